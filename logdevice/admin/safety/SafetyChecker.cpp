@@ -263,6 +263,16 @@ SafetyChecker::performSafetyCheck(
 
         const auto nodes_config = processor_->getNodesConfiguration();
         ClusterState* cluster_state = processor_->cluster_state_.get();
+        // Shared by internal logs and all batches of data logs, so that each
+        // distinct storage set is only evaluated once per check.
+        auto availability_cache =
+            std::make_shared<safety::StorageSetAvailabilityCache>(
+                status_map,
+                shards,
+                target_storage_state,
+                safety_margin,
+                nodes_config,
+                cluster_state);
 
         // Check impact on capacity
         Impact capacity_impact;
@@ -346,7 +356,8 @@ SafetyChecker::performSafetyCheck(
                                                   abort_on_error_,
                                                   error_sample_size_,
                                                   nodes_config,
-                                                  cluster_state);
+                                                  cluster_state,
+                                                  availability_cache.get());
           if (impact.hasError()) {
             // The operation failed. Possibly because we don't have metadata for
             // this log-id. This is critical.
@@ -415,7 +426,9 @@ SafetyChecker::performSafetyCheck(
                                          safety_margin,
                                          this,
                                          cfg,
-                                         cluster_state](auto&&) {
+                                         nodes_config,
+                                         cluster_state,
+                                         availability_cache](auto&&) {
                                return safety::checkImpactOnLogs(
                                    mbatch,
                                    metadata,
@@ -427,8 +440,9 @@ SafetyChecker::performSafetyCheck(
                                    /* internal_logs = */ false,
                                    abort_on_error_,
                                    error_sample_size_,
-                                   processor_->getNodesConfiguration(),
-                                   cluster_state);
+                                   nodes_config,
+                                   cluster_state,
+                                   availability_cache.get());
                              }));
           --chunks;
         }
@@ -448,7 +462,10 @@ SafetyChecker::performSafetyCheck(
                      return mergeImpact(
                          std::move(acc), result, error_sample_size_);
                    })
-            .thenValue([start_time](folly::Expected<Impact, Status> result) {
+            .thenValue([start_time, availability_cache](
+                           folly::Expected<Impact, Status> result) {
+              ld_debug("Evaluated %zu distinct storage sets",
+                       availability_cache->size());
               std::chrono::seconds total_time =
                   std::chrono::duration_cast<std::chrono::seconds>(
                       std::chrono::steady_clock::now() - start_time);
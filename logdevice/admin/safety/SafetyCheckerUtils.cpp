@@ -8,6 +8,8 @@
 
 #include "logdevice/admin/safety/SafetyCheckerUtils.h"
 
+#include <folly/hash/Hash.h>
+
 #include "logdevice/admin/Conv.h"
 #include "logdevice/common/EpochMetaData.h"
 #include "logdevice/common/FailureDomainNodeSet.h"
@@ -16,6 +18,67 @@ using namespace facebook::logdevice::configuration;
 
 namespace facebook { namespace logdevice { namespace safety {
 
+StorageSetAvailabilityCache::StorageSetAvailabilityCache(
+    ShardAuthoritativeStatusMap shard_status,
+    ShardSet op_shards,
+    configuration::StorageState target_storage_state,
+    SafetyMargin safety_margin,
+    std::shared_ptr<const configuration::nodes::NodesConfiguration>
+        nodes_config,
+    ClusterState* cluster_state)
+    : shard_status_(std::move(shard_status)),
+      op_shards_(std::move(op_shards)),
+      target_storage_state_(target_storage_state),
+      safety_margin_(std::move(safety_margin)),
+      nodes_config_(std::move(nodes_config)),
+      cluster_state_(cluster_state) {}
+
+std::pair<bool, bool> StorageSetAvailabilityCache::checkReadWriteAvailablity(
+    const StorageSet& storage_set,
+    const ReplicationProperty& replication_property,
+    bool require_fully_started_nodes) {
+  const KeyRef key{
+      storage_set, replication_property, require_fully_started_nodes};
+  {
+    auto results = results_.rlock();
+    auto it = results->find(key);
+    if (it != results->end()) {
+      ++hits_;
+      return it->second;
+    }
+  }
+  ++misses_;
+  // Evaluated without holding the lock. Batches racing on the same storage
+  // set compute the same result, the first one to get the lock stores it.
+  auto result = safety::checkReadWriteAvailablity(shard_status_,
+                                                  op_shards_,
+                                                  storage_set,
+                                                  target_storage_state_,
+                                                  replication_property,
+                                                  safety_margin_,
+                                                  nodes_config_,
+                                                  cluster_state_,
+                                                  require_fully_started_nodes);
+  results_.wlock()->emplace(
+      Key{storage_set, replication_property, require_fully_started_nodes},
+      result);
+  return result;
+}
+
+size_t StorageSetAvailabilityCache::size() const {
+  return results_.rlock()->size();
+}
+
+size_t StorageSetAvailabilityCache::KeyHash::
+operator()(const KeyRef& key) const {
+  // Replication is left out: normalizing it allocates, and logs that share a
+  // storage set almost always share its replication too.
+  return folly::hash::hash_range(key.storage_set.begin(),
+                                 key.storage_set.end(),
+                                 key.require_fully_started,
+                                 std::hash<ShardID>());
+}
+
 folly::Expected<Impact, Status> checkImpactOnLogs(
     const std::vector<logid_t>& log_ids,
     const std::shared_ptr<LogMetaDataFetcher::Results>& metadata,
@@ -29,7 +92,8 @@ folly::Expected<Impact, Status> checkImpactOnLogs(
     size_t error_sample_size,
     const std::shared_ptr<const configuration::nodes::NodesConfiguration>&
         nodes_config,
-    ClusterState* cluster_state) {
+    ClusterState* cluster_state,
+    StorageSetAvailabilityCache* availability_cache) {
   std::set<thrift::OperationImpact> impact_result_all;
   std::vector<thrift::ImpactOnEpoch> affected_logs_sample;
   size_t logs_done = 0;
@@ -47,7 +111,8 @@ folly::Expected<Impact, Status> checkImpactOnLogs(
                                    target_storage_state,
                                    safety_margin,
                                    nodes_config,
-                                   cluster_state);
+                                   cluster_state,
+                                   availability_cache);
     logs_done++;
     if (result.hasError()) {
       // The operation failed. Possibly because we don't have metadata for
@@ -93,7 +158,8 @@ folly::Expected<thrift::ImpactOnEpoch, Status> checkImpactOnLog(
     const SafetyMargin& safety_margin,
     const std::shared_ptr<const configuration::nodes::NodesConfiguration>&
         nodes_config,
-    ClusterState* cluster_state) {
+    ClusterState* cluster_state,
+    StorageSetAvailabilityCache* availability_cache) {
   ld_assert(metadata_cache);
   if (metadata_cache->find(log_id) == metadata_cache->end()) {
     // We cannot find the epoch metadata for this log. This can have multiple
@@ -140,16 +206,24 @@ folly::Expected<thrift::ImpactOnEpoch, Status> checkImpactOnLog(
     bool safe_writes;
     bool safe_reads;
 
-    std::tie(safe_reads, safe_writes) =
-        checkReadWriteAvailablity(shard_status,
-                                  op_shards,
-                                  epoch_metadata.shards,
-                                  target_storage_state,
-                                  epoch_metadata.replication,
-                                  safety_margin,
-                                  nodes_config,
-                                  cluster_state,
-                                  require_fully_started);
+    if (availability_cache) {
+      std::tie(safe_reads, safe_writes) =
+          availability_cache->checkReadWriteAvailablity(
+              epoch_metadata.shards,
+              epoch_metadata.replication,
+              require_fully_started);
+    } else {
+      std::tie(safe_reads, safe_writes) =
+          checkReadWriteAvailablity(shard_status,
+                                    op_shards,
+                                    epoch_metadata.shards,
+                                    target_storage_state,
+                                    epoch_metadata.replication,
+                                    safety_margin,
+                                    nodes_config,
+                                    cluster_state,
+                                    require_fully_started);
+    }
 
     if (safe_writes && safe_reads) {
       continue;
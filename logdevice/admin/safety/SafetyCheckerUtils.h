@@ -7,6 +7,10 @@
  */
 #pragma once
 
+#include <atomic>
+
+#include <folly/Synchronized.h>
+#include <folly/container/F14Map.h>
 #include <folly/container/F14Set.h>
 
 #include "logdevice/admin/if/gen-cpp2/safety_types.h"
@@ -20,8 +24,113 @@
 
 namespace facebook { namespace logdevice { namespace safety {
 
+/**
+ * Memoizes checkReadWriteAvailablity() for the storage sets seen during one
+ * safety check. Clusters with millions of logs typically only have a few
+ * thousand distinct storage sets and replication properties, so most logs and
+ * epochs can reuse the result computed for another one.
+ *
+ * Thread-safe, one instance is shared by all batches of logs of a check.
+ */
+class StorageSetAvailabilityCache {
+ public:
+  StorageSetAvailabilityCache(
+      ShardAuthoritativeStatusMap shard_status,
+      ShardSet op_shards,
+      configuration::StorageState target_storage_state,
+      SafetyMargin safety_margin,
+      std::shared_ptr<const configuration::nodes::NodesConfiguration>
+          nodes_config,
+      ClusterState* cluster_state);
+
+  /**
+   * Same as checkReadWriteAvailablity() called with the arguments passed to
+   * the constructor.
+   */
+  std::pair<bool, bool>
+  checkReadWriteAvailablity(const StorageSet& storage_set,
+                            const ReplicationProperty& replication_property,
+                            bool require_fully_started_nodes);
+
+  /**
+   * Number of distinct (storage set, replication) pairs evaluated so far.
+   */
+  size_t size() const;
+
+  // Number of lookups answered from the cache and evaluated, respectively.
+  uint64_t hits() const {
+    return hits_.load();
+  }
+  uint64_t misses() const {
+    return misses_.load();
+  }
+
+ private:
+  struct Key {
+    StorageSet storage_set;
+    ReplicationProperty replication;
+    bool require_fully_started;
+  };
+
+  // Lookups use a KeyRef to the caller's storage set, so that only the
+  // storage sets of misses get copied into the map.
+  struct KeyRef {
+    const StorageSet& storage_set;
+    const ReplicationProperty& replication;
+    bool require_fully_started;
+  };
+
+  static KeyRef toRef(const Key& key) {
+    return KeyRef{
+        key.storage_set, key.replication, key.require_fully_started};
+  }
+  static KeyRef toRef(const KeyRef& key) {
+    return key;
+  }
+
+  struct KeyHash {
+    using is_transparent = void;
+    size_t operator()(const KeyRef& key) const;
+    size_t operator()(const Key& key) const {
+      return (*this)(toRef(key));
+    }
+  };
+
+  struct KeyEqual {
+    using is_transparent = void;
+    template <typename A, typename B>
+    bool operator()(const A& a, const B& b) const {
+      const KeyRef lhs = toRef(a);
+      const KeyRef rhs = toRef(b);
+      // Replication last, comparing it allocates.
+      return lhs.require_fully_started == rhs.require_fully_started &&
+          lhs.storage_set == rhs.storage_set &&
+          lhs.replication == rhs.replication;
+    }
+  };
+
+  const ShardAuthoritativeStatusMap shard_status_;
+  const ShardSet op_shards_;
+  const configuration::StorageState target_storage_state_;
+  const SafetyMargin safety_margin_;
+  const std::shared_ptr<const configuration::nodes::NodesConfiguration>
+      nodes_config_;
+  ClusterState* const cluster_state_;
+
+  // Maps to (safe_for_reads, safe_for_writes).
+  folly::Synchronized<
+      folly::F14FastMap<Key, std::pair<bool, bool>, KeyHash, KeyEqual>>
+      results_;
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+};
+
 /**
  * Performs safety check on given logs
+ *
+ * @param availability_cache  If not null, used to evaluate each distinct
+ *                            storage set only once. Must have been created
+ *                            with the same arguments as passed here.
  */
 folly::Expected<Impact, Status> checkImpactOnLogs(
     const std::vector<logid_t>& log_ids,
@@ -36,7 +145,8 @@ folly::Expected<Impact, Status> checkImpactOnLogs(
     size_t error_sample_size,
     const std::shared_ptr<const configuration::nodes::NodesConfiguration>&
         nodes_config,
-    ClusterState* cluster_state);
+    ClusterState* cluster_state,
+    StorageSetAvailabilityCache* availability_cache = nullptr);
 /**
  * Perform safety check on a single log.
  */
@@ -50,7 +160,8 @@ folly::Expected<thrift::ImpactOnEpoch, Status> checkImpactOnLog(
     const SafetyMargin& safety_margin,
     const std::shared_ptr<const configuration::nodes::NodesConfiguration>&
         nodes_config,
-    ClusterState* cluster_state);
+    ClusterState* cluster_state,
+    StorageSetAvailabilityCache* availability_cache = nullptr);
 
 /**
  * Checks whether a node is alive in the FailureDetector (gossip) or not.
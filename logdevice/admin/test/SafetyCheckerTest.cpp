@@ -9,6 +9,9 @@
 
 #include <gtest/gtest.h>
 
+#include "logdevice/admin/safety/SafetyCheckerUtils.h"
+#include "logdevice/common/test/NodesConfigurationTestUtil.h"
+
 using namespace facebook::logdevice;
 
 TEST(SafetyCheckerTest, Parse) {
@@ -21,3 +24,72 @@ TEST(SafetyCheckerTest, Parse) {
   ASSERT_EQ(2, safety_margin2[NodeLocationScope::RACK]);
   ASSERT_EQ(5, safety_margin2[NodeLocationScope::NODE]);
 }
+
+TEST(SafetyCheckerTest, StorageSetAvailabilityCache) {
+  configuration::Nodes nodes;
+  for (node_index_t n = 0; n < 6; ++n) {
+    configuration::Node node = configuration::Node::withTestDefaults(n);
+    node.addStorageRole(1);
+    nodes.emplace(n, std::move(node));
+  }
+  const auto nodes_config = NodesConfigurationTestUtil::provisionNodes(
+      std::move(nodes), ReplicationProperty{{NodeLocationScope::NODE, 2}});
+  const ShardAuthoritativeStatusMap shard_status;
+  const ShardSet op_shards{ShardID(0, 0)};
+  const SafetyMargin safety_margin;
+  const auto target_state = configuration::StorageState::DISABLED;
+  safety::StorageSetAvailabilityCache cache(shard_status,
+                                            op_shards,
+                                            target_state,
+                                            safety_margin,
+                                            nodes_config,
+                                            /*cluster_state=*/nullptr);
+
+  auto check = [&](const StorageSet& storage_set,
+                   const ReplicationProperty& replication,
+                   bool require_fully_started) {
+    auto expected =
+        safety::checkReadWriteAvailablity(shard_status,
+                                          op_shards,
+                                          storage_set,
+                                          target_state,
+                                          replication,
+                                          safety_margin,
+                                          nodes_config,
+                                          /*cluster_state=*/nullptr,
+                                          require_fully_started);
+    EXPECT_EQ(expected,
+              cache.checkReadWriteAvailablity(
+                  storage_set, replication, require_fully_started));
+  };
+
+  const ReplicationProperty node2({{NodeLocationScope::NODE, 2}});
+  const ReplicationProperty node3({{NodeLocationScope::NODE, 3}});
+  const StorageSet set_a{ShardID(0, 0), ShardID(1, 0), ShardID(2, 0)};
+  const StorageSet set_b{ShardID(3, 0), ShardID(4, 0), ShardID(5, 0)};
+
+  check(set_a, node2, false);
+  EXPECT_EQ(0, cache.hits());
+  EXPECT_EQ(1, cache.misses());
+
+  // An equal storage set of another log is a hit.
+  const StorageSet set_a_copy = set_a;
+  check(set_a_copy, node2, false);
+  EXPECT_EQ(1, cache.hits());
+  EXPECT_EQ(1, cache.misses());
+
+  // Any difference in the key is a miss.
+  check(set_b, node2, false);
+  check(set_a, node3, false);
+  check(set_a, node2, true);
+  EXPECT_EQ(1, cache.hits());
+  EXPECT_EQ(4, cache.misses());
+  EXPECT_EQ(4, cache.size());
+
+  check(set_b, node2, false);
+  check(set_a, node3, false);
+  check(set_a, node2, true);
+  EXPECT_EQ(4, cache.hits());
+  EXPECT_EQ(4, cache.misses());
+  EXPECT_EQ(4, cache.size());
+}
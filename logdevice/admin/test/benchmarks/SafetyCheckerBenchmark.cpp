@@ -0,0 +1,159 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/Format.h>
+#include <folly/Singleton.h>
+#include <gflags/gflags.h>
+
+#include "logdevice/admin/safety/SafetyCheckerUtils.h"
+#include "logdevice/common/EpochMetaDataMap.h"
+#include "logdevice/common/test/NodesConfigurationTestUtil.h"
+
+using namespace facebook::logdevice;
+using namespace facebook::logdevice::configuration;
+
+DEFINE_uint64(num_logs, 1000000, "Number of data logs to check.");
+DEFINE_uint64(num_storage_sets,
+              2000,
+              "Number of distinct storage sets shared by the logs.");
+DEFINE_uint64(epochs_per_log, 2, "Number of historical epochs per log.");
+
+/**
+ * @file: Cost of evaluating the impact of draining a node on all data logs of
+ *        a synthetic cluster, as the CheckImpact admin API call does. Logs
+ *        only use a few thousand distinct storage sets, which
+ *        StorageSetAvailabilityCache evaluates once each instead of once per
+ *        log and epoch.
+ */
+
+namespace {
+
+constexpr node_index_t kNumNodes = 100;
+constexpr int kNumRacks = 10;
+constexpr size_t kStorageSetSize = 12;
+
+struct Cluster {
+  std::shared_ptr<const nodes::NodesConfiguration> nodes_config;
+  std::shared_ptr<LogMetaDataFetcher::Results> metadata;
+  std::vector<logid_t> log_ids;
+  ShardSet op_shards;
+};
+
+const Cluster& getCluster() {
+  static std::unique_ptr<Cluster> cluster;
+  if (cluster) {
+    return *cluster;
+  }
+  cluster = std::make_unique<Cluster>();
+
+  Nodes nodes;
+  for (node_index_t n = 0; n < kNumNodes; ++n) {
+    Node node = Node::withTestDefaults(n, false, false);
+    node.setLocation(folly::sformat("rg.dc.cl.rw.rk{}", n % kNumRacks));
+    node.addStorageRole(1, 1.0);
+    nodes.emplace(n, std::move(node));
+  }
+  cluster->nodes_config = NodesConfigurationTestUtil::provisionNodes(
+      std::move(nodes), ReplicationProperty{{NodeLocationScope::RACK, 2}});
+
+  std::mt19937_64 rnd(0xbe4c);
+  std::vector<ShardID> all_shards;
+  for (node_index_t n = 0; n < kNumNodes; ++n) {
+    all_shards.emplace_back(n, 0);
+  }
+  std::vector<StorageSet> storage_sets;
+  for (size_t i = 0; i < FLAGS_num_storage_sets; ++i) {
+    std::shuffle(all_shards.begin(), all_shards.end(), rnd);
+    StorageSet storage_set(
+        all_shards.begin(), all_shards.begin() + kStorageSetSize);
+    std::sort(storage_set.begin(), storage_set.end());
+    storage_sets.push_back(std::move(storage_set));
+  }
+
+  const ReplicationProperty replication(
+      {{NodeLocationScope::RACK, 2}, {NodeLocationScope::NODE, 3}});
+  cluster->metadata = std::make_shared<LogMetaDataFetcher::Results>();
+  cluster->metadata->reserve(FLAGS_num_logs);
+  for (size_t i = 0; i < FLAGS_num_logs; ++i) {
+    const logid_t log_id(i + 1);
+    EpochMetaDataMap::Map map;
+    for (size_t e = 0; e < FLAGS_epochs_per_log; ++e) {
+      const epoch_t epoch(EPOCH_MIN.val_ + e * 10);
+      map[epoch] = EpochMetaData(storage_sets[rnd() % storage_sets.size()],
+                                 replication,
+                                 epoch,
+                                 epoch);
+    }
+    LogMetaDataFetcher::Result result;
+    result.historical_metadata_status = E::OK;
+    result.historical_metadata = EpochMetaDataMap::create(
+        std::make_shared<const EpochMetaDataMap::Map>(std::move(map)),
+        epoch_t(EPOCH_MIN.val_ + FLAGS_epochs_per_log * 10));
+    cluster->metadata->emplace(log_id, std::move(result));
+    cluster->log_ids.push_back(log_id);
+  }
+
+  // Draining a single node is safe for all logs, so every log gets checked.
+  cluster->op_shards.insert(ShardID(0, 0));
+  return *cluster;
+}
+
+void checkAllLogs(unsigned n, bool use_cache) {
+  const Cluster* cluster;
+  BENCHMARK_SUSPEND {
+    cluster = &getCluster();
+  }
+  const ShardAuthoritativeStatusMap shard_status;
+  const SafetyMargin safety_margin;
+  for (unsigned i = 0; i < n; ++i) {
+    std::unique_ptr<safety::StorageSetAvailabilityCache> cache;
+    if (use_cache) {
+      cache = std::make_unique<safety::StorageSetAvailabilityCache>(
+          shard_status,
+          cluster->op_shards,
+          StorageState::DISABLED,
+          safety_margin,
+          cluster->nodes_config,
+          /*cluster_state=*/nullptr);
+    }
+    auto impact = safety::checkImpactOnLogs(cluster->log_ids,
+                                            cluster->metadata,
+                                            shard_status,
+                                            cluster->op_shards,
+                                            /*sequencers=*/{},
+                                            StorageState::DISABLED,
+                                            safety_margin,
+                                            /*internal_logs=*/false,
+                                            /*abort_on_error=*/true,
+                                            /*error_sample_size=*/20,
+                                            cluster->nodes_config,
+                                            /*cluster_state=*/nullptr,
+                                            cache.get());
+    ld_check(impact.hasValue());
+    folly::doNotOptimizeAway(impact);
+  }
+}
+
+} // namespace
+
+BENCHMARK_NAMED_PARAM(checkAllLogs, uncached, false)
+BENCHMARK_RELATIVE_NAMED_PARAM(checkAllLogs, cached, true)
+
+#ifndef BENCHMARK_BUNDLE
+int main(int argc, char** argv) {
+  folly::SingletonVault::singleton()->registrationComplete();
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
+#endif
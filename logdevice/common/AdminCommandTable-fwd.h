@@ -92,7 +92,9 @@ typedef AdminCommandTable<std::string, /* State */
                           int,         /* Proto */
                           size_t,      /* Send buf-sz */
                           bool,        /* Is ssl */
-                          int          /* FD of the underlying socket */
+                          int,         /* FD of the underlying socket */
+                          float,       /* Copied (MB) */
+                          float        /* Zero-copy (MB) */
                           >
     InfoSocketsTable;
 
@@ -313,6 +315,19 @@ typedef AdminCommandTable<std::string, /* Column family */
                           >
     InfoIteratorsTable;
 
+typedef AdminCommandTable<uint32_t,                  /* Shard */
+                          std::chrono::milliseconds, /* Start time */
+                          uint64_t,                  /* Latency us */
+                          std::string,               /* Context */
+                          std::string,               /* Op */
+                          std::string,               /* File type */
+                          uint64_t,                  /* File number */
+                          uint64_t,                  /* CF ID */
+                          uint64_t,                  /* Offset */
+                          uint64_t                   /* Size */
+                          >
+    InfoIOTracesTable;
+
 typedef AdminCommandTable<uint64_t,    /* Shard ID */
                           bool,        /* Failing */
                           Status,      /* Accepting writes */
@@ -0,0 +1,47 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+/**
+ * @file Stages of an append whose latencies are tracked separately, see
+ *       AppendStageTimer.
+ */
+
+namespace facebook { namespace logdevice {
+
+enum class AppendStage : uint8_t {
+#define APPEND_STAGE(name, _) name,
+#include "logdevice/common/append_stages.inc"
+  MAX
+};
+
+const char* appendStageName(AppendStage stage);
+
+// Storage node stages that are reported back to the sequencer in STORED for
+// sampled appends, see STORED_Header::APPEND_STAGES. STORED_REPLY isn't
+// known until the reply is sent.
+constexpr AppendStage FIRST_REPORTED_STORAGE_STAGE =
+    AppendStage::STORAGE_ADMISSION;
+constexpr AppendStage LAST_REPORTED_STORAGE_STAGE = AppendStage::SYNC;
+constexpr size_t NUM_REPORTED_STORAGE_STAGES =
+    static_cast<size_t>(LAST_REPORTED_STORAGE_STAGE) -
+    static_cast<size_t>(FIRST_REPORTED_STORAGE_STAGE) + 1;
+
+// Durations of the reported storage stages of one copy, in microseconds, in
+// stage order. 0 if the stage wasn't timed, e.g. SYNC for a copy that didn't
+// need to be synced.
+using StorageStageDurations = std::array<uint32_t, NUM_REPORTED_STORAGE_STAGES>;
+
+// E.g. "storage_admission=12us storage_queue=40us local_write=85us sync=0us".
+std::string toString(const StorageStageDurations& durations);
+
+}} // namespace facebook::logdevice
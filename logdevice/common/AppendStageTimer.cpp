@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/AppendStageTimer.h"
+
+#include <algorithm>
+#include <limits>
+
+#include <folly/Format.h>
+#include <folly/Random.h>
+
+#include "logdevice/common/chrono_util.h"
+#include "logdevice/common/stats/Stats.h"
+
+namespace facebook { namespace logdevice {
+
+const char* appendStageName(AppendStage stage) {
+  switch (stage) {
+#define APPEND_STAGE(name, str) \
+  case AppendStage::name:       \
+    return str;
+#include "logdevice/common/append_stages.inc"
+    case AppendStage::MAX:
+      break;
+  }
+  return "unknown";
+}
+
+std::string toString(const StorageStageDurations& durations) {
+  std::string res;
+  for (size_t i = 0; i < durations.size(); ++i) {
+    auto stage = static_cast<AppendStage>(
+        static_cast<size_t>(FIRST_REPORTED_STORAGE_STAGE) + i);
+    folly::format(&res,
+                  "{}{}={}us",
+                  res.empty() ? "" : " ",
+                  appendStageName(stage),
+                  durations[i]);
+  }
+  return res;
+}
+
+void AppendStageTimer::start(double sample_rate, TimePoint start_time) {
+  if (sample_rate <= 0 ||
+      (sample_rate < 1 && folly::Random::randDouble01() >= sample_rate)) {
+    return;
+  }
+  last_ = start_time;
+  ended_ = 0;
+  durations_usec_.fill(0);
+}
+
+void AppendStageTimer::endSampled(AppendStage stage, StatsHolder* stats) {
+  const uint16_t bit = 1u << static_cast<int>(stage);
+  if (ended_ & bit) {
+    return;
+  }
+  ended_ |= bit;
+  const TimePoint now = std::chrono::steady_clock::now();
+  const int64_t usec = std::max<int64_t>(to_usec(now - last_).count(), 0);
+  HISTOGRAM_ADD(stats, append_stage_latency[static_cast<int>(stage)], usec);
+  durations_usec_[static_cast<size_t>(stage)] = static_cast<uint32_t>(
+      std::min<int64_t>(usec, std::numeric_limits<uint32_t>::max()));
+  last_ = now;
+}
+
+StorageStageDurations AppendStageTimer::getStorageStageDurations() const {
+  StorageStageDurations res;
+  std::copy_n(durations_usec_.begin() +
+                  static_cast<size_t>(FIRST_REPORTED_STORAGE_STAGE),
+              res.size(),
+              res.begin());
+  return res;
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,93 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#include "logdevice/common/AppendStage.h"
+
+namespace facebook { namespace logdevice {
+
+class StatsHolder;
+
+/**
+ * @file Breaks down the latency of a sampled append into AppendStage-s, each
+ *       of which goes to its own histogram ("append_stage.<name>" in
+ *       ServerHistograms, also shown by "stats2 append_stages" and the
+ *       append_stages ldquery table).
+ *
+ *       Each node times the stages it takes part in with its own clock: an
+ *       Appender times the sequencer stages, a StoreStorageTask those of the
+ *       storage node. Only durations are compared across nodes, so clock
+ *       skew doesn't matter. The sequencer's REPLICATION stage covers the
+ *       storage node stages of the copies it waits for, plus the network.
+ *
+ *       An Appender samples with probability
+ *       --append-stage-latency-sample-rate and marks the STOREs of sampled
+ *       appends with STORE_Header::APPEND_STAGES. Storage nodes time the
+ *       STOREs so marked and send their stage durations back in STORED, so
+ *       that the sequencer can tell where a slow append spent its time.
+ *       If not sampled, ending a stage is a single branch.
+ */
+
+class AppendStageTimer {
+ public:
+  using TimePoint = std::chrono::steady_clock::time_point;
+
+  /**
+   * Decides whether to sample this append, with probability
+   * @param sample_rate. If so, the first stage timed starts at
+   * @param start_time.
+   */
+  void start(double sample_rate, TimePoint start_time);
+
+  bool sampled() const {
+    return last_ != TimePoint();
+  }
+
+  /**
+   * If sampled, ends @param stage now and adds the time since the end of the
+   * previous stage to its histogram. Each stage is only recorded the first
+   * time it ends, e.g. for the first wave of an Appender.
+   */
+  void end(AppendStage stage, StatsHolder* stats) {
+    if (sampled()) {
+      endSampled(stage, stats);
+    }
+  }
+
+  /**
+   * @return  how long @param stage took, in microseconds, or 0 if it wasn't
+   *          recorded.
+   */
+  uint32_t getDurationUsec(AppendStage stage) const {
+    return durations_usec_[static_cast<size_t>(stage)];
+  }
+
+  /**
+   * @return  durations of the storage node stages reported to the sequencer.
+   */
+  StorageStageDurations getStorageStageDurations() const;
+
+ private:
+  void endSampled(AppendStage stage, StatsHolder* stats);
+
+  // End of the last stage recorded, or default-constructed if not sampled.
+  TimePoint last_{};
+  // Bit i is set if stage i was recorded.
+  uint16_t ended_{0};
+  // Duration of each recorded stage.
+  std::array<uint32_t, static_cast<size_t>(AppendStage::MAX)> durations_usec_{};
+
+  static_assert(static_cast<size_t>(AppendStage::MAX) <= 16,
+                "ended_ needs more bits");
+};
+
+}} // namespace facebook::logdevice
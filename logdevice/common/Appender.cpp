@@ -27,6 +27,7 @@
 #include "logdevice/common/Processor.h"
 #include "logdevice/common/Sequencer.h"
 #include "logdevice/common/SocketSender.h"
+#include "logdevice/common/StoreBatcher.h"
 #include "logdevice/common/TailRecord.h"
 #include "logdevice/common/TraceLogger.h"
 #include "logdevice/common/Worker.h"
@@ -68,7 +69,7 @@ Appender::Appender(Worker* worker,
                    epoch_t seen_epoch,
                    size_t full_appender_size,
                    lsn_t lsn_before_redirect)
-    : sender_(std::make_unique<SenderProxy>()),
+    : sender_(std::make_unique<StoreBatchingSender>()),
       tracer_(std::move(trace_logger)),
       created_on_(worker),
       full_appender_size_(full_appender_size),
@@ -426,6 +427,10 @@ int Appender::trySendingWavesOfStores(
     if (!attrs_.optional_keys.empty()) {
       store_flags |= STORE_Header::CUSTOM_KEY;
     }
+    if (stage_timer_.sampled()) {
+      // Have storage nodes report how long their stages took.
+      store_flags |= STORE_Header::APPEND_STAGES;
+    }
 
     recipients_.replace(copyset, store_hdr_.copyset_size, this);
 
@@ -656,6 +661,10 @@ int Appender::start(std::shared_ptr<EpochSequencer> epoch_sequencer,
 
   STAT_INCR(getStats(), appender_start);
 
+  stage_timer_.start(
+      getSettings().append_stage_latency_sample_rate, creation_time_);
+  stage_timer_.end(AppendStage::SEQUENCER_WINDOW, getStats());
+
   // Test only setting to disallow appender from retiring. We skip sending the
   // copies to the storage nodes and hence stay in the started stage until
   // someone will abort this appender.
@@ -862,13 +871,14 @@ void Appender::sendReply(lsn_t lsn, Status status, NodeID redirect) {
                  append_message_count_);
     if (created_on_) { // can be null in tests
       // Bump the per-log-group stats
-      if (auto log_path =
-              created_on_->getConfiguration()->getLogGroupPath(log_id_)) {
+      const log_group_stats_idx_t log_group_idx =
+          created_on_->getConfiguration()->getLogGroupStatsIdx(log_id_);
+      if (log_group_idx != LOG_GROUP_STATS_IDX_INVALID) {
         ld_check(getPayload());
-        LOG_GROUP_TIME_SERIES_ADD(getStats(),
-                                  append_out_bytes,
-                                  log_path.value(),
-                                  getPayload()->size());
+        LOG_GROUP_IDX_TIME_SERIES_ADD(getStats(),
+                                      append_out_bytes,
+                                      log_group_idx,
+                                      getPayload()->size());
       }
     }
   } else {
@@ -1215,6 +1225,7 @@ void Appender::onCopySent(Status st, ShardID to, const STORE_Header& mhdr) {
   ld_check(replies_expected_ > 0);
 
   if (st == Status::OK) {
+    stage_timer_.end(AppendStage::STORE_SEND, getStats());
     if (mhdr.flags & STORE_Header::CHAIN) {
       for (auto& r : recipients_.getRecipients()) {
         r.setState(Recipient::State::OUTSTANDING);
@@ -1303,7 +1314,8 @@ void Appender::setNotAvailableShard(ShardID shard,
 
 int Appender::onReply(const STORED_Header& header,
                       ShardID from,
-                      ShardID rebuildingRecipient) {
+                      ShardID rebuildingRecipient,
+                      const StorageStageDurations* append_stages) {
   auto worker = Worker::onThisThread(false);
   if (worker &&
       worker->updateable_settings_->enable_store_histogram_calculations) {
@@ -1440,6 +1452,11 @@ int Appender::onReply(const STORED_Header& header,
       }
     }
 
+    if (stage_timer_.sampled()) {
+      storage_stages_ = append_stages ? folly::make_optional(*append_stages)
+                                      : folly::none;
+    }
+
     onRecipientSucceeded(recipient);
     // `this` may no longer exist here.
     return 0;
@@ -1735,6 +1752,7 @@ void Appender::onRecipientSucceeded(Recipient* recipient) {
   }
 
   ld_check(!reply_sent_);
+  stage_timer_.end(AppendStage::REPLICATION, getStats());
   // record the latency of this append
   HISTOGRAM_ADD(getStats(), append_latency, usec_since(creation_time_));
   int64_t latency_usec = usec_since(creation_time_);
@@ -1753,21 +1771,24 @@ void Appender::onRecipientSucceeded(Recipient* recipient) {
       backlog_duration_,
       started() ? store_hdr_.wave : 0,
       std::string(error_name(E::OK)),
-      std::string(error_name(E::OK)));
+      std::string(error_name(E::OK)),
+      storage_stages_);
   if (std::chrono::microseconds(latency_usec) >
       LOG_IF_APPEND_TOOK_LONGER_THAN) {
     RATELIMIT_WARNING(
         std::chrono::seconds(1),
         5,
         "Slow Appender %lu%s: %.3fs, %u waves, payload: %lu bytes, "
-        "client: %s",
+        "client: %s%s%s",
         log_id_.val_,
         lsn_to_string(store_hdr_.rid.lsn()).c_str(),
         latency_usec / 1e6,
         store_hdr_.wave,
         payload_.size(),
         client_sock_addr.valid() ? client_sock_addr.toStringNoPort().c_str()
-                                 : "invalid");
+                                 : "invalid",
+        storage_stages_ ? ", storage stages of the last copy: " : "",
+        storage_stages_ ? toString(*storage_stages_).c_str() : "");
   }
   sendReply(compose_lsn(store_hdr_.rid.epoch, store_hdr_.rid.esn), E::OK);
 
@@ -1924,6 +1945,9 @@ void Appender::onReaped() {
   FullyReplicated replicated =
       (release_type == ReleaseType::INVALID ? FullyReplicated::NO
                                             : FullyReplicated::YES);
+  if (replicated == FullyReplicated::YES) {
+    stage_timer_.end(AppendStage::RELEASE, getStats());
+  }
   // Check whether last-released LSN changed.
   bool last_release_changed =
       noteAppenderReaped(replicated, lsn, tail_record_, &last_released_epoch);
@@ -17,6 +17,7 @@
 #include <folly/Optional.h>
 #include <folly/small_vector.h>
 
+#include "logdevice/common/AppendStageTimer.h"
 #include "logdevice/common/AppenderTracer.h"
 #include "logdevice/common/CopySetManager.h"
 #include "logdevice/common/ExponentialBackoffTimer.h"
@@ -393,12 +394,15 @@ class Appender : public IntrusiveUnorderedMapHook {
    * @param from                storage shard that sent the reply
    * @param rebuildingRecipient If header.status == E::REBULDING, recipient in
    *                            the copyset that is rebuilding.
+   * @param append_stages       If the reply has STORED_Header::APPEND_STAGES,
+   *                            durations of the storage node stages.
    *
    * @return 0 on success, -1 if reply is invalid, sets err to E::PROTO.
    */
   int onReply(const STORED_Header& header,
               ShardID from,
-              ShardID rebuildingRecipient = ShardID());
+              ShardID rebuildingRecipient = ShardID(),
+              const StorageStageDurations* append_stages = nullptr);
 
   const PayloadHolder* getPayload() const {
     return &payload_;
@@ -662,7 +666,7 @@ class Appender : public IntrusiveUnorderedMapHook {
   // having a real EpochSequencer (epoch_sequencer_ may be nullptr in tests).
   std::shared_ptr<EpochSequencer> epoch_sequencer_;
 
-  // Access to Sender.
+  // Access to Sender. A StoreBatchingSender unless replaced by tests.
   std::unique_ptr<SenderBase> sender_;
 
   // Set of ShardIDs that sent a STORED reply with status OK.
@@ -813,6 +817,14 @@ class Appender : public IntrusiveUnorderedMapHook {
   // time when the appender was created, used to calculate the latency
   std::chrono::steady_clock::time_point creation_time_;
 
+  // Breakdown of the latency of this append by stage, if sampled.
+  AppendStageTimer stage_timer_;
+
+  // If sampled, durations of the storage node stages reported by the last
+  // successful STORED of the current wave. Once the record is fully
+  // replicated, that's the copy that completed replication.
+  folly::Optional<StorageStageDurations> storage_stages_;
+
   // deadline after which the client is presumed to have timed out. If the
   // epoch to which this Appender belongs (store_hdr_.epoch) is shut down
   // after this deadline, the appender may abort the request without sending
@@ -36,7 +36,8 @@ void AppenderTracer::traceAppend(
     folly::Optional<std::chrono::seconds> backlog_duration,
     uint32_t waves,
     std::string client_status,
-    std::string internal_status) {
+    std::string internal_status,
+    const folly::Optional<StorageStageDurations>& storage_stages) {
   auto sample_builder = [&]() -> std::unique_ptr<TraceSample> {
     auto sample = std::make_unique<TraceSample>();
     const auto& recipients = recipient_set.getRecipients();
@@ -81,6 +82,10 @@ void AppenderTracer::traceAppend(
     sample->addIntValue("waves", waves);
     sample->addNormalValue("client_status", client_status);
     sample->addNormalValue("internal_status", internal_status);
+    if (storage_stages) {
+      // Stages of the copy that completed replication.
+      sample->addNormalValue("storage_stages", toString(*storage_stages));
+    }
     sample->addNormalValue("thread_name", ThreadID::getName());
     return sample;
   };
@@ -9,6 +9,9 @@
 
 #include <memory>
 
+#include <folly/Optional.h>
+
+#include "logdevice/common/AppendStage.h"
 #include "logdevice/common/SampledTracer.h"
 #include "logdevice/include/Err.h"
 
@@ -37,7 +40,9 @@ class AppenderTracer : SampledTracer {
                    folly::Optional<std::chrono::seconds> backlog_duration,
                    uint32_t waves,
                    std::string client_status,
-                   std::string internal_status);
+                   std::string internal_status,
+                   const folly::Optional<StorageStageDurations>&
+                       storage_stages = folly::none);
 };
 
 }} // namespace facebook::logdevice
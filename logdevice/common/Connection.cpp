@@ -74,6 +74,10 @@ class SocketImpl {
       pending_bw_cbs_;
 };
 
+// Serialized messages up to this size are copied into the tailroom of the
+// previous buffer in the batch instead of being chained.
+static constexpr size_t MAX_COALESCED_MESSAGE_SIZE = 512;
+
 static std::chrono::milliseconds
 getTimeDiff(std::chrono::steady_clock::time_point& start_time) {
   auto diff = std::chrono::steady_clock::now() - start_time;
@@ -753,6 +757,7 @@ void Connection::close(Status reason) {
   }
   sock_write_cb_.clear();
   sendChain_.reset();
+  send_chain_zero_copy_ = false;
   sched_write_chain_.cancelTimeout();
   // Invoke closeNow to close the socket.
   proto_handler_->sock()->closeNow();
@@ -866,8 +871,10 @@ bool Connection::isChecksummingEnabled(MessageType msgtype) {
   return msg_checksum_set.find((char)msgtype) == msg_checksum_set.end();
 }
 
-std::unique_ptr<folly::IOBuf> Connection::serializeMessage(const Message& msg) {
-  auto result = msg.serialize(getProto(), isChecksummingEnabled(msg.type_));
+std::unique_ptr<folly::IOBuf>
+Connection::serializeMessage(const Message& msg, size_t* bytes_without_copy) {
+  auto result = msg.serialize(
+      getProto(), isChecksummingEnabled(msg.type_), bytes_without_copy);
   if (!result) {
     // The error code is set by serialize
     close(err);
@@ -876,12 +883,46 @@ std::unique_ptr<folly::IOBuf> Connection::serializeMessage(const Message& msg) {
   return result;
 }
 
+void Connection::noteBytesSerialized(size_t msglen, size_t zero_copy) {
+  ld_check(zero_copy <= msglen);
+  const size_t copied = msglen - zero_copy;
+  const size_t zero_copy_threshold = getSettings().socket_zero_copy_threshold;
+  if (zero_copy_threshold > 0 && zero_copy >= zero_copy_threshold) {
+    send_chain_zero_copy_ = true;
+  }
+  num_bytes_sent_copied_ += copied;
+  num_bytes_sent_zero_copy_ += zero_copy;
+  STAT_ADD(deps_->getStats(), sock_bytes_serialized_copied, copied);
+  STAT_ADD(deps_->getStats(), sock_bytes_serialized_zero_copy, zero_copy);
+}
+
+bool Connection::coalesceIntoSendChain(const folly::IOBuf& io_buf) {
+  if (io_buf.isChained() || io_buf.length() > MAX_COALESCED_MESSAGE_SIZE) {
+    return false;
+  }
+  // Only the connection may write into the tailroom: the buffer must not be
+  // shared with a message or wrap memory that IOBuf doesn't manage.
+  folly::IOBuf* tail = sendChain_->prev();
+  if (!tail->isManagedOne() || tail->isSharedOne() ||
+      tail->tailroom() < io_buf.length()) {
+    return false;
+  }
+  memcpy(tail->writableTail(), io_buf.data(), io_buf.length());
+  tail->append(io_buf.length());
+  STAT_INCR(deps_->getStats(), sock_messages_coalesced);
+  return true;
+}
+
 Connection::SendStatus
-Connection::sendBuffer(std::unique_ptr<folly::IOBuf>&& io_buf) {
+Connection::sendBuffer(std::unique_ptr<folly::IOBuf>&& io_buf,
+                       size_t bytes_without_copy) {
   if (proto_handler_->good()) {
+    noteBytesSerialized(io_buf->computeChainDataLength(), bytes_without_copy);
     if (sendChain_) {
       ld_check(sched_write_chain_.isScheduled());
-      sendChain_->prependChain(std::move(io_buf));
+      if (!coalesceIntoSendChain(*io_buf)) {
+        sendChain_->prependChain(std::move(io_buf));
+      }
     } else {
       sendChain_ = std::move(io_buf);
       ld_check(!sched_write_chain_.isScheduled());
@@ -911,7 +952,22 @@ void Connection::scheduleWriteChain() {
       SocketWriteCallback::WriteUnit{bytes_in_sendq, now});
   // These bytes are now buffered in socket and will be removed from sendq.
   sock_write_cb_.bytes_buffered += bytes_in_sendq;
-  proto_handler_->sock()->writeChain(&sock_write_cb_, std::move(sendChain_));
+  auto flags = folly::WriteFlags::NONE;
+  if (send_chain_zero_copy_) {
+    send_chain_zero_copy_ = false;
+    if (zero_copy_state_ == ZeroCopyState::UNKNOWN) {
+      zero_copy_state_ = !isSSL() && proto_handler_->sock()->setZeroCopy(true)
+          ? ZeroCopyState::ENABLED
+          : ZeroCopyState::UNSUPPORTED;
+    }
+    if (zero_copy_state_ == ZeroCopyState::ENABLED) {
+      // The socket holds on to the chain until the kernel is done with it.
+      flags = folly::WriteFlags::WRITE_MSG_ZEROCOPY;
+      STAT_INCR(deps_->getStats(), sock_zero_copy_writes);
+    }
+  }
+  proto_handler_->sock()->writeChain(
+      &sock_write_cb_, std::move(sendChain_), flags);
   // All the bytes will be now removed from sendq now that we have written into
   // the asyncsocket.
   onBytesAdmittedToSend(bytes_in_sendq);
@@ -923,14 +979,17 @@ int Connection::serializeMessage(std::unique_ptr<Envelope>&& envelope) {
 
   const auto& msg = envelope->message();
 
-  std::unique_ptr<folly::IOBuf> serialized_buf = serializeMessage(msg);
+  size_t bytes_without_copy = 0;
+  std::unique_ptr<folly::IOBuf> serialized_buf =
+      serializeMessage(msg, &bytes_without_copy);
 
   if (serialized_buf == nullptr) {
     return -1;
   }
 
   const auto msglen = serialized_buf->computeChainDataLength();
-  Connection::SendStatus status = sendBuffer(std::move(serialized_buf));
+  Connection::SendStatus status =
+      sendBuffer(std::move(serialized_buf), bytes_without_copy);
   if (status == Connection::SendStatus::ERROR) {
     RATELIMIT_CRITICAL(std::chrono::seconds(1),
                        2,
@@ -1797,7 +1856,9 @@ void Connection::getDebugInfo(InfoSocketsTable& table) const {
       .set<11>(getProto())
       .set<12>(this->getTcpSendBufSize())
       .set<13>(isSSL())
-      .set<14>(fd_);
+      .set<14>(fd_)
+      .set<15>(num_bytes_sent_copied_ / 1048576.0)
+      .set<16>(num_bytes_sent_zero_copy_ / 1048576.0);
 }
 
 folly::Optional<PrincipalIdentity> Connection::extractPeerIdentity() {
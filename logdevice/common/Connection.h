@@ -586,10 +586,31 @@ class Connection : public TrafficShappingSocket {
     ERROR, // Hit errors when writing the bytes.
   };
   /**
-   * Writes a serialized buffer into the socket.
+   * Writes a serialized buffer into the socket. @param bytes_without_copy is
+   * the number of bytes of the buffer that reference buffers of the message,
+   * see Message::serialize().
    * @returns SendStatus based on the status of the write.
    */
-  SendStatus sendBuffer(std::unique_ptr<folly::IOBuf>&& buffer_chain);
+  SendStatus sendBuffer(std::unique_ptr<folly::IOBuf>&& buffer_chain,
+                        size_t bytes_without_copy = 0);
+
+  /**
+   * Copies a small unchained @param buffer into the tailroom of the last
+   * buffer of sendChain_, so that it doesn't take an iovec of its own when
+   * the batch is written.
+   *
+   * @return  true if the buffer was copied, false if it needs to be chained.
+   */
+  bool coalesceIntoSendChain(const folly::IOBuf& buffer);
+
+  /**
+   * Accounts the bytes of a serialized message of @param msglen bytes that
+   * were copied when serializing it, and the @param zero_copy bytes that
+   * reference buffers of the message, e.g. payloads, and are written without
+   * copying. Decides whether the batch should be written with MSG_ZEROCOPY.
+   */
+  void noteBytesSerialized(size_t msglen, size_t zero_copy);
+
   /**
    * For asyncsocket based connections, to batch data better we schedule a zero
    * timeout event in sendBuffer. It allows to batch all the data going to same
@@ -681,7 +702,8 @@ class Connection : public TrafficShappingSocket {
    * @return serialized buffer if no errors, returns a nullptr otherwise. err
    *         contains the actual reason.
    */
-  std::unique_ptr<folly::IOBuf> serializeMessage(const Message& msg);
+  std::unique_ptr<folly::IOBuf>
+  serializeMessage(const Message& msg, size_t* bytes_without_copy = nullptr);
 
   /**
    * Invoked by connect() to initiate the connection to peer.
@@ -876,6 +898,12 @@ class Connection : public TrafficShappingSocket {
   // Total number of bytes received since this socket was created.
   size_t num_bytes_received_;
 
+  // Total number of bytes sent since this socket was created that were copied
+  // when serializing messages, and that were written from buffers of the
+  // messages, e.g. payloads, see ProtocolWriter::writeWithoutCopy().
+  size_t num_bytes_sent_copied_{0};
+  size_t num_bytes_sent_zero_copy_{0};
+
   // Set of stats that are are used to detect low socket performance.
   struct HealthStats {
     void clear() {
@@ -963,6 +991,16 @@ class Connection : public TrafficShappingSocket {
   // callback of this timer add data into the asyncsocket.
   EvTimer sched_write_chain_;
 
+  // True if sendChain_ contains a message that references at least
+  // --socket-zero-copy-threshold bytes of its buffers and should be written
+  // with MSG_ZEROCOPY.
+  bool send_chain_zero_copy_{false};
+
+  // Whether SO_ZEROCOPY was enabled on the socket. It is enabled on the first
+  // write that needs it, if the connection is not SSL.
+  enum class ZeroCopyState : uint8_t { UNKNOWN, ENABLED, UNSUPPORTED };
+  ZeroCopyState zero_copy_state_{ZeroCopyState::UNKNOWN};
+
   // Used to note down delays in writing into the asyncsocket.
   SteadyTimestamp sched_start_time_;
 
@@ -7,13 +7,68 @@
  */
 #include "logdevice/common/EpochMetaDataCache.h"
 
+#include <algorithm>
+
+#include <folly/hash/Hash.h>
+
 namespace facebook { namespace logdevice {
 
-EpochMetaDataCache::EpochMetaDataCache(size_t max_entries)
-    : cache_(max_entries) {
+constexpr size_t EpochMetaDataCache::DEFAULT_NUM_SHARDS;
+
+namespace {
+size_t divideRoundUp(size_t a, size_t b) {
+  return (a + b - 1) / b;
+}
+} // namespace
+
+EpochMetaDataCache::EpochMetaDataCache(size_t max_entries,
+                                       size_t max_bytes,
+                                       size_t num_shards)
+    : num_shards_(std::max<size_t>(1, std::min(num_shards, max_entries))),
+      max_entries_per_shard_(divideRoundUp(max_entries, num_shards_)),
+      max_bytes_per_shard_(divideRoundUp(max_bytes, num_shards_)),
+      shards_(new Shard[num_shards_]) {
   ld_check(max_entries > 0);
 }
 
+EpochMetaDataCache::Shard& EpochMetaDataCache::getShard(logid_t logid) const {
+  return shards_[folly::hash::twang_mix64(logid.val_) % num_shards_];
+}
+
+/* static */
+const EpochMetaDataCache::Entry*
+EpochMetaDataCache::findEntry(const Shard& shard,
+                              logid_t logid,
+                              epoch_t epoch,
+                              bool require_consistent) {
+  auto log_it = shard.index.find(logid.val_);
+  if (log_it == shard.index.end()) {
+    return nullptr;
+  }
+  // the entry with the largest interval start <= epoch
+  const LogIndex& log_index = log_it->second;
+  auto it = log_index.upper_bound(epoch);
+  if (it == log_index.begin()) {
+    return nullptr;
+  }
+  --it;
+  const Entry& entry = *it->second;
+
+  // record in the cache must have a cached source
+  ld_check(MetaDataLogReader::isCachedSource(entry.source));
+  if (entry.source == RecordSource::CACHED_SOFT) {
+    if (require_consistent || entry.epoch != epoch) {
+      // require consistent data but only has soft one in cache, consider it as
+      // a miss. Soft entries are not trusted beyond the epoch they were
+      // read for.
+      return nullptr;
+    }
+  } else if (epoch > entry.until) {
+    return nullptr;
+  }
+  return &entry;
+}
+
 bool EpochMetaDataCache::getMetaData(logid_t logid,
                                      epoch_t epoch,
                                      epoch_t* until_out,
@@ -23,23 +78,21 @@ bool EpochMetaDataCache::getMetaData(logid_t logid,
   ld_check(until_out != nullptr);
   ld_check(metadata_out != nullptr);
   ld_check(source_out != nullptr);
-  folly::SharedMutex::WriteHolder write_guard(cache_mutex_);
-  auto it = cache_.find(std::make_pair(logid, epoch));
-  if (it == cache_.end()) {
-    return false;
-  }
 
-  // record in the cache must have a cached source
-  ld_check(MetaDataLogReader::isCachedSource(it->second.source));
-  if (require_consistent && it->second.source == RecordSource::CACHED_SOFT) {
-    // require consistent data but only has soft one in cache, consider it as
-    // a miss
+  Shard& shard = getShard(logid);
+  folly::SharedMutex::ReadHolder read_guard(shard.mutex);
+  const Entry* entry = findEntry(shard, logid, epoch, require_consistent);
+  if (entry == nullptr) {
     return false;
   }
+  // Only write the cache line if the bit is not already set.
+  if (!entry->referenced.load(std::memory_order_relaxed)) {
+    entry->referenced.store(true, std::memory_order_relaxed);
+  }
 
-  *until_out = it->second.until;
-  *source_out = it->second.source;
-  *metadata_out = it->second.metadata;
+  *until_out = entry->until;
+  *source_out = entry->source;
+  *metadata_out = entry->metadata;
   return true;
 }
 
@@ -53,20 +106,15 @@ bool EpochMetaDataCache::getMetaDataNoPromotion(logid_t logid,
   ld_check(metadata_out != nullptr);
   ld_check(source_out != nullptr);
 
-  // using read locks here since the cache is immutable
-  folly::SharedMutex::ReadHolder read_guard(cache_mutex_);
-  auto it = cache_.findWithoutPromotion(std::make_pair(logid, epoch));
-  if (it == cache_.end()) {
+  const Shard& shard = getShard(logid);
+  folly::SharedMutex::ReadHolder read_guard(shard.mutex);
+  const Entry* entry = findEntry(shard, logid, epoch, require_consistent);
+  if (entry == nullptr) {
     return false;
   }
-
-  ld_check(MetaDataLogReader::isCachedSource(it->second.source));
-  if (require_consistent && it->second.source == RecordSource::CACHED_SOFT) {
-    return false;
-  }
-  *until_out = it->second.until;
-  *source_out = it->second.source;
-  *metadata_out = it->second.metadata;
+  *until_out = entry->until;
+  *source_out = entry->source;
+  *metadata_out = entry->metadata;
   return true;
 }
 
@@ -84,17 +132,94 @@ void EpochMetaDataCache::setMetaData(logid_t logid,
     ld_check(false);
     return;
   }
+  ld_check(until >= epoch);
 
-  folly::SharedMutex::WriteHolder write_guard(cache_mutex_);
-  auto it = cache_.findWithoutPromotion(std::make_pair(logid, epoch));
-  if (it != cache_.end() &&
-      it->second.source == RecordSource::CACHED_CONSISTENT &&
-      source == RecordSource::CACHED_SOFT) {
-    // do not overwrite an existing consistent record with a soft one
-    return;
+  Shard& shard = getShard(logid);
+  folly::SharedMutex::WriteHolder write_guard(shard.mutex);
+  LogIndex& log_index = shard.index[logid.val_];
+  auto it = log_index.find(epoch);
+  if (it != log_index.end()) {
+    Entry& entry = *it->second;
+    if (entry.source == RecordSource::CACHED_CONSISTENT &&
+        source == RecordSource::CACHED_SOFT) {
+      // do not overwrite an existing consistent record with a soft one
+      return;
+    }
+    shard.bytes -= entry.bytes;
+    entry.until = until;
+    entry.source = source;
+    entry.metadata = metadata;
+    entry.bytes = estimateBytes(metadata);
+    shard.bytes += entry.bytes;
+  } else {
+    // New entries go right behind the hand, i.e. they are the last ones the
+    // hand visits.
+    auto entry_it = shard.entries.emplace(
+        shard.hand, logid, epoch, until, source, metadata);
+    entry_it->bytes = estimateBytes(metadata);
+    shard.bytes += entry_it->bytes;
+    log_index.emplace(epoch, entry_it);
   }
+  evict(shard);
+}
 
-  cache_.set(std::make_pair(logid, epoch), {until, source, metadata});
+void EpochMetaDataCache::evict(Shard& shard) {
+  auto over_limit = [&] {
+    return shard.entries.size() > max_entries_per_shard_ ||
+        (max_bytes_per_shard_ > 0 && shard.bytes > max_bytes_per_shard_);
+  };
+  // Each entry is visited at most twice: once to clear its bit, once to
+  // evict it. Always keep the most recent entry even if it alone exceeds the
+  // byte limit.
+  while (over_limit() && shard.entries.size() > 1) {
+    if (shard.hand == shard.entries.end()) {
+      shard.hand = shard.entries.begin();
+    }
+    if (shard.hand->referenced.load(std::memory_order_relaxed)) {
+      shard.hand->referenced.store(false, std::memory_order_relaxed);
+      ++shard.hand;
+    } else {
+      erase(shard, shard.hand++);
+    }
+  }
+}
+
+void EpochMetaDataCache::erase(Shard& shard, EntryList::iterator it) {
+  auto log_it = shard.index.find(it->logid.val_);
+  ld_check(log_it != shard.index.end());
+  log_it->second.erase(it->epoch);
+  if (log_it->second.empty()) {
+    shard.index.erase(log_it);
+  }
+  shard.bytes -= it->bytes;
+  shard.entries.erase(it);
+}
+
+/* static */
+size_t EpochMetaDataCache::estimateBytes(const EpochMetaData& metadata) {
+  // The entry itself, its node in the clock list and in the log's index map,
+  // plus the heap-allocated parts of the metadata.
+  return sizeof(Entry) + 4 * sizeof(void*) + sizeof(LogIndex::value_type) +
+      metadata.shards.size() * sizeof(ShardID) +
+      metadata.weights.size() * sizeof(double);
+}
+
+size_t EpochMetaDataCache::numEntries() const {
+  size_t total = 0;
+  for (size_t i = 0; i < num_shards_; ++i) {
+    folly::SharedMutex::ReadHolder read_guard(shards_[i].mutex);
+    total += shards_[i].entries.size();
+  }
+  return total;
+}
+
+size_t EpochMetaDataCache::memoryUsage() const {
+  size_t total = 0;
+  for (size_t i = 0; i < num_shards_; ++i) {
+    folly::SharedMutex::ReadHolder read_guard(shards_[i].mutex);
+    total += shards_[i].bytes;
+  }
+  return total;
 }
 
 }} // namespace facebook::logdevice
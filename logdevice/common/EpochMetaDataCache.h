@@ -7,12 +7,15 @@
  */
 #pragma once
 
+#include <atomic>
+#include <list>
+#include <map>
+#include <memory>
+#include <unordered_map>
 #include <utility>
 
 #include <boost/noncopyable.hpp>
 #include <folly/SharedMutex.h>
-#include <folly/container/EvictingCacheMap.h>
-#include <folly/hash/Hash.h>
 
 #include "logdevice/common/EpochMetaData.h"
 #include "logdevice/common/MetaDataLogReader.h"
@@ -21,9 +24,11 @@ namespace facebook { namespace logdevice {
 
 /**
  *  EpochMetaDataCache caches epoch metadata results read from metadata logs.
- *  The key for finding an item in the cache is a pair of <logid_t, epoch_t>,
- *  and the value of stored consists of the EpochMetaData and the `until' epoch
- *  to which the metadata remains effective.
+ *  An entry is an epoch interval [epoch, until] of a log along with the
+ *  EpochMetaData effective for all epochs in the interval, as delivered by
+ *  MetaDataLogReader. A lookup for any epoch inside the interval of a
+ *  CACHED_CONSISTENT entry is a hit. CACHED_SOFT entries only match the exact
+ *  epoch they were stored for.
  *  Note that users of the cache must make sure the following guarantees:
  *      1) the epoch metadata put in the cache must be `authentic' for the
  *         requested epoch. Specifically, the epoch metadata must be read from
@@ -35,13 +40,12 @@ namespace facebook { namespace logdevice {
  *         information is needed, users should not read from the cache but read
  *         directly from metadata logs instead.
  *
- *  The cache is meant to be shared among all worker threads and is proteceted
- *  by locks.
- *
- * TODO: write our own LRU cache implementation that supports:
- *       1) epoch interval ranged looked up
- *       2) finer grained locking
- *       3) reduce write frequency by rate limiting promotions
+ *  The cache is meant to be shared among all worker threads. It is split in
+ *  shards by log id, each with its own lock. Lookups only take the shard lock
+ *  in shared mode: eviction uses the CLOCK approximation of LRU, so a hit
+ *  only sets a `referenced' bit on the entry (and only if it is not set
+ *  already) instead of moving it in a list. Each shard is bounded both in
+ *  number of entries and in (estimated) bytes.
  */
 
 class EpochMetaData;
@@ -50,14 +54,24 @@ class EpochMetaDataCache : boost::noncopyable {
  public:
   using RecordSource = MetaDataLogReader::RecordSource;
 
-  // create the cache with maximum entry size of @param max_entries
-  explicit EpochMetaDataCache(size_t max_entries);
+  static constexpr size_t DEFAULT_NUM_SHARDS = 16;
+
+  /**
+   * @param max_entries  maximum number of entries in the cache
+   * @param max_bytes    maximum estimated memory used by the entries, 0 for
+   *                     no limit
+   * @param num_shards   number of independently locked shards; each gets an
+   *                     equal part of the limits above
+   */
+  explicit EpochMetaDataCache(size_t max_entries,
+                              size_t max_bytes = 0,
+                              size_t num_shards = DEFAULT_NUM_SHARDS);
 
   // Given logid and epoch, search the epoch metadata in the cache.
   // @return       true if there is a cache hit, and results (metadata and
   //               until epoch) will be written into @param metadata_out and
   //               @param until_out, respectively. The entry will also be
-  //               promoted in the LRU list
+  //               marked as recently used
   bool getMetaData(logid_t logid,
                    epoch_t epoch,
                    epoch_t* until_out,
@@ -65,7 +79,7 @@ class EpochMetaDataCache : boost::noncopyable {
                    RecordSource* source_out,
                    bool require_consistent = true);
 
-  // same as getMetaData() but do not promote the entry if found
+  // same as getMetaData() but do not mark the entry as recently used
   bool getMetaDataNoPromotion(logid_t logid,
                               epoch_t epoch,
                               epoch_t* until_out,
@@ -73,34 +87,77 @@ class EpochMetaDataCache : boost::noncopyable {
                               RecordSource* source_out,
                               bool require_consistent = true) const;
 
-  // put an entry with epoch metadata and until epoch into the cache
+  // put an entry with epoch metadata for the interval [epoch, until] into the
+  // cache
   void setMetaData(logid_t logid,
                    epoch_t epoch,
                    epoch_t until,
                    RecordSource source,
                    const EpochMetaData& metadata);
 
- private:
-  using Key = std::pair<logid_t, epoch_t>;
-
-  struct KeyHasher {
-    size_t operator()(const EpochMetaDataCache::Key& key) const {
-      return folly::hash::hash_combine(key.first.val_, key.second.val_);
-    }
-  };
+  // Number of entries and their estimated memory usage, summed over shards.
+  size_t numEntries() const;
+  size_t memoryUsage() const;
 
-  struct Value {
+ private:
+  struct Entry {
+    Entry(logid_t logid,
+          epoch_t epoch,
+          epoch_t until,
+          RecordSource source,
+          const EpochMetaData& metadata)
+        : logid(logid),
+          epoch(epoch),
+          until(until),
+          source(source),
+          metadata(metadata) {}
+
+    const logid_t logid;
+    const epoch_t epoch;
     epoch_t until;
     RecordSource source;
     EpochMetaData metadata;
+    size_t bytes{0};
+    // Set on lookup, cleared by the clock hand. Entries found with the bit
+    // cleared are evicted.
+    mutable std::atomic<bool> referenced{false};
   };
 
-  // the internal LRU cache
-  using LRUCache = folly::EvictingCacheMap<Key, Value, KeyHasher>;
-  LRUCache cache_;
+  using EntryList = std::list<Entry>;
+  // interval start -> entry, for a single log
+  using LogIndex = std::map<epoch_t, EntryList::iterator>;
+
+  struct Shard {
+    mutable folly::SharedMutex mutex;
+    // All entries of the shard, in clock order.
+    EntryList entries;
+    EntryList::iterator hand{entries.end()};
+    // log id -> entries of the log
+    std::unordered_map<logid_t::raw_type, LogIndex> index;
+    size_t bytes{0};
+  };
+
+  // Returns the entry that covers `epoch` for the log, or nullptr. Requires
+  // the shard lock to be held.
+  static const Entry* findEntry(const Shard& shard,
+                                logid_t logid,
+                                epoch_t epoch,
+                                bool require_consistent);
+
+  static size_t estimateBytes(const EpochMetaData& metadata);
+
+  // Evicts entries until the shard fits its limits. Requires the shard lock
+  // to be held exclusively.
+  void evict(Shard& shard);
+
+  void erase(Shard& shard, EntryList::iterator it);
+
+  Shard& getShard(logid_t logid) const;
 
-  // protect the access to lru_cache_
-  folly::SharedMutex cache_mutex_;
+  const size_t num_shards_;
+  const size_t max_entries_per_shard_;
+  const size_t max_bytes_per_shard_;
+  std::unique_ptr<Shard[]> shards_;
 };
 
 }} // namespace facebook::logdevice
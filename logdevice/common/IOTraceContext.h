@@ -0,0 +1,37 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @file Reasons for local log store IO that IO tracing aggregates latencies
+ *       by, see IOTracing. In common/ so that stats code can pull it in.
+ */
+
+namespace facebook { namespace logdevice {
+
+enum class IOTraceContext : uint8_t {
+#define IO_TRACE_CONTEXT(name, _) name,
+#include "logdevice/common/io_trace_contexts.inc"
+  MAX
+};
+
+inline const char* ioTraceContextName(IOTraceContext context) {
+  switch (context) {
+#define IO_TRACE_CONTEXT(name, str) \
+  case IOTraceContext::name:        \
+    return str;
+#include "logdevice/common/io_trace_contexts.inc"
+    case IOTraceContext::MAX:
+      break;
+  }
+  return "invalid";
+}
+
+}} // namespace facebook::logdevice
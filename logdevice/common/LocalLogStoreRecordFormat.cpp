@@ -8,6 +8,8 @@
 #define __STDC_FORMAT_MACROS // pull in PRIu64 etc
 #include "logdevice/common/LocalLogStoreRecordFormat.h"
 
+#include <limits>
+
 #include <folly/Range.h>
 #include <folly/Varint.h>
 #include <folly/hash/Hash.h>
@@ -254,8 +256,9 @@ Slice formCopySetIndexEntry(uint32_t wave,
                             const ShardID* copyset,
                             const copyset_size_t copyset_size,
                             const folly::Optional<lsn_t>& block_starting_lsn,
-                            const csi_flags_t flags,
-                            std::string* buf) {
+                            csi_flags_t flags,
+                            std::string* buf,
+                            folly::StringPiece filterable_key) {
   buf->clear();
 
   if (!block_starting_lsn.has_value()) {
@@ -267,9 +270,19 @@ Slice formCopySetIndexEntry(uint32_t wave,
   ld_check(block_starting_lsn.has_value());
   ld_check_eq(block_starting_lsn.value(), LSN_INVALID);
   // TODO: block entry support (t9002309), will use the block starting lsn then
+  // Keys that don't fit are left out; filtering then reads the record.
+  const uint16_t key_length =
+      filterable_key.size() <= std::numeric_limits<uint16_t>::max()
+      ? filterable_key.size()
+      : 0;
+  flags &= ~CSI_FLAG_FILTERABLE_KEY;
+  flags |= key_length > 0 ? CSI_FLAG_FILTERABLE_KEY : 0;
   size_t nbytes = sizeof(wave) + sizeof(flags) + sizeof(copyset_size) +
       copyset_size *
           (flags & CSI_FLAG_SHARD_ID ? sizeof(ShardID) : sizeof(node_index_t));
+  if (flags & CSI_FLAG_FILTERABLE_KEY) {
+    nbytes += sizeof(key_length) + key_length;
+  }
   buf->reserve(nbytes);
 
   APPEND_TO_STRING(buf, wave);
@@ -285,6 +298,10 @@ Slice formCopySetIndexEntry(uint32_t wave,
       APPEND_TO_STRING(buf, nid);
     }
   }
+  if (flags & CSI_FLAG_FILTERABLE_KEY) {
+    APPEND_TO_STRING(buf, key_length);
+    buf->append(filterable_key.data(), key_length);
+  }
 
   // Check that we'd reserved the right number of bytes
   ld_check(buf->size() == nbytes);
@@ -299,7 +316,8 @@ Slice formCopySetIndexEntry(const STORE_Header& store_header,
                             const StoreChainLink* chainlink,
                             const folly::Optional<lsn_t>& block_starting_lsn,
                             bool shard_id_in_copyset,
-                            std::string* buf) {
+                            std::string* buf,
+                            folly::StringPiece filterable_key) {
   uint32_t wave = getRecordWaveOrRecoveryEpoch(store_header, store_extra);
   csi_flags_t flags = formCopySetIndexFlags(store_header, shard_id_in_copyset);
 
@@ -312,7 +330,8 @@ Slice formCopySetIndexEntry(const STORE_Header& store_header,
                                store_header.copyset_size,
                                block_starting_lsn,
                                flags,
-                               buf);
+                               buf,
+                               filterable_key);
 }
 
 #define READ_FROM_SLICE(slice, offset, thing)                           \
@@ -368,10 +387,14 @@ bool parseCopySetIndexSingleEntry(const Slice& cs_dir_slice,
                                   std::vector<ShardID>* copyset,
                                   uint32_t* wave,
                                   csi_flags_t* flags,
-                                  shard_index_t this_shard) {
+                                  shard_index_t this_shard,
+                                  folly::StringPiece* filterable_key) {
   if (copyset) {
     copyset->clear();
   }
+  if (filterable_key) {
+    filterable_key->clear();
+  }
   if (wave) {
     *wave = 0;
   }
@@ -419,6 +442,22 @@ bool parseCopySetIndexSingleEntry(const Slice& cs_dir_slice,
         copyset_size;
   }
 
+  if (_flags & CSI_FLAG_FILTERABLE_KEY) {
+    uint16_t key_length;
+    READ_FROM_SLICE(cs_dir_slice, offset, key_length);
+    if (!dd_assert(offset + key_length <= cs_dir_slice.size,
+                   "Truncated filterable key in copyset index entry: %s",
+                   hexdump_buf(cs_dir_slice, 200).c_str())) {
+      err = E::MALFORMED_RECORD;
+      return false;
+    }
+    if (filterable_key) {
+      *filterable_key = folly::StringPiece(
+          static_cast<const char*>(cs_dir_slice.data) + offset, key_length);
+    }
+    offset += key_length;
+  }
+
   // Check that we'd calculated the right number of bytes
   return dd_assert(offset <= cs_dir_slice.size,
                    "Unexpected CSI Entry size. Expected at least %s bytes. "
@@ -1023,6 +1062,7 @@ std::string csiFlagsToString(csi_flags_t flags) {
   FLAG(SHARD_ID)
   FLAG(HOLE)
   FLAG(DRAINED)
+  FLAG(FILTERABLE_KEY)
 
 #undef FLAG
 
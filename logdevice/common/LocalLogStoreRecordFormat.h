@@ -49,6 +49,9 @@
  *   [1 byte]  flags. is_hole and written by rebuilding
  *   [1 byte]  copyset size
  *   [N * 2 bytes]  node_index_t for each of the N nodes in copyset
+ *   If CSI_FLAG_FILTERABLE_KEY is set:
+ *     [2 bytes]       length K of the record's KeyType::FILTERABLE key
+ *     [K bytes]       the key
  *
  * All integers are in host byte order, assumed to be little endian.
  */
@@ -181,6 +184,10 @@ const csi_flags_t CSI_FLAG_SHARD_ID = (unsigned)1 << 2;
 // written by recovery
 const csi_flags_t CSI_FLAG_WRITTEN_BY_RECOVERY = (unsigned)1 << 3;
 
+// entry is followed by the record's KeyType::FILTERABLE key, which lets
+// server-side filtering skip records without reading them
+const csi_flags_t CSI_FLAG_FILTERABLE_KEY = (unsigned)1 << 4;
+
 // record represents a plug for a hole in the numbering sequence
 const csi_flags_t CSI_FLAG_HOLE = (unsigned)1 << 6;
 
@@ -287,6 +294,8 @@ flags_t copySetIndexFlagsToRecordFlags(csi_flags_t flags);
  * @param block_starting_lsn LSN where the block starts, also in
  *                           STORE_Message
  * @param buf                std::string to use as storage
+ * @param filterable_key     if non-empty, appended to the entry and
+ *                           CSI_FLAG_FILTERABLE_KEY is set in its flags
  *
  * @return Slice pointing into supplied std::string
  */
@@ -295,7 +304,8 @@ Slice formCopySetIndexEntry(uint32_t wave,
                             const copyset_size_t copyset_size,
                             const folly::Optional<lsn_t>& block_starting_lsn,
                             const csi_flags_t csi_flags,
-                            std::string* buf);
+                            std::string* buf,
+                            folly::StringPiece filterable_key = {});
 
 /**
  * Forms the copyset index entry for the record. This entry will contain
@@ -306,6 +316,7 @@ Slice formCopySetIndexEntry(uint32_t wave,
  * @param copyset             copy set, also in STORE_Message
  * @param block_starting_lsn  LSN where the block starts, also in STORE_Message
  * @param buf                 std::string to use as storage
+ * @param filterable_key      see above
  *
  * @return Slice pointing into supplied std::string
  */
@@ -314,7 +325,8 @@ Slice formCopySetIndexEntry(const STORE_Header& store_header,
                             const StoreChainLink* copyset,
                             const folly::Optional<lsn_t>& block_starting_lsn,
                             bool shard_id_in_copyset,
-                            std::string* buf);
+                            std::string* buf,
+                            folly::StringPiece filterable_key = {});
 
 /**
  * Parses the single copyset index entry blob as read from the local log store.
@@ -331,6 +343,10 @@ Slice formCopySetIndexEntry(const STORE_Header& store_header,
  *              --write-shard-id-in-copyset for more than the total retention
  *              period and after all internal logs have been snapshotted.
  *
+ * `filterable_key` is set to the key stored in the entry if it has
+ *                  CSI_FLAG_FILTERABLE_KEY, and to an empty range otherwise.
+ *                  Points into `cs_dir_slice`.
+ *
  * @return On success, returns true.  On failure, returns false and sets err to:
  *           MALFORMED_RECORD  parse error
  */
@@ -338,7 +354,8 @@ bool parseCopySetIndexSingleEntry(const Slice& cs_dir_slice,
                                   std::vector<ShardID>* copyset,
                                   uint32_t* wave,
                                   csi_flags_t* csi_flags,
-                                  shard_index_t this_shard);
+                                  shard_index_t this_shard,
+                                  folly::StringPiece* filterable_key = nullptr);
 
 /**
  * Parses the record blob as read from the local log store. The blob is
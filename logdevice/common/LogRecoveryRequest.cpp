@@ -18,6 +18,7 @@
 #include "logdevice/common/LogIDUniqueQueue.h"
 #include "logdevice/common/MetaDataLogWriter.h"
 #include "logdevice/common/Processor.h"
+#include "logdevice/common/SealBatcher.h"
 #include "logdevice/common/Sequencer.h"
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/settings/Settings.h"
@@ -1081,9 +1082,14 @@ int LogRecoveryRequest::sendSeal(ShardID shard) {
   SEAL_Header header = *seal_header_;
   header.shard = shard.shard();
 
+  Worker* worker = Worker::onThisThread();
+  const NodeID to(shard.node());
+  if (worker->sealBatcher().add(header, to, socket_cb)) {
+    return 0;
+  }
+
   auto msg = std::make_unique<SEAL_Message>(header);
-  return Worker::onThisThread()->sender().sendMessage(
-      std::move(msg), NodeID(shard.node()), &socket_cb);
+  return worker->sender().sendMessage(std::move(msg), to, &socket_cb);
 }
 
 void LogRecoveryRequest::onSealReply(ShardID from,
@@ -377,9 +377,17 @@ int decodeMetadata(PayloadKey key,
 size_t PayloadGroupCodec::decode(Slice binary,
                                  std::vector<PayloadGroup>& payload_groups_out,
                                  bool allow_buffer_sharing) {
+  const folly::IOBuf iobuf =
+      folly::IOBuf::wrapBufferAsValue(binary.data, binary.size);
+  return decode(iobuf, payload_groups_out, allow_buffer_sharing);
+}
+
+size_t PayloadGroupCodec::decode(const folly::IOBuf& binary,
+                                 std::vector<PayloadGroup>& payload_groups_out,
+                                 bool allow_buffer_sharing) {
   thrift::CompressedPayloadGroups compressed_payload_groups;
   const size_t deserialized_size = ThriftCodec::deserialize<ThriftSerializer>(
-      binary,
+      &binary,
       compressed_payload_groups,
       apache::thrift::ExternalBufferSharing::SHARE_EXTERNAL_BUFFER);
   if (deserialized_size == 0) {
@@ -141,6 +141,15 @@ class PayloadGroupCodec {
                        std::vector<PayloadGroup>& payload_groups_out,
                        bool allow_buffer_sharing);
 
+  /**
+   * Same as above, but decodes from a (possibly chained) IOBuf. If binary is
+   * managed, uncompressed payloads share its buffers instead of being copied.
+   */
+  FOLLY_NODISCARD
+  static size_t decode(const folly::IOBuf& binary,
+                       std::vector<PayloadGroup>& payload_groups_out,
+                       bool allow_buffer_sharing);
+
   /**
    * Decodes compressed representation of payload groups batch.
    * Returns number of bytes consumed, or 0 in case of error.
@@ -312,6 +312,7 @@ int ReaderImpl::startReadingImpl(logid_t log_id,
       nullptr);
 
   deps->setReaderName(reader_name_);
+  deps->setBufferBudget(buffer_budget_);
 
   auto read_stream = std::make_unique<ClientReadStream>(
       rsid,
@@ -319,7 +320,9 @@ int ReaderImpl::startReadingImpl(logid_t log_id,
       from,
       until,
       settings->client_read_flow_control_threshold,
-      buffer_type_,
+      // A circular buffer allocates all its slots upfront; with a shared
+      // budget, only pay for the records actually buffered.
+      buffer_budget_ ? ClientReadStreamBufferType::ORDERED_MAP : buffer_type_,
       read_buffer_size_,
       std::move(deps),
       processor_->config_,
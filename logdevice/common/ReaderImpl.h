@@ -33,6 +33,7 @@
 
 namespace facebook { namespace logdevice {
 
+class ClientReadStreamBufferBudget;
 class Processor;
 class ReaderBridgeImpl;
 
@@ -109,6 +110,12 @@ class ReaderImpl : public Reader {
     buffer_type_ = buffer_type;
   }
 
+  // make read streams draw their windows from a budget shared with other
+  // readers of the client; must outlive the reader
+  void setBufferBudget(ClientReadStreamBufferBudget* buffer_budget) {
+    buffer_budget_ = buffer_budget;
+  }
+
  protected: // tests can override
   virtual int startReadingImpl(logid_t log_id,
                                lsn_t from,
@@ -192,6 +199,9 @@ class ReaderImpl : public Reader {
   // linear buffer
   ClientReadStreamBufferType buffer_type_{ClientReadStreamBufferType::CIRCULAR};
 
+  // see setBufferBudget()
+  ClientReadStreamBufferBudget* buffer_budget_{nullptr};
+
   /**
    * This gets put on the MPMCQueue when ClientReadStream sends us something.
    * Each entry wraps either a DataRecord or a GapRecord.
@@ -0,0 +1,133 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/SealBatcher.h"
+
+#include <algorithm>
+
+#include "logdevice/common/Address.h"
+#include "logdevice/common/ConnectionInfo.h"
+#include "logdevice/common/Sender.h"
+#include "logdevice/common/Worker.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/common/protocol/Compatibility.h"
+#include "logdevice/common/protocol/SEAL_BATCH_Message.h"
+#include "logdevice/common/settings/Settings.h"
+#include "logdevice/common/stats/Stats.h"
+
+namespace facebook { namespace logdevice {
+
+bool SealBatcher::add(const SEAL_Header& header,
+                      NodeID to,
+                      SocketCallback& on_close) {
+  if (Worker::settings().seal_batch_max_logs == 0 ||
+      knownNotToSupportBatches(to)) {
+    return false;
+  }
+
+  Sender& sender = Worker::onThisThread()->sender();
+  if (!sender.getConnectionInfo(Address(to))) {
+    // No connection yet, e.g. right after this sequencer node started.
+    // Start connecting, so that there is a connection to register on_close
+    // with; the SEALs queued meanwhile are sent once it's handshaken.
+    if (sender.connect(to.index()) != 0 && err != E::ALREADY &&
+        err != E::ISCONN) {
+      return false;
+    }
+  }
+  if (sender.registerOnConnectionClosed(Address(to), on_close) != 0) {
+    return false;
+  }
+
+  PendingSEALs& pending = seals_[to.index()];
+  pending.to = to;
+  pending.headers.push_back(header);
+  activateFlushTimer();
+  return true;
+}
+
+void SealBatcher::onBatchNotSupported(const std::vector<SEAL_Header>& headers,
+                                      NodeID to) {
+  PendingSEALs& pending = unbatched_[to.index()];
+  pending.to = to;
+  pending.headers.insert(pending.headers.end(), headers.begin(), headers.end());
+  activateFlushTimer();
+}
+
+bool SealBatcher::knownNotToSupportBatches(NodeID to) {
+  const ConnectionInfo* info =
+      Worker::onThisThread()->sender().getConnectionInfo(Address(to));
+  return info && info->protocol.has_value() &&
+      info->protocol.value() < Compatibility::SEAL_BATCH_SUPPORT;
+}
+
+void SealBatcher::flush() {
+  // Failures to send are reported to recoveries right away, which may retry
+  // and get back here. Those SEALs will go out on the next flush.
+  auto seals = std::move(seals_);
+  seals_.clear();
+  auto unbatched = std::move(unbatched_);
+  unbatched_.clear();
+  for (auto& kv : unbatched) {
+    send(std::move(kv.second), /*batch=*/false);
+  }
+  for (auto& kv : seals) {
+    send(std::move(kv.second), /*batch=*/true);
+  }
+}
+
+void SealBatcher::send(PendingSEALs pending, bool batch) {
+  Sender& sender = Worker::onThisThread()->sender();
+  const Address to(pending.to);
+  // The connection may have been handshaken with an older protocol since the
+  // SEALs were queued.
+  const size_t max_logs = !batch || knownNotToSupportBatches(pending.to)
+      ? 1
+      : std::max<size_t>(1, Worker::settings().seal_batch_max_logs);
+
+  auto& headers = pending.headers;
+  for (size_t begin = 0; begin < headers.size(); begin += max_logs) {
+    const size_t end = std::min(headers.size(), begin + max_logs);
+    if (end - begin == 1) {
+      if (sender.sendMessage(
+              std::make_unique<SEAL_Message>(headers[begin]), pending.to) !=
+          0) {
+        SEAL_Message::onSentCommon(headers[begin], err, to);
+      }
+      continue;
+    }
+
+    const size_t nseals = end - begin;
+    auto msg = std::make_unique<SEAL_BATCH_Message>(std::vector<SEAL_Header>(
+        headers.begin() + begin, headers.begin() + end));
+    if (sender.sendMessage(std::move(msg), pending.to) != 0) {
+      const Status st = err;
+      RATELIMIT_INFO(std::chrono::seconds(10),
+                     1,
+                     "Failed to send a SEAL_BATCH of %zu SEALs to %s: %s",
+                     nseals,
+                     Sender::describeConnection(to).c_str(),
+                     error_description(st));
+      // Let every recovery know, as if its SEAL had failed on its own.
+      msg->onSent(st, to);
+      continue;
+    }
+    WORKER_STAT_INCR(seal_batches_sent);
+    WORKER_STAT_ADD(seal_batch_seals, nseals);
+  }
+}
+
+void SealBatcher::activateFlushTimer() {
+  if (!flush_timer_) {
+    flush_timer_ = std::make_unique<Timer>([this] { flush(); });
+  }
+  if (!flush_timer_->isActive()) {
+    flush_timer_->activate(std::chrono::milliseconds::zero());
+  }
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,97 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "logdevice/common/NodeID.h"
+#include "logdevice/common/SocketCallback.h"
+#include "logdevice/common/Timer.h"
+#include "logdevice/common/protocol/SEAL_Message.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Per-Worker buffer that packs the SEALs log recoveries send to the same
+ *       storage node within one iteration of the Worker's event loop into
+ *       SEAL_BATCH messages. When a sequencer node fails, thousands of
+ *       sequencers are activated elsewhere and each of their recoveries seals
+ *       its log on every node of its nodeset; batching turns that into a few
+ *       messages per node, each sealed with a single local log store write.
+ *
+ *       SEALs are held until a zero-delay timer fires, then sent in batches of
+ *       up to --seal-batch-max-logs. A batch of one is sent as a plain SEAL.
+ *       Whether the node supports SEAL_BATCH is only known once the
+ *       connection to it is handshaken, which on a freshly started sequencer
+ *       node is after the first SEALs are queued. Until then SEAL_BATCH is
+ *       assumed to be supported; if it turns out not to be, the SEALs of the
+ *       batch are sent on their own on the next flush.
+ *       Other errors sending a SEAL_BATCH are reported to the recovery of
+ *       each log through SEAL_Message::onSentCommon(), which retries as usual.
+ */
+
+class SealBatcher {
+ public:
+  SealBatcher() = default;
+
+  SealBatcher(const SealBatcher&) = delete;
+  SealBatcher& operator=(const SealBatcher&) = delete;
+
+  /**
+   * Queues a SEAL for storage node @param to, connecting to the node if
+   * needed, and registers @param on_close with the connection, since the SEAL
+   * is sent without a callback.
+   *
+   * @return true if the SEAL was queued. false if batching is disabled, the
+   *         node is known not to support SEAL_BATCH, or there is no
+   *         connection to register @param on_close with, in which case the
+   *         caller sends the SEAL itself.
+   */
+  bool add(const SEAL_Header& header, NodeID to, SocketCallback& on_close);
+
+  /**
+   * Sends all queued SEALs.
+   */
+  void flush();
+
+  /**
+   * Called when @param headers could not be sent to @param to in a
+   * SEAL_BATCH because the node doesn't support it. Queues them again, to
+   * be sent as individual SEALs.
+   */
+  void onBatchNotSupported(const std::vector<SEAL_Header>& headers,
+                           NodeID to);
+
+ private:
+  struct PendingSEALs {
+    NodeID to;
+    std::vector<SEAL_Header> headers;
+  };
+
+  // Send the SEALs queued for one node, in batches of at most
+  // --seal-batch-max-logs, or one by one if @param batch is false or the
+  // node is known not to support SEAL_BATCH.
+  static void send(PendingSEALs pending, bool batch);
+
+  // Is the connection to @param to handshaken with a protocol older than
+  // SEAL_BATCH_SUPPORT?
+  static bool knownNotToSupportBatches(NodeID to);
+
+  void activateFlushTimer();
+
+  std::unordered_map<node_index_t, PendingSEALs> seals_;
+  // SEALs of batches the node didn't accept, to be sent one by one.
+  std::unordered_map<node_index_t, PendingSEALs> unbatched_;
+
+  // Created on first use since Timer needs the Worker's event base.
+  std::unique_ptr<Timer> flush_timer_;
+};
+
+}} // namespace facebook::logdevice
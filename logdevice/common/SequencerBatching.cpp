@@ -155,7 +155,11 @@ int append_batch(logid_t log_id,
     append_batch(log_id, context, std::move(batch), attributes, out);
     return 0;
   } else {
-    err = E::BADPAYLOAD;
+    // AGAIN means the batch is compressed with a ZSTD dictionary that is
+    // being fetched.
+    if (err != E::AGAIN) {
+      err = E::BADPAYLOAD;
+    }
     return -1;
   }
 }
@@ -205,7 +209,8 @@ int append_decoded_batch(logid_t log_id,
   // format, then result will also be in SINGLE_PAYLOADS format, compatible with
   // older clients.
   switch (format) {
-    case BufferedWriteCodec::Format::SINGLE_PAYLOADS: {
+    case BufferedWriteCodec::Format::SINGLE_PAYLOADS:
+    case BufferedWriteCodec::Format::SINGLE_PAYLOADS_ZSTD_DICT: {
       return append_batch<folly::IOBuf>(log_id,
                                         context,
                                         payload,
@@ -327,8 +332,9 @@ bool SequencerBatching::buffer(logid_t log_id,
   rv = prepare_batch(log_id, *appender, context, &appends);
 
   if (rv != 0) {
-    ld_check(err == E::BADPAYLOAD);
-    sendReply(*machine, err);
+    ld_check(err == E::BADPAYLOAD || err == E::AGAIN);
+    // The client retries the append once the dictionary is fetched.
+    sendReply(*machine, err == E::AGAIN ? E::SEQNOBUFS : err);
     return true;
   }
 
@@ -0,0 +1,248 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/StoreBatcher.h"
+
+#include <algorithm>
+
+#include "logdevice/common/Address.h"
+#include "logdevice/common/ConnectionInfo.h"
+#include "logdevice/common/Sender.h"
+#include "logdevice/common/Worker.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/common/protocol/Compatibility.h"
+#include "logdevice/common/protocol/STORED_BATCH_Message.h"
+#include "logdevice/common/protocol/STORED_Message.h"
+#include "logdevice/common/protocol/STORE_BATCH_Message.h"
+#include "logdevice/common/protocol/STORE_Message.h"
+#include "logdevice/common/settings/Settings.h"
+#include "logdevice/common/stats/Stats.h"
+
+namespace facebook { namespace logdevice {
+
+namespace {
+
+size_t estimateSize(const STORE_Message& msg) {
+  const STORE_Header& header = msg.getHeader();
+  size_t size =
+      sizeof(STORE_Header) + msg.getCopyset().size() * sizeof(StoreChainLink);
+  if (!(header.flags & STORE_Header::AMEND)) {
+    size += msg.getPayloadHolder()->size();
+  }
+  return size;
+}
+
+size_t estimateSize(const STORED_Message& /* msg */) {
+  return sizeof(STORED_Header);
+}
+
+// Splits @param messages into groups of at most @param max_bytes and calls
+// @param send with each group.
+template <typename MessageT, typename SendFn>
+void sendInGroups(std::vector<std::unique_ptr<MessageT>> messages,
+                  size_t max_bytes,
+                  SendFn&& send) {
+  std::vector<std::unique_ptr<MessageT>> group;
+  size_t group_bytes = 0;
+  for (auto& msg : messages) {
+    const size_t size = estimateSize(*msg);
+    if (!group.empty() && group_bytes + size > max_bytes) {
+      send(std::move(group));
+      group.clear();
+      group_bytes = 0;
+    }
+    group_bytes += size;
+    group.push_back(std::move(msg));
+  }
+  if (!group.empty()) {
+    send(std::move(group));
+  }
+}
+
+} // namespace
+
+bool StoreBatcher::addSTORE(std::unique_ptr<STORE_Message>& msg, NodeID to) {
+  ld_check(msg);
+  const size_t max_bytes = maxBatchBytes();
+  if (max_bytes == 0 || msg->tc_ != TrafficClass::APPEND) {
+    return false;
+  }
+  // Large STOREs have little to gain from sharing a frame.
+  if (estimateSize(*msg) * 2 > max_bytes) {
+    return false;
+  }
+  if (!peerSupportsBatches(Address(to))) {
+    return false;
+  }
+
+  PendingSTOREs& pending = stores_[to.index()];
+  pending.to = to;
+  pending.messages.push_back(std::move(msg));
+  activateFlushTimer();
+  return true;
+}
+
+bool StoreBatcher::addSTORED(std::unique_ptr<STORED_Message>& msg,
+                             ClientID to) {
+  ld_check(msg);
+  const size_t max_bytes = maxBatchBytes();
+  if (max_bytes == 0 || (msg->header_.flags & STORED_Header::REBUILDING) ||
+      !peerSupportsBatches(Address(to))) {
+    return false;
+  }
+
+  storeds_[to].push_back(std::move(msg));
+  activateFlushTimer();
+  return true;
+}
+
+void StoreBatcher::flush() {
+  // Failures to send are reported to Appenders right away, which may send
+  // new STOREs and get back here. Those will go out on the next flush.
+  auto stores = std::move(stores_);
+  stores_.clear();
+  auto storeds = std::move(storeds_);
+  storeds_.clear();
+
+  for (auto& kv : stores) {
+    sendSTOREs(std::move(kv.second));
+  }
+  for (auto& kv : storeds) {
+    sendSTOREDs(std::move(kv.second), kv.first);
+  }
+}
+
+void StoreBatcher::sendSTOREs(PendingSTOREs pending) {
+  const Address to(pending.to);
+
+  auto send = [&](STOREs stores) {
+    if (stores.size() == 1) {
+      std::unique_ptr<Message> msg = std::move(stores[0]);
+      if (sendMessage(msg, to) != 0) {
+        onSTORENotSent(static_cast<const STORE_Message&>(*msg), err, to);
+      }
+      return;
+    }
+
+    const size_t nstores = stores.size();
+    std::unique_ptr<Message> msg =
+        std::make_unique<STORE_BATCH_Message>(std::move(stores));
+    if (sendMessage(msg, to) != 0) {
+      const Status st = err;
+      RATELIMIT_INFO(std::chrono::seconds(10),
+                     1,
+                     "Failed to send a STORE_BATCH of %zu STOREs to %s: %s",
+                     nstores,
+                     Sender::describeConnection(to).c_str(),
+                     error_description(st));
+      // Let every Appender know, as if its STORE had failed on its own.
+      for (const auto& store :
+           static_cast<STORE_BATCH_Message&>(*msg).getStores()) {
+        onSTORENotSent(*store, st, to);
+      }
+      return;
+    }
+    WORKER_STAT_INCR(store_batches_sent);
+    WORKER_STAT_ADD(store_batch_stores, nstores);
+  };
+
+  sendInGroups(std::move(pending.messages), maxBatchBytes(), send);
+}
+
+void StoreBatcher::sendSTOREDs(STOREDs replies, ClientID to) {
+  auto send = [&](STOREDs group) {
+    const size_t nreplies = group.size();
+    std::unique_ptr<Message> msg;
+    if (nreplies == 1) {
+      msg = std::move(group[0]);
+    } else {
+      msg = std::make_unique<STORED_BATCH_Message>(std::move(group));
+    }
+    if (sendMessage(msg, Address(to)) != 0) {
+      // Same as when a single STORED can't be sent, the Appender will time
+      // out and retry.
+      RATELIMIT_INFO(std::chrono::seconds(10),
+                     1,
+                     "Failed to send %zu STORED replies to %s: %s",
+                     nreplies,
+                     Sender::describeConnection(Address(to)).c_str(),
+                     error_description(err));
+      return;
+    }
+    if (nreplies > 1) {
+      WORKER_STAT_INCR(stored_batches_sent);
+      WORKER_STAT_ADD(stored_batch_replies, nreplies);
+    }
+  };
+
+  sendInGroups(std::move(replies), maxBatchBytes(), send);
+}
+
+size_t StoreBatcher::maxBatchBytes() const {
+  // Leave room for what the size estimates above don't account for, e.g.
+  // optional keys and per-message length prefixes.
+  return std::min<size_t>(
+      Worker::settings().store_batch_max_bytes, Message::MAX_LEN / 2);
+}
+
+bool StoreBatcher::peerSupportsBatches(const Address& to) const {
+  const ConnectionInfo* info =
+      Worker::onThisThread()->sender().getConnectionInfo(to);
+  return info && info->protocol.has_value() &&
+      info->protocol.value() >= Compatibility::STORE_BATCH_SUPPORT;
+}
+
+int StoreBatcher::sendMessage(std::unique_ptr<Message>& msg,
+                              const Address& to) {
+  return Worker::onThisThread()->sender().sendMessage(std::move(msg), to);
+}
+
+void StoreBatcher::onSTORENotSent(const STORE_Message& msg,
+                                  Status st,
+                                  const Address& to) {
+  msg.onSentCommon(st, to);
+}
+
+void StoreBatcher::activateFlushTimer() {
+  if (!flush_timer_) {
+    flush_timer_ = std::make_unique<Timer>([this] { flush(); });
+  }
+  if (!flush_timer_->isActive()) {
+    flush_timer_->activate(std::chrono::milliseconds::zero());
+  }
+}
+
+int StoreBatchingSender::sendMessageImpl(std::unique_ptr<Message>&& msg,
+                                         const Address& addr,
+                                         BWAvailableCallback* on_bw_avail,
+                                         SocketCallback* onclose) {
+  if (Worker::settings().store_batch_max_bytes > 0 &&
+      msg->type_ == MessageType::STORE && msg->tc_ == TrafficClass::APPEND &&
+      on_bw_avail != nullptr && onclose == nullptr && addr.isNodeAddress()) {
+    // A batch is sent without a bandwidth callback, so check that traffic
+    // shaping lets this STORE through before queueing it. If it doesn't,
+    // on_bw_avail is registered and the caller defers the STORE as usual.
+    // Other errors are reported by the regular send below.
+    if (!canSendToImpl(addr, msg->tc_, *on_bw_avail)) {
+      if (err == E::CBREGISTERED) {
+        return -1;
+      }
+    } else {
+      std::unique_ptr<STORE_Message> store(
+          static_cast<STORE_Message*>(msg.release()));
+      if (Worker::onThisThread()->storeBatcher().addSTORE(
+              store, addr.asNodeID())) {
+        return 0;
+      }
+      msg = std::move(store);
+    }
+  }
+  return SenderProxy::sendMessageImpl(
+      std::move(msg), addr, on_bw_avail, onclose);
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,130 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "logdevice/common/ClientID.h"
+#include "logdevice/common/NodeID.h"
+#include "logdevice/common/Sender.h"
+#include "logdevice/common/Timer.h"
+
+namespace facebook { namespace logdevice {
+
+class STORED_Message;
+class STORE_Message;
+
+/**
+ * @file Per-Worker buffer that packs the STORE messages Appenders send to the
+ *       same storage node within one iteration of the Worker's event loop into
+ *       a single STORE_BATCH message, and the STORED replies a storage node
+ *       sends to the same sequencer into a single STORED_BATCH message. At
+ *       hundreds of thousands of appends per second each STORE is small, and
+ *       shaping, framing and dispatching them one by one dominates.
+ *
+ *       Messages are held until a zero-delay timer fires, i.e. after the
+ *       Worker is done with the events and requests it is currently
+ *       processing. They are then sent in batches of up to
+ *       --store-batch-max-bytes. A batch of one message is sent as is.
+ *
+ *       Appenders send STOREs through a StoreBatchingSender, which checks
+ *       traffic shaping before queueing them. Errors sending a STORE_BATCH
+ *       are reported to every STORE's Appender through
+ *       STORE_Message::onSentCommon(), like an asynchronous failure to send a
+ *       single STORE. Store timeouts and retries are unaffected.
+ */
+
+class StoreBatcher {
+ public:
+  StoreBatcher() = default;
+  virtual ~StoreBatcher() = default;
+
+  StoreBatcher(const StoreBatcher&) = delete;
+  StoreBatcher& operator=(const StoreBatcher&) = delete;
+
+  /**
+   * Queues a STORE sent by an Appender to storage node @param to.
+   *
+   * @return true if the message was queued, in which case @param msg is
+   *         moved from. false if batching is disabled or @param msg should be
+   *         sent on its own, e.g. because it is large or the connection to
+   *         the node is not handshaken with a protocol supporting STORE_BATCH.
+   */
+  bool addSTORE(std::unique_ptr<STORE_Message>& msg, NodeID to);
+
+  /**
+   * Queues a STORED reply for the sequencer on connection @param to. Same
+   * contract as addSTORE(). Replies to rebuilding STOREs are not batched.
+   */
+  bool addSTORED(std::unique_ptr<STORED_Message>& msg, ClientID to);
+
+  /**
+   * Sends all queued messages.
+   */
+  void flush();
+
+ protected:
+  // The methods below talk to the Worker and are overridden in tests.
+
+  // Maximum size of a batch, 0 if batching is disabled.
+  virtual size_t maxBatchBytes() const;
+
+  // Returns false if the peer on the other end of @param to doesn't know
+  // about batch messages.
+  virtual bool peerSupportsBatches(const Address& to) const;
+
+  // Same contract as Sender::sendMessage(): @param msg is moved from on
+  // success, and left as is on failure with err set.
+  virtual int sendMessage(std::unique_ptr<Message>& msg, const Address& to);
+
+  // Called for every STORE of a batch (or a STORE sent on its own) that
+  // couldn't be sent. Lets the Appender know, like an asynchronous failure
+  // to send the STORE would.
+  virtual void onSTORENotSent(const STORE_Message& msg,
+                              Status st,
+                              const Address& to);
+
+  virtual void activateFlushTimer();
+
+ private:
+  using STOREs = std::vector<std::unique_ptr<STORE_Message>>;
+  using STOREDs = std::vector<std::unique_ptr<STORED_Message>>;
+
+  struct PendingSTOREs {
+    NodeID to;
+    STOREs messages;
+  };
+
+  // Send the messages queued for one peer, in batches of at most
+  // maxBatchBytes().
+  void sendSTOREs(PendingSTOREs pending);
+  void sendSTOREDs(STOREDs replies, ClientID to);
+
+  std::unordered_map<node_index_t, PendingSTOREs> stores_;
+  std::unordered_map<ClientID, STOREDs, ClientID::Hash> storeds_;
+
+  // Created on first use since Timer needs the Worker's event base.
+  std::unique_ptr<Timer> flush_timer_;
+};
+
+/**
+ * The Sender of Appenders. Gives the STOREs it is asked to send to the
+ * Worker's StoreBatcher, once traffic shaping allows sending to the node.
+ * Everything else goes to the Worker's Sender, as with SenderProxy.
+ */
+class StoreBatchingSender : public SenderProxy {
+ protected:
+  int sendMessageImpl(std::unique_ptr<Message>&& msg,
+                      const Address& addr,
+                      BWAvailableCallback* on_bw_avail,
+                      SocketCallback* onclose) override;
+};
+
+}} // namespace facebook::logdevice
@@ -53,10 +53,12 @@
 #include "logdevice/common/PermissionChecker.h"
 #include "logdevice/common/Processor.h"
 #include "logdevice/common/SSLFetcher.h"
+#include "logdevice/common/SealBatcher.h"
 #include "logdevice/common/SequencerBackgroundActivator.h"
 #include "logdevice/common/ServerConfigUpdatedRequest.h"
 #include "logdevice/common/ShapingContainer.h"
 #include "logdevice/common/SocketSender.h"
+#include "logdevice/common/StoreBatcher.h"
 #include "logdevice/common/SyncSequencerRequest.h"
 #include "logdevice/common/TraceLogger.h"
 #include "logdevice/common/TrimRequest.h"
@@ -181,9 +183,11 @@ class WorkerImpl {
   ConfigurationFetchRequestMap runningConfigurationFetches_;
   GetSeqStateRequestMap runningGetSeqState_;
   AppenderMap activeAppenders_;
+  StoreBatcher storeBatcher_;
   GetLogInfoRequestMaps runningGetLogInfo_;
   ClusterStateSubscriptionList clusterStateSubscriptions_;
   LogRecoveryRequestMap runningLogRecoveries_;
+  SealBatcher sealBatcher_;
   SyncSequencerRequestList runningSyncSequencerRequests_;
   AppenderBuffer appenderBuffer_;
   AppenderBuffer previously_redirected_appends_;
@@ -1180,6 +1184,14 @@ AppenderMap& Worker::activeAppenders() const {
   return impl_->activeAppenders_;
 }
 
+StoreBatcher& Worker::storeBatcher() const {
+  return impl_->storeBatcher_;
+}
+
+SealBatcher& Worker::sealBatcher() const {
+  return impl_->sealBatcher_;
+}
+
 AppendRequestMap& Worker::runningAppends() const {
   return impl_->runningAppends_;
 }
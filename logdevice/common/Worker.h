@@ -70,10 +70,8 @@ struct SocketConnectRequest;
   do {                                                               \
     const auto config_ = cluster_config;                             \
     if (config_ && config_->logsConfig()->isLocal()) {               \
-      const auto log_path_opt_ = config_->getLogGroupPath(log_id);   \
-      if (log_path_opt_) {                                           \
-        LOG_GROUP_STAT_ADD(stats, log_path_opt_.value(), name, val); \
-      }                                                              \
+      LOG_GROUP_IDX_STAT_ADD(                                        \
+          stats, config_->getLogGroupStatsIdx(log_id), name, val);   \
     }                                                                \
   } while (0)
 
@@ -130,7 +128,9 @@ class Request;
 class SSLFetcher;
 class Sender;
 class SocketSender;
+class SealBatcher;
 class SequencerBackgroundActivator;
+class StoreBatcher;
 class ServerConfig;
 class ShapingContainer;
 class ShardAuthoritativeStatusManager;
@@ -466,6 +466,12 @@ class Worker : public WorkContext {
   // a map of all currently active Appenders created by this Worker
   AppenderMap& activeAppenders() const;
 
+  // STOREs and STOREDs waiting to be sent in batches, see StoreBatcher
+  StoreBatcher& storeBatcher() const;
+
+  // SEALs of log recoveries waiting to be sent in batches, see SealBatcher
+  SealBatcher& sealBatcher() const;
+
   // a map of all currently running GetLogInfoRequests
   GetLogInfoRequestMaps& runningGetLogInfo() const;
 
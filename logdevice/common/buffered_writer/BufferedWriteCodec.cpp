@@ -7,7 +7,9 @@
  */
 #include "logdevice/common/buffered_writer/BufferedWriteCodec.h"
 
+#include <algorithm>
 #include <iterator>
+#include <limits>
 #include <lz4.h>
 #include <lz4hc.h>
 #include <zstd.h>
@@ -17,11 +19,29 @@
 
 #include "logdevice/common/Checksum.h"
 #include "logdevice/common/buffered_writer/BufferedWriteDecoderImpl.h"
+#include "logdevice/common/buffered_writer/ZstdDictionaries.h"
 #include "logdevice/common/debug.h"
+#include "logdevice/include/Err.h"
 #include "logdevice/include/types.h"
 
 namespace facebook { namespace logdevice {
 
+namespace {
+// Contexts for dictionary compression are expensive to create, so each
+// thread reuses its own.
+ZSTD_CCtx* threadLocalCCtx() {
+  thread_local std::unique_ptr<ZSTD_CCtx, size_t (*)(ZSTD_CCtx*)> cctx(
+      ZSTD_createCCtx(), ZSTD_freeCCtx);
+  return cctx.get();
+}
+
+ZSTD_DCtx* threadLocalDCtx() {
+  thread_local std::unique_ptr<ZSTD_DCtx, size_t (*)(ZSTD_DCtx*)> dctx(
+      ZSTD_createDCtx(), ZSTD_freeDCtx);
+  return dctx.get();
+}
+} // namespace
+
 BufferedWriteSinglePayloadsCodec::Encoder::Encoder(size_t capacity,
                                                    size_t headroom)
     : blob_(folly::IOBuf::CREATE, headroom + capacity),
@@ -44,10 +64,12 @@ void BufferedWriteSinglePayloadsCodec::Encoder::append(
   }
 }
 
-void BufferedWriteSinglePayloadsCodec::Encoder::encode(folly::IOBufQueue& out,
-                                                       Compression& compression,
-                                                       int zstd_level) {
-  bool compressed = compress(compression, zstd_level);
+void BufferedWriteSinglePayloadsCodec::Encoder::encode(
+    folly::IOBufQueue& out,
+    Compression& compression,
+    int zstd_level,
+    const ZSTD_CDict_s* zstd_dict) {
+  bool compressed = compress(compression, zstd_level, zstd_dict);
   if (!compressed) {
     compression = Compression::NONE;
   }
@@ -56,7 +78,8 @@ void BufferedWriteSinglePayloadsCodec::Encoder::encode(folly::IOBufQueue& out,
 
 bool BufferedWriteSinglePayloadsCodec::Encoder::compress(
     Compression compression,
-    int zstd_level) {
+    int zstd_level,
+    const ZSTD_CDict_s* zstd_dict) {
   if (compression == Compression::NONE) {
     // Nothing to do.
     return true;
@@ -64,6 +87,7 @@ bool BufferedWriteSinglePayloadsCodec::Encoder::compress(
   ld_check(compression == Compression::ZSTD ||
            compression == Compression::LZ4 ||
            compression == Compression::LZ4_HC);
+  ld_check(zstd_dict == nullptr || compression == Compression::ZSTD);
 
   const Slice to_compress(blob_.data(), blob_.length());
 
@@ -88,11 +112,21 @@ bool BufferedWriteSinglePayloadsCodec::Encoder::compress(
   size_t compressed_size;
   if (compression == Compression::ZSTD) {
     ld_check(zstd_level > 0);
-    compressed_size = ZSTD_compress(out,              // dst
-                                    end - out,        // dstCapacity
-                                    to_compress.data, // src
-                                    to_compress.size, // srcSize
-                                    zstd_level);      // level
+    if (zstd_dict != nullptr) {
+      // Compression level is baked into the dictionary.
+      compressed_size = ZSTD_compress_usingCDict(threadLocalCCtx(),
+                                                 out,
+                                                 end - out,
+                                                 to_compress.data,
+                                                 to_compress.size,
+                                                 zstd_dict);
+    } else {
+      compressed_size = ZSTD_compress(out,              // dst
+                                      end - out,        // dstCapacity
+                                      to_compress.data, // src
+                                      to_compress.size, // srcSize
+                                      zstd_level);      // level
+    }
     if (ZSTD_isError(compressed_size)) {
       ld_critical(
           "ZSTD_compress() failed: %s", ZSTD_getErrorName(compressed_size));
@@ -136,7 +170,8 @@ bool BufferedWriteSinglePayloadsCodec::Encoder::compress(
 
 namespace {
 folly::Optional<folly::IOBuf> uncompress(const Slice& slice,
-                                         const Compression compression) {
+                                         const Compression compression,
+                                         uint32_t zstd_dictionary_id) {
   if (compression == Compression::NONE) {
     return folly::IOBuf::wrapBufferAsValue(slice.data, slice.size);
   }
@@ -172,10 +207,32 @@ folly::Optional<folly::IOBuf> uncompress(const Slice& slice,
       ld_check(false);
       return folly::none;
     case Compression::ZSTD: {
-      size_t rv = ZSTD_decompress(out.writableTail(), // dst
-                                  uncompressed_size,  // dstCapacity
-                                  ptr,                // src
-                                  end - ptr);         // compressedSize
+      size_t rv;
+      if (zstd_dictionary_id != 0) {
+        auto ddict = ZstdDictionaries::instance().getDDict(zstd_dictionary_id);
+        if (!ddict) {
+          // err is AGAIN if the dictionary is being fetched.
+          if (err != E::AGAIN) {
+            RATELIMIT_ERROR(
+                std::chrono::seconds(1),
+                1,
+                "Batch is compressed with unknown ZSTD dictionary %u",
+                zstd_dictionary_id);
+          }
+          return folly::none;
+        }
+        rv = ZSTD_decompress_usingDDict(threadLocalDCtx(),
+                                        out.writableTail(),
+                                        uncompressed_size,
+                                        ptr,
+                                        end - ptr,
+                                        ddict.get());
+      } else {
+        rv = ZSTD_decompress(out.writableTail(), // dst
+                             uncompressed_size,  // dstCapacity
+                             ptr,                // src
+                             end - ptr);         // compressedSize
+      }
       if (ZSTD_isError(rv)) {
         RATELIMIT_ERROR(std::chrono::seconds(1),
                         1,
@@ -246,20 +303,138 @@ decodeVarint(folly::io::Cursor& cursor) {
   return result;
 }
 
+// Decompresses a ZSTD blob that is split across several buffers of an IOBuf
+// chain, without coalescing it first.
+folly::Optional<folly::IOBuf> uncompressZstdChain(const folly::IOBuf& blob,
+                                                  uint32_t zstd_dictionary_id) {
+  folly::io::Cursor cursor{&blob};
+  auto decoded_size = decodeVarint(cursor);
+  if (!decoded_size) {
+    RATELIMIT_ERROR(std::chrono::seconds(1), 1, "Failed to decode varint");
+    return folly::none;
+  }
+  const uint64_t uncompressed_size = *decoded_size;
+  if (uncompressed_size > MAX_PAYLOAD_SIZE_INTERNAL) {
+    RATELIMIT_ERROR(std::chrono::seconds(1),
+                    1,
+                    "Compressed buffered write header says uncompressed length "
+                    "is %lu, should be at most MAX_PAYLOAD_SIZE_INTERNAL (%zu)",
+                    uncompressed_size,
+                    MAX_PAYLOAD_SIZE_INTERNAL);
+    return folly::none;
+  }
+
+  ZSTD_DCtx* dctx = threadLocalDCtx();
+  // Also drops the dictionary referenced by the previous call, if any.
+  ZSTD_DCtx_reset(dctx, ZSTD_reset_session_and_parameters);
+  std::shared_ptr<const ZSTD_DDict> ddict;
+  if (zstd_dictionary_id != 0) {
+    ddict = ZstdDictionaries::instance().getDDict(zstd_dictionary_id);
+    if (!ddict) {
+      // err is AGAIN if the dictionary is being fetched.
+      if (err != E::AGAIN) {
+        RATELIMIT_ERROR(std::chrono::seconds(1),
+                        1,
+                        "Batch is compressed with unknown ZSTD dictionary %u",
+                        zstd_dictionary_id);
+      }
+      return folly::none;
+    }
+    ZSTD_DCtx_refDDict(dctx, ddict.get());
+  }
+
+  folly::IOBuf out{folly::IOBuf::CREATE, uncompressed_size};
+  ZSTD_outBuffer output{out.writableTail(), uncompressed_size, 0};
+  size_t rv = 1;
+  while (!cursor.isAtEnd()) {
+    const folly::ByteRange bytes = cursor.peekBytes();
+    ZSTD_inBuffer input{bytes.data(), bytes.size(), 0};
+    rv = ZSTD_decompressStream(dctx, &output, &input);
+    if (ZSTD_isError(rv)) {
+      RATELIMIT_ERROR(std::chrono::seconds(1),
+                      1,
+                      "ZSTD_decompressStream() failed: %s",
+                      ZSTD_getErrorName(rv));
+      return folly::none;
+    }
+    if (input.pos == 0 && output.pos == output.size) {
+      // Output is full, but there's more input.
+      break;
+    }
+    cursor.skip(input.pos);
+  }
+  if (rv != 0 || !cursor.isAtEnd() || output.pos != uncompressed_size) {
+    RATELIMIT_ERROR(std::chrono::seconds(1),
+                    1,
+                    "Zstd decompression length %zu does not match %lu found "
+                    "in header, or the frame is incomplete",
+                    output.pos,
+                    uncompressed_size);
+    return folly::none;
+  }
+  out.append(uncompressed_size);
+  return out;
+}
+
+// Same as uncompress() above, but takes a possibly chained IOBuf. For
+// Compression::NONE, the result shares buffers with blob.
+folly::Optional<folly::IOBuf> uncompress(const folly::IOBuf& blob,
+                                         const Compression compression,
+                                         uint32_t zstd_dictionary_id) {
+  if (compression == Compression::NONE) {
+    return blob.cloneAsValue();
+  }
+  if (!blob.isChained()) {
+    return uncompress(
+        Slice(blob.data(), blob.length()), compression, zstd_dictionary_id);
+  }
+  if (compression == Compression::ZSTD) {
+    return uncompressZstdChain(blob, zstd_dictionary_id);
+  }
+  // LZ4 only supports contiguous input.
+  const folly::IOBuf coalesced = blob.cloneCoalescedAsValue();
+  return uncompress(Slice(coalesced.data(), coalesced.length()),
+                    compression,
+                    zstd_dictionary_id);
+}
+
 } // namespace
 
 size_t BufferedWriteSinglePayloadsCodec::decode(
     const Slice& binary,
     Compression compression,
     std::vector<folly::IOBuf>& payloads_out,
-    bool allow_buffer_sharing) {
-  auto uncompressed = uncompress(binary, compression);
+    bool allow_buffer_sharing,
+    uint32_t zstd_dictionary_id) {
+  return decode(folly::IOBuf::wrapBufferAsValue(binary.data, binary.size),
+                compression,
+                payloads_out,
+                allow_buffer_sharing,
+                zstd_dictionary_id);
+}
+
+size_t BufferedWriteSinglePayloadsCodec::decode(
+    const folly::IOBuf& binary,
+    Compression compression,
+    std::vector<folly::IOBuf>& payloads_out,
+    bool allow_buffer_sharing,
+    uint32_t zstd_dictionary_id) {
+  if (zstd_dictionary_id != 0 && compression != Compression::ZSTD) {
+    RATELIMIT_ERROR(std::chrono::seconds(1),
+                    1,
+                    "Batch has ZSTD dictionary %u but compression %s",
+                    zstd_dictionary_id,
+                    compressionToString(compression).c_str());
+    return 0;
+  }
+  auto uncompressed = uncompress(binary, compression, zstd_dictionary_id);
   if (!uncompressed) {
     return 0;
   }
 
   // uncompressed can share buffer with binary (e.g. in case of NO_COMPRESSION)
-  // If sharing is not allowed, ensure that uncompressed manages its own copy
+  // If sharing is not allowed, ensure that uncompressed manages its own copy.
+  // This is a no-op if binary is managed: sharing refcounted buffers is safe.
   if (!allow_buffer_sharing) {
     uncompressed->makeManaged();
   }
@@ -327,7 +502,10 @@ BufferedWriteCodec::Encoder<BufferedWriteSinglePayloadsCodec::Encoder>::Encoder(
     : checksum_bits_(checksum_bits),
       appends_count_(appends_count),
       header_size_(calculateHeaderSize(checksum_bits_, appends_count_)),
-      payloads_encoder_(capacity - header_size_, header_size_) {}
+      format_(Format::SINGLE_PAYLOADS),
+      // Leave room for a dictionary ID in case encode() is asked to use one.
+      payloads_encoder_(capacity - header_size_,
+                        header_size_ + folly::kMaxVarintLength32) {}
 
 template <>
 BufferedWriteCodec::Encoder<PayloadGroupCodec::Encoder>::Encoder(
@@ -338,6 +516,7 @@ BufferedWriteCodec::Encoder<PayloadGroupCodec::Encoder>::Encoder(
     : checksum_bits_(checksum_bits),
       appends_count_(appends_count),
       header_size_(calculateHeaderSize(checksum_bits_, appends_count_)),
+      format_(Format::PAYLOAD_GROUPS),
       payloads_encoder_(appends_count_) {}
 
 template <typename PayloadsEncoder>
@@ -364,7 +543,8 @@ template <typename PayloadsEncoder>
 void BufferedWriteCodec::Encoder<PayloadsEncoder>::encode(
     folly::IOBufQueue& out,
     Compression compression,
-    int zstd_level) {
+    int zstd_level,
+    uint32_t zstd_dictionary_id) {
   folly::IOBufQueue queue;
   if constexpr (std::is_same_v<PayloadsEncoder, PayloadGroupCodec::Encoder>) {
     // Make sure there's headroom reserved
@@ -375,7 +555,28 @@ void BufferedWriteCodec::Encoder<PayloadsEncoder>::encode(
     queue.append(std::move(iobuf));
   }
 
-  payloads_encoder_.encode(queue, compression, zstd_level);
+  if constexpr (std::is_same_v<PayloadsEncoder,
+                               BufferedWriteSinglePayloadsCodec::Encoder>) {
+    std::shared_ptr<const ZSTD_CDict> zstd_dict;
+    if (compression == Compression::ZSTD && zstd_dictionary_id != 0) {
+      zstd_dict =
+          ZstdDictionaries::instance().getCDict(zstd_dictionary_id, zstd_level);
+      if (!zstd_dict) {
+        RATELIMIT_WARNING(std::chrono::seconds(10),
+                          1,
+                          "Unknown ZSTD dictionary %u, compressing without it",
+                          zstd_dictionary_id);
+      }
+    }
+    payloads_encoder_.encode(queue, compression, zstd_level, zstd_dict.get());
+    if (zstd_dict && compression == Compression::ZSTD) {
+      format_ = Format::SINGLE_PAYLOADS_ZSTD_DICT;
+      zstd_dictionary_id_ = zstd_dictionary_id;
+      header_size_ += folly::encodeVarintSize(zstd_dictionary_id_);
+    }
+  } else {
+    payloads_encoder_.encode(queue, compression, zstd_level);
+  }
 
   auto blob = queue.move();
   if constexpr (std::is_same_v<PayloadsEncoder, PayloadGroupCodec::Encoder>) {
@@ -396,30 +597,13 @@ void BufferedWriteCodec::Encoder<PayloadsEncoder>::encode(
   out.append(std::move(blob));
 }
 
-namespace {
-/** Returns format based on encoder type. */
-template <typename PayloadsEncoder>
-BufferedWriteCodec::Format getFormat();
-
-template <>
-BufferedWriteCodec::Format
-getFormat<BufferedWriteSinglePayloadsCodec::Encoder>() {
-  return BufferedWriteCodec::Format::SINGLE_PAYLOADS;
-}
-
-template <>
-BufferedWriteCodec::Format getFormat<PayloadGroupCodec::Encoder>() {
-  return BufferedWriteCodec::Format::PAYLOAD_GROUPS;
-}
-
-} // namespace
-
 // Format of the header:
 // * 0-8 bytes reserved for checksum -- this is not really part of the
 //   BufferedWriter format, see BufferedWriterImpl::prependChecksums()
 // * 1 magic marker byte
 // * 1 flags byte
 // * 0-9 bytes varint batch size
+// * for SINGLE_PAYLOADS_ZSTD_DICT only, 1-5 bytes varint dictionary ID
 template <typename PayloadsEncoder>
 void BufferedWriteCodec::Encoder<PayloadsEncoder>::encodeHeader(
     folly::IOBuf& blob,
@@ -433,11 +617,14 @@ void BufferedWriteCodec::Encoder<PayloadsEncoder>::encodeHeader(
   // Skip checksum
   out += checksum_bits_ / 8;
   // Magic marker & flags
-  *out++ = static_cast<uint8_t>(getFormat<PayloadsEncoder>());
+  *out++ = static_cast<uint8_t>(format_);
   *out++ = flags;
 
   size_t len = folly::encodeVarint(appends_count_, out);
   out += len;
+  if (format_ == Format::SINGLE_PAYLOADS_ZSTD_DICT) {
+    out += folly::encodeVarint(zstd_dictionary_id_, out);
+  }
   ld_check(blob.writableData() + header_size_ == out);
 
   if (checksum_bits_ > 0) {
@@ -462,6 +649,7 @@ void BufferedWriteCodec::Estimator::append(const folly::IOBuf& payload) {
   // will be discarded.
   switch (format_) {
     case Format::SINGLE_PAYLOADS:
+    case Format::SINGLE_PAYLOADS_ZSTD_DICT:
       single_payloads_estimator_.append(payload);
       FOLLY_FALLTHROUGH;
     case Format::PAYLOAD_GROUPS:
@@ -482,6 +670,7 @@ size_t BufferedWriteCodec::Estimator::calculateSize(int checksum_bits) const {
   size_t size = calculateHeaderSize(checksum_bits, appends_count_);
   switch (format_) {
     case Format::SINGLE_PAYLOADS:
+    case Format::SINGLE_PAYLOADS_ZSTD_DICT:
       size += single_payloads_estimator_.calculateSize();
       break;
     case Format::PAYLOAD_GROUPS:
@@ -497,7 +686,8 @@ namespace {
 size_t decodeHeader(folly::IOBuf& blob,
                     BufferedWriteDecoderImpl::flags_t* flags_out,
                     BufferedWriteCodec::Format* format_out,
-                    size_t* size_out) {
+                    size_t* size_out,
+                    uint32_t* zstd_dictionary_id_out = nullptr) {
   folly::io::Cursor cursor{&blob};
   if (cursor.isAtEnd()) {
     RATELIMIT_ERROR(
@@ -507,7 +697,8 @@ size_t decodeHeader(folly::IOBuf& blob,
 
   using Format = BufferedWriteCodec::Format;
   auto format = cursor.read<Format>();
-  if (format != Format::SINGLE_PAYLOADS && format != Format::PAYLOAD_GROUPS) {
+  if (format != Format::SINGLE_PAYLOADS && format != Format::PAYLOAD_GROUPS &&
+      format != Format::SINGLE_PAYLOADS_ZSTD_DICT) {
     RATELIMIT_ERROR(std::chrono::seconds(1),
                     1,
                     "Got unexpected marker byte 0x%02x",
@@ -541,8 +732,27 @@ size_t decodeHeader(folly::IOBuf& blob,
     batch_size = 1;
   }
 
+  uint32_t zstd_dictionary_id = 0;
+  if (format == Format::SINGLE_PAYLOADS_ZSTD_DICT) {
+    auto decoded_dictionary_id = decodeVarint(cursor);
+    if (!decoded_dictionary_id ||
+        *decoded_dictionary_id > std::numeric_limits<uint32_t>::max() ||
+        *decoded_dictionary_id == 0) {
+      RATELIMIT_ERROR(
+          std::chrono::seconds(1), 1, "Failed to decode ZSTD dictionary ID");
+      return 0;
+    }
+    zstd_dictionary_id = *decoded_dictionary_id;
+  }
+
   const size_t header_size = cursor.getCurrentPosition();
-  blob.trimStart(header_size);
+  // The header may span several buffers of a chain.
+  size_t to_trim = header_size;
+  for (folly::IOBuf* buf = &blob; to_trim > 0; buf = buf->next()) {
+    const size_t n = std::min(to_trim, buf->length());
+    buf->trimStart(n);
+    to_trim -= n;
+  }
 
   if (flags_out != nullptr) {
     *flags_out = flags;
@@ -553,15 +763,20 @@ size_t decodeHeader(folly::IOBuf& blob,
   if (size_out != nullptr) {
     *size_out = batch_size;
   }
+  if (zstd_dictionary_id_out != nullptr) {
+    *zstd_dictionary_id_out = zstd_dictionary_id;
+  }
   return header_size;
 }
 
 size_t decodeHeader(Slice& blob,
                     BufferedWriteDecoderImpl::flags_t* flags_out,
                     BufferedWriteCodec::Format* format_out,
-                    size_t* size_out) {
+                    size_t* size_out,
+                    uint32_t* zstd_dictionary_id_out = nullptr) {
   auto iobuf = folly::IOBuf::wrapBufferAsValue(blob.data, blob.size);
-  size_t header_size = decodeHeader(iobuf, flags_out, format_out, size_out);
+  size_t header_size = decodeHeader(
+      iobuf, flags_out, format_out, size_out, zstd_dictionary_id_out);
   blob = Slice(reinterpret_cast<const uint8_t*>(blob.data) + header_size,
                blob.size - header_size);
   return header_size;
@@ -598,23 +813,42 @@ FOLLY_NODISCARD
 size_t BufferedWriteCodec::decode(Slice binary,
                                   std::vector<folly::IOBuf>& payloads_out,
                                   bool allow_buffer_sharing) {
+  return decode(folly::IOBuf::wrapBufferAsValue(binary.data, binary.size),
+                payloads_out,
+                allow_buffer_sharing);
+}
+
+FOLLY_NODISCARD
+size_t BufferedWriteCodec::decode(const folly::IOBuf& blob,
+                                  std::vector<folly::IOBuf>& payloads_out,
+                                  bool allow_buffer_sharing) {
+  // Overridden with AGAIN if the batch needs a dictionary being fetched.
+  err = E::BADMSG;
   BufferedWriteDecoderImpl::flags_t flags;
   Format format;
   size_t batch_size;
-  const size_t header_size = decodeHeader(binary, &flags, &format, &batch_size);
+  uint32_t zstd_dictionary_id;
+  folly::IOBuf iobuf = blob;
+  const size_t header_size =
+      decodeHeader(iobuf, &flags, &format, &batch_size, &zstd_dictionary_id);
   if (header_size == 0) {
     return 0;
   }
-  if (binary.size == 0) {
+  if (iobuf.empty()) {
     // Nothing else to decode. Just the header.
     return header_size;
   }
   const Compression compression = static_cast<Compression>(
       flags & BufferedWriteDecoderImpl::Flags::COMPRESSION_MASK);
   switch (format) {
-    case Format::SINGLE_PAYLOADS: {
-      size_t bytes_decoded = BufferedWriteSinglePayloadsCodec::decode(
-          binary, compression, payloads_out, allow_buffer_sharing);
+    case Format::SINGLE_PAYLOADS:
+    case Format::SINGLE_PAYLOADS_ZSTD_DICT: {
+      size_t bytes_decoded =
+          BufferedWriteSinglePayloadsCodec::decode(iobuf,
+                                                   compression,
+                                                   payloads_out,
+                                                   allow_buffer_sharing,
+                                                   zstd_dictionary_id);
       if (bytes_decoded == 0) {
         return 0;
       }
@@ -646,24 +880,43 @@ FOLLY_NODISCARD
 size_t BufferedWriteCodec::decode(Slice binary,
                                   std::vector<PayloadGroup>& payload_groups_out,
                                   bool allow_buffer_sharing) {
+  return decode(folly::IOBuf::wrapBufferAsValue(binary.data, binary.size),
+                payload_groups_out,
+                allow_buffer_sharing);
+}
+
+FOLLY_NODISCARD
+size_t BufferedWriteCodec::decode(const folly::IOBuf& blob,
+                                  std::vector<PayloadGroup>& payload_groups_out,
+                                  bool allow_buffer_sharing) {
+  // Overridden with AGAIN if the batch needs a dictionary being fetched.
+  err = E::BADMSG;
   BufferedWriteDecoderImpl::flags_t flags;
   Format format;
   size_t batch_size;
-  const size_t header_size = decodeHeader(binary, &flags, &format, &batch_size);
+  uint32_t zstd_dictionary_id;
+  folly::IOBuf iobuf = blob;
+  const size_t header_size =
+      decodeHeader(iobuf, &flags, &format, &batch_size, &zstd_dictionary_id);
   if (header_size == 0) {
     return 0;
   }
   const Compression compression = static_cast<Compression>(
       flags & BufferedWriteDecoderImpl::Flags::COMPRESSION_MASK);
   switch (format) {
-    case Format::SINGLE_PAYLOADS: {
-      if (binary.size == 0) {
+    case Format::SINGLE_PAYLOADS:
+    case Format::SINGLE_PAYLOADS_ZSTD_DICT: {
+      if (iobuf.empty()) {
         // Nothing else to decode. Just the header.
         return header_size;
       }
       std::vector<folly::IOBuf> payloads;
-      const size_t bytes_decoded = BufferedWriteSinglePayloadsCodec::decode(
-          binary, compression, payloads, allow_buffer_sharing);
+      const size_t bytes_decoded =
+          BufferedWriteSinglePayloadsCodec::decode(iobuf,
+                                                   compression,
+                                                   payloads,
+                                                   allow_buffer_sharing,
+                                                   zstd_dictionary_id);
       if (bytes_decoded == 0) {
         return 0;
       }
@@ -672,7 +925,7 @@ size_t BufferedWriteCodec::decode(Slice binary,
     }
     case Format::PAYLOAD_GROUPS: {
       const size_t bytes_decoded = PayloadGroupCodec::decode(
-          binary, payload_groups_out, allow_buffer_sharing);
+          iobuf, payload_groups_out, allow_buffer_sharing);
       if (bytes_decoded == 0) {
         return 0;
       }
@@ -15,6 +15,8 @@
 #include "logdevice/common/PayloadGroupCodec.h"
 #include "logdevice/include/types.h"
 
+struct ZSTD_CDict_s;
+
 namespace facebook { namespace logdevice {
 
 /** Codec for batches of single payloads */
@@ -36,17 +38,21 @@ class BufferedWriteSinglePayloadsCodec {
      * Encodes and compressess payloads. If compressing payloads with requested
      * compresssion doesn't improve required space, then it can be left
      * uncompressed. compression parameter is updated accordingly.
+     * If zstd_dict is not null, ZSTD compression uses that dictionary.
      */
     void encode(folly::IOBufQueue& out,
                 Compression& compression,
-                int zstd_level = 0);
+                int zstd_level = 0,
+                const ZSTD_CDict_s* zstd_dict = nullptr);
 
    private:
     /**
      * Replaces blob with compressed blob if compression saves some space and
      * returns true. Otherwise leaves blob as is and returns false.
      */
-    bool compress(Compression compression, int zstd_level);
+    bool compress(Compression compression,
+                  int zstd_level,
+                  const ZSTD_CDict_s* zstd_dict);
 
     // Payloads are appended to the blob_ using appender_ */
     folly::IOBuf blob_;
@@ -71,12 +77,28 @@ class BufferedWriteSinglePayloadsCodec {
    * Uncompress and decode payloads stored in batch.
    * Resulting payloads can optionally share data with input (for example in
    * case it's uncompressed).
+   * If zstd_dictionary_id is not 0, the batch is ZSTD compressed with that
+   * dictionary, which is looked up in ZstdDictionaries.
    * Returns number of bytes consumed, or 0 if decoding fails.
    */
   static size_t decode(const Slice& binary,
                        Compression compression,
                        std::vector<folly::IOBuf>& payloads_out,
-                       bool allow_buffer_sharing);
+                       bool allow_buffer_sharing,
+                       uint32_t zstd_dictionary_id = 0);
+
+  /**
+   * Same as above, but decodes a possibly chained IOBuf without coalescing
+   * it. Uncompressed payloads are sub-slices of binary; if binary is managed
+   * they hold references to its buffers, so no copy is made even if
+   * allow_buffer_sharing is false. Payloads spanning several buffers of the
+   * chain are returned as chains.
+   */
+  static size_t decode(const folly::IOBuf& binary,
+                       Compression compression,
+                       std::vector<folly::IOBuf>& payloads_out,
+                       bool allow_buffer_sharing,
+                       uint32_t zstd_dictionary_id = 0);
 };
 
 /**
@@ -85,7 +107,15 @@ class BufferedWriteSinglePayloadsCodec {
 class BufferedWriteCodec {
  public:
   // Enum values are persisted in storage to identify encoding.
-  enum class Format : uint8_t { SINGLE_PAYLOADS = 0xb1, PAYLOAD_GROUPS = 0xb2 };
+  enum class Format : uint8_t {
+    SINGLE_PAYLOADS = 0xb1,
+    PAYLOAD_GROUPS = 0xb2,
+    // Same as SINGLE_PAYLOADS, but ZSTD compressed with a dictionary from
+    // ZstdDictionaries. The header is followed by the varint dictionary ID.
+    // Never returned by Estimator::getFormat(): Encoder switches to it when
+    // asked to compress SINGLE_PAYLOADS with a known dictionary.
+    SINGLE_PAYLOADS_ZSTD_DICT = 0xb3,
+  };
 
   /** Supports encoding of the payloads. */
   template <typename PayloadsEncoder>
@@ -109,10 +139,14 @@ class BufferedWriteCodec {
      * encoded payloads.
      * Encoder must not be re-used after calling this.
      * zstd_level must be specified if ZSTD compression is used.
+     * If zstd_dictionary_id is not 0 and refers to a dictionary registered in
+     * ZstdDictionaries, single payloads are compressed with that dictionary
+     * (SINGLE_PAYLOADS_ZSTD_DICT format). It's ignored for payload groups.
      */
     void encode(folly::IOBufQueue& out,
                 Compression compression,
-                int zstd_level = 0);
+                int zstd_level = 0,
+                uint32_t zstd_dictionary_id = 0);
 
    private:
     /** Writes header (checksum, flags, etc) to the blob's headroom */
@@ -121,6 +155,9 @@ class BufferedWriteCodec {
     int checksum_bits_;
     size_t appends_count_;
     size_t header_size_;
+    Format format_;
+    // Set if format_ is SINGLE_PAYLOADS_ZSTD_DICT.
+    uint32_t zstd_dictionary_id_ = 0;
 
     PayloadsEncoder payloads_encoder_;
   };
@@ -178,24 +215,47 @@ class BufferedWriteCodec {
    * Decodes payloads stored in batch.
    * Resulting payloads can optionally share data with input (for example in
    * case it's uncompressed).
-   * Returns number of bytes consumed, or 0 if decoding fails.
+   * Returns number of bytes consumed, or 0 if decoding fails with err set to
+   * AGAIN if the batch is compressed with a ZSTD dictionary that is being
+   * fetched (see ZstdDictionaries), BADMSG otherwise.
    */
   FOLLY_NODISCARD
   static size_t decode(Slice binary,
                        std::vector<folly::IOBuf>& payloads_out,
                        bool allow_buffer_sharing);
 
+  /**
+   * Same as above, but decodes a possibly chained IOBuf. If blob is managed,
+   * uncompressed payloads are refcounted sub-slices of it instead of copies,
+   * so they remain valid after blob is destroyed.
+   */
+  FOLLY_NODISCARD
+  static size_t decode(const folly::IOBuf& blob,
+                       std::vector<folly::IOBuf>& payloads_out,
+                       bool allow_buffer_sharing);
+
   /**
    * Decodes payloads stored in batch.
    * Resulting payloads can optionally share data with input (for example in
    * case it's uncompressed).
-   * Returns number of bytes consumed, or 0 if decoding fails.
+   * Returns number of bytes consumed, or 0 if decoding fails with err set to
+   * AGAIN if the batch is compressed with a ZSTD dictionary that is being
+   * fetched (see ZstdDictionaries), BADMSG otherwise.
    */
   FOLLY_NODISCARD
   static size_t decode(Slice binary,
                        std::vector<PayloadGroup>& payload_groups_out,
                        bool allow_buffer_sharing);
 
+  /**
+   * Same as above, but decodes a possibly chained IOBuf. See the IOBuf
+   * variant of decode() for single payloads.
+   */
+  FOLLY_NODISCARD
+  static size_t decode(const folly::IOBuf& blob,
+                       std::vector<PayloadGroup>& payload_groups_out,
+                       bool allow_buffer_sharing);
+
   /**
    * Decodes payload groups without uncompressing them. This requires payloads
    * to be in PAYLOAD_GROUPS format, otherwise decoding fails.
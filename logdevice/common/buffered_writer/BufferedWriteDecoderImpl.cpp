@@ -16,11 +16,38 @@
 #include "logdevice/common/DataRecordOwnsPayload.h"
 #include "logdevice/common/buffered_writer/BufferedWriteCodec.h"
 #include "logdevice/common/debug.h"
+#include "logdevice/include/Err.h"
 
 namespace facebook { namespace logdevice {
 
 using Compression = BufferedWriter::Options::Compression;
 
+namespace {
+/**
+ * Gets IOBuf from the record to allow IOBuf sharing. If record is backed by
+ * IOBuf, then that IOBuf is returned. Otherwise just wraps payload in IOBuf.
+ */
+folly::IOBuf getIOBuf(const DataRecord& record) {
+  auto record_owns_payload =
+      dynamic_cast<const DataRecordOwnsPayload*>(&record);
+  if (record_owns_payload != nullptr) {
+    const folly::IOBuf* iobuf =
+        std::visit(folly::overload(
+                       [&](const PayloadHolder& payload_holder) {
+                         return &payload_holder.iobuf();
+                       },
+                       [](const std::shared_ptr<BufferedWriteDecoder>&)
+                           -> const folly::IOBuf* { return nullptr; }),
+                   record_owns_payload->owner_);
+    if (iobuf != nullptr) {
+      return *iobuf;
+    }
+  }
+  return folly::IOBuf::wrapBufferAsValue(
+      record.payload.data(), record.payload.size());
+}
+} // namespace
+
 int BufferedWriteDecoderImpl::decode(
     std::vector<std::unique_ptr<DataRecord>>&& records,
     std::vector<Payload>& payloads_out) {
@@ -41,22 +68,30 @@ int BufferedWriteDecoderImpl::decodeImpl(
   // `payloads_out' with a batch that ends up failing to decode.
   std::vector<T> payloads_tmp;
   int rv = 0;
+  // Error of the first record that failed to decode, reported in err.
+  Status first_err = E::OK;
   for (auto& recordptr : records) {
     payloads_tmp.clear();
     if (decodeOne(std::move(recordptr), payloads_tmp) == 0) {
       payloads_out.insert(
           payloads_out.end(), payloads_tmp.begin(), payloads_tmp.end());
     } else {
+      if (rv == 0) {
+        first_err = err;
+      }
       rv = -1;
     }
   }
+  if (rv != 0) {
+    err = first_err;
+  }
   return rv;
 }
 
 int BufferedWriteDecoderImpl::decodeOne(std::unique_ptr<DataRecord>&& record,
                                         std::vector<Payload>& payloads_out) {
-  Slice slice(record->payload);
-  return decodeOne(slice,
+  const folly::IOBuf blob = getIOBuf(*record);
+  return decodeOne(blob,
                    payloads_out,
                    std::move(record),
                    /* allow_buffer_sharing */ true);
@@ -65,19 +100,21 @@ int BufferedWriteDecoderImpl::decodeOne(std::unique_ptr<DataRecord>&& record,
 int BufferedWriteDecoderImpl::decodeOne(
     std::unique_ptr<DataRecord>&& record,
     std::vector<PayloadGroup>& payload_groups_out) {
-  // TODO this can be switched to using IOBuf, taken from the record (after
-  // casting to DataRecordOwnsPayload) and allow buffer sharing to avoid copying
-  // buffer
-  Slice slice(record->payload);
-  return decodeOne(slice,
+  // Payload groups handed out to the client must not depend on the lifetime
+  // of the decoder, so only refcounted buffers can be shared.
+  const folly::IOBuf blob = getIOBuf(*record);
+  return decodeOne(blob,
                    payload_groups_out,
                    std::move(record),
-                   /* allow_buffer_sharing */ false);
+                   /* allow_buffer_sharing */ blob.isManaged());
 };
 
+// If the record is backed by an IOBuf, decoded payloads share it rather than
+// copy it even though buffer sharing is not allowed: sharing refcounted
+// buffers doesn't depend on the lifetime of the record.
 int BufferedWriteDecoderImpl::decodeOne(const DataRecord& record,
                                         std::vector<Payload>& payloads_out) {
-  return decodeOne(Slice(record.payload),
+  return decodeOne(getIOBuf(record),
                    payloads_out,
                    nullptr,
                    /* allow_buffer_sharing */ false);
@@ -86,13 +123,13 @@ int BufferedWriteDecoderImpl::decodeOne(const DataRecord& record,
 int BufferedWriteDecoderImpl::decodeOne(
     const DataRecord& record,
     std::vector<PayloadGroup>& payload_groups_out) {
-  return decodeOne(Slice(record.payload),
+  return decodeOne(getIOBuf(record),
                    payload_groups_out,
                    nullptr,
                    /* allow_buffer_sharing */ false);
 };
 
-int BufferedWriteDecoderImpl::decodeOne(Slice blob,
+int BufferedWriteDecoderImpl::decodeOne(const folly::IOBuf& blob,
                                         std::vector<Payload>& payloads_out,
                                         std::unique_ptr<DataRecord>&& record,
                                         bool allow_buffer_sharing) {
@@ -113,12 +150,15 @@ int BufferedWriteDecoderImpl::decodeOne(Slice blob,
 
   bool has_unmanaged_buffers = false;
   for (auto& iobuf : payloads) {
+    // Payloads are only chained if they straddle buffers of a chained blob.
+    // Payload needs contiguous memory, so only those get copied.
     iobuf.coalesce();
     const size_t len = iobuf.length();
     payloads_out.emplace_back(len ? iobuf.data() : nullptr, len);
     if (iobuf.isManaged()) {
-      // Data is not shared with blob, so it must be pinned, otherwise payload
-      // will point to deallocated memory
+      // Data is either a decompression buffer or a refcounted slice of the
+      // blob. It must be pinned, otherwise payload will point to deallocated
+      // memory
       pinned_buffers_.push_back(std::move(iobuf));
     } else {
       has_unmanaged_buffers = true;
@@ -140,7 +180,7 @@ int BufferedWriteDecoderImpl::decodeOne(Slice blob,
 }
 
 int BufferedWriteDecoderImpl::decodeOne(
-    Slice blob,
+    const folly::IOBuf& blob,
     std::vector<PayloadGroup>& payload_groups_out,
     std::unique_ptr<DataRecord>&& record,
     bool allow_buffer_sharing) {
@@ -177,32 +217,6 @@ int BufferedWriteDecoderImpl::decodeOne(
   return 0;
 }
 
-namespace {
-/**
- * Gets IOBuf from the record to allow IOBuf sharing. If record is backed by
- * IOBuf, then that IOBuf is returned. Otherwise just wraps payload in IOBuf.
- */
-folly::IOBuf getIOBuf(const DataRecord& record) {
-  auto record_owns_payload =
-      dynamic_cast<const DataRecordOwnsPayload*>(&record);
-  if (record_owns_payload != nullptr) {
-    const folly::IOBuf* iobuf =
-        std::visit(folly::overload(
-                       [&](const PayloadHolder& payload_holder) {
-                         return &payload_holder.iobuf();
-                       },
-                       [](const std::shared_ptr<BufferedWriteDecoder>&)
-                           -> const folly::IOBuf* { return nullptr; }),
-                   record_owns_payload->owner_);
-    if (iobuf != nullptr) {
-      return *iobuf;
-    }
-  }
-  return folly::IOBuf::wrapBufferAsValue(
-      record.payload.data(), record.payload.size());
-}
-} // namespace
-
 int BufferedWriteDecoderImpl::decodeOneCompressed(
     std::unique_ptr<DataRecord>&& record,
     CompressedPayloadGroups& compressed_payload_groups_out) {
@@ -63,12 +63,14 @@ class BufferedWriteDecoderImpl : public BufferedWriteDecoder {
 
  private:
   // Internal variant of decodeOne() where `record' is optional (`blob' may
-  // point into a manually managed piece of memory).
-  int decodeOne(Slice blob,
+  // point into a manually managed piece of memory). If `blob' is managed
+  // (e.g. the IOBuf backing a DataRecordOwnsPayload), payloads share its
+  // buffers instead of pinning `record' or copying.
+  int decodeOne(const folly::IOBuf& blob,
                 std::vector<Payload>& payloads_out,
                 std::unique_ptr<DataRecord>&& record,
                 bool allow_buffer_sharing);
-  int decodeOne(Slice blob,
+  int decodeOne(const folly::IOBuf& blob,
                 std::vector<PayloadGroup>& payload_groups_out,
                 std::unique_ptr<DataRecord>&& record,
                 bool allow_buffer_sharing);
@@ -79,8 +81,8 @@ class BufferedWriteDecoderImpl : public BufferedWriteDecoder {
 
   // DataRecord instances we decoded and assumed ownership of from the client
   folly::fbvector<std::unique_ptr<DataRecord>> pinned_data_records_;
-  // Buffers used for decompression; Payload instances we returned to the
-  // client point into these buffers.
+  // Buffers used for decompression and slices of IOBuf-backed records;
+  // Payload instances we returned to the client point into these buffers.
   folly::fbvector<folly::IOBuf> pinned_buffers_;
 };
 }} // namespace facebook::logdevice
@@ -86,6 +86,11 @@ void describeBufferedWriterOptions(options_description& po,
           }),
       "Algorithm to use for client-side compression in Buffered writer. 'none' "
       "for no compression. Supported values: 'zstd', 'lz4', 'lz4_hc'.");
+  po.add_options()((prefix + "zstd-dictionary-id").c_str(),
+                   value<uint32_t>(&opts->zstd_dictionary_id)
+                       ->default_value(opts->zstd_dictionary_id),
+                   "If nonzero and compression is zstd, compress batches with "
+                   "the ZSTD dictionary registered under this ID.");
   po.add_options()((prefix + "memory-limit-mb").c_str(),
                    value<int32_t>(&opts->memory_limit_mb)
                        ->default_value(opts->memory_limit_mb),
@@ -305,8 +305,11 @@ void BufferedWriterSingleLog::sendBatch(Batch& batch) {
     ld_check_eq(batch.blob.length(), 0);
 
     setBatchState(batch, Batch::State::CONSTRUCTING_BLOB);
-    construct_blob(
-        batch, checksumBits(), options_.compression, options_.destroy_payloads);
+    construct_blob(batch,
+                   checksumBits(),
+                   options_.compression,
+                   options_.zstd_dictionary_id,
+                   options_.destroy_payloads);
   } else {
     // This is a retry, so we must have already sent it, so we can skip the
     // purgatory of READY_TO_SEND.
@@ -626,6 +629,7 @@ void encode_batch(BufferedWriterSingleLog::Batch& batch,
                   int checksum_bits,
                   Compression compression,
                   int zstd_level,
+                  uint32_t zstd_dictionary_id,
                   bool destroy_payloads) {
   ld_check(batch.total_size_freed == 0);
 
@@ -678,7 +682,7 @@ void encode_batch(BufferedWriterSingleLog::Batch& batch,
     }
   }
   folly::IOBufQueue encoded;
-  encoder.encode(encoded, compression, zstd_level);
+  encoder.encode(encoded, compression, zstd_level, zstd_dictionary_id);
   batch.blob = encoded.moveAsValue();
 }
 } // namespace
@@ -688,16 +692,27 @@ void BufferedWriterSingleLog::Impl::construct_compressed_blob(
     int checksum_bits,
     Compression compression,
     int zstd_level,
-    bool destroy_payloads) {
+    bool destroy_payloads,
+    uint32_t zstd_dictionary_id) {
   switch (batch.blob_format) {
-    case BufferedWriteCodec::Format::SINGLE_PAYLOADS: {
+    case BufferedWriteCodec::Format::SINGLE_PAYLOADS:
+    case BufferedWriteCodec::Format::SINGLE_PAYLOADS_ZSTD_DICT: {
       encode_batch<BufferedWriteSinglePayloadsCodec::Encoder>(
-          batch, checksum_bits, compression, zstd_level, destroy_payloads);
+          batch,
+          checksum_bits,
+          compression,
+          zstd_level,
+          zstd_dictionary_id,
+          destroy_payloads);
       break;
     }
     case BufferedWriteCodec::Format::PAYLOAD_GROUPS: {
-      encode_batch<PayloadGroupCodec::Encoder>(
-          batch, checksum_bits, compression, zstd_level, destroy_payloads);
+      encode_batch<PayloadGroupCodec::Encoder>(batch,
+                                               checksum_bits,
+                                               compression,
+                                               zstd_level,
+                                               zstd_dictionary_id,
+                                               destroy_payloads);
       break;
     }
   }
@@ -708,17 +723,23 @@ void BufferedWriterSingleLog::Impl::construct_blob_long_running(
     int checksum_bits,
     Compression compression,
     const int zstd_level,
-    bool destroy_payloads) {
+    bool destroy_payloads,
+    uint32_t zstd_dictionary_id) {
   ld_check(batch.state == Batch::State::CONSTRUCTING_BLOB);
 
-  construct_compressed_blob(
-      batch, checksum_bits, compression, zstd_level, destroy_payloads);
+  construct_compressed_blob(batch,
+                            checksum_bits,
+                            compression,
+                            zstd_level,
+                            destroy_payloads,
+                            zstd_dictionary_id);
 }
 
 void BufferedWriterSingleLog::construct_blob(
     BufferedWriterSingleLog::Batch& batch,
     int checksum_bits,
     Compression compression,
+    uint32_t zstd_dictionary_id,
     bool destroy_payloads) {
   ld_check(batch.state == Batch::State::CONSTRUCTING_BLOB);
 
@@ -736,8 +757,12 @@ void BufferedWriterSingleLog::construct_blob(
 
   if (batch.blob_bytes_total <
       Worker::settings().buffered_writer_bg_thread_bytes_threshold) {
-    Impl::construct_blob_long_running(
-        batch, checksum_bits, compression, zstd_level, destroy_payloads);
+    Impl::construct_blob_long_running(batch,
+                                      checksum_bits,
+                                      compression,
+                                      zstd_level,
+                                      destroy_payloads,
+                                      zstd_dictionary_id);
     readyToSend(batch);
   } else {
     ProcessorProxy* processor_proxy = parent_->parent_->processorProxy();
@@ -757,9 +782,15 @@ void BufferedWriterSingleLog::construct_blob(
          thread_affinity = Worker::onThisThread()->idx_.val(),
          compression,
          zstd_level,
+         zstd_dictionary_id,
          this]() mutable {
           BufferedWriterSingleLog::Impl::construct_blob_long_running(
-              batch, checksum_bits, compression, zstd_level, destroy_payloads);
+              batch,
+              checksum_bits,
+              compression,
+              zstd_level,
+              destroy_payloads,
+              zstd_dictionary_id);
           std::unique_ptr<Request> request =
               std::make_unique<ContinueBlobSendRequest>(
                   this, batch, thread_affinity);
@@ -166,7 +166,8 @@ class BufferedWriterSingleLog {
                                             int checksum_bits,
                                             Compression compression,
                                             int zstd_level,
-                                            bool destroy_payloads);
+                                            bool destroy_payloads,
+                                            uint32_t zstd_dictionary_id = 0);
 
     // Constructs a blob from a batch.  Copies and compresses the data, so is
     // therefore potentially long running.
@@ -174,7 +175,8 @@ class BufferedWriterSingleLog {
                                           int checksum_bits,
                                           Compression compression,
                                           int zstd_level,
-                                          bool destroy_payloads);
+                                          bool destroy_payloads,
+                                          uint32_t zstd_dictionary_id = 0);
   };
 
   // We add ourselves to the BufferedWriterShard's `flushable' list when there
@@ -279,6 +281,7 @@ class BufferedWriterSingleLog {
   void construct_blob(Batch& batch,
                       int checksum_bits,
                       Compression compresssion,
+                      uint32_t zstd_dictionary_id,
                       bool destroy_payloads);
 
   BufferedWriterShard* parent_;
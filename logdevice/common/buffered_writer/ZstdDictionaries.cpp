@@ -0,0 +1,256 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/buffered_writer/ZstdDictionaries.h"
+
+#include <algorithm>
+#include <mutex>
+#include <zdict.h>
+#include <zstd.h>
+
+#include <folly/Random.h>
+#include <folly/executors/GlobalExecutor.h>
+
+#include "logdevice/common/debug.h"
+#include "logdevice/include/Err.h"
+
+namespace facebook { namespace logdevice {
+
+ZstdDictionaries& ZstdDictionaries::instance() {
+  // Leaked so that it's usable from static destructors of other objects.
+  static ZstdDictionaries* dictionaries = new ZstdDictionaries();
+  return *dictionaries;
+}
+
+int ZstdDictionaries::add(uint32_t id, std::string dictionary) {
+  std::unique_lock<folly::SharedMutex> lock(mutex_);
+  return addLocked(id, std::move(dictionary));
+}
+
+int ZstdDictionaries::addLocked(uint32_t id, std::string dictionary) {
+  if (id == 0 || dictionary.empty()) {
+    err = E::INVALID_PARAM;
+    return -1;
+  }
+  auto it = dictionaries_.find(id);
+  if (it != dictionaries_.end()) {
+    if (it->second.bytes != dictionary) {
+      ld_error("A different ZSTD dictionary with id %u is already registered",
+               id);
+      err = E::EXISTS;
+      return -1;
+    }
+    return 0;
+  }
+
+  ZSTD_DDict* ddict = ZSTD_createDDict(dictionary.data(), dictionary.size());
+  if (ddict == nullptr) {
+    ld_error("ZSTD_createDDict() failed for dictionary %u of size %zu",
+             id,
+             dictionary.size());
+    err = E::INVALID_PARAM;
+    return -1;
+  }
+  not_found_.erase(id);
+  Entry& entry = dictionaries_[id];
+  entry.bytes = std::move(dictionary);
+  entry.ddict =
+      std::shared_ptr<const ZSTD_DDict>(ddict, [](const ZSTD_DDict* d) {
+        ZSTD_freeDDict(const_cast<ZSTD_DDict*>(d));
+      });
+  return 0;
+}
+
+void ZstdDictionaries::setFetcher(Fetcher fetcher,
+                                  std::chrono::milliseconds not_found_ttl) {
+  std::unique_lock<folly::SharedMutex> lock(mutex_);
+  fetcher_ = std::move(fetcher);
+  not_found_ttl_ = not_found_ttl;
+  // Failures and fetches in progress were the previous fetcher's.
+  fetching_.clear();
+  not_found_.clear();
+  ++generation_;
+}
+
+std::shared_ptr<const ZSTD_CDict> ZstdDictionaries::getCDict(uint32_t id,
+                                                             int level) {
+  const auto key = std::make_pair(id, level);
+  {
+    folly::SharedMutex::ReadHolder lock(mutex_);
+    auto it = cdicts_.find(key);
+    if (it != cdicts_.end()) {
+      return it->second;
+    }
+  }
+
+  std::unique_lock<folly::SharedMutex> lock(mutex_);
+  auto it = cdicts_.find(key);
+  if (it != cdicts_.end()) {
+    return it->second;
+  }
+  auto entry = dictionaries_.find(id);
+  if (entry == dictionaries_.end()) {
+    return nullptr;
+  }
+  ZSTD_CDict* cdict = ZSTD_createCDict(
+      entry->second.bytes.data(), entry->second.bytes.size(), level);
+  if (cdict == nullptr) {
+    ld_error("ZSTD_createCDict() failed for dictionary %u, level %d",
+             id,
+             level);
+    return nullptr;
+  }
+  std::shared_ptr<const ZSTD_CDict> res(cdict, [](const ZSTD_CDict* c) {
+    ZSTD_freeCDict(const_cast<ZSTD_CDict*>(c));
+  });
+  cdicts_.emplace(key, res);
+  return res;
+}
+
+std::shared_ptr<const ZSTD_DDict> ZstdDictionaries::getDDict(uint32_t id) {
+  {
+    folly::SharedMutex::ReadHolder lock(mutex_);
+    auto it = dictionaries_.find(id);
+    if (it != dictionaries_.end()) {
+      return it->second.ddict;
+    }
+    if (recentlyNotFound(id)) {
+      err = E::NOTFOUND;
+      return nullptr;
+    }
+  }
+
+  std::unique_lock<folly::SharedMutex> lock(mutex_);
+  auto it = dictionaries_.find(id);
+  if (it != dictionaries_.end()) {
+    return it->second.ddict;
+  }
+  if (recentlyNotFound(id)) {
+    err = E::NOTFOUND;
+    return nullptr;
+  }
+  err = prefetchLocked(id) ? E::AGAIN : E::NOTFOUND;
+  return nullptr;
+}
+
+void ZstdDictionaries::prefetch(uint32_t id) {
+  std::unique_lock<folly::SharedMutex> lock(mutex_);
+  if (!dictionaries_.count(id) && !recentlyNotFound(id)) {
+    prefetchLocked(id);
+  }
+}
+
+bool ZstdDictionaries::recentlyNotFound(uint32_t id) const {
+  auto it = not_found_.find(id);
+  return it != not_found_.end() &&
+      std::chrono::steady_clock::now() < it->second + not_found_ttl_;
+}
+
+bool ZstdDictionaries::has(uint32_t id) {
+  folly::SharedMutex::ReadHolder lock(mutex_);
+  return dictionaries_.count(id) > 0;
+}
+
+bool ZstdDictionaries::prefetchLocked(uint32_t id) {
+  if (!fetcher_) {
+    return false;
+  }
+  if (!fetching_.insert(id).second) {
+    // Already being fetched.
+    return true;
+  }
+
+  folly::getIOExecutor()->add(
+      [this, id, fetcher = fetcher_, generation = generation_] {
+        std::string dictionary = fetcher(id);
+        if (dictionary.empty()) {
+          RATELIMIT_ERROR(
+              std::chrono::seconds(10), 1, "Unknown ZSTD dictionary %u", id);
+        }
+
+        std::unique_lock<folly::SharedMutex> lock(mutex_);
+        if (generation != generation_) {
+          // clear() or setFetcher() was called since the fetch started.
+          return;
+        }
+        fetching_.erase(id);
+        // addLocked() fails if the dictionary is invalid or a different one
+        // got add()ed meanwhile, and logs the error.
+        if (dictionary.empty() ||
+            (addLocked(id, std::move(dictionary)) != 0 &&
+             !dictionaries_.count(id))) {
+          not_found_[id] = std::chrono::steady_clock::now();
+        }
+      });
+  return true;
+}
+
+std::string ZstdDictionaries::train(const std::vector<std::string>& samples,
+                                    size_t dictionary_size) {
+  std::string concatenated;
+  std::vector<size_t> sizes;
+  sizes.reserve(samples.size());
+  for (const std::string& sample : samples) {
+    concatenated += sample;
+    sizes.push_back(sample.size());
+  }
+
+  std::string dictionary(dictionary_size, '\0');
+  size_t rv = ZDICT_trainFromBuffer(&dictionary[0],
+                                    dictionary.size(),
+                                    concatenated.data(),
+                                    sizes.data(),
+                                    sizes.size());
+  if (ZDICT_isError(rv)) {
+    ld_warning("ZDICT_trainFromBuffer() failed on %zu samples of total size "
+               "%zu: %s",
+               samples.size(),
+               concatenated.size(),
+               ZDICT_getErrorName(rv));
+    return std::string();
+  }
+  dictionary.resize(rv);
+  return dictionary;
+}
+
+void ZstdDictionaries::clear() {
+  std::unique_lock<folly::SharedMutex> lock(mutex_);
+  dictionaries_.clear();
+  cdicts_.clear();
+  fetcher_ = nullptr;
+  not_found_ttl_ = DEFAULT_NOT_FOUND_TTL;
+  fetching_.clear();
+  not_found_.clear();
+  ++generation_;
+}
+
+ZstdDictionaryTrainer::ZstdDictionaryTrainer(size_t max_samples,
+                                             size_t max_sample_size)
+    : max_samples_(max_samples), max_sample_size_(max_sample_size) {
+  ld_check(max_samples_ > 0);
+}
+
+void ZstdDictionaryTrainer::addSample(Slice payload) {
+  const size_t size = std::min(payload.size, max_sample_size_);
+  ++seen_;
+  if (samples_.size() < max_samples_) {
+    samples_.emplace_back(static_cast<const char*>(payload.data), size);
+    return;
+  }
+  // Keep the payload with probability max_samples_ / seen_, replacing a
+  // random sample.
+  const uint64_t idx = folly::Random::rand64(seen_);
+  if (idx < max_samples_) {
+    samples_[idx].assign(static_cast<const char*>(payload.data), size);
+  }
+}
+
+std::string ZstdDictionaryTrainer::train(size_t dictionary_size) const {
+  return ZstdDictionaries::train(samples_, dictionary_size);
+}
+
+}} // namespace facebook::logdevice
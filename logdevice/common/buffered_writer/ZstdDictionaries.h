@@ -0,0 +1,206 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <folly/SharedMutex.h>
+#include <folly/hash/Hash.h>
+
+#include "logdevice/include/types.h"
+
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+
+namespace facebook { namespace logdevice {
+
+/**
+ * Process-wide registry of ZSTD dictionaries used by BufferedWriter batches
+ * in the SINGLE_PAYLOADS_ZSTD_DICT format (see BufferedWriteCodec.h).
+ *
+ * Batches only carry the numeric ID of the dictionary they were compressed
+ * with, so both the writer and every reader of the log need the dictionary
+ * bytes registered under the same ID. Dictionaries are immutable once
+ * registered: a new version of a dictionary must get a new ID, so that
+ * records written with the old version stay readable.
+ *
+ * Readers that don't know a dictionary up front can install a fetcher that
+ * is called the first time an unknown ID is encountered (e.g. to read it
+ * from a config store or an internal log). The fetcher runs asynchronously
+ * on the global IO executor, since decoding happens on threads that must not
+ * block, e.g. client workers; batches are undecodable until the fetch
+ * completes. Digested dictionaries are cached, so the cost of loading a
+ * dictionary is only paid once per process. IDs the fetcher couldn't find
+ * are remembered for a while, so that readers of batches compressed with a
+ * lost dictionary get a definite error rather than being told to retry.
+ *
+ * Thread-safe.
+ */
+class ZstdDictionaries {
+ public:
+  // Returns the bytes of dictionary with the given ID, or an empty string if
+  // it's unknown. Called on the global IO executor without any locks held;
+  // may block.
+  using Fetcher = std::function<std::string(uint32_t id)>;
+
+  static ZstdDictionaries& instance();
+
+  /**
+   * Registers dictionary @param dictionary under @param id.
+   *
+   * @return  0 on success, -1 on failure with err set to:
+   *            INVALID_PARAM  id is 0 or dictionary is empty
+   *            EXISTS         a different dictionary is registered with this ID
+   */
+  int add(uint32_t id, std::string dictionary);
+
+  static constexpr std::chrono::milliseconds DEFAULT_NOT_FOUND_TTL{60000};
+
+  /**
+   * Sets the function used to look up dictionaries that weren't add()ed.
+   * Successfully fetched dictionaries are registered as if add() was called.
+   *
+   * @param not_found_ttl  for how long an ID that the fetcher returned
+   *                       nothing (or an invalid dictionary) for is reported
+   *                       as unknown before it is fetched again
+   */
+  void setFetcher(Fetcher fetcher,
+                  std::chrono::milliseconds not_found_ttl =
+                      DEFAULT_NOT_FOUND_TTL);
+
+  /**
+   * Returns the dictionary with the given ID digested for compression at
+   * @param level, or nullptr if the dictionary is unknown. Doesn't call the
+   * fetcher: writers are expected to register their dictionaries up front.
+   */
+  std::shared_ptr<const ZSTD_CDict_s> getCDict(uint32_t id, int level);
+
+  /**
+   * Returns the dictionary with the given ID digested for decompression.
+   * Never blocks on the fetcher: if the dictionary is not registered yet,
+   * starts fetching it (see prefetch()) and returns nullptr.
+   *
+   * @return  the dictionary, or nullptr with err set to:
+   *            AGAIN     the dictionary is being fetched, try again later
+   *            NOTFOUND  the dictionary is unknown and there is no fetcher,
+   *                      or the last fetch of it failed less than the
+   *                      not-found TTL ago (see setFetcher())
+   */
+  std::shared_ptr<const ZSTD_DDict_s> getDDict(uint32_t id);
+
+  /**
+   * Starts fetching the dictionary with the given ID in the background if it
+   * is not registered or being fetched already. No-op if there is no
+   * fetcher, or if the last fetch of this ID failed recently. Readers that
+   * know which dictionaries they will need can call this ahead of time.
+   */
+  void prefetch(uint32_t id);
+
+  // Whether the dictionary with the given ID is registered.
+  bool has(uint32_t id);
+
+  /**
+   * Trains a dictionary of at most @param dictionary_size bytes on
+   * @param samples.
+   *
+   * @return  the dictionary bytes, or an empty string if training failed
+   *          (typically because there are too few samples)
+   */
+  static std::string train(const std::vector<std::string>& samples,
+                           size_t dictionary_size);
+
+  // Removes all dictionaries and the fetcher, and forgets about fetches in
+  // progress and failed ones. Used in tests.
+  void clear();
+
+ private:
+  struct Entry {
+    std::string bytes;
+    std::shared_ptr<const ZSTD_DDict_s> ddict;
+  };
+
+  // Adds a dictionary, with mutex_ locked exclusively.
+  int addLocked(uint32_t id, std::string dictionary);
+
+  // Schedules a fetch of dictionary `id`, with mutex_ locked exclusively.
+  // @return  false if there is no fetcher.
+  bool prefetchLocked(uint32_t id);
+
+  // Whether the last fetch of `id` failed less than not_found_ttl_ ago, with
+  // mutex_ locked.
+  bool recentlyNotFound(uint32_t id) const;
+
+  folly::SharedMutex mutex_;
+  std::unordered_map<uint32_t, Entry> dictionaries_;
+  // CDicts are specific to a compression level, so they are created lazily
+  // for each (id, level) pair actually used.
+  std::unordered_map<std::pair<uint32_t, int>,
+                     std::shared_ptr<const ZSTD_CDict_s>,
+                     folly::hasher<std::pair<uint32_t, int>>>
+      cdicts_;
+  Fetcher fetcher_;
+  std::chrono::milliseconds not_found_ttl_{DEFAULT_NOT_FOUND_TTL};
+  // IDs of dictionaries currently being fetched.
+  std::unordered_set<uint32_t> fetching_;
+  // IDs the fetcher failed to provide, with the time of the failure.
+  std::unordered_map<uint32_t, std::chrono::steady_clock::time_point>
+      not_found_;
+  // Bumped by clear() and setFetcher(), so that fetches started before are
+  // ignored when they complete.
+  uint64_t generation_ = 0;
+};
+
+/**
+ * Collects a uniform sample of payloads written to a log group, to train a
+ * dictionary on. Uses reservoir sampling, so memory usage is bounded by the
+ * number of samples regardless of how many payloads are seen.
+ *
+ * Not thread-safe.
+ */
+class ZstdDictionaryTrainer {
+ public:
+  /**
+   * @param max_samples      number of payloads to keep
+   * @param max_sample_size  payloads longer than this are truncated; ZSTD
+   *                         gets most of its benefit from the first few KB
+   */
+  explicit ZstdDictionaryTrainer(size_t max_samples = 10000,
+                                 size_t max_sample_size = 16 * 1024);
+
+  void addSample(Slice payload);
+
+  // Number of payloads seen so far, including ones not kept.
+  uint64_t numSeen() const {
+    return seen_;
+  }
+
+  const std::vector<std::string>& samples() const {
+    return samples_;
+  }
+
+  /**
+   * Same as ZstdDictionaries::train() on the collected samples.
+   */
+  std::string train(size_t dictionary_size) const;
+
+ private:
+  const size_t max_samples_;
+  const size_t max_sample_size_;
+  uint64_t seen_ = 0;
+  std::vector<std::string> samples_;
+};
+
+}} // namespace facebook::logdevice
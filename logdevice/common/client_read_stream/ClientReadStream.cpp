@@ -12,6 +12,7 @@
 #include <algorithm>
 #include <chrono>
 #include <cinttypes>
+#include <cstdlib>
 #include <utility>
 
 #include <folly/CppAttributes.h>
@@ -39,6 +40,7 @@
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/client_read_stream/AllClientReadStreams.h"
 #include "logdevice/common/client_read_stream/ClientReadStreamBuffer.h"
+#include "logdevice/common/client_read_stream/ClientReadStreamBufferBudget.h"
 #include "logdevice/common/client_read_stream/ClientReadStreamBufferFactory.h"
 #include "logdevice/common/client_read_stream/ClientReadStreamConnectionHealth.h"
 #include "logdevice/common/client_read_stream/ClientReadStreamScd.h"
@@ -140,6 +142,15 @@ ClientReadStream::ClientReadStream(
     attrs_ = *attrs;
   }
 
+  if (ClientReadStreamBufferBudget* budget = deps_->getBufferBudget()) {
+    // Start with a small window drawn from the budget and let it grow as the
+    // application consumes records. See updateWindowSize().
+    window_size_ =
+        std::min(window_size_, ClientReadStreamBufferBudget::MIN_WINDOW);
+    budget->reserveRecords(window_size_);
+    last_window_update_time_ = std::chrono::steady_clock::now();
+  }
+
   calcWindowHigh();
   calcNextLSNToSlideWindow();
   updateServerWindow();
@@ -452,6 +463,13 @@ void ClientReadStream::start() {
   connection_health_tracker_ =
       std::make_unique<ClientReadStreamConnectionHealth>(this);
 
+  if (deps_->getBufferBudget()) {
+    window_update_timer_ =
+        deps_->createTimer([this] { onWindowUpdateTimer(); });
+    window_update_timer_->activate(
+        ClientReadStreamBufferBudget::WINDOW_TARGET_DURATION);
+  }
+
   if (worker_ &&
       !MetaDataLog::isMetaDataLog(
           log_id_) // Don't create tracer for metadata logs to avoid issues in
@@ -1189,7 +1207,7 @@ void ClientReadStream::onDataRecord(ShardID shard,
 
     if (!rstate->record || rstate->record_corrupted) {
       // Updating info reg. buffer usage.
-      bytes_buffered_ += record->payload.size();
+      adjustBytesBuffered(record->payload.size());
       std::unique_ptr<DataRecordOwnsPayload> data_record;
       std::visit(folly::overload(
                      [&](auto& payload) {
@@ -3456,7 +3474,7 @@ int ClientReadStream::deliverRecord(
     num_records_delivered_++;
     num_bytes_delivered_ += payload_size_map.getCounter(BYTE_OFFSET);
     // Updating info reg. buffer usage.
-    bytes_buffered_ -= payload_size_map.getCounter(BYTE_OFFSET);
+    adjustBytesBuffered(-int64_t(payload_size_map.getCounter(BYTE_OFFSET)));
     if (current_offsets.isValid()) {
       accumulated_offsets_ = std::move(current_offsets);
     }
@@ -3752,13 +3770,80 @@ void ClientReadStream::updateServerWindow() {
           lsn_to_string(server_window_.high).c_str());
 }
 
-void ClientReadStream::updateWindowSize() {
+void ClientReadStream::updateWindowSize(bool shrink_only) {
+  ClientReadStreamBufferBudget* budget = deps_->getBufferBudget();
+  if (budget == nullptr) {
+    if (deps_->hasMemoryPressure()) {
+      // cut the window size in half
+      window_size_ = std::max(size_t(1), window_size_ / 2);
+    } else {
+      // increment window size but not more than what the buffer can hold
+      window_size_ = std::min(buffer_->capacity(), window_size_ + 1);
+    }
+    return;
+  }
+
+  // Bring the byte total up to date before checking it.
+  adjustBytesBuffered(0, /*flush=*/true);
+
+  const auto now = std::chrono::steady_clock::now();
+  const size_t delivered =
+      num_records_delivered_ - records_delivered_at_last_window_update_;
+  const auto elapsed = now - last_window_update_time_;
+  last_window_update_time_ = now;
+  records_delivered_at_last_window_update_ = num_records_delivered_;
+
+  size_t target;
   if (deps_->hasMemoryPressure()) {
     // cut the window size in half
-    window_size_ = std::max(size_t(1), window_size_ / 2);
+    target = std::max(size_t(1), window_size_ / 2);
   } else {
-    // increment window size but not more than what the buffer can hold
-    window_size_ = std::min(buffer_->capacity(), window_size_ + 1);
+    // Each WINDOW update goes to every shard in the read set, so keep at
+    // least one record per shard in the window.
+    const size_t min_window =
+        std::max(ClientReadStreamBufferBudget::MIN_WINDOW, readSetSize());
+    target = ClientReadStreamBufferBudget::targetWindowSize(
+        window_size_, buffer_->capacity(), min_window, delivered, elapsed);
+  }
+
+  if (target < window_size_) {
+    budget->releaseRecords(window_size_ - target);
+    window_size_ = target;
+  } else if (!shrink_only) {
+    window_size_ += budget->acquireRecords(target - window_size_);
+  }
+}
+
+void ClientReadStream::onWindowUpdateTimer() {
+  if (std::chrono::steady_clock::now() - last_window_update_time_ >=
+      ClientReadStreamBufferBudget::WINDOW_TARGET_DURATION) {
+    // The window hasn't slid for a while, e.g. because the log is idle or
+    // the application stopped consuming. Shrink it anyway, so that it
+    // returns the part of the budget it doesn't use. Storage shards keep
+    // the window they were given until the next slide, see
+    // slideSenderWindows().
+    updateWindowSize(/*shrink_only=*/true);
+  }
+  window_update_timer_->activate(
+      ClientReadStreamBufferBudget::WINDOW_TARGET_DURATION);
+}
+
+void ClientReadStream::adjustBytesBuffered(int64_t delta, bool flush) {
+  bytes_buffered_ += delta;
+  ClientReadStreamBufferBudget* budget = deps_->getBufferBudget();
+  if (budget == nullptr) {
+    return;
+  }
+  // Reporting every record would make all read streams of the client
+  // contend on the budget's counter.
+  const int64_t unreported =
+      int64_t(bytes_buffered_) - int64_t(bytes_reported_to_budget_);
+  if (unreported != 0 &&
+      (flush ||
+       std::abs(unreported) >=
+           ClientReadStreamBufferBudget::BYTES_REPORTING_GRANULARITY)) {
+    budget->addBytes(unreported);
+    bytes_reported_to_budget_ = bytes_buffered_;
   }
 }
 
@@ -3774,8 +3859,13 @@ bool ClientReadStream::slideSenderWindows() {
     return false;
   }
 
+  const lsn_t prev_window_high = window_high_;
   updateWindowSize();
   calcWindowHigh();
+  // Storage shards may have sent records up to the window they were last
+  // given, so don't move its end back if the window shrank a lot, e.g. in
+  // onWindowUpdateTimer(). The smaller size takes effect at the next slide.
+  window_high_ = std::max(window_high_, prev_window_high);
   calcNextLSNToSlideWindow();
 
   if (reader_) {
@@ -3953,6 +4043,11 @@ ClientReadStream::~ClientReadStream() {
     TAGGED_STAT_DECR(Worker::stats(), monitoring_tags_, num_read_streams);
   }
 
+  if (ClientReadStreamBufferBudget* budget = deps_->getBufferBudget()) {
+    budget->releaseRecords(window_size_);
+    budget->addBytes(-int64_t(bytes_reported_to_budget_));
+  }
+
   // Not safe to destroy while executing a callback
   ld_check(!inside_callback_);
 
@@ -4200,6 +4295,7 @@ void ClientReadStream::rewind(std::string reason) {
 
   // clear the entire read stream buffer
   buffer_->clear();
+  adjustBytesBuffered(-int64_t(bytes_buffered_), /*flush=*/true);
 
   gap_end_outside_window_ = LSN_INVALID;
 
@@ -4424,8 +4520,7 @@ ClientReadStreamDependencies::ClientReadStreamDependencies() = default;
 ClientReadStreamDependencies::~ClientReadStreamDependencies() {}
 
 bool ClientReadStreamDependencies::hasMemoryPressure() const {
-  // TODO(T6159466): implement memory limits/accounting
-  return false;
+  return buffer_budget_ != nullptr && buffer_budget_->overBytesBudget();
 }
 
 bool ClientReadStreamDependencies::isWorkerOverloaded() const {
@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include <chrono>
 #include <cstddef>
 #include <functional>
 #include <memory>
@@ -42,6 +43,7 @@ namespace facebook { namespace logdevice {
 class BackoffTimer;
 class ClientGapTracer;
 class ClientReadStreamBuffer;
+class ClientReadStreamBufferBudget;
 class ClientReadStreamConnectionHealth;
 class ClientReadStreamScd;
 class ClientReadTracer;
@@ -324,6 +326,18 @@ class ClientReadStreamDependencies {
     reader_name_ = reader_name;
   }
 
+  /**
+   * Makes the read stream draw its window from a budget shared with other
+   * read streams. The budget must outlive the read stream.
+   */
+  void setBufferBudget(ClientReadStreamBufferBudget* budget) {
+    buffer_budget_ = budget;
+  }
+
+  ClientReadStreamBufferBudget* getBufferBudget() const {
+    return buffer_budget_;
+  }
+
   read_stream_id_t getReadStreamID() const {
     return read_stream_id_;
   }
@@ -344,6 +358,8 @@ class ClientReadStreamDependencies {
 
   virtual ~ClientReadStreamDependencies();
 
+  // True if read streams sharing our buffer budget buffer more payload bytes
+  // than it allows.
   virtual bool hasMemoryPressure() const;
 
   virtual bool isWorkerOverloaded() const;
@@ -353,6 +369,7 @@ class ClientReadStreamDependencies {
   logid_t log_id_;
   std::string client_session_id_;
   std::string reader_name_;
+  ClientReadStreamBufferBudget* buffer_budget_{nullptr};
   record_cb_t record_callback_;
   gap_cb_t gap_callback_;
   done_cb_t done_callback_;
@@ -1008,8 +1025,25 @@ class ClientReadStream : boost::noncopyable {
   /**
    * Evaluates current conditions and update the size of the next window if
    * needed. This does not change the current window.
+   *
+   * @param shrink_only  only let the window shrink, used when it's
+   *                     re-evaluated without sliding
+   */
+  void updateWindowSize(bool shrink_only = false);
+
+  /**
+   * Called every WINDOW_TARGET_DURATION if the window is drawn from a
+   * ClientReadStreamBufferBudget. Shrinks the window if it hasn't slid since
+   * the previous call.
+   */
+  void onWindowUpdateTimer();
+
+  /**
+   * Updates bytes_buffered_, and the buffer budget, if any, once the bytes
+   * not reported to it reach BYTES_REPORTING_GRANULARITY or if @param flush
+   * is true.
    */
-  void updateWindowSize();
+  void adjustBytesBuffered(int64_t delta, bool flush = false);
 
   /**
    * Set shard's connection state. Used in tests only.
@@ -1441,9 +1475,19 @@ class ClientReadStream : boost::noncopyable {
    * dynamically scaled to accommodate constraints such as memory pressure.
    * The window size is bounded by the client_read_buffer_size which limits the
    * maximum number of records that can be buffered at any given time.
+   * If deps_ has a ClientReadStreamBufferBudget, the window is drawn from it.
    */
   size_t window_size_;
 
+  // When the window size was last updated, and num_records_delivered_ at that
+  // time. Used to size windows drawn from a ClientReadStreamBufferBudget.
+  std::chrono::steady_clock::time_point last_window_update_time_;
+  size_t records_delivered_at_last_window_update_{0};
+
+  // Re-evaluates a window drawn from a ClientReadStreamBufferBudget that
+  // doesn't slide, see onWindowUpdateTimer().
+  std::unique_ptr<Timer> window_update_timer_;
+
   /**
    * The largest LSN in sender's sliding window. This member variable
    * is employed to avoid doing the math every time we call
@@ -1653,6 +1697,9 @@ class ClientReadStream : boost::noncopyable {
   // Counter of the size (in bytes) of the current ReadStream.
   size_t bytes_buffered_{0};
 
+  // Part of bytes_buffered_ accounted in the ClientReadStreamBufferBudget.
+  size_t bytes_reported_to_budget_{0};
+
   /**
    * When we are in all send all mode but SCD is in use on the log, there is a
    * race condition that can cause erroneous data loss reporting. We fix this by
@@ -0,0 +1,101 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/client_read_stream/ClientReadStreamBufferBudget.h"
+
+#include <algorithm>
+
+#include "logdevice/common/checks.h"
+#include "logdevice/common/stats/Stats.h"
+
+namespace facebook { namespace logdevice {
+
+constexpr size_t ClientReadStreamBufferBudget::MIN_WINDOW;
+constexpr std::chrono::milliseconds
+    ClientReadStreamBufferBudget::WINDOW_TARGET_DURATION;
+constexpr size_t ClientReadStreamBufferBudget::BYTES_REPORTING_GRANULARITY;
+
+ClientReadStreamBufferBudget::ClientReadStreamBufferBudget(size_t max_records,
+                                                           size_t max_bytes,
+                                                           StatsHolder* stats)
+    : max_records_(max_records), max_bytes_(max_bytes), stats_(stats) {}
+
+size_t ClientReadStreamBufferBudget::acquireRecords(size_t records) {
+  if (records == 0) {
+    return 0;
+  }
+  if (max_records_ == 0) {
+    reserveRecords(records);
+    return records;
+  }
+
+  size_t current = records_.load();
+  size_t granted;
+  do {
+    granted =
+        current >= max_records_ ? 0 : std::min(records, max_records_ - current);
+    if (granted == 0) {
+      break;
+    }
+  } while (!records_.compare_exchange_weak(current, current + granted));
+
+  if (granted < records) {
+    STAT_INCR(stats_, client.read_buffer_budget_exhausted);
+  }
+  STAT_ADD(stats_, client.read_buffer_budget_records, granted);
+  return granted;
+}
+
+void ClientReadStreamBufferBudget::reserveRecords(size_t records) {
+  records_.fetch_add(records);
+  STAT_ADD(stats_, client.read_buffer_budget_records, records);
+}
+
+void ClientReadStreamBufferBudget::releaseRecords(size_t records) {
+  ld_check(records_.load() >= records);
+  records_.fetch_sub(records);
+  STAT_SUB(stats_, client.read_buffer_budget_records, records);
+}
+
+void ClientReadStreamBufferBudget::addBytes(int64_t delta) {
+  bytes_.fetch_add(delta);
+  STAT_ADD(stats_, client.read_buffer_budget_bytes, delta);
+}
+
+bool ClientReadStreamBufferBudget::overBytesBudget() const {
+  return max_bytes_ > 0 && getBytes() > max_bytes_;
+}
+
+/* static */
+size_t ClientReadStreamBufferBudget::targetWindowSize(
+    size_t window_size,
+    size_t capacity,
+    size_t min_window,
+    size_t delivered,
+    std::chrono::steady_clock::duration elapsed) {
+  using seconds_double = std::chrono::duration<double>;
+  ld_check(capacity > 0);
+  min_window = std::min(min_window, capacity);
+
+  // Records the application would consume in WINDOW_TARGET_DURATION at the
+  // rate observed since the previous slide.
+  const double elapsed_sec =
+      std::max(std::chrono::duration_cast<seconds_double>(elapsed).count(),
+               1e-6);
+  const double wanted = delivered / elapsed_sec *
+      std::chrono::duration_cast<seconds_double>(WINDOW_TARGET_DURATION)
+          .count();
+
+  // Grow at most 2x per slide so that a burst does not grab a large part of
+  // the budget at once.
+  const size_t max_window = std::min(capacity, 2 * window_size);
+  const size_t target =
+      wanted >= max_window ? max_window : static_cast<size_t>(wanted);
+  return std::max(target, min_window);
+}
+
+}} // namespace facebook::logdevice
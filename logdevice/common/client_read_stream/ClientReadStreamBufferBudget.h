@@ -0,0 +1,146 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include <boost/noncopyable.hpp>
+
+namespace facebook { namespace logdevice {
+
+class StatsHolder;
+
+/**
+ * @file ClientReadStreamBufferBudget is a memory budget shared by all
+ *       ClientReadStreams of a Client, across all workers. Instead of each
+ *       stream advertising a window of client-read-buffer-size records to
+ *       storage shards, streams draw their window (in records) from the
+ *       budget and return it when the window shrinks or the stream goes
+ *       away. Payload bytes buffered by the streams are accounted as well;
+ *       when they exceed the byte budget, streams halve their windows on the
+ *       next slide (see ClientReadStreamDependencies::hasMemoryPressure()).
+ *
+ *       Window sizes follow consumption: at each slide a stream sizes its
+ *       window to about WINDOW_TARGET_DURATION worth of records at the rate
+ *       the application consumed them since the previous slide, at most
+ *       doubling it at a time. Streams whose consumer keeps up grow towards
+ *       the per-stream buffer capacity. A stream whose window doesn't slide,
+ *       e.g. an idle tailing stream, re-evaluates it every
+ *       WINDOW_TARGET_DURATION, shrinks back towards MIN_WINDOW and leaves
+ *       the rest of the budget to others.
+ *
+ *       Every stream is always granted a window of at least MIN_WINDOW
+ *       records so that it can make progress, so the total may exceed the
+ *       record budget by that much per stream.
+ *
+ *       This class is thread-safe.
+ */
+
+class ClientReadStreamBufferBudget : boost::noncopyable {
+ public:
+  // Smallest window a stream is shrunk to.
+  static constexpr size_t MIN_WINDOW = 16;
+
+  // How much consumption a window should cover. Also how often a stream
+  // whose window hasn't slid re-evaluates it.
+  static constexpr std::chrono::milliseconds WINDOW_TARGET_DURATION{1000};
+
+  // Streams report their buffered bytes to the budget once they have changed
+  // by this much, rather than on every record, so the byte total may be off
+  // by this much per stream.
+  static constexpr size_t BYTES_REPORTING_GRANULARITY = 16 * 1024;
+
+  /**
+   * @param max_records  total number of records in the windows of all read
+   *                     streams, 0 for no limit
+   * @param max_bytes    total payload bytes buffered by all read streams,
+   *                     0 for no limit
+   * @param stats        stats to report utilization to, may be nullptr
+   */
+  ClientReadStreamBufferBudget(size_t max_records,
+                               size_t max_bytes,
+                               StatsHolder* stats = nullptr);
+
+  /**
+   * Grants up to `records` more window records to a stream.
+   *
+   * @return  the number of records granted, possibly 0 if the budget is
+   *          exhausted
+   */
+  size_t acquireRecords(size_t records);
+
+  /**
+   * Unconditionally adds `records` to the granted total. Used for the
+   * initial MIN_WINDOW of a stream.
+   */
+  void reserveRecords(size_t records);
+
+  /**
+   * Returns window records to the budget.
+   */
+  void releaseRecords(size_t records);
+
+  /**
+   * Accounts for payload bytes added to (delta > 0) or removed from
+   * (delta < 0) the buffer of a stream. Streams batch their updates, see
+   * BYTES_REPORTING_GRANULARITY.
+   */
+  void addBytes(int64_t delta);
+
+  /**
+   * @return  true if read streams currently buffer more payload bytes than
+   *          the byte budget allows.
+   */
+  bool overBytesBudget() const;
+
+  size_t getRecords() const {
+    return records_.load();
+  }
+
+  size_t getBytes() const {
+    int64_t bytes = bytes_.load();
+    return bytes > 0 ? bytes : 0;
+  }
+
+  size_t getMaxRecords() const {
+    return max_records_;
+  }
+
+  size_t getMaxBytes() const {
+    return max_bytes_;
+  }
+
+  /**
+   * Computes the window size a stream should ask for when sliding its
+   * window.
+   *
+   * @param window_size  current window size
+   * @param capacity     capacity of the stream's buffer, the largest window
+   * @param min_window   smallest window for this stream
+   * @param delivered    records delivered since the previous slide
+   * @param elapsed      time since the previous slide
+   */
+  static size_t targetWindowSize(size_t window_size,
+                                 size_t capacity,
+                                 size_t min_window,
+                                 size_t delivered,
+                                 std::chrono::steady_clock::duration elapsed);
+
+ private:
+  const size_t max_records_;
+  const size_t max_bytes_;
+  StatsHolder* const stats_;
+
+  std::atomic<size_t> records_{0};
+  std::atomic<int64_t> bytes_{0};
+};
+
+}} // namespace facebook::logdevice
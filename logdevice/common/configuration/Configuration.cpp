@@ -79,6 +79,11 @@ folly::Optional<std::string> Configuration::getLogGroupPath(logid_t id) const {
   return localLogsConfig()->getLogGroupPath(id);
 }
 
+log_group_stats_idx_t Configuration::getLogGroupStatsIdx(logid_t id) const {
+  ld_check(logs_config_->isLocal());
+  return localLogsConfig()->getLogGroupStatsIdx(id);
+}
+
 std::chrono::seconds Configuration::getMaxBacklogDuration() const {
   ld_check(logs_config_->isLocal());
   return localLogsConfig()->getMaxBacklogDuration();
@@ -134,6 +134,15 @@ class Configuration {
    */
   folly::Optional<std::string> getLogGroupPath(logid_t id) const;
 
+  /**
+   * Returns the per-log-group stats handle (see LogGroupStatsIndex) of the
+   * LogGroup the supplied logid belongs to, or LOG_GROUP_STATS_IDX_INVALID if
+   * the logid was not found. The handle is cached in the LogsConfig, so this
+   * is much cheaper than getLogGroupPath(). Same restrictions as
+   * getLogGroupPath() apply.
+   */
+  log_group_stats_idx_t getLogGroupStatsIdx(logid_t id) const;
+
   /**
    * Looks up a log by ID and returns a shared pointer to the LogGroupNode
    * object. Use this on the client when you don't care about blocking the
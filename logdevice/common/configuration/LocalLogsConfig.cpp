@@ -69,6 +69,19 @@ LocalLogsConfig::getLogGroupPath(logid_t id) const {
   return folly::none;
 }
 
+log_group_stats_idx_t LocalLogsConfig::getLogGroupStatsIdx(logid_t id) const {
+  if (MetaDataLog::isMetaDataLog(id)) {
+    return LOG_GROUP_STATS_IDX_INVALID;
+  }
+
+  const LogGroupInDirectory* res = getLogGroupInDirectoryByIDRaw(id);
+  if (res) {
+    return res->getStatsIdx();
+  }
+
+  return LOG_GROUP_STATS_IDX_INVALID;
+}
+
 const LocalLogsConfig::LogGroupInDirectory* FOLLY_NULLABLE
 LocalLogsConfig::getLogGroupInDirectoryByIDRaw(logid_t id) const {
   const logsconfig::LogGroupInDirectory* res =
@@ -100,6 +100,12 @@ class LocalLogsConfig : public LogsConfig {
 
   folly::Optional<std::string> getLogGroupPath(logid_t id) const;
 
+  /**
+   * Returns the per-log-group stats handle of the log group that @param id
+   * belongs to, or LOG_GROUP_STATS_IDX_INVALID if there's no such log group.
+   */
+  log_group_stats_idx_t getLogGroupStatsIdx(logid_t id) const;
+
   std::chrono::seconds getMaxBacklogDuration() const {
     return config_tree_->getMaxBacklogDuration();
   }
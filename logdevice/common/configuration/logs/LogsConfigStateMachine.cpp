@@ -104,6 +104,10 @@ bool LogsConfigStateMachine::shouldTrim() const {
       snapshot_log_id_ != LOGID_INVALID;
 }
 
+size_t LogsConfigStateMachine::getSnapshotChunkSize() const {
+  return settings_->rsm_snapshot_chunk_size;
+}
+
 bool LogsConfigStateMachine::canSnapshot() const {
   return allow_snapshotting_ && !snapshot_in_flight_ &&
       settings_->logsconfig_snapshotting && canTrimAndSnapshot() &&
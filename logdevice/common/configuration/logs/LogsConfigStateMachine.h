@@ -110,6 +110,8 @@ class LogsConfigStateMachine
 
   virtual bool canSnapshot() const override;
 
+  size_t getSnapshotChunkSize() const override;
+
   bool canTrimAndSnapshot() const;
 
   bool shouldTrim() const;
@@ -7,6 +7,7 @@
  */
 #include "logdevice/common/configuration/logs/LogsConfigTree.h"
 
+#include <algorithm>
 #include <deque>
 #include <iostream>
 
@@ -39,6 +40,178 @@ bool operator==(const LogGroupInDirectory& left,
   return left.log_group == right.log_group && left.parent == right.parent;
 }
 
+constexpr size_t LogIdIndex::MAX_CHUNK_SIZE;
+
+// Returns the last of the n sorted values at begin not greater than key, or
+// nullptr if there is none. The comparison compiles to a conditional move
+// rather than a branch, which would be mispredicted half of the time.
+static const logid_t::raw_type* searchLastAtOrBefore(
+    const logid_t::raw_type* begin,
+    size_t n,
+    logid_t::raw_type key) {
+  if (n == 0) {
+    return nullptr;
+  }
+  // The result, if any, is always in [base, base + n).
+  const logid_t::raw_type* base = begin;
+  while (n > 1) {
+    const size_t half = n / 2;
+    base = base[half] <= key ? base + half : base;
+    n -= half;
+  }
+  return *base <= key ? base : nullptr;
+}
+
+// Returns whether `ptr` holds the only reference to its object, which can then
+// be modified in place. The fence orders the modification after the reads of
+// the owners that released their references in the meantime.
+template <typename T>
+static bool isUnique(const std::shared_ptr<T>& ptr) {
+  if (ptr.use_count() != 1) {
+    return false;
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return true;
+}
+
+void LogIdIndex::assign(std::vector<Entry> entries) {
+  auto by_lo = [](const Entry& a, const Entry& b) { return a.lo < b.lo; };
+  if (!std::is_sorted(entries.begin(), entries.end(), by_lo)) {
+    std::sort(entries.begin(), entries.end(), by_lo);
+  }
+  clear();
+  // Leave room in every chunk so that the next inserts don't split them.
+  const size_t chunk_size = MAX_CHUNK_SIZE / 2;
+  chunks_.reserve((entries.size() + chunk_size - 1) / chunk_size);
+  for (size_t i = 0; i < entries.size(); ++i) {
+    Entry& entry = entries[i];
+    ld_check(entry.lo <= entry.hi);
+    ld_check(i == 0 || entries[i - 1].hi < entry.lo);
+    if (i % chunk_size == 0) {
+      chunks_.push_back(std::make_shared<Chunk>());
+      chunks_.back()->lows.reserve(MAX_CHUNK_SIZE);
+      chunks_.back()->entries.reserve(MAX_CHUNK_SIZE);
+      chunk_lows_.push_back(entry.lo);
+    }
+    num_logs_ += entry.hi - entry.lo + 1;
+    chunks_.back()->lows.push_back(entry.lo);
+    chunks_.back()->entries.push_back(std::move(entry));
+  }
+  num_ranges_ = entries.size();
+}
+
+void LogIdIndex::clear() {
+  chunk_lows_.clear();
+  chunks_.clear();
+  num_ranges_ = 0;
+  num_logs_ = 0;
+}
+
+void LogIdIndex::insert(Entry entry) {
+  ld_check(entry.lo <= entry.hi);
+  ld_check(findOverlap(entry.lo, entry.hi) == nullptr);
+  num_logs_ += entry.hi - entry.lo + 1;
+  ++num_ranges_;
+  if (chunks_.empty()) {
+    chunks_.push_back(std::make_shared<Chunk>());
+    chunk_lows_.push_back(entry.lo);
+  }
+  // A range starting before all others goes to the first chunk.
+  const size_t i = std::max(findChunk(entry.lo), ssize_t(0));
+  Chunk& chunk = mutableChunk(i);
+  const size_t pos =
+      std::upper_bound(chunk.lows.begin(), chunk.lows.end(), entry.lo) -
+      chunk.lows.begin();
+  chunk.lows.insert(chunk.lows.begin() + pos, entry.lo);
+  chunk.entries.insert(chunk.entries.begin() + pos, std::move(entry));
+  chunk_lows_[i] = chunk.lows.front();
+  if (chunk.lows.size() > MAX_CHUNK_SIZE) {
+    split(i);
+  }
+}
+
+LogIdIndex::Chunk& LogIdIndex::mutableChunk(size_t i) {
+  std::shared_ptr<Chunk>& chunk = chunks_[i];
+  if (!isUnique(chunk)) {
+    chunk = std::make_shared<Chunk>(*chunk);
+  }
+  return *chunk;
+}
+
+void LogIdIndex::split(size_t i) {
+  auto second = std::make_shared<Chunk>();
+  Chunk& first = mutableChunk(i);
+  const size_t half = first.lows.size() / 2;
+  second->lows.reserve(MAX_CHUNK_SIZE);
+  second->entries.reserve(MAX_CHUNK_SIZE);
+  second->lows.assign(first.lows.begin() + half, first.lows.end());
+  second->entries.assign(std::make_move_iterator(first.entries.begin() + half),
+                         std::make_move_iterator(first.entries.end()));
+  first.lows.resize(half);
+  first.entries.erase(first.entries.begin() + half, first.entries.end());
+  chunk_lows_.insert(chunk_lows_.begin() + i + 1, second->lows.front());
+  chunks_.insert(chunks_.begin() + i + 1, std::move(second));
+}
+
+bool LogIdIndex::erase(logid_t::raw_type lo) {
+  const ssize_t i = findChunk(lo);
+  if (i < 0) {
+    return false;
+  }
+  const Chunk& found = *chunks_[i];
+  auto found_it = std::lower_bound(found.lows.begin(), found.lows.end(), lo);
+  if (found_it == found.lows.end() || *found_it != lo) {
+    return false;
+  }
+  const size_t pos = found_it - found.lows.begin();
+  Chunk& chunk = mutableChunk(i);
+  const Entry& entry = chunk.entries[pos];
+  num_logs_ -= entry.hi - entry.lo + 1;
+  --num_ranges_;
+  chunk.lows.erase(chunk.lows.begin() + pos);
+  chunk.entries.erase(chunk.entries.begin() + pos);
+  if (chunk.lows.empty()) {
+    chunk_lows_.erase(chunk_lows_.begin() + i);
+    chunks_.erase(chunks_.begin() + i);
+  } else {
+    chunk_lows_[i] = chunk.lows.front();
+  }
+  return true;
+}
+
+ssize_t LogIdIndex::findChunk(logid_t::raw_type logid) const {
+  const logid_t::raw_type* found =
+      searchLastAtOrBefore(chunk_lows_.data(), chunk_lows_.size(), logid);
+  return found != nullptr ? found - chunk_lows_.data() : -1;
+}
+
+const LogIdIndex::Entry*
+LogIdIndex::findLastStartingAtOrBefore(logid_t::raw_type logid) const {
+  const ssize_t i = findChunk(logid);
+  if (i < 0) {
+    return nullptr;
+  }
+  const Chunk& chunk = *chunks_[i];
+  // Found, since the chunk's first range starts at or before logid.
+  const logid_t::raw_type* found =
+      searchLastAtOrBefore(chunk.lows.data(), chunk.lows.size(), logid);
+  ld_check(found != nullptr);
+  return &chunk.entries[found - chunk.lows.data()];
+}
+
+const LogIdIndex::Entry* LogIdIndex::find(logid_t::raw_type logid) const {
+  const Entry* entry = findLastStartingAtOrBefore(logid);
+  return entry != nullptr && logid <= entry->hi ? entry : nullptr;
+}
+
+const LogIdIndex::Entry* LogIdIndex::findOverlap(logid_t::raw_type lo,
+                                                 logid_t::raw_type hi) const {
+  // Ranges don't overlap, so if any range overlaps [lo, hi], the last one
+  // starting before hi does.
+  const Entry* entry = findLastStartingAtOrBefore(hi);
+  return entry != nullptr && lo <= entry->hi ? entry : nullptr;
+}
+
 static std::string intervalToString(const logid_range_t& range) {
   return std::to_string(range.first.val()) + ".." +
       std::to_string(range.second.val());
@@ -342,23 +515,35 @@ bool LogGroupNode::isRangeValid(const LogGroupNode* lg) {
 }
 
 std::string DirectoryNode::getFullyQualifiedName() const {
-  if (!parent_) {
-    return delimiter_;
+  return path_;
+}
+
+std::string DirectoryNode::makePath(const DirectoryNode* parent,
+                                    const std::string& name,
+                                    const std::string& delimiter) {
+  if (parent == nullptr) {
+    return delimiter;
   }
-  return parent_->getFullyQualifiedName() + name_ + delimiter_;
+  return parent->getFullyQualifiedName() + name + delimiter;
 }
 
 DirectoryNode::DirectoryNode(const DirectoryNode& other)
-    : DirectoryNode(other, other.parent_) {}
-
-DirectoryNode::DirectoryNode(const DirectoryNode& other, DirectoryNode* parent)
-    : LogsConfigTreeNode(other.name_, other.attrs()),
-      parent_(parent),
+    : LogsConfigTreeNode(other),
+      path_(other.path_),
+      children_(other.children_),
+      logs_(other.logs_),
+      delimiter_(other.delimiter_) {}
+
+DirectoryNode::DirectoryNode(const DirectoryNode& other,
+                             const DirectoryNode* parent,
+                             const std::string& name)
+    : LogsConfigTreeNode(name, other.attrs()),
+      path_(makePath(parent, name, other.delimiter_)),
+      logs_(other.logs_),
       delimiter_(other.delimiter_) {
-  // a simple copy of the log groups map
-  logs_ = other.logs_;
   for (const auto& item : other.children_) {
-    children_[item.first] = std::make_unique<DirectoryNode>(*item.second, this);
+    children_[item.first] =
+        std::make_shared<DirectoryNode>(*item.second, this, item.first);
   }
 }
 
@@ -375,15 +560,14 @@ ReplicationProperty DirectoryNode::getNarrowestReplication() const {
 
 DirectoryNode* DirectoryNode::addChild(const std::string& name,
                                        const LogAttributes& child_attrs) {
-  auto child = std::make_unique<DirectoryNode>(
+  auto child = std::make_shared<DirectoryNode>(
       name, this, LogAttributes(child_attrs, attrs()), delimiter_);
   DirectoryNode* node = child.get();
   setChild(name, std::move(child));
   return node;
 }
 
-void DirectoryNode::setChild(const std::string& name,
-                             std::unique_ptr<DirectoryNode> child) {
+void DirectoryNode::setChild(const std::string& name, DirectoryNodePtr child) {
   children_[name] = std::move(child);
 }
 
@@ -399,7 +583,7 @@ void DirectoryNode::deduplicateRecursively(CommonValuesRegistry& registry,
     if (auto new_attrs = registry.deduplicate(log->attrs())) {
       log = std::make_shared<const LogGroupNode>(
           log->name(), *new_attrs, log->range());
-      callback(parent_, log);
+      callback(this, log);
     }
   }
 }
@@ -441,14 +625,15 @@ LogGroupNodePtr DirectoryNode::addLogGroup(const LogGroupNode& log_group,
                      failure_reason);
 }
 
-bool DirectoryNode::refreshAttributesInheritance(std::string& failure_reason) {
+bool DirectoryNode::refreshAttributesInheritance(const DirectoryNode* parent,
+                                                 std::string& failure_reason) {
   // create new attributes that apply the parent to the supplied attributes
-  if (parent_ != nullptr) {
-    replaceAttrs(LogAttributes(attrs(), parent_->attrs()));
+  if (parent != nullptr) {
+    replaceAttrs(LogAttributes(attrs(), parent->attrs()));
   }
   // for all dirs, set new attribute
   for (auto& it : children_) {
-    if (!it.second->refreshAttributesInheritance(failure_reason)) {
+    if (!it.second->refreshAttributesInheritance(this, failure_reason)) {
       // refreshing attributes for this directory failed.
       return false;
     }
@@ -618,10 +803,12 @@ DirectoryNode* FOLLY_NULLABLE
 LogsConfigTree::addDirectory(DirectoryNode* parent,
                              const std::string& name,
                              const LogAttributes& attrs) {
-  if (parent && !parent->exists(name)) {
-    return parent->addChild(name, attrs);
+  if (parent == nullptr || parent->exists(name)) {
+    return nullptr;
   }
-  return nullptr;
+  // parent may be shared with other trees
+  DirectoryNode* dir = mutableDirectory(parent->getFullyQualifiedName());
+  return dir != nullptr ? dir->addChild(name, attrs) : nullptr;
 }
 
 DirectoryNode* FOLLY_NULLABLE
@@ -672,7 +859,9 @@ LogsConfigTree::addDirectory(const std::string& raw_path,
     err = E::EXISTS;
     return nullptr;
   } else {
-    DirectoryNode* current_parent = found;
+    DirectoryNode* current_parent =
+        mutableDirectory(found->getFullyQualifiedName());
+    ld_check(current_parent != nullptr);
     while (remaining_tokens.size() > 0) {
       LogAttributes dir_attrs =
           remaining_tokens.size() == 1 ? attrs : LogAttributes();
@@ -862,6 +1051,16 @@ LogGroupNodePtr LogsConfigTree::addLogGroup(DirectoryNode* parent,
     err = E::ID_CLASH;
     return nullptr;
   }
+  // parent may be shared with other trees
+  parent = mutableDirectory(parent->getFullyQualifiedName());
+  if (parent == nullptr) {
+    failure_reason = folly::format("The parent directory of LogGroup \"{}\" "
+                                   "is not in the tree!",
+                                   log_group.name())
+                         .str();
+    err = E::NOTFOUND;
+    return nullptr;
+  }
   auto lg = parent->addLogGroup(log_group,
                                 /* overwrite= */ false,
                                 failure_reason);
@@ -925,6 +1124,8 @@ bool LogsConfigTree::replaceLogGroup(const std::string& raw_path,
     return false;
   }
   auto old_node = old_node_iter->second;
+  parent = mutableDirectory(parent->getFullyQualifiedName());
+  ld_check(parent != nullptr);
 
   if (!deleteLogGroupFromLookupIndex(old_node->range())) {
     return false;
@@ -955,6 +1156,10 @@ bool LogsConfigTree::replaceLogGroup(const std::string& raw_path,
 int LogsConfigTree::deleteLogGroup(DirectoryNode* parent,
                                    LogGroupNodePtr node,
                                    std::string& failure_reason) {
+  if (node != nullptr && parent != nullptr) {
+    // parent may be shared with other trees
+    parent = mutableDirectory(parent->getFullyQualifiedName());
+  }
   if (node == nullptr || parent == nullptr) {
     failure_reason = "Path was not found!";
     err = E::NOTFOUND;
@@ -995,7 +1200,7 @@ int LogsConfigTree::deleteDirectory(DirectoryNode* FOLLY_NULLABLE dir,
     err = E::NOTFOUND;
     return -1;
   }
-  if (dir == root_.get() || dir->parent() == nullptr) {
+  if (dir == root_.get() || dir->getFullyQualifiedName() == delimiter_) {
     // cannot delete the root directory
     failure_reason = "Cannot delete the root directory!";
     err = E::INVALID_PARAM;
@@ -1011,8 +1216,11 @@ int LogsConfigTree::deleteDirectory(DirectoryNode* FOLLY_NULLABLE dir,
 
   deleteDirectoryFromLookupIndex(dir);
 
-  DirectoryNode* parent = dir->parent();
-  parent->deleteChild(dir->name());
+  const std::string name = dir->name();
+  DirectoryNode* parent = mutableDirectory(
+      splitParentPath(normalize_path(dir->getFullyQualifiedName())).first);
+  ld_check(parent != nullptr);
+  parent->deleteChild(name);
   return 0;
 }
 
@@ -1121,10 +1329,16 @@ int LogsConfigTree::rename(const std::string& raw_from_path,
   }
   ld_check(dest_dir != nullptr);
   if (source->type() == NodeType::DIRECTORY) {
-    // rename a directory
+    // rename a directory by replacing it with a copy that has the new name,
+    // as have the FQNs of all the directories in it
     auto* dir = static_cast<const DirectoryNode*>(source);
-    const_cast<DirectoryNode*>(dir)->setName(new_name);
-    dest_dir->replaceChild(old_name, new_name);
+    dest_dir = mutableDirectory(dest_dir->getFullyQualifiedName());
+    ld_check(dest_dir != nullptr);
+    auto renamed = std::make_shared<DirectoryNode>(*dir, dest_dir, new_name);
+    deleteDirectoryFromLookupIndex(dir);
+    dest_dir->deleteChild(old_name);
+    dest_dir->setChild(new_name, renamed);
+    rebuildIndexForDir(renamed.get(), false /* delete_old */);
   } else {
     // rename a log group node by creating a new one
     LogGroupNode new_group =
@@ -1160,24 +1374,34 @@ int LogsConfigTree::setAttributes(const std::string& path,
   }
   if (node->type() == NodeType::DIRECTORY) {
     const DirectoryNode* dir = static_cast<const DirectoryNode*>(node);
-    // copy the directory
-    std::unique_ptr<DirectoryNode> new_dir =
-        std::make_unique<DirectoryNode>(*dir);
+    const std::string name = dir->name();
+    const DirectoryNode* parent = nullptr;
+    std::string parent_path;
+    if (dir != root_.get()) {
+      parent_path = splitParentPath(normalize_path(path)).first;
+      parent = findDirectory(parent_path);
+      ld_check(parent != nullptr);
+    }
+    // copy the directory and the directories in it, which all get new
+    // attributes
+    DirectoryNodePtr new_dir =
+        std::make_shared<DirectoryNode>(*dir, parent, name);
     LogAttributes new_attrs = attrs;
-    if (dir == root_.get()) {
+    if (parent == nullptr) {
       // If the directory is root, we need to re-apply the defaults to the
       // supplied attributes.
       new_attrs = LogAttributes(new_attrs, DefaultLogAttributes());
     }
-    if (new_dir->setAttributes(new_attrs, failure_reason)) {
-      DirectoryNode* new_dir_ptr = new_dir.get();
-      if (dir->parent() == nullptr) {
+    if (new_dir->setAttributes(new_attrs, failure_reason, parent)) {
+      if (parent == nullptr) {
         // this is the root dir.
         root_ = std::move(new_dir);
+        rebuildIndex();
       } else {
-        dir->parent_->setChild(dir->name(), std::move(new_dir));
+        const DirectoryNode* new_dir_ptr = new_dir.get();
+        mutableDirectory(parent_path)->setChild(name, std::move(new_dir));
+        rebuildIndexForDir(new_dir_ptr, true);
       }
-      rebuildIndexForDir(new_dir_ptr, true);
       return 0;
     } else {
       // new_dir->setAttributes will set failure_reason
@@ -1199,27 +1423,130 @@ int LogsConfigTree::setAttributes(const std::string& path,
 // in the tree
 bool LogsConfigTree::doesLogRangeClash(const logid_range_t& range,
                                        std::string& failure_reason) const {
-  // use a right open interval because that's what
-  // icl::intersect<interval_map,...> expects for default interval_map
-  // instantiations
-  boost::icl::right_open_interval<logid_t::raw_type> logid_interval(
-      range.first.val(), range.second.val() + 1);
-  LogMap::const_iterator found = logs_index_.find(logid_interval);
-  if (found != logs_index_.end()) {
-    boost::icl::right_open_interval<logid_t::raw_type> overlap = found->first;
-    failure_reason =
-        folly::format(
-            "Log id or range \"[{}, {}]\" overlaps with another range: "
-            "[{},{}] from Log Group \"{}\"",
-            range.first.val(),
-            range.second.val(),
-            overlap.lower(),
-            overlap.upper() - 1,
-            found->second.getFullyQualifiedName())
-            .str();
-    return true;
+  const LogIdIndex::Entry* found =
+      log_id_index_.findOverlap(range.first.val(), range.second.val());
+  if (found == nullptr) {
+    return false;
+  }
+  failure_reason =
+      folly::format("Log id or range \"[{}, {}]\" overlaps with another range: "
+                    "[{},{}] from Log Group \"{}\"",
+                    range.first.val(),
+                    range.second.val(),
+                    found->lo,
+                    found->hi,
+                    found->value.getFullyQualifiedName())
+          .str();
+  return true;
+}
+
+const LogMap& LogsConfigTree::getLogMap() const {
+  if (UNLIKELY(!logs_index_valid_.load(std::memory_order_acquire))) {
+    buildLogMap();
+  }
+  return logs_index_;
+}
+
+size_t LogsConfigTree::size() const {
+  return log_id_index_.numLogs();
+}
+
+void LogsConfigTree::buildLogMap() const {
+  std::lock_guard<std::mutex> lock(index_mutex_);
+  if (logs_index_valid_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  logs_index_.clear();
+  log_id_index_.forEach([&](const LogIdIndex::Entry& entry) {
+    logs_index_.insert(
+        logs_index_.end(),
+        std::make_pair(boost::icl::right_open_interval<logid_t::raw_type>(
+                           entry.lo, entry.hi + 1),
+                       entry.value));
+  });
+  logs_index_valid_.store(true, std::memory_order_release);
+}
+
+DirectoryNode* LogsConfigTree::mutableDirectory(const std::string& path) {
+  ld_check(root_ != nullptr);
+  std::string clean_path = normalize_path(path);
+  std::deque<folly::StringPiece> tokens = tokensOfPath(clean_path);
+  if (tokens.size() == 1 && tokens.front().size() == 0) {
+    // the root directory
+    tokens.clear();
+  }
+  auto unshare = [this](DirectoryNodePtr& dir) {
+    if (isUnique(dir)) {
+      return;
+    }
+    // The copy shares the children of the original, only the index entries
+    // of its own log groups need to point to it.
+    dir = std::make_shared<DirectoryNode>(*dir);
+    for (const auto& item : dir->logs()) {
+      updateLookupIndex(dir.get(), item.second, true /* delete_old */);
+    }
+  };
+  unshare(root_);
+  DirectoryNode* dir = root_.get();
+  for (const folly::StringPiece& token : tokens) {
+    auto search = dir->children_.find(token.str());
+    if (search == dir->children_.end()) {
+      return nullptr;
+    }
+    unshare(search->second);
+    dir = search->second.get();
+  }
+  return dir;
+}
+
+DirectoryNodePtr
+LogsConfigTree::deduplicateDirectory(const DirectoryNode& dir) {
+  DirectoryNodePtr copy;
+  auto get_copy = [&]() {
+    if (!copy) {
+      copy = std::make_shared<DirectoryNode>(dir);
+    }
+    return copy.get();
+  };
+  if (auto new_attrs = registry_.deduplicate(dir.attrs())) {
+    get_copy()->replaceAttrs(*new_attrs);
+  }
+  for (const auto& item : dir.children()) {
+    if (DirectoryNodePtr new_child = deduplicateDirectory(*item.second)) {
+      get_copy()->children_[item.first] = std::move(new_child);
+    }
+  }
+  for (const auto& item : dir.logs()) {
+    const LogGroupNodePtr& log = item.second;
+    if (auto new_attrs = registry_.deduplicate(log->attrs())) {
+      get_copy()->logs_[item.first] = std::make_shared<const LogGroupNode>(
+          log->name(), *new_attrs, log->range());
+    }
+  }
+  if (copy) {
+    for (const auto& item : copy->logs()) {
+      updateLookupIndex(copy.get(), item.second, true /* delete_old */);
+    }
+  }
+  return copy;
+}
+
+void LogsConfigTree::addBacklogDuration(const LogGroupNode& log_group) {
+  auto backlogDuration = log_group.attrs().backlogDuration();
+  if (backlogDuration.hasValue() && backlogDuration.value().has_value()) {
+    ++backlog_durations_[backlogDuration.value().value()];
+  }
+}
+
+void LogsConfigTree::removeBacklogDuration(const LogGroupNode& log_group) {
+  auto backlogDuration = log_group.attrs().backlogDuration();
+  if (backlogDuration.hasValue() && backlogDuration.value().has_value()) {
+    auto it = backlog_durations_.find(backlogDuration.value().value());
+    ld_check(it != backlog_durations_.end());
+    if (it != backlog_durations_.end() && --it->second == 0) {
+      backlog_durations_.erase(it);
+    }
   }
-  return false;
 }
 
 void LogsConfigTree::updateLookupIndex(const DirectoryNode* parent,
@@ -1229,12 +1556,6 @@ void LogsConfigTree::updateLookupIndex(const DirectoryNode* parent,
   if (log_group == nullptr) {
     return;
   }
-  auto backlogDuration = log_group->attrs().backlogDuration();
-  // update the max_backlog_duration
-  if (backlogDuration.hasValue() && backlogDuration.value().has_value()) {
-    max_backlog_duration_ =
-        std::max(max_backlog_duration_, backlogDuration.value().value());
-  }
   const auto& range = log_group->range();
   auto interval = boost::icl::right_open_interval<logid_t::raw_type>(
       range.first.val(), range.second.val() + 1);
@@ -1250,15 +1571,22 @@ void LogsConfigTree::updateLookupIndex(const DirectoryNode* parent,
       }
     }
   }
-  logs_index_.insert(
-      logs_index_.end(),
-      std::make_pair(interval, LogGroupInDirectory{log_group, parent}));
+  addBacklogDuration(*log_group);
+  log_id_index_.insert(
+      LogIdIndex::Entry{range.first.val(),
+                        range.second.val(),
+                        LogGroupInDirectory{log_group, parent}});
+  if (logs_index_valid_.load(std::memory_order_relaxed)) {
+    logs_index_.insert(
+        logs_index_.end(),
+        std::make_pair(interval, LogGroupInDirectory{log_group, parent}));
+  }
 }
 
 bool LogsConfigTree::deleteLogGroupFromLookupIndex(const logid_range_t& range) {
   // delete that log range from the index
-  auto iter = logs_index_.find(range.first.val());
-  if (iter == logs_index_.end()) {
+  const LogIdIndex::Entry* entry = log_id_index_.find(range.first.val());
+  if (entry == nullptr || entry->lo != range.first.val()) {
     // this is wrong, we should always be able to find this here, failing.
     err = E::INVALID_CONFIG;
     ld_error("The log group range '%zu..%zu' doesn't seem to have the "
@@ -1268,8 +1596,13 @@ bool LogsConfigTree::deleteLogGroupFromLookupIndex(const logid_range_t& range) {
              range.second.val());
     return false;
   }
-  // clears that interval from the index
-  logs_index_.erase(iter->first);
+  removeBacklogDuration(*entry->value.log_group);
+  log_id_index_.erase(range.first.val());
+  if (logs_index_valid_.load(std::memory_order_relaxed)) {
+    // clears that interval from the index
+    logs_index_.erase(boost::icl::right_open_interval<logid_t::raw_type>(
+        range.first.val(), range.second.val() + 1));
+  }
   return true;
 }
 
@@ -1295,9 +1628,28 @@ void LogsConfigTree::rebuildIndexForDir(const DirectoryNode* dir,
   }
 }
 
+void LogsConfigTree::collectLogIdIndexEntries(
+    const DirectoryNode* dir,
+    std::vector<LogIdIndex::Entry>& entries) {
+  for (const auto& log_item : dir->logs()) {
+    const LogGroupNodePtr& log_group = log_item.second;
+    addBacklogDuration(*log_group);
+    entries.push_back(LogIdIndex::Entry{log_group->range().first.val(),
+                                        log_group->range().second.val(),
+                                        LogGroupInDirectory{log_group, dir}});
+  }
+  for (const auto& dir_item : dir->children()) {
+    collectLogIdIndexEntries(dir_item.second.get(), entries);
+  }
+}
+
 void LogsConfigTree::rebuildIndex() {
+  std::vector<LogIdIndex::Entry> entries;
+  backlog_durations_.clear();
+  collectLogIdIndexEntries(root_.get(), entries);
+  log_id_index_.assign(std::move(entries));
   logs_index_.clear();
-  rebuildIndexForDir(root_.get(), false);
+  logs_index_valid_.store(false, std::memory_order_release);
 }
 
 ReplicationProperty LogsConfigTree::getNarrowestReplication() const {
@@ -7,13 +7,18 @@
  */
 #pragma once
 
+#include <atomic>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include <boost/icl/interval_map.hpp>
 #include <boost/icl/map.hpp>
+#include <folly/Likely.h>
 #include <folly/Memory.h>
 #include <folly/Optional.h>
 #include <folly/String.h>
@@ -23,6 +28,7 @@
 #include "logdevice/common/configuration/ReplicationProperty.h"
 #include "logdevice/common/configuration/logs/CodecType.h"
 #include "logdevice/common/configuration/logs/DefaultLogAttributes.h"
+#include "logdevice/common/stats/LogGroupStatsIndex.h"
 #include "logdevice/include/Err.h"
 #include "logdevice/include/LogAttributes.h"
 #include "logdevice/include/types.h"
@@ -49,6 +55,9 @@ class RenameDelta;
 // added/deleted. It doesn't own the memory of the LogGroup (the ownership of
 // the LogGroupNode is managed by shared_ptr in all of its parents (assuming
 // that a given LogGroupNode will be immutably shared across multiple trees))
+//
+// Lookups by log id don't use this map but LogIdIndex below, which is much
+// cheaper to query and to build.
 using LogMap = boost::icl::interval_map<
     logid_t::raw_type,
     // The value of this map is the LogGroup and it's parent directory pointer
@@ -185,14 +194,19 @@ class LogsConfigTreeNode {
   LogAttributes attrs_;
 };
 
-// This is the map that holds the children of a directory. A parent directory is
-// the owner of the memory for his children directory.
-using DirectoryMap =
-    folly::F14FastMap<std::string, std::unique_ptr<DirectoryNode>>;
+// This is the map that holds the children of a directory. Directories are
+// shared by the copies of a LogsConfigTree until one of them modifies them,
+// see LogsConfigTree::copy().
+using DirectoryNodePtr = std::shared_ptr<DirectoryNode>;
+using DirectoryMap = folly::F14FastMap<std::string, DirectoryNodePtr>;
 
 using LogGroupMap = folly::F14FastMap<std::string, LogGroupNodePtr>;
 /*
  * A node in the tree of logs config representing a directory (aka. Namespace)
+ *
+ * A directory doesn't point to its parent but knows its fully qualified name,
+ * so that it can be shared by several trees. Once in a tree, it should only be
+ * modified through the LogsConfigTree.
  */
 class DirectoryNode : public LogsConfigTreeNode {
  public:
@@ -204,36 +218,42 @@ class DirectoryNode : public LogsConfigTreeNode {
       std::function<void(const DirectoryNode*, const LogGroupNodePtr&)>;
 
   explicit DirectoryNode(const std::string& delimiter)
-      : delimiter_(delimiter) {}
-
-  // The copy constructor, this ensures that the directory tree is deeply copied
-  // by pointers for an effective snapshotting of the tree.
-  DirectoryNode(const DirectoryNode& other, DirectoryNode* parent);
+      : path_(delimiter), delimiter_(delimiter) {}
 
-  // copy constructor (should generally be avoided)
+  // Copies the directory, sharing its children directories and log groups
+  // with the original.
   DirectoryNode(const DirectoryNode& other);
 
+  // Deeply copies the directory and its children directories as a child of
+  // `parent` named `name`, which sets their fully qualified names
+  // accordingly. Log groups are shared with the original.
+  DirectoryNode(const DirectoryNode& other,
+                const DirectoryNode* parent,
+                const std::string& name);
+
   DirectoryNode(const std::string& delimiter,
                 const LogAttributes& attrs,
-                DirectoryNode* parent = nullptr)
-      : LogsConfigTreeNode(attrs), parent_(parent), delimiter_(delimiter) {}
+                const DirectoryNode* parent = nullptr)
+      : LogsConfigTreeNode(attrs),
+        path_(makePath(parent, name_, delimiter)),
+        delimiter_(delimiter) {}
 
   DirectoryNode(const std::string& name,
-                DirectoryNode* parent,
+                const DirectoryNode* parent,
                 const LogAttributes& attrs,
                 const std::string& delimiter)
       : LogsConfigTreeNode(name, attrs),
-        parent_(parent),
+        path_(makePath(parent, name, delimiter)),
         delimiter_(delimiter) {}
 
   DirectoryNode(const std::string& name,
-                DirectoryNode* parent,
+                const DirectoryNode* parent,
                 const LogAttributes& attrs,
                 DirectoryMap dirs,
                 const LogGroupMap& logs,
                 const std::string& delimiter)
       : LogsConfigTreeNode(name, attrs),
-        parent_(parent),
+        path_(makePath(parent, name, delimiter)),
         children_(std::move(dirs)),
         logs_(logs),
         delimiter_(delimiter) {}
@@ -246,11 +266,7 @@ class DirectoryNode : public LogsConfigTreeNode {
     return children_;
   }
 
-  virtual DirectoryNode* parent() const {
-    return parent_;
-  }
-
-  // returns a FQN of the node (e.g, /dir1/group1)
+  // returns a FQN of the node (e.g, /dir1/dir2/)
   virtual std::string getFullyQualifiedName() const;
 
   // Checks whether that name (whether it's a LogGroup or a Directory) exists
@@ -261,11 +277,14 @@ class DirectoryNode : public LogsConfigTreeNode {
 
   /**
    * Sets the attributes of this node and updates all the children
-   * accordingly by re-applying the inheritance tree
+   * accordingly by re-applying the inheritance tree. `parent` is the
+   * directory this one inherits attributes from, if any.
    */
-  bool setAttributes(const LogAttributes& attrs, std::string& failure_reason) {
+  bool setAttributes(const LogAttributes& attrs,
+                     std::string& failure_reason,
+                     const DirectoryNode* parent = nullptr) {
     replaceAttrs(attrs);
-    return refreshAttributesInheritance(failure_reason);
+    return refreshAttributesInheritance(parent, failure_reason);
   }
 
   virtual const LogGroupMap& logs() const {
@@ -281,19 +300,19 @@ class DirectoryNode : public LogsConfigTreeNode {
                           const LogAttributes& child_attrs = LogAttributes());
 
   // updates the attributes of the children directories and logs with the
-  // current log attributes as a parent.
+  // current log attributes as a parent, after applying those of `parent` to
+  // this directory if it's not nullptr.
   // If refreshing attributes failed, we set err=E::INVALID_ATTRIBUTES and will
   // fill the failure_reason string with the reason message (unless
   // failure_reason is set to nullptr)
-  bool refreshAttributesInheritance(std::string& failure_reason);
+  bool refreshAttributesInheritance(const DirectoryNode* parent,
+                                    std::string& failure_reason);
 
   /**
    * Overwrites the child (whether exists or not) with a new DirectoryNode
-   * object.
-   * Note that this does not set the parent for the supplied `DirectoryNode`.
-   * The parent must be set before passing it through.
+   * object, which must have been created with this directory as its parent.
    */
-  void setChild(const std::string& name, std::unique_ptr<DirectoryNode> child);
+  void setChild(const std::string& name, DirectoryNodePtr child);
   /*
    * This doesn't update the tree interval map (LogID -> LogGroupNode)
    * This has to be done explicitly after calling this method
@@ -330,24 +349,6 @@ class DirectoryNode : public LogsConfigTreeNode {
     logs_ = logs;
   }
 
-  void setName(const std::string& name) {
-    name_ = name;
-  }
-  // changes the name for one of the child directories, this only changes
-  // the map key but doesn't change anything in the Directory object for
-  // that child
-  bool replaceChild(const std::string& name, const std::string& new_name) {
-    DirectoryMap::iterator search = children_.find(name);
-    if (search != children_.end()) {
-      auto value = std::move(search->second);
-      // found, replace
-      children_.erase(search);
-      children_[new_name] = std::move(value);
-      return true;
-    }
-    return false;
-  }
-
   // sets the children map directly.
   void setChildren(DirectoryMap&& dirs) {
     children_ = std::move(dirs);
@@ -360,7 +361,13 @@ class DirectoryNode : public LogsConfigTreeNode {
   void deduplicateRecursively(CommonValuesRegistry&, const GroupChangeCb&);
 
  private:
-  DirectoryNode* parent_;
+  // FQN of a directory named `name` under `parent`, or of the root if
+  // `parent` is nullptr.
+  static std::string makePath(const DirectoryNode* parent,
+                              const std::string& name,
+                              const std::string& delimiter);
+
+  std::string path_;
   DirectoryMap children_;
   LogGroupMap logs_;
   std::string delimiter_;
@@ -454,11 +461,15 @@ struct LogGroupInDirectory {
       : log_group(group), parent(dir) {}
 
   LogGroupInDirectory(const LogGroupInDirectory& lgind)
-      : log_group(lgind.log_group), parent(lgind.parent) {}
+      : log_group(lgind.log_group),
+        parent(lgind.parent),
+        stats_idx_(lgind.stats_idx_.load(std::memory_order_relaxed)) {}
 
   LogGroupInDirectory& operator=(const LogGroupInDirectory& in) {
     log_group = in.log_group;
     parent = in.parent;
+    stats_idx_.store(in.stats_idx_.load(std::memory_order_relaxed),
+                     std::memory_order_relaxed);
     return *this;
   }
 
@@ -475,14 +486,140 @@ struct LogGroupInDirectory {
     }
   }
 
+  /**
+   * Returns the handle of this log group in per-log-group stats (see
+   * LogGroupStatsIndex). Resolved from the fully qualified name on first
+   * call and cached, so that the per-append stats path doesn't need to build
+   * and hash the name.
+   */
+  log_group_stats_idx_t getStatsIdx() const {
+    log_group_stats_idx_t idx = stats_idx_.load(std::memory_order_relaxed);
+    if (UNLIKELY(idx == LOG_GROUP_STATS_IDX_INVALID)) {
+      idx = LogGroupStatsIndex::instance().getOrAssign(getFullyQualifiedName());
+      stats_idx_.store(idx, std::memory_order_relaxed);
+    }
+    return idx;
+  }
+
   std::string toJson(bool metadata_logs = false) const;
   folly::dynamic toFollyDynamic(bool metadata_logs = false) const;
+
+ private:
+  // Cached result of getStatsIdx(). Only depends on the fully qualified name,
+  // which can't change for a given (log_group, parent) pair since both are
+  // immutable.
+  mutable std::atomic<log_group_stats_idx_t> stats_idx_{
+      LOG_GROUP_STATS_IDX_INVALID};
 };
 
 // needed for LogGroupInDirectory to be used as a value in interval_map
 bool operator==(const LogGroupInDirectory& left,
                 const LogGroupInDirectory& right);
 
+/**
+ * Index of log id ranges used by LogsConfigTree to find the log group of a
+ * log id, which happens on every append. The ranges are kept sorted in flat
+ * arrays of at most MAX_CHUNK_SIZE ranges each, with their lower bounds in
+ * arrays of their own so that the binary searches only touch those, and are
+ * branchless. A lookup searches the first lower bounds of the chunks, then
+ * the lower bounds of one chunk.
+ *
+ * Adding or removing a range only shifts the ranges of one chunk, plus the
+ * chunks themselves when one is split or removed.
+ *
+ * Copies of the index share their chunks until they modify them, so copying
+ * the index only copies a pointer per chunk.
+ */
+class LogIdIndex {
+ public:
+  struct Entry {
+    // First and last log id of the range.
+    logid_t::raw_type lo;
+    logid_t::raw_type hi;
+    LogGroupInDirectory value;
+  };
+
+  static constexpr size_t MAX_CHUNK_SIZE = 256;
+
+  /**
+   * Replaces the contents of the index. The ranges must not overlap.
+   */
+  void assign(std::vector<Entry> entries);
+
+  void clear();
+
+  /**
+   * Adds a range, which must not overlap with any range of the index.
+   */
+  void insert(Entry entry);
+
+  /**
+   * Removes the range starting at @param lo.
+   *
+   * @return  false if there is no such range
+   */
+  bool erase(logid_t::raw_type lo);
+
+  /**
+   * @return the range containing the given log id, or nullptr.
+   */
+  const Entry* find(logid_t::raw_type logid) const;
+
+  /**
+   * @return a range overlapping [lo, hi], or nullptr if there is none.
+   */
+  const Entry* findOverlap(logid_t::raw_type lo, logid_t::raw_type hi) const;
+
+  // Calls f(const Entry&) for all ranges, sorted by log id.
+  template <typename F>
+  void forEach(F f) const {
+    for (const auto& chunk : chunks_) {
+      for (const Entry& entry : chunk->entries) {
+        f(entry);
+      }
+    }
+  }
+
+  // Number of ranges.
+  size_t numRanges() const {
+    return num_ranges_;
+  }
+
+  // Number of log ids in all ranges.
+  size_t numLogs() const {
+    return num_logs_;
+  }
+
+ private:
+  struct Chunk {
+    std::vector<logid_t::raw_type> lows;
+    std::vector<Entry> entries;
+  };
+
+  // Returns the index of the chunk containing the range with the largest
+  // lower bound not greater than logid, or -1 if all ranges start after
+  // logid.
+  ssize_t findChunk(logid_t::raw_type logid) const;
+
+  // Returns the range with the largest lower bound not greater than logid,
+  // or nullptr if all ranges start after logid.
+  const Entry* findLastStartingAtOrBefore(logid_t::raw_type logid) const;
+
+  // Returns chunk i for modification, after replacing it with a copy if it's
+  // shared with another index.
+  Chunk& mutableChunk(size_t i);
+
+  // Splits chunk i in two.
+  void split(size_t i);
+
+  // First lower bound of each chunk.
+  std::vector<logid_t::raw_type> chunk_lows_;
+  // Never empty.
+  std::vector<std::shared_ptr<Chunk>> chunks_;
+  size_t num_ranges_{0};
+  size_t num_logs_{0};
+};
+
 /**
  * LogsConfigTree is an immutable class representing a tree of directories and
  * LogGroups. Immutability here means that you should _never_ update a tree
@@ -490,6 +627,19 @@ bool operator==(const LogGroupInDirectory& left,
  *
  * LogsConfigTree is not thread-safe. All mutations happen in
  * LogsConfigStateMachine which runs in a Worker.
+ *
+ * Log ids are looked up in a LogIdIndex, which mutations update range by
+ * range. The LogMap is only needed for iteration: it is built on first use,
+ * under index_mutex_ so that a tree that is not being mutated can be read from
+ * any number of threads, and then kept up to date by mutations.
+ *
+ * Copies of a tree share their directories, log groups and index chunks, so
+ * that the copy LogsConfigManager publishes after every delta costs the same
+ * whatever the size of the tree. A mutation first replaces the shared
+ * directories on the path to the one it modifies with copies (see
+ * mutableDirectory()), which share their children with the originals. So
+ * after a mutation, DirectoryNode pointers the tree handed out before may
+ * belong to other trees; methods taking them look them up by path.
  */
 class LogsConfigTree {
  public:
@@ -680,33 +830,34 @@ class LogsConfigTree {
 
   // The following methods provide direct access to the log map.
   LogsConfigTree::const_iterator logsBegin() const {
-    return boost::icl::elements_begin(logs_index_);
+    return boost::icl::elements_begin(getLogMap());
   }
 
   LogsConfigTree::const_iterator logsEnd() const {
-    return boost::icl::elements_end(logs_index_);
+    return boost::icl::elements_end(getLogMap());
   }
 
   LogsConfigTree::const_reverse_iterator logsRBegin() const {
-    return boost::icl::elements_rbegin(logs_index_);
+    return boost::icl::elements_rbegin(getLogMap());
   }
 
   LogsConfigTree::const_reverse_iterator logsREnd() const {
-    return boost::icl::elements_rend(logs_index_);
+    return boost::icl::elements_rend(getLogMap());
   }
 
   // returns the LogGroupNode that has this logid in its range.
   // The returned structure `LogGroupInDirectory` contains pointer to the log
   // group and its parent directory
   // this returns nullptr if the logid was not found.
+  // The returned pointer is invalidated by any mutation of the tree.
   //
   const LogGroupInDirectory* getLogGroupByID(const logid_t& logid) const {
-    auto iter = logs_index_.find(logid.val());
-    if (iter == logs_index_.end()) {
+    const LogIdIndex::Entry* entry = log_id_index_.find(logid.val());
+    if (entry == nullptr) {
       err = E::NOTFOUND;
       return nullptr;
     }
-    return &iter->second;
+    return &entry->value;
   }
 
   std::pair<DirectoryNode*, LogGroupNodePtr>
@@ -714,21 +865,12 @@ class LogsConfigTree {
 
   // returns true if the logid exists in the tree
   bool logExists(logid_t logid) const {
-    auto iter = logs_index_.find(logid.val());
-    if (iter == logs_index_.end()) {
-      err = E::NOTFOUND;
-      return false;
-    }
-    return true;
+    return getLogGroupByID(logid) != nullptr;
   }
 
-  const LogMap& getLogMap() const {
-    return logs_index_;
-  }
+  const LogMap& getLogMap() const;
 
-  size_t size() const {
-    return logs_index_.size();
-  }
+  size_t size() const;
 
   // returns true if the supplied logrange will clash with any of the log_groups
   // in the tree
@@ -766,7 +908,8 @@ class LogsConfigTree {
 
   // maximum finite backlog duration of a log
   std::chrono::seconds getMaxBacklogDuration() const {
-    return max_backlog_duration_;
+    return backlog_durations_.empty() ? std::chrono::seconds(0)
+                                      : backlog_durations_.rbegin()->first;
   }
   /**
    * Returns the "minimum" of the two replication properties. More precisely,
@@ -805,11 +948,9 @@ class LogsConfigTree {
    */
   void deduplicateAttributes() {
     if (root_) {
-      auto group_changed = [this](const DirectoryNode* parent,
-                                  LogGroupNodePtr group) {
-        updateLookupIndex(parent, group, true /* delete_old */);
-      };
-      root_->deduplicateRecursively(registry_, group_changed);
+      if (DirectoryNodePtr new_root = deduplicateDirectory(*root_)) {
+        root_ = std::move(new_root);
+      }
     }
   }
 
@@ -820,15 +961,42 @@ class LogsConfigTree {
  protected:
   LogsConfigTree& copy(const LogsConfigTree& other) {
     delimiter_ = other.delimiter_;
-    root_ = std::make_unique<DirectoryNode>(*other.root_);
+    // Shared until one of the trees modifies them, see mutableDirectory().
+    root_ = other.root_;
+    log_id_index_ = other.log_id_index_;
     version_ = other.version_;
     registry_ = other.registry_;
-    // We cannot copy the index because the Parent pointer in
-    // LogGroupInDirectory will be pointing to the old tree.
-    rebuildIndex();
+    backlog_durations_ = other.backlog_durations_;
+    // Built on first iteration, which published trees rarely need.
+    logs_index_.clear();
+    logs_index_valid_.store(false, std::memory_order_release);
     return *this;
   }
 
+  // Returns the directory at `path` for modification, or nullptr if there is
+  // none. The directories on the way to it that are shared with other trees
+  // are replaced with copies first, and the index entries of their log groups
+  // updated to point to the copies.
+  DirectoryNode* mutableDirectory(const std::string& path);
+
+  // Returns a copy of `dir` and its children directories with their
+  // attributes deduplicated, sharing those that don't change, or nullptr if
+  // nothing changes.
+  DirectoryNodePtr deduplicateDirectory(const DirectoryNode& dir);
+
+  // Builds the LogMap from the LogIdIndex if it's not up to date.
+  void buildLogMap() const;
+
+  // update backlog_durations_ for a log group added to or removed from the
+  // lookup index
+  void addBacklogDuration(const LogGroupNode& log_group);
+  void removeBacklogDuration(const LogGroupNode& log_group);
+
+  // appends to `entries` the ranges of all log groups in this directory and
+  // its children.
+  void collectLogIdIndexEntries(const DirectoryNode* dir,
+                                std::vector<LogIdIndex::Entry>& entries);
+
   /*
    * Adds a log group to a specific directory
    */
@@ -856,7 +1024,8 @@ class LogsConfigTree {
   // (only for first level)
   void rebuildIndexForDir(const DirectoryNode* dir, const bool delete_old);
 
-  // same as rebuildIndexForDir except that this rebuilds the whole tree
+  // Rebuilds the lookup index of the whole tree. Only the LogIdIndex is built,
+  // the LogMap is built when it's first needed.
   void rebuildIndex();
 
   std::string normalize_path(const std::string& path) const;
@@ -889,12 +1058,19 @@ class LogsConfigTree {
   std::pair<DirectoryNode*, std::deque<folly::StringPiece>>
   partialFindDirectory(DirectoryNode* parent,
                        const std::deque<folly::StringPiece>& tokens) const;
-  std::unique_ptr<DirectoryNode> root_;
+  DirectoryNodePtr root_;
   lsn_t version_ = 0l;
   std::string delimiter_;
-  // maximum finite backlog duration of a log
-  std::chrono::seconds max_backlog_duration_{0};
-  LogMap logs_index_;
+  // number of log groups with each finite backlog duration
+  std::map<std::chrono::seconds, size_t> backlog_durations_;
+
+  // The two lookup indexes, see the class comment. log_id_index_ is always up
+  // to date, logs_index_ only if logs_index_valid_.
+  LogIdIndex log_id_index_;
+  mutable LogMap logs_index_;
+  mutable std::atomic<bool> logs_index_valid_{true};
+  // Serializes the lazy build of logs_index_ by const methods.
+  mutable std::mutex index_mutex_;
   // Max version seen, this is meant to be used if this tree is not backed by
   // LogsConfigManager.
   static std::atomic<uint64_t> max_version;
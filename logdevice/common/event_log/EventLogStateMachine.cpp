@@ -284,6 +284,10 @@ bool EventLogStateMachine::canSnapshot() const {
       cansnapshot && snapshot_log_id_ != LOGID_INVALID;
 }
 
+size_t EventLogStateMachine::getSnapshotChunkSize() const {
+  return settings_->rsm_snapshot_chunk_size;
+}
+
 bool EventLogStateMachine::shouldCreateSnapshot() const {
   // Create a snapshot if:
   // 1. we are not already snapshotting;
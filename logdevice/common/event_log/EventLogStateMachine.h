@@ -151,6 +151,8 @@ class EventLogStateMachine
    */
   virtual bool canSnapshot() const override;
 
+  size_t getSnapshotChunkSize() const override;
+
   /**
    * @return True if this object is responsible for trimming and snapshotting.
    */
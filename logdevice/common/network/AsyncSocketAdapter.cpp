@@ -140,6 +140,10 @@ void AsyncSocketAdapter::writeChain(WriteCallback* callback,
   transport_->writeChain(callback, std::move(buf), flags);
 }
 
+bool AsyncSocketAdapter::setZeroCopy(bool enable) {
+  return transport_->setZeroCopy(enable);
+}
+
 int AsyncSocketAdapter::setSendBufSize(size_t bufsize) {
   return transport_->setSendBufSize(bufsize);
 }
@@ -237,6 +237,11 @@ class AsyncSocketAdapter : public SocketAdapter {
                   std::unique_ptr<folly::IOBuf>&& buf,
                   folly::WriteFlags flags = folly::WriteFlags::NONE) override;
 
+  /**
+   * Enable or disable SO_ZEROCOPY, see folly::AsyncSocket::setZeroCopy().
+   */
+  bool setZeroCopy(bool enable) override;
+
   /**
    * Set the send bufsize
    */
@@ -178,6 +178,19 @@ class SocketAdapter {
              std::unique_ptr<folly::IOBuf>&& buf,
              folly::WriteFlags flags = folly::WriteFlags::NONE) = 0;
 
+  /**
+   * Enable or disable SO_ZEROCOPY on the socket, so that writeChain() with
+   * folly::WriteFlags::WRITE_MSG_ZEROCOPY sends without copying the data
+   * into the kernel. The buffers are then held until the kernel reports
+   * completion.
+   *
+   * @return  true if zero-copy is now enabled or disabled as requested,
+   *          false if the socket or the kernel doesn't support it.
+   */
+  virtual bool setZeroCopy(bool /* enable */) {
+    return false;
+  }
+
   /**
    * Set the send bufsize
    */
@@ -205,12 +205,14 @@ Message::Disposition APPEND_Message::onReceived(const Address& from) {
   STAT_INCR(stats, append_received);
   STAT_ADD(stats, append_payload_bytes, payload_size);
   // Bump the per-log-group stats
-  if (auto log_path = Worker::getConfig()->getLogGroupPath(header_.logid)) {
-    LOG_GROUP_TIME_SERIES_ADD(
-        stats, append_in_bytes, log_path.value(), payload_size);
+  const log_group_stats_idx_t log_group_idx =
+      Worker::getConfig()->getLogGroupStatsIdx(header_.logid);
+  if (log_group_idx != LOG_GROUP_STATS_IDX_INVALID) {
+    LOG_GROUP_IDX_TIME_SERIES_ADD(
+        stats, append_in_bytes, log_group_idx, payload_size);
     if (attrs_.counters.has_value()) {
-      LOG_GROUP_CUSTOM_COUNTERS_ADD(
-          stats, log_path.value(), attrs_.counters.value());
+      LOG_GROUP_IDX_CUSTOM_COUNTERS_ADD(
+          stats, log_group_idx, attrs_.counters.value());
     }
   }
   WORKER_LOG_STAT_ADD(header_.logid, append_payload_bytes, payload_size);
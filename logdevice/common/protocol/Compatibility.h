@@ -53,6 +53,16 @@ enum ProtocolVersion : uint16_t {
 
   GET_RSM_SNAPSHOT_MESSAGE_SUPPORT, // = 103
 
+  // STORE_BATCH and STORED_BATCH messages
+  STORE_BATCH_SUPPORT, // = 104
+
+  // SEAL_BATCH message
+  SEAL_BATCH_SUPPORT, // = 105
+
+  // STORE_Header::APPEND_STAGES, and STORED_Header::APPEND_STAGES with the
+  // durations of storage node stages in STORED_Message
+  APPEND_STAGES_IN_STORED, // = 106
+
   // NOTE: insert new protocol versions here
 
   // Maximum version number of the protocol this version of LogDevice
@@ -77,6 +87,9 @@ static_assert(HEALTH_MONITOR_SUPPORT_IN_GOSSIP == 100, "");
 static_assert(NODE_STATUS_AND_HASHMAP_SUPPORT_IN_CLUSTER_STATE == 101, "");
 static_assert(INCLUDE_VERSIONS_IN_GOSSIP == 102, "");
 static_assert(GET_RSM_SNAPSHOT_MESSAGE_SUPPORT == 103, "");
+static_assert(STORE_BATCH_SUPPORT == 104, "");
+static_assert(SEAL_BATCH_SUPPORT == 105, "");
+static_assert(APPEND_STAGES_IN_STORED == 106, "");
 
 constexpr uint16_t MIN_PROTOCOL_SUPPORTED = PROTOCOL_VERSION_LOWER_BOUND + 1;
 constexpr uint16_t MAX_PROTOCOL_SUPPORTED = PROTOCOL_VERSION_UPPER_BOUND - 1;
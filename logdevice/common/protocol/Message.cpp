@@ -41,8 +41,10 @@ size_t Message::size(uint16_t proto) const {
   return ProtocolHeader::bytesNeeded(type_, proto) + size;
 }
 
-std::unique_ptr<folly::IOBuf> Message::serialize(uint16_t protocol,
-                                                 bool checksum_enabled) const {
+std::unique_ptr<folly::IOBuf>
+Message::serialize(uint16_t protocol,
+                   bool checksum_enabled,
+                   size_t* bytes_without_copy) const {
   const bool compute_checksum =
       ProtocolHeader::needChecksumInHeader(type_, protocol) && checksum_enabled;
 
@@ -77,6 +79,9 @@ std::unique_ptr<folly::IOBuf> Message::serialize(uint16_t protocol,
   protohdr.len = io_buf->computeChainDataLength();
 
   memcpy(static_cast<void*>(io_buf->writableData()), &protohdr, protohdr_bytes);
+  if (bytes_without_copy) {
+    *bytes_without_copy = writer.bytesWrittenWithoutCopy();
+  }
   return io_buf;
 }
 
@@ -74,12 +74,17 @@ struct Message {
    *                         checksum (it also depends on protocol version and
    *                         message type) but passing false will prevent
    *                         checksumming regaradless of other settings.
+   * @param bytes_without_copy  If not null, set to the number of bytes of the
+   *                         result that reference buffers of the message,
+   *                         e.g. payloads, rather than copies of them.
    *
    * @return pointer to IOBuf containing result or nullptr if serialization
    *         failed. In case of failure caller should check global error code.
    */
-  std::unique_ptr<folly::IOBuf> serialize(uint16_t protocol,
-                                          bool checksum_enabled) const;
+  std::unique_ptr<folly::IOBuf>
+  serialize(uint16_t protocol,
+            bool checksum_enabled,
+            size_t* bytes_without_copy = nullptr) const;
 
   /**
    * The type of a static factory that constructs a Message from a
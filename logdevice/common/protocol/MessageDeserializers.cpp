@@ -53,13 +53,16 @@
 #include "logdevice/common/protocol/RECORD_Message.h"
 #include "logdevice/common/protocol/RELEASE_Message.h"
 #include "logdevice/common/protocol/SEALED_Message.h"
+#include "logdevice/common/protocol/SEAL_BATCH_Message.h"
 #include "logdevice/common/protocol/SEAL_Message.h"
 #include "logdevice/common/protocol/SHARD_STATUS_UPDATE_Message.h"
 #include "logdevice/common/protocol/SHUTDOWN_Message.h"
 #include "logdevice/common/protocol/STARTED_Message.h"
 #include "logdevice/common/protocol/START_Message.h"
 #include "logdevice/common/protocol/STOP_Message.h"
+#include "logdevice/common/protocol/STORED_BATCH_Message.h"
 #include "logdevice/common/protocol/STORED_Message.h"
+#include "logdevice/common/protocol/STORE_BATCH_Message.h"
 #include "logdevice/common/protocol/STORE_Message.h"
 #include "logdevice/common/protocol/TEST_Message.h"
 #include "logdevice/common/protocol/TRIMMED_Message.h"
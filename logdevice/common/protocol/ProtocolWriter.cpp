@@ -300,6 +300,7 @@ void ProtocolWriter::writeWithoutCopy(const void* data, size_t nbytes) {
         [&] { return dest_->writeWithoutCopy(data, nbytes, nwritten_); });
   }
   nwritten_ += nbytes;
+  nwritten_without_copy_ += nbytes;
 }
 
 void ProtocolWriter::writeWithoutCopy(const folly::IOBuf* buffer) {
@@ -310,6 +311,7 @@ void ProtocolWriter::writeWithoutCopy(const folly::IOBuf* buffer) {
     writeImplCb([&] { return dest_->writeWithoutCopy(buffer, nwritten_); });
   }
   nwritten_ += buffer->length();
+  nwritten_without_copy_ += buffer->length();
 }
 
 }} // namespace facebook::logdevice
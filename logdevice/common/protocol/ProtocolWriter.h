@@ -218,6 +218,14 @@ class ProtocolWriter {
     return status_ == E::OK ? nwritten_ : -1;
   }
 
+  /**
+   * Number of bytes of the result passed to writeWithoutCopy(). Destinations
+   * that support it reference them rather than copying them.
+   */
+  size_t bytesWrittenWithoutCopy() const {
+    return nwritten_without_copy_;
+  }
+
   /**
    * Returns `true` if this ProtocolWriter doesn't care about the data being
    * written. This is used for optimizing message size calculations
@@ -298,6 +306,8 @@ class ProtocolWriter {
   const char* context_;
 
   size_t nwritten_ = 0;
+  // Part of nwritten_ written with writeWithoutCopy()
+  size_t nwritten_without_copy_ = 0;
   // Connection protocol
   folly::Optional<uint16_t> proto_;
   // Protocol gate; write calls are ignored if `proto_' < `proto_gate_'
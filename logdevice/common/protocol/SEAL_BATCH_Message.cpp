@@ -0,0 +1,79 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/protocol/SEAL_BATCH_Message.h"
+
+#include "logdevice/common/SealBatcher.h"
+#include "logdevice/common/Worker.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/common/protocol/ProtocolReader.h"
+#include "logdevice/common/protocol/ProtocolWriter.h"
+
+namespace facebook { namespace logdevice {
+
+SEAL_BATCH_Message::SEAL_BATCH_Message(std::vector<SEAL_Header> headers)
+    : Message(MessageType::SEAL_BATCH, TrafficClass::RECOVERY),
+      headers_(std::move(headers)) {
+  ld_check(!headers_.empty());
+}
+
+void SEAL_BATCH_Message::serialize(ProtocolWriter& writer) const {
+  writer.write(static_cast<uint32_t>(headers_.size()));
+  writer.writeVector(headers_);
+}
+
+MessageReadResult SEAL_BATCH_Message::deserialize(ProtocolReader& reader) {
+  uint32_t count = 0;
+  reader.read(&count);
+  if (reader.ok() && count == 0) {
+    ld_error("Bad SEAL_BATCH message: no SEALs");
+    return reader.errorResult(E::BADMSG);
+  }
+
+  std::vector<SEAL_Header> headers;
+  reader.readVector(&headers, count);
+  return reader.result(
+      [&] { return new SEAL_BATCH_Message(std::move(headers)); });
+}
+
+void SEAL_BATCH_Message::onSent(Status st, const Address& to) const {
+  if (st == E::PROTONOSUPPORT) {
+    // Sent before the connection was handshaken, to a node that turned out
+    // not to support SEAL_BATCH. Send the SEALs on their own instead.
+    Worker::onThisThread()->sealBatcher().onBatchNotSupported(
+        headers_, to.asNodeID());
+    return;
+  }
+  for (const auto& header : headers_) {
+    SEAL_Message::onSentCommon(header, st, to);
+  }
+}
+
+uint16_t SEAL_BATCH_Message::getMinProtocolVersion() const {
+  return Compatibility::SEAL_BATCH_SUPPORT;
+}
+
+PermissionParams SEAL_BATCH_Message::getPermissionParams() const {
+  PermissionParams params;
+  params.requiresPermission = true;
+  params.action = ACTION::SERVER_INTERNAL;
+  return params;
+}
+
+std::vector<std::pair<std::string, folly::dynamic>>
+SEAL_BATCH_Message::getDebugInfo() const {
+  std::vector<std::pair<std::string, folly::dynamic>> res;
+  folly::dynamic logs = folly::dynamic::array();
+  for (const auto& header : headers_) {
+    logs.push_back(header.log_id.val_);
+  }
+  res.emplace_back("num_seals", headers_.size());
+  res.emplace_back("logs", std::move(logs));
+  return res;
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,60 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <vector>
+
+#include "logdevice/common/protocol/Message.h"
+#include "logdevice/common/protocol/SEAL_Message.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file SEAL_BATCH carries the SEALs that log recoveries running on one
+ *       Worker sent to the same storage node within an iteration of the
+ *       Worker's event loop. When a sequencer node takes over many logs at
+ *       once, this lets the storage node write (and sync) the seals of all
+ *       of them together. See SealBatcher.
+ *
+ *       The storage node still replies to each SEAL with its own SEALED, and
+ *       notifications of the batch being sent are passed to the recovery of
+ *       every log in the batch.
+ *
+ *       Wire format: a uint32_t number of SEALs, then that many SEAL_Headers.
+ */
+
+class SEAL_BATCH_Message : public Message {
+ public:
+  explicit SEAL_BATCH_Message(std::vector<SEAL_Header> headers);
+
+  SEAL_BATCH_Message(const SEAL_BATCH_Message&) = delete;
+  SEAL_BATCH_Message& operator=(const SEAL_BATCH_Message&) = delete;
+
+  const std::vector<SEAL_Header>& getHeaders() const {
+    return headers_;
+  }
+
+  // see Message.h
+  void serialize(ProtocolWriter& writer) const override;
+  void onSent(Status st, const Address& to) const override;
+  Disposition onReceived(const Address&) override {
+    // Receipt handler lives in server/SEAL_BATCH_onReceived.cpp; this should
+    // never get called.
+    std::abort();
+  }
+  uint16_t getMinProtocolVersion() const override;
+  PermissionParams getPermissionParams() const override;
+  std::vector<std::pair<std::string, folly::dynamic>>
+  getDebugInfo() const override;
+  static Message::deserializer_t deserialize;
+
+ private:
+  std::vector<SEAL_Header> headers_;
+};
+
+}} // namespace facebook::logdevice
@@ -58,6 +58,12 @@ class SEAL_Message : public Message {
   PermissionParams getPermissionParams() const override;
   static Message::deserializer_t deserialize;
 
+  // Notifies the log recovery that sent the SEAL described by `header', if
+  // it's still running. Also used for SEALs sent in a SEAL_BATCH.
+  static void onSentCommon(const SEAL_Header& header,
+                           Status status,
+                           const Address& to);
+
   SEAL_Header header_;
 };
 
@@ -0,0 +1,120 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/protocol/STORED_BATCH_Message.h"
+
+#include <folly/io/IOBuf.h>
+
+#include "logdevice/common/Sender.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/common/protocol/ProtocolReader.h"
+#include "logdevice/common/protocol/ProtocolWriter.h"
+#include "logdevice/common/util.h"
+
+namespace facebook { namespace logdevice {
+
+STORED_BATCH_Message::STORED_BATCH_Message(
+    std::vector<std::unique_ptr<STORED_Message>> replies)
+    : Message(MessageType::STORED_BATCH, TrafficClass::APPEND),
+      replies_(std::move(replies)) {
+  ld_check(!replies_.empty());
+}
+
+void STORED_BATCH_Message::serialize(ProtocolWriter& writer) const {
+  writer.write(static_cast<uint32_t>(replies_.size()));
+  for (const auto& reply : replies_) {
+    ProtocolWriter size_writer(MessageType::STORED,
+                               static_cast<folly::IOBuf*>(nullptr),
+                               writer.proto());
+    reply->serialize(size_writer);
+    ssize_t len = size_writer.result();
+    if (len < 0) {
+      writer.setError(size_writer.status());
+      return;
+    }
+    writer.write(static_cast<uint32_t>(len));
+    reply->serialize(writer);
+  }
+}
+
+MessageReadResult STORED_BATCH_Message::deserialize(ProtocolReader& reader) {
+  uint32_t count = 0;
+  reader.read(&count);
+  if (reader.ok() && count == 0) {
+    ld_error("Bad STORED_BATCH message: no STOREDs");
+    return reader.errorResult(E::BADMSG);
+  }
+
+  std::vector<std::unique_ptr<STORED_Message>> replies;
+  for (uint32_t i = 0; i < count && reader.ok(); ++i) {
+    uint32_t len = 0;
+    reader.read(&len);
+    folly::IOBuf buf;
+    reader.readIOBuf(&buf, len);
+    if (!reader.ok()) {
+      break;
+    }
+    ProtocolReader reply_reader(MessageType::STORED,
+                                std::make_unique<folly::IOBuf>(std::move(buf)),
+                                reader.proto());
+    MessageReadResult res = STORED_Message::deserialize(reply_reader);
+    if (!res.msg) {
+      ld_error("Bad STORED_BATCH message: failed to read STORED %u of %u: %s",
+               i,
+               count,
+               error_name(err));
+      return reader.errorResult(E::BADMSG);
+    }
+    replies.push_back(
+        checked_downcast<std::unique_ptr<STORED_Message>>(std::move(res.msg)));
+  }
+
+  return reader.result(
+      [&] { return new STORED_BATCH_Message(std::move(replies)); });
+}
+
+Message::Disposition STORED_BATCH_Message::onReceived(const Address& from) {
+  // Replies to rebuilding STOREs are never batched, so every STORED goes
+  // to its Appender as STORED_onReceived() would do.
+  for (const auto& reply : replies_) {
+    if (reply->header_.flags & STORED_Header::REBUILDING) {
+      RATELIMIT_ERROR(std::chrono::seconds(10),
+                      2,
+                      "PROTOCOL ERROR: got a STORED_BATCH from %s with a "
+                      "reply to a rebuilding STORE for record %s",
+                      Sender::describeConnection(from).c_str(),
+                      reply->header_.rid.toString().c_str());
+      err = E::PROTO;
+      return Disposition::ERROR;
+    }
+  }
+  for (auto& reply : replies_) {
+    if (reply->onReceivedCommon(from) == Disposition::ERROR) {
+      // err is set, the connection is about to be closed.
+      return Disposition::ERROR;
+    }
+  }
+  return Disposition::NORMAL;
+}
+
+uint16_t STORED_BATCH_Message::getMinProtocolVersion() const {
+  return Compatibility::STORE_BATCH_SUPPORT;
+}
+
+std::vector<std::pair<std::string, folly::dynamic>>
+STORED_BATCH_Message::getDebugInfo() const {
+  std::vector<std::pair<std::string, folly::dynamic>> res;
+  folly::dynamic records = folly::dynamic::array();
+  for (const auto& reply : replies_) {
+    records.push_back(reply->header_.rid.toString());
+  }
+  res.emplace_back("num_replies", replies_.size());
+  res.emplace_back("records", std::move(records));
+  return res;
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,58 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "logdevice/common/protocol/Message.h"
+#include "logdevice/common/protocol/STORED_Message.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file STORED_BATCH carries several STORED replies that a Worker of a
+ *       storage node sent to the same sequencer within an iteration of its
+ *       event loop. It is the counterpart of STORE_BATCH, see StoreBatcher.
+ *
+ *       Only replies to STOREs sent by Appenders are batched. The sequencer
+ *       handles each STORED as if it had arrived on its own.
+ *
+ *       Wire format: same as STORE_BATCH, a uint32_t number of STOREDs, then
+ *       each STORED prefixed with its length as uint32_t.
+ */
+
+class STORED_BATCH_Message : public Message {
+ public:
+  explicit STORED_BATCH_Message(
+      std::vector<std::unique_ptr<STORED_Message>> replies);
+
+  STORED_BATCH_Message(const STORED_BATCH_Message&) = delete;
+  STORED_BATCH_Message& operator=(const STORED_BATCH_Message&) = delete;
+
+  int8_t getExecutorPriority() const override {
+    return folly::Executor::HI_PRI;
+  }
+
+  // see Message.h
+  void serialize(ProtocolWriter& writer) const override;
+  Disposition onReceived(const Address& from) override;
+  uint16_t getMinProtocolVersion() const override;
+  std::vector<std::pair<std::string, folly::dynamic>>
+  getDebugInfo() const override;
+  static Message::deserializer_t deserialize;
+
+  const std::vector<std::unique_ptr<STORED_Message>>& getReplies() const {
+    return replies_;
+  }
+
+ private:
+  std::vector<std::unique_ptr<STORED_Message>> replies_;
+};
+
+}} // namespace facebook::logdevice
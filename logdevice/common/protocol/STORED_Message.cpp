@@ -16,8 +16,10 @@
 #include "logdevice/common/Request.h"
 #include "logdevice/common/RequestType.h"
 #include "logdevice/common/Sender.h"
+#include "logdevice/common/StoreBatcher.h"
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/debug.h"
+#include "logdevice/common/protocol/Compatibility.h"
 #include "logdevice/common/protocol/ProtocolReader.h"
 #include "logdevice/common/protocol/ProtocolWriter.h"
 #include "logdevice/common/stats/Stats.h"
@@ -73,19 +75,40 @@ MessageReadResult STORED_Message::deserialize(ProtocolReader& reader) {
     }
   }
 
+  StorageStageDurations append_stages{};
+  if (hdr.flags & STORED_Header::APPEND_STAGES) {
+    uint8_t num_stages = 0;
+    reader.read(&num_stages);
+    for (uint8_t i = 0; i < num_stages; ++i) {
+      uint32_t usec = 0;
+      reader.read(&usec);
+      if (i < append_stages.size()) {
+        append_stages[i] = usec;
+      }
+    }
+  }
+
   return reader.result([&] {
-    return new STORED_Message(hdr,
-                              rebuilding_version,
-                              rebuilding_wave,
-                              rebuilding_id,
-                              flushToken,
-                              serverInstanceId,
-                              rebuildingRecipient);
+    auto msg = new STORED_Message(hdr,
+                                  rebuilding_version,
+                                  rebuilding_wave,
+                                  rebuilding_id,
+                                  flushToken,
+                                  serverInstanceId,
+                                  rebuildingRecipient);
+    msg->append_stages_ = append_stages;
+    return msg;
   });
 }
 
 void STORED_Message::serialize(ProtocolWriter& writer) const {
-  writer.write(&header_, STORED_Header::headerSize(writer.proto()));
+  STORED_Header proto_supported_header(header_);
+  if (writer.proto() <
+      Compatibility::ProtocolVersion::APPEND_STAGES_IN_STORED) {
+    proto_supported_header.flags &= ~STORED_Header::APPEND_STAGES;
+  }
+  writer.write(&proto_supported_header,
+               STORED_Header::headerSize(writer.proto()));
   if (header_.flags & STORED_Header::REBUILDING) {
     writer.write(rebuilding_version_);
     writer.write(rebuilding_wave_);
@@ -96,12 +119,19 @@ void STORED_Message::serialize(ProtocolWriter& writer) const {
   if (header_.status == E::REBUILDING) {
     writer.write(rebuildingRecipient_);
   }
+  if (proto_supported_header.flags & STORED_Header::APPEND_STAGES) {
+    writer.write(static_cast<uint8_t>(append_stages_.size()));
+    for (uint32_t usec : append_stages_) {
+      writer.write(usec);
+    }
+  }
 }
 
 Message::Disposition
 STORED_Message::handleOneMessage(const STORED_Header& header,
                                  ShardID from,
-                                 ShardID rebuildingRecipient) {
+                                 ShardID rebuildingRecipient,
+                                 const StorageStageDurations* append_stages) {
   Appender* appender{
       // Appender that sent the corresponding STORE
       Worker::onThisThread()->activeAppenders().map.find(header.rid)};
@@ -115,7 +145,7 @@ STORED_Message::handleOneMessage(const STORED_Header& header,
 
   ld_assert(header.rid == Appender::KeyExtractor()(*appender));
 
-  return appender->onReply(header, from, rebuildingRecipient)
+  return appender->onReply(header, from, rebuildingRecipient, append_stages)
       ? Disposition::ERROR
       : Disposition::NORMAL;
 }
@@ -174,7 +204,12 @@ Message::Disposition STORED_Message::onReceivedCommon(const Address& from) {
     }
   }
 
-  return handleOneMessage(header_, shard, rebuildingRecipient_);
+  return handleOneMessage(
+      header_,
+      shard,
+      rebuildingRecipient_,
+      (header_.flags & STORED_Header::APPEND_STAGES) ? &append_stages_
+                                                     : nullptr);
 }
 
 /**
@@ -248,6 +283,10 @@ class SendSTOREDRequest : public Request {
           to.getIdx());
     }
 
+    if (Worker::onThisThread()->storeBatcher().addSTORED(msg, to)) {
+      return;
+    }
+
     rv = sender.sendMessage(std::move(msg), to);
     if (rv != 0) {
       RATELIMIT_INFO(std::chrono::seconds(10),
@@ -272,7 +311,8 @@ void STORED_Message::createAndSend(const STORED_Header& header,
                                    uint32_t rebuilding_wave,
                                    chunk_rebuilding_id_t rebuilding_id,
                                    FlushToken flushToken,
-                                   ShardID rebuildingRecipient) {
+                                   ShardID rebuildingRecipient,
+                                   const StorageStageDurations* append_stages) {
   ld_check(send_to.valid()); // must have been set by onReceived()
   Worker* worker = Worker::onThisThread();
 
@@ -357,6 +397,10 @@ void STORED_Message::createAndSend(const STORED_Header& header,
                                                 flushToken,
                                                 serverInstanceId,
                                                 rebuildingRecipient);
+    if (append_stages) {
+      msg->header_.flags |= STORED_Header::APPEND_STAGES;
+      msg->append_stages_ = *append_stages;
+    }
 
     if (target_worker.second == worker->idx_) {
       // the connection to origin is handled by this Worker thread
@@ -397,6 +441,7 @@ STORED_Message::getDebugInfo() const {
     FLAG(REBUILDING)
     FLAG(PREMPTED_BY_SOFT_SEAL_ONLY)
     FLAG(LOW_WATERMARK_NOSPC)
+    FLAG(APPEND_STAGES)
 #undef FLAG
     return folly::join('|', strings);
   };
@@ -420,6 +465,9 @@ STORED_Message::getDebugInfo() const {
     add("server_instance_id", serverInstanceId_);
     add("rebuilding_recipient", rebuildingRecipient_.toString());
   }
+  if (header_.flags & STORED_Header::APPEND_STAGES) {
+    add("append_stages", toString(append_stages_));
+  }
 
   return res;
 }
@@ -9,6 +9,7 @@
 
 #include <cstdint>
 
+#include "logdevice/common/AppendStage.h"
 #include "logdevice/common/ClientID.h"
 #include "logdevice/common/NodeID.h"
 #include "logdevice/common/RecordID.h"
@@ -97,6 +98,9 @@ struct STORED_Header {
   static const STORED_flags_t PREMPTED_BY_SOFT_SEAL_ONLY = 1ul << 4; //=16
   // the local log store's partition crossed low-watermark
   static const STORED_flags_t LOW_WATERMARK_NOSPC = 1ul << 5; //=32
+  // the STORE had STORE_Header::APPEND_STAGES; the message carries the
+  // durations of the storage node stages of the STORE
+  static const STORED_flags_t APPEND_STAGES = 1ul << 6; //=64
 } __attribute__((__packed__));
 
 class STORED_Message : public Message {
@@ -144,13 +148,15 @@ class STORED_Message : public Message {
    * current Worker, a Request is sent to the responsible Worker, which will
    * send the message.
    */
-  static void createAndSend(const STORED_Header& header,
-                            ClientID send_to,
-                            lsn_t rebuilding_version,
-                            uint32_t rebuilding_wave,
-                            chunk_rebuilding_id_t rebuilding_id,
-                            FlushToken flushToken = FlushToken_INVALID,
-                            ShardID rebuildingRecipient = ShardID());
+  static void
+  createAndSend(const STORED_Header& header,
+                ClientID send_to,
+                lsn_t rebuilding_version,
+                uint32_t rebuilding_wave,
+                chunk_rebuilding_id_t rebuilding_id,
+                FlushToken flushToken = FlushToken_INVALID,
+                ShardID rebuildingRecipient = ShardID(),
+                const StorageStageDurations* append_stages = nullptr);
 
   STORED_Header header_;
 
@@ -178,6 +184,11 @@ class STORED_Message : public Message {
   // recipient in the copyset that is in the rebuilding set.
   ShardID rebuildingRecipient_;
 
+  // If the APPEND_STAGES flag is set, how long the storage node stages of
+  // the STORE took. Serialized as a count followed by that many durations,
+  // so that stages can be added later; unknown trailing ones are ignored.
+  StorageStageDurations append_stages_{};
+
   virtual std::vector<std::pair<std::string, folly::dynamic>>
   getDebugInfo() const override;
 
@@ -185,9 +196,11 @@ class STORED_Message : public Message {
   /**
    * Calls Appender::onReply() once (at most).  Helper function.
    */
-  static Message::Disposition handleOneMessage(const STORED_Header& header,
-                                               ShardID from,
-                                               ShardID rebuildingRecipient);
+  static Message::Disposition
+  handleOneMessage(const STORED_Header& header,
+                   ShardID from,
+                   ShardID rebuildingRecipient,
+                   const StorageStageDurations* append_stages = nullptr);
 
   friend Disposition STORED_onReceived(STORED_Message* msg,
                                        const Address& from);
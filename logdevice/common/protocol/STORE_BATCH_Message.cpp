@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/protocol/STORE_BATCH_Message.h"
+
+#include <folly/io/IOBuf.h>
+
+#include "logdevice/common/debug.h"
+#include "logdevice/common/protocol/ProtocolReader.h"
+#include "logdevice/common/protocol/ProtocolWriter.h"
+#include "logdevice/common/util.h"
+
+namespace facebook { namespace logdevice {
+
+STORE_BATCH_Message::STORE_BATCH_Message(
+    std::vector<std::unique_ptr<STORE_Message>> stores)
+    : Message(MessageType::STORE_BATCH, TrafficClass::APPEND),
+      stores_(std::move(stores)) {
+  ld_check(!stores_.empty());
+}
+
+void STORE_BATCH_Message::serialize(ProtocolWriter& writer) const {
+  writer.write(static_cast<uint32_t>(stores_.size()));
+  for (const auto& store : stores_) {
+    // Find out the length of the STORE without copying anything.
+    ProtocolWriter size_writer(MessageType::STORE,
+                               static_cast<folly::IOBuf*>(nullptr),
+                               writer.proto());
+    store->serialize(size_writer);
+    ssize_t len = size_writer.result();
+    if (len < 0) {
+      writer.setError(size_writer.status());
+      return;
+    }
+    writer.write(static_cast<uint32_t>(len));
+    store->serialize(writer);
+  }
+}
+
+MessageReadResult STORE_BATCH_Message::deserialize(ProtocolReader& reader) {
+  uint32_t count = 0;
+  reader.read(&count);
+  if (reader.ok() && count == 0) {
+    ld_error("Bad STORE_BATCH message: no STOREs");
+    return reader.errorResult(E::BADMSG);
+  }
+
+  std::vector<std::unique_ptr<STORE_Message>> stores;
+  for (uint32_t i = 0; i < count && reader.ok(); ++i) {
+    uint32_t len = 0;
+    reader.read(&len);
+    folly::IOBuf buf;
+    reader.readIOBuf(&buf, len);
+    if (!reader.ok()) {
+      break;
+    }
+    // Each STORE is read by a reader of its own since STORE_Message takes
+    // everything after its header as the payload.
+    ProtocolReader store_reader(MessageType::STORE,
+                                std::make_unique<folly::IOBuf>(std::move(buf)),
+                                reader.proto());
+    MessageReadResult res = STORE_Message::deserialize(store_reader);
+    if (!res.msg) {
+      ld_error("Bad STORE_BATCH message: failed to read STORE %u of %u: %s",
+               i,
+               count,
+               error_name(err));
+      return reader.errorResult(E::BADMSG);
+    }
+    stores.push_back(
+        checked_downcast<std::unique_ptr<STORE_Message>>(std::move(res.msg)));
+  }
+
+  return reader.result(
+      [&] { return new STORE_BATCH_Message(std::move(stores)); });
+}
+
+void STORE_BATCH_Message::onSent(Status st, const Address& to) const {
+  // Only STOREs sent by Appenders are batched, so the server-specific part of
+  // STORE_onSent() does not apply.
+  for (const auto& store : stores_) {
+    store->onSentCommon(st, to);
+  }
+}
+
+uint16_t STORE_BATCH_Message::getMinProtocolVersion() const {
+  return Compatibility::STORE_BATCH_SUPPORT;
+}
+
+PermissionParams STORE_BATCH_Message::getPermissionParams() const {
+  PermissionParams params;
+  params.requiresPermission = true;
+  params.action = ACTION::SERVER_INTERNAL;
+  return params;
+}
+
+std::vector<std::pair<std::string, folly::dynamic>>
+STORE_BATCH_Message::getDebugInfo() const {
+  std::vector<std::pair<std::string, folly::dynamic>> res;
+  folly::dynamic records = folly::dynamic::array();
+  for (const auto& store : stores_) {
+    records.push_back(store->getHeader().rid.toString());
+  }
+  res.emplace_back("num_stores", stores_.size());
+  res.emplace_back("records", std::move(records));
+  return res;
+}
+
+}} // namespace facebook::logdevice
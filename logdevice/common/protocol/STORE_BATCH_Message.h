@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "logdevice/common/protocol/Message.h"
+#include "logdevice/common/protocol/STORE_Message.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file STORE_BATCH carries several STORE messages that Appenders of one
+ *       Worker sent to the same storage node within an iteration of the
+ *       Worker's event loop, so that they are shaped and framed once. See
+ *       StoreBatcher.
+ *
+ *       The storage node handles each STORE as if it had arrived on its own,
+ *       and notifications of the batch being sent are passed to every STORE.
+ *       Only STOREs sent by Appenders are batched, recovery and rebuilding
+ *       STOREs are always sent on their own.
+ *
+ *       Wire format: a uint32_t number of STOREs, then for each STORE its
+ *       length as uint32_t followed by the STORE as serialized by
+ *       STORE_Message::serialize().
+ */
+
+class STORE_BATCH_Message : public Message {
+ public:
+  explicit STORE_BATCH_Message(
+      std::vector<std::unique_ptr<STORE_Message>> stores);
+
+  STORE_BATCH_Message(const STORE_BATCH_Message&) = delete;
+  STORE_BATCH_Message& operator=(const STORE_BATCH_Message&) = delete;
+
+  int8_t getExecutorPriority() const override {
+    return folly::Executor::HI_PRI;
+  }
+
+  // see Message.h
+  void serialize(ProtocolWriter& writer) const override;
+  void onSent(Status st, const Address& to) const override;
+  Disposition onReceived(const Address&) override {
+    // Receipt handler lives in StoreStateMachine::onReceived(); this should
+    // never get called.
+    std::abort();
+  }
+  uint16_t getMinProtocolVersion() const override;
+  PermissionParams getPermissionParams() const override;
+  std::vector<std::pair<std::string, folly::dynamic>>
+  getDebugInfo() const override;
+  static Message::deserializer_t deserialize;
+
+  std::vector<std::unique_ptr<STORE_Message>>& getStores() {
+    return stores_;
+  }
+
+  const std::vector<std::unique_ptr<STORE_Message>>& getStores() const {
+    return stores_;
+  }
+
+ private:
+  std::vector<std::unique_ptr<STORE_Message>> stores_;
+};
+
+}} // namespace facebook::logdevice
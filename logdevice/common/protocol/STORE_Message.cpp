@@ -123,6 +123,10 @@ void STORE_Message::serialize(ProtocolWriter& writer) const {
   if (writer.proto() < Compatibility::ProtocolVersion::STREAM_WRITER_SUPPORT) {
     proto_supported_header.flags &= ~STORE_Header::WRITE_STREAM;
   }
+  if (writer.proto() <
+      Compatibility::ProtocolVersion::APPEND_STAGES_IN_STORED) {
+    proto_supported_header.flags &= ~STORE_Header::APPEND_STAGES;
+  }
   writer.write(proto_supported_header);
 
   if (header_.flags & STORE_Header::RECOVERY) {
@@ -480,6 +484,7 @@ std::string STORE_Message::flagsToString(STORE_flags_t flags) {
   FLAG(DRAINED)
   FLAG(WRITE_STREAM)
   FLAG(PAYLOAD_GROUP)
+  FLAG(APPEND_STAGES)
 
 #undef FLAG
 
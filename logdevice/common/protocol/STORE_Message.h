@@ -169,6 +169,11 @@ struct STORE_Header {
   // Record contains serialized PayloadGroup
   static const STORE_flags_t PAYLOAD_GROUP = 1u << 23; //=8388608
 
+  // The append was sampled by the sequencer for latency breakdown. The
+  // storage node times its stages of the STORE and reports them in STORED.
+  // @see AppendStageTimer
+  static const STORE_flags_t APPEND_STAGES = 1u << 24; //=16777216
+
   // Please update STORE_Message::flagsToString() when adding flags.
 } __attribute__((__packed__));
 
@@ -0,0 +1,268 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/replicated_state_machine/RSMSnapshotChunks.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <zstd.h>
+
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/executors/thread_factory/NamedThreadFactory.h>
+#include <folly/futures/Future.h>
+
+#include "logdevice/common/debug.h"
+#include "logdevice/include/Err.h"
+
+namespace facebook { namespace logdevice {
+
+namespace {
+
+struct ChunkInfo {
+  uint32_t uncompressed_size;
+  uint32_t size;
+} __attribute__((__packed__));
+
+static_assert(sizeof(ChunkInfo) == 8, "");
+
+// Keeps the compressed size of a chunk well within uint32_t.
+constexpr size_t MAX_CHUNK_SIZE = 1ul << 30;
+
+// Threads that (de)compress chunks. Callers block until their chunks are
+// done, so this must be a pool that they never run on themselves. Sharing e.g.
+// the global CPU executor with them could deadlock it. Never destroyed, so
+// that it outlives every caller.
+folly::Executor& chunkExecutor() {
+  static folly::CPUThreadPoolExecutor* executor =
+      new folly::CPUThreadPoolExecutor(
+          std::max(1u, std::min(8u, std::thread::hardware_concurrency())),
+          std::make_shared<folly::NamedThreadFactory>("ld:rsm-chunks"));
+  return *executor;
+}
+
+// Calls @param fn(i) for every i in [0, n). Calls are spread over
+// chunkExecutor() when there is more than one. The caller blocks until all of
+// them are done, which is no worse than doing the same work inline.
+//
+// @return true if all calls returned true.
+template <typename Fn>
+bool forEachChunk(size_t n, Fn&& fn) {
+  if (n <= 1) {
+    return n == 0 || fn(0);
+  }
+
+  std::vector<folly::Future<bool>> futs;
+  futs.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    futs.push_back(folly::via(&chunkExecutor()).thenValue([&fn, i](auto&&) {
+      return fn(i);
+    }));
+  }
+  bool ok = true;
+  for (auto& res : folly::collectAll(futs.begin(), futs.end()).get()) {
+    ok = ok && res.hasValue() && res.value();
+  }
+  return ok;
+}
+
+} // namespace
+
+int RSMSnapshotChunks::encode(Payload state,
+                              size_t chunk_size,
+                              bool compress,
+                              std::string& out) {
+  ld_check(chunk_size > 0);
+  chunk_size = std::min(chunk_size, MAX_CHUNK_SIZE);
+  if (state.size() > MAX_STATE_SIZE) {
+    ld_error("Snapshot state of %zu bytes is larger than the maximum of %zu",
+             state.size(),
+             MAX_STATE_SIZE);
+    err = E::TOOBIG;
+    return -1;
+  }
+
+  const char* src = static_cast<const char*>(state.data());
+  const size_t nchunks = (state.size() + chunk_size - 1) / chunk_size;
+  auto chunk_start = [&](size_t i) { return i * chunk_size; };
+  auto chunk_len = [&](size_t i) {
+    return std::min(chunk_size, state.size() - chunk_start(i));
+  };
+
+  std::vector<std::string> compressed;
+  if (compress) {
+    compressed.resize(nchunks);
+    bool ok = forEachChunk(nchunks, [&](size_t i) {
+      std::string& dst = compressed[i];
+      dst.resize(ZSTD_compressBound(chunk_len(i)));
+      size_t rv = ZSTD_compress(&dst[0],
+                                dst.size(),
+                                src + chunk_start(i),
+                                chunk_len(i),
+                                ZSTD_LEVEL);
+      if (ZSTD_isError(rv)) {
+        RATELIMIT_ERROR(std::chrono::seconds(1),
+                        1,
+                        "ZSTD_compress() failed: %s",
+                        ZSTD_getErrorName(rv));
+        return false;
+      }
+      dst.resize(rv);
+      return true;
+    });
+    if (!ok) {
+      err = E::INTERNAL;
+      return -1;
+    }
+  }
+
+  const uint32_t n = nchunks;
+  out.append(reinterpret_cast<const char*>(&n), sizeof(n));
+  for (size_t i = 0; i < nchunks; ++i) {
+    ChunkInfo info;
+    info.uncompressed_size = chunk_len(i);
+    info.size = compress ? compressed[i].size() : chunk_len(i);
+    out.append(reinterpret_cast<const char*>(&info), sizeof(info));
+  }
+  for (size_t i = 0; i < nchunks; ++i) {
+    if (compress) {
+      out.append(compressed[i]);
+    } else {
+      out.append(src + chunk_start(i), chunk_len(i));
+    }
+  }
+  return 0;
+}
+
+int RSMSnapshotChunks::decode(Payload payload,
+                              bool compressed,
+                              std::string& state_out) {
+  const char* ptr = static_cast<const char*>(payload.data());
+  const size_t size = payload.size();
+
+  uint32_t nchunks;
+  if (size < sizeof(nchunks)) {
+    ld_error("Chunked snapshot too small: %zu bytes", size);
+    err = E::BADMSG;
+    return -1;
+  }
+  memcpy(&nchunks, ptr, sizeof(nchunks));
+  const size_t table_size = sizeof(nchunks) + nchunks * sizeof(ChunkInfo);
+  if (size < table_size) {
+    ld_error("Chunked snapshot of %zu bytes too small for %u chunks",
+             size,
+             nchunks);
+    err = E::BADMSG;
+    return -1;
+  }
+
+  std::vector<ChunkInfo> chunks(nchunks);
+  memcpy(chunks.data(), ptr + sizeof(nchunks), nchunks * sizeof(ChunkInfo));
+
+  // Offsets of each chunk in the payload and in the decoded state.
+  std::vector<size_t> src_offsets(nchunks);
+  std::vector<size_t> dst_offsets(nchunks);
+  size_t src_off = table_size;
+  size_t dst_off = 0;
+  for (size_t i = 0; i < nchunks; ++i) {
+    if (!compressed && chunks[i].size != chunks[i].uncompressed_size) {
+      ld_error("Chunk %zu of uncompressed snapshot has size %u but "
+               "uncompressed size %u",
+               i,
+               chunks[i].size,
+               chunks[i].uncompressed_size);
+      err = E::BADMSG;
+      return -1;
+    }
+    if (chunks[i].uncompressed_size > MAX_CHUNK_SIZE) {
+      ld_error("Chunk %zu of snapshot has uncompressed size %u, more than "
+               "the maximum of %zu",
+               i,
+               chunks[i].uncompressed_size,
+               MAX_CHUNK_SIZE);
+      err = E::BADMSG;
+      return -1;
+    }
+    src_offsets[i] = src_off;
+    dst_offsets[i] = dst_off;
+    src_off += chunks[i].size;
+    dst_off += chunks[i].uncompressed_size;
+  }
+  // The table is not trusted with the size of state_out: check it against
+  // the payload and the limit before allocating.
+  if (src_off != size) {
+    ld_error("Chunks of snapshot add up to %zu bytes, expected %zu",
+             src_off,
+             size);
+    err = E::BADMSG;
+    return -1;
+  }
+  if (dst_off > MAX_STATE_SIZE) {
+    ld_error("Chunks of snapshot add up to %zu bytes uncompressed, more than "
+             "the maximum of %zu",
+             dst_off,
+             MAX_STATE_SIZE);
+    err = E::BADMSG;
+    return -1;
+  }
+  if (compressed) {
+    // Each chunk is a single zstd frame that records its content size. A
+    // table that disagrees with the frames is corrupt.
+    for (size_t i = 0; i < nchunks; ++i) {
+      unsigned long long frame_size =
+          ZSTD_getDecompressedSize(ptr + src_offsets[i], chunks[i].size);
+      if (frame_size != chunks[i].uncompressed_size) {
+        ld_error("Chunk %zu of snapshot has uncompressed size %u, but its "
+                 "zstd frame says %llu",
+                 i,
+                 chunks[i].uncompressed_size,
+                 frame_size);
+        err = E::BADMSG;
+        return -1;
+      }
+    }
+  }
+
+  state_out.resize(dst_off);
+  bool ok = forEachChunk(nchunks, [&](size_t i) {
+    const ChunkInfo& info = chunks[i];
+    const char* src = ptr + src_offsets[i];
+    char* dst = &state_out[0] + dst_offsets[i];
+    if (!compressed) {
+      memcpy(dst, src, info.size);
+      return true;
+    }
+    size_t rv = ZSTD_decompress(dst, info.uncompressed_size, src, info.size);
+    if (ZSTD_isError(rv)) {
+      RATELIMIT_ERROR(std::chrono::seconds(1),
+                      1,
+                      "ZSTD_decompress() failed for chunk %zu: %s",
+                      i,
+                      ZSTD_getErrorName(rv));
+      return false;
+    }
+    if (rv != info.uncompressed_size) {
+      RATELIMIT_ERROR(std::chrono::seconds(1),
+                      1,
+                      "Chunk %zu decompressed to %zu bytes, expected %u",
+                      i,
+                      rv,
+                      info.uncompressed_size);
+      return false;
+    }
+    return true;
+  });
+  if (!ok) {
+    err = E::BADMSG;
+    return -1;
+  }
+  return 0;
+}
+
+}} // namespace facebook::logdevice
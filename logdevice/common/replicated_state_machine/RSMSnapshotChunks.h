@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <string>
+
+#include "logdevice/include/Record.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Encoding of the payload of a snapshot whose RSMSnapshotHeader has the
+ *       CHUNKED flag. The serialized state is split into chunks of a bounded
+ *       size that are compressed (if ZSTD_COMPRESSION is set) and decompressed
+ *       independently, on a small thread pool of their own. For snapshots of
+ *       hundreds of MB this takes most of the decompression cost off the
+ *       replay path of the state machine.
+ *
+ *       Every snapshot still holds the whole state and is stored and fetched
+ *       as one blob by RSMSnapshotStore.
+ *
+ *       Format:
+ *         uint32_t nchunks;
+ *         struct {
+ *           uint32_t uncompressed_size;
+ *           uint32_t size; // size of the chunk as stored
+ *         } chunks[nchunks];
+ *         followed by the chunks themselves, back to back.
+ *
+ *       Deserializing the state itself is left to the state machine, which
+ *       gets the chunks concatenated back into a single blob.
+ */
+
+class RSMSnapshotChunks {
+ public:
+  /**
+   * Splits @param state into chunks of at most @param chunk_size bytes and
+   * appends their encoding to @param out.
+   *
+   * @param compress  Whether to compress each chunk with ZSTD.
+   *
+   * @return 0 on success or -1 with err set to E::TOOBIG if @param state is
+   *         larger than MAX_STATE_SIZE, or E::INTERNAL if compression
+   *         failed.
+   */
+  static int encode(Payload state,
+                    size_t chunk_size,
+                    bool compress,
+                    std::string& out);
+
+  /**
+   * Decodes @param payload, as produced by encode(), into @param state_out.
+   *
+   * @param compressed  Whether the chunks are ZSTD-compressed.
+   *
+   * @return 0 on success or -1 with err set to E::BADMSG if the payload is
+   *         malformed, including if its chunks add up to more than
+   *         MAX_STATE_SIZE bytes. Sizes are checked before @param state_out
+   *         is allocated.
+   */
+  static int decode(Payload payload, bool compressed, std::string& state_out);
+
+  // Compression level used for each chunk, same as for unchunked snapshots.
+  static constexpr int ZSTD_LEVEL = 5;
+
+  // Largest state that can be encoded and decoded.
+  static constexpr size_t MAX_STATE_SIZE = 1ul << 32;
+};
+
+}} // namespace facebook::logdevice
@@ -57,6 +57,11 @@ struct RSMSnapshotHeader : public SerializableData {
   // payload.
   static const uint32_t ZSTD_COMPRESSION = 1 << 0; //=1
 
+  // If this flag is set, the snapshot payload is split into chunks that are
+  // compressed independently, see RSMSnapshotChunks. Readers that predate
+  // this flag can't read such snapshots.
+  static const uint32_t CHUNKED = 1 << 1; //=2
+
   /**
    * Deserialize a RSMSnapshotHeader from a payload.
    *
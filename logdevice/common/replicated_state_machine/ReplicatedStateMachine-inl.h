@@ -12,6 +12,7 @@
 #include "logdevice/common/SnapshotStoreTypes.h"
 #include "logdevice/common/Timestamp.h"
 #include "logdevice/common/TrimRequest.h"
+#include "logdevice/common/replicated_state_machine/RSMSnapshotChunks.h"
 #include "logdevice/common/replicated_state_machine/ReplicatedStateMachine-enum.h"
 #include "logdevice/common/replicated_state_machine/TrimRSMRequest.h"
 #include "logdevice/common/replicated_state_machine/logging.h"
@@ -391,9 +392,19 @@ int ReplicatedStateMachine<T, D>::deserializeSnapshot(
   ptr += header_sz;
 
   std::unique_ptr<uint8_t[]> buf_decompressed;
+  std::string buf_unchunked;
   Payload p(ptr, payload.size() - header_sz);
 
-  if (header_out.flags & RSMSnapshotHeader::ZSTD_COMPRESSION) {
+  if (header_out.flags & RSMSnapshotHeader::CHUNKED) {
+    const bool compressed =
+        header_out.flags & RSMSnapshotHeader::ZSTD_COMPRESSION;
+    if (RSMSnapshotChunks::decode(p, compressed, buf_unchunked) != 0) {
+      rsm_error(rsm_type_, "Failed to decode chunks of snapshot.");
+      err = E::BADMSG;
+      return -1;
+    }
+    p = Payload(buf_unchunked.data(), buf_unchunked.size());
+  } else if (header_out.flags & RSMSnapshotHeader::ZSTD_COMPRESSION) {
     size_t uncompressed_size = ZSTD_getDecompressedSize(p.data(), p.size());
     buf_decompressed = std::make_unique<uint8_t[]>(uncompressed_size);
     size_t rv = ZSTD_decompress(buf_decompressed.get(), // dst
@@ -1546,14 +1557,17 @@ Status ReplicatedStateMachine<T, D>::getSnapshotFromMemory(
     return E::STALE;
   }
 
-  snapshot_blob_out = createSnapshotPayload(*data_, version_);
+  snapshot_blob_out =
+      createSnapshotPayload(*data_, version_, getSnapshotChunkSize());
   version_out = version_;
   return E::OK;
 }
 
 template <typename T, typename D>
-std::string ReplicatedStateMachine<T, D>::createSnapshotPayload(const T& data,
-                                                                lsn_t version) {
+std::string
+ReplicatedStateMachine<T, D>::createSnapshotPayload(const T& data,
+                                                   lsn_t version,
+                                                   size_t chunk_size) {
   RSMSnapshotHeader header{
       /*format_version=*/RSMSnapshotHeader::CONTAINS_NODE_METADATA,
       /*flags=*/0,
@@ -1582,6 +1596,34 @@ std::string ReplicatedStateMachine<T, D>::createSnapshotPayload(const T& data,
     ld_check(rv == uncompressed_payload_size);
   }
 
+  if (chunk_size > 0) {
+    header.flags |= RSMSnapshotHeader::CHUNKED;
+    if (snapshot_compression_) {
+      header.flags |= RSMSnapshotHeader::ZSTD_COMPRESSION;
+    }
+
+    std::string chunked_buf;
+    chunked_buf.resize(header_sz);
+    auto rv = RSMSnapshotHeader::serialize(header, &chunked_buf[0], header_sz);
+    ld_check(rv == header_sz);
+
+    // Split the serialized state into chunks, compressing each of them if
+    // requested.
+    const Payload state(&buf[0] + header_sz, uncompressed_payload_size);
+    rv = RSMSnapshotChunks::encode(
+        state, chunk_size, snapshot_compression_, chunked_buf);
+    if (rv != 0) {
+      rsm_error(rsm_type_, "Failed to split snapshot into chunks");
+      ld_check(false);
+      return std::string();
+    }
+    rsm_debug(rsm_type_,
+              "buf size: unchunked:%lu, chunked:%lu",
+              buf.size(),
+              chunked_buf.size());
+    return chunked_buf;
+  }
+
   if (snapshot_compression_) {
     header.flags |= RSMSnapshotHeader::ZSTD_COMPRESSION;
 
@@ -1671,7 +1713,8 @@ void ReplicatedStateMachine<T, D>::snapshot(std::function<void(Status st)> cb) {
     return;
   }
 
-  std::string payload = createSnapshotPayload(*data_, version_);
+  std::string payload =
+      createSnapshotPayload(*data_, version_, getSnapshotChunkSize());
 
   // We'll capture these in the lambda below.
   const size_t byte_offset_at_time_of_snapshot = delta_log_byte_offset_;
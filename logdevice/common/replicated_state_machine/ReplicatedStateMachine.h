@@ -464,8 +464,11 @@ class ReplicatedStateMachine {
                                        std::string& snapshot_blob_out);
 
   // Create a payload for a snapshot. The payload includes `data` serialized as
-  // well as the version of that snapshot.
-  std::string createSnapshotPayload(const T& data, lsn_t version);
+  // well as the version of that snapshot. If `chunk_size` is non-zero, the
+  // serialized data is split into chunks of at most that many bytes, see
+  // RSMSnapshotChunks.
+  std::string
+  createSnapshotPayload(const T& data, lsn_t version, size_t chunk_size);
 
   // Some metadata included inside delta records.
   struct DeltaHeader {
@@ -647,6 +650,13 @@ class ReplicatedStateMachine {
   virtual bool canSnapshot() const = 0;
   virtual void onSnapshotCreated(Status st, size_t snapshotSize) = 0;
 
+  // If non-zero, snapshots are split into chunks of at most this many bytes
+  // that are compressed and decompressed in parallel. Readers that don't know
+  // about chunked snapshots can't read them.
+  virtual size_t getSnapshotChunkSize() const {
+    return 0;
+  }
+
   // Whether this node can perform trimming of delta log
   bool canTrim() const;
 
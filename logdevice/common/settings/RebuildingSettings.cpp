@@ -186,6 +186,42 @@ void RebuildingSettings::defineSettings(SettingEasyInit& init) {
        "default to avoid thrashing the cache.",
        SERVER,
        SettingsCategory::Rebuilding);
+  init("rebuilding-ingest-sst",
+       &ingest_sst,
+       "false",
+       nullptr,
+       "On recipients (LogsDB only), buffer rebuilt records per partition and "
+       "ingest each buffer into its partition as an SST file, instead of "
+       "writing the records through the memtable. A storage thread ingests the "
+       "buffers once they reach rebuilding-ingest-sst-buffer-size or are "
+       "rebuilding-ingest-sst-max-delay old. STOREs of buffered records are "
+       "only acknowledged after the ingestion, when the records are readable "
+       "and durable.",
+       SERVER,
+       SettingsCategory::Rebuilding);
+  init("rebuilding-ingest-sst-buffer-size",
+       &ingest_sst_buffer_size,
+       "64M",
+       parse_positive<size_t>(),
+       "With rebuilding-ingest-sst, size of the rebuilt records buffered for a "
+       "partition at which they are ingested as an SST file.",
+       SERVER,
+       SettingsCategory::Rebuilding);
+  init("rebuilding-ingest-sst-max-delay",
+       &ingest_sst_max_delay,
+       "1s",
+       [](std::chrono::milliseconds val) {
+         if (val.count() <= 0) {
+           throw boost::program_options::error(
+               "rebuilding-ingest-sst-max-delay must be positive");
+         }
+       },
+       "With rebuilding-ingest-sst, maximum time rebuilt records wait in a "
+       "buffer before it is ingested, even if it isn't full. Since STOREs of "
+       "buffered records are acknowledged after the ingestion, this adds to "
+       "their latency; larger values make for fewer and larger SST files.",
+       SERVER,
+       SettingsCategory::Rebuilding);
   init("rebuilding-read-only",
        &read_only,
        "none",
@@ -46,6 +46,9 @@ struct RebuildingSettings : public SettingsBundle {
   size_t max_record_bytes_in_flight;
   bool use_rocksdb_cache;
   RebuildingReadOnlyOption read_only;
+  bool ingest_sst;
+  size_t ingest_sst_buffer_size;
+  std::chrono::milliseconds ingest_sst_max_delay;
   size_t max_get_seq_state_in_flight;
   chrono_interval_t<std::chrono::milliseconds> retry_timeout;
   chrono_interval_t<std::chrono::milliseconds> store_timeout;
@@ -545,6 +545,18 @@ void Settings::defineSettings(SettingEasyInit& init) {
       "apply it to existing sockets, only to newly created ones",
       SERVER | CLIENT,
       SettingsCategory::Network);
+  init("socket-zero-copy-threshold",
+       &socket_zero_copy_threshold,
+       "0",
+       parse_nonnegative<size_t>(),
+       "If positive, messages referencing a payload of at least this many "
+       "bytes are sent with MSG_ZEROCOPY on plaintext connections, which "
+       "saves copying the payload into the kernel at the cost of tracking "
+       "completions. Only worth it for large payloads. Changes take effect "
+       "for subsequent messages, including on existing sockets. 0 to "
+       "disable.",
+       SERVER | CLIENT,
+       SettingsCategory::Network);
   init(
       "nagle",
       &nagle,
@@ -686,6 +698,21 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "amount of RECORD data to read from local log store at once",
        SERVER,
        SettingsCategory::ReadPath);
+  init("max-read-streams-per-storage-task",
+       &max_read_streams_per_storage_task,
+       "1",
+       parse_positive<size_t>(),
+       "Maximum number of read streams of the same client whose blocking reads "
+       "from the same shard are batched into a single storage task. A client "
+       "only has one read storage task in flight at a time, so with many "
+       "streams that need to read from disk, e.g. tailing readers woken up by "
+       "a release, batching saves a storage thread round trip per stream. "
+       "It only saves round trips: each read still seeks its own iterator, "
+       "and only streams of the same log may share one. The reads of a batch "
+       "share output-max-records-kb, each getting what the reads before it "
+       "left over. 1 disables batching.",
+       SERVER,
+       SettingsCategory::ReadPath);
   init("max-record-read-execution-time",
        &max_record_read_execution_time,
        "1s",
@@ -761,6 +788,18 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "and we log it",
        SERVER | CLIENT,
        SettingsCategory::Monitoring);
+  init("append-stage-latency-sample-rate",
+       &append_stage_latency_sample_rate,
+       "0.01",
+       validate_range<double>(0, 1.0),
+       "Fraction of appends for which the sequencer records how long each "
+       "stage of the append took (admission into the sequencer window, "
+       "sending STOREs, replication, release). Storage nodes time the STOREs "
+       "of the sampled appends (queueing, writing, syncing and replying) and "
+       "report their stages back to the sequencer in STORED. Published as the "
+       "append_stage histograms. 0 to disable.",
+       SERVER,
+       SettingsCategory::Monitoring);
   init("flow-groups-run-yield-interval",
        &flow_groups_run_yield_interval,
        "2ms",
@@ -839,6 +878,26 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "size of the record cache.",
        SERVER,
        SettingsCategory::Recovery);
+  init("persist-record-caches-to-file",
+       &persist_record_caches_to_file,
+       "false",
+       nullptr, // no validation
+       "Persist record caches to a memory-mapped file in the directory of "
+       "each shard instead of the local log store. Caches are appended to the "
+       "file in the background as they change, so that little is left to "
+       "write on shutdown, and are only read after a restart when their log "
+       "is first accessed.",
+       SERVER | REQUIRES_RESTART /* used in LogStorageStateMap::setProcessor */,
+       SettingsCategory::Recovery);
+  init("record-cache-persist-interval",
+       &record_cache_persist_interval,
+       "30s",
+       validate_positive<ssize_t>(),
+       "With --persist-record-caches-to-file, how often record caches that "
+       "changed are appended to the file, if they have not changed for that "
+       "long since.",
+       SERVER,
+       SettingsCategory::Recovery);
 
   init("abort-on-failed-check",
        &abort_on_failed_check,
@@ -1121,6 +1180,18 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "never send a wave of STORE messages through a chain",
        SERVER,
        SettingsCategory::WritePath);
+  init("store-batch-max-bytes",
+       &store_batch_max_bytes,
+       "0",
+       parse_nonnegative<size_t>(),
+       "If positive, STORE messages a worker sends to the same storage node "
+       "within one event loop iteration are packed into a single STORE_BATCH "
+       "message of up to approximately this many bytes, and storage nodes "
+       "reply with STORED_BATCH messages in the same way. STOREs with larger "
+       "payloads are sent on their own. Only used with peers that support "
+       "the batch messages. 0 to disable.",
+       SERVER,
+       SettingsCategory::WritePath);
   init("sbr-low-watermark-check-interval",
        &sbr_low_watermark_check_interval,
        "60s",
@@ -1332,6 +1403,36 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "unless write-batch-size is reached first",
        SERVER,
        SettingsCategory::Storage);
+  init("write-group-commit",
+       &write_group_commit,
+       "false",
+       nullptr,
+       "If true, storage threads of a shard combine their write batches into "
+       "commit groups: the first thread to arrive becomes the group leader, "
+       "waits a short adaptive window for other threads to join, then does "
+       "one write and at most one WAL sync for the whole group. Sync writes "
+       "are acknowledged as soon as the group's WAL sync completes, without "
+       "going through the syncing thread.",
+       SERVER,
+       SettingsCategory::Storage);
+  init("write-group-commit-latency-budget",
+       &write_group_commit_latency_budget,
+       "2ms",
+       validate_positive<ssize_t>(),
+       "With --write-group-commit, the target for the p99 of the time a "
+       "commit group spends waiting for members plus writing and syncing. The "
+       "group wait window shrinks as observed write and sync latency grows.",
+       SERVER,
+       SettingsCategory::Storage);
+  init("write-group-commit-max-ops",
+       &write_group_commit_max_ops,
+       "1024",
+       parse_positive<ssize_t>(),
+       "With --write-group-commit, maximum number of write ops in one commit "
+       "group. A full group is written without waiting for the window to "
+       "expire.",
+       SERVER,
+       SettingsCategory::Storage);
   init("storage-tasks-use-drr",
        &storage_tasks_use_drr,
        "false",
@@ -1347,6 +1448,26 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "Use something like 1MB for byte based scheduling.",
        SERVER,
        SettingsCategory::Storage);
+  init("storage-tasks-work-stealing",
+       &storage_tasks_work_stealing,
+       "false",
+       nullptr,
+       "Give each storage thread its own lane of the storage task queue and "
+       "let idle threads steal tasks from other threads' lanes, instead of "
+       "having all threads of a type share one queue. Priorities are still "
+       "respected across lanes. Doesn't apply to slow threads if "
+       "--storage-tasks-use-drr is set.",
+       SERVER | REQUIRES_RESTART,
+       SettingsCategory::Storage);
+  init("storage-tasks-steal-across-shards",
+       &storage_tasks_steal_across_shards,
+       "false",
+       nullptr,
+       "If --storage-tasks-work-stealing is set, let idle slow storage "
+       "threads execute read storage tasks queued for other shards that live "
+       "on the same disk.",
+       SERVER | REQUIRES_RESTART,
+       SettingsCategory::Storage);
 
 #define STORAGE_TASK_PRINCIPAL(name, key, shareVal)                      \
   init("storage-task-" #key "-share",                                    \
@@ -1390,6 +1511,18 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "limit on the number of logs that can be in recovery at the same time",
        SERVER,
        SettingsCategory::Recovery);
+  init("seal-batch-max-logs",
+       &seal_batch_max_logs,
+       "0",
+       parse_nonnegative<size_t>(),
+       "If positive, SEAL messages that log recoveries on a worker send to the "
+       "same storage node within one event loop iteration are packed into "
+       "SEAL_BATCH messages of up to this many logs, which the storage node "
+       "seals with one write to its local log store. Speeds up recovery when "
+       "many sequencers are activated at once, e.g. after a sequencer node "
+       "fails. Only used with peers that support SEAL_BATCH. 0 to disable.",
+       SERVER,
+       SettingsCategory::Recovery);
   init("appender-buffer-queue-cap",
        &appender_buffer_queue_cap,
        "10000",
@@ -1447,6 +1580,26 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "window update messages (less means more often)",
        CLIENT | SERVER /* for event log reads */,
        SettingsCategory::ReadPath);
+  init("client-read-buffer-budget-records",
+       &client_read_buffer_budget_records,
+       "0",
+       parse_nonnegative<ssize_t>(),
+       "total number of records in the windows of all read streams of the "
+       "client. When this or --client-read-buffer-budget-bytes is set, read "
+       "streams start with a small window that grows while the application "
+       "keeps up and shrinks when the stream is idle, up to "
+       "--client-read-buffer-size records each. 0 means no limit",
+       CLIENT | REQUIRES_RESTART,
+       SettingsCategory::ReadPath);
+  init("client-read-buffer-budget-bytes",
+       &client_read_buffer_budget_bytes,
+       "0",
+       parse_nonnegative<ssize_t>(),
+       "total payload bytes buffered by all read streams of the client. When "
+       "exceeded, read streams halve their windows as they slide them. 0 "
+       "means no limit",
+       CLIENT | REQUIRES_RESTART,
+       SettingsCategory::ReadPath);
   init("client-epoch-metadata-cache-size",
        &client_epoch_metadata_cache_size,
        "50000",
@@ -1455,6 +1608,15 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "Set it to 0 to disable the epoch metadata cache.",
        CLIENT | REQUIRES_RESTART,
        SettingsCategory::ReadPath);
+  init("client-epoch-metadata-cache-max-bytes",
+       &client_epoch_metadata_cache_max_bytes,
+       "64M",
+       parse_nonnegative<ssize_t>(),
+       "upper bound on the estimated memory used by the client-side epoch "
+       "metadata cache, in addition to --client-epoch-metadata-cache-size. "
+       "0 means no limit.",
+       CLIENT | REQUIRES_RESTART,
+       SettingsCategory::ReadPath);
   init("client-readers-flow-tracer-period",
        &client_readers_flow_tracer_period,
        "0s",
@@ -2008,6 +2170,24 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "format to the parent znode",
        SERVER,
        SettingsCategory::EpochStore);
+  init("epoch-store-multi-op-max-logs",
+       &epoch_store_multi_op_max_logs,
+       "0",
+       nullptr, // no validation
+       "Maximum number of logs whose epoch store updates (e.g. epoch bumps "
+       "during bulk sequencer activation) are combined into a single "
+       "multi-op transaction. Updates issued while earlier transactions are "
+       "in flight are queued and sent together. 0 or 1 disables batching.",
+       SERVER,
+       SettingsCategory::EpochStore);
+  init("epoch-store-multi-op-max-in-flight",
+       &epoch_store_multi_op_max_in_flight,
+       "2",
+       parse_positive<size_t>(),
+       "Maximum number of multi-op epoch store transactions in flight at the "
+       "same time when --epoch-store-multi-op-max-logs is greater than 1.",
+       SERVER,
+       SettingsCategory::EpochStore);
   init("ssl-load-client-cert",
        &ssl_load_client_cert,
        "false",
@@ -2421,6 +2601,17 @@ void Settings::defineSettings(SettingEasyInit& init) {
       "benefit of batching and recompressing would be small.",
       SERVER,
       SettingsCategory::Batching);
+  init("sequencer-batching-zstd-dictionaries-dir",
+       &sequencer_batching_zstd_dictionaries_dir,
+       "",
+       nullptr, // no validation
+       "Directory to load ZSTD dictionaries from when sequencer batching (if "
+       "used) gets appends that a client's BufferedWriter compressed with a "
+       "dictionary the server doesn't know. The dictionary with ID N is read "
+       "from file N in this directory. If empty, such appends are rejected "
+       "with E::BADPAYLOAD.",
+       SERVER,
+       SettingsCategory::Batching);
   init("num-processor-background-threads",
        &num_processor_background_threads,
        "0",
@@ -3245,6 +3436,18 @@ void Settings::defineSettings(SettingEasyInit& init) {
        SERVER | EXPERIMENTAL,
        SettingsCategory::WritePath);
 
+  init("write-filterable-key-in-copyset-index",
+       &write_filterable_key_in_copyset_index,
+       "false",
+       nullptr,
+       "Store the filterable key of each record in its copyset index entry. "
+       "Read streams with a server-side filter then skip records whose key "
+       "doesn't match without reading them, if the copyset index is used. "
+       "Only enable once all storage nodes run a version that understands "
+       "the new entry format.",
+       SERVER | EXPERIMENTAL,
+       SettingsCategory::WritePath);
+
   init("epoch-metadata-use-new-storage-set-format",
        &epoch_metadata_use_new_storage_set_format,
        "false",
@@ -3419,6 +3622,17 @@ void Settings::defineSettings(SettingEasyInit& init) {
       SERVER | CLIENT | REQUIRES_RESTART,
       SettingsCategory::Core);
 
+  init("rsm-snapshot-chunk-size",
+       &rsm_snapshot_chunk_size,
+       "0",
+       parse_nonnegative<size_t>(),
+       "If positive, event log and logs config snapshots are split into "
+       "chunks of at most this many bytes that are compressed and "
+       "decompressed in parallel. Only enable once all clients and servers "
+       "can read chunked snapshots. 0 to write snapshots as a single blob.",
+       SERVER,
+       SettingsCategory::Core);
+
   init("rsm-snapshot-enable-dual-writes",
        &rsm_snapshot_enable_dual_writes,
        "true",
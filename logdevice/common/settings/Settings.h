@@ -179,6 +179,11 @@ struct Settings : public SettingsBundle {
   // If -1, system default will be used instead (setsockopt not called).
   int tcp_rcvbuf_kb;
 
+  // If positive, enable SO_ZEROCOPY on new plaintext TCP sockets and send
+  // batches that reference a payload of at least this many BYTES with
+  // MSG_ZEROCOPY instead of copying them into the kernel. 0 to disable.
+  size_t socket_zero_copy_threshold;
+
   // if true, enable Nagle's algorithm on all new TCP sockets. This should
   // increase the average packet size, but will increase latencies for many
   // workloads. If false (default), disable Nagle by calling
@@ -235,6 +240,11 @@ struct Settings : public SettingsBundle {
   // Similar to output_max_records_kb but is applied *before* filtering records.
   int64_t max_record_bytes_read_at_once;
 
+  // Maximum number of read streams of a client whose blocking reads from the
+  // same shard are issued as a single ReadStorageTask. 1 to issue a task per
+  // stream.
+  size_t max_read_streams_per_storage_task;
+
   // Maximum execution time for reading records
   std::chrono::milliseconds max_record_read_execution_time;
 
@@ -275,6 +285,10 @@ struct Settings : public SettingsBundle {
   // considered slow and we log it
   std::chrono::milliseconds slow_background_task_threshold;
 
+  // Fraction of appends whose latency is broken down by stage, sampled by
+  // sequencers, see AppendStageTimer.
+  double append_stage_latency_sample_rate;
+
   // The maximum number of incoming messages to read from an input evbuffer
   // of a Socket bufferevent before returning control to libevent.
   unsigned incoming_messages_max_per_socket;
@@ -340,6 +354,15 @@ struct Settings : public SettingsBundle {
   // size of the record cache
   std::chrono::seconds record_cache_monitor_interval;
 
+  // persist record caches to a memory-mapped file per shard, appended to in
+  // the background and read lazily after restart, instead of writing all of
+  // them to the local log store on shutdown
+  bool persist_record_caches_to_file;
+
+  // how often record caches that changed and then stayed unchanged for this
+  // long are appended to the record cache file
+  std::chrono::seconds record_cache_persist_interval;
+
   // When an ld_check() fails, call abort().  If not, just continue
   // executing.  We'll log either way.
   bool abort_on_failed_check;
@@ -418,6 +441,12 @@ struct Settings : public SettingsBundle {
   // chain.
   bool disable_chain_sending;
 
+  // If positive, STORE messages that Appenders send to the same storage node,
+  // and STORED replies sent to the same sequencer, within one event loop
+  // iteration are packed into STORE_BATCH/STORED_BATCH messages of up to this
+  // many bytes. See StoreBatcher.
+  size_t store_batch_max_bytes;
+
   // Time interval that a node health check probe is sent if there is
   // an outstanding probe from the same node in nodeset
   std::chrono::seconds node_health_check_retry_interval;
@@ -491,12 +520,33 @@ struct Settings : public SettingsBundle {
   //   unless write_batch_size is reached first.
   size_t write_batch_bytes;
 
+  // Storage threads of a shard combine their write batches into commit
+  // groups, with one LocalLogStore::writeMulti() and at most one WAL sync
+  // per group. See GroupCommitter.
+  bool write_group_commit;
+
+  // Target for the p99 of group formation wait plus group write and sync
+  // time. Commit groups wait for more writers only as long as this allows.
+  std::chrono::microseconds write_group_commit_latency_budget;
+
+  // Maximum number of write ops in a commit group.
+  size_t write_group_commit_max_ops;
+
   // SLOW threadpool storage tasks go through the DRR scheduler.
   bool storage_tasks_use_drr;
 
   // Quanta for the DRR scheduler.
   uint64_t storage_tasks_drr_quanta = 1;
 
+  // Give each storage thread its own task queue lane and let idle threads
+  // steal from other lanes. Ignored for SLOW threads if storage_tasks_use_drr
+  // is set.
+  bool storage_tasks_work_stealing;
+
+  // Let idle SLOW storage threads execute read tasks queued for other shards
+  // on the same disk. Requires storage_tasks_work_stealing.
+  bool storage_tasks_steal_across_shards;
+
   // Shares for StorageTask principals.
   std::array<StorageTaskShare, (uint64_t)StorageTaskPrincipal::NUM_PRINCIPALS>
       storage_task_shares;
@@ -540,6 +590,11 @@ struct Settings : public SettingsBundle {
   // metadata recoveries running.
   int concurrent_log_recoveries;
 
+  // If positive, SEALs sent by log recoveries on a worker to the same storage
+  // node within one event loop iteration are packed into SEAL_BATCH messages
+  // of up to this many logs. See SealBatcher.
+  size_t seal_batch_max_logs;
+
   // If true, purging will get the EpochRecoveryMetadata even if the epoch
   // is empty locally on the node
   bool get_erm_for_empty_epoch;
@@ -669,10 +724,23 @@ struct Settings : public SettingsBundle {
   // but also wire chatter.
   double client_read_flow_control_threshold;
 
+  // (client-only setting) Budget shared by all read streams of a client: the
+  // total number of records in their windows, and the total payload bytes
+  // they buffer. When either is non-zero, windows adapt to how fast each
+  // stream is consumed instead of being client_read_buffer_size records each.
+  // 0 means no limit.
+  size_t client_read_buffer_budget_records;
+  size_t client_read_buffer_budget_bytes;
+
   // (client-only setting) maximum number of epoch metadata entries cached in
   // the client. Set it to 0 to disable epoch metadata caching
   size_t client_epoch_metadata_cache_size;
 
+  // (client-only setting) upper bound on the estimated memory used by the
+  // client-side epoch metadata cache. 0 means only the number of entries is
+  // bounded.
+  size_t client_epoch_metadata_cache_max_bytes;
+
   // (client-only setting) Period for logging in logdevice_readers_flow scuba
   // table. Set it to 0 to disable feature.
   std::chrono::milliseconds client_readers_flow_tracer_period;
@@ -852,6 +920,15 @@ struct Settings : public SettingsBundle {
   // format to the parent znode.
   bool epoch_store_double_write_new_serialization_format;
 
+  // Maximum number of logs whose epoch store updates are combined into a
+  // single multi-op transaction. 0 or 1 means every log is written on its own.
+  size_t epoch_store_multi_op_max_logs;
+
+  // Maximum number of such multi-op transactions in flight at once. Updates
+  // that arrive while the limit is reached are queued and form the next
+  // transaction.
+  size_t epoch_store_multi_op_max_in_flight;
+
   // Maximum amount of memory that can be allocated by read storage tasks.
   size_t read_storage_tasks_max_mem_bytes;
 
@@ -1045,6 +1122,11 @@ struct Settings : public SettingsBundle {
   // batching and recompressing would be small.
   ssize_t sequencer_batching_passthru_threshold;
 
+  // Directory that sequencer batching reads ZSTD dictionaries it doesn't
+  // know from, one file per dictionary named after its ID. Needed to
+  // re-batch appends that clients compressed with a dictionary.
+  std::string sequencer_batching_zstd_dictionaries_dir;
+
   // Number of background threads.  Currently, background threads are used by
   // BufferedWriter to construct/compress large batches.  If 0 (the default),
   // use num_workers.
@@ -1390,6 +1472,10 @@ struct Settings : public SettingsBundle {
 
   // When set, serialize ShardIDs instead of node_index_t on disk.
   bool write_shard_id_in_copyset;
+  // When set, copyset index entries of new records carry the record's
+  // filterable key, so that server-side filtering can skip records without
+  // reading them.
+  bool write_filterable_key_in_copyset_index;
   // When set, new EpochMetaData is serialized using the new copyset
   // serialization format for Flexible Log Sharding.
   // TODO(T15517759): once all clusters are configured to use this option,
@@ -1416,6 +1502,7 @@ struct Settings : public SettingsBundle {
   bool rsm_include_read_pointer_in_snapshot;
   SnapshotStoreType rsm_snapshot_store_type;
   bool rsm_snapshot_enable_dual_writes;
+  size_t rsm_snapshot_chunk_size;
   std::chrono::milliseconds eventlog_snapshotting_period;
   std::chrono::milliseconds logsconfig_snapshotting_period;
 
@@ -870,19 +870,34 @@ std::string CompactHistogram::getUnitName() const {
   return units_ ? units_->at(0).name : "";
 }
 
-const CompactHistogram::Unit& CompactHistogram::pickUnit(int64_t value) const {
-  if (units_ == nullptr) {
-    static Unit u = {0l, ""};
+static const HistogramUnit& pickHistogramUnit(
+    const std::vector<HistogramUnit>* units,
+    int64_t value) {
+  if (units == nullptr) {
+    static HistogramUnit u = {0l, ""};
     return u;
   }
-  ld_check(!units_->empty());
+  ld_check(!units->empty());
 
   // Find the biggest unit smaller than value.
-  size_t idx = units_->size() - 1;
-  while (idx > 0 && (*units_)[idx].unit > value) {
+  size_t idx = units->size() - 1;
+  while (idx > 0 && (*units)[idx].unit > value) {
     --idx;
   }
-  return (*units_)[idx];
+  return (*units)[idx];
+}
+
+static const std::vector<HistogramUnit>* latencyUnits() {
+  static std::vector<HistogramUnit> units{{1l, "us"},
+                                          {1000l, "ms"},
+                                          {1000000l, "s"},
+                                          {60000000l, "min"},
+                                          {3600000000l, "hr"}};
+  return &units;
+}
+
+const CompactHistogram::Unit& CompactHistogram::pickUnit(int64_t value) const {
+  return pickHistogramUnit(units_, value);
 }
 
 std::string CompactHistogram::valueToString(int64_t value) const {
@@ -956,16 +971,7 @@ CompactHistogram& CompactHistogram::operator=(const CompactHistogram& rhs) {
 
 CompactLatencyHistogram::CompactLatencyHistogram(
     folly::Optional<PublishRange> publish_range)
-    : CompactHistogram(
-          [] {
-            static std::vector<Unit> units{{1l, "us"},
-                                           {1000l, "ms"},
-                                           {1000000l, "s"},
-                                           {60000000l, "min"},
-                                           {3600000000l, "hr"}};
-            return &units;
-          }(),
-          std::move(publish_range)) {}
+    : CompactHistogram(latencyUnits(), std::move(publish_range)) {}
 
 CompactSizeHistogram::CompactSizeHistogram()
     : CompactHistogram([] {
@@ -987,4 +993,327 @@ CompactNoUnitHistogram::CompactNoUnitHistogram()
                                        {1000000000000l, "T"}};
         return &units;
       }()) {}
+
+size_t HdrHistogram::bucketIndex(int64_t value) {
+  constexpr int64_t kSubBuckets = 1l << SUB_BUCKET_BITS;
+  if (value < kSubBuckets) {
+    return std::max(value, 0l);
+  }
+  // Position of the highest set bit, at least SUB_BUCKET_BITS.
+  int exp = folly::findLastSet(value) - 1;
+  if (exp >= MAX_VALUE_BITS) {
+    return NUM_BUCKETS - 1;
+  }
+  // value >> shift is in [kSubBuckets, 2 * kSubBuckets).
+  int shift = exp - SUB_BUCKET_BITS;
+  return (static_cast<size_t>(shift) << SUB_BUCKET_BITS) + (value >> shift);
+}
+
+int64_t HdrHistogram::bucketMin(size_t index) {
+  ld_check_lt(index, NUM_BUCKETS);
+  constexpr size_t kSubBuckets = 1ul << SUB_BUCKET_BITS;
+  if (index < 2 * kSubBuckets) {
+    return index;
+  }
+  int shift = (index >> SUB_BUCKET_BITS) - 1;
+  return static_cast<int64_t>(kSubBuckets + (index & (kSubBuckets - 1)))
+      << shift;
+}
+
+int64_t HdrHistogram::bucketWidth(size_t index) {
+  ld_check_lt(index, NUM_BUCKETS);
+  if (index < 2ul << SUB_BUCKET_BITS) {
+    return 1;
+  }
+  return 1l << ((index >> SUB_BUCKET_BITS) - 1);
+}
+
+void HdrHistogram::add(int64_t value) {
+  buckets_[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void HdrHistogram::clear() {
+  for (auto& b : buckets_) {
+    b.store(0, std::memory_order_relaxed);
+  }
+}
+
+void HdrHistogram::assign(const HistogramInterface& other_if) {
+  auto& other = checked_cref_cast<HdrHistogram>(other_if);
+  ld_check(units_ == other.units_);
+
+  for (size_t i = 0; i < buckets_.size(); ++i) {
+    buckets_[i].store(other.buckets_[i].load(std::memory_order_relaxed),
+                      std::memory_order_relaxed);
+  }
+  publish_range_ = other.publish_range_;
+}
+
+void HdrHistogram::merge(const HistogramInterface& other_if) {
+  auto& other = checked_cref_cast<HdrHistogram>(other_if);
+  ld_check(units_ == other.units_);
+
+  for (size_t i = 0; i < buckets_.size(); ++i) {
+    uint64_t x = other.buckets_[i].load(std::memory_order_relaxed);
+    // Most buckets are empty, don't bother writing them.
+    if (x != 0) {
+      buckets_[i].fetch_add(x, std::memory_order_relaxed);
+    }
+  }
+}
+
+void HdrHistogram::subtract(const HistogramInterface& other_if) {
+  auto& other = checked_cref_cast<HdrHistogram>(other_if);
+  ld_check(units_ == other.units_);
+
+  for (size_t i = 0; i < buckets_.size(); ++i) {
+    uint64_t x = other.buckets_[i].load(std::memory_order_relaxed);
+    if (x == 0) {
+      continue;
+    }
+    uint64_t prev = buckets_[i].fetch_sub(x, std::memory_order_relaxed);
+    if (!dd_assert(x <= prev,
+                   "Histogram subtraction overflowed. Bucket %lu, this: [%s] "
+                   "(half-updated), right operand: [%s]",
+                   i,
+                   toShortString().c_str(),
+                   other.toShortString().c_str())) {
+      buckets_[i].store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+void HdrHistogram::estimatePercentiles(const double* percentiles,
+                                       size_t npercentiles,
+                                       int64_t* samples_out,
+                                       uint64_t* count_out,
+                                       int64_t* sum_out) const {
+  // Make a local copy to avoid race conditions with concurrent add()s.
+  std::array<uint64_t, NUM_BUCKETS> buckets;
+  uint64_t count = 0;
+  int64_t sum = 0;
+  for (size_t i = 0; i < buckets_.size(); ++i) {
+    uint64_t x = buckets_[i].load(std::memory_order_relaxed);
+    if (x == 0) {
+      buckets[i] = 0;
+      continue;
+    }
+    if (!dd_assert(x <= std::numeric_limits<uint64_t>::max() - count,
+                   "Histogram total count overflowed: %s",
+                   toShortString().c_str())) {
+      // See CompactHistogram::estimatePercentiles().
+      x = 0;
+    }
+    count += x;
+    buckets[i] = x;
+    // Bucket centers; exact for the buckets of width 1.
+    sum += x * (bucketMin(i) + bucketWidth(i) / 2);
+  }
+  if (count_out) {
+    *count_out = count;
+  }
+  if (sum_out) {
+    *sum_out = sum;
+  }
+
+  if (npercentiles == 0) {
+    return;
+  }
+
+  ld_check(samples_out != nullptr);
+  ld_check(std::is_sorted(percentiles, percentiles + npercentiles));
+  ld_check(std::all_of(percentiles, percentiles + npercentiles, [](double p) {
+    return p >= 0.0 && p <= 1.0;
+  }));
+
+  if (count == 0) {
+    std::fill(samples_out, samples_out + npercentiles, 0l);
+    return;
+  }
+
+  size_t idx = 0;    // index in percentiles
+  uint64_t seen = 0; // count in buckets seen so far
+  for (size_t i = 0; i < buckets.size() && idx < npercentiles; ++i) {
+    uint64_t x = buckets[i];
+    if (x == 0) {
+      continue;
+    }
+    uint64_t next = seen + x;
+    ld_check_le(next, count);
+    int64_t width = bucketWidth(i);
+    while (idx < npercentiles &&
+           (percentiles[idx] * count <= next || next == count)) {
+      // Linearly interpolate inside the bucket.
+      double p = (percentiles[idx] * count - seen) / (next - seen);
+      samples_out[idx] = bucketMin(i) +
+          std::min(width - 1, static_cast<int64_t>(p * width));
+      ++idx;
+    }
+    seen = next;
+  }
+
+  ld_check(idx == npercentiles);
+}
+
+void HdrHistogram::print(std::ostream& out) const {
+  const std::array<std::pair<double, const char*>, 6> pct = {
+      {{.5, "p50"},
+       {.75, "p75"},
+       {.95, "p95"},
+       {.99, "p99"},
+       {.999, "p99.9"},
+       {.9999, "p99.99"}}};
+
+  uint64_t count = 0;
+  for (const auto& b : buckets_) {
+    count += b.load(std::memory_order_relaxed);
+  }
+
+  size_t idx = 0;    // in `pct`
+  uint64_t seen = 0; // count in buckets seen so far
+  for (size_t i = 0; i < buckets_.size(); ++i) {
+    uint64_t x = buckets_[i].load(std::memory_order_relaxed);
+    if (x == 0) {
+      continue;
+    }
+
+    int64_t min = bucketMin(i);
+    int64_t max = min + bucketWidth(i);
+    uint64_t next = seen + x;
+
+    const Unit& u = pickHistogramUnit(units_, min);
+    std::string label = folly::sformat(
+        "{:.3f}..{:.3f}{}", 1. * min / u.unit, 1. * max / u.unit, u.name);
+
+    std::string pct_str;
+    while (idx < pct.size() &&
+           (pct[idx].first * count <= next || next == count)) {
+      pct_str += " ";
+      pct_str += pct[idx].second;
+      ++idx;
+    }
+
+    out << std::setw(20) << std::right << label << std::setw(1) << " : "
+        << std::setw(10) << std::left << x << std::setw(1) << pct_str
+        << std::endl;
+
+    seen = next;
+  }
+}
+
+bool HdrHistogram::shouldPublishCumulativeFrequencyCounters() const {
+  return publish_range_.has_value() &&
+      publish_range_->to >= publish_range_->from &&
+      publish_range_->to <= MAX_VALUE_BITS;
+}
+
+HistogramInterface::CumulativeFrequencyCounters
+HdrHistogram::getCumulativeFrequencyCounters() const {
+  ld_check(shouldPublishCumulativeFrequencyCounters());
+
+  const size_t first_idx = std::max(publish_range_->from, 1ul);
+  const size_t last_idx = publish_range_->to;
+
+  CumulativeFrequencyCounters result;
+  auto& counters = result.counters;
+
+  // Powers of two are bucket boundaries, so the counts are the same as
+  // CompactHistogram's would be.
+  uint64_t acc = 0;
+  size_t bucket = buckets_.size();
+  for (size_t idx = last_idx + 1; idx-- > first_idx;) {
+    const int64_t value = 1l << (idx - 1);
+    const size_t first_bucket = bucketIndex(value);
+    while (bucket > first_bucket) {
+      acc += buckets_[--bucket].load(std::memory_order_relaxed);
+    }
+    counters.emplace_back(value, acc);
+  }
+
+  std::reverse(counters.begin(), counters.end());
+  return result;
+}
+
+std::string HdrHistogram::getUnitName() const {
+  return units_ ? units_->at(0).name : "";
+}
+
+std::string HdrHistogram::valueToString(int64_t value) const {
+  const Unit& u = pickHistogramUnit(units_, value);
+  return folly::sformat("{:.3f}{}", 1. * value / u.unit, u.name);
+}
+
+std::string HdrHistogram::toShortString() const {
+  std::stringstream ss;
+  bool first = true;
+  for (size_t i = 0; i < buckets_.size(); ++i) {
+    uint64_t x = buckets_[i].load(std::memory_order_relaxed);
+    if (x == 0) {
+      continue;
+    }
+    if (!first) {
+      ss << ",";
+    }
+    first = false;
+    ss << i << ":" << x;
+  }
+  return ss.str();
+}
+
+bool HdrHistogram::fromShortString(folly::StringPiece s) {
+  clear();
+  if (s.empty()) {
+    return true;
+  }
+
+  std::vector<folly::StringPiece> tokens;
+  folly::split(',', s, tokens);
+  if (tokens.size() > buckets_.size()) {
+    return false;
+  }
+
+  std::vector<size_t> seen_idxs;
+  for (folly::StringPiece tok : tokens) {
+    size_t idx;
+    uint64_t x;
+    try {
+      if (!folly::split(':', tok, idx, x)) {
+        return false;
+      }
+    } catch (std::range_error&) {
+      return false;
+    }
+    if (idx >= buckets_.size()) {
+      return false;
+    }
+
+    buckets_[idx].store(x, std::memory_order_relaxed);
+    seen_idxs.push_back(idx);
+  }
+
+  // Check for duplicate bucket indices.
+  std::sort(seen_idxs.begin(), seen_idxs.end());
+  if (std::unique(seen_idxs.begin(), seen_idxs.end()) != seen_idxs.end()) {
+    return false;
+  }
+
+  return true;
+}
+
+HdrHistogram::HdrHistogram(const std::vector<Unit>* units,
+                           folly::Optional<PublishRange> publish_range)
+    : publish_range_(std::move(publish_range)), units_(units) {}
+
+HdrHistogram::HdrHistogram(const HdrHistogram& rhs) : units_(rhs.units_) {
+  assign(rhs);
+}
+HdrHistogram& HdrHistogram::operator=(const HdrHistogram& rhs) {
+  assign(rhs);
+  return *this;
+}
+
+HdrLatencyHistogram::HdrLatencyHistogram(
+    folly::Optional<PublishRange> publish_range)
+    : HdrHistogram(latencyUnits(), std::move(publish_range)) {}
+
 }} // namespace facebook::logdevice
@@ -43,7 +43,10 @@ namespace facebook { namespace logdevice {
  * fewer buckets. Main caveat is that it's sometimes not responsive to small
  * changes in values, see comment starting with "IMPORTANT" below.
  *
- * Each of the two implementations has multiple subclasses for different units
+ * HdrHistogram is a log-linear variant of CompactHistogram with many more
+ * buckets, for the few histograms that need accurate tail percentiles.
+ *
+ * Each of the implementations has multiple subclasses for different units
  * of measurement. They define how the histograms are presented
  * (e.g. "1h" instead of "3600000000") and, for MultiScaleHistogram, what
  * the block boundaries are.
@@ -400,6 +403,14 @@ class NoUnitHistogram final : public MultiScaleHistogram {
   static const std::vector<Scale>* getScales();
 };
 
+// A unit of measurement for presenting values of CompactHistogram and
+// HdrHistogram.
+struct HistogramUnit {
+  // What value constitutes one of this unit. E.g. 1<<20 for "MiB".
+  int64_t unit;
+  const char* name;
+};
+
 // Simple histogram with 60 buckets corresponding to powers of two.
 // Just 60 uint64_t values, with memory_order_relaxed.
 // All methods are thread-safe, including the ones that HistogramInterface
@@ -465,11 +476,7 @@ class CompactHistogram : public HistogramInterface {
   CumulativeFrequencyCounters getCumulativeFrequencyCounters() const override;
 
  protected:
-  struct Unit {
-    // What value constitutes one of this unit. E.g. 1<<20 for "MiB".
-    int64_t unit;
-    const char* name;
-  };
+  using Unit = HistogramUnit;
 
   explicit CompactHistogram(
       const std::vector<Unit>* units,
@@ -502,4 +509,87 @@ class CompactNoUnitHistogram : public CompactHistogram {
   CompactNoUnitHistogram();
 };
 
+// Log-linear histogram in the style of HdrHistogram: each range of values
+// [2^e, 2^(e+1)) is split into 32 equal buckets, so percentile estimates are
+// within ~3% of the actual values at any scale, including the far tail
+// (p99.9, p99.99). Values below 64 are counted exactly.
+//
+// Like CompactHistogram, the buckets are relaxed atomics and all methods are
+// thread-safe: add() is a single lock-free increment, and merge() is
+// a bucket-wise sum. Merging histograms (e.g. per-worker ones in
+// StatsHolder::aggregate(), or ones from different nodes parsed with
+// fromShortString()) gives exactly the same percentiles as adding all the
+// values to one histogram.
+//
+// The price is size: 1600 buckets, 12.5 KB. Use it for the few histograms
+// that need accurate tail percentiles, e.g. append and read latencies.
+class HdrHistogram : public HistogramInterface {
+ public:
+  // Each power of two is split into 1 << SUB_BUCKET_BITS buckets.
+  static constexpr int SUB_BUCKET_BITS = 5;
+  // Values of 1 << MAX_VALUE_BITS and more are counted in the last bucket.
+  static constexpr int MAX_VALUE_BITS = 54;
+  static constexpr size_t NUM_BUCKETS = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1)
+      << SUB_BUCKET_BITS;
+
+  // Same as for CompactHistogram: publishes the number of values of at least
+  // 1 << (i - 1) for each i in [from, to].
+  using PublishRange = CompactHistogram::PublishRange;
+
+  // Must be the same subclass.
+  HdrHistogram(const HdrHistogram& rhs);
+  HdrHistogram& operator=(const HdrHistogram& rhs);
+
+  void add(int64_t value) override;
+  void clear() override;
+  void assign(const HistogramInterface& other) override;
+  void merge(const HistogramInterface& other) override;
+  void subtract(const HistogramInterface& other) override;
+  void estimatePercentiles(const double* percentiles,
+                           size_t npercentiles,
+                           int64_t* samples_out,
+                           uint64_t* count_out = nullptr,
+                           int64_t* sum_out = nullptr) const override;
+  void print(std::ostream& out) const override;
+
+  std::string getUnitName() const override;
+  std::string valueToString(int64_t value) const override;
+
+  // Same format as CompactHistogram::toShortString(), with indices of
+  // HdrHistogram buckets. E.g.: "3:1234,70:33,400:100".
+  std::string toShortString() const;
+
+  // Parses the histogram from a string in format produced by toShortString().
+  // If the string is not in the right format, returns false.
+  bool fromShortString(folly::StringPiece s);
+
+  bool shouldPublishCumulativeFrequencyCounters() const override;
+  CumulativeFrequencyCounters getCumulativeFrequencyCounters() const override;
+
+  // Index of the bucket `value` falls into.
+  static size_t bucketIndex(int64_t value);
+  // Smallest value of the bucket at `index`.
+  static int64_t bucketMin(size_t index);
+  // Number of distinct values in the bucket at `index`.
+  static int64_t bucketWidth(size_t index);
+
+ protected:
+  using Unit = HistogramUnit;
+
+  explicit HdrHistogram(
+      const std::vector<Unit>* units,
+      folly::Optional<PublishRange> publish_range = folly::none);
+
+ private:
+  folly::Optional<PublishRange> publish_range_;
+  std::array<std::atomic<uint64_t>, NUM_BUCKETS> buckets_{};
+  const std::vector<Unit>* units_ = nullptr;
+};
+
+class HdrLatencyHistogram : public HdrHistogram {
+ public:
+  HdrLatencyHistogram(
+      folly::Optional<PublishRange> publish_range = folly::none);
+};
+
 }} // namespace facebook::logdevice
@@ -0,0 +1,52 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/stats/LogGroupStatsIndex.h"
+
+#include "logdevice/common/checks.h"
+
+namespace facebook { namespace logdevice {
+
+LogGroupStatsIndex& LogGroupStatsIndex::instance() {
+  // Leaked on purpose: names handed out by getName() must outlive any static
+  // Stats objects that are destroyed at exit.
+  static LogGroupStatsIndex* index = new LogGroupStatsIndex();
+  return *index;
+}
+
+log_group_stats_idx_t
+LogGroupStatsIndex::getOrAssign(const std::string& log_group) {
+  {
+    auto state = state_.rlock();
+    auto it = state->ids.find(log_group);
+    if (it != state->ids.end()) {
+      return it->second;
+    }
+  }
+
+  auto state = state_.wlock();
+  auto res = state->ids.emplace(
+      log_group, static_cast<log_group_stats_idx_t>(state->names.size()));
+  if (res.second) {
+    ld_check(state->names.size() < LOG_GROUP_STATS_IDX_INVALID);
+    state->names.push_back(&res.first->first);
+  }
+  return res.first->second;
+}
+
+const std::string&
+LogGroupStatsIndex::getName(log_group_stats_idx_t idx) const {
+  auto state = state_.rlock();
+  ld_check(idx < state->names.size());
+  return *state->names[idx];
+}
+
+size_t LogGroupStatsIndex::size() const {
+  return state_.rlock()->names.size();
+}
+
+}} // namespace facebook::logdevice
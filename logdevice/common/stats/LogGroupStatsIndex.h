@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <folly/SharedMutex.h>
+#include <folly/Synchronized.h>
+#include <folly/container/F14Map.h>
+
+namespace facebook { namespace logdevice {
+
+/**
+ * Dense integer handle of a log group in per-log-group stats.
+ */
+using log_group_stats_idx_t = uint32_t;
+
+constexpr log_group_stats_idx_t LOG_GROUP_STATS_IDX_INVALID =
+    ~log_group_stats_idx_t(0);
+
+/**
+ * Process-wide mapping from fully qualified log group names to dense
+ * log_group_stats_idx_t handles. Per-log-group stats are stored in arrays
+ * indexed by these handles (see PerLogStatsSlots in Stats.h), so the string
+ * lookup only has to happen once per log group, not once per stat bump.
+ *
+ * Handles are assigned on first use and never reused, even if the log group
+ * is later removed or renamed. The number of distinct names is bounded by
+ * the number of log groups the process has ever seen in its config.
+ *
+ * Thread-safe.
+ */
+class LogGroupStatsIndex {
+ public:
+  static LogGroupStatsIndex& instance();
+
+  /**
+   * Returns the handle of the given log group, assigning a new one if this
+   * is the first time we see the name.
+   */
+  log_group_stats_idx_t getOrAssign(const std::string& log_group);
+
+  /**
+   * Returns the name of the log group with handle @param idx. The reference
+   * stays valid for the lifetime of the process. @param idx must have been
+   * returned by getOrAssign().
+   */
+  const std::string& getName(log_group_stats_idx_t idx) const;
+
+  /**
+   * Number of handles assigned so far.
+   */
+  size_t size() const;
+
+ private:
+  struct State {
+    // Node map so that keys have stable addresses that names can point to.
+    folly::F14NodeMap<std::string, log_group_stats_idx_t> ids;
+    std::vector<const std::string*> names;
+  };
+
+  folly::Synchronized<State, folly::SharedMutex> state_;
+};
+
+}} // namespace facebook::logdevice
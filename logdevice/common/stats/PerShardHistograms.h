@@ -10,6 +10,7 @@
 #include <cstddef>
 #include <vector>
 
+#include "logdevice/common/IOTraceContext.h"
 #include "logdevice/common/StorageTask-enums.h"
 #include "logdevice/common/stats/Histogram.h"
 #include "logdevice/common/stats/HistogramBundle.h"
@@ -72,6 +73,9 @@ struct PerShardHistograms : public PerShardHistogramBundle {
       {"queue_time." class_name,                                         \
        &storage_task_queue_time[static_cast<int>(StorageTaskType::name)]},
 #include "logdevice/common/storage_task_types.inc"
+#define IO_TRACE_CONTEXT(name, str) \
+  {"io_latency." str, &io_latency[static_cast<int>(IOTraceContext::name)]},
+#include "logdevice/common/io_trace_contexts.inc"
     };
   }
 
@@ -125,6 +129,9 @@ struct PerShardHistograms : public PerShardHistogramBundle {
   // Queueing latencies for storage threads (by storage thread type)
   compact_latency_histogram_t storage_threads_queue_time[static_cast<size_t>(
       StorageTaskThreadType::MAX)];
+  // Latencies of IO operations of the local log store, by what they were
+  // done for. See IOTracing.
+  latency_histogram_t io_latency[static_cast<size_t>(IOTraceContext::MAX)];
 };
 
 }} // namespace facebook::logdevice
@@ -9,6 +9,7 @@
 
 #include <array>
 
+#include "logdevice/common/AppendStage.h"
 #include "logdevice/common/RequestType.h"
 #include "logdevice/common/StorageTask-enums.h"
 #include "logdevice/common/protocol/MessageType.h"
@@ -66,12 +67,16 @@ struct ServerHistograms : public HistogramBundle {
   {"storage_task_response_duration." name,     \
    &storage_task_response_duration[int(StorageTaskType::type)]},
 #include "logdevice/common/storage_task_types.inc" // nolint
+#define APPEND_STAGE(name, str) \
+  {"append_stage." str, &append_stage_latency[int(AppendStage::name)]},
+#include "logdevice/common/append_stages.inc" // nolint
     };
   }
   // Latency of appends as seen by the sequencer
-  LatencyHistogram append_latency;
+  HdrLatencyHistogram append_latency;
 
-  LatencyHistogram write_to_read_latency;
+  // Time between a record being written and delivered to a reader.
+  HdrLatencyHistogram write_to_read_latency;
 
   LatencyHistogram store_bw_wait_latency;
 
@@ -144,6 +149,10 @@ struct ServerHistograms : public HistogramBundle {
       message_callback_duration;
   std::array<CompactLatencyHistogram, static_cast<int>(StorageTaskType::MAX)>
       storage_task_response_duration;
+
+  // Latency of each stage of sampled appends, see AppendStageTimer.
+  std::array<LatencyHistogram, static_cast<int>(AppendStage::MAX)>
+      append_stage_latency;
 };
 
 }} // namespace facebook::logdevice
@@ -117,6 +117,133 @@ void PerLogStats::aggregate(PerLogStats const& other,
 #include "logdevice/common/stats/per_log_stats.inc" // nolint
 }
 
+PerLogStatsSlots::~PerLogStatsSlots() {
+  freeAll();
+}
+
+void PerLogStatsSlots::freeAll() {
+  Directory* dir = dir_.exchange(nullptr, std::memory_order_relaxed);
+  if (dir == nullptr) {
+    return;
+  }
+  for (size_t c = 0; c < dir->capacity; ++c) {
+    delete dir->chunks[c].load(std::memory_order_relaxed);
+  }
+  delete dir;
+}
+
+PerLogStatsSlots::PerLogStatsSlots(PerLogStatsSlots&& other) noexcept {
+  dir_.store(other.dir_.exchange(nullptr, std::memory_order_relaxed),
+             std::memory_order_relaxed);
+}
+
+PerLogStatsSlots& PerLogStatsSlots::
+operator=(PerLogStatsSlots&& other) noexcept {
+  if (&other != this) {
+    freeAll();
+    dir_.store(other.dir_.exchange(nullptr, std::memory_order_relaxed),
+               std::memory_order_relaxed);
+  }
+  return *this;
+}
+
+PerLogStats* PerLogStatsSlots::getSlow(log_group_stats_idx_t idx) {
+  ld_check(idx != LOG_GROUP_STATS_IDX_INVALID);
+  const size_t chunk_idx = idx >> kChunkBits;
+  {
+    std::lock_guard<std::mutex> lock(alloc_mutex_);
+    Directory* dir = dir_.load(std::memory_order_relaxed);
+    if (dir == nullptr || chunk_idx >= dir->capacity) {
+      // Grow the directory geometrically so that the total size of retired
+      // directories stays within a constant factor of the current one.
+      size_t capacity = dir ? dir->capacity * 2 : 16;
+      while (capacity <= chunk_idx) {
+        capacity *= 2;
+      }
+      auto new_dir = std::make_unique<Directory>(capacity);
+      if (dir != nullptr) {
+        for (size_t c = 0; c < dir->capacity; ++c) {
+          new_dir->chunks[c].store(
+              dir->chunks[c].load(std::memory_order_relaxed),
+              std::memory_order_relaxed);
+        }
+        new_dir->prev.reset(dir);
+      }
+      dir = new_dir.release();
+      dir_.store(dir, std::memory_order_release);
+    }
+    if (dir->chunks[chunk_idx].load(std::memory_order_relaxed) == nullptr) {
+      dir->chunks[chunk_idx].store(new Chunk(), std::memory_order_release);
+    }
+  }
+  return get(idx);
+}
+
+void PerLogStatsSlots::activate(Chunk* chunk, size_t slot) {
+  std::lock_guard<std::mutex> guard(chunk->slots[slot].mutex);
+  chunk->active[slot].store(true, std::memory_order_release);
+}
+
+PerLogStats* PerLogStatsSlots::find(log_group_stats_idx_t idx) const {
+  Directory* dir = dir_.load(std::memory_order_acquire);
+  const size_t chunk_idx = idx >> kChunkBits;
+  if (dir == nullptr || chunk_idx >= dir->capacity) {
+    return nullptr;
+  }
+  Chunk* chunk = dir->chunks[chunk_idx].load(std::memory_order_acquire);
+  const size_t slot = idx & (kChunkSize - 1);
+  if (chunk == nullptr ||
+      !chunk->active[slot].load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+  return &chunk->slots[slot];
+}
+
+std::vector<std::pair<std::string, PerLogStats*>>
+PerLogStatsSlots::snapshot() const {
+  std::vector<std::pair<std::string, PerLogStats*>> res;
+  const LogGroupStatsIndex& index = LogGroupStatsIndex::instance();
+  forEach([&](log_group_stats_idx_t idx, PerLogStats& stats) {
+    res.emplace_back(index.getName(idx), &stats);
+  });
+  return res;
+}
+
+void PerLogStatsSlots::aggregate(PerLogStatsSlots const& other,
+                                 StatsAggOptional agg_override) {
+  other.forEach([&](log_group_stats_idx_t idx, PerLogStats& other_stats) {
+    get(idx)->aggregate(other_stats, agg_override);
+  });
+}
+
+void PerLogStatsSlots::reset() {
+  Directory* dir = dir_.load(std::memory_order_acquire);
+  if (dir == nullptr) {
+    return;
+  }
+  for (size_t c = 0; c < dir->capacity; ++c) {
+    Chunk* chunk = dir->chunks[c].load(std::memory_order_acquire);
+    if (chunk == nullptr) {
+      continue;
+    }
+    for (size_t i = 0; i < kChunkSize; ++i) {
+      if (!chunk->active[i].load(std::memory_order_acquire)) {
+        continue;
+      }
+      PerLogStats& stats = chunk->slots[i];
+      std::lock_guard<std::mutex> guard(stats.mutex);
+      // Deactivate first so that a writer that increments after the
+      // counters are zeroed reactivates the slot on its next get().
+      chunk->active[i].store(false, std::memory_order_release);
+#define STAT_DEFINE(name, _) stats.name = {};
+#include "logdevice/common/stats/per_log_stats.inc" // nolint
+#define TIME_SERIES_DEFINE(name, _, __, ___) stats.name.reset();
+#include "logdevice/common/stats/per_log_time_series.inc" // nolint
+      stats.custom_counters.reset();
+    }
+  }
+}
+
 void PerTrafficClassStats::aggregate(PerTrafficClassStats const& other,
                                      StatsAggOptional agg_override) {
 #define STAT_DEFINE(name, agg) \
@@ -468,22 +595,8 @@ void Stats::aggregateCompoundStats(Stats const& other,
         other.per_storage_task_type_stats[i], agg_override);
   }
 
-  // Aggregate per log stats. Use synchronizedCopy() to copy other's
-  // per_log_stats into temporary vector, to avoid holding a read lock on it
-  // while we aggregate.
-  this->per_log_stats.withWLock(
-      [&agg_override,
-       other_per_log_stats_entries = other.synchronizedCopy(
-           &Stats::per_log_stats)](auto& this_per_log_stats) {
-        for (const auto& kv : other_per_log_stats_entries) {
-          ld_check(kv.second != nullptr);
-          auto& stats_ptr = this_per_log_stats[kv.first];
-          if (stats_ptr == nullptr) {
-            stats_ptr = std::make_shared<PerLogStats>();
-          }
-          stats_ptr->aggregate(*kv.second, agg_override);
-        }
-      });
+  // Aggregate per log stats.
+  per_log_stats.aggregate(other.per_log_stats, agg_override);
 
   // Aggregate per worker stats. Also use synchronizedCopy()
   this->per_worker_stats.withWLock(
@@ -576,7 +689,7 @@ void Stats::reset() {
 
       per_worker_stats.wlock()->clear();
 
-      per_log_stats.wlock()->clear();
+      per_log_stats.reset();
       break;
     case StatsParams::StatsSet::LDBENCH_WORKER:
 #define STAT_DEFINE(name, _) ldbench->name = {};
@@ -849,9 +962,8 @@ void Stats::enumerate(EnumerationCallbacks* cb, bool list_all) const {
   }
   publishStorageTaskStats(StorageTaskType::UNKNOWN, unknown_stats);
 
-  // Per log. Use synchronizedCopy() to avoid holding a read lock during
-  // callbacks.
-  for (auto const& kv : synchronizedCopy(&Stats::per_log_stats)) {
+  // Per log.
+  for (auto const& kv : per_log_stats.snapshot()) {
     ld_check(kv.second != nullptr);
 #define STAT_DEFINE(name, _) cb->stat(#name, kv.first, kv.second->name);
 #include "logdevice/common/stats/per_log_stats.inc" // nolint
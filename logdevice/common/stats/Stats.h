@@ -18,6 +18,7 @@
 #include <vector>
 
 #include <folly/Conv.h>
+#include <folly/Likely.h>
 #include <folly/Optional.h>
 #include <folly/Synchronized.h>
 #include <folly/ThreadLocal.h>
@@ -31,6 +32,7 @@
 #include "logdevice/common/configuration/NodeLocation.h"
 #include "logdevice/common/configuration/TrafficClass.h"
 #include "logdevice/common/protocol/MessageType.h"
+#include "logdevice/common/stats/LogGroupStatsIndex.h"
 #include "logdevice/common/stats/StatsCounter.h"
 #include "logdevice/common/types_internal.h"
 #include "logdevice/common/util.h"
@@ -147,11 +149,153 @@ struct PerLogStats {
 #include "logdevice/common/stats/per_log_time_series.inc" // nolint
 
   std::shared_ptr<CustomCountersTimeSeries> custom_counters;
-  // Mutex almost exclusively locked by one thread since PerLogStats objects
-  // are contained in thread-local stats
+  // Protects the time series above. Almost exclusively locked by one thread
+  // since PerLogStats objects are contained in thread-local stats.
   std::mutex mutex;
 };
 
+/**
+ * PerLogStats of all log groups in a Stats object, indexed by the dense
+ * handles assigned by LogGroupStatsIndex.
+ *
+ * Slots are allocated in fixed-size chunks which are never moved or freed
+ * until the container is destroyed, so looking up a slot on the hot path is
+ * a couple of acquire loads with no locks, hashing or reference counting.
+ * Allocating a new chunk takes a mutex; it's uncontended in practice because
+ * each thread-local Stats object has a single writer. Readers (aggregation,
+ * admin commands) may iterate concurrently with writers.
+ */
+class PerLogStatsSlots {
+ public:
+  PerLogStatsSlots() {}
+  ~PerLogStatsSlots();
+
+  PerLogStatsSlots(const PerLogStatsSlots&) = delete;
+  PerLogStatsSlots& operator=(const PerLogStatsSlots&) = delete;
+
+  /**
+   * Not thread-safe, same as Stats' move constructor and move-assignment.
+   */
+  PerLogStatsSlots(PerLogStatsSlots&& other) noexcept;
+  PerLogStatsSlots& operator=(PerLogStatsSlots&& other) noexcept;
+
+  /**
+   * Returns the stats of log group @param idx, creating them if needed.
+   */
+  inline PerLogStats* get(log_group_stats_idx_t idx);
+
+  /**
+   * Returns the stats of log group @param idx if they were ever created
+   * since the last reset(), nullptr otherwise.
+   */
+  PerLogStats* find(log_group_stats_idx_t idx) const;
+
+  /**
+   * Calls @param f (log_group_stats_idx_t, PerLogStats&) for every log group
+   * that has stats.
+   */
+  template <typename F>
+  void forEach(F&& f) const;
+
+  /**
+   * Returns (log group name, stats) pairs for every log group that has
+   * stats. The pointers stay valid for the lifetime of this object.
+   */
+  std::vector<std::pair<std::string, PerLogStats*>> snapshot() const;
+
+  /**
+   * Add or subtract counters of all log groups in @param other.
+   */
+  void aggregate(PerLogStatsSlots const& other, StatsAggOptional agg_override);
+
+  /**
+   * Reset counters and drop time series of all log groups. Can be called
+   * concurrently with writers: each slot is reset under its mutex, which is
+   * also taken by the time series writers and by get() when it marks the
+   * slot as touched again. Counters are zeroed with the same relaxed atomic
+   * stores as the other stats, so an increment racing with reset() is
+   * either zeroed or kept, and in the latter case shows up once the writer
+   * touches the slot again.
+   */
+  void reset();
+
+ private:
+  static constexpr size_t kChunkBits = 6;
+  static constexpr size_t kChunkSize = size_t(1) << kChunkBits;
+
+  struct Chunk {
+    std::array<PerLogStats, kChunkSize> slots;
+    // Whether the slot was touched since the last reset(). Only changed
+    // under the slot's mutex.
+    std::array<std::atomic<bool>, kChunkSize> active{};
+  };
+
+  struct Directory {
+    explicit Directory(size_t cap)
+        : capacity(cap), chunks(new std::atomic<Chunk*>[cap]) {
+      for (size_t i = 0; i < cap; ++i) {
+        chunks[i].store(nullptr, std::memory_order_relaxed);
+      }
+    }
+
+    const size_t capacity;
+    std::unique_ptr<std::atomic<Chunk*>[]> chunks;
+    // The directory this one replaced when growing. Kept alive because
+    // concurrent readers may still be looking at it. Chunks are owned by the
+    // newest directory.
+    std::unique_ptr<Directory> prev;
+  };
+
+  // Allocates the chunk (and grows the directory) for @param idx.
+  PerLogStats* getSlow(log_group_stats_idx_t idx);
+
+  // Marks a slot as touched, synchronizing with reset() through the slot's
+  // mutex.
+  static void activate(Chunk* chunk, size_t slot);
+
+  // Frees all chunks and directories. Not thread-safe.
+  void freeAll();
+
+  std::atomic<Directory*> dir_{nullptr};
+  std::mutex alloc_mutex_;
+};
+
+PerLogStats* PerLogStatsSlots::get(log_group_stats_idx_t idx) {
+  Directory* dir = dir_.load(std::memory_order_acquire);
+  const size_t chunk_idx = idx >> kChunkBits;
+  if (LIKELY(dir != nullptr && chunk_idx < dir->capacity)) {
+    Chunk* chunk = dir->chunks[chunk_idx].load(std::memory_order_acquire);
+    if (LIKELY(chunk != nullptr)) {
+      const size_t slot = idx & (kChunkSize - 1);
+      if (UNLIKELY(!chunk->active[slot].load(std::memory_order_relaxed))) {
+        activate(chunk, slot);
+      }
+      return &chunk->slots[slot];
+    }
+  }
+  return getSlow(idx);
+}
+
+template <typename F>
+void PerLogStatsSlots::forEach(F&& f) const {
+  Directory* dir = dir_.load(std::memory_order_acquire);
+  if (dir == nullptr) {
+    return;
+  }
+  for (size_t c = 0; c < dir->capacity; ++c) {
+    Chunk* chunk = dir->chunks[c].load(std::memory_order_acquire);
+    if (chunk == nullptr) {
+      continue;
+    }
+    for (size_t i = 0; i < kChunkSize; ++i) {
+      if (chunk->active[i].load(std::memory_order_acquire)) {
+        f(static_cast<log_group_stats_idx_t>((c << kChunkBits) | i),
+          chunk->slots[i]);
+      }
+    }
+  }
+}
+
 struct PerTrafficClassStats {
   PerTrafficClassStats() {}
 
@@ -647,7 +791,7 @@ struct Stats final {
 
   /**
    * Take a read-lock and make a deep copy of a some map wrapped in a
-   * folly::Synchronized, such as per_log_stats.
+   * folly::Synchronized, such as per_worker_stats.
    */
   template <typename Map>
   auto synchronizedCopy(folly::Synchronized<Map> Stats::*map) const {
@@ -690,10 +834,8 @@ struct Stats final {
   std::array<PerStorageTaskTypeStats, static_cast<int>(StorageTaskType::MAX)>
       per_storage_task_type_stats = {};
 
-  // Per-log-group stats
-  folly::Synchronized<
-      std::unordered_map<std::string, std::shared_ptr<PerLogStats>>>
-      per_log_stats;
+  // Per-log-group stats, indexed by LogGroupStatsIndex handles
+  PerLogStatsSlots per_log_stats;
 
   // Server histograms. Initialized only on servers.
   std::unique_ptr<ServerHistograms> server_histograms;
@@ -1073,90 +1215,88 @@ class PerShardStatToken {
     }                                     \
   } while (0)
 
-#define LOG_GROUP_STAT_ADD(stats_struct, log_name, name, val)            \
-  do {                                                                   \
-    if (stats_struct) {                                                  \
-      auto stats_ulock = (stats_struct)->get().per_log_stats.ulock();    \
-      auto stats_it = stats_ulock->find((log_name));                     \
-      if (stats_it != stats_ulock->end()) {                              \
-        /* PerLogStats for log_name already exist (common case). */      \
-        /* Just atomically increment the value.  */                      \
-        stats_it->second->name += (val);                                 \
-      } else {                                                           \
-        /* PerLogStats for log_name do not exist yet (rare case). */     \
-        /* Upgrade ulock to wlock and emplace new PerLogStats. */        \
-        /* No risk of deadlock because we are the only writer thread. */ \
-        auto stats_ptr = std::make_shared<PerLogStats>();                \
-        stats_ptr->name += (val);                                        \
-        stats_ulock.moveFromUpgradeToWrite()->emplace_hint(              \
-            stats_it, (log_name), std::move(stats_ptr));                 \
-      }                                                                  \
-    }                                                                    \
+// Per-log-group stats. The *_IDX_* variants take a log_group_stats_idx_t
+// handle, usually cached on the LogsConfig entry (see
+// Configuration::getLogGroupStatsIdx()), and don't take any locks. The
+// variants taking a log group name resolve it through LogGroupStatsIndex
+// first, which costs a hash lookup under a shared lock.
+#define LOG_GROUP_IDX_STAT_ADD(stats_struct, log_idx, name, val)       \
+  do {                                                                 \
+    if (stats_struct) {                                                \
+      const log_group_stats_idx_t idx_hygienic = (log_idx);            \
+      if (idx_hygienic != LOG_GROUP_STATS_IDX_INVALID) {               \
+        (stats_struct)->get().per_log_stats.get(idx_hygienic)->name += \
+            (val);                                                     \
+      }                                                                \
+    }                                                                  \
+  } while (0)
+
+#define LOG_GROUP_IDX_TIME_SERIES_ADD(stats_struct, stat_name, log_idx, val)  \
+  do {                                                                        \
+    if (stats_struct) {                                                       \
+      const log_group_stats_idx_t idx_hygienic = (log_idx);                   \
+      if (idx_hygienic != LOG_GROUP_STATS_IDX_INVALID) {                      \
+        PerLogStats* log_stats_hygienic =                                     \
+            (stats_struct)->get().per_log_stats.get(idx_hygienic);            \
+        std::lock_guard<std::mutex> guard(log_stats_hygienic->mutex);         \
+        if (UNLIKELY(!log_stats_hygienic->stat_name)) {                       \
+          log_stats_hygienic->stat_name = std::make_shared<PerLogTimeSeries>( \
+              (stats_struct)->params_.get()->num_buckets_##stat_name,         \
+              (stats_struct)->params_.get()->time_intervals_##stat_name);     \
+        }                                                                     \
+        log_stats_hygienic->stat_name->addValue(val);                         \
+      }                                                                       \
+    }                                                                         \
+  } while (0)
+
+#define LOG_GROUP_IDX_CUSTOM_COUNTERS_ADD(stats_struct, log_idx, val) \
+  do {                                                                \
+    if (stats_struct) {                                               \
+      const log_group_stats_idx_t idx_hygienic = (log_idx);           \
+      if (idx_hygienic != LOG_GROUP_STATS_IDX_INVALID) {              \
+        PerLogStats* log_stats_hygienic =                             \
+            (stats_struct)->get().per_log_stats.get(idx_hygienic);    \
+        std::lock_guard<std::mutex> guard(log_stats_hygienic->mutex); \
+        if (UNLIKELY(!log_stats_hygienic->custom_counters)) {         \
+          log_stats_hygienic->custom_counters =                       \
+              std::make_shared<CustomCountersTimeSeries>();           \
+        }                                                             \
+        log_stats_hygienic->custom_counters->addCustomCounters(val);  \
+      }                                                               \
+    }                                                                 \
+  } while (0)
+
+// The name is only resolved if there are stats to add to.
+#define LOG_GROUP_STAT_ADD(stats_struct, log_name, name, val)     \
+  do {                                                            \
+    if (stats_struct) {                                           \
+      LOG_GROUP_IDX_STAT_ADD(                                     \
+          stats_struct,                                           \
+          LogGroupStatsIndex::instance().getOrAssign((log_name)), \
+          name,                                                   \
+          val);                                                   \
+    }                                                             \
   } while (0)
 
-#define LOG_GROUP_TIME_SERIES_ADD(stats_struct, stat_name, log_name, val)      \
-  do {                                                                         \
-    if (stats_struct) {                                                        \
-      auto stats_ulock = (stats_struct)->get().per_log_stats.ulock();          \
-      /* Unfortunately, the type of the lock after a downgrade from write to   \
-       * upgrade isn't the same as the type of upgrade lock initially acquired \
-       */                                                                      \
-      folly::LockedPtr<decltype(stats_ulock)::Synchronized,                    \
-                       folly::LockPolicyFromExclusiveToUpgrade>                \
-          stats_downgraded_ulock;                                              \
-      auto stats_it = stats_ulock->find((log_name));                           \
-      if (UNLIKELY(stats_it == stats_ulock->end())) {                          \
-        /* PerLogStats for log_name do not exist yet (rare case). */           \
-        /* Upgrade ulock to wlock and emplace new PerLogStats. */              \
-        /* No risk of deadlock because we are the only writer thread. */       \
-        auto stats_ptr = std::make_shared<PerLogStats>();                      \
-        auto stats_wlock = stats_ulock.moveFromUpgradeToWrite();               \
-        stats_it =                                                             \
-            stats_wlock->emplace((log_name), std::move(stats_ptr)).first;      \
-        stats_downgraded_ulock = stats_wlock.moveFromWriteToUpgrade();         \
-      }                                                                        \
-      {                                                                        \
-        std::lock_guard<std::mutex> guard(stats_it->second->mutex);            \
-        if (UNLIKELY(!stats_it->second->stat_name)) {                          \
-          stats_it->second->stat_name = std::make_shared<PerLogTimeSeries>(    \
-              (stats_struct)->params_.get()->num_buckets_##stat_name,          \
-              (stats_struct)->params_.get()->time_intervals_##stat_name);      \
-        }                                                                      \
-        stats_it->second->stat_name->addValue(val);                            \
-      }                                                                        \
-    }                                                                          \
+#define LOG_GROUP_TIME_SERIES_ADD(stats_struct, stat_name, log_name, val) \
+  do {                                                                    \
+    if (stats_struct) {                                                   \
+      LOG_GROUP_IDX_TIME_SERIES_ADD(                                      \
+          stats_struct,                                                   \
+          stat_name,                                                      \
+          LogGroupStatsIndex::instance().getOrAssign((log_name)),         \
+          val);                                                           \
+    }                                                                     \
   } while (0)
 
-#define LOG_GROUP_CUSTOM_COUNTERS_ADD(stats_struct, log_name, val)             \
-  do {                                                                         \
-    if (stats_struct) {                                                        \
-      auto stats_ulock = (stats_struct)->get().per_log_stats.ulock();          \
-      /* Unfortunately, the type of the lock after a downgrade from write to   \
-       * upgrade isn't the same as the type of upgrade lock initially acquired \
-       */                                                                      \
-      folly::LockedPtr<decltype(stats_ulock)::Synchronized,                    \
-                       folly::LockPolicyFromExclusiveToUpgrade>                \
-          stats_downgraded_ulock;                                              \
-      auto stats_it = stats_ulock->find((log_name));                           \
-      if (UNLIKELY(stats_it == stats_ulock->end())) {                          \
-        /* PerLogStats for log_name do not exist yet (rare case). */           \
-        /* Upgrade ulock to wlock and emplace new PerLogStats. */              \
-        /* No risk of deadlock because we are the only writer thread. */       \
-        auto stats_ptr = std::make_shared<PerLogStats>();                      \
-        auto stats_wlock = stats_ulock.moveFromUpgradeToWrite();               \
-        stats_it =                                                             \
-            stats_wlock->emplace((log_name), std::move(stats_ptr)).first;      \
-        stats_downgraded_ulock = stats_wlock.moveFromWriteToUpgrade();         \
-      }                                                                        \
-      {                                                                        \
-        std::lock_guard<std::mutex> guard(stats_it->second->mutex);            \
-        if (UNLIKELY(!stats_it->second->custom_counters)) {                    \
-          stats_it->second->custom_counters =                                  \
-              std::make_shared<CustomCountersTimeSeries>();                    \
-        }                                                                      \
-        stats_it->second->custom_counters->addCustomCounters(val);             \
-      }                                                                        \
-    }                                                                          \
+#define LOG_GROUP_CUSTOM_COUNTERS_ADD(stats_struct, log_name, val) \
+  do {                                                             \
+    if (stats_struct) {                                            \
+      LOG_GROUP_IDX_CUSTOM_COUNTERS_ADD(                           \
+          stats_struct,                                            \
+          LogGroupStatsIndex::instance().getOrAssign((log_name)),  \
+          val);                                                    \
+    }                                                              \
   } while (0)
 
 #define TRAFFIC_CLASS_STAT_ADD(stats_struct, traffic_class, name, val) \
@@ -0,0 +1,76 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/AppendStageTimer.h"
+
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+using namespace facebook::logdevice;
+using namespace std::literals::chrono_literals;
+
+TEST(AppendStageTimerTest, NotSampled) {
+  AppendStageTimer timer;
+  EXPECT_FALSE(timer.sampled());
+
+  timer.start(0, std::chrono::steady_clock::now() - 1s);
+  EXPECT_FALSE(timer.sampled());
+  timer.end(AppendStage::STORAGE_ADMISSION, nullptr);
+  EXPECT_EQ(0, timer.getDurationUsec(AppendStage::STORAGE_ADMISSION));
+  EXPECT_EQ(StorageStageDurations{}, timer.getStorageStageDurations());
+}
+
+TEST(AppendStageTimerTest, StagesRecordedOnce) {
+  AppendStageTimer timer;
+  timer.start(1.0, std::chrono::steady_clock::now() - 100ms);
+  ASSERT_TRUE(timer.sampled());
+
+  // The first stage starts at the given start time.
+  timer.end(AppendStage::SEQUENCER_WINDOW, nullptr);
+  const uint32_t window_usec =
+      timer.getDurationUsec(AppendStage::SEQUENCER_WINDOW);
+  EXPECT_GE(window_usec, 100000);
+
+  // Ending it again, e.g. for a later wave, doesn't change it.
+  timer.end(AppendStage::SEQUENCER_WINDOW, nullptr);
+  EXPECT_EQ(window_usec, timer.getDurationUsec(AppendStage::SEQUENCER_WINDOW));
+
+  // The next stage starts where the previous one ended.
+  timer.end(AppendStage::STORE_SEND, nullptr);
+  EXPECT_LT(timer.getDurationUsec(AppendStage::STORE_SEND), 100000);
+  EXPECT_EQ(0, timer.getDurationUsec(AppendStage::REPLICATION));
+}
+
+TEST(AppendStageTimerTest, StorageStageDurations) {
+  AppendStageTimer timer;
+  timer.start(1.0, std::chrono::steady_clock::now() - 100ms);
+  timer.end(AppendStage::STORAGE_ADMISSION, nullptr);
+  timer.end(AppendStage::STORAGE_QUEUE, nullptr);
+  timer.end(AppendStage::LOCAL_WRITE, nullptr);
+  // Not reported to the sequencer.
+  timer.end(AppendStage::STORED_REPLY, nullptr);
+
+  StorageStageDurations stages = timer.getStorageStageDurations();
+  ASSERT_EQ(4, stages.size());
+  EXPECT_EQ(timer.getDurationUsec(AppendStage::STORAGE_ADMISSION), stages[0]);
+  EXPECT_GE(stages[0], 100000);
+  EXPECT_EQ(timer.getDurationUsec(AppendStage::STORAGE_QUEUE), stages[1]);
+  EXPECT_EQ(timer.getDurationUsec(AppendStage::LOCAL_WRITE), stages[2]);
+  // The write didn't need a sync.
+  EXPECT_EQ(0, stages[3]);
+
+  // Starting again forgets the previous durations.
+  timer.start(1.0, std::chrono::steady_clock::now());
+  EXPECT_EQ(StorageStageDurations{}, timer.getStorageStageDurations());
+}
+
+TEST(AppendStageTimerTest, ToString) {
+  EXPECT_EQ("storage_admission=12us storage_queue=40us local_write=85us "
+            "sync=0us",
+            toString(StorageStageDurations{12, 40, 85, 0}));
+}
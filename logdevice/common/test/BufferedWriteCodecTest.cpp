@@ -8,14 +8,24 @@
 
 #include "logdevice/common/buffered_writer/BufferedWriteCodec.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
 #include <unordered_map>
 #include <variant>
 
 #include <folly/Overload.h>
+#include <folly/ScopeGuard.h>
 #include <folly/Varint.h>
+#include <folly/synchronization/Baton.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include "logdevice/common/buffered_writer/ZstdDictionaries.h"
+#include "logdevice/common/test/TestUtil.h"
+#include "logdevice/include/Err.h"
+
 namespace facebook { namespace logdevice {
 
 namespace {
@@ -283,6 +293,274 @@ TEST(BufferedWriteEstimatorTest, FormatChange) {
   EXPECT_EQ(estimator.getFormat(), BufferedWriteCodec::Format::PAYLOAD_GROUPS);
 }
 
+namespace {
+// Small, similar payloads, like the serialized structs that benefit from
+// dictionary compression.
+std::string makeStructPayload(int i) {
+  return "{\"user_id\": " + std::to_string(i * 7919) +
+      ", \"event\": \"page_view\", \"country\": \"" +
+      (i % 2 ? "US" : "GB") + "\", \"session\": " + std::to_string(i % 97) +
+      ", \"client\": \"web\"}";
+}
+
+folly::IOBuf encodeSinglePayloads(const std::vector<std::string>& payloads,
+                                  Compression compression,
+                                  uint32_t zstd_dictionary_id) {
+  const auto payload_variants = convert(payloads);
+  const size_t size = estimate(payload_variants).calculateSize(0);
+  BufferedWriteCodec::Encoder<BufferedWriteSinglePayloadsCodec::Encoder>
+      encoder(0, payloads.size(), size);
+  for (const auto& payload : payloads) {
+    encoder.append(
+        folly::IOBuf::wrapBufferAsValue(payload.data(), payload.size()));
+  }
+  folly::IOBufQueue queue;
+  encoder.encode(queue, compression, /* zstd_level */ 5, zstd_dictionary_id);
+  auto encoded = queue.moveAsValue();
+  encoded.coalesce();
+  return encoded;
+}
+
+std::vector<std::string> decodeSinglePayloads(const folly::IOBuf& encoded) {
+  std::vector<folly::IOBuf> decoded;
+  size_t consumed =
+      BufferedWriteCodec::decode(Slice(encoded.data(), encoded.length()),
+                                 decoded,
+                                 /* allow_buffer_sharing */ false);
+  EXPECT_EQ(encoded.length(), consumed);
+  std::vector<std::string> result;
+  for (auto& payload : decoded) {
+    result.push_back(payload.moveToFbString().toStdString());
+  }
+  return result;
+}
+} // namespace
+
+TEST(BufferedWriteCodecTest, ZstdDictionary) {
+  ZstdDictionaries::instance().clear();
+  SCOPE_EXIT {
+    ZstdDictionaries::instance().clear();
+  };
+
+  ZstdDictionaryTrainer trainer(1000);
+  for (int i = 0; i < 5000; ++i) {
+    const std::string payload = makeStructPayload(i);
+    trainer.addSample(Slice(payload.data(), payload.size()));
+  }
+  EXPECT_EQ(5000, trainer.numSeen());
+  EXPECT_EQ(1000, trainer.samples().size());
+  std::string dictionary = trainer.train(4096);
+  ASSERT_FALSE(dictionary.empty());
+  ASSERT_EQ(0, ZstdDictionaries::instance().add(7, dictionary));
+  // Re-adding the same dictionary is fine, changing it is not.
+  EXPECT_EQ(0, ZstdDictionaries::instance().add(7, dictionary));
+  EXPECT_EQ(-1, ZstdDictionaries::instance().add(7, dictionary + "x"));
+  EXPECT_EQ(E::EXISTS, err);
+
+  std::vector<std::string> payloads;
+  for (int i = 10000; i < 10004; ++i) {
+    payloads.push_back(makeStructPayload(i));
+  }
+
+  auto with_dict = encodeSinglePayloads(payloads, Compression::ZSTD, 7);
+  auto without_dict = encodeSinglePayloads(payloads, Compression::ZSTD, 0);
+
+  BufferedWriteCodec::Format format;
+  ASSERT_TRUE(BufferedWriteCodec::decodeFormat(
+      Slice(with_dict.data(), with_dict.length()), &format));
+  EXPECT_EQ(BufferedWriteCodec::Format::SINGLE_PAYLOADS_ZSTD_DICT, format);
+  Compression compression;
+  ASSERT_TRUE(BufferedWriteCodec::decodeCompression(
+      Slice(with_dict.data(), with_dict.length()), &compression));
+  EXPECT_EQ(Compression::ZSTD, compression);
+  size_t batch_size;
+  ASSERT_TRUE(BufferedWriteCodec::decodeBatchSize(
+      Slice(with_dict.data(), with_dict.length()), &batch_size));
+  EXPECT_EQ(payloads.size(), batch_size);
+
+  // A few small payloads don't compress well on their own.
+  EXPECT_LT(with_dict.length(), without_dict.length());
+
+  EXPECT_EQ(payloads, decodeSinglePayloads(with_dict));
+  EXPECT_EQ(payloads, decodeSinglePayloads(without_dict));
+
+  // A reader that doesn't have the dictionary can't decode the batch until
+  // it fetches the dictionary.
+  ZstdDictionaries::instance().clear();
+  std::vector<folly::IOBuf> decoded;
+  EXPECT_EQ(0,
+            BufferedWriteCodec::decode(
+                Slice(with_dict.data(), with_dict.length()), decoded, false));
+  EXPECT_EQ(E::NOTFOUND, err);
+
+  // The fetcher is called in the background; decoding fails with AGAIN
+  // until it returns.
+  std::atomic<int> fetches{0};
+  folly::Baton<> fetch_allowed;
+  ZstdDictionaries::instance().setFetcher([&](uint32_t id) {
+    fetch_allowed.wait();
+    ++fetches;
+    return id == 7 ? dictionary : std::string();
+  });
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(0,
+              BufferedWriteCodec::decode(
+                  Slice(with_dict.data(), with_dict.length()), decoded, false));
+    EXPECT_EQ(E::AGAIN, err);
+  }
+  fetch_allowed.post();
+  wait_until([] { return ZstdDictionaries::instance().has(7); });
+  EXPECT_EQ(payloads, decodeSinglePayloads(with_dict));
+  EXPECT_EQ(payloads, decodeSinglePayloads(with_dict));
+  EXPECT_EQ(1, fetches.load());
+}
+
+TEST(BufferedWriteCodecTest, ZstdDictionaryFetchFailure) {
+  ZstdDictionaries::instance().clear();
+  SCOPE_EXIT {
+    ZstdDictionaries::instance().clear();
+  };
+
+  ZstdDictionaryTrainer trainer(1000);
+  for (int i = 0; i < 1000; ++i) {
+    const std::string payload = makeStructPayload(i);
+    trainer.addSample(Slice(payload.data(), payload.size()));
+  }
+  const std::string dictionary = trainer.train(4096);
+  ASSERT_FALSE(dictionary.empty());
+  ASSERT_EQ(0, ZstdDictionaries::instance().add(7, dictionary));
+  std::vector<std::string> payloads;
+  for (int i = 10000; i < 10004; ++i) {
+    payloads.push_back(makeStructPayload(i));
+  }
+  auto encoded = encodeSinglePayloads(payloads, Compression::ZSTD, 7);
+  const Slice blob(encoded.data(), encoded.length());
+  ZstdDictionaries::instance().clear();
+
+  // The dictionary can't be found at first. Once the fetch fails, decoding
+  // fails with NOTFOUND without fetching again until the TTL expires.
+  std::atomic<int> fetches{0};
+  std::atomic<bool> found{false};
+  const std::chrono::milliseconds ttl(200);
+  ZstdDictionaries::instance().setFetcher(
+      [&](uint32_t /*id*/) {
+        ++fetches;
+        return found.load() ? dictionary : std::string();
+      },
+      ttl);
+  std::vector<folly::IOBuf> decoded;
+  EXPECT_EQ(0, BufferedWriteCodec::decode(blob, decoded, false));
+  EXPECT_EQ(E::AGAIN, err);
+  wait_until([&] {
+    return BufferedWriteCodec::decode(blob, decoded, false) == 0 &&
+        err == E::NOTFOUND;
+  });
+  const auto failed_at = std::chrono::steady_clock::now();
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(0, BufferedWriteCodec::decode(blob, decoded, false));
+    if (std::chrono::steady_clock::now() < failed_at + ttl) {
+      EXPECT_EQ(E::NOTFOUND, err);
+    }
+  }
+  ZstdDictionaries::instance().prefetch(7);
+  if (std::chrono::steady_clock::now() < failed_at + ttl) {
+    EXPECT_EQ(1, fetches.load());
+  }
+
+  // After the TTL the dictionary is fetched again.
+  found.store(true);
+  /* sleep override */
+  std::this_thread::sleep_for(ttl);
+  wait_until([] {
+    ZstdDictionaries::instance().prefetch(7);
+    return ZstdDictionaries::instance().has(7);
+  });
+  EXPECT_LE(2, fetches.load());
+  EXPECT_EQ(payloads, decodeSinglePayloads(encoded));
+
+  // clear() forgets about fetches in progress, so that the next fetcher is
+  // called, and the result of the stale fetch is dropped.
+  ZstdDictionaries::instance().clear();
+  folly::Baton<> stale_fetch_allowed;
+  SCOPE_EXIT {
+    stale_fetch_allowed.post();
+  };
+  std::atomic<bool> stale_fetch_done{false};
+  ZstdDictionaries::instance().setFetcher([&](uint32_t /*id*/) {
+    stale_fetch_allowed.wait();
+    stale_fetch_done.store(true);
+    return std::string();
+  });
+  EXPECT_EQ(0, BufferedWriteCodec::decode(blob, decoded, false));
+  EXPECT_EQ(E::AGAIN, err);
+  ZstdDictionaries::instance().clear();
+  ZstdDictionaries::instance().setFetcher(
+      [&](uint32_t /*id*/) { return dictionary; });
+  EXPECT_EQ(0, BufferedWriteCodec::decode(blob, decoded, false));
+  EXPECT_EQ(E::AGAIN, err);
+  wait_until([] { return ZstdDictionaries::instance().has(7); });
+  stale_fetch_allowed.post();
+  wait_until([&] { return stale_fetch_done.load(); });
+  EXPECT_EQ(payloads, decodeSinglePayloads(encoded));
+}
+
+TEST(BufferedWriteCodecTest, UnknownZstdDictionary) {
+  ZstdDictionaries::instance().clear();
+
+  std::vector<std::string> payloads;
+  for (int i = 0; i < 20; ++i) {
+    payloads.push_back(makeStructPayload(i));
+  }
+  // Writer falls back to compressing without the dictionary.
+  auto encoded = encodeSinglePayloads(payloads, Compression::ZSTD, 42);
+  BufferedWriteCodec::Format format;
+  ASSERT_TRUE(BufferedWriteCodec::decodeFormat(
+      Slice(encoded.data(), encoded.length()), &format));
+  EXPECT_EQ(BufferedWriteCodec::Format::SINGLE_PAYLOADS, format);
+  EXPECT_EQ(payloads, decodeSinglePayloads(encoded));
+}
+
+// Batches read from the network can be split across several buffers. They
+// should be decoded without coalescing, and uncompressed payloads should
+// share the buffers of the chain.
+TEST(BufferedWriteCodecTest, DecodeChained) {
+  std::vector<std::string> payloads;
+  for (int i = 0; i < 50; ++i) {
+    payloads.push_back(makeStructPayload(i));
+  }
+
+  for (Compression compression :
+       {Compression::NONE, Compression::ZSTD, Compression::LZ4}) {
+    SCOPED_TRACE(compressionToString(compression));
+    const folly::IOBuf encoded =
+        encodeSinglePayloads(payloads, compression, 0);
+
+    // Split into buffers of 7 bytes so that the header and most payloads
+    // straddle buffer boundaries.
+    folly::IOBufQueue queue;
+    for (size_t off = 0; off < encoded.length(); off += 7) {
+      queue.append(folly::IOBuf::copyBuffer(
+          encoded.data() + off, std::min<size_t>(7, encoded.length() - off)));
+    }
+    const folly::IOBuf chain = queue.moveAsValue();
+    ASSERT_TRUE(chain.isChained());
+
+    std::vector<folly::IOBuf> decoded;
+    size_t consumed = BufferedWriteCodec::decode(
+        chain, decoded, /* allow_buffer_sharing */ false);
+    ASSERT_GT(consumed, 0);
+    ASSERT_EQ(payloads.size(), decoded.size());
+    for (size_t i = 0; i < payloads.size(); ++i) {
+      EXPECT_TRUE(decoded[i].isManaged());
+      if (compression == Compression::NONE) {
+        EXPECT_TRUE(decoded[i].isShared());
+      }
+      EXPECT_EQ(payloads[i],
+                decoded[i].cloneAsValue().moveToFbString().toStdString());
+    }
+  }
+}
+
 TEST_P(BufferedWriteCodecTest, EncodeDecodeMatch) {
   const auto& [checksum_bits, payloads_in] = GetParam();
 
@@ -294,6 +572,7 @@ TEST_P(BufferedWriteCodecTest, EncodeDecodeMatch) {
   folly::IOBuf encoded;
   switch (estimator.getFormat()) {
     case BufferedWriteCodec::Format::SINGLE_PAYLOADS:
+    case BufferedWriteCodec::Format::SINGLE_PAYLOADS_ZSTD_DICT:
       encoded = encode<BufferedWriteSinglePayloadsCodec::Encoder>(
           checksum_bits, size, payloads_in);
       break;
@@ -0,0 +1,93 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/client_read_stream/ClientReadStreamBufferBudget.h"
+
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace facebook::logdevice;
+using namespace std::chrono_literals;
+
+using Budget = ClientReadStreamBufferBudget;
+
+TEST(ClientReadStreamBufferBudgetTest, Records) {
+  Budget budget(100, 0);
+  budget.reserveRecords(16);
+  EXPECT_EQ(50, budget.acquireRecords(50));
+  EXPECT_EQ(66, budget.getRecords());
+  // only 34 records left
+  EXPECT_EQ(34, budget.acquireRecords(50));
+  EXPECT_EQ(0, budget.acquireRecords(1));
+  EXPECT_EQ(100, budget.getRecords());
+
+  // minimum windows are granted even past the budget
+  budget.reserveRecords(16);
+  EXPECT_EQ(116, budget.getRecords());
+  EXPECT_EQ(0, budget.acquireRecords(1));
+
+  budget.releaseRecords(36);
+  EXPECT_EQ(20, budget.acquireRecords(30));
+  EXPECT_EQ(100, budget.getRecords());
+}
+
+TEST(ClientReadStreamBufferBudgetTest, NoRecordLimit) {
+  Budget budget(0, 1000);
+  EXPECT_EQ(1000000, budget.acquireRecords(1000000));
+  EXPECT_EQ(1000000, budget.getRecords());
+}
+
+TEST(ClientReadStreamBufferBudgetTest, Bytes) {
+  Budget budget(0, 1000);
+  budget.addBytes(600);
+  EXPECT_FALSE(budget.overBytesBudget());
+  budget.addBytes(600);
+  EXPECT_TRUE(budget.overBytesBudget());
+  EXPECT_EQ(1200, budget.getBytes());
+  budget.addBytes(-300);
+  EXPECT_FALSE(budget.overBytesBudget());
+
+  Budget unlimited(100, 0);
+  unlimited.addBytes(1ll << 40);
+  EXPECT_FALSE(unlimited.overBytesBudget());
+}
+
+TEST(ClientReadStreamBufferBudgetTest, TargetWindowSize) {
+  // 1000 records/s: a second worth of records, but at most double the window
+  EXPECT_EQ(200, Budget::targetWindowSize(100, 512, 16, 1000, 1s));
+  EXPECT_EQ(150, Budget::targetWindowSize(100, 512, 16, 150, 1s));
+  EXPECT_EQ(300, Budget::targetWindowSize(200, 512, 16, 150, 500ms));
+  // never more than the buffer capacity
+  EXPECT_EQ(512, Budget::targetWindowSize(400, 512, 16, 100000, 1s));
+  // idle streams shrink to the minimum window
+  EXPECT_EQ(16, Budget::targetWindowSize(512, 512, 16, 358, 60s));
+  EXPECT_EQ(32, Budget::targetWindowSize(512, 512, 32, 0, 1s));
+  // unless the buffer is smaller than that
+  EXPECT_EQ(8, Budget::targetWindowSize(8, 8, 16, 0, 1s));
+  // elapsed time may be zero
+  EXPECT_EQ(32, Budget::targetWindowSize(16, 512, 16, 10, 0s));
+}
+
+TEST(ClientReadStreamBufferBudgetTest, Concurrent) {
+  Budget budget(1000, 0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < 10000; ++i) {
+        size_t granted = budget.acquireRecords(7);
+        EXPECT_LE(budget.getRecords(), 1000);
+        budget.releaseRecords(granted);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0, budget.getRecords());
+}
@@ -0,0 +1,382 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <folly/MapUtil.h>
+#include <folly/Optional.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "logdevice/common/ShardAuthoritativeStatusMap.h"
+#include "logdevice/common/client_read_stream/ClientReadStream.h"
+#include "logdevice/common/configuration/UpdateableConfig.h"
+#include "logdevice/common/event_log/EventLogRebuildingSet.h"
+#include "logdevice/common/settings/Settings.h"
+#include "logdevice/common/test/MockBackoffTimer.h"
+#include "logdevice/common/test/MockTimer.h"
+#include "logdevice/common/test/TestUtil.h"
+#include "logdevice/include/types.h"
+
+/**
+ * @file Harness for driving a ClientReadStream without a Worker: TestState
+ *       collects everything the read stream sends, and
+ *       MockClientReadStreamDependencies plays the rest of the client.
+ *       Used by ClientReadStreamTest and by benchmarks.
+ */
+
+namespace facebook { namespace logdevice {
+
+using ConnectionState = ClientReadStreamSenderState::ConnectionState;
+using PerShardStatusMap = std::unordered_map<ShardID, Status, ShardID::Hash>;
+using RecordSource = MetaDataLogReader::RecordSource;
+
+struct StartMessage {
+  ShardID dest;
+  lsn_t start_lsn;
+  lsn_t until_lsn;
+  lsn_t window_high;
+  filter_version_t filter_version;
+  bool scd_enabled;
+  SCDCopysetReordering scd_copyset_reordering;
+  small_shardset_t filtered_out;
+  ReadStreamAttributes attrs;
+
+  bool operator==(const StartMessage& other) const {
+    auto as_tuple = [](const StartMessage& m) {
+      return std::make_tuple(m.dest,
+                             m.start_lsn,
+                             m.until_lsn,
+                             m.window_high,
+                             m.filter_version,
+                             m.scd_enabled,
+                             std::unordered_set<ShardID, ShardID::Hash>{
+                                 m.filtered_out.begin(), m.filtered_out.end()},
+                             m.attrs);
+      // `scd_copyset_reordering' not considered as most tests don't care
+      // about it
+    };
+    return as_tuple(*this) == as_tuple(other);
+  }
+};
+
+struct WindowMessage {
+  ShardID dest;
+  lsn_t low;
+  lsn_t high;
+
+  bool operator==(const WindowMessage& other) const {
+    auto as_tuple = [](const WindowMessage& m) {
+      return std::tie(m.dest, m.low, m.high);
+    };
+    return as_tuple(*this) == as_tuple(other);
+  }
+};
+
+struct GapMessage {
+  GapType type;
+  lsn_t low;
+  lsn_t high;
+
+  bool operator==(const GapMessage& other) const {
+    auto as_tuple = [](const GapMessage& m) {
+      return std::tie(m.type, m.low, m.high);
+    };
+    return as_tuple(*this) == as_tuple(other);
+  }
+};
+
+inline ::std::ostream& operator<<(::std::ostream& os, const StartMessage& m) {
+  os << "{";
+  os << "dest: " << m.dest.toString() << ", ";
+  os << "start_lsn: " << lsn_to_string(m.start_lsn) << ", ";
+  os << "until_lsn: " << lsn_to_string(m.until_lsn) << ", ";
+  os << "window_high: " << lsn_to_string(m.window_high) << ", ";
+  os << "filter_version: " << m.filter_version.val_ << ", ";
+  os << "scd_enabled: " << m.scd_enabled << ", ";
+  os << "scd_copyset_reordering: " << static_cast<int>(m.scd_copyset_reordering)
+     << ", ";
+  os << "filtered_out: {";
+  for (ShardID shard : m.filtered_out) {
+    os << shard.toString() << ", ";
+  }
+  os << "}}";
+  return os;
+}
+
+inline ::std::ostream& operator<<(::std::ostream& os, const WindowMessage& m) {
+  os << "{";
+  os << "dest: " << m.dest.toString() << ", ";
+  os << "low: " << lsn_to_string(m.low) << ", ";
+  os << "high: " << lsn_to_string(m.high) << "}";
+  return os;
+}
+
+inline ::std::ostream& operator<<(::std::ostream& os, const GapMessage& m) {
+  os << "{";
+  os << "type: " << (int)m.type << ", ";
+  os << "low: " << lsn_to_string(m.low) << ", ";
+  os << "high: " << lsn_to_string(m.high) << "}";
+  return os;
+}
+
+const logid_t LOG_ID(1);
+
+struct CacheEntry {
+  epoch_t epoch;
+  epoch_t until;
+  RecordSource source;
+  EpochMetaData metadata;
+};
+
+struct TestState {
+  TestState()
+      : config(std::make_shared<UpdateableConfig>()),
+        settings(create_default_settings<Settings>()) {}
+  std::vector<ShardID> shards{ShardID(0, 0),
+                              ShardID(1, 0),
+                              ShardID(2, 0),
+                              ShardID(3, 0),
+                              ShardID(4, 0),
+                              ShardID(5, 0)};
+
+  // Outgoing messages from ClientReadStream go into these vectors
+  std::vector<lsn_t> recv;
+  std::vector<StartMessage> start;
+  std::vector<ShardID> stop;
+  std::vector<WindowMessage> window;
+  std::vector<GapMessage> gap;
+
+  std::unordered_map<ShardID, SocketCallback*, ShardID::Hash> on_close;
+  std::unordered_map<node_index_t, bool> cluster_state;
+  std::vector<epoch_t> metadata_req;
+  bool callbacks_accepting = true;
+  bool disposed = false;
+
+  // default metadata to be delivered when epoch metadata is requested
+  EpochMetaData default_metadata;
+  // If set, deps_->getMetaDataForEpoch() will be a no-op and tests are
+  // required to directly call onEpochMetaData() to simulate getting metadata
+  // in an asynchronous manner. This is used by tests that test nodeset related
+  // features.
+  // By default this is not set, and the function will deliver the default
+  // metadata (set by the test read stream) with until epoch set to
+  // lsn_to_epoch(LSN_MAX). The read stream should no longer request epoch
+  // metadata again. This is to allow all existing test items that do not test
+  // nodeset feature to pass.
+  bool disable_default_metadata = false;
+
+  std::shared_ptr<UpdateableConfig> config;
+  Settings settings;
+
+  // Map of error codes to be returned by sendStartMessage() for a given
+  // ShardID.
+  PerShardStatusMap send_start_errors;
+
+  // Protocol version overrides for sockets to servers
+  std::unordered_map<node_index_t, uint16_t> protos;
+
+  EventLogRebuildingSet rebuilding_set;
+
+  bool nodes_may_send_shard_status_update_message = true;
+
+  bool connection_healthy = true;
+
+  // last metadata request requires consistent entries from the cache
+  folly::Optional<bool> require_consistent_from_cache;
+
+  std::vector<CacheEntry> cache_entries_;
+
+  bool has_memory_pressure = false;
+  std::unordered_map<ShardID, ClientReadStreamSenderState, ShardID::Hash>*
+      storage_set_states;
+};
+
+/**
+ * Mock implementation of ClientReadStreamDependencies that captures all
+ * outgoing communication from ClientReadStream to allow inspection by tests.
+ */
+class MockClientReadStreamDependencies : public ClientReadStreamDependencies {
+ public:
+  explicit MockClientReadStreamDependencies(TestState* state) : state_(*state) {
+    ON_CALL(*this, recordCallback(::testing::_))
+        .WillByDefault(
+            ::testing::Invoke([&](std::unique_ptr<DataRecord>& record) {
+              return recordCallbackImpl(record);
+            }));
+  }
+
+  bool getMetaDataForEpoch(read_stream_id_t /*rsid*/,
+                           epoch_t epoch,
+                           MetaDataLogReader::Callback cb,
+                           bool /*allow_from_cache*/,
+                           bool require_consistent_from_cache) override {
+    state_.metadata_req.push_back(epoch);
+    state_.require_consistent_from_cache = require_consistent_from_cache;
+
+    if (state_.disable_default_metadata) {
+      // The test explicitly calls onEpochMetaData().
+      return false;
+    }
+
+    // otherwise, provide the default metadata and make it effective
+    // for all future epochs
+    ld_check(state_.default_metadata.isValid());
+    std::unique_ptr<EpochMetaData> metadata =
+        std::make_unique<EpochMetaData>(state_.default_metadata);
+
+    cb(E::OK,
+       MetaDataLogReader::Result{LOG_ID,
+                                 epoch,
+                                 lsn_to_epoch(LSN_MAX),
+                                 RecordSource::LAST,
+                                 compose_lsn(epoch_t(epoch), esn_t(1)),
+                                 std::chrono::milliseconds(0),
+                                 std::move(metadata)});
+    return true;
+  }
+
+  void
+  updateEpochMetaDataCache(epoch_t epoch,
+                           epoch_t until,
+                           const EpochMetaData& metadata,
+                           MetaDataLogReader::RecordSource source) override {
+    state_.cache_entries_.push_back(CacheEntry{epoch, until, source, metadata});
+  }
+
+  int sendStartMessage(ShardID shard,
+                       SocketCallback* onclose,
+                       START_Header header,
+                       const small_shardset_t& filtered_out,
+                       const ReadStreamAttributes* attrs) override {
+    // Check if the test wants to simulate failure to send START to that shard.
+    auto it = state_.send_start_errors.find(shard);
+    if (it != state_.send_start_errors.end()) {
+      err = it->second;
+      return -1;
+    }
+    ReadStreamAttributes reader_attrs =
+        attrs == nullptr ? ReadStreamAttributes() : (*attrs);
+    state_.start.push_back(
+        StartMessage{shard,
+                     lsn_t(header.start_lsn),
+                     lsn_t(header.until_lsn),
+                     lsn_t(header.window_high),
+                     header.filter_version,
+                     (bool)(header.flags & START_Header::SINGLE_COPY_DELIVERY),
+                     header.scd_copyset_reordering,
+                     filtered_out,
+                     reader_attrs});
+    state_.on_close[shard] = onclose;
+
+    return 0;
+  }
+
+  int sendStopMessage(ShardID shard) override {
+    state_.stop.push_back(shard);
+    return 0;
+  }
+
+  int sendWindowMessage(ShardID shard,
+                        lsn_t window_low,
+                        lsn_t window_high) override {
+    EXPECT_LE(window_low, window_high);
+    state_.window.push_back(WindowMessage{shard, window_low, window_high});
+    return 0;
+  }
+
+  MOCK_METHOD1(recordCallback, bool(std::unique_ptr<DataRecord>& record));
+  bool recordCallbackImpl(std::unique_ptr<DataRecord>& record) {
+    state_.recv.push_back(record->attrs.lsn);
+    return state_.callbacks_accepting;
+  }
+
+  bool gapCallback(const GapRecord& gap) override {
+    state_.gap.push_back(GapMessage{gap.type, gap.lo, gap.hi});
+    return state_.callbacks_accepting;
+  }
+
+  void healthCallback(bool is_healthy) override {
+    state_.connection_healthy = is_healthy;
+  }
+
+  MOCK_METHOD2(recordCopyCallback,
+               void(ShardID from, const RawDataRecord* record));
+
+  void dispose() override {
+    state_.disposed = true;
+  }
+
+  // Stub out timer functionality for now
+
+  std::unique_ptr<BackoffTimer>
+  createBackoffTimer(std::chrono::milliseconds,
+                     std::chrono::milliseconds) override {
+    return std::make_unique<MockBackoffTimer>();
+  }
+
+  std::unique_ptr<BackoffTimer> createBackoffTimer(
+      const chrono_expbackoff_t<std::chrono::milliseconds>&) override {
+    return std::make_unique<MockBackoffTimer>();
+  }
+
+  std::unique_ptr<Timer>
+  createTimer(std::function<void()> /*cb*/ = nullptr) override {
+    return std::make_unique<MockTimer>();
+  }
+
+  void setClientReadStream(ClientReadStream* client_read_stream) {
+    client_read_stream_ = client_read_stream;
+  }
+
+  std::function<ClientReadStream*(read_stream_id_t)>
+  getStreamByIDCallback() override {
+    ld_check(client_read_stream_);
+    return [=](read_stream_id_t /*rsid*/) { return client_read_stream_; };
+  }
+
+  const Settings& getSettings() const override {
+    return state_.settings;
+  }
+
+  std::shared_ptr<const configuration::nodes::NodesConfiguration>
+  getNodesConfiguration() const {
+    auto cfg = state_.config->get();
+    return cfg->getNodesConfiguration();
+  }
+
+  ShardAuthoritativeStatusMap getShardStatus() const override {
+    auto cfg = state_.config->get();
+    return state_.rebuilding_set.toShardStatusMap(*getNodesConfiguration());
+  }
+
+  void refreshClusterState() override {}
+
+  folly::Optional<uint16_t>
+  getSocketProtocolVersion(node_index_t nid) const override {
+    return folly::get_default(
+        state_.protos, nid, Compatibility::MAX_PROTOCOL_SUPPORTED);
+  }
+
+  bool hasMemoryPressure() const override {
+    return state_.has_memory_pressure;
+  }
+
+ private:
+  ClientReadStream* client_read_stream_ = nullptr;
+  TestState& state_;
+};
+
+}} // namespace facebook::logdevice
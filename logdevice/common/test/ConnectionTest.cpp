@@ -16,6 +16,7 @@
 #include "logdevice/common/network/MessageReader.h"
 #include "logdevice/common/protocol/CHECK_NODE_HEALTH_Message.h"
 #include "logdevice/common/protocol/GET_SEQ_STATE_Message.h"
+#include "logdevice/common/protocol/RECORD_Message.h"
 #include "logdevice/common/test/ConnectionTest_fixtures.h"
 #include "logdevice/common/test/NodesConfigurationTestUtil.h"
 
@@ -212,6 +213,22 @@ static Envelope* create_message(Connection& s) {
   return envelope;
 }
 
+static Envelope* create_record_message(Connection& s,
+                                       const folly::IOBuf& payload) {
+  RECORD_Header header{logid_t(42),
+                       read_stream_id_t(1),
+                       lsn_t(1),
+                       0 /* timestamp */,
+                       0 /* flags */,
+                       shard_index_t(0)};
+  auto msg =
+      std::make_unique<RECORD_Message>(header,
+                                       TrafficClass::READ_BACKLOG,
+                                       PayloadHolder(payload.cloneAsValue()),
+                                       nullptr);
+  return s.registerMessage(std::move(msg));
+}
+
 TEST_F(ClientConnectionTest, SerializationStages) {
   std::unique_ptr<folly::IOBuf> hello_buf;
   ON_CALL(*sock_, connect_(_, _, _, _, _))
@@ -336,6 +353,161 @@ TEST_F(ClientConnectionTest, ListenerKeepConnectionActive) {
   EXPECT_FALSE(usedSinceLastCheck());
 }
 
+// Small messages sent in the same batch are copied into a single buffer.
+TEST_F(ClientConnectionTest, SmallMessagesCoalesced) {
+  std::vector<std::unique_ptr<folly::IOBuf>> written;
+  std::vector<folly::WriteFlags> write_flags;
+  ON_CALL(*sock_, connect_(_, _, _, _, _))
+      .WillByDefault(SaveArg<0>(&conn_callback_));
+  ON_CALL(*sock_, good()).WillByDefault(Return(true));
+  ON_CALL(*sock_, writeChain_(_, _, _))
+      .WillByDefault(Invoke([&](folly::AsyncSocket::WriteCallback* cb,
+                                folly::IOBuf* buf,
+                                folly::WriteFlags flags) {
+        wr_callback_ = cb;
+        written.emplace_back(buf);
+        write_flags.push_back(flags);
+      }));
+  ON_CALL(*sock_, setReadCB(_)).WillByDefault(SaveArg<0>(&rd_callback_));
+  EXPECT_EQ(conn_->connect(), 0);
+  conn_callback_->connectSuccess();
+  ev_base_folly_.loopOnce();
+  writeSuccess();
+  CHECK_ON_SENT(MessageType::HELLO, E::OK);
+  receiveAckMessage();
+  ASSERT_TRUE(handshaken());
+
+  for (int i = 0; i < 3; ++i) {
+    Envelope* envelope = create_message(*conn_);
+    ASSERT_NE(envelope, nullptr);
+    conn_->releaseMessage(*envelope);
+  }
+  ev_base_folly_.loopOnce();
+  ASSERT_EQ(2u, written.size());
+  EXPECT_EQ(1u, written[1]->countChainElements());
+  EXPECT_EQ(folly::WriteFlags::NONE, write_flags[1]);
+  writeSuccess();
+  CHECK_ON_SENT(MessageType::GET_SEQ_STATE, E::OK);
+  CHECK_ON_SENT(MessageType::GET_SEQ_STATE, E::OK);
+  CHECK_ON_SENT(MessageType::GET_SEQ_STATE, E::OK);
+}
+
+// With --socket-zero-copy-threshold, batches with a large payload are written
+// with MSG_ZEROCOPY. The socket, not the connection, keeps the payload until
+// the kernel reports completion on the error queue.
+TEST_F(ClientConnectionTest, ZeroCopyWrites) {
+  settings_.socket_zero_copy_threshold = 4096;
+  std::vector<std::unique_ptr<folly::IOBuf>> written;
+  std::vector<folly::WriteFlags> write_flags;
+  ON_CALL(*sock_, connect_(_, _, _, _, _))
+      .WillByDefault(SaveArg<0>(&conn_callback_));
+  ON_CALL(*sock_, good()).WillByDefault(Return(true));
+  ON_CALL(*sock_, writeChain_(_, _, _))
+      .WillByDefault(Invoke([&](folly::AsyncSocket::WriteCallback* cb,
+                                folly::IOBuf* buf,
+                                folly::WriteFlags flags) {
+        wr_callback_ = cb;
+        written.emplace_back(buf);
+        write_flags.push_back(flags);
+      }));
+  ON_CALL(*sock_, setReadCB(_)).WillByDefault(SaveArg<0>(&rd_callback_));
+  // SO_ZEROCOPY is enabled once, on the first write that needs it.
+  EXPECT_CALL(*sock_, setZeroCopy(true)).WillOnce(Return(true));
+  EXPECT_EQ(conn_->connect(), 0);
+  conn_callback_->connectSuccess();
+  ev_base_folly_.loopOnce();
+  writeSuccess();
+  CHECK_ON_SENT(MessageType::HELLO, E::OK);
+  receiveAckMessage();
+  ASSERT_TRUE(handshaken());
+  ASSERT_EQ(folly::WriteFlags::NONE, write_flags[0]);
+  const size_t copied_before = bytesSentCopied();
+
+  folly::IOBuf payload(folly::IOBuf::CREATE, 8192);
+  payload.append(8192);
+  Envelope* envelope = create_record_message(*conn_, payload);
+  ASSERT_NE(envelope, nullptr);
+  conn_->releaseMessage(*envelope);
+  ev_base_folly_.loopOnce();
+  ASSERT_EQ(2u, written.size());
+  EXPECT_EQ(folly::WriteFlags::WRITE_MSG_ZEROCOPY, write_flags[1]);
+  EXPECT_EQ(8192u, bytesSentZeroCopy());
+  EXPECT_GT(bytesSentCopied(), copied_before);
+
+  // The write completes before the kernel is done with the buffers. The
+  // message is released, but the chain held by the socket still references
+  // the payload.
+  writeSuccess();
+  CHECK_ON_SENT(MessageType::RECORD, E::OK);
+  EXPECT_TRUE(payload.isSharedOne());
+  // The completion notification releases the chain and with it the payload.
+  written[1].reset();
+  EXPECT_FALSE(payload.isSharedOne());
+
+  // Batches without a large payload are written normally.
+  envelope = create_message(*conn_);
+  ASSERT_NE(envelope, nullptr);
+  conn_->releaseMessage(*envelope);
+  ev_base_folly_.loopOnce();
+  ASSERT_EQ(3u, written.size());
+  EXPECT_EQ(folly::WriteFlags::NONE, write_flags[2]);
+  writeSuccess();
+  CHECK_ON_SENT(MessageType::GET_SEQ_STATE, E::OK);
+
+  // Zero-copy can be turned off without reconnecting.
+  settings_.socket_zero_copy_threshold = 0;
+  envelope = create_record_message(*conn_, payload);
+  ASSERT_NE(envelope, nullptr);
+  conn_->releaseMessage(*envelope);
+  ev_base_folly_.loopOnce();
+  ASSERT_EQ(4u, written.size());
+  EXPECT_EQ(folly::WriteFlags::NONE, write_flags[3]);
+  EXPECT_EQ(2 * 8192u, bytesSentZeroCopy());
+  writeSuccess();
+  CHECK_ON_SENT(MessageType::RECORD, E::OK);
+}
+
+// If the socket doesn't support SO_ZEROCOPY, writes fall back to copying and
+// enabling it isn't retried.
+TEST_F(ClientConnectionTest, ZeroCopyUnsupported) {
+  settings_.socket_zero_copy_threshold = 4096;
+  std::vector<std::unique_ptr<folly::IOBuf>> written;
+  std::vector<folly::WriteFlags> write_flags;
+  ON_CALL(*sock_, connect_(_, _, _, _, _))
+      .WillByDefault(SaveArg<0>(&conn_callback_));
+  ON_CALL(*sock_, good()).WillByDefault(Return(true));
+  ON_CALL(*sock_, writeChain_(_, _, _))
+      .WillByDefault(Invoke([&](folly::AsyncSocket::WriteCallback* cb,
+                                folly::IOBuf* buf,
+                                folly::WriteFlags flags) {
+        wr_callback_ = cb;
+        written.emplace_back(buf);
+        write_flags.push_back(flags);
+      }));
+  ON_CALL(*sock_, setReadCB(_)).WillByDefault(SaveArg<0>(&rd_callback_));
+  EXPECT_CALL(*sock_, setZeroCopy(true)).WillOnce(Return(false));
+  EXPECT_EQ(conn_->connect(), 0);
+  conn_callback_->connectSuccess();
+  ev_base_folly_.loopOnce();
+  writeSuccess();
+  CHECK_ON_SENT(MessageType::HELLO, E::OK);
+  receiveAckMessage();
+  ASSERT_TRUE(handshaken());
+
+  folly::IOBuf payload(folly::IOBuf::CREATE, 8192);
+  payload.append(8192);
+  for (size_t i = 0; i < 2; ++i) {
+    Envelope* envelope = create_record_message(*conn_, payload);
+    ASSERT_NE(envelope, nullptr);
+    conn_->releaseMessage(*envelope);
+    ev_base_folly_.loopOnce();
+    ASSERT_EQ(i + 2, written.size());
+    EXPECT_EQ(folly::WriteFlags::NONE, write_flags.back());
+    writeSuccess();
+    CHECK_ON_SENT(MessageType::RECORD, E::OK);
+  }
+}
+
 TEST_F(ServerConnectionTest, IncomingMessageBytesLimitHandshake) {
   incoming_message_bytes_limit_.setLimit(0);
   // Simulate HELLO to be received by the server.
@@ -130,6 +130,13 @@ class ConnectionTest : public ::testing::Test {
 
   int getDscp();
 
+  size_t bytesSentCopied() const {
+    return conn_->num_bytes_sent_copied_;
+  }
+  size_t bytesSentZeroCopy() const {
+    return conn_->num_bytes_sent_zero_copy_;
+  }
+
   bool usedSinceLastCheck() {
     bool used = !conn_->isIdleAfter(last_usage_check_time_);
     last_usage_check_time_ = SteadyTimestamp::now();
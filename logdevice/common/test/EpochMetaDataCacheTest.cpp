@@ -9,6 +9,8 @@
 
 #include <cstdio>
 #include <cstring>
+#include <thread>
+#include <vector>
 
 #include <folly/Memory.h>
 #include <gtest/gtest.h>
@@ -155,6 +157,137 @@ TEST_F(EpochMetaDataCacheTest, Overwrite) {
   ASSERT_EQ(expected, result_);
 }
 
-// TODO: add test(s) for eviction
+TEST_F(EpochMetaDataCacheTest, IntervalLookup) {
+  setUp();
+  cache_->setMetaData(LOG_ID,
+                      epoch_t(5),
+                      epoch_t(10),
+                      RecordSource::CACHED_CONSISTENT,
+                      genEpochMetaData(epoch_t(3)));
+  cache_->setMetaData(LOG_ID,
+                      epoch_t(11),
+                      epoch_t(20),
+                      RecordSource::CACHED_CONSISTENT,
+                      genEpochMetaData(epoch_t(11)));
+  ASSERT_FALSE(get(epoch_t(4), false));
+  for (epoch_t::raw_type e = 5; e <= 10; ++e) {
+    ASSERT_TRUE(getNoPromotion(epoch_t(e), true));
+    EXPECT_EQ(epoch_t(10), result_.until);
+    EXPECT_EQ(genEpochMetaData(epoch_t(3)), result_.metadata);
+  }
+  ASSERT_TRUE(get(epoch_t(20), true));
+  EXPECT_EQ(epoch_t(20), result_.until);
+  EXPECT_EQ(genEpochMetaData(epoch_t(11)), result_.metadata);
+  ASSERT_FALSE(get(epoch_t(21), false));
+
+  // other logs are not affected
+  epoch_t until;
+  EpochMetaData metadata;
+  RecordSource source;
+  ASSERT_FALSE(cache_->getMetaData(
+      logid_t(LOG_ID.val_ + 1), epoch_t(7), &until, &metadata, &source));
+}
+
+TEST_F(EpochMetaDataCacheTest, SoftEntriesAreExact) {
+  setUp();
+  cache_->setMetaData(LOG_ID,
+                      epoch_t(5),
+                      epoch_t(10),
+                      RecordSource::CACHED_SOFT,
+                      genEpochMetaData(epoch_t(5)));
+  ASSERT_TRUE(get(epoch_t(5), false));
+  ASSERT_FALSE(get(epoch_t(6), false));
+  ASSERT_FALSE(get(epoch_t(6), true));
+}
+
+TEST_F(EpochMetaDataCacheTest, Eviction) {
+  capacity_ = 4;
+  cache_ = std::make_unique<EpochMetaDataCache>(capacity_, 0, 1);
+  auto set = [&](epoch_t::raw_type e) {
+    cache_->setMetaData(LOG_ID,
+                        epoch_t(e),
+                        epoch_t(e),
+                        RecordSource::CACHED_CONSISTENT,
+                        genEpochMetaData(epoch_t(e)));
+  };
+  for (epoch_t::raw_type e = 1; e <= 4; ++e) {
+    set(e);
+  }
+  EXPECT_EQ(4, cache_->numEntries());
+
+  // Entries looked up since the hand last passed survive.
+  ASSERT_TRUE(get(epoch_t(1), true));
+  ASSERT_TRUE(getNoPromotion(epoch_t(2), true));
+  set(5);
+  EXPECT_EQ(4, cache_->numEntries());
+  EXPECT_TRUE(getNoPromotion(epoch_t(1), true));
+  EXPECT_FALSE(getNoPromotion(epoch_t(2), true));
+  EXPECT_TRUE(getNoPromotion(epoch_t(5), true));
+
+  set(6);
+  EXPECT_EQ(4, cache_->numEntries());
+  EXPECT_FALSE(getNoPromotion(epoch_t(3), true));
+  EXPECT_TRUE(getNoPromotion(epoch_t(6), true));
+}
+
+TEST_F(EpochMetaDataCacheTest, MemoryLimit) {
+  const size_t max_entries = 1000000;
+  // measure the size of one entry
+  EpochMetaDataCache probe(max_entries, 0, 1);
+  probe.setMetaData(LOG_ID,
+                    epoch_t(1),
+                    epoch_t(1),
+                    RecordSource::CACHED_CONSISTENT,
+                    genEpochMetaData(epoch_t(1)));
+  const size_t entry_bytes = probe.memoryUsage();
+  ASSERT_GT(entry_bytes, 0);
+
+  cache_ = std::make_unique<EpochMetaDataCache>(
+      max_entries, 160 * entry_bytes, EpochMetaDataCache::DEFAULT_NUM_SHARDS);
+  for (epoch_t::raw_type e = 1; e <= 1000; ++e) {
+    cache_->setMetaData(logid_t(e),
+                        epoch_t(e),
+                        epoch_t(e),
+                        RecordSource::CACHED_CONSISTENT,
+                        genEpochMetaData(epoch_t(e)));
+  }
+  // Each shard gets 1/16th of the limit, i.e. 10 entries.
+  EXPECT_LE(cache_->memoryUsage(), 160 * entry_bytes);
+  EXPECT_GT(cache_->numEntries(), 80);
+  EXPECT_EQ(cache_->memoryUsage(), cache_->numEntries() * entry_bytes);
+}
+
+TEST_F(EpochMetaDataCacheTest, Concurrent) {
+  cache_ = std::make_unique<EpochMetaDataCache>(160);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&, t] {
+      epoch_t until;
+      EpochMetaData metadata;
+      RecordSource source;
+      for (int i = 0; i < 10000; ++i) {
+        logid_t logid(i % 50 + 1);
+        epoch_t epoch((i + t) % 30 + 1);
+        if (cache_->getMetaData(logid, epoch, &until, &metadata, &source)) {
+          // entries are stored for intervals [e, e + 9] starting at
+          // multiples of 10, plus one
+          EXPECT_GE(until, epoch);
+          EXPECT_LE(metadata.h.epoch, epoch);
+        } else {
+          epoch_t start((epoch.val_ - 1) / 10 * 10 + 1);
+          cache_->setMetaData(logid,
+                              start,
+                              epoch_t(start.val_ + 9),
+                              RecordSource::CACHED_CONSISTENT,
+                              genEpochMetaData(start));
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_LE(cache_->numEntries(), 160);
+}
 
 } // namespace
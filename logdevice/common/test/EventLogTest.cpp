@@ -233,8 +233,11 @@ class EventLogTest : public ::testing::TestWithParam<bool> {
   }
 
   std::unique_ptr<DataRecord>
-  genSnapshotRecord(const EventLogRebuildingSet& set, lsn_t v, lsn_t lsn) {
-    std::string buf = evlog_->createSnapshotPayload(set, v);
+  genSnapshotRecord(const EventLogRebuildingSet& set,
+                    lsn_t v,
+                    lsn_t lsn,
+                    size_t chunk_size = 0) {
+    std::string buf = evlog_->createSnapshotPayload(set, v, chunk_size);
 
     return std::make_unique<DataRecordOwnsPayload>(
         configuration::InternalLogs::EVENT_LOG_SNAPSHOTS,
@@ -1628,6 +1631,44 @@ TEST_P(EventLogTest, TimeBasedSnapsho) {
 }
 
 // Run all tests with and without snapshot compression.
+// A snapshot split into many chunks, compressed or not, is read back into the
+// same state.
+TEST_P(EventLogTest, ChunkedSnapshot) {
+  delta_log_tail_lsn_ = lsn_t{42};
+  snapshot_log_tail_lsn_ = lsn_t{4};
+  settings_updater_->setFromCLI({{"event-log-snapshotting", "true"}});
+  init();
+  evlog_->enableSnapshotCompression(GetParam());
+  evlog_->start();
+
+  EventLogRebuildingSet set;
+  for (node_index_t nid = 0; nid < kNumNodes; ++nid) {
+    UPDATE(set, lsn_t{30 + nid}, SHARD_NEEDS_REBUILD, nid, uint32_t{0});
+  }
+  const lsn_t version = lsn_t{30 + kNumNodes - 1};
+
+  auto p = genSnapshotRecord(set, version, lsn_t{4}, /*chunk_size=*/16);
+  RSMSnapshotHeader header;
+  ASSERT_GT(RSMSnapshotHeader::deserialize(p->payload, header), 0);
+  EXPECT_TRUE(header.flags & RSMSnapshotHeader::CHUNKED);
+  EXPECT_EQ(GetParam(),
+            bool(header.flags & RSMSnapshotHeader::ZSTD_COMPRESSION));
+  // Small chunks, so that there are many of them.
+  ASSERT_GT(p->payload.size(), 4 * 16);
+  evlog_->onSnapshotRecord(p);
+
+  DELTA_GAP(BRIDGE, LSN_OLDEST, lsn_t{41});
+  subscriber_->assertNoUpdate();
+  DELTA(lsn_t{42}, SHARD_NEEDS_REBUILD, node_index_t{0}, uint32_t{1});
+  auto u = subscriber_->retrieveNextUpdate();
+  ASSERT_EQ(lsn_t{42}, u.version);
+  for (node_index_t nid = 0; nid < kNumNodes; ++nid) {
+    ASSERT_SHARD_STATUS(u.state, nid, uint32_t{0}, UNAVAILABLE);
+  }
+  ASSERT_SHARD_STATUS(u.state, node_index_t{0}, uint32_t{1}, UNAVAILABLE);
+  subscriber_->assertNoUpdate();
+}
+
 INSTANTIATE_TEST_CASE_P(T, EventLogTest, ::testing::Values(false, true));
 
 }} // namespace facebook::logdevice
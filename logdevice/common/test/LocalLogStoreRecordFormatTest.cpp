@@ -293,3 +293,43 @@ INSTANTIATE_TEST_CASE_P(LocalLogStoreRecordFormatTest,
                                            ::testing::Bool(),
                                            ::testing::Bool(),
                                            ::testing::Bool()));
+
+TEST(LocalLogStoreRecordFormatCSITest, FilterableKey) {
+  const shard_index_t this_shard = 3;
+  const ShardID copyset[] = {ShardID(88, this_shard), ShardID(99, 64)};
+  const LocalLogStoreRecordFormat::csi_flags_t flags =
+      LocalLogStoreRecordFormat::CSI_FLAG_SHARD_ID;
+  const std::string key = "filterable";
+
+  std::string buf;
+  Slice csi_blob = LocalLogStoreRecordFormat::formCopySetIndexEntry(
+      4321, copyset, 2, LSN_INVALID, flags, &buf, key);
+  ASSERT_EQ(sizeof(uint32_t) + sizeof(LocalLogStoreRecordFormat::csi_flags_t) +
+                sizeof(copyset_size_t) + 2 * sizeof(ShardID) +
+                sizeof(uint16_t) + key.size(),
+            csi_blob.size);
+
+  LocalLogStoreRecordFormat::csi_flags_t flags_read;
+  uint32_t wave_read;
+  std::vector<ShardID> copyset_read;
+  folly::StringPiece key_read;
+  ASSERT_TRUE(LocalLogStoreRecordFormat::parseCopySetIndexSingleEntry(
+      csi_blob, &copyset_read, &wave_read, &flags_read, this_shard, &key_read));
+  EXPECT_EQ(
+      flags | LocalLogStoreRecordFormat::CSI_FLAG_FILTERABLE_KEY, flags_read);
+  EXPECT_EQ(4321, wave_read);
+  EXPECT_EQ(std::vector<ShardID>(copyset, copyset + 2), copyset_read);
+  EXPECT_EQ(key, key_read.str());
+
+  // The key is optional for readers.
+  ASSERT_TRUE(LocalLogStoreRecordFormat::parseCopySetIndexSingleEntry(
+      csi_blob, nullptr, nullptr, &flags_read, this_shard));
+
+  // Entries without a key parse as before.
+  csi_blob = LocalLogStoreRecordFormat::formCopySetIndexEntry(
+      4321, copyset, 2, LSN_INVALID, flags, &buf);
+  ASSERT_TRUE(LocalLogStoreRecordFormat::parseCopySetIndexSingleEntry(
+      csi_blob, &copyset_read, &wave_read, &flags_read, this_shard, &key_read));
+  EXPECT_EQ(flags, flags_read);
+  EXPECT_TRUE(key_read.empty());
+}
@@ -7,7 +7,9 @@
  */
 #include "logdevice/common/configuration/logs/LogsConfigTree.h"
 
+#include <algorithm>
 #include <iostream>
+#include <map>
 #include <set>
 #include <thread>
 
@@ -470,6 +472,216 @@ TEST(LogsConfigTreeTest, TestFindLogByID) {
   ASSERT_FALSE(not_found);
 }
 
+// Lookups by id must see the same log groups whether they are served from the
+// index built when copying the tree or from the one updated by mutations.
+TEST(LogsConfigTreeTest, TestFindLogByIDAfterCopy) {
+  std::unique_ptr<LogsConfigTree> tree = LogsConfigTree::create();
+  auto dir = tree->addDirectory(
+      tree->root(), "logs", LogAttributes().with_replicationFactor(2));
+  for (int i = 0; i < 100; ++i) {
+    // Added in non-sorted order of log ids.
+    logid_t::raw_type lo = 1 + ((i * 37) % 100) * 10;
+    ASSERT_TRUE(tree->addLogGroup(dir,
+                                  "group" + std::to_string(i),
+                                  logid_range_t{logid_t(lo), logid_t(lo + 4)}));
+  }
+
+  auto copy = tree->copy();
+  for (const LogsConfigTree* t : {tree.get(), copy.get()}) {
+    ASSERT_EQ(500, t->size());
+    for (logid_t::raw_type id = 0; id <= 1000; ++id) {
+      const LogGroupInDirectory* lgid = t->getLogGroupByID(logid_t(id));
+      bool expected = id > 0 && (id - 1) % 10 < 5;
+      ASSERT_EQ(expected, lgid != nullptr) << id;
+      ASSERT_EQ(expected, t->logExists(logid_t(id))) << id;
+      if (lgid) {
+        ASSERT_EQ(dir->getFullyQualifiedName(),
+                  lgid->parent->getFullyQualifiedName());
+        ASSERT_TRUE(lgid->log_group->range().first.val() <= id);
+        ASSERT_TRUE(id <= lgid->log_group->range().second.val());
+      }
+    }
+    std::string failure_reason;
+    ASSERT_TRUE(t->doesLogRangeClash(
+        logid_range_t{logid_t(6), logid_t(11)}, failure_reason));
+    ASSERT_FALSE(t->doesLogRangeClash(
+        logid_range_t{logid_t(6), logid_t(10)}, failure_reason));
+    ASSERT_EQ(500, std::distance(t->logsBegin(), t->logsEnd()));
+  }
+
+  // Mutate the copy and check the lookups again.
+  ASSERT_EQ(0, copy->deleteLogGroup("/logs/group0"));
+  ASSERT_FALSE(copy->getLogGroupByID(logid_t(1)));
+  ASSERT_TRUE(tree->getLogGroupByID(logid_t(1)));
+  ASSERT_TRUE(copy->addLogGroup(
+      "/logs/new_group", logid_range_t{logid_t(2000), logid_t(2000)}));
+  ASSERT_EQ(496, copy->size());
+  ASSERT_EQ("new_group",
+            copy->getLogGroupByID(logid_t(2000))->log_group->name());
+  ASSERT_FALSE(tree->getLogGroupByID(logid_t(2000)));
+}
+
+// LogIdIndex is updated range by range, across chunk splits and removals.
+TEST(LogsConfigTreeTest, LogIdIndexInsertErase) {
+  LogIdIndex index;
+  std::map<logid_t::raw_type, logid_t::raw_type> expected;
+  auto check = [&] {
+    size_t num_logs = 0;
+    for (const auto& kv : expected) {
+      num_logs += kv.second - kv.first + 1;
+    }
+    ASSERT_EQ(expected.size(), index.numRanges());
+    ASSERT_EQ(num_logs, index.numLogs());
+    std::vector<logid_t::raw_type> lows;
+    index.forEach([&](const LogIdIndex::Entry& e) { lows.push_back(e.lo); });
+    ASSERT_EQ(expected.size(), lows.size());
+    ASSERT_TRUE(std::is_sorted(lows.begin(), lows.end()));
+    for (logid_t::raw_type id = 0; id <= 4 * 2000 + 10; ++id) {
+      auto it = expected.upper_bound(id);
+      bool in_range = it != expected.begin() && id <= std::prev(it)->second;
+      const LogIdIndex::Entry* e = index.find(id);
+      ASSERT_EQ(in_range, e != nullptr) << id;
+      if (e) {
+        ASSERT_EQ(std::prev(it)->first, e->lo);
+      }
+    }
+  };
+
+  // Ranges [4i + 1, 4i + 2], added in shuffled order so that chunks get
+  // split in the middle and at both ends.
+  for (int i = 0; i < 2000; ++i) {
+    logid_t::raw_type lo = 1 + ((i * 797) % 2000) * 4;
+    index.insert(LogIdIndex::Entry{lo, lo + 1, LogGroupInDirectory()});
+    expected[lo] = lo + 1;
+  }
+  check();
+  ASSERT_TRUE(index.findOverlap(3, 5));
+  ASSERT_FALSE(index.findOverlap(3, 4));
+
+  ASSERT_FALSE(index.erase(2));
+  for (int i = 0; i < 2000; i += 3) {
+    logid_t::raw_type lo = 1 + ((i * 797) % 2000) * 4;
+    ASSERT_TRUE(index.erase(lo));
+    expected.erase(lo);
+  }
+  check();
+
+  std::vector<LogIdIndex::Entry> entries;
+  index.forEach([&](const LogIdIndex::Entry& e) { entries.push_back(e); });
+  LogIdIndex copy;
+  copy.assign(std::move(entries));
+  for (const auto& kv : expected) {
+    ASSERT_TRUE(copy.find(kv.first));
+    ASSERT_TRUE(index.erase(kv.first));
+  }
+  ASSERT_EQ(0, index.numRanges());
+  ASSERT_EQ(0, index.numLogs());
+  ASSERT_FALSE(index.find(1));
+  ASSERT_EQ(expected.size(), copy.numRanges());
+}
+
+// Mutations of a copied tree keep pointing lookups to the copy's directories.
+TEST(LogsConfigTreeTest, TestFindLogByIDAfterCopyAndMutation) {
+  std::unique_ptr<LogsConfigTree> tree = LogsConfigTree::create();
+  auto dir = tree->addDirectory(
+      tree->root(), "logs", LogAttributes().with_replicationFactor(2));
+  ASSERT_TRUE(tree->addDirectory(dir, "sub"));
+  for (int i = 0; i < 1000; ++i) {
+    std::string path = (i % 2 ? "/logs/sub/group" : "/logs/group") +
+        std::to_string(i);
+    ASSERT_TRUE(tree->addLogGroup(
+        path, logid_range_t{logid_t(i * 2 + 1), logid_t(i * 2 + 1)}));
+  }
+
+  auto copy = tree->copy();
+  const DirectoryNode* sub = copy->findDirectory("/logs/sub");
+  ASSERT_NE(nullptr, sub);
+  ASSERT_EQ(tree->findDirectory("/logs/sub"), sub);
+  ASSERT_EQ(sub, copy->getLogGroupByID(logid_t(3))->parent);
+  ASSERT_EQ(0, copy->rename("/logs/sub/group1", "/logs/sub/renamed"));
+  ASSERT_EQ("renamed", copy->getLogGroupByID(logid_t(3))->log_group->name());
+  // The copy got its own /logs/sub, which all its log groups point to.
+  sub = copy->findDirectory("/logs/sub");
+  ASSERT_NE(tree->findDirectory("/logs/sub"), sub);
+  for (int i = 1; i < 1000; i += 2) {
+    logid_t logid(i * 2 + 1);
+    ASSERT_EQ(sub, copy->getLogGroupByID(logid)->parent);
+    ASSERT_EQ(tree->findDirectory("/logs/sub"),
+              tree->getLogGroupByID(logid)->parent);
+  }
+  ASSERT_EQ("group1", tree->getLogGroupByID(logid_t(3))->log_group->name());
+
+  ASSERT_EQ(
+      0,
+      copy->setAttributes(
+          "/logs/sub", LogAttributes().with_replicationFactor(3)));
+  sub = copy->findDirectory("/logs/sub");
+  for (int i = 1; i < 1000; i += 2) {
+    const LogGroupInDirectory* lgid =
+        copy->getLogGroupByID(logid_t(i * 2 + 1));
+    ASSERT_NE(nullptr, lgid);
+    ASSERT_EQ(sub, lgid->parent);
+    ASSERT_EQ(3, lgid->log_group->attrs().replicationFactor());
+  }
+  ASSERT_EQ(1000, std::distance(copy->logsBegin(), copy->logsEnd()));
+  ASSERT_EQ(0, copy->deleteLogGroup("/logs/group0"));
+  ASSERT_EQ(999, std::distance(copy->logsBegin(), copy->logsEnd()));
+  ASSERT_EQ(999, copy->size());
+  ASSERT_EQ(1000, tree->size());
+}
+
+// Copies share the directories that neither modifies, and modifying one
+// doesn't change the other.
+TEST(LogsConfigTreeTest, TestCopiesShareUnchangedDirectories) {
+  std::unique_ptr<LogsConfigTree> tree = LogsConfigTree::create();
+  LogAttributes attrs = LogAttributes().with_replicationFactor(2);
+  LogAttributes attrs1 = attrs.with_backlogDuration(std::chrono::seconds(100));
+  LogAttributes attrs2 = attrs.with_backlogDuration(std::chrono::seconds(10));
+  ASSERT_TRUE(tree->addLogGroup(
+      "/a/b/log1", logid_range_t{logid_t(1), logid_t(1)}, attrs1, true));
+  ASSERT_TRUE(tree->addLogGroup(
+      "/c/log2", logid_range_t{logid_t(2), logid_t(2)}, attrs2, true));
+  ASSERT_TRUE(
+      tree->addLogGroup("/log3", logid_range_t{logid_t(3), logid_t(3)}, attrs));
+
+  auto copy = tree->copy();
+  ASSERT_EQ(tree->root(), copy->root());
+  ASSERT_EQ(std::chrono::seconds(100), copy->getMaxBacklogDuration());
+
+  // Only the directories on the way to /a/b get copied.
+  ASSERT_EQ(0, copy->deleteLogGroup("/a/b/log1"));
+  ASSERT_NE(tree->root(), copy->root());
+  ASSERT_NE(tree->findDirectory("/a"), copy->findDirectory("/a"));
+  ASSERT_NE(tree->findDirectory("/a/b"), copy->findDirectory("/a/b"));
+  ASSERT_EQ(tree->findDirectory("/c"), copy->findDirectory("/c"));
+  ASSERT_EQ(tree->findLogGroup("/log3"), copy->findLogGroup("/log3"));
+  ASSERT_EQ(copy->root(), copy->getLogGroupByID(logid_t(3))->parent);
+  ASSERT_EQ(tree->root(), tree->getLogGroupByID(logid_t(3))->parent);
+  ASSERT_FALSE(copy->logExists(logid_t(1)));
+  ASSERT_TRUE(tree->logExists(logid_t(1)));
+  ASSERT_EQ(std::chrono::seconds(10), copy->getMaxBacklogDuration());
+  ASSERT_EQ(std::chrono::seconds(100), tree->getMaxBacklogDuration());
+
+  // Renaming a directory changes the names of everything in it.
+  ASSERT_EQ(0, tree->rename("/a", "/x"));
+  ASSERT_EQ("/x/b/log1",
+            tree->getLogGroupByID(logid_t(1))->getFullyQualifiedName());
+  ASSERT_EQ("/x/b/", tree->findDirectory("/x/b")->getFullyQualifiedName());
+  ASSERT_EQ(nullptr, tree->findDirectory("/a"));
+  ASSERT_NE(nullptr, copy->findDirectory("/a/b"));
+  ASSERT_EQ(nullptr, copy->findDirectory("/x"));
+
+  ASSERT_EQ(0, copy->deleteDirectory("/c", true /* recursive */));
+  ASSERT_FALSE(copy->logExists(logid_t(2)));
+  ASSERT_EQ(std::chrono::seconds(0), copy->getMaxBacklogDuration());
+  ASSERT_EQ("/c/log2",
+            tree->getLogGroupByID(logid_t(2))->getFullyQualifiedName());
+
+  ASSERT_EQ(1, copy->size());
+  ASSERT_EQ(3, tree->size());
+  ASSERT_EQ(3, std::distance(tree->logsBegin(), tree->logsEnd()));
+}
+
 TEST(LogsConfigTreeTest, TestMetadataLogAddFail) {
   std::unique_ptr<LogsConfigTree> tree = LogsConfigTree::create();
   LogAttributes base_attrs = LogAttributes().with_replicationFactor(2);
@@ -31,10 +31,13 @@
 #include "logdevice/common/protocol/ProtocolWriter.h"
 #include "logdevice/common/protocol/RECORD_Message.h"
 #include "logdevice/common/protocol/SEALED_Message.h"
+#include "logdevice/common/protocol/SEAL_BATCH_Message.h"
 #include "logdevice/common/protocol/SHUTDOWN_Message.h"
 #include "logdevice/common/protocol/STARTED_Message.h"
 #include "logdevice/common/protocol/START_Message.h"
 #include "logdevice/common/protocol/STOP_Message.h"
+#include "logdevice/common/protocol/STORED_BATCH_Message.h"
+#include "logdevice/common/protocol/STORE_BATCH_Message.h"
 #include "logdevice/common/protocol/STORE_Message.h"
 #include "logdevice/common/request_util.h"
 #include "logdevice/common/test/TestUtil.h"
@@ -624,6 +627,186 @@ TEST_F(MessageSerializationTest, STORE_WithWriteStreamFlagSet) {
           nullptr);
 }
 
+TEST_F(MessageSerializationTest, STORE_BATCH) {
+  TestStoreMessageFactory factory;
+  std::vector<std::unique_ptr<STORE_Message>> stores;
+  stores.push_back(std::make_unique<STORE_Message>(factory.message()));
+  factory.setWave(2);
+  stores.push_back(std::make_unique<STORE_Message>(factory.message()));
+  STORE_BATCH_Message m(std::move(stores));
+
+  auto check = [&](const STORE_BATCH_Message& m2, uint16_t proto) {
+    ASSERT_EQ(m.getStores().size(), m2.getStores().size());
+    for (size_t i = 0; i < m.getStores().size(); ++i) {
+      checkSTORE(*m.getStores()[i], *m2.getStores()[i], proto);
+    }
+  };
+  auto expected = [&](uint16_t proto) {
+    std::string rv = TestStoreMessageFactory::hex<uint32_t>(2);
+    for (uint32_t wave : {1, 2}) {
+      factory.setWave(wave);
+      std::string store = factory.serialized(proto);
+      rv += TestStoreMessageFactory::hex<uint32_t>(store.size() / 2);
+      rv += store;
+    }
+    return rv;
+  };
+  DO_TEST(m,
+          check,
+          Compatibility::STORE_BATCH_SUPPORT,
+          Compatibility::MAX_PROTOCOL_SUPPORTED,
+          expected,
+          nullptr);
+}
+
+TEST_F(MessageSerializationTest, STORED_BATCH) {
+  auto make_reply = [](uint32_t wave, Status status) {
+    STORED_Header h;
+    h.rid = RecordID(esn_t(0x01020304), epoch_t(0x05060708), logid_t(9));
+    h.wave = wave;
+    h.status = status;
+    h.redirect = NodeID(5, 2);
+    h.flags = STORED_Header::SYNCED;
+    h.shard = 1;
+    return std::make_unique<STORED_Message>(h,
+                                            LSN_INVALID,
+                                            0,
+                                            CHUNK_REBUILDING_ID_INVALID,
+                                            FlushToken_INVALID,
+                                            ServerInstanceId_INVALID,
+                                            ShardID(3, 1));
+  };
+  std::vector<std::unique_ptr<STORED_Message>> replies;
+  replies.push_back(make_reply(1, E::OK));
+  // A reply with E::REBUILDING also carries the rebuilding recipient, so
+  // replies in a batch differ in size.
+  replies.push_back(make_reply(2, E::REBUILDING));
+  STORED_BATCH_Message m(std::move(replies));
+
+  auto check = [&](const STORED_BATCH_Message& m2, uint16_t /*proto*/) {
+    ASSERT_EQ(m.getReplies().size(), m2.getReplies().size());
+    for (size_t i = 0; i < m.getReplies().size(); ++i) {
+      const STORED_Message& a = *m.getReplies()[i];
+      const STORED_Message& b = *m2.getReplies()[i];
+      EXPECT_EQ(a.header_.rid, b.header_.rid);
+      EXPECT_EQ(a.header_.wave, b.header_.wave);
+      EXPECT_EQ(a.header_.status, b.header_.status);
+      EXPECT_EQ(a.header_.redirect, b.header_.redirect);
+      EXPECT_EQ(a.header_.flags, b.header_.flags);
+      EXPECT_EQ(a.header_.shard, b.header_.shard);
+      if (a.header_.status == E::REBUILDING) {
+        EXPECT_EQ(a.rebuildingRecipient_, b.rebuildingRecipient_);
+      }
+    }
+  };
+  // Each reply is prefixed with its length.
+  auto expected = [&](uint16_t proto) {
+    std::string rv = TestStoreMessageFactory::hex<uint32_t>(2);
+    for (const auto& reply : m.getReplies()) {
+      std::unique_ptr<folly::IOBuf> iobuf =
+          folly::IOBuf::create(IOBUF_ALLOCATION_UNIT);
+      ProtocolWriter writer(MessageType::STORED, iobuf.get(), proto);
+      reply->serialize(writer);
+      ssize_t sz = writer.result();
+      EXPECT_GT(sz, 0);
+      std::string serialized = iobuf->coalesce().str();
+      rv += TestStoreMessageFactory::hex<uint32_t>(sz);
+      rv += hexdump_buf(&serialized[0], sz);
+    }
+    return rv;
+  };
+  DO_TEST(m,
+          check,
+          Compatibility::STORE_BATCH_SUPPORT,
+          Compatibility::MAX_PROTOCOL_SUPPORTED,
+          expected,
+          nullptr);
+}
+
+TEST_F(MessageSerializationTest, STORED_WithAppendStages) {
+  STORED_Header h;
+  h.rid = RecordID(esn_t(0x01020304), epoch_t(0x05060708), logid_t(9));
+  h.wave = 1;
+  h.status = E::OK;
+  h.redirect = NodeID(5, 2);
+  h.flags = STORED_Header::SYNCED | STORED_Header::APPEND_STAGES;
+  h.shard = 1;
+  STORED_Message m(h,
+                   LSN_INVALID,
+                   0,
+                   CHUNK_REBUILDING_ID_INVALID,
+                   FlushToken_INVALID,
+                   ServerInstanceId_INVALID);
+  m.append_stages_ = {10, 20, 30, 40};
+
+  auto check = [&](const STORED_Message& m2, uint16_t proto) {
+    EXPECT_EQ(m.header_.rid, m2.header_.rid);
+    EXPECT_EQ(m.header_.wave, m2.header_.wave);
+    EXPECT_EQ(m.header_.shard, m2.header_.shard);
+    if (proto < Compatibility::APPEND_STAGES_IN_STORED) {
+      // Old peers don't get the stages.
+      EXPECT_EQ(STORED_Header::SYNCED, m2.header_.flags);
+      EXPECT_EQ(StorageStageDurations{}, m2.append_stages_);
+    } else {
+      EXPECT_EQ(m.header_.flags, m2.header_.flags);
+      EXPECT_EQ(m.append_stages_, m2.append_stages_);
+    }
+  };
+  auto expected = [](uint16_t proto) {
+    std::string rv = "0403020108070605090000000000000001000000000002000500";
+    if (proto < Compatibility::APPEND_STAGES_IN_STORED) {
+      return rv + "010100";
+    }
+    // Flags, shard, then the number of stages and their durations.
+    return rv + "410100" + "04" + "0A000000140000001E00000028000000";
+  };
+  DO_TEST(m,
+          check,
+          Compatibility::MIN_PROTOCOL_SUPPORTED,
+          Compatibility::MAX_PROTOCOL_SUPPORTED,
+          expected,
+          nullptr);
+}
+
+TEST_F(MessageSerializationTest, SEAL_BATCH) {
+  SEAL_Header h1;
+  h1.rqid = request_id_t(0x0102030405060708);
+  h1.log_id = logid_t(7);
+  h1.seal_epoch = epoch_t(9);
+  h1.last_clean_epoch = epoch_t(4);
+  h1.sealed_by = NodeID(2, 1);
+  h1.shard = 3;
+  SEAL_Header h2 = h1;
+  h2.rqid = request_id_t(1);
+  h2.log_id = logid_t(8);
+  h2.seal_epoch = epoch_t(10);
+  h2.last_clean_epoch = EPOCH_INVALID;
+  SEAL_BATCH_Message m({h1, h2});
+
+  auto check = [&](const SEAL_BATCH_Message& m2, uint16_t /*proto*/) {
+    ASSERT_EQ(m.getHeaders().size(), m2.getHeaders().size());
+    for (size_t i = 0; i < m.getHeaders().size(); ++i) {
+      const SEAL_Header& a = m.getHeaders()[i];
+      const SEAL_Header& b = m2.getHeaders()[i];
+      EXPECT_EQ(a.rqid, b.rqid);
+      EXPECT_EQ(a.log_id, b.log_id);
+      EXPECT_EQ(a.seal_epoch, b.seal_epoch);
+      EXPECT_EQ(a.last_clean_epoch, b.last_clean_epoch);
+      EXPECT_EQ(a.sealed_by, b.sealed_by);
+      EXPECT_EQ(a.shard, b.shard);
+    }
+  };
+  std::string expected =
+      "020000000807060504030201070000000000000009000000040000000100020003000100"
+      "00000000000008000000000000000A00000000000000010002000300";
+  DO_TEST(m,
+          check,
+          Compatibility::SEAL_BATCH_SUPPORT,
+          Compatibility::MAX_PROTOCOL_SUPPORTED,
+          [&](uint16_t) { return expected; },
+          nullptr);
+}
+
 TEST_F(MessageSerializationTest, SHUTDOWN_WithServerInstanceId) {
   SHUTDOWN_Header h = {E::SHUTDOWN, ServerInstanceId(10)};
 
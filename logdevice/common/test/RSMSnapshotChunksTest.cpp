@@ -0,0 +1,127 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/replicated_state_machine/RSMSnapshotChunks.h"
+
+#include <gtest/gtest.h>
+
+#include "logdevice/include/Err.h"
+
+using namespace facebook::logdevice;
+
+namespace {
+
+std::string makeState(size_t size) {
+  std::string state(size, '\0');
+  for (size_t i = 0; i < size; ++i) {
+    state[i] = 'a' + (i * 7 + i / 13) % 26;
+  }
+  return state;
+}
+
+void roundTrip(const std::string& state, size_t chunk_size, bool compress) {
+  std::string encoded;
+  ASSERT_EQ(0,
+            RSMSnapshotChunks::encode(Payload(state.data(), state.size()),
+                                      chunk_size,
+                                      compress,
+                                      encoded));
+  std::string decoded;
+  ASSERT_EQ(0,
+            RSMSnapshotChunks::decode(
+                Payload(encoded.data(), encoded.size()), compress, decoded));
+  EXPECT_EQ(state, decoded);
+}
+
+} // namespace
+
+TEST(RSMSnapshotChunksTest, RoundTrip) {
+  for (bool compress : {false, true}) {
+    roundTrip("", 16, compress);
+    roundTrip(makeState(1), 16, compress);
+    roundTrip(makeState(16), 16, compress);
+    roundTrip(makeState(100), 16, compress);
+    roundTrip(makeState(1 << 20), 4096, compress);
+    roundTrip(makeState(1 << 20), 1 << 24, compress);
+  }
+}
+
+TEST(RSMSnapshotChunksTest, Layout) {
+  const std::string state = makeState(10);
+  std::string encoded;
+  ASSERT_EQ(0,
+            RSMSnapshotChunks::encode(
+                Payload(state.data(), state.size()), 4, false, encoded));
+  // Number of chunks, a (uncompressed size, size) pair per chunk, then the
+  // chunks.
+  ASSERT_EQ(4 + 3 * 8 + state.size(), encoded.size());
+  uint32_t nchunks;
+  memcpy(&nchunks, encoded.data(), sizeof(nchunks));
+  EXPECT_EQ(3, nchunks);
+  EXPECT_EQ(state, encoded.substr(4 + 3 * 8));
+}
+
+TEST(RSMSnapshotChunksTest, Malformed) {
+  const std::string state(1000, 'x');
+  std::string encoded;
+  ASSERT_EQ(0,
+            RSMSnapshotChunks::encode(
+                Payload(state.data(), state.size()), 100, true, encoded));
+
+  std::string decoded;
+  // Truncated.
+  for (size_t len : {0ul, 3ul, 20ul, encoded.size() - 1}) {
+    err = E::OK;
+    EXPECT_EQ(-1,
+              RSMSnapshotChunks::decode(
+                  Payload(encoded.data(), len), true, decoded));
+    EXPECT_EQ(E::BADMSG, err);
+  }
+
+  // Compressed chunks read as if they were not.
+  err = E::OK;
+  EXPECT_EQ(-1,
+            RSMSnapshotChunks::decode(
+                Payload(encoded.data(), encoded.size()), false, decoded));
+  EXPECT_EQ(E::BADMSG, err);
+
+  // Uncompressed size of the first chunk doesn't match its content.
+  std::string corrupted = encoded;
+  uint32_t uncompressed_size = 101;
+  memcpy(&corrupted[4], &uncompressed_size, sizeof(uncompressed_size));
+  err = E::OK;
+  EXPECT_EQ(-1,
+            RSMSnapshotChunks::decode(
+                Payload(corrupted.data(), corrupted.size()), true, decoded));
+  EXPECT_EQ(E::BADMSG, err);
+
+  // Table claims more than MAX_STATE_SIZE uncompressed. Must fail without
+  // trying to allocate that much.
+  const uint32_t nchunks = RSMSnapshotChunks::MAX_STATE_SIZE / (1u << 30) + 1;
+  std::string huge(sizeof(nchunks), '\0');
+  memcpy(&huge[0], &nchunks, sizeof(nchunks));
+  for (uint32_t i = 0; i < nchunks; ++i) {
+    uint32_t info[2] = {1u << 30, 1};
+    huge.append(reinterpret_cast<const char*>(info), sizeof(info));
+  }
+  huge.append(nchunks, 'x');
+  err = E::OK;
+  EXPECT_EQ(-1,
+            RSMSnapshotChunks::decode(
+                Payload(huge.data(), huge.size()), true, decoded));
+  EXPECT_EQ(E::BADMSG, err);
+
+  // A single chunk claiming more than the maximum chunk size.
+  huge = encoded;
+  uncompressed_size = (1u << 30) + 1;
+  memcpy(&huge[4], &uncompressed_size, sizeof(uncompressed_size));
+  err = E::OK;
+  EXPECT_EQ(-1,
+            RSMSnapshotChunks::decode(
+                Payload(huge.data(), huge.size()), true, decoded));
+  EXPECT_EQ(E::BADMSG, err);
+}
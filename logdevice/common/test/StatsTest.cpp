@@ -10,6 +10,8 @@
 #include <array>
 #include <atomic>
 #include <condition_variable>
+#include <limits>
+#include <map>
 #include <mutex>
 #include <thread>
 #include <unistd.h>
@@ -116,6 +118,95 @@ TEST(StatsTest, MultipleThreadsTest) {
   EXPECT_EQ(nthreads, total.store_synced);
 }
 
+// Per-log-group stats bumped by handle and by name from multiple threads
+// should end up in the same slot and be summed up by aggregate().
+TEST(StatsTest, PerLogStatsTest) {
+  StatsHolder holder(StatsParams().setIsServer(true));
+  constexpr int nthreads = 4;
+  // Use enough log groups to span several chunks of PerLogStatsSlots.
+  constexpr int nlog_groups = 200;
+
+  std::vector<log_group_stats_idx_t> idxs;
+  for (int i = 0; i < nlog_groups; ++i) {
+    idxs.push_back(LogGroupStatsIndex::instance().getOrAssign(
+        "/stats_test/log_group_" + std::to_string(i)));
+  }
+  EXPECT_EQ(idxs[7],
+            LogGroupStatsIndex::instance().getOrAssign(
+                "/stats_test/log_group_7"));
+  EXPECT_EQ("/stats_test/log_group_7",
+            LogGroupStatsIndex::instance().getName(idxs[7]));
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < nthreads; ++t) {
+    threads.emplace_back([&]() {
+      for (int i = 0; i < nlog_groups; ++i) {
+        LOG_GROUP_IDX_STAT_ADD(&holder, idxs[i], append_success, i);
+        LOG_GROUP_STAT_ADD(&holder,
+                           "/stats_test/log_group_" + std::to_string(i),
+                           append_failed,
+                           1);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  Stats total = holder.aggregate();
+  EXPECT_EQ(nullptr, total.per_log_stats.find(LOG_GROUP_STATS_IDX_INVALID));
+  int nfound = 0;
+  for (const auto& kv : total.per_log_stats.snapshot()) {
+    if (kv.first.find("/stats_test/") != 0) {
+      continue;
+    }
+    ++nfound;
+    const int i = std::stoi(kv.first.substr(kv.first.rfind('_') + 1));
+    EXPECT_EQ(nthreads * i, kv.second->append_success);
+    EXPECT_EQ(nthreads, kv.second->append_failed);
+  }
+  EXPECT_EQ(nlog_groups, nfound);
+
+  holder.reset();
+  total = holder.aggregate();
+  EXPECT_EQ(nullptr, total.per_log_stats.find(idxs[0]));
+}
+
+// Name-based macros shouldn't assign a handle when there are no stats, and
+// reset() can run while writers are bumping the same log groups.
+TEST(StatsTest, PerLogStatsNullAndConcurrentReset) {
+  StatsHolder* no_stats = nullptr;
+  const size_t nassigned = LogGroupStatsIndex::instance().size();
+  LOG_GROUP_STAT_ADD(no_stats, "/stats_test/no_stats", append_success, 1);
+  LOG_GROUP_CUSTOM_COUNTERS_ADD(
+      no_stats, "/stats_test/no_stats", (std::map<uint8_t, int64_t>{}));
+  EXPECT_EQ(nassigned, LogGroupStatsIndex::instance().size());
+
+  StatsHolder holder(StatsParams().setIsServer(true));
+  const log_group_stats_idx_t idx =
+      LogGroupStatsIndex::instance().getOrAssign("/stats_test/reset");
+  std::atomic<bool> stop{false};
+  std::thread writer([&]() {
+    while (!stop.load()) {
+      LOG_GROUP_IDX_STAT_ADD(&holder, idx, append_success, 1);
+      LOG_GROUP_IDX_CUSTOM_COUNTERS_ADD(
+          &holder, idx, (std::map<uint8_t, int64_t>{{1, 1}}));
+    }
+  });
+  for (int i = 0; i < 1000; ++i) {
+    holder.reset();
+  }
+  stop.store(true);
+  writer.join();
+
+  // Bumps after the resets are kept.
+  LOG_GROUP_IDX_STAT_ADD(&holder, idx, append_success, 1);
+  Stats total = holder.aggregate();
+  PerLogStats* stats = total.per_log_stats.find(idx);
+  ASSERT_NE(nullptr, stats);
+  EXPECT_GE(stats->append_success, 1);
+}
+
 TEST(StatsTest, LatencyPercentileTest) {
   FastUpdateableSharedPtr<StatsParams> params(std::make_shared<StatsParams>());
   Stats s(&params);
@@ -310,6 +401,139 @@ TEST(StatsTest, CompactLatencyHistogramShouldGetCumulativeFrequencyCounters) {
   ASSERT_EQ(expected_result2, frequency_counters2);
 }
 
+TEST(StatsTest, HdrHistogramBuckets) {
+  // Buckets are contiguous, and each value falls into the bucket whose range
+  // contains it.
+  for (size_t i = 0; i < HdrHistogram::NUM_BUCKETS; ++i) {
+    int64_t min = HdrHistogram::bucketMin(i);
+    int64_t width = HdrHistogram::bucketWidth(i);
+    ASSERT_EQ(i, HdrHistogram::bucketIndex(min));
+    ASSERT_EQ(i, HdrHistogram::bucketIndex(min + width - 1));
+    if (i + 1 < HdrHistogram::NUM_BUCKETS) {
+      ASSERT_EQ(min + width, HdrHistogram::bucketMin(i + 1));
+    }
+  }
+  EXPECT_EQ(0, HdrHistogram::bucketIndex(-5));
+  EXPECT_EQ(HdrHistogram::NUM_BUCKETS - 1,
+            HdrHistogram::bucketIndex(std::numeric_limits<int64_t>::max()));
+}
+
+TEST(StatsTest, HdrHistogramPercentiles) {
+  HdrLatencyHistogram h;
+  EXPECT_EQ(0, h.estimatePercentile(.5));
+
+  // 1..100000us, uniformly. Percentiles should be within the 1/32 relative
+  // bucket width of the exact values, including the tail.
+  const int64_t n = 100000;
+  for (int64_t v = 1; v <= n; ++v) {
+    h.add(v);
+  }
+  const double pcts[] = {0., .5, .9, .99, .999, .9999, 1.};
+  constexpr size_t npcts = sizeof(pcts) / sizeof(pcts[0]);
+  int64_t samples[npcts];
+  uint64_t count;
+  int64_t sum;
+  h.estimatePercentiles(pcts, npcts, samples, &count, &sum);
+  EXPECT_EQ(n, count);
+  EXPECT_NEAR(n * (n + 1) / 2, sum, n * (n + 1) / 2 / 32);
+  for (size_t i = 0; i < npcts; ++i) {
+    double expected = std::max(1., pcts[i] * n);
+    EXPECT_NEAR(expected, samples[i], expected / 32) << pcts[i];
+  }
+
+  // Small values are exact.
+  HdrLatencyHistogram small;
+  small.add(7);
+  small.add(7);
+  small.add(42);
+  EXPECT_EQ(7, small.estimatePercentile(.5));
+  EXPECT_EQ(42, small.estimatePercentile(1.));
+  EXPECT_EQ(56, small.getCountAndSum().second);
+}
+
+TEST(StatsTest, HdrHistogramMergeAndSerialize) {
+  folly::ThreadLocalPRNG prng;
+  HdrLatencyHistogram all, a, b;
+  for (int i = 0; i < 10000; ++i) {
+    int64_t v = folly::Random::rand64(1, 1l << 40, prng);
+    all.add(v);
+    (i % 3 ? a : b).add(v);
+  }
+
+  // Merging gives exactly the same histogram as adding all the values.
+  HdrLatencyHistogram merged;
+  merged.merge(a);
+  merged.merge(b);
+  EXPECT_EQ(all.toShortString(), merged.toShortString());
+  EXPECT_EQ(all.estimatePercentile(.9999), merged.estimatePercentile(.9999));
+
+  merged.subtract(b);
+  EXPECT_EQ(a.toShortString(), merged.toShortString());
+
+  // Round trip through the short string form.
+  HdrLatencyHistogram parsed;
+  ASSERT_TRUE(parsed.fromShortString(all.toShortString()));
+  EXPECT_EQ(all.toShortString(), parsed.toShortString());
+  EXPECT_EQ(all.getCountAndSum(), parsed.getCountAndSum());
+
+  HdrLatencyHistogram empty;
+  EXPECT_EQ("", empty.toShortString());
+  EXPECT_TRUE(parsed.fromShortString(""));
+  EXPECT_EQ(0, parsed.getCountAndSum().first);
+
+  EXPECT_FALSE(parsed.fromShortString("1:2,1:3"));
+  EXPECT_FALSE(parsed.fromShortString("1600:1"));
+  EXPECT_FALSE(parsed.fromShortString("1:"));
+  EXPECT_FALSE(parsed.fromShortString("foo"));
+}
+
+TEST(StatsTest, HdrLatencyHistogramShouldGetCumulativeFrequencyCounters) {
+  // Same values and publish range as in the CompactLatencyHistogram test
+  // above; the counters must be the same.
+  CompactLatencyHistogram compact{CompactHistogram::PublishRange{10, 20}};
+  HdrLatencyHistogram hdr{HdrHistogram::PublishRange{10, 20}};
+  HdrLatencyHistogram default_hist;
+
+  for (int64_t idx = 0; idx <= 50; idx++) {
+    for (int times = idx + 1; times > 0; --times) {
+      compact.add((1l << idx) - 1);
+      hdr.add((1l << idx) - 1);
+    }
+  }
+
+  ASSERT_TRUE(hdr.shouldPublishCumulativeFrequencyCounters());
+  ASSERT_FALSE(default_hist.shouldPublishCumulativeFrequencyCounters());
+  ASSERT_EQ(compact.getCumulativeFrequencyCounters().counters,
+            hdr.getCumulativeFrequencyCounters().counters);
+}
+
+TEST(StatsTest, HdrHistogramAggregate) {
+  // Per-thread histograms are merged by StatsHolder::aggregate().
+  StatsHolder holder(StatsParams().setIsServer(false));
+  constexpr int nthreads = 4;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < nthreads; ++t) {
+    threads.emplace_back([&holder, t] {
+      for (int64_t v = 1; v <= 1000; ++v) {
+        CLIENT_HISTOGRAM_ADD(&holder, append_latency, v * (t + 1));
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  HdrLatencyHistogram expected;
+  for (int t = 0; t < nthreads; ++t) {
+    for (int64_t v = 1; v <= 1000; ++v) {
+      expected.add(v * (t + 1));
+    }
+  }
+  Stats total = holder.aggregate();
+  EXPECT_EQ(expected.toShortString(),
+            total.client.histograms->append_latency.toShortString());
+}
+
 TEST(StatsTest, PerNodeTimeSeriesSingleThread) {
   StatsHolder holder(
       StatsParams().setIsServer(false).setNodeStatsRetentionTimeOnClients(
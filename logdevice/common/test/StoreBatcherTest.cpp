@@ -0,0 +1,253 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/StoreBatcher.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "logdevice/common/protocol/STORED_BATCH_Message.h"
+#include "logdevice/common/protocol/STORED_Message.h"
+#include "logdevice/common/protocol/STORE_BATCH_Message.h"
+#include "logdevice/common/protocol/STORE_Message.h"
+
+using namespace facebook::logdevice;
+
+namespace {
+
+const std::string PAYLOAD = "hello";
+
+// Size of a STORE made by makeSTORE(), as StoreBatcher estimates it.
+const size_t STORE_SIZE =
+    sizeof(STORE_Header) + 3 * sizeof(StoreChainLink) + PAYLOAD.size();
+
+std::unique_ptr<STORE_Message> makeSTORE(uint32_t wave,
+                                         STORE_flags_t flags = 0) {
+  STORE_Header header{
+      RecordID(esn_t(wave), epoch_t(1), logid_t(1)),
+      0,            // timestamp
+      ESN_INVALID,  // last_known_good
+      wave,         // wave
+      flags,        // flags
+      0,            // nsync
+      0,            // copyset offset
+      3,            // copyset size
+      0,            // timeout
+      NodeID(0, 1), // sequencer
+  };
+  StoreChainLink copyset[] = {{ShardID(1, 0), ClientID::INVALID},
+                              {ShardID(2, 0), ClientID::INVALID},
+                              {ShardID(3, 0), ClientID::INVALID}};
+  return std::make_unique<STORE_Message>(header,
+                                         copyset,
+                                         0,
+                                         0,
+                                         STORE_Extra(),
+                                         std::map<KeyType, std::string>(),
+                                         PayloadHolder::copyString(PAYLOAD),
+                                         true);
+}
+
+std::unique_ptr<STORED_Message> makeSTORED(uint32_t wave,
+                                           STORED_flags_t flags = 0) {
+  STORED_Header header;
+  header.rid = RecordID(esn_t(wave), epoch_t(1), logid_t(1));
+  header.wave = wave;
+  header.status = E::OK;
+  header.redirect = NodeID();
+  header.flags = flags;
+  header.shard = 0;
+  return std::make_unique<STORED_Message>(header,
+                                          LSN_INVALID,
+                                          0,
+                                          CHUNK_REBUILDING_ID_INVALID,
+                                          FlushToken_INVALID,
+                                          ServerInstanceId_INVALID);
+}
+
+// Records what StoreBatcher sends instead of talking to a Worker.
+class MockStoreBatcher : public StoreBatcher {
+ public:
+  struct Sent {
+    std::unique_ptr<Message> msg;
+    Address to;
+  };
+
+  size_t max_bytes = 1000;
+  bool peer_supports_batches = true;
+  // If not OK, sendMessage() fails with this error.
+  Status send_error = E::OK;
+
+  std::vector<Sent> sent;
+  // (wave, status) of STOREs reported as not sent.
+  std::vector<std::pair<uint32_t, Status>> not_sent;
+  int timer_activations = 0;
+
+  // Number of STOREs in sent[i], 1 for a plain STORE.
+  size_t numSTOREs(size_t i) {
+    Message& msg = *sent.at(i).msg;
+    if (msg.type_ == MessageType::STORE) {
+      return 1;
+    }
+    EXPECT_EQ(MessageType::STORE_BATCH, msg.type_);
+    return static_cast<STORE_BATCH_Message&>(msg).getStores().size();
+  }
+
+ protected:
+  size_t maxBatchBytes() const override {
+    return max_bytes;
+  }
+  bool peerSupportsBatches(const Address& /* to */) const override {
+    return peer_supports_batches;
+  }
+  int sendMessage(std::unique_ptr<Message>& msg, const Address& to) override {
+    if (send_error != E::OK) {
+      err = send_error;
+      return -1;
+    }
+    sent.push_back(Sent{std::move(msg), to});
+    return 0;
+  }
+  void onSTORENotSent(const STORE_Message& msg,
+                      Status st,
+                      const Address& /* to */) override {
+    not_sent.emplace_back(msg.getHeader().wave, st);
+  }
+  void activateFlushTimer() override {
+    ++timer_activations;
+  }
+};
+
+} // namespace
+
+TEST(StoreBatcherTest, GroupsSTOREsPerNode) {
+  MockStoreBatcher batcher;
+  for (uint32_t wave = 1; wave <= 3; ++wave) {
+    auto msg = makeSTORE(wave);
+    ASSERT_TRUE(batcher.addSTORE(msg, NodeID(1, 1)));
+    EXPECT_EQ(nullptr, msg);
+  }
+  auto msg = makeSTORE(4);
+  ASSERT_TRUE(batcher.addSTORE(msg, NodeID(2, 1)));
+  EXPECT_EQ(4, batcher.timer_activations);
+  EXPECT_TRUE(batcher.sent.empty());
+
+  batcher.flush();
+  ASSERT_EQ(2, batcher.sent.size());
+  for (size_t i = 0; i < batcher.sent.size(); ++i) {
+    if (batcher.sent[i].to.asNodeID().index() == 1) {
+      // Three STOREs for N1 go out as one batch, in the order they were
+      // added.
+      ASSERT_EQ(3, batcher.numSTOREs(i));
+      auto& stores =
+          static_cast<STORE_BATCH_Message&>(*batcher.sent[i].msg).getStores();
+      for (uint32_t wave = 1; wave <= 3; ++wave) {
+        EXPECT_EQ(wave, stores[wave - 1]->getHeader().wave);
+      }
+    } else {
+      // A lone STORE for N2 is sent as is.
+      EXPECT_EQ(2, batcher.sent[i].to.asNodeID().index());
+      EXPECT_EQ(MessageType::STORE, batcher.sent[i].msg->type_);
+    }
+  }
+  EXPECT_TRUE(batcher.not_sent.empty());
+
+  // Nothing is left to send.
+  batcher.sent.clear();
+  batcher.flush();
+  EXPECT_TRUE(batcher.sent.empty());
+}
+
+TEST(StoreBatcherTest, SplitsBatchesAtMaxBytes) {
+  MockStoreBatcher batcher;
+  // Two STOREs fit in a batch, three don't.
+  batcher.max_bytes = STORE_SIZE * 5 / 2;
+  for (uint32_t wave = 1; wave <= 5; ++wave) {
+    auto msg = makeSTORE(wave);
+    ASSERT_TRUE(batcher.addSTORE(msg, NodeID(1, 1)));
+  }
+  batcher.flush();
+  ASSERT_EQ(3, batcher.sent.size());
+  EXPECT_EQ(2, batcher.numSTOREs(0));
+  EXPECT_EQ(2, batcher.numSTOREs(1));
+  EXPECT_EQ(1, batcher.numSTOREs(2));
+  EXPECT_EQ(MessageType::STORE, batcher.sent[2].msg->type_);
+}
+
+TEST(StoreBatcherTest, STOREsSentOnTheirOwn) {
+  MockStoreBatcher batcher;
+
+  // Batching disabled.
+  batcher.max_bytes = 0;
+  auto msg = makeSTORE(1);
+  EXPECT_FALSE(batcher.addSTORE(msg, NodeID(1, 1)));
+  EXPECT_NE(nullptr, msg);
+
+  // STORE too large to share a batch.
+  batcher.max_bytes = STORE_SIZE * 3 / 2;
+  EXPECT_FALSE(batcher.addSTORE(msg, NodeID(1, 1)));
+  EXPECT_NE(nullptr, msg);
+
+  // Peer doesn't support STORE_BATCH.
+  batcher.max_bytes = 1000;
+  batcher.peer_supports_batches = false;
+  EXPECT_FALSE(batcher.addSTORE(msg, NodeID(1, 1)));
+  EXPECT_NE(nullptr, msg);
+
+  // Rebuilding STOREs aren't batched.
+  batcher.peer_supports_batches = true;
+  auto rebuilding_msg = makeSTORE(2, STORE_Header::REBUILDING);
+  EXPECT_FALSE(batcher.addSTORE(rebuilding_msg, NodeID(1, 1)));
+  EXPECT_NE(nullptr, rebuilding_msg);
+
+  EXPECT_EQ(0, batcher.timer_activations);
+  batcher.flush();
+  EXPECT_TRUE(batcher.sent.empty());
+}
+
+TEST(StoreBatcherTest, FailureIsReportedForEverySTORE) {
+  MockStoreBatcher batcher;
+  // Two STOREs fit in a batch, so the third one is sent on its own.
+  batcher.max_bytes = STORE_SIZE * 5 / 2;
+  for (uint32_t wave = 1; wave <= 3; ++wave) {
+    auto msg = makeSTORE(wave);
+    ASSERT_TRUE(batcher.addSTORE(msg, NodeID(1, 1)));
+  }
+  batcher.send_error = E::NOBUFS;
+  batcher.flush();
+  EXPECT_TRUE(batcher.sent.empty());
+  using Item = std::pair<uint32_t, Status>;
+  EXPECT_EQ(std::vector<Item>({{1, E::NOBUFS}, {2, E::NOBUFS}, {3, E::NOBUFS}}),
+            batcher.not_sent);
+}
+
+TEST(StoreBatcherTest, GroupsSTOREDsPerClient) {
+  MockStoreBatcher batcher;
+  for (uint32_t wave = 1; wave <= 2; ++wave) {
+    auto msg = makeSTORED(wave);
+    ASSERT_TRUE(batcher.addSTORED(msg, ClientID(7)));
+  }
+  // Replies to rebuilding STOREs aren't batched.
+  auto rebuilding_msg = makeSTORED(3, STORED_Header::REBUILDING);
+  EXPECT_FALSE(batcher.addSTORED(rebuilding_msg, ClientID(7)));
+  EXPECT_NE(nullptr, rebuilding_msg);
+
+  batcher.flush();
+  ASSERT_EQ(1, batcher.sent.size());
+  EXPECT_EQ(ClientID(7), batcher.sent[0].to.asClientID());
+  ASSERT_EQ(MessageType::STORED_BATCH, batcher.sent[0].msg->type_);
+  auto& replies =
+      static_cast<STORED_BATCH_Message&>(*batcher.sent[0].msg).getReplies();
+  ASSERT_EQ(2, replies.size());
+  EXPECT_EQ(1, replies[0]->header_.wave);
+  EXPECT_EQ(2, replies[1]->header_.wave);
+}
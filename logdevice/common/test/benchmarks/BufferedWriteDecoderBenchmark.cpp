@@ -0,0 +1,145 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/Random.h>
+#include <folly/Singleton.h>
+#include <folly/io/IOBuf.h>
+#include <gflags/gflags.h>
+
+#include "logdevice/common/buffered_writer/BufferedWriteCodec.h"
+
+using namespace facebook::logdevice;
+
+/**
+ * @file: Decoding throughput of BufferedWriter batches that arrive as IOBuf
+ *        chains (as records read from the network do), with the copying
+ *        path (coalesce the chain, decode from a Slice without sharing) and
+ *        the zero-copy path (decode the chain directly, sharing its buffers).
+ *        Each run reports the uncompressed payload KiB it decoded as its
+ *        iteration count, so the iters/s column is decoded KiB/s.
+ */
+
+namespace {
+
+constexpr size_t kPayloadSize = 100;
+// Size of buffers the encoded batch is split into.
+constexpr size_t kChainBufferSize = 4096;
+
+struct Batch {
+  folly::IOBuf chain;
+  size_t payload_bytes = 0;
+};
+
+Batch makeBatch(Compression compression, size_t npayloads) {
+  std::vector<std::string> payloads;
+  BufferedWriteCodec::Estimator estimator;
+  for (size_t i = 0; i < npayloads; ++i) {
+    // Half random, half constant so that compression has something to do.
+    std::string payload(kPayloadSize, 'x');
+    for (size_t j = 0; j < kPayloadSize / 2; ++j) {
+      payload[j] = 'a' + folly::Random::rand32(26);
+    }
+    estimator.append(
+        folly::IOBuf::wrapBufferAsValue(payload.data(), payload.size()));
+    payloads.push_back(std::move(payload));
+  }
+
+  BufferedWriteCodec::Encoder<BufferedWriteSinglePayloadsCodec::Encoder>
+      encoder(0, npayloads, estimator.calculateSize(0));
+  for (const auto& payload : payloads) {
+    encoder.append(
+        folly::IOBuf::wrapBufferAsValue(payload.data(), payload.size()));
+  }
+  folly::IOBufQueue queue;
+  encoder.encode(queue, compression, /* zstd_level */ 5);
+  folly::IOBuf encoded = queue.moveAsValue();
+  encoded.coalesce();
+
+  Batch batch;
+  batch.payload_bytes = npayloads * kPayloadSize;
+  folly::IOBufQueue chain;
+  for (size_t off = 0; off < encoded.length(); off += kChainBufferSize) {
+    chain.append(folly::IOBuf::copyBuffer(
+        encoded.data() + off,
+        std::min(kChainBufferSize, encoded.length() - off)));
+  }
+  batch.chain = chain.moveAsValue();
+  return batch;
+}
+
+// BENCHMARK_MULTI functions return the iteration count as unsigned. Counting
+// bytes would overflow it for large runs, so count KiB, computed in 64 bits.
+unsigned decodedKiB(unsigned n, const Batch& batch) {
+  return static_cast<unsigned>(uint64_t(n) * batch.payload_bytes / 1024);
+}
+
+unsigned decodeCopying(unsigned n, Compression compression, size_t npayloads) {
+  Batch batch;
+  BENCHMARK_SUSPEND {
+    batch = makeBatch(compression, npayloads);
+  }
+  std::vector<PayloadGroup> payloads;
+  for (unsigned i = 0; i < n; ++i) {
+    payloads.clear();
+    const folly::IOBuf contiguous = batch.chain.cloneCoalescedAsValue();
+    size_t rv = BufferedWriteCodec::decode(
+        Slice(contiguous.data(), contiguous.length()),
+        payloads,
+        /* allow_buffer_sharing */ false);
+    folly::doNotOptimizeAway(rv);
+  }
+  return decodedKiB(n, batch);
+}
+
+unsigned decodeZeroCopy(unsigned n, Compression compression, size_t npayloads) {
+  Batch batch;
+  BENCHMARK_SUSPEND {
+    batch = makeBatch(compression, npayloads);
+  }
+  std::vector<PayloadGroup> payloads;
+  for (unsigned i = 0; i < n; ++i) {
+    payloads.clear();
+    size_t rv = BufferedWriteCodec::decode(
+        batch.chain, payloads, /* allow_buffer_sharing */ false);
+    folly::doNotOptimizeAway(rv);
+  }
+  return decodedKiB(n, batch);
+}
+
+} // namespace
+
+#define DECODE_BENCHMARKS(name, compression, npayloads)                \
+  BENCHMARK_NAMED_PARAM_MULTI(                                         \
+      decodeCopying, name, Compression::compression, npayloads)        \
+  BENCHMARK_RELATIVE_NAMED_PARAM_MULTI(                                \
+      decodeZeroCopy, name, Compression::compression, npayloads)       \
+  BENCHMARK_DRAW_LINE();
+
+DECODE_BENCHMARKS(none_10, NONE, 10)
+DECODE_BENCHMARKS(none_100, NONE, 100)
+DECODE_BENCHMARKS(none_1000, NONE, 1000)
+DECODE_BENCHMARKS(zstd_10, ZSTD, 10)
+DECODE_BENCHMARKS(zstd_100, ZSTD, 100)
+DECODE_BENCHMARKS(zstd_1000, ZSTD, 1000)
+DECODE_BENCHMARKS(lz4_10, LZ4, 10)
+DECODE_BENCHMARKS(lz4_100, LZ4, 100)
+DECODE_BENCHMARKS(lz4_1000, LZ4, 1000)
+
+#ifndef BENCHMARK_BUNDLE
+int main(int argc, char** argv) {
+  folly::SingletonVault::singleton()->registrationComplete();
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
+#endif
@@ -0,0 +1,330 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/Random.h>
+#include <folly/Singleton.h>
+#include <gflags/gflags.h>
+
+#include "logdevice/common/client_read_stream/ClientReadStream.h"
+#include "logdevice/common/client_read_stream/ClientReadStreamBufferBudget.h"
+#include "logdevice/common/client_read_stream/ClientReadStreamBufferFactory.h"
+#include "logdevice/common/configuration/Configuration.h"
+#include "logdevice/common/configuration/LocalLogsConfig.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/common/protocol/STARTED_Message.h"
+#include "logdevice/common/test/ClientReadStreamTest_fixtures.h"
+#include "logdevice/common/test/MockTimer.h"
+#include "logdevice/common/test/NodesConfigurationTestUtil.h"
+
+using namespace facebook::logdevice;
+
+/**
+ * @file Memory and throughput of many concurrent ClientReadStreams with fixed
+ *       windows of --buffer_size records in a circular buffer (the default),
+ *       and with windows drawn from a ClientReadStreamBufferBudget in an
+ *       ordered map buffer.
+ *
+ *       The read streams are real ones, driven through the harness of
+ *       ClientReadStreamTest. Each reads from a single storage shard, which
+ *       in each round sends every record of the log that fits in the last
+ *       window the stream gave it. --hot_streams streams read a backlog and
+ *       their application consumes up to --consume_per_round records per
+ *       round, rejecting the rest until the next round; the others tail
+ *       their log, which gets a new record once every --tail_append_one_in
+ *       rounds. Windows are re-evaluated by the read stream's own timer,
+ *       which is fired every round and uses the real clock, so idle windows
+ *       only shrink in runs longer than WINDOW_TARGET_DURATION.
+ *
+ *       Counters: records delivered per round, peak bytes buffered by all
+ *       streams, in KB, and peak sum of the windows given to storage
+ *       shards, in records.
+ */
+
+DEFINE_int32(num_streams, 1000, "Number of concurrent read streams.");
+DEFINE_int32(hot_streams, 10, "Streams reading a backlog.");
+DEFINE_int32(buffer_size, 512, "Per-stream buffer size, in records.");
+DEFINE_int32(consume_per_round,
+             256,
+             "Records the application of a hot stream consumes per round.");
+DEFINE_int32(tail_append_one_in,
+             100,
+             "Logs of tailing streams get a record once every this many "
+             "rounds.");
+DEFINE_int32(payload_size, 1024, "Payload size of records.");
+DEFINE_int64(budget_records, 100000, "Record budget of all streams.");
+DEFINE_int64(budget_bytes, 256 << 20, "Byte budget of all streams.");
+
+namespace {
+
+constexpr double kFlowControlThreshold = 0.7;
+const ShardID kShard(0, 0);
+
+/**
+ * The rest of the client, as seen by one read stream: the application, which
+ * consumes a quota of records per round, and the connection to the storage
+ * shard, which remembers the window the stream gave it.
+ */
+class BenchmarkDependencies : public MockClientReadStreamDependencies {
+ public:
+  explicit BenchmarkDependencies(TestState* state)
+      : MockClientReadStreamDependencies(state) {}
+
+  bool recordCallback(std::unique_ptr<DataRecord>& /*record*/) override {
+    if (quota_ == 0) {
+      return false;
+    }
+    --quota_;
+    ++delivered_;
+    return true;
+  }
+
+  bool gapCallback(const GapRecord& /*gap*/) override {
+    return true;
+  }
+
+  void recordCopyCallback(ShardID /*from*/,
+                          const RawDataRecord* /*record*/) override {}
+
+  int sendStartMessage(ShardID /*shard*/,
+                       SocketCallback* /*onclose*/,
+                       START_Header header,
+                       const small_shardset_t& /*filtered_out*/,
+                       const ReadStreamAttributes* /*attrs*/) override {
+    window_high_ = header.window_high;
+    return 0;
+  }
+
+  int sendWindowMessage(ShardID /*shard*/,
+                        lsn_t /*window_low*/,
+                        lsn_t window_high) override {
+    window_high_ = window_high;
+    return 0;
+  }
+
+  std::unique_ptr<Timer>
+  createTimer(std::function<void()> cb = nullptr) override {
+    auto timer = std::make_unique<MockTimer>(std::move(cb));
+    timers_.push_back(timer.get());
+    return timer;
+  }
+
+  void setQuota(size_t quota) {
+    quota_ = quota;
+  }
+
+  // Fires the timers of the read stream that are due, i.e. all active ones.
+  void fireTimers() {
+    for (MockTimer* timer : timers_) {
+      if (timer->isActive()) {
+        timer->trigger();
+      }
+    }
+  }
+
+  lsn_t windowHigh() const {
+    return window_high_;
+  }
+
+  size_t delivered() const {
+    return delivered_;
+  }
+
+ private:
+  size_t quota_{0};
+  size_t delivered_{0};
+  lsn_t window_high_{LSN_INVALID};
+  // Owned by the read stream.
+  std::vector<MockTimer*> timers_;
+};
+
+struct Stream {
+  TestState state;
+  // Owned by read_stream.
+  BenchmarkDependencies* deps;
+  std::unique_ptr<ClientReadStream> read_stream;
+  bool hot;
+  // next record the storage shard sends
+  lsn_t next_lsn_to_send;
+  // last record of the log
+  lsn_t tail;
+};
+
+class Simulation {
+ public:
+  explicit Simulation(ClientReadStreamBufferBudget* budget)
+      : budget_(budget), payload_(FLAGS_payload_size, 'x') {
+    auto config = makeConfig();
+    const EpochMetaData metadata(
+        {kShard},
+        ReplicationProperty(1, NodeLocationScope::NODE),
+        EPOCH_MIN,
+        EPOCH_MIN);
+    const lsn_t start_lsn = compose_lsn(EPOCH_MIN, ESN_MIN);
+    for (int i = 0; i < FLAGS_num_streams; ++i) {
+      auto s = std::make_unique<Stream>();
+      s->state.shards = {kShard};
+      s->state.config = config;
+      s->state.default_metadata = metadata;
+      s->hot = i < FLAGS_hot_streams;
+      s->next_lsn_to_send = start_lsn;
+      s->tail = s->hot ? compose_lsn(EPOCH_MIN, ESN_MAX) : start_lsn - 1;
+
+      auto deps = std::make_unique<BenchmarkDependencies>(&s->state);
+      s->deps = deps.get();
+      deps->setBufferBudget(budget_);
+      const read_stream_id_t rsid(i + 1);
+      s->read_stream = std::make_unique<ClientReadStream>(
+          rsid,
+          LOG_ID,
+          start_lsn,
+          LSN_MAX,
+          kFlowControlThreshold,
+          budget_ ? ClientReadStreamBufferType::ORDERED_MAP
+                  : ClientReadStreamBufferType::CIRCULAR,
+          FLAGS_buffer_size,
+          std::move(deps),
+          config);
+      s->deps->setClientReadStream(s->read_stream.get());
+      s->read_stream->start();
+      s->read_stream->onStartSent(kShard, E::OK);
+      STARTED_Header header = {
+          LOG_ID, rsid, E::OK, filter_version_t{1}, LSN_INVALID, 0};
+      s->read_stream->onStarted(
+          kShard, STARTED_Message(header, TrafficClass::READ_BACKLOG));
+      streams_.push_back(std::move(s));
+    }
+  }
+
+  void runRound() {
+    for (auto& s : streams_) {
+      if (!s->hot && folly::Random::oneIn(FLAGS_tail_append_one_in)) {
+        ++s->tail;
+      }
+      s->deps->setQuota(s->hot ? FLAGS_consume_per_round
+                               : std::numeric_limits<size_t>::max());
+      // Deliver the records the application rejected last round.
+      s->read_stream->resumeReading();
+      const lsn_t last = std::min(s->deps->windowHigh(), s->tail);
+      for (; s->next_lsn_to_send <= last; ++s->next_lsn_to_send) {
+        s->read_stream->onDataRecord(
+            kShard,
+            std::make_unique<RawDataRecord>(LOG_ID,
+                                            PayloadHolder::copyString(payload_),
+                                            s->next_lsn_to_send,
+                                            std::chrono::milliseconds{0},
+                                            0 /* flags */));
+      }
+      s->deps->fireTimers();
+    }
+    BENCHMARK_SUSPEND {
+      size_t bytes = 0;
+      size_t windows = 0;
+      for (const auto& s : streams_) {
+        bytes += s->read_stream->getBytesBuffered();
+        windows +=
+            s->deps->windowHigh() - s->read_stream->getNextLSNToDeliver() + 1;
+      }
+      peak_bytes_ = std::max(peak_bytes_, bytes);
+      peak_windows_ = std::max(peak_windows_, windows);
+    }
+  }
+
+  size_t delivered() const {
+    size_t res = 0;
+    for (const auto& s : streams_) {
+      res += s->deps->delivered();
+    }
+    return res;
+  }
+
+  size_t peakBytes() const {
+    return peak_bytes_;
+  }
+
+  size_t peakWindows() const {
+    return peak_windows_;
+  }
+
+ private:
+  static std::shared_ptr<UpdateableConfig> makeConfig() {
+    auto config = std::make_shared<UpdateableConfig>();
+    configuration::Nodes nodes;
+    nodes[kShard.node()] =
+        configuration::Node::withTestDefaults(kShard.node());
+    auto nodes_configuration = NodesConfigurationTestUtil::provisionNodes(
+        std::move(nodes), ReplicationProperty{{NodeLocationScope::NODE, 1}});
+    auto logs_config = std::make_shared<configuration::LocalLogsConfig>();
+    logs_config->insert(boost::icl::right_open_interval<logid_t::raw_type>(
+                            LOG_ID.val_, LOG_ID.val_ + 1),
+                        "log",
+                        logsconfig::LogAttributes().with_replicationFactor(1));
+    config->updateableServerConfig()->update(
+        ServerConfig::fromDataTest("ClientReadStreamBufferBudgetBenchmark"));
+    config->updateableNodesConfiguration()->update(
+        std::move(nodes_configuration));
+    config->updateableLogsConfig()->update(std::move(logs_config));
+    return config;
+  }
+
+  ClientReadStreamBufferBudget* const budget_;
+  const std::string payload_;
+  std::vector<std::unique_ptr<Stream>> streams_;
+  size_t peak_bytes_{0};
+  size_t peak_windows_{0};
+};
+
+void runSimulation(folly::UserCounters& counters, int n, bool with_budget) {
+  std::unique_ptr<ClientReadStreamBufferBudget> budget;
+  std::unique_ptr<Simulation> sim;
+  BENCHMARK_SUSPEND {
+    dbg::currentLevel = dbg::Level::ERROR;
+    if (with_budget) {
+      budget = std::make_unique<ClientReadStreamBufferBudget>(
+          FLAGS_budget_records, FLAGS_budget_bytes);
+    }
+    sim = std::make_unique<Simulation>(budget.get());
+  }
+
+  for (int i = 0; i < n; ++i) {
+    sim->runRound();
+  }
+
+  counters["records_per_round"] = sim->delivered() / std::max(n, 1);
+  counters["peak_buffered_kb"] = sim->peakBytes() / 1024;
+  counters["peak_window_records"] = sim->peakWindows();
+  BENCHMARK_SUSPEND {
+    // Read streams return their windows and bytes to the budget.
+    sim.reset();
+  }
+}
+
+} // namespace
+
+BENCHMARK_COUNTERS(FixedWindows, counters, n) {
+  runSimulation(counters, n, false);
+}
+
+BENCHMARK_COUNTERS(BudgetedWindows, counters, n) {
+  runSimulation(counters, n, true);
+}
+
+#ifndef BENCHMARK_BUNDLE
+int main(int argc, char** argv) {
+  folly::SingletonVault::singleton()->registrationComplete();
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
+#endif
@@ -0,0 +1,199 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/Random.h>
+#include <folly/SharedMutex.h>
+#include <folly/Singleton.h>
+#include <folly/container/EvictingCacheMap.h>
+#include <folly/hash/Hash.h>
+#include <gflags/gflags.h>
+
+#include "logdevice/common/EpochMetaDataCache.h"
+
+using namespace facebook::logdevice;
+
+/**
+ * @file Benchmark of EpochMetaDataCache lookups from many threads, the way
+ *       ClientReadStreams on all workers of a client share it, against the
+ *       previous implementation: a single lock around an exact-key LRU map,
+ *       where every hit takes the lock exclusively to promote the entry.
+ *
+ *       Each log has --intervals_per_log metadata intervals of
+ *       --epochs_per_interval epochs. Streams look up random epochs, so the
+ *       exact-key cache only hits when it was filled with that very epoch;
+ *       the "Starts" variants only request interval starts to compare lookup
+ *       cost alone. 1% of the lookups are followed by a setMetaData() as a
+ *       stream that missed would do.
+ *
+ *       Run with --bm_min_usec=1000000.
+ */
+
+DEFINE_int32(num_logs, 10000, "Number of logs in the cache.");
+DEFINE_int32(intervals_per_log, 4, "Metadata intervals per log.");
+DEFINE_int32(epochs_per_interval, 100, "Epochs in each metadata interval.");
+
+namespace {
+
+using RecordSource = MetaDataLogReader::RecordSource;
+
+// The implementation EpochMetaDataCache had before it became interval-aware
+// and sharded.
+class ExactKeyEpochMetaDataCache {
+ public:
+  explicit ExactKeyEpochMetaDataCache(size_t max_entries)
+      : cache_(max_entries) {}
+
+  bool getMetaData(logid_t logid,
+                   epoch_t epoch,
+                   epoch_t* until_out,
+                   EpochMetaData* metadata_out,
+                   RecordSource* source_out,
+                   bool /* require_consistent */ = true) {
+    folly::SharedMutex::WriteHolder write_guard(cache_mutex_);
+    auto it = cache_.find(std::make_pair(logid, epoch));
+    if (it == cache_.end()) {
+      return false;
+    }
+    *until_out = it->second.until;
+    *source_out = it->second.source;
+    *metadata_out = it->second.metadata;
+    return true;
+  }
+
+  void setMetaData(logid_t logid,
+                   epoch_t epoch,
+                   epoch_t until,
+                   RecordSource source,
+                   const EpochMetaData& metadata) {
+    folly::SharedMutex::WriteHolder write_guard(cache_mutex_);
+    cache_.set(std::make_pair(logid, epoch), {until, source, metadata});
+  }
+
+ private:
+  using Key = std::pair<logid_t, epoch_t>;
+
+  struct KeyHasher {
+    size_t operator()(const Key& key) const {
+      return folly::hash::hash_combine(key.first.val_, key.second.val_);
+    }
+  };
+
+  struct Value {
+    epoch_t until;
+    RecordSource source;
+    EpochMetaData metadata;
+  };
+
+  folly::EvictingCacheMap<Key, Value, KeyHasher> cache_;
+  folly::SharedMutex cache_mutex_;
+};
+
+EpochMetaData genEpochMetaData(epoch_t epoch) {
+  EpochMetaData m(
+      StorageSet{ShardID(1, 0), ShardID(2, 0), ShardID(3, 0), ShardID(4, 0)},
+      ReplicationProperty(3, NodeLocationScope::NODE));
+  m.h.epoch = m.h.effective_since = epoch;
+  return m;
+}
+
+template <typename Cache>
+std::unique_ptr<Cache> makeCache() {
+  const size_t entries = FLAGS_num_logs * FLAGS_intervals_per_log;
+  auto cache = std::make_unique<Cache>(entries);
+  for (int log = 1; log <= FLAGS_num_logs; ++log) {
+    for (int i = 0; i < FLAGS_intervals_per_log; ++i) {
+      const epoch_t start(1 + i * FLAGS_epochs_per_interval);
+      const epoch_t until(start.val_ + FLAGS_epochs_per_interval - 1);
+      cache->setMetaData(logid_t(log),
+                         start,
+                         until,
+                         RecordSource::CACHED_CONSISTENT,
+                         genEpochMetaData(start));
+    }
+  }
+  return cache;
+}
+
+template <typename Cache>
+void benchLookups(int n, int num_threads, bool starts_only) {
+  std::unique_ptr<Cache> cache;
+  BENCHMARK_SUSPEND {
+    cache = makeCache<Cache>();
+  }
+
+  std::atomic<uint64_t> hits{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&] {
+      EpochMetaData metadata;
+      epoch_t until;
+      RecordSource source;
+      uint64_t local_hits = 0;
+      for (int i = 0; i < n / num_threads; ++i) {
+        const logid_t log(folly::Random::rand32(FLAGS_num_logs) + 1);
+        const uint32_t interval =
+            folly::Random::rand32(FLAGS_intervals_per_log);
+        const uint32_t offset = starts_only
+            ? 0
+            : folly::Random::rand32(FLAGS_epochs_per_interval);
+        const epoch_t epoch(1 + interval * FLAGS_epochs_per_interval + offset);
+        if (cache->getMetaData(log, epoch, &until, &metadata, &source)) {
+          ++local_hits;
+        } else if (folly::Random::oneIn(100)) {
+          cache->setMetaData(log,
+                             epoch,
+                             epoch,
+                             RecordSource::CACHED_CONSISTENT,
+                             genEpochMetaData(epoch));
+        }
+        folly::doNotOptimizeAway(metadata);
+      }
+      hits += local_hits;
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  folly::doNotOptimizeAway(hits.load());
+}
+
+} // namespace
+
+#define CACHE_BENCHMARKS(threads)                                          \
+  BENCHMARK(ExactKey_##threads##Threads, n) {                              \
+    benchLookups<ExactKeyEpochMetaDataCache>(n, threads, false);           \
+  }                                                                        \
+  BENCHMARK_RELATIVE(Interval_##threads##Threads, n) {                     \
+    benchLookups<EpochMetaDataCache>(n, threads, false);                   \
+  }                                                                        \
+  BENCHMARK(ExactKeyStarts_##threads##Threads, n) {                        \
+    benchLookups<ExactKeyEpochMetaDataCache>(n, threads, true);            \
+  }                                                                        \
+  BENCHMARK_RELATIVE(IntervalStarts_##threads##Threads, n) {               \
+    benchLookups<EpochMetaDataCache>(n, threads, true);                    \
+  }                                                                        \
+  BENCHMARK_DRAW_LINE();
+
+CACHE_BENCHMARKS(1)
+CACHE_BENCHMARKS(4)
+CACHE_BENCHMARKS(16)
+CACHE_BENCHMARKS(64)
+
+#ifndef BENCHMARK_BUNDLE
+int main(int argc, char** argv) {
+  folly::SingletonVault::singleton()->registrationComplete();
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
+#endif
@@ -7,6 +7,7 @@
  */
 #include <atomic>
 #include <chrono>
+#include <random>
 #include <thread>
 #include <vector>
 
@@ -25,21 +26,38 @@ DEFINE_int32(num_log_groups,
              500000,
              "Number of log groups in the logs config tree");
 
+DEFINE_int32(directories_per_parent,
+             500,
+             "The directories are grouped in parent directories of this many "
+             "directories each, under the root");
+
 using namespace facebook::logdevice;
 using namespace facebook::logdevice::logsconfig;
 
+static int logGroupsPerDirectory() {
+  return FLAGS_num_log_groups / FLAGS_num_directories;
+}
+
+// Path of directory i (starting from 1).
+static std::string directoryPath(int i) {
+  return folly::sformat(
+      "/parent{}/dir{}", 1 + (i - 1) / FLAGS_directories_per_parent, i);
+}
+
+// Log group j of directory i (both starting from 1) contains the single log
+// (i - 1) * logGroupsPerDirectory() + j.
 std::unique_ptr<LogsConfigTree> createTestTree() {
   std::unique_ptr<LogsConfigTree> tree = LogsConfigTree::create();
   auto defaults = DefaultLogAttributes().with_replicationFactor(3);
   for (int i = 1; i <= FLAGS_num_directories; i++) {
-    auto dir =
-        tree->addDirectory(tree->root(), "dir" + std::to_string(i), defaults);
+    auto dir = tree->addDirectory(directoryPath(i), true, defaults);
     // We want to distribute the log-groups as evenly as possible over the
     // directories.
-    for (int j = 1; j <= (FLAGS_num_log_groups / FLAGS_num_directories); j++) {
+    for (int j = 1; j <= logGroupsPerDirectory(); j++) {
+      logid_t logid((i - 1) * logGroupsPerDirectory() + j);
       tree->addLogGroup(dir,
                         "log-" + std::to_string(j),
-                        logid_range_t{logid_t(j), logid_t(j)},
+                        logid_range_t{logid, logid},
                         LogAttributes(),
                         false);
     }
@@ -74,7 +92,7 @@ BENCHMARK(LogsConfigTreeAdd, n) {
 BENCHMARK(LogsConfigTreeFindDir, n) {
   folly::BenchmarkSuspender benchmark_suspender;
   std::unique_ptr<LogsConfigTree> tree = createTestTree();
-  std::string dirname1 = folly::sformat("/dir{}", FLAGS_num_directories / 2);
+  std::string dirname1 = directoryPath(FLAGS_num_directories / 2);
   benchmark_suspender.dismiss();
 
   for (int i = 1; i <= n; i++) {
@@ -82,6 +100,63 @@ BENCHMARK(LogsConfigTreeFindDir, n) {
   }
 }
 
+// Lookups of random log ids in a published tree, i.e. a copy of the tree
+// maintained by LogsConfigStateMachine.
+BENCHMARK(LogsConfigTreeLookup, n) {
+  folly::BenchmarkSuspender benchmark_suspender;
+  std::unique_ptr<LogsConfigTree> tree = createTestTree()->copy();
+  const int num_logs = FLAGS_num_directories * logGroupsPerDirectory();
+  std::mt19937 rnd(0xbe4c);
+  std::vector<logid_t> logids;
+  for (int i = 0; i < 1024; i++) {
+    logids.push_back(logid_t(1 + rnd() % num_logs));
+  }
+  benchmark_suspender.dismiss();
+
+  for (int i = 1; i <= n; i++) {
+    folly::doNotOptimizeAway(tree->getLogGroupByID(logids[i % logids.size()]));
+  }
+}
+
+// Applying a delta that changes the attributes of a log group, then
+// publishing the result, as LogsConfigStateMachine and LogsConfigManager do,
+// and looking up a log in the published tree.
+BENCHMARK(LogsConfigTreeDeltaApply, n) {
+  folly::BenchmarkSuspender benchmark_suspender;
+  std::unique_ptr<LogsConfigTree> tree = createTestTree();
+  const int num_directories = FLAGS_num_directories;
+  benchmark_suspender.dismiss();
+
+  for (int i = 1; i <= n; i++) {
+    std::string path = folly::sformat("{}/log-{}",
+                                      directoryPath(1 + i % num_directories),
+                                      1 + i % logGroupsPerDirectory());
+    tree->setAttributes(
+        path, LogAttributes().with_replicationFactor(2 + i % 2));
+    std::unique_ptr<LogsConfigTree> published = tree->copy();
+    folly::doNotOptimizeAway(published->getLogGroupByID(logid_t(1)));
+  }
+}
+
+// Applying a delta that changes the attributes of a log group, then looking
+// up a log in the same tree, as LogsConfigManager does when serving log group
+// requests from the tree of LogsConfigStateMachine.
+BENCHMARK(LogsConfigTreeDeltaApplyAndLookup, n) {
+  folly::BenchmarkSuspender benchmark_suspender;
+  std::unique_ptr<LogsConfigTree> tree = createTestTree();
+  const int num_directories = FLAGS_num_directories;
+  benchmark_suspender.dismiss();
+
+  for (int i = 1; i <= n; i++) {
+    std::string path = folly::sformat("{}/log-{}",
+                                      directoryPath(1 + i % num_directories),
+                                      1 + i % logGroupsPerDirectory());
+    tree->setAttributes(
+        path, LogAttributes().with_replicationFactor(2 + i % 2));
+    folly::doNotOptimizeAway(tree->getLogGroupByID(logid_t(1)));
+  }
+}
+
 #ifndef BENCHMARK_BUNDLE
 
 int main(int argc, char** argv) {
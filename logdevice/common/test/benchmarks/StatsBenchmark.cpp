@@ -5,10 +5,12 @@
  * This source code is licensed under the BSD-style license found in the
  * LICENSE file in the root directory of this source tree.
  */
+#include <array>
 #include <atomic>
 #include <condition_variable>
 #include <functional>
 #include <mutex>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -17,6 +19,7 @@
 #include <folly/synchronization/Baton.h>
 #include <gflags/gflags.h>
 
+#include "logdevice/common/stats/Histogram.h"
 #include "logdevice/common/stats/Stats.h"
 #include "logdevice/common/test/TestUtil.h"
 
@@ -179,6 +182,136 @@ BENCHMARK(BM_stats_aggregate, iters) {
       });
 }
 
+// Per-log-group stats bumped on the append path (a counter and a time
+// series), spread over many log groups. The "by_name" variant resolves the
+// log group by its name on every bump, the "by_idx" variant uses a handle
+// resolved beforehand, as the append path does with
+// Configuration::getLogGroupStatsIdx().
+
+static std::vector<std::string> makeLogGroupNames(size_t num_log_groups) {
+  std::vector<std::string> names;
+  names.reserve(num_log_groups);
+  for (size_t i = 0; i < num_log_groups; ++i) {
+    names.push_back("/benchmark/log_group_" + std::to_string(i));
+  }
+  return names;
+}
+
+// Visits log groups in a scattered order so that consecutive bumps don't hit
+// the same cache lines.
+static size_t nextLogGroup(size_t num_log_groups) {
+  static thread_local size_t i = 0;
+  return (i++ * 2654435761u) % num_log_groups;
+}
+
+static void BM_per_log_stats_by_name(uint32_t iters, size_t num_log_groups) {
+  const int pt = iters / FLAGS_num_threads;
+  CHECK_GT(pt, 0);
+  StatsHolder stats(StatsParams().setIsServer(true));
+  std::vector<std::string> names;
+
+  BENCHMARK_SUSPEND {
+    names = makeLogGroupNames(num_log_groups);
+  }
+
+  stats_benchmark(FLAGS_num_threads, pt, [&stats, &names]() {
+    const std::string& name = names[nextLogGroup(names.size())];
+    LOG_GROUP_STAT_ADD(&stats, name, append_payload_bytes, 100);
+    LOG_GROUP_TIME_SERIES_ADD(&stats, append_in_bytes, name, 100);
+  });
+}
+
+static void BM_per_log_stats_by_idx(uint32_t iters, size_t num_log_groups) {
+  const int pt = iters / FLAGS_num_threads;
+  CHECK_GT(pt, 0);
+  StatsHolder stats(StatsParams().setIsServer(true));
+  std::vector<log_group_stats_idx_t> idxs;
+
+  BENCHMARK_SUSPEND {
+    for (const auto& name : makeLogGroupNames(num_log_groups)) {
+      idxs.push_back(LogGroupStatsIndex::instance().getOrAssign(name));
+    }
+  }
+
+  stats_benchmark(FLAGS_num_threads, pt, [&stats, &idxs]() {
+    const log_group_stats_idx_t idx = idxs[nextLogGroup(idxs.size())];
+    LOG_GROUP_IDX_STAT_ADD(&stats, idx, append_payload_bytes, 100);
+    LOG_GROUP_IDX_TIME_SERIES_ADD(&stats, append_in_bytes, idx, 100);
+  });
+}
+
+BENCHMARK_DRAW_LINE();
+BENCHMARK_PARAM(BM_per_log_stats_by_name, 10000)
+BENCHMARK_RELATIVE_PARAM(BM_per_log_stats_by_idx, 10000)
+BENCHMARK_PARAM(BM_per_log_stats_by_name, 100000)
+BENCHMARK_RELATIVE_PARAM(BM_per_log_stats_by_idx, 100000)
+
+// Cost of recording a latency in each kind of histogram, each thread using
+// its own histogram as they do in Stats. Values are spread over 1us..~1s.
+
+template <typename H>
+static void histogram_add_benchmark(uint32_t iters) {
+  const int pt = iters / FLAGS_num_threads;
+  CHECK_GT(pt, 0);
+
+  stats_benchmark(FLAGS_num_threads, pt, []() {
+    static thread_local H h;
+    static thread_local uint64_t v = 0;
+    v = v * 6364136223846793005ul + 1442695040888963407ul;
+    h.add(1 + ((v >> 33) & ((1 << 20) - 1)));
+  });
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(BM_histogram_add_multi_scale, iters) {
+  histogram_add_benchmark<LatencyHistogram>(iters);
+}
+
+BENCHMARK_RELATIVE(BM_histogram_add_compact, iters) {
+  histogram_add_benchmark<CompactLatencyHistogram>(iters);
+}
+
+BENCHMARK_RELATIVE(BM_histogram_add_hdr, iters) {
+  histogram_add_benchmark<HdrLatencyHistogram>(iters);
+}
+
+// Merging per-thread histograms, as StatsHolder::aggregate() does.
+
+template <typename H>
+static void histogram_merge_benchmark(uint32_t iters) {
+  std::array<H, 2> histograms;
+
+  BENCHMARK_SUSPEND {
+    uint64_t v = 0;
+    for (int i = 0; i < 100000; ++i) {
+      v = v * 6364136223846793005ul + 1442695040888963407ul;
+      histograms[i % 2].add(1 + ((v >> 33) & ((1 << 20) - 1)));
+    }
+  }
+
+  for (uint32_t i = 0; i < iters; ++i) {
+    H total;
+    total.merge(histograms[0]);
+    total.merge(histograms[1]);
+    folly::doNotOptimizeAway(total.estimatePercentile(.999));
+  }
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(BM_histogram_merge_multi_scale, iters) {
+  histogram_merge_benchmark<LatencyHistogram>(iters);
+}
+
+BENCHMARK_RELATIVE(BM_histogram_merge_compact, iters) {
+  histogram_merge_benchmark<CompactLatencyHistogram>(iters);
+}
+
+BENCHMARK_RELATIVE(BM_histogram_merge_hdr, iters) {
+  histogram_merge_benchmark<HdrLatencyHistogram>(iters);
+}
+
 }} // namespace facebook::logdevice
 
 #ifndef BENCHMARK_BUNDLE
@@ -60,7 +60,13 @@ class BufferedWriteDecoder {
    * payloads_out as explained above).
    *
    * @returns On success, returns 0.  If some DataRecord's failed to decode,
-   *          return -1, leaving malformed records in `records'.
+   *          return -1, leaving malformed records in `records'. err is set to
+   *          E::AGAIN if a record is compressed with a ZSTD dictionary that
+   *          is still being fetched (see
+   *          BufferedWriter::setZstdDictionaryFetcher()); decoding it again
+   *          once the fetch completes will succeed if the dictionary was
+   *          found. Otherwise err is E::NOTFOUND: the dictionary is unknown,
+   *          and for a minute after a failed fetch it isn't fetched again.
    */
   int decode(std::vector<std::unique_ptr<DataRecord>>&& records,
              std::vector<Payload>& payloads_out);
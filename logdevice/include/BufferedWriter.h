@@ -8,6 +8,7 @@
 #pragma once
 
 #include <chrono>
+#include <functional>
 #include <memory>
 #include <tuple>
 #include <variant>
@@ -227,6 +228,12 @@ class BufferedWriter {
     // Compression codec.
     Compression compression = Compression::LZ4;
 
+    // If nonzero and compression is ZSTD, batches are compressed with the
+    // dictionary registered under this ID with addZstdDictionary(). Readers
+    // need the same dictionary to decode them. If the dictionary is not
+    // registered, batches are compressed without it.
+    uint32_t zstd_dictionary_id = 0;
+
     // If set to true, will destroy individual payloads immediately after they
     // are batched together. onSuccess(), onFailure() and onRetry() callbacks
     // will not contain payloads.
@@ -272,6 +279,51 @@ class BufferedWriter {
                                                 AppendCallback* callback,
                                                 Options options = Options());
 
+  /**
+   * Registers a ZSTD dictionary for LogOptions::zstd_dictionary_id in this
+   * process. Dictionaries are shared by all BufferedWriter instances and by
+   * BufferedWriteDecoder, which needs the same dictionary to decode batches
+   * compressed with it. A registered dictionary can't be changed; publish a
+   * new version under a new ID instead.
+   *
+   * @return 0 on success, -1 if `id` is 0, `dictionary` is empty or invalid,
+   *         or a different dictionary is already registered under `id`
+   */
+  static int addZstdDictionary(uint32_t id, std::string dictionary);
+
+  /**
+   * Sets a function that BufferedWriteDecoder calls to get the dictionary
+   * with the given ID when it encounters a batch compressed with a dictionary
+   * that wasn't registered with addZstdDictionary(), e.g. to load it from
+   * wherever the application distributes its dictionaries. The function
+   * should return an empty string if the dictionary doesn't exist.
+   *
+   * The function is called asynchronously on folly's global IO executor, so
+   * it may block. Until it returns, decoding batches compressed with the
+   * dictionary fails with err set to E::AGAIN. Call
+   * prefetchZstdDictionary() to load a dictionary ahead of time. If the
+   * function returns an empty string or an invalid dictionary, decoding
+   * fails with E::NOTFOUND instead, and the ID is only fetched again after a
+   * minute.
+   */
+  static void
+  setZstdDictionaryFetcher(std::function<std::string(uint32_t id)> fetcher);
+
+  /**
+   * Starts loading the dictionary with the given ID through the fetcher set
+   * with setZstdDictionaryFetcher(), if it isn't loaded yet.
+   */
+  static void prefetchZstdDictionary(uint32_t id);
+
+  /**
+   * Trains a ZSTD dictionary of at most `dictionary_size` bytes on a sample
+   * of payloads, typically a few thousand payloads appended to one log group.
+   * Returns an empty string if training fails (e.g. too few samples).
+   */
+  static std::string
+  trainZstdDictionary(const std::vector<std::string>& samples,
+                      size_t dictionary_size = 64 * 1024);
+
   /**
    * Same as Client::append() except the append may get buffered. If the call
    * succeeds it is added into a buffer, and finally appended to the log as a
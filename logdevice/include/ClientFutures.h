@@ -0,0 +1,213 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include <folly/futures/Future.h>
+
+#include "logdevice/include/AsyncReader.h"
+#include "logdevice/include/Client.h"
+#include "logdevice/include/Record.h"
+#include "logdevice/include/types.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Future-based counterparts of the asynchronous Client methods, so that
+ *       callers can compose them with folly::SemiFuture combinators, or
+ *       co_await them from folly::coro code, rather than nest callbacks.
+ *
+ *       Each function calls the Client method of the same name and returns a
+ *       future that is fulfilled from the callback, on the Client's Worker
+ *       thread. Attach continuations with .via() to run them elsewhere. If the
+ *       Client method fails synchronously, the future is ready right away with
+ *       the error that the method set `err` to.
+ *
+ *       Like the rest of the API, none of this throws: failures are reported
+ *       through the status of the result. Cancelling a future (e.g. with
+ *       .cancel()) fulfils it right away with status E::CANCELLED, and the
+ *       result of the underlying operation is dropped, so that the future is
+ *       fulfilled exactly once. Appends made through a ClientImpl are also
+ *       aborted if they are still running, without a record being written if
+ *       the APPEND had not been sent to a sequencer yet. Other operations,
+ *       which only read, run to completion in the background.
+ */
+
+namespace ClientFutures {
+
+// Status of an operation along with its result, which is only meaningful if
+// status is E::OK.
+template <typename T>
+struct Result {
+  Status status;
+  T value;
+};
+
+struct AppendResult {
+  Status status;
+  lsn_t lsn;
+  std::chrono::milliseconds timestamp;
+};
+
+/**
+ * See Client::append(). status is E::OK if the record was appended, in
+ * which case lsn and timestamp are those of the record.
+ */
+folly::SemiFuture<AppendResult>
+append(Client& client,
+       logid_t logid,
+       std::string payload,
+       AppendAttributes attrs = AppendAttributes());
+
+/**
+ * See Client::trim().
+ */
+folly::SemiFuture<Status> trim(Client& client, logid_t logid, lsn_t lsn);
+
+/**
+ * See Client::findTime().
+ */
+folly::SemiFuture<Result<lsn_t>>
+findTime(Client& client,
+         logid_t logid,
+         std::chrono::milliseconds timestamp,
+         FindKeyAccuracy accuracy = FindKeyAccuracy::STRICT);
+
+/**
+ * See Client::findKey().
+ */
+folly::SemiFuture<FindKeyResult>
+findKey(Client& client,
+        logid_t logid,
+        std::string key,
+        FindKeyAccuracy accuracy = FindKeyAccuracy::STRICT);
+
+/**
+ * See Client::isLogEmpty().
+ */
+folly::SemiFuture<Result<bool>> isLogEmpty(Client& client, logid_t logid);
+
+/**
+ * See Client::dataSize().
+ */
+folly::SemiFuture<Result<size_t>> dataSize(Client& client,
+                                           logid_t logid,
+                                           std::chrono::milliseconds start,
+                                           std::chrono::milliseconds end,
+                                           DataSizeAccuracy accuracy);
+
+/**
+ * See Client::getTailLSN().
+ */
+folly::SemiFuture<Result<lsn_t>> getTailLSN(Client& client, logid_t logid);
+
+/**
+ * See Client::getTailAttributes().
+ */
+folly::SemiFuture<Result<std::unique_ptr<LogTailAttributes>>>
+getTailAttributes(Client& client, logid_t logid);
+
+/**
+ * See Client::getHeadAttributes().
+ */
+folly::SemiFuture<Result<std::unique_ptr<LogHeadAttributes>>>
+getHeadAttributes(Client& client, logid_t logid);
+
+} // namespace ClientFutures
+
+/**
+ * Pull-based interface to an AsyncReader: each call to next() returns a
+ * future of the next record or gap, from whichever of the logs being read
+ * delivers one first.
+ *
+ * Records are only taken from the AsyncReader while a next() is
+ * outstanding. Otherwise the record callback turns them down and they stay
+ * in the buffer of the log's read stream, which stops sliding its window
+ * until they are consumed. How much data is held for a slow consumer is thus
+ * bounded by the buffer size the AsyncReader was created with, same as for a
+ * callback that returns false.
+ *
+ * next() must not be called again before the future it returned completes.
+ * Cancelling that future fulfils it with status E::CANCELLED and leaves
+ * reading as it is: the next record is delivered to the following call to
+ * next().
+ * Call stopReading() or destroy the FutureReader to stop reading.
+ */
+class FutureReader {
+ public:
+  struct Item {
+    // E::OK, or E::CANCELLED if next() was cancelled, or E::SHUTDOWN if the
+    // FutureReader was destroyed before anything was delivered.
+    Status status = E::OK;
+    // If status is E::OK, exactly one of these is set unless reading is done
+    // for all logs passed to startReading(), in which case both are null.
+    std::unique_ptr<DataRecord> record;
+    std::unique_ptr<GapRecord> gap;
+
+    bool done() const {
+      return status == E::OK && !record && !gap;
+    }
+
+    static Item withStatus(Status st) {
+      Item item;
+      item.status = st;
+      return item;
+    }
+  };
+
+  /**
+   * Takes over @param reader and its callbacks, e.g. a reader created with
+   * Client::createAsyncReader(). Reading must not have been started yet.
+   */
+  explicit FutureReader(std::unique_ptr<AsyncReader> reader);
+
+  /**
+   * Stops reading, waiting for records and gaps being delivered to be
+   * dropped. An outstanding next() completes with E::SHUTDOWN.
+   */
+  ~FutureReader();
+
+  FutureReader(const FutureReader&) = delete;
+  FutureReader& operator=(const FutureReader&) = delete;
+
+  /**
+   * See AsyncReader::startReading().
+   */
+  int startReading(logid_t log_id,
+                   lsn_t from,
+                   lsn_t until = LSN_MAX,
+                   const ReadStreamAttributes* attrs = nullptr);
+
+  /**
+   * See AsyncReader::stopReading(). Once the log's stream is stopped it no
+   * longer counts toward the logs next() waits for.
+   */
+  int stopReading(logid_t log_id);
+
+  /**
+   * @return  a future of the next record or gap. If no log is being read any
+   *          more, the future is ready with an Item for which done() is
+   *          true.
+   */
+  folly::SemiFuture<Item> next();
+
+  AsyncReader& getAsyncReader() {
+    return *reader_;
+  }
+
+ private:
+  struct State;
+
+  std::shared_ptr<State> state_;
+  std::unique_ptr<AsyncReader> reader_;
+};
+
+}} // namespace facebook::logdevice
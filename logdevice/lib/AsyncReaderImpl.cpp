@@ -287,6 +287,7 @@ int AsyncReaderImpl::startReading(logid_t log_id,
   // by way of a StartReadingRequest.
 
   auto settings = processor_->settings();
+  ClientReadStreamBufferBudget* buffer_budget = client_->getReadBufferBudget();
 
   read_stream_id_t rsid = processor_->issueReadStreamID();
 
@@ -322,6 +323,7 @@ int AsyncReaderImpl::startReading(logid_t log_id,
         }
       });
   deps->setReaderName(reader_name_);
+  deps->setBufferBudget(buffer_budget);
 
   auto read_stream = std::make_unique<ClientReadStream>(
       rsid,
@@ -329,7 +331,9 @@ int AsyncReaderImpl::startReading(logid_t log_id,
       from,
       until,
       settings->client_read_flow_control_threshold,
-      buffer_type_,
+      // A circular buffer allocates all its slots upfront; with a shared
+      // budget, only pay for the records actually buffered.
+      buffer_budget ? ClientReadStreamBufferType::ORDERED_MAP : buffer_type_,
       read_buffer_size_,
       std::move(deps),
       processor_->config_,
@@ -11,6 +11,7 @@
 
 #include "logdevice/common/StreamWriterAppendSink.h"
 #include "logdevice/common/buffered_writer/BufferedWriterImpl.h"
+#include "logdevice/common/buffered_writer/ZstdDictionaries.h"
 #include "logdevice/common/util.h"
 #include "logdevice/lib/ClientImpl.h"
 #include "logdevice/lib/ClientProcessor.h"
@@ -57,6 +58,25 @@ BufferedWriter::create(std::shared_ptr<Client> client,
   return std::move(buffered_writer);
 }
 
+int BufferedWriter::addZstdDictionary(uint32_t id, std::string dictionary) {
+  return ZstdDictionaries::instance().add(id, std::move(dictionary));
+}
+
+void BufferedWriter::setZstdDictionaryFetcher(
+    std::function<std::string(uint32_t id)> fetcher) {
+  ZstdDictionaries::instance().setFetcher(std::move(fetcher));
+}
+
+void BufferedWriter::prefetchZstdDictionary(uint32_t id) {
+  ZstdDictionaries::instance().prefetch(id);
+}
+
+std::string
+BufferedWriter::trainZstdDictionary(const std::vector<std::string>& samples,
+                                    size_t dictionary_size) {
+  return ZstdDictionaries::train(samples, dictionary_size);
+}
+
 int BufferedWriter::append(logid_t log_id,
                            std::string&& payload,
                            AppendCallback::Context cb_context,
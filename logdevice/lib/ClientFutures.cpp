@@ -0,0 +1,395 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/include/ClientFutures.h"
+
+#include <atomic>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include <folly/Optional.h>
+
+#include "logdevice/common/debug.h"
+#include "logdevice/include/Err.h"
+#include "logdevice/lib/ClientImpl.h"
+
+namespace facebook { namespace logdevice {
+
+namespace {
+
+// Promise fulfilled by the callback of a Client method, unless the future
+// was cancelled first. Copies share the promise so that one can be captured
+// in the callback.
+template <typename T>
+class PendingCall {
+ public:
+  PendingCall() : state_(std::make_shared<State>()) {}
+
+  folly::SemiFuture<T> getSemiFuture() {
+    return state_->promise.getSemiFuture();
+  }
+
+  void setValue(T value) const {
+    if (!state_->completed.exchange(true)) {
+      state_->promise.setValue(std::move(value));
+    }
+  }
+
+  // Makes cancelling the future fulfil it with
+  // @param on_error(E::CANCELLED), then call @param on_cancel if it is set.
+  // Must be called once the Client method accepted the callback.
+  template <typename ErrorFn>
+  void setCancelHandler(ErrorFn on_error,
+                        std::function<void()> on_cancel = nullptr) {
+    // The interrupt handler is owned by the promise, don't let it keep the
+    // promise alive.
+    std::weak_ptr<State> weak_state = state_;
+    state_->promise.setInterruptHandler(
+        [weak_state, on_error, on_cancel = std::move(on_cancel)](
+            const folly::exception_wrapper&) {
+          auto state = weak_state.lock();
+          if (!state || state->completed.exchange(true)) {
+            return;
+          }
+          state->promise.setValue(on_error(E::CANCELLED));
+          if (on_cancel) {
+            on_cancel();
+          }
+        });
+  }
+
+ private:
+  struct State {
+    folly::Promise<T> promise;
+    // Set by whichever of the callback and the interrupt handler gets to the
+    // promise first.
+    std::atomic<bool> completed{false};
+  };
+
+  std::shared_ptr<State> state_;
+};
+
+// Calls @param start, which passes a callback fulfilling @param call to a
+// Client method and returns what the method returned. If the method failed,
+// returns a future ready with the result of @param on_error(err) instead.
+// on_error also makes the result of a cancelled call.
+template <typename T, typename StartFn, typename ErrorFn>
+folly::SemiFuture<T> run(PendingCall<T> call,
+                         StartFn&& start,
+                         ErrorFn on_error) {
+  auto future = call.getSemiFuture();
+  if (start() != 0) {
+    return folly::makeSemiFuture<T>(on_error(err));
+  }
+  call.setCancelHandler(on_error);
+  return future;
+}
+
+template <typename T>
+ClientFutures::Result<T> failed(Status st) {
+  return ClientFutures::Result<T>{st, T()};
+}
+
+} // namespace
+
+namespace ClientFutures {
+
+folly::SemiFuture<AppendResult> append(Client& client,
+                                       logid_t logid,
+                                       std::string payload,
+                                       AppendAttributes attrs) {
+  PendingCall<AppendResult> call;
+  auto future = call.getSemiFuture();
+  auto cb = [call](Status st, const DataRecord& r) {
+    call.setValue(AppendResult{st, r.attrs.lsn, r.attrs.timestamp});
+  };
+  auto on_error = [](Status st) {
+    return AppendResult{st, LSN_INVALID, std::chrono::milliseconds(0)};
+  };
+
+  ClientImpl* client_impl = dynamic_cast<ClientImpl*>(&client);
+  if (!client_impl) {
+    if (client.append(logid, std::move(payload), cb, std::move(attrs)) != 0) {
+      return folly::makeSemiFuture(on_error(err));
+    }
+    call.setCancelHandler(on_error);
+    return future;
+  }
+
+  ClientImpl::AppendHandle handle;
+  if (client_impl->appendCancellable(
+          logid, std::move(payload), cb, std::move(attrs), &handle) != 0) {
+    return folly::makeSemiFuture(on_error(err));
+  }
+  // Don't keep the Client alive, nor abort anything once it's gone.
+  std::weak_ptr<ClientImpl> weak_client = client_impl->shared_from_this();
+  call.setCancelHandler(on_error, [weak_client, handle] {
+    if (auto client_ptr = weak_client.lock()) {
+      client_ptr->cancelAppend(handle);
+    }
+  });
+  return future;
+}
+
+folly::SemiFuture<Status> trim(Client& client, logid_t logid, lsn_t lsn) {
+  PendingCall<Status> call;
+  return run(call,
+             [&] {
+               return client.trim(
+                   logid, lsn, [call](Status st) { call.setValue(st); });
+             },
+             [](Status st) { return st; });
+}
+
+folly::SemiFuture<Result<lsn_t>> findTime(Client& client,
+                                          logid_t logid,
+                                          std::chrono::milliseconds timestamp,
+                                          FindKeyAccuracy accuracy) {
+  PendingCall<Result<lsn_t>> call;
+  return run(call,
+             [&] {
+               return client.findTime(logid,
+                                      timestamp,
+                                      [call](Status st, lsn_t lsn) {
+                                        call.setValue(Result<lsn_t>{st, lsn});
+                                      },
+                                      accuracy);
+             },
+             failed<lsn_t>);
+}
+
+folly::SemiFuture<FindKeyResult> findKey(Client& client,
+                                         logid_t logid,
+                                         std::string key,
+                                         FindKeyAccuracy accuracy) {
+  PendingCall<FindKeyResult> call;
+  return run(call,
+             [&] {
+               return client.findKey(
+                   logid,
+                   std::move(key),
+                   [call](FindKeyResult result) { call.setValue(result); },
+                   accuracy);
+             },
+             [](Status st) {
+               return FindKeyResult{st, LSN_INVALID, LSN_INVALID};
+             });
+}
+
+folly::SemiFuture<Result<bool>> isLogEmpty(Client& client, logid_t logid) {
+  PendingCall<Result<bool>> call;
+  return run(call,
+             [&] {
+               return client.isLogEmpty(logid, [call](Status st, bool empty) {
+                 call.setValue(Result<bool>{st, empty});
+               });
+             },
+             failed<bool>);
+}
+
+folly::SemiFuture<Result<size_t>> dataSize(Client& client,
+                                           logid_t logid,
+                                           std::chrono::milliseconds start,
+                                           std::chrono::milliseconds end,
+                                           DataSizeAccuracy accuracy) {
+  PendingCall<Result<size_t>> call;
+  return run(call,
+             [&] {
+               return client.dataSize(
+                   logid, start, end, accuracy, [call](Status st, size_t size) {
+                     call.setValue(Result<size_t>{st, size});
+                   });
+             },
+             failed<size_t>);
+}
+
+folly::SemiFuture<Result<lsn_t>> getTailLSN(Client& client, logid_t logid) {
+  PendingCall<Result<lsn_t>> call;
+  return run(call,
+             [&] {
+               return client.getTailLSN(logid, [call](Status st, lsn_t lsn) {
+                 call.setValue(Result<lsn_t>{st, lsn});
+               });
+             },
+             failed<lsn_t>);
+}
+
+folly::SemiFuture<Result<std::unique_ptr<LogTailAttributes>>>
+getTailAttributes(Client& client, logid_t logid) {
+  using ResultT = Result<std::unique_ptr<LogTailAttributes>>;
+  PendingCall<ResultT> call;
+  return run(call,
+             [&] {
+               return client.getTailAttributes(
+                   logid,
+                   [call](Status st, std::unique_ptr<LogTailAttributes> attrs) {
+                     call.setValue(ResultT{st, std::move(attrs)});
+                   });
+             },
+             failed<std::unique_ptr<LogTailAttributes>>);
+}
+
+folly::SemiFuture<Result<std::unique_ptr<LogHeadAttributes>>>
+getHeadAttributes(Client& client, logid_t logid) {
+  using ResultT = Result<std::unique_ptr<LogHeadAttributes>>;
+  PendingCall<ResultT> call;
+  return run(call,
+             [&] {
+               return client.getHeadAttributes(
+                   logid,
+                   [call](Status st, std::unique_ptr<LogHeadAttributes> attrs) {
+                     call.setValue(ResultT{st, std::move(attrs)});
+                   });
+             },
+             failed<std::unique_ptr<LogHeadAttributes>>);
+}
+
+} // namespace ClientFutures
+
+struct FutureReader::State {
+  std::mutex mutex;
+  // Promise of the outstanding next(), if any.
+  folly::Optional<folly::Promise<Item>> pending;
+  // Logs whose records or gaps were turned down since the last next(), to
+  // be resumed by the next call.
+  std::unordered_set<logid_t, logid_t::Hash> declined;
+  // Logs that were started and are neither done nor stopped.
+  std::unordered_set<logid_t, logid_t::Hash> active;
+
+  // Hands @param item over to the outstanding next(). Returns false, leaving
+  // @param item as is, if there is none.
+  bool deliver(logid_t log_id, Item& item) {
+    auto promise = folly::Promise<Item>::makeEmpty();
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+      if (!pending.has_value()) {
+        declined.insert(log_id);
+        return false;
+      }
+      promise = std::move(pending.value());
+      pending.reset();
+    }
+    // Outside of the lock, continuations may run inline and call next().
+    promise.setValue(std::move(item));
+    return true;
+  }
+
+  // Called when @param log_id is no longer read. Completes the outstanding
+  // next() if that was the last log.
+  void finish(logid_t log_id) {
+    auto promise = folly::Promise<Item>::makeEmpty();
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+      active.erase(log_id);
+      declined.erase(log_id);
+      if (!active.empty() || !pending.has_value()) {
+        return;
+      }
+      promise = std::move(pending.value());
+      pending.reset();
+    }
+    promise.setValue(Item());
+  }
+};
+
+FutureReader::FutureReader(std::unique_ptr<AsyncReader> reader)
+    : state_(std::make_shared<State>()), reader_(std::move(reader)) {
+  ld_check(reader_);
+  auto state = state_;
+  reader_->setRecordCallback([state](std::unique_ptr<DataRecord>& record) {
+    const logid_t log_id = record->logid;
+    Item item;
+    item.record = std::move(record);
+    if (!state->deliver(log_id, item)) {
+      // AsyncReader expects the record to be left alone if it's declined.
+      record = std::move(item.record);
+      return false;
+    }
+    return true;
+  });
+  reader_->setGapCallback([state](const GapRecord& gap) {
+    Item item;
+    item.gap = std::make_unique<GapRecord>(gap);
+    return state->deliver(gap.logid, item);
+  });
+  reader_->setDoneCallback([state](logid_t log_id) { state->finish(log_id); });
+}
+
+FutureReader::~FutureReader() {
+  // Waits for callbacks in flight, after which nothing else touches state_.
+  reader_.reset();
+  if (state_->pending.has_value()) {
+    state_->pending->setValue(Item::withStatus(E::SHUTDOWN));
+  }
+}
+
+int FutureReader::startReading(logid_t log_id,
+                               lsn_t from,
+                               lsn_t until,
+                               const ReadStreamAttributes* attrs) {
+  {
+    std::lock_guard<std::mutex> guard(state_->mutex);
+    state_->active.insert(log_id);
+  }
+  int rv = reader_->startReading(log_id, from, until, attrs);
+  if (rv != 0) {
+    const Status st = err;
+    std::lock_guard<std::mutex> guard(state_->mutex);
+    state_->active.erase(log_id);
+    err = st;
+  }
+  return rv;
+}
+
+int FutureReader::stopReading(logid_t log_id) {
+  auto state = state_;
+  return reader_->stopReading(
+      log_id, [state, log_id] { state->finish(log_id); });
+}
+
+folly::SemiFuture<FutureReader::Item> FutureReader::next() {
+  folly::SemiFuture<Item> future = folly::SemiFuture<Item>::makeEmpty();
+  std::vector<logid_t> to_resume;
+  {
+    std::lock_guard<std::mutex> guard(state_->mutex);
+    ld_check(!state_->pending.has_value());
+    if (state_->active.empty()) {
+      return folly::makeSemiFuture(Item());
+    }
+    folly::Promise<Item> promise;
+    future = promise.getSemiFuture();
+    std::weak_ptr<State> weak_state = state_;
+    promise.setInterruptHandler([weak_state](const folly::exception_wrapper&) {
+      auto state = weak_state.lock();
+      if (!state) {
+        return;
+      }
+      auto cancelled = folly::Promise<Item>::makeEmpty();
+      {
+        std::lock_guard<std::mutex> state_guard(state->mutex);
+        if (!state->pending.has_value()) {
+          return;
+        }
+        cancelled = std::move(state->pending.value());
+        state->pending.reset();
+      }
+      cancelled.setValue(Item::withStatus(E::CANCELLED));
+    });
+    state_->pending = std::move(promise);
+    to_resume.assign(state_->declined.begin(), state_->declined.end());
+    state_->declined.clear();
+  }
+  // Have the read streams redeliver what was turned down rather than wait
+  // for their retry timers.
+  for (logid_t log_id : to_resume) {
+    reader_->resumeReading(log_id);
+  }
+  return future;
+}
+
+}} // namespace facebook::logdevice
@@ -36,7 +36,9 @@
 #include "logdevice/common/TailRecord.h"
 #include "logdevice/common/ThreadID.h"
 #include "logdevice/common/TrimRequest.h"
+#include "logdevice/common/Worker.h"
 #include "logdevice/common/client_read_stream/AllClientReadStreams.h"
+#include "logdevice/common/client_read_stream/ClientReadStreamBufferBudget.h"
 #include "logdevice/common/configuration/Configuration.h"
 #include "logdevice/common/configuration/TextConfigUpdater.h"
 #include "logdevice/common/configuration/UpdateableConfig.h"
@@ -49,6 +51,7 @@
 #include "logdevice/common/plugin/TraceLoggerFactory.h"
 #include "logdevice/common/plugin/ZookeeperClientFactory.h"
 #include "logdevice/common/replicated_state_machine/RsmSnapshotStoreFactory.h"
+#include "logdevice/common/request_util.h"
 #include "logdevice/common/settings/Settings.h"
 #include "logdevice/common/settings/UpdateableSettings.h"
 #include "logdevice/common/stats/Stats.h"
@@ -116,8 +119,8 @@ ClientImpl::ClientImpl(std::string cluster_name,
 
   const size_t metadata_cache_size = settings->client_epoch_metadata_cache_size;
   if (metadata_cache_size > 0) {
-    epoch_metadata_cache_ =
-        std::make_unique<EpochMetaDataCache>(metadata_cache_size);
+    epoch_metadata_cache_ = std::make_unique<EpochMetaDataCache>(
+        metadata_cache_size, settings->client_epoch_metadata_cache_max_bytes);
   }
 
   if (settings->stats_collection_interval.count() > 0 ||
@@ -132,6 +135,14 @@ ClientImpl::ClientImpl(std::string cluster_name,
 
   STAT_SET(stats_.get(), client.client_started, 1);
 
+  if (settings->client_read_buffer_budget_records > 0 ||
+      settings->client_read_buffer_budget_bytes > 0) {
+    read_buffer_budget_ = std::make_unique<ClientReadStreamBufferBudget>(
+        settings->client_read_buffer_budget_records,
+        settings->client_read_buffer_budget_bytes,
+        stats_.get());
+  }
+
   std::shared_ptr<ServerConfig> server_cfg = config_->get()->serverConfig();
 
   std::shared_ptr<TraceLoggerFactory> trace_logger_factory =
@@ -304,6 +315,31 @@ ClientImpl::~ClientImpl() {
           cluster_name_.c_str());
 }
 
+namespace {
+
+// We need payload to be owned by a folly::IOBuf rather than an std::string.
+// If payload is small, let's just make a copy. If payload is large, we'll
+// use a custom deleter function to avoid copying.
+PayloadHolder payloadHolderFromString(std::string payload) {
+  if (payload.size() < 256) {
+    return PayloadHolder(
+        PayloadHolder::COPY_BUFFER, payload.data(), payload.size());
+  }
+  std::string* string_on_heap = new std::string(std::move(payload));
+  folly::IOBuf::FreeFunction deleter = +[](void* /* buf */, void* userData) {
+    delete reinterpret_cast<std::string*>(userData);
+  };
+  return PayloadHolder(
+      folly::IOBuf(folly::IOBuf::TAKE_OWNERSHIP,
+                   string_on_heap->data(),
+                   string_on_heap->size(),
+                   deleter,
+                   /* userData */ reinterpret_cast<void*>(string_on_heap)),
+      /* ignore_size_limit */ true);
+}
+
+} // namespace
+
 int ClientImpl::append(logid_t logid,
                        const Payload& payload,
                        append_callback_t cb,
@@ -336,29 +372,8 @@ int ClientImpl::append(logid_t logid,
                        AppendAttributes attrs,
                        worker_id_t target_worker,
                        std::unique_ptr<std::string> per_request_token) {
-  // We need payload to be owned by a folly::IOBuf rather than an std::string.
-  // If payload is small, let's just make a copy. If payload is large, we'll
-  // use a custom deleter function to avoid copying.
-  PayloadHolder payload_holder;
-  if (payload.size() < 256) {
-    payload_holder = PayloadHolder(
-        PayloadHolder::COPY_BUFFER, payload.data(), payload.size());
-  } else {
-    std::string* string_on_heap = new std::string(std::move(payload));
-    folly::IOBuf::FreeFunction deleter = +[](void* /* buf */, void* userData) {
-      delete reinterpret_cast<std::string*>(userData);
-    };
-    payload_holder = PayloadHolder(
-        folly::IOBuf(folly::IOBuf::TAKE_OWNERSHIP,
-                     string_on_heap->data(),
-                     string_on_heap->size(),
-                     deleter,
-                     /* userData */ reinterpret_cast<void*>(string_on_heap)),
-        /* ignore_size_limit */ true);
-  }
-
   auto req = prepareRequest(logid,
-                            std::move(payload_holder),
+                            payloadHolderFromString(std::move(payload)),
                             cb,
                             std::move(attrs),
                             target_worker,
@@ -369,6 +384,45 @@ int ClientImpl::append(logid_t logid,
   return postAppend(std::move(req));
 }
 
+int ClientImpl::appendCancellable(logid_t logid,
+                                  std::string payload,
+                                  append_callback_t cb,
+                                  AppendAttributes attrs,
+                                  AppendHandle* handle_out) {
+  ld_check(handle_out);
+  auto req = prepareRequest(logid,
+                            payloadHolderFromString(std::move(payload)),
+                            std::move(cb),
+                            std::move(attrs),
+                            worker_id_t(-1),
+                            nullptr);
+  if (!req) {
+    return -1;
+  }
+  // Pin the request to the Worker it would go to anyway so that
+  // cancelAppend() knows where to find it.
+  handle_out->worker = worker_id_t(req->getThreadAffinity(
+      processor_->getWorkerCount(req->getWorkerTypeAffinity())));
+  handle_out->rqid = req->id_;
+  return postAppend(std::move(req));
+}
+
+void ClientImpl::cancelAppend(const AppendHandle& handle) {
+  const request_id_t rqid = handle.rqid;
+  run_on_worker_nonblocking(
+      processor_.get(),
+      handle.worker,
+      WorkerType::GENERAL,
+      RequestType::CANCEL_APPEND,
+      [rqid] {
+        auto& appends = Worker::onThisThread()->runningAppends().map;
+        auto it = appends.find(rqid);
+        if (it != appends.end()) {
+          checked_downcast<AppendRequest*>(it->second.get())->cancel();
+        }
+      });
+}
+
 int ClientImpl::append(logid_t logid,
                        PayloadGroup&& payload_group,
                        append_callback_t cb,
@@ -609,12 +663,14 @@ lsn_t ClientImpl::appendSync(logid_t logid,
 
 std::unique_ptr<Reader> ClientImpl::createReader(size_t max_logs,
                                                  ssize_t buffer_size) noexcept {
-  return std::make_unique<ReaderImpl>(max_logs,
-                                      buffer_size,
-                                      processor_.get(),
-                                      getClientSessionID(),
-                                      getEpochMetaDataCache(),
-                                      shared_from_this());
+  auto reader = std::make_unique<ReaderImpl>(max_logs,
+                                             buffer_size,
+                                             processor_.get(),
+                                             getClientSessionID(),
+                                             getEpochMetaDataCache(),
+                                             shared_from_this());
+  reader->setBufferBudget(getReadBufferBudget());
+  return reader;
 }
 
 std::unique_ptr<AsyncReader>
@@ -42,6 +42,7 @@ class NodesConfigurationManager;
 class AppendRequest;
 class ClientAPIHitsTracer;
 class ClientBridgeImpl;
+class ClientReadStreamBufferBudget;
 class ClientEventTracer;
 class ClientProcessor;
 class ClientSettings;
@@ -142,6 +143,28 @@ class ClientImpl : public Client,
              worker_id_t target_worker,
              std::unique_ptr<std::string> per_request_token);
 
+  // Identifies an append posted with appendCancellable().
+  struct AppendHandle {
+    worker_id_t worker{-1};
+    request_id_t rqid{REQUEST_ID_INVALID};
+  };
+
+  // Same as append() but also fills @param handle_out, which can be passed
+  // to cancelAppend() to abort the append. Used by ClientFutures.
+  int appendCancellable(logid_t logid,
+                        std::string payload,
+                        append_callback_t cb,
+                        AppendAttributes attrs,
+                        AppendHandle* handle_out);
+
+  // Aborts the append identified by @param handle if it is still running.
+  // Its callback is not invoked: AppendRequest::cancel() deactivates the
+  // request before destroying it, and the destructor only calls back active
+  // requests. Asynchronous: the append may complete before the Worker running
+  // it gets to the cancellation, in which case the callback has been invoked
+  // and this is a no-op.
+  void cancelAppend(const AppendHandle& handle);
+
   // Variant of append() for use by BufferedWriter.  Differences:
   // - Forces the append to go to a specific Worker.
   // - Uses a slightly higher limit on the max payload size to allow for
@@ -434,6 +457,12 @@ class ClientImpl : public Client,
     return epoch_metadata_cache_.get();
   }
 
+  // return a raw pointer to the buffer budget shared by read streams, or
+  // nullptr if read streams use fixed-size windows
+  ClientReadStreamBufferBudget* getReadBufferBudget() {
+    return read_buffer_budget_.get();
+  }
+
   // verifies that arguments to append() are valid; sets err
   bool checkAppendImpl(logid_t logid,
                        size_t payload_size,
@@ -541,6 +570,10 @@ class ClientImpl : public Client,
 
   std::unique_ptr<StatsHolder> stats_;
 
+  // buffer budget shared by all read streams of this client, if enabled. Must
+  // outlive the Processor.
+  std::unique_ptr<ClientReadStreamBufferBudget> read_buffer_budget_;
+
   std::unique_ptr<ClientBridgeImpl> bridge_;
 
   std::unique_ptr<ClientEventTracer> event_tracer_;
@@ -40,9 +40,11 @@ ClientMessageDispatch::onReceivedImpl(Message* msg,
     case MessageType::NODE_STATS_AGGREGATE_REPLY:
     case MessageType::RELEASE:
     case MessageType::SEAL:
+    case MessageType::SEAL_BATCH:
     case MessageType::START:
     case MessageType::STOP:
     case MessageType::STORE:
+    case MessageType::STORE_BATCH:
     case MessageType::TRIM:
     case MessageType::WINDOW:
       RATELIMIT_ERROR(
@@ -0,0 +1,153 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/include/ClientFutures.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "logdevice/lib/test/MockAsyncReader.h"
+
+using namespace facebook::logdevice;
+
+using ::testing::_;
+using ::testing::NiceMock;
+using ::testing::Return;
+using ::testing::SaveArg;
+
+namespace {
+
+class FutureReaderTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    auto reader = std::make_unique<NiceMock<MockAsyncReader>>();
+    mock_reader_ = reader.get();
+    EXPECT_CALL(*mock_reader_, setRecordCallback(_))
+        .WillOnce(SaveArg<0>(&record_cb_));
+    EXPECT_CALL(*mock_reader_, setGapCallback(_))
+        .WillOnce(SaveArg<0>(&gap_cb_));
+    EXPECT_CALL(*mock_reader_, setDoneCallback(_))
+        .WillOnce(SaveArg<0>(&done_cb_));
+    ON_CALL(*mock_reader_, startReading(_, _, _, _)).WillByDefault(Return(0));
+    reader_ = std::make_unique<FutureReader>(std::move(reader));
+  }
+
+  // Delivers a record to the FutureReader, as ClientReadStream would.
+  // Returns whether it was accepted.
+  bool deliverRecord(logid_t log_id, lsn_t lsn) {
+    auto record = std::make_unique<DataRecord>();
+    record->logid = log_id;
+    record->attrs.lsn = lsn;
+    bool accepted = record_cb_(record);
+    // A declined record must be left for redelivery.
+    EXPECT_EQ(accepted, record == nullptr);
+    return accepted;
+  }
+
+  NiceMock<MockAsyncReader>* mock_reader_;
+  std::function<bool(std::unique_ptr<DataRecord>&)> record_cb_;
+  std::function<bool(const GapRecord&)> gap_cb_;
+  std::function<void(logid_t)> done_cb_;
+  std::unique_ptr<FutureReader> reader_;
+};
+
+} // namespace
+
+TEST_F(FutureReaderTest, RecordsWaitForNext) {
+  const logid_t log(1);
+  ASSERT_EQ(0, reader_->startReading(log, 1));
+
+  // Nobody is asking for records yet, leave them in the read stream.
+  EXPECT_FALSE(deliverRecord(log, 1));
+
+  // next() has the read stream redeliver right away.
+  EXPECT_CALL(*mock_reader_, resumeReading(log)).WillOnce(Return(0));
+  auto future = reader_->next();
+  EXPECT_FALSE(future.isReady());
+  EXPECT_TRUE(deliverRecord(log, 1));
+  ASSERT_TRUE(future.isReady());
+  FutureReader::Item item = std::move(future).get();
+  ASSERT_TRUE(item.record);
+  EXPECT_FALSE(item.gap);
+  EXPECT_EQ(1, item.record->attrs.lsn);
+
+  // Only one record per next().
+  EXPECT_FALSE(deliverRecord(log, 2));
+}
+
+TEST_F(FutureReaderTest, GapsAndDone) {
+  const logid_t log1(1), log2(2);
+  ASSERT_EQ(0, reader_->startReading(log1, 1));
+  ASSERT_EQ(0, reader_->startReading(log2, 1));
+
+  auto future = reader_->next();
+  EXPECT_TRUE(gap_cb_(GapRecord(log2, GapType::HOLE, 1, 3)));
+  FutureReader::Item item = std::move(future).get();
+  ASSERT_TRUE(item.gap);
+  EXPECT_EQ(log2, item.gap->logid);
+  EXPECT_EQ(GapType::HOLE, item.gap->type);
+  EXPECT_EQ(3, item.gap->hi);
+
+  // Not done until both logs are.
+  future = reader_->next();
+  done_cb_(log1);
+  EXPECT_FALSE(future.isReady());
+  done_cb_(log2);
+  ASSERT_TRUE(future.isReady());
+  EXPECT_TRUE(std::move(future).get().done());
+
+  EXPECT_TRUE(reader_->next().isReady());
+}
+
+TEST_F(FutureReaderTest, StopReading) {
+  const logid_t log(1);
+  ASSERT_EQ(0, reader_->startReading(log, 1));
+
+  std::function<void()> stopped_cb;
+  EXPECT_CALL(*mock_reader_, stopReading(log, _))
+      .WillOnce(testing::DoAll(SaveArg<1>(&stopped_cb), Return(0)));
+  auto future = reader_->next();
+  ASSERT_EQ(0, reader_->stopReading(log));
+  EXPECT_FALSE(future.isReady());
+  stopped_cb();
+  ASSERT_TRUE(future.isReady());
+  EXPECT_TRUE(std::move(future).get().done());
+}
+
+TEST_F(FutureReaderTest, FailedStartIsNotWaitedFor) {
+  EXPECT_CALL(*mock_reader_, startReading(logid_t(1), _, _, _))
+      .WillOnce(Return(-1));
+  err = E::NOTFOUND;
+  EXPECT_EQ(-1, reader_->startReading(logid_t(1), 1));
+  EXPECT_EQ(E::NOTFOUND, err);
+  EXPECT_TRUE(std::move(reader_->next()).get().done());
+}
+
+TEST_F(FutureReaderTest, Cancel) {
+  const logid_t log(1);
+  ASSERT_EQ(0, reader_->startReading(log, 1));
+
+  auto future = reader_->next();
+  future.cancel();
+  ASSERT_TRUE(future.isReady());
+  EXPECT_EQ(E::CANCELLED, std::move(future).get().status);
+
+  // The record goes to the next call instead.
+  EXPECT_FALSE(deliverRecord(log, 1));
+  EXPECT_CALL(*mock_reader_, resumeReading(log)).WillOnce(Return(0));
+  future = reader_->next();
+  EXPECT_TRUE(deliverRecord(log, 1));
+  EXPECT_EQ(1, std::move(future).get().record->attrs.lsn);
+}
+
+TEST_F(FutureReaderTest, Destroy) {
+  ASSERT_EQ(0, reader_->startReading(logid_t(1), 1));
+  auto future = reader_->next();
+  reader_.reset();
+  ASSERT_TRUE(future.isReady());
+  EXPECT_EQ(E::SHUTDOWN, std::move(future).get().status);
+}
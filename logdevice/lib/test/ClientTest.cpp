@@ -7,17 +7,23 @@
  */
 #include "logdevice/include/Client.h"
 
+#include <atomic>
 #include <chrono>
+#include <memory>
 
 #include <folly/synchronization/Baton.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
 #include "logdevice/common/Semaphore.h"
+#include "logdevice/common/Worker.h"
+#include "logdevice/common/request_util.h"
 #include "logdevice/common/stats/Stats.h"
 #include "logdevice/common/test/TestUtil.h"
 #include "logdevice/common/types_internal.h"
 #include "logdevice/include/ClientFactory.h"
+#include "logdevice/include/ClientFutures.h"
+#include "logdevice/lib/ClientImpl.h"
 
 using namespace ::testing;
 
@@ -308,4 +314,154 @@ TEST_F(ClientTest, DontBumpMetricOnUnworthyFailures) {
   EXPECT_EQ(0, stats.client.client_init_failed);
 }
 
+namespace {
+
+// Keeps all general workers of @param processor busy until destroyed, so
+// that the requests posted meanwhile are run in order afterwards.
+class WorkerBlocker {
+ public:
+  explicit WorkerBlocker(Processor& processor)
+      : nworkers_(processor.getWorkerCount(WorkerType::GENERAL)),
+        sem_(std::make_shared<Semaphore>()) {
+    for (int i = 0; i < nworkers_; ++i) {
+      run_on_worker_nonblocking(&processor,
+                                worker_id_t(i),
+                                WorkerType::GENERAL,
+                                RequestType::MISC,
+                                [sem = sem_] { sem->wait(); });
+    }
+  }
+
+  ~WorkerBlocker() {
+    for (int i = 0; i < nworkers_; ++i) {
+      sem_->post();
+    }
+  }
+
+ private:
+  const int nworkers_;
+  // Shared with the workers, which may still be waking up when this is
+  // destroyed.
+  std::shared_ptr<Semaphore> sem_;
+};
+
+size_t numRunningAppends(ClientImpl& client) {
+  size_t res = 0;
+  for (size_t n : run_on_worker_pool(
+           &client.getProcessor(), WorkerType::GENERAL, [] {
+             return Worker::onThisThread()->runningAppends().map.size();
+           })) {
+    res += n;
+  }
+  return res;
+}
+
+} // namespace
+
+// Results of operations made through ClientFutures, whether they fail right
+// away or once they ran. No server is running, so only failures are tested.
+TEST_F(ClientTest, Futures) {
+  std::string config_path =
+      std::string("file:") + TEST_CONFIG_FILE("sample_no_ssl.conf");
+  std::shared_ptr<Client> client = clientFactory().create(config_path);
+  ASSERT_NE(nullptr, client);
+
+  const std::string too_big(client->getMaxPayloadSize() + 1, 'x');
+  auto append = ClientFutures::append(*client, logid_t(1), too_big);
+  ASSERT_TRUE(append.isReady());
+  EXPECT_EQ(E::TOOBIG, std::move(append).get().status);
+
+  // Log 999 is not in the config.
+  EXPECT_EQ(
+      E::NOTFOUND,
+      ClientFutures::append(*client, logid_t(999), "foo").get().status);
+  EXPECT_EQ(E::NOTFOUND, ClientFutures::trim(*client, logid_t(999), 1).get());
+  EXPECT_EQ(
+      E::INVALID_PARAM,
+      ClientFutures::findTime(*client, LOGID_INVALID, std::chrono::seconds(1))
+          .get()
+          .status);
+}
+
+// Cancelling a future fulfils it with E::CANCELLED exactly once, and aborts
+// the append behind it.
+TEST_F(ClientTest, CancelFutures) {
+  std::string config_path =
+      std::string("file:") + TEST_CONFIG_FILE("sample_no_ssl.conf");
+  std::shared_ptr<Client> client = clientFactory().create(config_path);
+  ASSERT_NE(nullptr, client);
+  auto client_impl = std::dynamic_pointer_cast<ClientImpl>(client);
+  ASSERT_NE(nullptr, client_impl);
+
+  auto append = folly::SemiFuture<ClientFutures::AppendResult>::makeEmpty();
+  auto trim = folly::SemiFuture<Status>::makeEmpty();
+  auto find_time =
+      folly::SemiFuture<ClientFutures::Result<lsn_t>>::makeEmpty();
+  {
+    // None of the operations gets to run before it is cancelled.
+    WorkerBlocker blocker(client_impl->getProcessor());
+    append = ClientFutures::append(*client, logid_t(1), "foo");
+    trim = ClientFutures::trim(*client, logid_t(1), 10);
+    find_time = ClientFutures::findTime(
+        *client, logid_t(1), std::chrono::milliseconds(0));
+    EXPECT_FALSE(append.isReady());
+    EXPECT_FALSE(trim.isReady());
+    EXPECT_FALSE(find_time.isReady());
+    append.cancel();
+    trim.cancel();
+    find_time.cancel();
+    EXPECT_TRUE(append.isReady());
+    EXPECT_TRUE(trim.isReady());
+    EXPECT_TRUE(find_time.isReady());
+  }
+  EXPECT_EQ(0, numRunningAppends(*client_impl));
+
+  // Shutting down completes the trim and findTime requests, whose results
+  // must be dropped.
+  client.reset();
+  client_impl.reset();
+  EXPECT_EQ(E::CANCELLED, std::move(append).get().status);
+  EXPECT_EQ(E::CANCELLED, std::move(trim).get());
+  EXPECT_EQ(E::CANCELLED, std::move(find_time).get().status);
+}
+
+TEST_F(ClientTest, CancelAppend) {
+  std::string config_path =
+      std::string("file:") + TEST_CONFIG_FILE("sample_no_ssl.conf");
+  std::shared_ptr<Client> client = clientFactory().create(config_path);
+  ASSERT_NE(nullptr, client);
+  auto client_impl = std::dynamic_pointer_cast<ClientImpl>(client);
+  ASSERT_NE(nullptr, client_impl);
+
+  std::atomic<int> callbacks{0};
+  Semaphore called;
+  auto cb = [&](Status, const DataRecord&) {
+    ++callbacks;
+    called.post();
+  };
+
+  ClientImpl::AppendHandle handle;
+  {
+    WorkerBlocker blocker(client_impl->getProcessor());
+    ASSERT_EQ(0,
+              client_impl->appendCancellable(
+                  logid_t(1), "foo", cb, AppendAttributes(), &handle));
+    client_impl->cancelAppend(handle);
+  }
+  EXPECT_EQ(0, numRunningAppends(*client_impl));
+  EXPECT_EQ(0, callbacks.load());
+
+  // Cancelling an append that completed already is a no-op.
+  ASSERT_EQ(0,
+            client_impl->appendCancellable(
+                logid_t(999), "foo", cb, AppendAttributes(), &handle));
+  called.wait();
+  client_impl->cancelAppend(handle);
+  EXPECT_EQ(0, numRunningAppends(*client_impl));
+
+  client.reset();
+  client_impl.reset();
+  EXPECT_EQ(1, callbacks.load());
+}
+
 }} // namespace facebook::logdevice
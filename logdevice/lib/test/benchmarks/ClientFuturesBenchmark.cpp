@@ -0,0 +1,208 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include <folly/Benchmark.h>
+#include <folly/Singleton.h>
+#include <folly/synchronization/Baton.h>
+#include <gflags/gflags.h>
+#include <gmock/gmock.h>
+
+#include "logdevice/common/debug.h"
+#include "logdevice/common/test/TestUtil.h"
+#include "logdevice/include/ClientFactory.h"
+#include "logdevice/include/ClientFutures.h"
+#include "logdevice/lib/test/MockAsyncReader.h"
+
+using namespace facebook::logdevice;
+
+using ::testing::_;
+using ::testing::NiceMock;
+using ::testing::Return;
+using ::testing::SaveArg;
+
+/**
+ * @file: Per-record cost of consuming records through FutureReader::next()
+ *        compared to a plain AsyncReader record callback, and to the promise
+ *        glue an application would otherwise write around that callback.
+ *        Records are handed to the callbacks directly, as a ClientReadStream
+ *        would, so this only measures the overhead on the consuming side.
+ *
+ *        Also the round trip of an append and of a findTime() made with a
+ *        callback and through ClientFutures, one at a time, on a Client
+ *        without a cluster. The append goes to a log that is not in the
+ *        config and the findTime() to LOGID_INVALID, so both are posted to
+ *        a Worker and fail there without network traffic, and the
+ *        difference is the overhead of the futures.
+ */
+
+namespace {
+
+std::unique_ptr<DataRecord> makeRecord(lsn_t lsn) {
+  auto record = std::make_unique<DataRecord>();
+  record->logid = logid_t(1);
+  record->attrs.lsn = lsn;
+  return record;
+}
+
+// Log that is not in the config of getClient().
+const logid_t kUnknownLog(999);
+
+Client& getClient() {
+  static auto ncs =
+      provisionTempNodesConfiguration(*createSimpleNodesConfig(1));
+  static std::shared_ptr<Client> client = [] {
+    dbg::currentLevel = dbg::Level::CRITICAL;
+    return ClientFactory()
+        .setSetting("nodes-configuration-file-store-dir", ncs->path().string())
+        .setSetting("admin-client-capabilities", "true")
+        .create(std::string("file:") + TEST_CONFIG_FILE("sample_no_ssl.conf"));
+  }();
+  ld_check(client);
+  return *client;
+}
+
+} // namespace
+
+BENCHMARK(AppendCallback, n) {
+  Client* client;
+  BENCHMARK_SUSPEND {
+    client = &getClient();
+  }
+  Status last = E::OK;
+  folly::Baton<> baton;
+  for (size_t i = 0; i < n; ++i) {
+    baton.reset();
+    client->append(kUnknownLog, "foo", [&](Status st, const DataRecord&) {
+      last = st;
+      baton.post();
+    });
+    baton.wait();
+  }
+  folly::doNotOptimizeAway(last);
+}
+
+BENCHMARK_RELATIVE(AppendFuture, n) {
+  Client* client;
+  BENCHMARK_SUSPEND {
+    client = &getClient();
+  }
+  Status last = E::OK;
+  for (size_t i = 0; i < n; ++i) {
+    last = ClientFutures::append(*client, kUnknownLog, "foo").get().status;
+  }
+  folly::doNotOptimizeAway(last);
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(FindTimeCallback, n) {
+  Client* client;
+  BENCHMARK_SUSPEND {
+    client = &getClient();
+  }
+  Status last = E::OK;
+  folly::Baton<> baton;
+  for (size_t i = 0; i < n; ++i) {
+    baton.reset();
+    client->findTime(
+        LOGID_INVALID, std::chrono::milliseconds(0), [&](Status st, lsn_t) {
+          last = st;
+          baton.post();
+        });
+    baton.wait();
+  }
+  folly::doNotOptimizeAway(last);
+}
+
+BENCHMARK_RELATIVE(FindTimeFuture, n) {
+  Client* client;
+  BENCHMARK_SUSPEND {
+    client = &getClient();
+  }
+  Status last = E::OK;
+  for (size_t i = 0; i < n; ++i) {
+    last = ClientFutures::findTime(
+               *client, LOGID_INVALID, std::chrono::milliseconds(0))
+               .get()
+               .status;
+  }
+  folly::doNotOptimizeAway(last);
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(AsyncReaderCallback, n) {
+  lsn_t last = LSN_INVALID;
+  std::function<bool(std::unique_ptr<DataRecord>&)> cb =
+      [&](std::unique_ptr<DataRecord>& record) {
+        last = record->attrs.lsn;
+        return true;
+      };
+  for (size_t i = 1; i <= n; ++i) {
+    auto record = makeRecord(i);
+    cb(record);
+  }
+  folly::doNotOptimizeAway(last);
+}
+
+BENCHMARK_RELATIVE(HandWrittenPromise, n) {
+  lsn_t last = LSN_INVALID;
+  folly::Promise<std::unique_ptr<DataRecord>> promise;
+  std::function<bool(std::unique_ptr<DataRecord>&)> cb =
+      [&](std::unique_ptr<DataRecord>& record) {
+        promise.setValue(std::move(record));
+        return true;
+      };
+  for (size_t i = 1; i <= n; ++i) {
+    promise = folly::Promise<std::unique_ptr<DataRecord>>();
+    auto future = promise.getSemiFuture();
+    auto record = makeRecord(i);
+    cb(record);
+    last = std::move(future).get()->attrs.lsn;
+  }
+  folly::doNotOptimizeAway(last);
+}
+
+BENCHMARK_RELATIVE(FutureReaderNext, n) {
+  std::function<bool(std::unique_ptr<DataRecord>&)> cb;
+  std::unique_ptr<FutureReader> reader;
+  BENCHMARK_SUSPEND {
+    auto mock_reader = std::make_unique<NiceMock<MockAsyncReader>>();
+    ON_CALL(*mock_reader, setRecordCallback(_))
+        .WillByDefault(SaveArg<0>(&cb));
+    ON_CALL(*mock_reader, startReading(_, _, _, _)).WillByDefault(Return(0));
+    reader = std::make_unique<FutureReader>(std::move(mock_reader));
+    reader->startReading(logid_t(1), LSN_OLDEST);
+  }
+
+  lsn_t last = LSN_INVALID;
+  for (size_t i = 1; i <= n; ++i) {
+    auto future = reader->next();
+    auto record = makeRecord(i);
+    cb(record);
+    last = std::move(future).get().record->attrs.lsn;
+  }
+  folly::doNotOptimizeAway(last);
+
+  BENCHMARK_SUSPEND {
+    reader.reset();
+  }
+}
+
+#ifndef BENCHMARK_BUNDLE
+int main(int argc, char** argv) {
+  folly::SingletonVault::singleton()->registrationComplete();
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+
+  return 0;
+}
+#endif
@@ -17,6 +17,7 @@
 #include "logdevice/ops/ldquery/TableRegistry.h"
 #include "logdevice/ops/ldquery/VirtualTable.h"
 #include "tables/AppendOutliers.h"
+#include "tables/AppendStages.h"
 #include "tables/AppendThroughput.h"
 #include "tables/CatchupQueues.h"
 #include "tables/ChunkRebuildings.h"
@@ -26,6 +27,8 @@
 #include "tables/EventLog.h"
 #include "tables/Graylist.h"
 #include "tables/HistoricalMetadata.h"
+#include "tables/IOLatency.h"
+#include "tables/IOTraces.h"
 #include "tables/Info.h"
 #include "tables/InfoConfig.h"
 #include "tables/InfoRsm.h"
@@ -142,6 +145,7 @@ LDQuery::LDQuery(std::string config_path,
   ctx_->use_ssl = use_ssl;
 
   table_registry_.registerTable<tables::AppendOutliers>(ctx_);
+  table_registry_.registerTable<tables::AppendStages>(ctx_);
   table_registry_.registerTable<tables::AppendThroughput>(ctx_);
   table_registry_.registerTable<tables::CatchupQueues>(ctx_);
   table_registry_.registerTable<tables::ChunkRebuildings>(ctx_);
@@ -153,6 +157,8 @@ LDQuery::LDQuery(std::string config_path,
   table_registry_.registerTable<tables::Graylist>(ctx_);
   table_registry_.registerTable<tables::HistoricalMetadata>(ctx_);
   table_registry_.registerTable<tables::HistoricalMetadataLegacy>(ctx_);
+  table_registry_.registerTable<tables::IOLatency>(ctx_);
+  table_registry_.registerTable<tables::IOTraces>(ctx_);
   table_registry_.registerTable<tables::Info>(ctx_);
   table_registry_.registerTable<tables::InfoConfig>(ctx_);
   table_registry_.registerTable<tables::InfoRsm>(ctx_);
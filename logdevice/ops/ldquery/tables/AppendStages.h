@@ -0,0 +1,59 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "../Context.h"
+#include "AdminCommandTable.h"
+
+namespace facebook {
+  namespace logdevice {
+    namespace ldquery {
+      namespace tables {
+
+class AppendStages : public AdminCommandTable {
+ public:
+  explicit AppendStages(std::shared_ptr<Context> ctx)
+      : AdminCommandTable(ctx) {}
+  static std::string getName() {
+    return "append_stages";
+  }
+  std::string getDescription() override {
+    return "Latency of a sample of appends, broken down by the stage of the "
+           "append path it was spent in (controlled by "
+           "--append-stage-latency-sample-rate).  Sequencer nodes report the "
+           "stages up to the append being released, storage nodes those of "
+           "processing the STOREs of the appends sampled by the sequencer.  "
+           "Each node measures its own stages, so the \"replication\" stage "
+           "of a sequencer includes the storage stages of the copies it "
+           "waited for, plus the network.";
+  }
+  TableColumns getFetchableColumns() const override {
+    return {
+        {"name",
+         DataType::TEXT,
+         "Name of the stage, in the order in which stages happen."},
+        {"unit", DataType::TEXT, "Unit of the values."},
+        {"min", DataType::REAL, "Minimum time spent in the stage."},
+        {"p50", DataType::REAL, "Median time spent in the stage."},
+        {"p75", DataType::REAL, "75th percentile."},
+        {"p95", DataType::REAL, "95th percentile."},
+        {"p99", DataType::REAL, "99th percentile."},
+        {"p99_99", DataType::REAL, "99.99th percentile."},
+        {"max", DataType::REAL, "Maximum time spent in the stage."},
+        {"count", DataType::BIGINT, "Number of sampled appends."},
+        {"mean", DataType::REAL, "Average time spent in the stage."}};
+  }
+  std::string getCommandToSend(QueryContext& /*ctx*/) const override {
+    return std::string("stats2 append_stages --json\n");
+  }
+};
+
+}}}} // namespace facebook::logdevice::ldquery::tables
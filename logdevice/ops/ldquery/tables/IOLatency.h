@@ -0,0 +1,56 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "../Context.h"
+#include "AdminCommandTable.h"
+
+namespace facebook {
+  namespace logdevice {
+    namespace ldquery {
+      namespace tables {
+
+class IOLatency : public AdminCommandTable {
+ public:
+  explicit IOLatency(std::shared_ptr<Context> ctx) : AdminCommandTable(ctx) {}
+  static std::string getName() {
+    return "io_latency";
+  }
+  std::string getDescription() override {
+    return "Latency of the IO operations rocksdb does on storage nodes, broken "
+           "down by shard and by what the operation was done for: a write, a "
+           "flush, a compaction, a read stream, a findtime, rebuilding, or "
+           "\"other\".  Only populated when binary IO tracing is on (see "
+           "--rocksdb-io-trace-ring-size).";
+  }
+  TableColumns getFetchableColumns() const override {
+    return {
+        {"name",
+         DataType::TEXT,
+         "What the operations were done for, e.g. \"compaction\"."},
+        {"shard", DataType::INTEGER, "Shard the operations were done on."},
+        {"unit", DataType::TEXT, "Unit of the values."},
+        {"min", DataType::REAL, "Minimum latency."},
+        {"p50", DataType::REAL, "Median latency."},
+        {"p75", DataType::REAL, "75th percentile."},
+        {"p95", DataType::REAL, "95th percentile."},
+        {"p99", DataType::REAL, "99th percentile."},
+        {"p99_99", DataType::REAL, "99.99th percentile."},
+        {"max", DataType::REAL, "Maximum latency."},
+        {"count", DataType::BIGINT, "Number of operations."},
+        {"mean", DataType::REAL, "Average latency."}};
+  }
+  std::string getCommandToSend(QueryContext& /*ctx*/) const override {
+    return std::string("stats2 io_latency --json\n");
+  }
+};
+
+}}}} // namespace facebook::logdevice::ldquery::tables
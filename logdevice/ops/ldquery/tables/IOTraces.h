@@ -0,0 +1,70 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "../Context.h"
+#include "AdminCommandTable.h"
+
+namespace facebook {
+  namespace logdevice {
+    namespace ldquery {
+      namespace tables {
+
+class IOTraces : public AdminCommandTable {
+ public:
+  explicit IOTraces(std::shared_ptr<Context> ctx) : AdminCommandTable(ctx) {}
+  static std::string getName() {
+    return "io_traces";
+  }
+  std::string getDescription() override {
+    return "The most recent IO operations rocksdb did on storage nodes, as "
+           "recorded by binary IO tracing (see --rocksdb-io-trace-ring-size). "
+           " Each thread keeps its last operations, so threads doing little "
+           "IO keep older ones.  At most 1000 operations per node are "
+           "fetched.";
+  }
+  TableColumns getFetchableColumns() const override {
+    return {
+        {"shard", DataType::INTEGER, "Shard the operation was done on."},
+        {"start_time", DataType::TIME, "When the operation started."},
+        {"latency_us",
+         DataType::BIGINT,
+         "How long the operation took, in microseconds."},
+        {"context",
+         DataType::TEXT,
+         "What the operation was done for, e.g. \"flush\" or "
+         "\"read_stream\"."},
+        {"op",
+         DataType::TEXT,
+         "Type of the operation, e.g. \"read\" or \"sync\"."},
+        {"file_type",
+         DataType::TEXT,
+         "Type of the file: \"sst\", \"wal\", \"manifest\", \"directory\" or "
+         "\"other\"."},
+        {"file_number",
+         DataType::BIGINT,
+         "RocksDB file number, null if the file name doesn't have one."},
+        {"cf_id",
+         DataType::BIGINT,
+         "ID of the RocksDB column family flushed or compacted, null for "
+         "other contexts."},
+        {"offset", DataType::BIGINT, "Offset in the file, if applicable."},
+        {"size",
+         DataType::BIGINT,
+         "Number of bytes read or written, if applicable."},
+    };
+  }
+  std::string getCommandToSend(QueryContext& /*ctx*/) const override {
+    return std::string("info io_traces --json\n");
+  }
+};
+
+}}}} // namespace facebook::logdevice::ldquery::tables
@@ -89,6 +89,15 @@ class Sockets : public AdminCommandTable {
         {"fd",
          DataType::INTEGER,
          "The file descriptor of the underlying os socket."},
+        {"copied_mb",
+         DataType::REAL,
+         "Number of bytes written to the Connection that were copied when "
+         "serializing messages."},
+        {"zero_copy_mb",
+         DataType::REAL,
+         "Number of bytes written to the Connection straight from buffers "
+         "shared with the messages, e.g. large payloads, without copying them "
+         "when serializing."},
     };
   }
   std::string getCommandToSend(QueryContext& /*ctx*/) const override {
@@ -28,14 +28,18 @@ class Stats : public AdminCommandTable {
   std::string getDescription() override {
     return "Return statistics for all nodes in the cluster.  See "
            "\"logdevice/common/stats/\".  See \"stats_rocksdb\" for "
-           "statistics related to RocksDB.";
+           "statistics related to RocksDB.  Each nonempty histogram is "
+           "returned as a few counters: \"<name>.count\" and percentiles "
+           "\"<name>.p50\", \"<name>.p90\", \"<name>.p99\", "
+           "\"<name>.p99_9\" and \"<name>.p99_99\", in the histogram's "
+           "unit (microseconds for latencies).";
   }
   TableColumns getFetchableColumns() const override {
     return {{"name", DataType::TEXT, "Name of the stat counter."},
             {"value", DataType::BIGINT, "Value of the stat counter."}};
   }
   std::string getCommandToSend(QueryContext& /*ctx*/) const override {
-    return std::string("stats2\n");
+    return std::string("stats2 --histograms\n");
   }
 };
 
@@ -22,6 +22,7 @@
 #include "logdevice/common/stats/Stats.h"
 #include "logdevice/common/util.h"
 #include "logdevice/server/EpochRecordCacheEntry.h"
+#include "logdevice/server/EpochRecordCacheEntryArena.h"
 #include "logdevice/server/RecordCacheDependencies.h"
 
 namespace facebook { namespace logdevice {
@@ -41,6 +42,7 @@ EpochRecordCache::EpochRecordCache(logid_t log_id,
       deps_(deps),
       tail_optimized_(tail_optimized),
       stored_(stored),
+      arena_(new EpochRecordCacheEntryArena(capacity, deps->getStatsHolder())),
       buffer_(capacity) {
   ld_check(capacity > 0);
   ld_check(deps_ != nullptr);
@@ -139,6 +141,8 @@ EpochRecordCache::~EpochRecordCache() {
   // destruction
   disableCache();
   ld_check(disabled_.load());
+  // entries still referenced elsewhere keep the arena alive
+  arena_->release();
 }
 
 esn_t EpochRecordCache::getLNG() const {
@@ -266,18 +270,19 @@ int EpochRecordCache::putRecord(RecordID rid,
   }
 
   // it is likely that the record will be stored in cache, pre-allocate
-  // its entry
+  // its entry, and the control block of its shared_ptr, in the arena
   auto entry = std::shared_ptr<EpochRecordCacheEntry>(
-      new EpochRecordCacheEntry(rid.lsn(),
-                                flags,
-                                timestamp,
-                                lng,
-                                wave_or_recovery_epoch,
-                                copyset,
-                                offsets_within_epoch,
-                                std::move(keys),
-                                payload_holder),
-      EpochRecordCacheEntry::Disposer(deps_));
+      new (arena_) EpochRecordCacheEntry(rid.lsn(),
+                                         flags,
+                                         timestamp,
+                                         lng,
+                                         wave_or_recovery_epoch,
+                                         copyset,
+                                         offsets_within_epoch,
+                                         std::move(keys),
+                                         payload_holder),
+      EpochRecordCacheEntry::Disposer(deps_),
+      EpochRecordCacheEntryArena::Allocator<EpochRecordCacheEntry>(arena_));
 
   ReleasedVector entries_to_drop;
   int rv = 0;
@@ -479,6 +484,7 @@ void EpochRecordCache::advanceLNG(esn_t new_lng) {
 
     advanceLNGImpl(head, new_lng, entries_to_drop);
   }
+
 }
 
 void EpochRecordCache::amendExistingEntry(
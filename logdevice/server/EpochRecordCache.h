@@ -38,6 +38,7 @@ namespace facebook { namespace logdevice {
  */
 
 class EpochRecordCacheEntry;
+class EpochRecordCacheEntryArena;
 struct RecordID;
 
 namespace EpochRecordCacheSerializer {
@@ -465,6 +466,10 @@ class EpochRecordCache {
   // NOTE: access must be protected by rw_lock_
   TailRecord tail_record_;
 
+  // Entries created by putRecord() are allocated here. The cache owns a
+  // reference to the arena, and each entry another one.
+  EpochRecordCacheEntryArena* const arena_;
+
   // actual buffer for storing (pointers to) cache entries
   CircularBuffer<std::shared_ptr<EpochRecordCacheEntry>> buffer_;
 
@@ -17,12 +17,60 @@
 #include "logdevice/common/stats/Stats.h"
 #include "logdevice/include/Err.h"
 #include "logdevice/server/EpochRecordCache.h"
+#include "logdevice/server/EpochRecordCacheEntryArena.h"
 #include "logdevice/server/RecordCacheDependencies.h"
 
 namespace facebook { namespace logdevice {
 
 using namespace EpochRecordCacheSerializer;
 
+namespace {
+
+EpochRecordCacheEntryArena*& arenaInHeader(void* p) {
+  return *reinterpret_cast<EpochRecordCacheEntryArena**>(
+      static_cast<char*>(p) - EpochRecordCacheEntry::kAllocationHeaderSize);
+}
+
+} // namespace
+
+void* EpochRecordCacheEntry::operator new(size_t size) {
+  return operator new(size, nullptr);
+}
+
+void* EpochRecordCacheEntry::operator new(size_t size,
+                                          EpochRecordCacheEntryArena* arena) {
+  const size_t alloc_size = kAllocationHeaderSize + size;
+  char* p = static_cast<char*>(arena ? arena->allocate(alloc_size)
+                                     : ::operator new(alloc_size));
+  void* entry = p + kAllocationHeaderSize;
+  arenaInHeader(entry) = arena;
+  return entry;
+}
+
+void EpochRecordCacheEntry::operator delete(void* p, size_t size) {
+  EpochRecordCacheEntryArena* arena = arenaInHeader(p);
+  char* header = static_cast<char*>(p) - kAllocationHeaderSize;
+  if (arena) {
+    arena->deallocate(header, kAllocationHeaderSize + size);
+  } else {
+    ::operator delete(header);
+  }
+}
+
+void EpochRecordCacheEntry::operator delete(void* p,
+                                            EpochRecordCacheEntryArena*) {
+  // only called if the constructor throws
+  operator delete(p, sizeof(EpochRecordCacheEntry));
+}
+
+EpochRecordCacheEntryArena* EpochRecordCacheEntry::getArena() const {
+  return arenaInHeader(const_cast<EpochRecordCacheEntry*>(this));
+}
+
+size_t EpochRecordCacheEntry::getCachedBytesEstimate() const {
+  return getArena() != nullptr ? payload.size() : getBytesEstimate();
+}
+
 EpochRecordCacheEntry::EpochRecordCacheEntry() : ZeroCopiedRecord() {}
 
 EpochRecordCacheEntry::EpochRecordCacheEntry(
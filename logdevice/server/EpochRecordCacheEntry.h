@@ -20,6 +20,7 @@
 namespace facebook { namespace logdevice {
 
 class EpochRecordCacheDependencies;
+class EpochRecordCacheEntryArena;
 
 namespace EpochRecordCacheSerializer {
 class EpochRecordCacheCompare;
@@ -28,11 +29,43 @@ class EpochRecordCacheCompare;
 /**
  * Descriptor of one cache entry, contains just enough information for
  * log recovery procedure (i.e., store flags, timestamp and payloads)
+ *
+ * Entries must be created with new. Entries created by EpochRecordCache
+ * itself are allocated in the arena of the epoch (see
+ * EpochRecordCacheEntryArena.h), the others on the heap; either way they are
+ * destroyed with a plain delete.
  */
-class EpochRecordCacheEntry : public ZeroCopiedRecord {
+class EpochRecordCacheEntry final : public ZeroCopiedRecord {
  public:
   class Disposer;
 
+  // Every entry is preceded in memory by a header holding the arena it was
+  // allocated from, or nullptr.
+  static constexpr size_t kAllocationHeaderSize = alignof(std::max_align_t);
+
+  static void* operator new(size_t size);
+  static void* operator new(size_t size, EpochRecordCacheEntryArena* arena);
+  static void operator delete(void* p, size_t size);
+  static void operator delete(void* p, EpochRecordCacheEntryArena* arena);
+
+  /**
+   * @return  arena the entry was allocated from, nullptr if it's on the heap
+   */
+  EpochRecordCacheEntryArena* getArena() const;
+
+  /**
+   * Size of the entry as accounted for in the
+   * record_cache_bytes_cached_estimate stat. Entries in an arena only count
+   * their payload, the rest is part of record_cache_arena_bytes.
+   */
+  size_t getCachedBytesEstimate() const;
+
+  // Same as above for an entry created by EpochRecordCache::putRecord(),
+  // which always uses the arena.
+  static size_t getCachedBytesEstimate(Payload payload_raw) {
+    return payload_raw.size();
+  }
+
   /*
    * Create and repopulate an entry from serialized representation in the
    * given buffer, and with the given disposer. Returns nullptr if the
@@ -0,0 +1,232 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/EpochRecordCacheEntryArena.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <new>
+
+#include <folly/lang/Bits.h>
+
+#include "logdevice/common/debug.h"
+#include "logdevice/common/stats/Stats.h"
+#include "logdevice/server/EpochRecordCacheEntry.h"
+
+namespace facebook { namespace logdevice {
+
+namespace {
+
+constexpr size_t kSlotAlignment = alignof(std::max_align_t);
+
+constexpr size_t roundUpToSlot(size_t size) {
+  return (size + kSlotAlignment - 1) / kSlotAlignment * kSlotAlignment;
+}
+
+} // namespace
+
+EpochRecordCacheEntryArena::EpochRecordCacheEntryArena(size_t slab_entries,
+                                                       StatsHolder* stats)
+    : slab_entries_(
+          std::max<size_t>(1, std::min(slab_entries, kMaxSlabEntries))),
+      stats_(stats),
+      small_(roundUpToSlot(kSmallSlotSize)),
+      entries_(roundUpToSlot(EpochRecordCacheEntry::kAllocationHeaderSize +
+                             sizeof(EpochRecordCacheEntry))) {
+  static_assert(sizeof(void*) <= kSmallSlotSize,
+                "slots must fit a free list pointer");
+  const size_t header = roundUpToSlot(sizeof(Slab));
+  for (Pool* pool : {&small_, &entries_}) {
+    auto slab_bytes = [&](size_t slots) {
+      return folly::nextPowTwo(header + pool->slot_size * slots);
+    };
+    pool->max_slab_bytes =
+        std::min(slab_bytes(slab_entries_),
+                 std::max(kMaxSlabBytes, slab_bytes(1)));
+    pool->min_slab_bytes = std::min(
+        slab_bytes(std::min(slab_entries_, kInitialSlabEntries)),
+        pool->max_slab_bytes);
+  }
+}
+
+EpochRecordCacheEntryArena::~EpochRecordCacheEntryArena() {
+  ld_check(refs_.load() == 0);
+  // Nothing is allocated anymore, so all slabs have free slots.
+  for (Pool* pool : {&small_, &entries_}) {
+    while (pool->partial != nullptr) {
+      ld_check(pool->partial->slots_in_use == 0);
+      freeSlab(pool->partial);
+    }
+    ld_check(pool->slabs.empty());
+  }
+  ld_check(bytes_allocated_.load() == 0);
+}
+
+void EpochRecordCacheEntryArena::release() {
+  unref();
+}
+
+void EpochRecordCacheEntryArena::unref() {
+  if (--refs_ == 0) {
+    delete this;
+  }
+}
+
+EpochRecordCacheEntryArena::Pool*
+EpochRecordCacheEntryArena::poolFor(size_t size) {
+  if (size <= small_.slot_size) {
+    return &small_;
+  }
+  if (size <= entries_.slot_size) {
+    return &entries_;
+  }
+  return nullptr;
+}
+
+void EpochRecordCacheEntryArena::linkPartial(Slab* slab) {
+  Pool& pool = *slab->pool;
+  slab->prev = nullptr;
+  slab->next = pool.partial;
+  if (pool.partial != nullptr) {
+    pool.partial->prev = slab;
+  }
+  pool.partial = slab;
+}
+
+void EpochRecordCacheEntryArena::unlinkPartial(Slab* slab) {
+  Pool& pool = *slab->pool;
+  if (slab->prev != nullptr) {
+    slab->prev->next = slab->next;
+  } else {
+    ld_check(pool.partial == slab);
+    pool.partial = slab->next;
+  }
+  if (slab->next != nullptr) {
+    slab->next->prev = slab->prev;
+  }
+  slab->prev = slab->next = nullptr;
+}
+
+void EpochRecordCacheEntryArena::grow(Pool& pool) {
+  // Each slab is twice as big as the previous one, so that the number of
+  // slabs stays logarithmic in the number of slots until they reach the
+  // maximum size.
+  size_t bytes = pool.min_slab_bytes;
+  for (size_t i = 0; i < pool.slabs.size() && bytes < pool.max_slab_bytes;
+       ++i) {
+    bytes *= 2;
+  }
+  void* mem = ::operator new(bytes);
+  Slab* slab = new (mem) Slab();
+  slab->pool = &pool;
+  slab->bytes = bytes;
+  // Thread the slots in address order so that consecutive allocations are
+  // adjacent in memory.
+  const size_t header = roundUpToSlot(sizeof(Slab));
+  const size_t num_slots = (bytes - header) / pool.slot_size;
+  ld_check(num_slots > 0);
+  char* slots = static_cast<char*>(mem) + header;
+  for (size_t i = num_slots; i > 0; --i) {
+    void* slot = slots + (i - 1) * pool.slot_size;
+    *static_cast<void**>(slot) = slab->free_list;
+    slab->free_list = slot;
+  }
+  linkPartial(slab);
+  pool.slabs.insert(std::upper_bound(pool.slabs.begin(),
+                                     pool.slabs.end(),
+                                     slab,
+                                     std::less<Slab*>()),
+                    slab);
+  if (pool.first == nullptr) {
+    pool.first = slab;
+  }
+  bytes_allocated_ += bytes;
+  STAT_ADD(stats_, record_cache_arena_bytes, bytes);
+}
+
+EpochRecordCacheEntryArena::Slab*
+EpochRecordCacheEntryArena::slabOf(Pool& pool, void* p) {
+  // The last slab starting at or before p.
+  auto it = std::upper_bound(pool.slabs.begin(),
+                             pool.slabs.end(),
+                             p,
+                             [](void* addr, Slab* slab) {
+                               return std::less<void*>()(addr, slab);
+                             });
+  ld_check(it != pool.slabs.begin());
+  Slab* slab = *(it - 1);
+  ld_check(static_cast<char*>(p) <
+           reinterpret_cast<char*>(slab) + slab->bytes);
+  return slab;
+}
+
+void EpochRecordCacheEntryArena::freeSlab(Slab* slab) {
+  ld_check(slab->slots_in_use == 0);
+  Pool& pool = *slab->pool;
+  const size_t bytes = slab->bytes;
+  unlinkPartial(slab);
+  auto it = std::lower_bound(
+      pool.slabs.begin(), pool.slabs.end(), slab, std::less<Slab*>());
+  ld_check(it != pool.slabs.end() && *it == slab);
+  pool.slabs.erase(it);
+  if (pool.first == slab) {
+    pool.first = nullptr;
+  }
+  slab->~Slab();
+  ::operator delete(slab);
+  bytes_allocated_ -= bytes;
+  STAT_SUB(stats_, record_cache_arena_bytes, bytes);
+}
+
+void* EpochRecordCacheEntryArena::allocate(size_t size) {
+  Pool* pool = poolFor(size);
+  if (pool == nullptr) {
+    return ::operator new(size);
+  }
+
+  std::lock_guard<folly::SpinLock> guard(lock_);
+  if (pool->partial == nullptr) {
+    grow(*pool);
+  }
+  Slab* slab = pool->partial;
+  void* slot = slab->free_list;
+  slab->free_list = *static_cast<void**>(slot);
+  ++slab->slots_in_use;
+  if (slab->free_list == nullptr) {
+    unlinkPartial(slab);
+  }
+  ++refs_;
+  return slot;
+}
+
+void EpochRecordCacheEntryArena::deallocate(void* p, size_t size) {
+  Pool* pool = poolFor(size);
+  if (pool == nullptr) {
+    ::operator delete(p);
+    return;
+  }
+
+  {
+    std::lock_guard<folly::SpinLock> guard(lock_);
+    Slab* slab = slabOf(*pool, p);
+    ld_check(slab->pool == pool);
+    if (slab->free_list == nullptr) {
+      linkPartial(slab);
+    }
+    *static_cast<void**>(p) = slab->free_list;
+    slab->free_list = p;
+    ld_check(slab->slots_in_use > 0);
+    if (--slab->slots_in_use == 0 && slab != pool->first) {
+      freeSlab(slab);
+    }
+  }
+  unref();
+}
+
+}} // namespace facebook::logdevice
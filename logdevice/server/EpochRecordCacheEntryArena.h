@@ -0,0 +1,214 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <folly/SpinLock.h>
+
+namespace facebook { namespace logdevice {
+
+class StatsHolder;
+
+/**
+ * @file Slab allocator for the entries of one EpochRecordCache, and for the
+ *       shared_ptr control blocks that manage them. Every STORE cached on a
+ *       storage node used to cost two small heap allocations (the entry and
+ *       its control block), freed later on whichever thread dropped the last
+ *       reference; with an arena they come out of a few slabs owned by the
+ *       epoch and are recycled through a free list guarded by a lock that is
+ *       only shared by threads touching the same epoch.
+ *
+ *       Most epochs only ever cache a few records, so the first slab of each
+ *       size class is small and the following ones double in size, up to
+ *       kMaxSlabBytes. Slabs are powers of two, which the heap allocates
+ *       without rounding up, and are filled with as many slots as fit.
+ *
+ *       Each slab counts its slots in use and is returned to the heap as
+ *       soon as the last of them is freed, except for the first slab of each
+ *       size class, which is kept for the next allocations. So the memory of
+ *       the arena, counted in record_cache_arena_bytes, goes down as entries
+ *       are evicted and disposed of. The slab of a slot is found by a binary
+ *       search over the few slabs of its size class. The arena itself is
+ *       freed when the owning EpochRecordCache is gone and the last entry
+ *       allocated from it is destroyed (entries may outlive the cache in read
+ *       streams and snapshots).
+ *
+ *       Allocations larger than the slots fall back to the heap.
+ *
+ *       Thread-safe.
+ */
+
+class EpochRecordCacheEntryArena {
+ public:
+  template <typename T>
+  class Allocator;
+
+  /**
+   * @param slab_entries  number of entries that the largest slabs make room
+   *                      for, usually the capacity of the EpochRecordCache
+   * @param stats         for record_cache_arena_bytes; may be nullptr
+   *
+   * The caller owns one reference to the arena and must drop it with
+   * release() instead of deleting the arena.
+   */
+  EpochRecordCacheEntryArena(size_t slab_entries, StatsHolder* stats);
+
+  EpochRecordCacheEntryArena(const EpochRecordCacheEntryArena&) = delete;
+  EpochRecordCacheEntryArena&
+  operator=(const EpochRecordCacheEntryArena&) = delete;
+
+  /**
+   * Drops the reference held by the creator. The arena destroys itself once
+   * this was called and everything allocated from it was deallocated.
+   */
+  void release();
+
+  /**
+   * @return  memory for @param size bytes aligned for any scalar type.
+   *          Throws std::bad_alloc if the heap is exhausted.
+   */
+  void* allocate(size_t size);
+
+  /**
+   * Returns memory obtained from allocate() with the same @param size.
+   * May destroy the arena.
+   */
+  void deallocate(void* p, size_t size);
+
+  /**
+   * @return  total size of the slabs currently allocated
+   */
+  size_t bytesAllocated() const {
+    return bytes_allocated_.load();
+  }
+
+  // Largest object that goes into a small slot. Big enough for the control
+  // block of a shared_ptr with a stateful deleter and allocator.
+  static constexpr size_t kSmallSlotSize = 64;
+
+  // Never allocate more than this many slots per slab.
+  static constexpr size_t kMaxSlabEntries = 128;
+
+  // The first slab of each size class makes room for this many slots.
+  static constexpr size_t kInitialSlabEntries = 4;
+
+  // Slabs grow up to this size, or to the size that fits slab_entries
+  // slots if that is smaller.
+  static constexpr size_t kMaxSlabBytes = 4096;
+
+ private:
+  struct Pool;
+
+  // Header at the start of each slab. Free slots of the slab form an
+  // intrusive singly linked list.
+  struct Slab {
+    Pool* pool;
+    // Neighbours in the list of slabs of the pool that have free slots.
+    Slab* prev = nullptr;
+    Slab* next = nullptr;
+    void* free_list = nullptr;
+    size_t slots_in_use = 0;
+    // Size of the slab including this header, a power of two.
+    size_t bytes = 0;
+  };
+
+  // Slots of a single size, in slabs of increasing size.
+  struct Pool {
+    explicit Pool(size_t slot_size) : slot_size(slot_size) {}
+
+    const size_t slot_size;
+    // Sizes of the first and of the largest slabs, powers of two.
+    size_t min_slab_bytes = 0;
+    size_t max_slab_bytes = 0;
+    // All slabs, sorted by address. The first one allocated is never freed
+    // before the arena.
+    std::vector<Slab*> slabs;
+    Slab* first = nullptr;
+    // Slabs with at least one free slot.
+    Slab* partial = nullptr;
+  };
+
+  ~EpochRecordCacheEntryArena();
+
+  // Returns the pool serving allocations of @param size, or nullptr if they
+  // should go to the heap.
+  Pool* poolFor(size_t size);
+
+  // Allocates a slab in @param pool, with lock_ held.
+  void grow(Pool& pool);
+
+  // Returns the slab of @param pool that @param p was allocated from, with
+  // lock_ held.
+  static Slab* slabOf(Pool& pool, void* p);
+
+  // Frees an empty slab, with lock_ held.
+  void freeSlab(Slab* slab);
+
+  static void linkPartial(Slab* slab);
+  static void unlinkPartial(Slab* slab);
+
+  // Drops a reference, destroying the arena if it was the last one.
+  void unref();
+
+  const size_t slab_entries_;
+  StatsHolder* const stats_;
+
+  // One reference for the creator and one for every slot in use.
+  std::atomic<size_t> refs_{1};
+  std::atomic<size_t> bytes_allocated_{0};
+
+  folly::SpinLock lock_;
+  Pool small_;
+  Pool entries_;
+};
+
+/**
+ * Standard allocator on top of an arena, used for shared_ptr control blocks.
+ * The arena must stay alive while anything allocated through it does, which
+ * it does by itself as long as deallocate() goes through the same arena.
+ */
+template <typename T>
+class EpochRecordCacheEntryArena::Allocator {
+ public:
+  using value_type = T;
+
+  explicit Allocator(EpochRecordCacheEntryArena* arena) : arena_(arena) {}
+
+  template <typename U>
+  Allocator(const Allocator<U>& other) : arena_(other.arena_) {}
+
+  T* allocate(size_t n) {
+    return static_cast<T*>(arena_->allocate(n * sizeof(T)));
+  }
+
+  void deallocate(T* p, size_t n) {
+    arena_->deallocate(p, n * sizeof(T));
+  }
+
+  template <typename U>
+  bool operator==(const Allocator<U>& other) const {
+    return arena_ == other.arena_;
+  }
+
+  template <typename U>
+  bool operator!=(const Allocator<U>& other) const {
+    return arena_ != other.arena_;
+  }
+
+ private:
+  EpochRecordCacheEntryArena* arena_;
+
+  template <typename U>
+  friend class Allocator;
+};
+
+}} // namespace facebook::logdevice
@@ -29,10 +29,7 @@ CustomCountersAggregateMap doAggregateCustomCounters(StatsHolder* stats,
   CustomCountersAggregateMap output;
 
   stats->runForEach([&](facebook::logdevice::Stats& s) {
-    // Use synchronizedCopy() so we do not have to hold a read lock on
-    // per_log_append_bytes map while we iterate over individual entries.
-    for (auto& entry :
-         s.synchronizedCopy(&facebook::logdevice::Stats::per_log_stats)) {
+    for (auto& entry : s.per_log_stats.snapshot()) {
       std::lock_guard<std::mutex> guard(entry.second->mutex);
       std::string& clean_name = entry.first;
 
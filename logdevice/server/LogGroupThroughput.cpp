@@ -45,14 +45,11 @@ AggregateMap doAggregate(StatsHolder* stats,
   ld_check(member_ptr != nullptr);
 
   stats->runForEach([&](facebook::logdevice::Stats& s) {
-    // Use synchronizedCopy() so we do not have to hold a read lock on
-    // per_log_stats map while we iterate over individual entries.
-    for (auto& entry :
-         s.synchronizedCopy(&facebook::logdevice::Stats::per_log_stats)) {
+    for (auto& entry : s.per_log_stats.snapshot()) {
       std::lock_guard<std::mutex> guard(entry.second->mutex);
       std::string& clean_name = entry.first;
 
-      auto stat = entry.second.get()->*member_ptr;
+      auto stat = entry.second->*member_ptr;
       if (!stat) {
         continue;
       }
@@ -80,15 +80,17 @@ int RecordCache::putRecord(RecordID rid,
 
   if (epoch_cache != nullptr) {
     // common path
-    return epoch_cache->putRecord(rid,
-                                  timestamp,
-                                  lng,
-                                  wave_or_recovery_epoch,
-                                  copyset,
-                                  flags,
-                                  std::move(optional_keys),
-                                  payload_holder,
-                                  std::move(offsets_within_epoch));
+    int rv = epoch_cache->putRecord(rid,
+                                    timestamp,
+                                    lng,
+                                    wave_or_recovery_epoch,
+                                    copyset,
+                                    flags,
+                                    std::move(optional_keys),
+                                    payload_holder,
+                                    std::move(offsets_within_epoch));
+    bumpVersion();
+    return rv;
   }
 
   epoch_t head_epoch_cached = epoch_t(head_epoch_cached_.load());
@@ -198,15 +200,17 @@ int RecordCache::putRecord(RecordID rid,
     ld_check(epoch_cache != nullptr);
   }
 
-  return epoch_cache->putRecord(rid,
-                                timestamp,
-                                lng,
-                                wave_or_recovery_epoch,
-                                copyset,
-                                flags,
-                                std::move(optional_keys),
-                                payload_holder,
-                                std::move(offsets_within_epoch));
+  int rv = epoch_cache->putRecord(rid,
+                                  timestamp,
+                                  lng,
+                                  wave_or_recovery_epoch,
+                                  copyset,
+                                  flags,
+                                  std::move(optional_keys),
+                                  payload_holder,
+                                  std::move(offsets_within_epoch));
+  bumpVersion();
+  return rv;
 }
 
 std::pair<RecordCache::Result, std::shared_ptr<EpochRecordCache>>
@@ -281,6 +285,7 @@ void RecordCache::onLastCleanEpochAdvanced(epoch_t lce) {
     discarded_caches = epoch_caches_.popUpTo(discard_upto.val_);
 
     head_epoch_cached_.store(discard_upto.val_);
+    bumpVersion();
 
     if (discard_upto == next_epoch_to_cache) {
       // the whole cache is cleared
@@ -320,6 +325,7 @@ void RecordCache::onRelease(lsn_t last_released) {
           deps_->getSeal(log_id_, shard_, /*soft=*/false);
       if (!seal.has_value() || seal.value().epoch < release_epoch) {
         epoch_cache->advanceLNG(release_esn);
+        bumpVersion();
       }
     }
   }
@@ -355,6 +361,7 @@ void RecordCache::updateLastNonAuthoritativeEpoch(logid_t logid) {
     atomic_fetch_min(
         last_nonauthoritative_epoch_, lsn_to_epoch(highest_lsn).val_);
   }
+  bumpVersion();
 
   if (folly::kIsDebug) {
     if (last_nonauthoritative_epoch_.load() != EPOCH_MAX.val_) {
@@ -372,6 +379,7 @@ void RecordCache::updateLastNonAuthoritativeEpoch(logid_t logid) {
 
 void RecordCache::neverStored() {
   last_nonauthoritative_epoch_.store(EPOCH_INVALID.val_);
+  bumpVersion();
 }
 
 void RecordCache::shutdown() {
@@ -420,6 +428,7 @@ void RecordCache::evictResetEpochImpl(epoch_t epoch) {
           EpochRecordCache::StoredBefore::MAYBE));
 
   ld_check(epoch_cache != nullptr);
+  bumpVersion();
   STAT_INCR(deps_->getStatsHolder(), record_cache_epoch_evicted_by_reset);
 }
 
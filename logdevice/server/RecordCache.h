@@ -186,6 +186,15 @@ class RecordCache {
    */
   void shutdown();
 
+  /**
+   * @return  a counter bumped after every change that may affect the output
+   *          of toLinearBuffer(). Used to tell which caches changed since
+   *          they were last persisted.
+   */
+  uint64_t getVersion() const {
+    return version_.load();
+  }
+
   /**
    * Adds a row for each epoch in cache.
    */
@@ -266,6 +275,13 @@ class RecordCache {
   // indicate the record cache is shutdown and shouldn't take new writes
   std::atomic<bool> shutdown_{false};
 
+  // see getVersion()
+  std::atomic<uint64_t> version_{0};
+
+  void bumpVersion() {
+    version_.fetch_add(1, std::memory_order_release);
+  }
+
   // actual implementation for evictResetEpoch(), must be called under
   // mutex_
   void evictResetEpochImpl(epoch_t epoch);
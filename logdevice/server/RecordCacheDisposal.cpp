@@ -40,8 +40,9 @@ void RecordCacheDisposal::disposeOfCacheEntry(
   entry->next_.reset();
 
   auto stats = owner_->getStats();
-  STAT_SUB(
-      stats, record_cache_bytes_cached_estimate, entry->getBytesEstimate());
+  STAT_SUB(stats,
+           record_cache_bytes_cached_estimate,
+           entry->getCachedBytesEstimate());
   STAT_INCR(stats, record_cache_records_evicted);
 
   // Free the payload so that it can deallocated on the right thread.
@@ -0,0 +1,338 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/RecordCacheFile.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <folly/FileUtil.h>
+#include <folly/hash/Checksum.h>
+
+#include "logdevice/common/debug.h"
+#include "logdevice/include/Err.h"
+
+namespace facebook { namespace logdevice {
+
+using namespace RecordCacheFile;
+
+namespace {
+
+uint32_t entryChecksum(uint64_t log_id, Slice blob) {
+  const uint64_t size = blob.size;
+  uint32_t checksum = folly::crc32c(
+      reinterpret_cast<const uint8_t*>(&log_id), sizeof(log_id));
+  checksum = folly::crc32c(
+      reinterpret_cast<const uint8_t*>(&size), sizeof(size), checksum);
+  return folly::crc32c(
+      reinterpret_cast<const uint8_t*>(blob.data), blob.size, checksum);
+}
+
+uint32_t trailerChecksum(uint64_t index_offset) {
+  return folly::crc32c(
+      reinterpret_cast<const uint8_t*>(&index_offset), sizeof(index_offset));
+}
+
+size_t padding(size_t size) {
+  return (kAlignment - size % kAlignment) % kAlignment;
+}
+
+} // namespace
+
+std::unique_ptr<RecordCacheFileWriter>
+RecordCacheFileWriter::create(const std::string& path) {
+  int fd = folly::openNoInt(
+      path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    ld_error("Failed to create record cache file %s: %s",
+             path.c_str(),
+             strerror(errno));
+    err = E::FAILED;
+    return nullptr;
+  }
+
+  std::unique_ptr<RecordCacheFileWriter> writer(
+      new RecordCacheFileWriter(path, fd));
+  const FileHeader header{FILE_MAGIC, CURRENT_VERSION};
+  if (folly::writeFull(fd, &header, sizeof(header)) != sizeof(header)) {
+    ld_error("Failed to write header of record cache file %s: %s",
+             path.c_str(),
+             strerror(errno));
+    err = E::FAILED;
+    return nullptr;
+  }
+  writer->offset_ = sizeof(header);
+  return writer;
+}
+
+RecordCacheFileWriter::RecordCacheFileWriter(std::string path, int fd)
+    : path_(std::move(path)), fd_(fd) {}
+
+RecordCacheFileWriter::~RecordCacheFileWriter() {
+  folly::closeNoInt(fd_);
+}
+
+int RecordCacheFileWriter::writeEntry(uint64_t log_id, Slice blob) {
+  if (failed_) {
+    err = E::FAILED;
+    return -1;
+  }
+
+  const EntryHeader header{
+      ENTRY_MAGIC, entryChecksum(log_id, blob), log_id, blob.size};
+  static const char zeros[kAlignment] = {};
+  iovec iov[3];
+  iov[0].iov_base = const_cast<EntryHeader*>(&header);
+  iov[0].iov_len = sizeof(header);
+  iov[1].iov_base = const_cast<void*>(blob.data);
+  iov[1].iov_len = blob.size;
+  iov[2].iov_base = const_cast<char*>(zeros);
+  iov[2].iov_len = padding(blob.size);
+
+  const size_t total = sizeof(header) + blob.size + padding(blob.size);
+  ssize_t rv = folly::writevFull(fd_, iov, 3);
+  if (rv < 0 || size_t(rv) != total) {
+    ld_error("Failed to append %zu bytes to record cache file %s: %s",
+             total,
+             path_.c_str(),
+             strerror(errno));
+    // the file may end with a partial entry, give up on it
+    failed_ = true;
+    err = E::FAILED;
+    return -1;
+  }
+  offset_ += total;
+  return 0;
+}
+
+int RecordCacheFileWriter::append(logid_t log_id, Slice blob) {
+  ld_check(log_id != LOGID_INVALID);
+  ld_check(!sealed_);
+  const uint64_t offset = offset_;
+  if (writeEntry(log_id.val_, blob) != 0) {
+    return -1;
+  }
+
+  auto res = index_.emplace(log_id, Location{offset, blob.size});
+  if (!res.second) {
+    live_bytes_ -= res.first->second.size;
+    res.first->second = Location{offset, blob.size};
+  }
+  live_bytes_ += blob.size;
+  return 0;
+}
+
+void RecordCacheFileWriter::remove(logid_t log_id) {
+  auto it = index_.find(log_id);
+  if (it != index_.end()) {
+    live_bytes_ -= it->second.size;
+    index_.erase(it);
+  }
+}
+
+int RecordCacheFileWriter::seal() {
+  ld_check(!sealed_);
+  std::vector<IndexEntry> index;
+  index.reserve(index_.size());
+  for (const auto& kv : index_) {
+    index.push_back(IndexEntry{kv.first.val_, kv.second.offset});
+  }
+
+  const uint64_t index_offset = offset_;
+  if (writeEntry(LOGID_INVALID.val_,
+                 Slice(index.data(), index.size() * sizeof(IndexEntry))) !=
+      0) {
+    return -1;
+  }
+
+  const Trailer trailer{
+      index_offset, trailerChecksum(index_offset), TRAILER_MAGIC};
+  if (folly::writeFull(fd_, &trailer, sizeof(trailer)) != sizeof(trailer) ||
+      folly::fsyncNoInt(fd_) != 0) {
+    ld_error("Failed to seal record cache file %s: %s",
+             path_.c_str(),
+             strerror(errno));
+    failed_ = true;
+    err = E::FAILED;
+    return -1;
+  }
+  offset_ += sizeof(trailer);
+  sealed_ = true;
+  return 0;
+}
+
+std::unique_ptr<RecordCacheFileReader>
+RecordCacheFileReader::open(const std::string& path) {
+  int fd = folly::openNoInt(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    if (errno == ENOENT) {
+      err = E::NOTFOUND;
+    } else {
+      ld_error("Failed to open record cache file %s: %s",
+               path.c_str(),
+               strerror(errno));
+      err = E::FAILED;
+    }
+    return nullptr;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    ld_error("Failed to stat record cache file %s: %s",
+             path.c_str(),
+             strerror(errno));
+    folly::closeNoInt(fd);
+    err = E::FAILED;
+    return nullptr;
+  }
+  const size_t size = st.st_size;
+  if (size < sizeof(FileHeader) + sizeof(EntryHeader) + sizeof(Trailer)) {
+    ld_warning("Record cache file %s is too small (%zu bytes), ignoring it",
+               path.c_str(),
+               size);
+    folly::closeNoInt(fd);
+    err = E::BADMSG;
+    return nullptr;
+  }
+
+  // The mapping outlives the file descriptor, and the file itself once it
+  // gets unlinked.
+  void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  folly::closeNoInt(fd);
+  if (data == MAP_FAILED) {
+    ld_error("Failed to mmap record cache file %s of size %zu: %s",
+             path.c_str(),
+             size,
+             strerror(errno));
+    err = E::FAILED;
+    return nullptr;
+  }
+  std::unique_ptr<RecordCacheFileReader> reader(
+      new RecordCacheFileReader(static_cast<const char*>(data), size));
+
+  FileHeader header;
+  memcpy(&header, reader->data_, sizeof(header));
+  if (header.magic != FILE_MAGIC || header.version != CURRENT_VERSION) {
+    ld_warning("Record cache file %s has an unexpected header (magic %x, "
+               "version %u), ignoring it",
+               path.c_str(),
+               header.magic,
+               header.version);
+    err = E::BADMSG;
+    return nullptr;
+  }
+
+  Trailer trailer;
+  memcpy(&trailer, reader->data_ + size - sizeof(trailer), sizeof(trailer));
+  if (trailer.magic != TRAILER_MAGIC ||
+      trailer.checksum != trailerChecksum(trailer.index_offset) ||
+      trailer.index_offset < sizeof(FileHeader) ||
+      trailer.index_offset > size - sizeof(trailer)) {
+    ld_warning("Record cache file %s was not sealed, ignoring it",
+               path.c_str());
+    err = E::BADMSG;
+    return nullptr;
+  }
+
+  Slice index;
+  if (reader->readEntry(trailer.index_offset, LOGID_INVALID.val_, &index) !=
+          0 ||
+      index.size % sizeof(IndexEntry) != 0) {
+    ld_warning("Index of record cache file %s is corrupted, ignoring it",
+               path.c_str());
+    err = E::BADMSG;
+    return nullptr;
+  }
+
+  const size_t nentries = index.size / sizeof(IndexEntry);
+  reader->index_.reserve(nentries);
+  for (size_t i = 0; i < nentries; ++i) {
+    IndexEntry entry;
+    memcpy(&entry,
+           static_cast<const char*>(index.data) + i * sizeof(IndexEntry),
+           sizeof(entry));
+    const uint64_t log_id = entry.log_id;
+    const uint64_t offset = entry.offset;
+    if (log_id == LOGID_INVALID.val_ || offset >= trailer.index_offset ||
+        !reader->index_.emplace(logid_t(log_id), offset).second) {
+      ld_warning("Index of record cache file %s has an invalid entry for log "
+                 "%lu at offset %lu, ignoring the file",
+                 path.c_str(),
+                 log_id,
+                 offset);
+      err = E::BADMSG;
+      return nullptr;
+    }
+  }
+  return reader;
+}
+
+RecordCacheFileReader::RecordCacheFileReader(const char* data, size_t size)
+    : data_(data), size_(size) {}
+
+RecordCacheFileReader::~RecordCacheFileReader() {
+  munmap(const_cast<char*>(data_), size_);
+}
+
+int RecordCacheFileReader::readEntry(uint64_t offset,
+                                     uint64_t expected_log_id,
+                                     Slice* out) const {
+  if (offset > size_ || size_ - offset < sizeof(EntryHeader)) {
+    err = E::BADMSG;
+    return -1;
+  }
+  EntryHeader header;
+  memcpy(&header, data_ + offset, sizeof(header));
+  const uint64_t max_size = size_ - offset - sizeof(header);
+  if (header.magic != ENTRY_MAGIC || header.log_id != expected_log_id ||
+      header.size > max_size) {
+    err = E::BADMSG;
+    return -1;
+  }
+  const Slice blob(data_ + offset + sizeof(header), header.size);
+  if (header.checksum != entryChecksum(header.log_id, blob)) {
+    err = E::BADMSG;
+    return -1;
+  }
+  *out = blob;
+  return 0;
+}
+
+int RecordCacheFileReader::find(logid_t log_id, Slice* blob_out) const {
+  ld_check(blob_out != nullptr);
+  auto it = index_.find(log_id);
+  if (it == index_.end()) {
+    err = E::NOTFOUND;
+    return -1;
+  }
+  if (readEntry(it->second, log_id.val_, blob_out) != 0) {
+    RATELIMIT_ERROR(std::chrono::seconds(10),
+                    10,
+                    "Record cache of log %lu at offset %lu in a record cache "
+                    "file is corrupted",
+                    log_id.val_,
+                    it->second);
+    return -1;
+  }
+  return 0;
+}
+
+std::vector<logid_t> RecordCacheFileReader::logs() const {
+  std::vector<logid_t> res;
+  res.reserve(index_.size());
+  for (const auto& kv : index_) {
+    res.push_back(kv.first);
+  }
+  return res;
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,226 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "logdevice/common/types_internal.h"
+#include "logdevice/include/types.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file  Append-only file holding serialized record caches (see
+ *        RecordCacheSerializer) for the logs of one shard, and an index
+ *        of the latest copy for every log. Record caches are appended to it
+ *        while the server is running, whenever they change, so that only
+ *        caches that changed recently are left to write on shutdown. Once
+ *        everything is written the file is sealed with the index.
+ *
+ *        The next instance maps the file into memory, reads the index (not
+ *        the caches) and deserializes the cache of a log on first access.
+ *
+ *        Layout, integers in host byte order since the file is only ever
+ *        read by the node that wrote it:
+ *
+ *          FileHeader
+ *          entries        EntryHeader, blob, padding to kAlignment bytes
+ *          index entry    an entry for LOGID_INVALID with an array of
+ *                         IndexEntry as its blob
+ *          Trailer        offset of the index entry
+ *
+ *        Every entry is checksummed. A file without a valid trailer was not
+ *        sealed, e.g. because the server crashed, and must not be used: the
+ *        caches in it may be missing records stored later, while a cache
+ *        missing from the file is simply rebuilt from the local log store.
+ */
+
+namespace RecordCacheFile {
+
+constexpr uint32_t FILE_MAGIC = 0x43524C44; // "LDRC"
+constexpr uint32_t ENTRY_MAGIC = 0xCACE0E17;
+constexpr uint32_t TRAILER_MAGIC = 0x4C414553; // "SEAL"
+constexpr uint32_t CURRENT_VERSION = 1;
+constexpr size_t kAlignment = 8;
+
+// Name of the file in the directory of the shard.
+constexpr const char* FILE_NAME = "RECORD_CACHE";
+
+struct FileHeader {
+  uint32_t magic;
+  uint32_t version;
+} __attribute__((__packed__));
+
+struct EntryHeader {
+  uint32_t magic;
+  // crc32c of log_id, size and the blob
+  uint32_t checksum;
+  uint64_t log_id;
+  uint64_t size;
+} __attribute__((__packed__));
+
+struct IndexEntry {
+  uint64_t log_id;
+  // offset of the EntryHeader
+  uint64_t offset;
+} __attribute__((__packed__));
+
+struct Trailer {
+  uint64_t index_offset;
+  // crc32c of index_offset
+  uint32_t checksum;
+  uint32_t magic;
+} __attribute__((__packed__));
+
+static_assert(sizeof(FileHeader) % kAlignment == 0, "");
+static_assert(sizeof(EntryHeader) % kAlignment == 0, "");
+static_assert(sizeof(IndexEntry) % kAlignment == 0, "");
+static_assert(sizeof(Trailer) % kAlignment == 0, "");
+
+} // namespace RecordCacheFile
+
+/**
+ * Writes a record cache file. Not thread-safe.
+ */
+class RecordCacheFileWriter {
+ public:
+  /**
+   * Creates the file at @param path, replacing any existing file.
+   *
+   * @return  the writer, or nullptr with err set to E::FAILED if the file
+   *          could not be created.
+   */
+  static std::unique_ptr<RecordCacheFileWriter>
+  create(const std::string& path);
+
+  /**
+   * Closes the file without sealing it.
+   */
+  ~RecordCacheFileWriter();
+
+  RecordCacheFileWriter(const RecordCacheFileWriter&) = delete;
+  RecordCacheFileWriter& operator=(const RecordCacheFileWriter&) = delete;
+
+  /**
+   * Appends @param blob as the latest record cache of @param log_id.
+   *
+   * @return  0 on success, -1 with err set to E::FAILED on a write error,
+   *          after which the file can no longer be sealed.
+   */
+  int append(logid_t log_id, Slice blob);
+
+  /**
+   * Drops @param log_id from the index, e.g. if its latest cache could not be
+   * appended and the previous copy is stale.
+   */
+  void remove(logid_t log_id);
+
+  /**
+   * Writes the index and the trailer and syncs the file. Nothing may be
+   * appended after that.
+   *
+   * @return  0 on success, -1 with err set to E::FAILED otherwise.
+   */
+  int seal();
+
+  const std::string& path() const {
+    return path_;
+  }
+
+  // Size of the file so far.
+  size_t size() const {
+    return offset_;
+  }
+
+  // Total size of the latest entries of all logs in the index.
+  size_t liveBytes() const {
+    return live_bytes_;
+  }
+
+  size_t numLogs() const {
+    return index_.size();
+  }
+
+ private:
+  struct Location {
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  RecordCacheFileWriter(std::string path, int fd);
+
+  int writeEntry(uint64_t log_id, Slice blob);
+
+  const std::string path_;
+  int fd_;
+  uint64_t offset_ = 0;
+  size_t live_bytes_ = 0;
+  bool failed_ = false;
+  bool sealed_ = false;
+  std::unordered_map<logid_t, Location> index_;
+};
+
+/**
+ * Maps a sealed record cache file into memory. Only the index is read when
+ * the file is opened; the pages holding a cache are faulted in when it is
+ * looked up. Thread-safe.
+ */
+class RecordCacheFileReader {
+ public:
+  /**
+   * @return  the reader, or nullptr with err set to
+   *            E::NOTFOUND  if there is no file at @param path,
+   *            E::BADMSG    if the file is not sealed or its header, trailer or
+   *                         index are corrupted,
+   *            E::FAILED    if the file could not be read.
+   */
+  static std::unique_ptr<RecordCacheFileReader> open(const std::string& path);
+
+  ~RecordCacheFileReader();
+
+  RecordCacheFileReader(const RecordCacheFileReader&) = delete;
+  RecordCacheFileReader& operator=(const RecordCacheFileReader&) = delete;
+
+  /**
+   * Looks up the record cache of @param log_id, verifying its checksum.
+   *
+   * @param blob_out  set to the serialized cache, which points into the file
+   *                  and stays valid for the lifetime of the reader
+   * @return  0 on success, -1 with err set to E::NOTFOUND if the file has no
+   *          cache for the log, or E::BADMSG if its entry is corrupted.
+   */
+  int find(logid_t log_id, Slice* blob_out) const;
+
+  // All logs in the index.
+  std::vector<logid_t> logs() const;
+
+  size_t numLogs() const {
+    return index_.size();
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+ private:
+  RecordCacheFileReader(const char* data, size_t size);
+
+  // Validates the entry at @param offset, returning its blob.
+  int readEntry(uint64_t offset, uint64_t expected_log_id, Slice* out) const;
+
+  const char* const data_;
+  const size_t size_;
+  std::unordered_map<logid_t, uint64_t> index_;
+};
+
+}} // namespace facebook::logdevice
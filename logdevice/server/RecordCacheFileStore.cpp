@@ -0,0 +1,313 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/RecordCacheFileStore.h"
+
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+#include "logdevice/common/debug.h"
+#include "logdevice/common/stats/Stats.h"
+#include "logdevice/include/Err.h"
+#include "logdevice/server/RecordCache.h"
+#include "logdevice/server/read_path/LogStorageStateMap.h"
+
+namespace facebook { namespace logdevice {
+
+// Don't bother starting a new file while the current one is smaller than this.
+static const size_t MIN_ROTATION_BYTES = 64 * 1024 * 1024;
+
+RecordCacheFileStore::RecordCacheFileStore(shard_size_t num_shards,
+                                           StatsHolder* stats)
+    : stats_(stats) {
+  for (shard_index_t s = 0; s < num_shards; ++s) {
+    shards_.push_back(std::make_unique<Shard>());
+  }
+}
+
+RecordCacheFileStore::~RecordCacheFileStore() = default;
+
+int RecordCacheFileStore::removeFile(const std::string& path) {
+  if (unlink(path.c_str()) != 0 && errno != ENOENT) {
+    ld_error("Failed to remove record cache file %s: %s",
+             path.c_str(),
+             strerror(errno));
+    err = E::FAILED;
+    return -1;
+  }
+  return 0;
+}
+
+int RecordCacheFileStore::openShard(shard_index_t shard_idx,
+                                    std::string path,
+                                    size_t bytes_limit) {
+  ld_check(shard_idx < shards_.size());
+  Shard& shard = *shards_[shard_idx];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  std::lock_guard<std::mutex> restore_lock(shard.restore_mutex);
+  ld_check(shard.writer == nullptr);
+  ld_check(shard.reader == nullptr);
+  shard.bytes_limit = bytes_limit;
+
+  shard.reader = RecordCacheFileReader::open(path);
+  if (shard.reader != nullptr) {
+    for (logid_t log_id : shard.reader->logs()) {
+      shard.not_restored.insert(log_id);
+    }
+    ld_info("Restoring record caches of %zu logs on shard %d from %s (%zu "
+            "bytes) on first access",
+            shard.not_restored.size(),
+            shard_idx,
+            path.c_str(),
+            shard.reader->size());
+    if (shard.not_restored.empty()) {
+      shard.reader.reset();
+    }
+  } else if (err != E::NOTFOUND) {
+    ld_warning("Not restoring record caches of shard %d from %s: %s",
+               shard_idx,
+               path.c_str(),
+               error_name(err));
+  }
+  shard.restoring.store(shard.reader != nullptr);
+
+  // The shard is about to take writes, which the caches in the old file
+  // won't reflect. It must be gone, or at least no longer sealed, before that.
+  // The mapping stays valid after the file is unlinked.
+  if (removeFile(path) != 0) {
+    return -1;
+  }
+  shard.writer = RecordCacheFileWriter::create(path);
+  if (shard.writer == nullptr) {
+    ld_error("Record caches of shard %d will not be persisted", shard_idx);
+  }
+  return 0;
+}
+
+std::unique_ptr<RecordCache>
+RecordCacheFileStore::restore(logid_t log_id,
+                              shard_index_t shard_idx,
+                              RecordCacheDependencies* deps) {
+  ld_check(shard_idx < shards_.size());
+  Shard& shard = *shards_[shard_idx];
+  if (!shard.restoring.load()) {
+    return nullptr;
+  }
+
+  std::shared_ptr<RecordCacheFileReader> reader;
+  {
+    std::lock_guard<std::mutex> restore_lock(shard.restore_mutex);
+    if (shard.reader == nullptr || shard.not_restored.erase(log_id) == 0) {
+      return nullptr;
+    }
+    reader = shard.reader;
+    if (shard.not_restored.empty()) {
+      ld_info("Restored all persisted record caches on shard %d", shard_idx);
+      shard.restoring.store(false);
+      shard.reader.reset();
+    }
+  }
+
+  // The log is claimed, no one else will look it up. Checksumming and
+  // deserializing may take a while for large caches, so do it without
+  // holding up other logs of the shard.
+  std::unique_ptr<RecordCache> cache;
+  Slice blob;
+  if (reader->find(log_id, &blob) == 0) {
+    cache = RecordCache::fromLinearBuffer(
+        static_cast<const char*>(blob.data), blob.size, deps, shard_idx);
+    if (cache == nullptr) {
+      RATELIMIT_ERROR(std::chrono::seconds(10),
+                      10,
+                      "Failed to deserialize persisted record cache of log "
+                      "%lu on shard %d",
+                      log_id.val_,
+                      shard_idx);
+      STAT_INCR(stats_, record_cache_repopulations_failed);
+    } else {
+      STAT_INCR(stats_, record_cache_file_logs_restored);
+      STAT_ADD(stats_, record_cache_repopulated_bytes, blob.size);
+      // like RecordCacheRepopulationTask, account for the restored entries
+      STAT_ADD(stats_, record_cache_bytes_cached_estimate, blob.size);
+    }
+  } else {
+    STAT_INCR(stats_, record_cache_repopulations_failed);
+  }
+  return cache;
+}
+
+void RecordCacheFileStore::maybeRotate(shard_index_t shard_idx, Shard& shard) {
+  if (shard.writer == nullptr || shard.writer->size() < MIN_ROTATION_BYTES ||
+      shard.writer->size() < 2 * shard.writer->liveBytes()) {
+    return;
+  }
+  // Caches persisted so far will be appended again once stable, or on
+  // shutdown.
+  const std::string path = shard.writer->path();
+  ld_info("Starting a new record cache file for shard %d: %zu of the %zu "
+          "bytes in %s are live",
+          shard_idx,
+          shard.writer->liveBytes(),
+          shard.writer->size(),
+          path.c_str());
+  shard.writer.reset();
+  shard.persisted_versions.clear();
+  shard.writer = RecordCacheFileWriter::create(path);
+}
+
+void RecordCacheFileStore::persist(shard_index_t shard_idx,
+                                   Shard& shard,
+                                   LogStorageStateMap& map,
+                                   bool stable_only) {
+  if (shard.writer == nullptr) {
+    return;
+  }
+  RecordCacheFileWriter& writer = *shard.writer;
+
+  std::vector<char> buffer;
+  std::unordered_map<logid_t, uint64_t> seen_versions;
+  size_t logs_written = 0;
+  size_t bytes_written = 0;
+  size_t logs_dropped = 0;
+
+  auto callback = [&](logid_t log_id, const LogStorageState& state) {
+    const RecordCache* cache = state.record_cache_.get();
+    if (cache == nullptr) {
+      return 0;
+    }
+    // Read before serializing: a change made meanwhile bumps the version
+    // again and gets the cache persisted next time.
+    const uint64_t version = cache->getVersion();
+    auto persisted = shard.persisted_versions.find(log_id);
+    if (persisted != shard.persisted_versions.end() &&
+        persisted->second == version) {
+      return 0;
+    }
+    if (stable_only) {
+      seen_versions[log_id] = version;
+      auto seen = shard.seen_versions.find(log_id);
+      if (seen == shard.seen_versions.end() || seen->second != version) {
+        return 0;
+      }
+    }
+
+    ssize_t size = cache->sizeInLinearBuffer();
+    ssize_t linear_size = -1;
+    if (size >= 0 &&
+        (shard.bytes_limit == 0 ||
+         writer.liveBytes() + size <= shard.bytes_limit)) {
+      buffer.resize(size);
+      linear_size = cache->toLinearBuffer(buffer.data(), size);
+    }
+    if (linear_size < 0) {
+      // Disabled, over the limit, or grew while being serialized. Either way
+      // the copy in the file, if any, is stale.
+      writer.remove(log_id);
+      shard.persisted_versions.erase(log_id);
+      ++logs_dropped;
+      return 0;
+    }
+
+    if (writer.append(log_id, Slice(buffer.data(), linear_size)) != 0) {
+      return -1;
+    }
+    shard.persisted_versions[log_id] = version;
+    ++logs_written;
+    bytes_written += linear_size;
+    return 0;
+  };
+
+  int rv = map.forEachLogOnShard(shard_idx, callback);
+  STAT_ADD(stats_, record_cache_file_bytes_written, bytes_written);
+  if (rv != 0) {
+    ld_error("Giving up on persisting record caches of shard %d to %s",
+             shard_idx,
+             writer.path().c_str());
+    shard.writer.reset();
+    shard.persisted_versions.clear();
+    return;
+  }
+  if (stable_only) {
+    shard.seen_versions = std::move(seen_versions);
+  }
+
+  if (logs_dropped > 0) {
+    RATELIMIT_WARNING(std::chrono::seconds(10),
+                      1,
+                      "Could not persist record caches of %zu logs on shard "
+                      "%d, e.g. because of the limit of %zu bytes per shard",
+                      logs_dropped,
+                      shard_idx,
+                      shard.bytes_limit);
+  }
+  ld_debug("Appended record caches of %zu logs on shard %d, %zu bytes",
+           logs_written,
+           shard_idx,
+           bytes_written);
+}
+
+void RecordCacheFileStore::persistStable(shard_index_t shard_idx,
+                                         LogStorageStateMap& map) {
+  ld_check(shard_idx < shards_.size());
+  Shard& shard = *shards_[shard_idx];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  maybeRotate(shard_idx, shard);
+  persist(shard_idx, shard, map, /* stable_only */ true);
+}
+
+int RecordCacheFileStore::persistAndSeal(shard_index_t shard_idx,
+                                         LogStorageStateMap& map) {
+  ld_check(shard_idx < shards_.size());
+  Shard& shard = *shards_[shard_idx];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  persist(shard_idx, shard, map, /* stable_only */ false);
+  if (shard.writer == nullptr) {
+    ld_error("Not persisting record caches of shard %d", shard_idx);
+    return -1;
+  }
+  RecordCacheFileWriter& writer = *shard.writer;
+
+  size_t logs_carried_over = 0;
+  {
+    std::lock_guard<std::mutex> restore_lock(shard.restore_mutex);
+    for (logid_t log_id : shard.not_restored) {
+      // A LogStorageState created before the shard was opened has its own
+      // cache, which was persisted above.
+      if (map.find(log_id, shard_idx) != nullptr) {
+        continue;
+      }
+      Slice blob;
+      if (shard.reader->find(log_id, &blob) != 0 ||
+          (shard.bytes_limit > 0 &&
+           writer.liveBytes() + blob.size > shard.bytes_limit)) {
+        continue;
+      }
+      if (writer.append(log_id, blob) != 0) {
+        shard.writer.reset();
+        return -1;
+      }
+      ++logs_carried_over;
+    }
+  }
+
+  if (writer.seal() != 0) {
+    shard.writer.reset();
+    return -1;
+  }
+  ld_info("Persisted record caches of %zu logs on shard %d to %s, including "
+          "%zu carried over from the previous file, totaling %zu bytes.",
+          writer.numLogs(),
+          shard_idx,
+          writer.path().c_str(),
+          logs_carried_over,
+          writer.liveBytes());
+  shard.writer.reset();
+  return 0;
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,159 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "logdevice/common/types_internal.h"
+#include "logdevice/include/types.h"
+#include "logdevice/server/RecordCacheFile.h"
+
+namespace facebook { namespace logdevice {
+
+class LogStorageStateMap;
+class RecordCache;
+class RecordCacheDependencies;
+class StatsHolder;
+
+/**
+ * @file  Keeps record caches of all shards persisted in record cache files
+ *        (see RecordCacheFile.h) when --persist-record-caches-to-file is set,
+ *        and restores them after a restart.
+ *
+ *        While the server runs, the record cache monitor thread periodically
+ *        appends caches that changed since they were last written but have
+ *        not changed for a whole interval since, so that hot logs are not
+ *        written over and over. On shutdown, the last storage thread of each
+ *        shard appends the rest and seals the file.
+ *
+ *        On startup, the sealed file left by the previous instance is mapped
+ *        into memory and removed from the directory, and the cache of a log is
+ *        only deserialized when its LogStorageState is first created. Caches
+ *        no log asked for are carried over into the new file on shutdown.
+ *
+ *        Thread-safe; calls for the same shard are serialized.
+ */
+
+class RecordCacheFileStore {
+ public:
+  RecordCacheFileStore(shard_size_t num_shards, StatsHolder* stats);
+  ~RecordCacheFileStore();
+
+  /**
+   * Called on startup on a storage thread of every enabled shard, before the
+   * shard serves reads or writes. Maps the file left at @param path by the
+   * previous instance if it was sealed, and starts a new file in its place.
+   *
+   * If the new file cannot be created, record caches of the shard are not
+   * persisted, but may still be restored.
+   *
+   * @param bytes_limit  maximum total size of the caches persisted for the
+   *                     shard, 0 for unlimited
+   * @return  0 on success, -1 with err set to E::FAILED if the old file could
+   *          not be removed. The next instance may then restore stale caches
+   *          from it, so the shard must not be used.
+   */
+  int openShard(shard_index_t shard, std::string path, size_t bytes_limit);
+
+  /**
+   * @return  the record cache of @param log_id persisted by the previous
+   *          instance, at most once per log, or nullptr if there is none
+   *          or it could not be read. The cache is deserialized without
+   *          holding up restores of other logs.
+   */
+  std::unique_ptr<RecordCache> restore(logid_t log_id,
+                                       shard_index_t shard,
+                                       RecordCacheDependencies* deps);
+
+  /**
+   * Appends the caches of logs on @param shard that changed since they were
+   * last persisted and have not changed since the previous call. Called
+   * periodically by the record cache monitor thread.
+   */
+  void persistStable(shard_index_t shard, LogStorageStateMap& map);
+
+  /**
+   * Appends all caches of logs on @param shard that changed since they were
+   * last persisted, carries over caches restored from the previous file that
+   * were never asked for, and seals the file. Called on shutdown once the
+   * shard no longer takes writes.
+   *
+   * @return  0 on success, -1 if the file could not be sealed
+   */
+  int persistAndSeal(shard_index_t shard, LogStorageStateMap& map);
+
+  /**
+   * Removes the record cache file at @param path if there is one, e.g. if
+   * record caches are no longer persisted to files. A file left behind would
+   * otherwise be used after a later restart with stale contents.
+   *
+   * @return  0 on success or if there is no file, -1 on error
+   */
+  static int removeFile(const std::string& path);
+
+  shard_size_t numShards() const {
+    return shards_.size();
+  }
+
+ private:
+  struct Shard {
+    // protects the state of the file being written; persisting a shard may
+    // take a while and must not hold up restores
+    std::mutex mutex;
+    size_t bytes_limit = 0;
+
+    // file written by this instance, nullptr if it could not be created or
+    // failed
+    std::unique_ptr<RecordCacheFileWriter> writer;
+
+    // RecordCache::getVersion() of the cache last appended to writer
+    std::unordered_map<logid_t, uint64_t> persisted_versions;
+
+    // RecordCache::getVersion() of caches seen by the previous call to
+    // persistStable()
+    std::unordered_map<logid_t, uint64_t> seen_versions;
+
+    // protects reader and not_restored, locked after mutex if both are;
+    // only held to claim a log, caches are deserialized without it
+    std::mutex restore_mutex;
+
+    // file left by the previous instance, and the logs in it that were not
+    // restored yet; reset once every log was claimed, but kept alive by
+    // restores still deserializing from it
+    std::shared_ptr<RecordCacheFileReader> reader;
+    std::unordered_set<logid_t> not_restored;
+
+    // whether reader is set, checked without the mutex
+    std::atomic<bool> restoring{false};
+  };
+
+  // Appends caches of @param shard that changed since last persisted.
+  // If @param stable_only, only those that did not change since the previous
+  // call either.
+  void persist(shard_index_t shard_idx,
+               Shard& shard,
+               LogStorageStateMap& map,
+               bool stable_only);
+
+  // Starts a new file once the current one is mostly made of caches that
+  // were persisted again later.
+  void maybeRotate(shard_index_t shard_idx, Shard& shard);
+
+  StatsHolder* const stats_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+}} // namespace facebook::logdevice
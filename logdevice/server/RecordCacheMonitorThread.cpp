@@ -7,6 +7,7 @@
  */
 #include "logdevice/server/RecordCacheMonitorThread.h"
 
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <queue>
@@ -15,6 +16,7 @@
 #include "logdevice/common/ThreadID.h"
 #include "logdevice/common/debug.h"
 #include "logdevice/common/stats/Stats.h"
+#include "logdevice/server/RecordCacheFileStore.h"
 #include "logdevice/server/ServerProcessor.h"
 #include "logdevice/server/read_path/LogStorageStateMap.h"
 
@@ -43,6 +45,7 @@ void RecordCacheMonitorThread::threadMain() {
           "to %lu bytes.",
           processor_->settings()->record_cache_max_size);
 
+  auto last_persisted = std::chrono::steady_clock::now();
   while (!shutdown_.signaled()) {
     auto result = recordCacheNeedsEviction();
     if (result.first) {
@@ -56,6 +59,13 @@ void RecordCacheMonitorThread::threadMain() {
       evictCaches(result.second);
     }
 
+    const auto now = std::chrono::steady_clock::now();
+    if (now - last_persisted >=
+        processor_->settings()->record_cache_persist_interval) {
+      persistRecordCaches();
+      last_persisted = now;
+    }
+
     shutdown_.waitFor(processor_->settings()->record_cache_monitor_interval);
   }
 }
@@ -82,6 +92,12 @@ std::pair<bool, size_t> RecordCacheMonitorThread::recordCacheNeedsEviction() {
   // memeory usage of all record cache related data. Therefore, we use this
   // number to calculate the eviction size target which is used to evict current
   // record cache entries.
+  //
+  // Entries allocated in the per-epoch arenas only contribute their payload to
+  // record_cache_bytes_cached_estimate; the memory holding the entries
+  // themselves is the size of the arenas, record_cache_arena_bytes. Arenas
+  // free a slab as soon as all entries in it are destroyed, so evictions
+  // bring that down too.
 
   int64_t total_cache_size = 0;
   StatsHolder* holder = processor_->stats_;
@@ -93,7 +109,8 @@ std::pair<bool, size_t> RecordCacheMonitorThread::recordCacheNeedsEviction() {
   }
 
   holder->runForEach([&total_cache_size](Stats& stats) {
-    total_cache_size += stats.record_cache_bytes_cached_estimate;
+    total_cache_size += stats.record_cache_bytes_cached_estimate +
+        stats.record_cache_arena_bytes;
   });
 
   if (total_cache_size > 0 && total_cache_size > (int64_t)size_limit) {
@@ -110,6 +127,17 @@ std::pair<bool, size_t> RecordCacheMonitorThread::recordCacheNeedsEviction() {
   return std::make_pair(false, 0);
 }
 
+void RecordCacheMonitorThread::persistRecordCaches() {
+  LogStorageStateMap& log_map = processor_->getLogStorageStateMap();
+  RecordCacheFileStore* files = log_map.getRecordCacheFileStore();
+  if (files == nullptr) {
+    return;
+  }
+  for (shard_index_t shard = 0; shard < files->numShards(); ++shard) {
+    files->persistStable(shard, log_map);
+  }
+}
+
 namespace {
 
 struct LogEntry {
@@ -27,6 +27,10 @@ class ServerProcessor;
  *         epochs currently cached. This could help to leave more logs in the
  *         cache, achieving better availability in terms of logs and less seeks
  *         durng epoch recovery.
+ *
+ *         With --persist-record-caches-to-file, the thread also periodically
+ *         appends record caches to record cache files, see
+ *         RecordCacheFileStore.h.
  */
 
 class RecordCacheMonitorThread {
@@ -57,6 +61,10 @@ class RecordCacheMonitorThread {
 
   // Perform eviction for all logs, attempting to evict @param target_bytes
   void evictCaches(size_t target_bytes);
+
+  // Append record caches that changed but are now stable to record cache
+  // files, if record caches are persisted to files.
+  void persistRecordCaches();
 };
 
 }} // namespace facebook::logdevice
@@ -9,6 +9,7 @@
 
 #include "logdevice/common/Worker.h"
 #include "logdevice/server/RecordCache.h"
+#include "logdevice/server/RecordCacheFileStore.h"
 #include "logdevice/server/ServerProcessor.h"
 #include "logdevice/server/read_path/LogStorageStateMap.h"
 #include "logdevice/server/storage_tasks/ExecStorageThread.h"
@@ -37,6 +38,13 @@ void persistRecordCaches(shard_index_t shard_idx,
 
   ld_check(shard.getShardIdx() == shard_idx);
 
+  RecordCacheFileStore* files = log_storage_state_map.getRecordCacheFileStore();
+  if (files != nullptr) {
+    // most caches were already appended to the file in the background
+    files->persistAndSeal(shard_idx, log_storage_state_map);
+    return;
+  }
+
   ld_check(sharded_store->numShards() > 0);
   const size_t bytes_limit_per_shard =
       storage_thread_pool->getProcessor().settings()->record_cache_max_size /
@@ -18,7 +18,9 @@ class StorageThreadPool;
 /**
  * @file  A function for persisting record caches for all logs stored
  *        on a particular shard. Called at the very end of shutting down storage
- *        threads, from the last thread to be shut down.
+ *        threads, from the last thread to be shut down. Record caches go
+ *        to the local log store, or to the record cache file of the shard
+ *        with --persist-record-caches-to-file.
  */
 
 namespace RecordCachePersistence {
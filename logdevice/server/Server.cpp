@@ -7,6 +7,7 @@
  */
 #include "logdevice/server/Server.h"
 
+#include <folly/FileUtil.h>
 #include <folly/MapUtil.h>
 #include <folly/io/async/EventBaseThread.h>
 #include <thrift/lib/cpp/util/EnumUtils.h>
@@ -28,6 +29,7 @@
 #include "logdevice/common/StaticSequencerPlacement.h"
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/ZookeeperClient.h"
+#include "logdevice/common/buffered_writer/ZstdDictionaries.h"
 #include "logdevice/common/configuration/Configuration.h"
 #include "logdevice/common/configuration/InternalLogs.h"
 #include "logdevice/common/configuration/LocalLogsConfig.h"
@@ -652,7 +654,8 @@ Server::Server(ServerParameters* params)
   if (!(initListeners() && initStore() && initLogStorageStateMap() &&
         initStorageThreadPool() && initProcessor() && initFailureDetector() &&
         startWorkers() && initNCM() && repopulateRecordCaches() &&
-        initSequencers() && initSequencerPlacement() &&
+        initZstdDictionaries() && initSequencers() &&
+        initSequencerPlacement() &&
         initRebuildingCoordinator() && initClusterMaintenanceStateMachine() &&
         initLogStoreMonitor() && initUnreleasedRecordDetector() &&
         initLogsConfigManager() && initAdminServer() && initThriftServers() &&
@@ -1321,7 +1324,8 @@ bool Server::initSequencers() {
           server_settings_->epoch_store_path,
           processor_->getRequestExecutor(),
           processor_->getOptionalMyNodeID(),
-          updateable_config_->updateableNodesConfiguration());
+          updateable_config_->updateableNodesConfiguration(),
+          processor_settings_->epoch_store_multi_op_max_logs);
     } catch (const ConstructorFailed&) {
       ld_error(
           "Failed to construct FileEpochStore: %s", error_description(err));
@@ -1355,6 +1359,31 @@ bool Server::initSequencers() {
   return true;
 }
 
+bool Server::initZstdDictionaries() {
+  // The registry is process-wide and outlives the server, so the fetcher
+  // holds its own reference to the settings.
+  UpdateableSettings<Settings> settings = params_->getProcessorSettings();
+  ZstdDictionaries::instance().setFetcher([settings](uint32_t id) {
+    const std::string dir = settings->sequencer_batching_zstd_dictionaries_dir;
+    if (dir.empty()) {
+      return std::string();
+    }
+    const std::string path = dir + "/" + std::to_string(id);
+    std::string dictionary;
+    if (!folly::readFile(path.c_str(), dictionary)) {
+      RATELIMIT_ERROR(std::chrono::seconds(10),
+                      1,
+                      "Failed to read ZSTD dictionary %u from %s: %s",
+                      id,
+                      path.c_str(),
+                      strerror(errno));
+      return std::string();
+    }
+    return dictionary;
+  });
+  return true;
+}
+
 bool Server::initLogStoreMonitor() {
   if (params_->isStorageNode()) {
     logstore_monitor_ =
@@ -361,6 +361,9 @@ class Server {
   bool startWorkers();
   bool initNCM();
   bool repopulateRecordCaches();
+  // Lets sequencer batching load ZSTD dictionaries of client batches from
+  // sequencer-batching-zstd-dictionaries-dir.
+  bool initZstdDictionaries();
   bool initSequencers();
   bool initLogStoreMonitor();
   bool initSequencerPlacement();
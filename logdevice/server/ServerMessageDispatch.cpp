@@ -15,6 +15,7 @@
 #include "logdevice/common/protocol/MessageTypeNames.h"
 #include "logdevice/common/protocol/RELEASE_Message.h"
 #include "logdevice/common/protocol/STOP_Message.h"
+#include "logdevice/common/protocol/STORE_BATCH_Message.h"
 #include "logdevice/common/protocol/STORE_Message.h"
 #include "logdevice/common/protocol/WINDOW_Message.h"
 #include "logdevice/common/util.h"
@@ -40,6 +41,7 @@
 #include "logdevice/server/message_handlers/GOSSIP_onReceived.h"
 #include "logdevice/server/message_handlers/LOGS_CONFIG_API_onReceived.h"
 #include "logdevice/server/message_handlers/MEMTABLE_FLUSHED_onReceived.h"
+#include "logdevice/server/message_handlers/SEAL_BATCH_onReceived.h"
 #include "logdevice/server/message_handlers/SEAL_onReceived.h"
 #include "logdevice/server/message_handlers/START_onReceived.h"
 #include "logdevice/server/message_handlers/STOP_onReceived.h"
@@ -198,6 +200,10 @@ Message::Disposition ServerMessageDispatch::onReceivedHandler(
     case MessageType::SEAL:
       return SEAL_onReceived(checked_downcast<SEAL_Message*>(msg), from);
 
+    case MessageType::SEAL_BATCH:
+      return SEAL_BATCH_onReceived(
+          checked_downcast<SEAL_BATCH_Message*>(msg), from);
+
     case MessageType::START:
       return START_onReceived(
           checked_downcast<START_Message*>(msg), from, permission_status);
@@ -209,6 +215,10 @@ Message::Disposition ServerMessageDispatch::onReceivedHandler(
       return StoreStateMachine::onReceived(
           checked_downcast<STORE_Message*>(msg), from);
 
+    case MessageType::STORE_BATCH:
+      return StoreStateMachine::onReceived(
+          checked_downcast<STORE_BATCH_Message*>(msg), from);
+
     case MessageType::STORED:
       return STORED_onReceived(checked_downcast<STORED_Message*>(msg), from);
 
@@ -16,6 +16,7 @@
 #include "logdevice/common/event_log/EventLogRebuildingSet.h"
 #include "logdevice/common/protocol/RELEASE_Message.h"
 #include "logdevice/common/protocol/STORED_Message.h"
+#include "logdevice/common/protocol/STORE_BATCH_Message.h"
 #include "logdevice/common/protocol/STORE_Message.h"
 #include "logdevice/common/stats/Stats.h"
 #include "logdevice/server/EpochRecordCache.h"
@@ -282,6 +283,24 @@ Message::Disposition StoreStateMachine::onReceived(STORE_Message* msg,
   return Message::Disposition::KEEP;
 }
 
+Message::Disposition
+StoreStateMachine::onReceived(STORE_BATCH_Message* msg, const Address& from) {
+  for (auto& store : msg->getStores()) {
+    switch (onReceived(store.get(), from)) {
+      case Message::Disposition::NORMAL:
+        break;
+      case Message::Disposition::KEEP:
+        // A StoreStateMachine took ownership of the STORE.
+        store.release();
+        break;
+      case Message::Disposition::ERROR:
+        // err is set, the connection is about to be closed.
+        return Message::Disposition::ERROR;
+    }
+  }
+  return Message::Disposition::NORMAL;
+}
+
 // Check if a node index is being rebuilt in RELOCATE mode. If that's the
 // case, we will deny the STORE with E::REBUILDING.
 static bool destIsRebuilding(ShardID dest,
@@ -651,7 +670,8 @@ void StoreStateMachine::storeAndForward() {
       durability_,
       worker_settings.write_find_time_index,
       merge_mutable_per_epoch_log_metadata,
-      worker_settings.write_shard_id_in_copyset);
+      worker_settings.write_shard_id_in_copyset,
+      worker_settings.write_filterable_key_in_copyset_index);
 
   // Forward to next node in chain
   if (header.flags & STORE_Header::CHAIN) {
@@ -17,6 +17,7 @@
 
 namespace facebook { namespace logdevice {
 
+class STORE_BATCH_Message;
 class STORE_Message;
 
 /**
@@ -35,6 +36,14 @@ class StoreStateMachine {
    */
   static Message::Disposition onReceived(STORE_Message* msg,
                                          const Address& from);
+
+  /**
+   * Handles a STORE_BATCH message by processing each of its STOREs as if it
+   * had arrived on its own.
+   */
+  static Message::Disposition onReceived(STORE_BATCH_Message* msg,
+                                         const Address& from);
+
   /**
    * Check if the copyset of an incoming STORE message is valid.
    *
@@ -31,6 +31,17 @@
 
 namespace facebook { namespace logdevice {
 
+namespace {
+
+folly::StringPiece
+filterableKey(const std::map<KeyType, std::string>& optional_keys) {
+  auto it = optional_keys.find(KeyType::FILTERABLE);
+  return it != optional_keys.end() ? folly::StringPiece(it->second)
+                                   : folly::StringPiece();
+}
+
+} // namespace
+
 StoreStorageTask::StoreStorageTask(
     const STORE_Header& store_header,
     const StoreChainLink* copyset,
@@ -43,7 +54,8 @@ StoreStorageTask::StoreStorageTask(
     Durability durability,
     bool write_find_time_index,
     bool merge_mutable_per_epoch_log_metadata,
-    bool write_shard_id_in_copyset)
+    bool write_shard_id_in_copyset,
+    bool write_filterable_key_in_copyset_index)
     : WriteStorageTask(StorageTask::Type::STORE),
       payload_holder_(payload_holder),
       timestamp_(store_header.timestamp),
@@ -81,7 +93,10 @@ StoreStorageTask::StoreStorageTask(
               copyset,
               block_starting_lsn,
               write_shard_id_in_copyset,
-              &copyset_index_entry_buf_),
+              &copyset_index_entry_buf_,
+              write_filterable_key_in_copyset_index
+                  ? filterableKey(optional_keys)
+                  : folly::StringPiece()),
           {},
           durability < Durability::NUM_DURABILITIES
               ? durability
@@ -254,6 +269,18 @@ void StoreStorageTask::onDone() {
   }
 
   sendReply(status_);
+  stage_timer_.end(AppendStage::STORED_REPLY, Worker::stats());
+}
+
+void StoreStorageTask::startAppendStageTimer() {
+  if (recovery_ || rebuilding_ || !(flags_ & STORE_Header::APPEND_STAGES)) {
+    // Not on behalf of an append sampled by the sequencer.
+    return;
+  }
+  // The first stage covers the STORE being processed on the worker,
+  // including waiting for this shard's LogStorageState.
+  stage_timer_.start(/*sample_rate=*/1.0, start_time_);
+  stage_timer_.end(AppendStage::STORAGE_ADMISSION, Worker::stats());
 }
 
 void StoreStorageTask::onDropped() {
@@ -317,13 +344,21 @@ void StoreStorageTask::sendReply(Status status) const {
     flags |= STORE_Header::OFFSET_MAP;
   }
 
+  // Let the sequencer know where a sampled append spent its time here.
+  folly::Optional<StorageStageDurations> append_stages;
+  if (stage_timer_.sampled()) {
+    append_stages = stage_timer_.getStorageStageDurations();
+  }
+
   STORED_Message::createAndSend(
       STORED_Header{rid_, wave_, status, seal_.seq_node, flags, getShardIdx()},
       reply_to_,
       extra_.rebuilding_version,
       extra_.rebuilding_wave,
       extra_.rebuilding_id,
-      flushToken_);
+      flushToken_,
+      ShardID(),
+      append_stages.get_pointer());
 }
 
 int StoreStorageTask::putCache() {
@@ -353,7 +388,8 @@ int StoreStorageTask::putCache() {
     STAT_ADD(
         stats(),
         record_cache_bytes_cached_estimate,
-        EpochRecordCacheEntry::getBytesEstimate(payload_holder_.getPayload()));
+        EpochRecordCacheEntry::getCachedBytesEstimate(
+            payload_holder_.getPayload()));
   }
   return rv;
 }
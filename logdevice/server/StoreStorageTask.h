@@ -55,7 +55,8 @@ class StoreStorageTask : public WriteStorageTask {
                    Durability durability,
                    bool write_find_time_index,
                    bool merge_mutable_per_epoch_log_metadata,
-                   bool write_shard_id_in_copyset);
+                   bool write_shard_id_in_copyset,
+                   bool write_filterable_key_in_copyset_index = false);
 
   ~StoreStorageTask() override;
 
@@ -70,6 +71,8 @@ class StoreStorageTask : public WriteStorageTask {
 
   bool isTimedout() const override;
 
+  void startAppendStageTimer() override;
+
   ThreadType getThreadType() const override {
     // Stores from Appenders are sensitive to latency (because of store timeout
     // in Appender, and limited sequencer window). They are executed on fast
@@ -20,6 +20,7 @@
 #include "logdevice/server/admincommands/CreateCheckpoint.h"
 #include "logdevice/server/admincommands/CustomCounters.h"
 #include "logdevice/server/admincommands/DeprecatedStats.h"
+#include "logdevice/server/admincommands/DumpIOTraces.h"
 #include "logdevice/server/admincommands/DumpQueuedMessages.h"
 #include "logdevice/server/admincommands/Failsafe.h"
 #include "logdevice/server/admincommands/Fill.h"
@@ -33,6 +34,7 @@
 #include "logdevice/server/admincommands/InfoEventLog.h"
 #include "logdevice/server/admincommands/InfoGossip.h"
 #include "logdevice/server/admincommands/InfoGraylist.h"
+#include "logdevice/server/admincommands/InfoIOTraces.h"
 #include "logdevice/server/admincommands/InfoIterators.h"
 #include "logdevice/server/admincommands/InfoLogsConfigRsm.h"
 #include "logdevice/server/admincommands/InfoLogsDBMetadata.h"
@@ -126,6 +128,7 @@ AdminCommandFactory::AdminCommandFactory() {
   selector_.add<commands::ListOrEraseMetadata>("delete metadata",
                                                /* erase */ true);
   selector_.add<commands::InfoIterators>("info iterators");
+  selector_.add<commands::InfoIOTraces>("info io_traces");
   selector_.add<commands::InfoShards>("info shards");
   selector_.add<commands::InfoSettings>("info settings");
   selector_.add<commands::InfoRecordCache>("info record_cache");
@@ -164,6 +167,8 @@ AdminCommandFactory::AdminCommandFactory() {
   selector_.add<commands::StatsHistogram>("stats2 histogram");
   selector_.add<commands::TrafficShapingHistogram>("stats2 shaping");
   selector_.add<commands::StoreTimeoutHistogram>("stats2 store_timeouts");
+  selector_.add<commands::AppendStagesHistogram>("stats2 append_stages");
+  selector_.add<commands::IOLatencyHistogram>("stats2 io_latency");
 
   selector_.add<commands::StatsThroughput>("stats throughput");
   selector_.add<commands::StatsCustomCounters>("stats custom counters");
@@ -230,6 +235,8 @@ AdminCommandFactory::AdminCommandFactory() {
 
   selector_.add<commands::CreateCheckpoint>(
       "create_checkpoint", Restriction::LOCALHOST_ONLY);
+  selector_.add<commands::DumpIOTraces>(
+      "dump_io_traces", Restriction::LOCALHOST_ONLY);
 
   selector_.add<commands::Failsafe>("failsafe", Restriction::LOCALHOST_ONLY);
 
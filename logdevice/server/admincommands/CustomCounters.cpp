@@ -46,10 +46,7 @@ static AggregateMap doAggregate(StatsHolder* stats,
   std::string delimiter = logs_config->getNamespaceDelimiter();
 
   stats->runForEach([&](facebook::logdevice::Stats& s) {
-    // Use synchronizedCopy() so we do not have to hold a read lock on
-    // per_log_append_bytes map while we iterate over individual entries.
-    for (auto& entry :
-         s.synchronizedCopy(&facebook::logdevice::Stats::per_log_stats)) {
+    for (auto& entry : s.per_log_stats.snapshot()) {
       std::lock_guard<std::mutex> guard(entry.second->mutex);
       std::string& clean_name = entry.first;
 
@@ -0,0 +1,92 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <vector>
+
+#include "logdevice/server/admincommands/AdminCommand.h"
+#include "logdevice/server/locallogstore/IOTraceBuffer.h"
+#include "logdevice/server/locallogstore/IOTracing.h"
+#include "logdevice/server/locallogstore/ShardedRocksDBLocalLogStore.h"
+
+namespace facebook { namespace logdevice { namespace commands {
+
+class DumpIOTraces : public AdminCommand {
+  using AdminCommand::AdminCommand;
+
+ private:
+  std::string path_;
+  shard_index_t shard_ = -1;
+
+ public:
+  void getOptions(
+      boost::program_options::options_description& out_options) override {
+    // clang-format off
+    out_options.add_options()
+      ("path",
+       boost::program_options::value<std::string>(&path_)
+       ->required())
+      ("shard",
+       boost::program_options::value<shard_index_t>(&shard_));
+    // clang-format on
+  }
+  void getPositionalOptions(
+      boost::program_options::positional_options_description& out_options)
+      override {
+    out_options.add("path", 1);
+  }
+  std::string getUsage() override {
+    return "dump_io_traces <path> [--shard=<shard>]\r\n\r\n"
+           "Writes the IO operations currently in the binary IO trace "
+           "buffers\r\n"
+           "(see rocksdb-io-trace-ring-size) to a file at <path> on the "
+           "server's\r\n"
+           "host, for offline analysis. See readIOTraceFile() for the "
+           "format.\r\n";
+  }
+
+  void run() override {
+    if (!server_->getProcessor()->runningOnStorageNode()) {
+      out_.printf("Error: not a storage node\r\n");
+      return;
+    }
+
+    auto sharded_store = server_->getShardedLocalLogStore();
+    if (shard_ >= sharded_store->numShards()) {
+      out_.printf("Error: shard index %d out of range [0, %d]\r\n",
+                  shard_,
+                  sharded_store->numShards() - 1);
+      return;
+    }
+
+    std::vector<IOTraceEvent> events;
+    for (shard_index_t i = 0; i < sharded_store->numShards(); ++i) {
+      if (shard_ >= 0 && i != shard_) {
+        continue;
+      }
+      IOTracing* tracing = sharded_store->getByIndex(i)->getIOTracing();
+      if (tracing == nullptr || !tracing->isBinaryTracingEnabled()) {
+        continue;
+      }
+      std::vector<IOTraceEvent> shard_events = tracing->getRecentEvents();
+      events.insert(events.end(), shard_events.begin(), shard_events.end());
+    }
+
+    if (writeIOTraceFile(path_, events) != 0) {
+      out_.printf("Error: failed to write IO traces to %s: %s\r\n",
+                  path_.c_str(),
+                  error_description(err));
+      return;
+    }
+    out_.printf("Wrote %zu IO trace events to %s\r\n",
+                events.size(),
+                path_.c_str());
+  }
+};
+
+}}} // namespace facebook::logdevice::commands
@@ -0,0 +1,130 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "logdevice/common/AdminCommandTable.h"
+#include "logdevice/server/admincommands/AdminCommand.h"
+#include "logdevice/server/locallogstore/IOTracing.h"
+#include "logdevice/server/locallogstore/ShardedRocksDBLocalLogStore.h"
+
+namespace facebook { namespace logdevice { namespace commands {
+
+class InfoIOTraces : public AdminCommand {
+  using AdminCommand::AdminCommand;
+
+ private:
+  shard_index_t shard_ = -1;
+  size_t limit_ = 1000;
+  double min_latency_ms_ = 0;
+  bool json_ = false;
+
+ public:
+  void getOptions(
+      boost::program_options::options_description& out_options) override {
+    // clang-format off
+    out_options.add_options()
+      ("shard",
+       boost::program_options::value<shard_index_t>(&shard_))
+      ("limit",
+       boost::program_options::value<size_t>(&limit_)
+         ->default_value(limit_))
+      ("min-latency-ms",
+       boost::program_options::value<double>(&min_latency_ms_))
+      ("json", boost::program_options::bool_switch(&json_));
+    // clang-format on
+  }
+  std::string getUsage() override {
+    return "info io_traces [--shard=<shard>] [--limit=<n>] "
+           "[--min-latency-ms=<ms>] [--json]\r\n\r\n"
+           "Prints the most recent IO operations recorded by binary IO "
+           "tracing\r\n"
+           "(see rocksdb-io-trace-ring-size), at most <n> of them, oldest "
+           "first.\r\n";
+  }
+
+  void run() override {
+    InfoIOTracesTable table(!json_,
+                            "Shard",
+                            "Start time",
+                            "Latency us",
+                            "Context",
+                            "Op",
+                            "File type",
+                            "File number",
+                            "CF ID",
+                            "Offset",
+                            "Size");
+
+    if (!server_->getProcessor()->runningOnStorageNode()) {
+      out_.printf("Error: not a storage node\r\n");
+      return;
+    }
+
+    auto sharded_store = server_->getShardedLocalLogStore();
+    if (shard_ >= sharded_store->numShards()) {
+      out_.printf("Error: shard index %d out of range [0, %d]\r\n",
+                  shard_,
+                  sharded_store->numShards() - 1);
+      return;
+    }
+
+    const uint64_t min_latency_us = uint64_t(min_latency_ms_ * 1000);
+    std::vector<IOTraceEvent> events;
+    for (shard_index_t i = 0; i < sharded_store->numShards(); ++i) {
+      if (shard_ >= 0 && i != shard_) {
+        continue;
+      }
+      IOTracing* tracing = sharded_store->getByIndex(i)->getIOTracing();
+      if (tracing == nullptr || !tracing->isBinaryTracingEnabled()) {
+        continue;
+      }
+      for (const IOTraceEvent& e : tracing->getRecentEvents()) {
+        if (e.latency_us >= min_latency_us) {
+          events.push_back(e);
+        }
+      }
+    }
+
+    std::stable_sort(events.begin(),
+                     events.end(),
+                     [](const IOTraceEvent& a, const IOTraceEvent& b) {
+                       return a.start_time_us < b.start_time_us;
+                     });
+    auto begin = events.begin();
+    if (events.size() > limit_) {
+      begin += events.size() - limit_;
+    }
+
+    for (auto it = begin; it != events.end(); ++it) {
+      const IOTraceEvent& e = *it;
+      table.next()
+          .set<0>(e.shard)
+          .set<1>(std::chrono::duration_cast<std::chrono::milliseconds>(
+              std::chrono::microseconds(e.start_time_us)))
+          .set<2>(e.latency_us)
+          .set<3>(ioTraceContextName(e.context))
+          .set<4>(ioTraceOpName(e.op))
+          .set<5>(ioTraceFileTypeName(e.file_type));
+      if (e.file_number != 0) {
+        table.set<6>(e.file_number);
+      }
+      if (e.cf_id != IOTraceEvent::CF_UNKNOWN) {
+        table.set<7>(e.cf_id);
+      }
+      table.set<8>(e.offset).set<9>(e.size);
+    }
+
+    json_ ? table.printJson(out_) : table.print(out_);
+  }
+};
+
+}}} // namespace facebook::logdevice::commands
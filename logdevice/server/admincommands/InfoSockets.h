@@ -49,7 +49,9 @@ class InfoSockets : public AdminCommand {
                            "Proto",
                            "Sendbuf",
                            "Is ssl",
-                           "FD");
+                           "FD",
+                           "Copied (MB)",
+                           "Zero-copy (MB)");
 
     auto tables = run_on_all_workers(server_->getProcessor(), [&]() {
       InfoSocketsTable t(table);
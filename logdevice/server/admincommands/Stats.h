@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include <array>
 #include <sstream>
 
 #include "logdevice/common/PriorityMap.h"
@@ -16,18 +17,24 @@
 
 namespace facebook { namespace logdevice { namespace commands {
 
+// If `include_histograms` is true, each nonempty histogram is printed as
+// a few stats: "<name>.count" and percentiles "<name>.p50", "<name>.p99_9"
+// etc, in the histogram's unit (e.g. microseconds for latencies).
 inline void printStats(const Stats& stats,
                        folly::io::Appender& out,
                        bool include_log_groups,
-                       const char* key_prefix = "") {
+                       const char* key_prefix = "",
+                       bool include_histograms = false) {
   class Callbacks : public Stats::EnumerationCallbacks {
    public:
     Callbacks(folly::io::Appender& out,
               const char* key_prefix,
-              bool include_log_groups)
+              bool include_log_groups,
+              bool include_histograms)
         : out_(out),
           keyPrefix_(key_prefix),
-          includeLogGroups_(include_log_groups) {}
+          includeLogGroups_(include_log_groups),
+          includeHistograms_(include_histograms) {}
 
     // Simple stats.
     void stat(const std::string& name, int64_t val) override {
@@ -144,23 +151,57 @@ inline void printStats(const Stats& stats,
                   val);
     }
 
-    // Don't show histograms.
-    void histogram(const std::string& /*name*/,
-                   const HistogramInterface& /*hist*/) override {}
-    void histogram(const std::string& /*name*/,
-                   shard_index_t /*shard*/,
-                   const HistogramInterface& /*hist*/) override {}
-    void histogramWithTag(const std::string& /*name*/,
-                          const std::string& /*tag*/,
-                          const HistogramInterface& /*hist*/) override {}
+    void histogram(const std::string& name,
+                   const HistogramInterface& hist) override {
+      printHistogram(name, hist);
+    }
+    // Per-shard histograms.
+    void histogram(const std::string& name,
+                   shard_index_t shard,
+                   const HistogramInterface& hist) override {
+      printHistogram(name + ".shard" + std::to_string(shard), hist);
+    }
+    // Per-monitoring-tag histograms.
+    void histogramWithTag(const std::string& name,
+                          const std::string& tag,
+                          const HistogramInterface& hist) override {
+      printHistogram(name + "." + tag, hist);
+    }
 
    private:
+    void printHistogram(const std::string& name,
+                        const HistogramInterface& hist) {
+      if (!includeHistograms_) {
+        return;
+      }
+      static const std::array<double, 5> pcts = {.5, .9, .99, .999, .9999};
+      static const std::array<const char*, 5> names = {
+          "p50", "p90", "p99", "p99_9", "p99_99"};
+      std::array<int64_t, 5> samples;
+      uint64_t count;
+      hist.estimatePercentiles(
+          pcts.data(), pcts.size(), samples.data(), &count);
+      if (count == 0) {
+        return;
+      }
+      out_.printf(
+          "STAT %s%s.count %" PRIu64 "\r\n", keyPrefix_, name.c_str(), count);
+      for (size_t i = 0; i < pcts.size(); ++i) {
+        out_.printf("STAT %s%s.%s %" PRId64 "\r\n",
+                    keyPrefix_,
+                    name.c_str(),
+                    names[i],
+                    samples[i]);
+      }
+    }
+
     folly::io::Appender& out_;
     const char* keyPrefix_;
     bool includeLogGroups_;
+    bool includeHistograms_;
   };
 
-  Callbacks cb(out, key_prefix, include_log_groups);
+  Callbacks cb(out, key_prefix, include_log_groups, include_histograms);
   stats.enumerate(&cb, /* list_all */ true);
 }
 
@@ -169,10 +210,11 @@ class Stats : public AdminCommand {
 
  private:
   bool include_log_groups_;
+  bool include_histograms_;
 
  public:
   std::string getUsage() override {
-    return "stats [--include-log-groups]";
+    return "stats [--include-log-groups] [--histograms]";
   }
 
   void getOptions(
@@ -183,7 +225,12 @@ class Stats : public AdminCommand {
       ("full", boost::program_options::bool_switch(&include_log_groups_))
 
       ("include-log-groups",
-        boost::program_options::bool_switch(&include_log_groups_));
+        boost::program_options::bool_switch(&include_log_groups_))
+
+      // Also print percentiles of histograms. Off by default since it's much
+      // more output than the counters.
+      ("histograms",
+        boost::program_options::bool_switch(&include_histograms_));
     // clang-format on
   }
 
@@ -191,7 +238,9 @@ class Stats : public AdminCommand {
     if (server_->getParameters()->getStats()) {
       printStats(server_->getParameters()->getStats()->aggregate(),
                  out_,
-                 include_log_groups_);
+                 include_log_groups_,
+                 "",
+                 include_histograms_);
     }
   }
 };
@@ -13,6 +13,8 @@
 #include <vector>
 
 #include "logdevice/common/AdminCommandTable.h"
+#include "logdevice/common/AppendStage.h"
+#include "logdevice/common/IOTraceContext.h"
 #include "logdevice/common/stats/PerShardHistograms.h"
 #include "logdevice/common/stats/ServerHistograms.h"
 #include "logdevice/server/admincommands/AdminCommand.h"
@@ -293,6 +295,118 @@ class StatsHistogram : public ShardedStatsHistogramBase {
   }
 };
 
+// Latency of sampled appends broken down by stage, in the order the stages
+// happen. See AppendStageTimer.
+class AppendStagesHistogram : public StatsHistogramBase<> {
+  using StatsHistogramBase<>::StatsHistogramBase;
+
+ public:
+  std::string getUsage() override {
+    return "stats2 append_stages " + StatsHistogramBase<>::getUsage();
+  }
+
+  void run() override {
+    execute();
+  }
+
+ private:
+  std::vector<HistTuple>
+  findHistograms(facebook::logdevice::Stats& stats) override {
+    ld_check(stats.server_histograms);
+    std::vector<HistTuple> hists;
+    for (int i = 0; i < static_cast<int>(AppendStage::MAX); ++i) {
+      hists.push_back(
+          HistTuple(appendStageName(static_cast<AppendStage>(i)),
+                    &stats.server_histograms->append_stage_latency[i]));
+    }
+    return hists;
+  }
+
+  void printHist(HistTuple& tuple) override {
+    std::ostringstream oss;
+    std::get<1>(tuple)->print(oss);
+    out_.printf(
+        "%s:\r\n%s\r\n", std::get<0>(tuple).c_str(), oss.str().c_str());
+  }
+};
+
+// Latency of IO operations done by rocksdb broken down by what they were done
+// for. See IOTracing.
+class IOLatencyHistogram : public ShardedStatsHistogramBase {
+  using ShardedStatsHistogramBase::ShardedStatsHistogramBase;
+
+ public:
+  std::string getUsage() override {
+    return "stats2 io_latency [shard] " +
+        ShardedStatsHistogramBase::getUsage();
+  }
+
+  void getOptions(boost::program_options::options_description& opts) override {
+    opts.add_options()(
+        "shard", boost::program_options::value<shard_index_t>(&shard_));
+    ShardedStatsHistogramBase::getOptions(opts);
+  }
+
+  void getPositionalOptions(
+      boost::program_options::positional_options_description& out_options)
+      override {
+    out_options.add("shard", 1);
+    ShardedStatsHistogramBase::getPositionalOptions(out_options);
+  }
+
+  void run() override {
+    if (!server_->getProcessor()->runningOnStorageNode()) {
+      out_.printf("Error: not a storage node\r\n");
+      return;
+    }
+    execute("Shard");
+  }
+
+ private:
+  shard_index_t shard_{-1};
+
+  std::vector<HistTuple>
+  findHistograms(facebook::logdevice::Stats& stats) override {
+    ld_check(stats.per_shard_histograms);
+    std::vector<HistTuple> hists;
+
+    ld_check(server_->getShardedLocalLogStore() != nullptr);
+    shard_index_t shard_lo = 0;
+    shard_index_t shard_hi =
+        server_->getShardedLocalLogStore()->numShards() - 1;
+    if (shard_ != -1) {
+      if (shard_ < shard_lo || shard_ > shard_hi) {
+        out_.printf("Shard index out or range\r\n");
+        return hists;
+      }
+      shard_lo = shard_hi = shard_;
+    }
+
+    for (int i = 0; i < static_cast<int>(IOTraceContext::MAX); ++i) {
+      for (int idx = shard_lo; idx <= shard_hi; ++idx) {
+        hists.push_back(
+            HistTuple(ioTraceContextName(static_cast<IOTraceContext>(i)),
+                      stats.per_shard_histograms->io_latency[i].get(idx),
+                      idx));
+      }
+    }
+    return hists;
+  }
+
+  void setUniqueCols(HistTuple& tuple, SummaryTable& table) override {
+    table.set<1>(std::get<2>(tuple));
+  }
+
+  void printHist(HistTuple& tuple) override {
+    std::ostringstream oss;
+    std::get<1>(tuple)->print(oss);
+    out_.printf("%s - Shard %d:\r\n%s\r\n",
+                std::get<0>(tuple).c_str(),
+                std::get<2>(tuple),
+                oss.str().c_str());
+  }
+};
+
 using TrafficShapingHistogramBase =
     StatsHistogramBase<std::string /*scope*/, std::string /*priority*/>;
 class TrafficShapingHistogram : public TrafficShapingHistogramBase {
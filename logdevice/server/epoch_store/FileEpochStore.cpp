@@ -7,8 +7,10 @@
  */
 #include "logdevice/server/epoch_store/FileEpochStore.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
+#include <map>
 #include <unistd.h>
 
 #include <folly/FileUtil.h>
@@ -37,22 +39,20 @@ FileEpochStore::FileEpochStore(
     std::string path,
     RequestExecutor request_executor,
     folly::Optional<NodeID> my_node_id,
-    std::shared_ptr<UpdateableNodesConfiguration> config)
+    std::shared_ptr<UpdateableNodesConfiguration> config,
+    size_t max_batch_logs)
     : path_(std::move(path)),
       request_executor_(std::move(request_executor)),
       my_node_id_(std::move(my_node_id)),
-      config_(std::move(config)) {
+      config_(std::move(config)),
+      max_batch_logs_(max_batch_logs) {
   ld_check(!path_.empty());
 }
 
 int FileEpochStore::getLastCleanEpoch(logid_t log_id,
                                       EpochStore::CompletionLCE cf) {
-  auto log_metadata = LogMetaData::forNewLog(log_id);
-  auto zrq = std::unique_ptr<ZookeeperEpochStoreRequest>(
-      new GetLastCleanEpochZRQ(log_id, cf));
-  int rv = updateEpochStore(zrq, log_metadata);
-  zrq->postCompletion(
-      rv == 0 ? E::OK : err, std::move(log_metadata), request_executor_);
+  runRequest(std::unique_ptr<ZookeeperEpochStoreRequest>(
+      new GetLastCleanEpochZRQ(log_id, cf)));
   return 0;
 }
 
@@ -73,12 +73,8 @@ int FileEpochStore::setLastCleanEpoch(logid_t log_id,
     return -1;
   }
 
-  auto log_metadata = LogMetaData::forNewLog(log_id);
-  auto zrq = std::unique_ptr<ZookeeperEpochStoreRequest>(
-      new SetLastCleanEpochZRQ(log_id, lce, tail_record, cf));
-  int rv = updateEpochStore(zrq, log_metadata);
-  zrq->postCompletion(
-      rv == 0 ? E::OK : err, std::move(log_metadata), request_executor_);
+  runRequest(std::unique_ptr<ZookeeperEpochStoreRequest>(
+      new SetLastCleanEpochZRQ(log_id, lce, tail_record, cf)));
   return 0;
 }
 
@@ -93,18 +89,14 @@ int FileEpochStore::createOrUpdateMetaData(
     return -1;
   }
 
-  auto log_metadata = LogMetaData::forNewLog(log_id);
-  auto zrq = std::unique_ptr<ZookeeperEpochStoreRequest>(
+  runRequest(std::unique_ptr<ZookeeperEpochStoreRequest>(
       new EpochMetaDataZRQ(log_id,
                            cf,
                            std::move(updater),
                            std::move(tracer),
                            write_node_id,
                            config_->get(),
-                           my_node_id_));
-  int rv = updateEpochStore(zrq, log_metadata);
-  zrq->postCompletion(
-      rv == 0 ? E::OK : err, std::move(log_metadata), request_executor_);
+                           my_node_id_)));
   return 0;
 }
 
@@ -152,14 +144,138 @@ int FileEpochStore::provisionMetaDataLogs(
   return 0;
 }
 
+void FileEpochStore::runRequest(
+    std::unique_ptr<ZookeeperEpochStoreRequest> zrq) {
+  if (max_batch_logs_ <= 1) {
+    auto log_metadata = LogMetaData::forNewLog(zrq->logid_);
+    int rv = updateEpochStore(zrq, log_metadata);
+    zrq->postCompletion(
+        rv == 0 ? E::OK : err, std::move(log_metadata), request_executor_);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(batch_mutex_);
+    pending_requests_.push_back(std::move(zrq));
+    if (draining_) {
+      // The draining thread will pick it up.
+      return;
+    }
+    draining_ = true;
+  }
+
+  for (;;) {
+    std::vector<std::unique_ptr<ZookeeperEpochStoreRequest>> batch;
+    {
+      std::lock_guard<std::mutex> lock(batch_mutex_);
+      if (pending_requests_.empty()) {
+        draining_ = false;
+        return;
+      }
+      while (!pending_requests_.empty() && batch.size() < max_batch_logs_) {
+        batch.push_back(std::move(pending_requests_.front()));
+        pending_requests_.pop_front();
+      }
+    }
+    executeBatch(std::move(batch));
+  }
+}
+
+void FileEpochStore::executeBatch(
+    std::vector<std::unique_ptr<ZookeeperEpochStoreRequest>> batch) {
+  // Requests of each log (data and metadata log share a file), in order.
+  std::map<logid_t::raw_type,
+           std::vector<std::unique_ptr<ZookeeperEpochStoreRequest>>>
+      by_log;
+  for (auto& zrq : batch) {
+    by_log[MetaDataLog::dataLogID(zrq->logid_).val()].push_back(
+        std::move(zrq));
+  }
+
+  for (auto& kv : by_log) {
+    const logid_t logid(kv.first);
+    auto& requests = kv.second;
+    auto log_metadata = LogMetaData::forNewLog(logid);
+    std::vector<Status> statuses(requests.size(), E::OK);
+    std::vector<LogMetaData> results;
+    results.reserve(requests.size());
+
+    int lock_fd = lockLogFile(logid);
+    bool value_existed = false;
+    if (lock_fd < 0 ||
+        readLogFile(*requests.front(), log_metadata, &value_existed) != 0) {
+      const Status st = err;
+      if (lock_fd >= 0) {
+        unlockLogFile(lock_fd);
+      }
+      for (auto& zrq : requests) {
+        zrq->postCompletion(
+            st, LogMetaData::forNewLog(zrq->logid_), request_executor_);
+      }
+      continue;
+    }
+
+    // Each request sees the changes of the ones before it. A request that
+    // fails must not leave partial changes behind, so it works on a copy.
+    size_t first_modified = requests.size();
+    for (size_t i = 0; i < requests.size(); ++i) {
+      LogMetaData attempt = log_metadata;
+      bool modified = false;
+      int rv = applyRequest(requests[i], attempt, value_existed, &modified);
+      statuses[i] = rv == 0 ? E::OK : err;
+      if (modified) {
+        log_metadata = attempt;
+        value_existed = true;
+        first_modified = std::min(first_modified, i);
+      }
+      results.push_back(std::move(attempt));
+    }
+
+    if (first_modified < requests.size() &&
+        writeLogFile(*requests[first_modified], log_metadata) != 0) {
+      // Nothing from first_modified on was persisted.
+      const Status st = err;
+      std::fill(statuses.begin() + first_modified, statuses.end(), st);
+    }
+    unlockLogFile(lock_fd);
+
+    for (size_t i = 0; i < requests.size(); ++i) {
+      requests[i]->postCompletion(
+          statuses[i], std::move(results[i]), request_executor_);
+    }
+  }
+}
+
 int FileEpochStore::updateEpochStore(
     std::unique_ptr<ZookeeperEpochStoreRequest>& zrq,
     LogMetaData& log_metadata) {
-  logid_t logid = zrq->logid_;
+  int lock_fd = lockLogFile(zrq->logid_);
+  if (lock_fd < 0) {
+    return -1;
+  }
+  SCOPE_EXIT {
+    unlockLogFile(lock_fd);
+  };
 
-  boost::filesystem::path log_path =
-      folly::sformat("{}/{}", path_, MetaDataLog::dataLogID(logid).val());
-  boost::filesystem::path lock_path = log_path.string() + ".lock";
+  bool value_existed;
+  if (readLogFile(*zrq, log_metadata, &value_existed) != 0) {
+    return -1;
+  }
+
+  bool modified = false;
+  int rv = applyRequest(zrq, log_metadata, value_existed, &modified);
+  if (rv != 0 || !modified) {
+    return rv;
+  }
+  return writeLogFile(*zrq, log_metadata);
+}
+
+std::string FileEpochStore::logFilePath(logid_t logid) const {
+  return folly::sformat("{}/{}", path_, MetaDataLog::dataLogID(logid).val());
+}
+
+int FileEpochStore::lockLogFile(logid_t logid) {
+  boost::filesystem::path lock_path = logFilePath(logid) + ".lock";
 
   int lock_fd = open(lock_path.c_str(),
                      O_RDWR | O_CREAT,
@@ -192,29 +308,42 @@ int FileEpochStore::updateEpochStore(
     err = E::NOTFOUND;
     return -1;
   }
+  return lock_fd;
+}
 
-  SCOPE_EXIT {
-    flock(lock_fd, LOCK_UN);
-    close(lock_fd);
-  };
+void FileEpochStore::unlockLogFile(int lock_fd) {
+  flock(lock_fd, LOCK_UN);
+  close(lock_fd);
+}
 
+int FileEpochStore::readLogFile(const ZookeeperEpochStoreRequest& zrq,
+                                LogMetaData& log_metadata,
+                                bool* value_existed) {
   std::string data;
-  auto read_success = folly::readFile(log_path.c_str(), data);
+  *value_existed = folly::readFile(logFilePath(zrq.logid_).c_str(), data);
 
-  if (read_success) {
-    auto deserialization_st = zrq->deserializeLogMetaData(data, log_metadata);
+  if (*value_existed) {
+    auto deserialization_st = zrq.deserializeLogMetaData(data, log_metadata);
 
     if (deserialization_st != E::OK) {
       RATELIMIT_ERROR(std::chrono::seconds(1),
                       1,
                       "Failed to deserialize log metadata for log %lu",
-                      zrq->logid_.val_);
+                      zrq.logid_.val_);
       err = deserialization_st;
       return -1;
     }
   }
+  return 0;
+}
 
-  auto next_step = zrq->applyChanges(log_metadata, read_success);
+int FileEpochStore::applyRequest(
+    std::unique_ptr<ZookeeperEpochStoreRequest>& zrq,
+    LogMetaData& log_metadata,
+    bool value_existed,
+    bool* modified) {
+  *modified = false;
+  auto next_step = zrq->applyChanges(log_metadata, value_existed);
 
   switch (next_step) {
     case ZookeeperEpochStoreRequest::NextStep::PROVISION:
@@ -248,7 +377,15 @@ int FileEpochStore::updateEpochStore(
     zrq->composeZnodeValue(log_metadata, znode_value, sizeof(znode_value));
   }
 
-  auto serialized_log_metadata = zrq->serializeLogMetaData(log_metadata);
+  *modified = true;
+  return 0;
+}
+
+int FileEpochStore::writeLogFile(const ZookeeperEpochStoreRequest& zrq,
+                                 const LogMetaData& log_metadata) {
+  const logid_t logid = zrq.logid_;
+  const std::string log_path = logFilePath(logid);
+  auto serialized_log_metadata = zrq.serializeLogMetaData(log_metadata);
 
   using folly::test::TemporaryFile;
   TemporaryFile tmp(
@@ -7,7 +7,10 @@
  */
 #pragma once
 
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include <boost/noncopyable.hpp>
 
@@ -31,11 +34,18 @@ class FileEpochStore : public EpochStore, boost::noncopyable {
   /**
    * @param path      root directory storing one file for each log
    * @param processor parent processor for current FileEpochStore
+   * @param max_batch_logs  if greater than 1, requests issued concurrently
+   *                        are executed in batches of up to this many
+   *                        requests, reading and writing each log's file
+   *                        once per batch. Mirrors
+   *                        --epoch-store-multi-op-max-logs of
+   *                        ZookeeperEpochStore.
    */
   FileEpochStore(std::string path,
                  RequestExecutor request_executor,
                  folly::Optional<NodeID> my_node_id,
-                 std::shared_ptr<UpdateableNodesConfiguration> config);
+                 std::shared_ptr<UpdateableNodesConfiguration> config,
+                 size_t max_batch_logs = 0);
 
   ~FileEpochStore() override {}
 
@@ -96,6 +106,45 @@ class FileEpochStore : public EpochStore, boost::noncopyable {
   int updateEpochStore(std::unique_ptr<ZookeeperEpochStoreRequest>& zrq,
                        LogMetaData& log_metadata);
 
+  /**
+   * Executes the request and posts its completion. If batching is enabled,
+   * the request is queued instead, and executed by whichever thread is
+   * draining the queue (possibly this one).
+   */
+  void runRequest(std::unique_ptr<ZookeeperEpochStoreRequest> zrq);
+
+  /**
+   * Executes a batch of requests. The file of each log is locked, read and
+   * written once, and the requests for that log are applied to it in order.
+   */
+  void executeBatch(
+      std::vector<std::unique_ptr<ZookeeperEpochStoreRequest>> batch);
+
+  /**
+   * Helpers for updateEpochStore() and executeBatch().
+   *
+   * lockLogFile() returns the fd of the locked lock file of the log, or -1
+   * with err set to NOTFOUND.
+   *
+   * readLogFile() and writeLogFile() return 0 on success, or -1 with err set
+   * as for updateEpochStore().
+   *
+   * applyRequest() returns 0 or -1 as updateEpochStore() would if no write
+   * was needed, and sets *modified if the file needs to be written.
+   */
+  std::string logFilePath(logid_t logid) const;
+  int lockLogFile(logid_t logid);
+  void unlockLogFile(int lock_fd);
+  int readLogFile(const ZookeeperEpochStoreRequest& zrq,
+                  LogMetaData& log_metadata,
+                  bool* value_existed);
+  int applyRequest(std::unique_ptr<ZookeeperEpochStoreRequest>& zrq,
+                   LogMetaData& log_metadata,
+                   bool value_existed,
+                   bool* modified);
+  int writeLogFile(const ZookeeperEpochStoreRequest& zrq,
+                   const LogMetaData& log_metadata);
+
   std::string path_;
 
   RequestExecutor request_executor_;
@@ -108,6 +157,14 @@ class FileEpochStore : public EpochStore, boost::noncopyable {
   std::mutex paused_mutex_;
   std::condition_variable paused_cv_;
   bool paused_{false};
+
+  const size_t max_batch_logs_;
+
+  // Requests waiting to be executed in a batch, and whether some thread is
+  // currently draining them. Protected by batch_mutex_.
+  std::mutex batch_mutex_;
+  std::deque<std::unique_ptr<ZookeeperEpochStoreRequest>> pending_requests_;
+  bool draining_{false};
 };
 
 }} // namespace facebook::logdevice
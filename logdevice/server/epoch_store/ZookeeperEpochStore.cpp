@@ -7,6 +7,7 @@
  */
 #include "logdevice/server/epoch_store/ZookeeperEpochStore.h"
 
+#include <algorithm>
 #include <cstring>
 
 #include <boost/filesystem.hpp>
@@ -244,6 +245,16 @@ void ZookeeperEpochStore::legacyWriteZnode(RequestContext&& context,
                                            std::string legacy_znode_value,
                                            zk::version_t legacy_znode_version) {
   std::string znode_path = context.zrq->getZnodePath(rootPath());
+  if (settings_->epoch_store_multi_op_max_logs > 1) {
+    // The version check is done by the set op of the multi-op instead.
+    std::vector<zk::Op> ops;
+    ops.emplace_back(ZookeeperClientBase::makeSetOp(
+        std::move(znode_path),
+        std::move(legacy_znode_value),
+        legacy_znode_version));
+    enqueueWrite(std::move(context), std::move(ops));
+    return;
+  }
   // setData() below succeeds only if the current version number of
   // znode at znode_path matches the version that the znode had
   // when we read its value. Zookeeper atomically increments the version
@@ -284,6 +295,11 @@ void ZookeeperEpochStore::doubleWriteZnode(
                                      legacy_znode_version),
   };
 
+  if (settings_->epoch_store_multi_op_max_logs > 1) {
+    enqueueWrite(std::move(context), std::move(ops));
+    return;
+  }
+
   auto cb = [this, context = std::move(context)](
                 int rc, std::vector<zk::OpResponse> /* results */) mutable {
     auto logid = context.zrq->logid_;
@@ -292,6 +308,120 @@ void ZookeeperEpochStore::doubleWriteZnode(
   zkclient_->multiOp(std::move(ops), std::move(cb));
 }
 
+void ZookeeperEpochStore::enqueueWrite(RequestContext&& context,
+                                       std::vector<zk::Op> ops) {
+  {
+    std::lock_guard<std::mutex> lock(batch_mutex_);
+    pending_writes_.push_back(BatchedWrite{std::move(context), std::move(ops)});
+  }
+  flushWrites();
+}
+
+void ZookeeperEpochStore::flushWrites() {
+  std::vector<std::vector<BatchedWrite>> batches;
+  {
+    std::lock_guard<std::mutex> lock(batch_mutex_);
+    const size_t max_logs =
+        std::max<size_t>(1, settings_->epoch_store_multi_op_max_logs);
+    const size_t max_in_flight = settings_->epoch_store_multi_op_max_in_flight;
+    while (!pending_writes_.empty() && multi_ops_in_flight_ < max_in_flight) {
+      std::vector<BatchedWrite> batch;
+      do {
+        batch.push_back(std::move(pending_writes_.front()));
+        pending_writes_.pop_front();
+      } while (!batch.back().solo && batch.size() < max_logs &&
+               !pending_writes_.empty() && !pending_writes_.front().solo);
+      ++multi_ops_in_flight_;
+      batches.push_back(std::move(batch));
+    }
+  }
+
+  // Send outside of the lock, the completion may run inline.
+  for (auto& batch : batches) {
+    std::vector<zk::Op> ops;
+    for (const auto& write : batch) {
+      ops.insert(ops.end(), write.ops.begin(), write.ops.end());
+    }
+    STAT_INCR(stats_, zookeeper_epoch_store_multi_ops);
+    STAT_ADD(stats_, zookeeper_epoch_store_multi_op_logs, batch.size());
+    auto cb = [this, batch = std::move(batch)](
+                  int rc, std::vector<zk::OpResponse> results) mutable {
+      onMultiOpComplete(std::move(batch), rc, std::move(results));
+    };
+    zkclient_->multiOp(std::move(ops), std::move(cb));
+  }
+}
+
+void ZookeeperEpochStore::onMultiOpComplete(
+    std::vector<BatchedWrite> batch,
+    int rc,
+    std::vector<zk::OpResponse> results) {
+  {
+    std::lock_guard<std::mutex> lock(batch_mutex_);
+    ld_check(multi_ops_in_flight_ > 0);
+    --multi_ops_in_flight_;
+  }
+
+  const bool conflict = rc == ZBADVERSION || rc == ZNONODE || rc == ZNODEEXISTS;
+  if (rc == ZOK || batch.size() == 1 || !conflict) {
+    // Either every write succeeded, or the outcome is the same for all of
+    // them (e.g. the session expired).
+    for (auto& write : batch) {
+      const logid_t logid = write.context.zrq->logid_;
+      postRequestCompletion(
+          completionStatus(rc, logid), std::move(write.context));
+    }
+    flushWrites();
+    return;
+  }
+
+  STAT_INCR(stats_, zookeeper_epoch_store_multi_op_conflicts);
+
+  // ZooKeeper reports the error on the op that failed and ZOK or
+  // ZRUNTIMEINCONSISTENCY on the ops that were rolled back.
+  std::vector<int> own_rc(batch.size(), ZOK);
+  size_t culprits = 0;
+  size_t num_ops = 0;
+  for (const auto& write : batch) {
+    num_ops += write.ops.size();
+  }
+  if (results.size() == num_ops) {
+    size_t op_idx = 0;
+    for (size_t i = 0; i < batch.size(); ++i) {
+      for (size_t j = 0; j < batch[i].ops.size(); ++j, ++op_idx) {
+        const int op_rc = results[op_idx].rc_;
+        if (op_rc != ZOK && op_rc != ZRUNTIMEINCONSISTENCY &&
+            own_rc[i] == ZOK) {
+          own_rc[i] = op_rc;
+          ++culprits;
+        }
+      }
+    }
+  }
+  const bool attributed = culprits > 0 && culprits < batch.size();
+
+  std::vector<BatchedWrite> retries;
+  for (size_t i = 0; i < batch.size(); ++i) {
+    if (attributed && own_rc[i] != ZOK) {
+      const logid_t logid = batch[i].context.zrq->logid_;
+      postRequestCompletion(
+          completionStatus(own_rc[i], logid), std::move(batch[i].context));
+    } else {
+      batch[i].solo = !attributed;
+      retries.push_back(std::move(batch[i]));
+    }
+  }
+
+  {
+    // The retried writes go ahead of the ones that arrived in the meantime.
+    std::lock_guard<std::mutex> lock(batch_mutex_);
+    for (auto it = retries.rbegin(); it != retries.rend(); ++it) {
+      pending_writes_.push_front(std::move(*it));
+    }
+  }
+  flushWrites();
+}
+
 void ZookeeperEpochStore::onGetZnodeComplete(
     RequestContext&& context,
     ZnodeReadResult legacy_znode,
@@ -8,8 +8,11 @@
 #pragma once
 
 #include <chrono>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include <boost/noncopyable.hpp>
 #include <folly/Optional.h>
@@ -153,6 +156,24 @@ class ZookeeperEpochStore : public EpochStore, boost::noncopyable {
     RequestSettings settings;
   };
 
+  // A versioned write of a single log's znode(s) waiting to be sent as part
+  // of a multi-op transaction.
+  struct BatchedWrite {
+    RequestContext context;
+    // One setData op, or two if double writing.
+    std::vector<zk::Op> ops;
+    // If true, this write must be sent in a transaction of its own. Set when
+    // a multi-op failed and the failure could not be attributed to a
+    // particular log.
+    bool solo{false};
+  };
+
+  // Protects pending_writes_ and multi_ops_in_flight_.
+  std::mutex batch_mutex_;
+  // Writes waiting for a multi-op slot, in arrival order.
+  std::deque<BatchedWrite> pending_writes_;
+  size_t multi_ops_in_flight_{0};
+
   /**
    * Run a zoo_aget() on a znode, optionally followed by a modify and a
    * version-conditional zoo_aset() of a new value into the same znode.
@@ -201,6 +222,31 @@ class ZookeeperEpochStore : public EpochStore, boost::noncopyable {
                         std::string legacy_znode_value,
                         zk::version_t legacy_znode_version,
                         zk::version_t migration_znode_version);
+
+  /**
+   * Queues the ops of a log's versioned write to be sent in a multi-op
+   * together with writes of other logs, and sends as many multi-ops as
+   * --epoch-store-multi-op-max-in-flight allows.
+   */
+  void enqueueWrite(RequestContext&& context, std::vector<zk::Op> ops);
+
+  /**
+   * Sends queued writes in multi-ops of at most
+   * --epoch-store-multi-op-max-logs logs while fewer than
+   * --epoch-store-multi-op-max-in-flight multi-ops are outstanding.
+   */
+  void flushWrites();
+
+  /**
+   * Completes the writes of a multi-op. Since a multi-op is all-or-nothing,
+   * a conflict on one log (e.g. a concurrent writer bumped the znode version)
+   * fails the whole transaction. The logs that caused it are completed with
+   * their own status and the rest are queued again. If the culprits cannot
+   * be told apart, every write is retried in a transaction of its own.
+   */
+  void onMultiOpComplete(std::vector<BatchedWrite> batch,
+                         int rc,
+                         std::vector<zk::OpResponse> results);
 };
 
 }} // namespace facebook::logdevice
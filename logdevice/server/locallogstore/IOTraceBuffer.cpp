@@ -0,0 +1,235 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/locallogstore/IOTraceBuffer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+
+#include <folly/Conv.h>
+#include <folly/FileUtil.h>
+#include <folly/lang/Bits.h>
+
+#include "logdevice/common/checks.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/include/Err.h"
+
+namespace facebook { namespace logdevice {
+
+namespace {
+
+constexpr uint32_t FILE_MAGIC = 0x54494C44; // "LDIT"
+constexpr uint32_t CURRENT_VERSION = 1;
+
+struct FileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t event_size;
+  uint32_t reserved;
+} __attribute__((__packed__));
+
+uint64_t parseFileNumber(folly::StringPiece s) {
+  auto number = folly::tryTo<uint64_t>(s);
+  return number.hasValue() ? number.value() : 0;
+}
+
+} // namespace
+
+constexpr uint32_t IOTraceEvent::CF_UNKNOWN;
+constexpr size_t IOTraceRing::WORDS;
+
+const char* ioTraceOpName(IOTraceOp op) {
+  switch (op) {
+    case IOTraceOp::OTHER:
+      return "other";
+    case IOTraceOp::OPEN:
+      return "open";
+    case IOTraceOp::CLOSE:
+      return "close";
+    case IOTraceOp::READ:
+      return "read";
+    case IOTraceOp::PREFETCH:
+      return "prefetch";
+    case IOTraceOp::WRITE:
+      return "write";
+    case IOTraceOp::SYNC:
+      return "sync";
+    case IOTraceOp::RANGE_SYNC:
+      return "range_sync";
+    case IOTraceOp::TRUNCATE:
+      return "truncate";
+    case IOTraceOp::ALLOCATE:
+      return "allocate";
+    case IOTraceOp::INVALIDATE_CACHE:
+      return "invalidate_cache";
+    case IOTraceOp::DELETE:
+      return "delete";
+    case IOTraceOp::RENAME:
+      return "rename";
+    case IOTraceOp::MAX:
+      break;
+  }
+  return "invalid";
+}
+
+const char* ioTraceFileTypeName(IOTraceFileType type) {
+  switch (type) {
+    case IOTraceFileType::OTHER:
+      return "other";
+    case IOTraceFileType::SST:
+      return "sst";
+    case IOTraceFileType::WAL:
+      return "wal";
+    case IOTraceFileType::MANIFEST:
+      return "manifest";
+    case IOTraceFileType::DIRECTORY:
+      return "directory";
+    case IOTraceFileType::MAX:
+      break;
+  }
+  return "invalid";
+}
+
+/* static */
+IOTraceFile IOTraceFile::parse(folly::StringPiece filename) {
+  size_t slash = filename.rfind('/');
+  if (slash != folly::StringPiece::npos) {
+    filename.advance(slash + 1);
+  }
+
+  IOTraceFile file;
+  if (filename.removeSuffix(".sst")) {
+    file.type = IOTraceFileType::SST;
+  } else if (filename.removeSuffix(".log")) {
+    file.type = IOTraceFileType::WAL;
+  } else if (filename.removePrefix("MANIFEST-")) {
+    file.type = IOTraceFileType::MANIFEST;
+  } else {
+    return file;
+  }
+  file.number = parseFileNumber(filename);
+  return file;
+}
+
+IOTraceRing::IOTraceRing(size_t capacity)
+    : mask_(folly::nextPowTwo(std::max(capacity, size_t(1))) - 1),
+      slots_(new Slot[mask_ + 1]()) {}
+
+void IOTraceRing::push(const IOTraceEvent& event) {
+  uint64_t words[WORDS];
+  std::memcpy(words, &event, sizeof(words));
+
+  const uint64_t i = head_.load(std::memory_order_relaxed);
+  Slot& slot = slots_[i & mask_];
+  slot.seq.store(2 * i + 1, std::memory_order_relaxed);
+  // Make sure readers see the odd seq before any of the new words.
+  std::atomic_thread_fence(std::memory_order_release);
+  for (size_t k = 0; k < WORDS; ++k) {
+    slot.words[k].store(words[k], std::memory_order_relaxed);
+  }
+  slot.seq.store(2 * i + 2, std::memory_order_release);
+  head_.store(i + 1, std::memory_order_release);
+}
+
+void IOTraceRing::snapshot(std::vector<IOTraceEvent>* out) const {
+  ld_check(out);
+  const uint64_t head = head_.load(std::memory_order_acquire);
+  const uint64_t begin = head > capacity() ? head - capacity() : 0;
+  out->reserve(out->size() + (head - begin));
+
+  for (uint64_t i = begin; i < head; ++i) {
+    const Slot& slot = slots_[i & mask_];
+    const uint64_t expected_seq = 2 * i + 2;
+    if (slot.seq.load(std::memory_order_acquire) != expected_seq) {
+      // Already overwritten by a newer event.
+      continue;
+    }
+    uint64_t words[WORDS];
+    for (size_t k = 0; k < WORDS; ++k) {
+      words[k] = slot.words[k].load(std::memory_order_relaxed);
+    }
+    // Make sure the words are read before checking seq again.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) != expected_seq) {
+      continue;
+    }
+    out->emplace_back();
+    std::memcpy(&out->back(), words, sizeof(words));
+  }
+}
+
+int writeIOTraceFile(const std::string& path,
+                     const std::vector<IOTraceEvent>& events) {
+  int fd = folly::openNoInt(
+      path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    ld_error(
+        "Failed to create IO trace file %s: %s", path.c_str(), strerror(errno));
+    err = E::FAILED;
+    return -1;
+  }
+
+  const FileHeader header{FILE_MAGIC, CURRENT_VERSION, sizeof(IOTraceEvent), 0};
+  const size_t events_size = events.size() * sizeof(IOTraceEvent);
+  bool ok = folly::writeFull(fd, &header, sizeof(header)) == sizeof(header) &&
+      folly::writeFull(fd, events.data(), events_size) == events_size;
+  if (!ok) {
+    ld_error("Failed to write %zu events to IO trace file %s: %s",
+             events.size(),
+             path.c_str(),
+             strerror(errno));
+  }
+  if (folly::closeNoInt(fd) != 0 && ok) {
+    ld_error(
+        "Failed to close IO trace file %s: %s", path.c_str(), strerror(errno));
+    ok = false;
+  }
+  if (!ok) {
+    err = E::FAILED;
+    return -1;
+  }
+  return 0;
+}
+
+int readIOTraceFile(const std::string& path, std::vector<IOTraceEvent>* out) {
+  ld_check(out);
+  std::string contents;
+  if (!folly::readFile(path.c_str(), contents)) {
+    if (errno == ENOENT) {
+      err = E::NOTFOUND;
+    } else {
+      ld_error(
+          "Failed to read IO trace file %s: %s", path.c_str(), strerror(errno));
+      err = E::FAILED;
+    }
+    return -1;
+  }
+
+  FileHeader header;
+  if (contents.size() < sizeof(header)) {
+    err = E::BADMSG;
+    return -1;
+  }
+  std::memcpy(&header, contents.data(), sizeof(header));
+  const size_t events_size = contents.size() - sizeof(header);
+  if (header.magic != FILE_MAGIC || header.version != CURRENT_VERSION ||
+      header.event_size != sizeof(IOTraceEvent) ||
+      events_size % sizeof(IOTraceEvent) != 0) {
+    ld_error("%s is not a valid IO trace file", path.c_str());
+    err = E::BADMSG;
+    return -1;
+  }
+
+  out->clear();
+  out->resize(events_size / sizeof(IOTraceEvent));
+  std::memcpy(out->data(), contents.data() + sizeof(header), events_size);
+  return 0;
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,173 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <folly/Range.h>
+
+#include "logdevice/common/IOTraceContext.h"
+
+/**
+ * @file Binary IO trace events, the per-thread ring buffers IOTracing keeps
+ *       them in, and the file format they are dumped to for offline analysis.
+ *
+ *       Unlike the text traces of IOTracing, events are fixed-size and cost a
+ *       couple dozen stores to record, so they are recorded for every traced
+ *       operation, not only slow ones.
+ */
+
+namespace facebook { namespace logdevice {
+
+// Type of a traced IO operation. Values are stored in dump files, append
+// new ones at the end.
+enum class IOTraceOp : uint8_t {
+  OTHER = 0,
+  OPEN,
+  CLOSE,
+  READ,
+  PREFETCH,
+  WRITE,
+  SYNC,
+  RANGE_SYNC,
+  TRUNCATE,
+  ALLOCATE,
+  INVALIDATE_CACHE,
+  DELETE,
+  RENAME,
+  MAX
+};
+
+const char* ioTraceOpName(IOTraceOp op);
+
+// Type of the file an operation is done on, as told by its name.
+enum class IOTraceFileType : uint8_t {
+  OTHER = 0,
+  SST,
+  WAL,
+  MANIFEST,
+  DIRECTORY,
+  MAX
+};
+
+const char* ioTraceFileTypeName(IOTraceFileType type);
+
+// A rocksdb file, e.g. {SST, 367120} for "367120.sst".
+struct IOTraceFile {
+  IOTraceFileType type = IOTraceFileType::OTHER;
+  // rocksdb file number, 0 if the name doesn't have one.
+  uint64_t number = 0;
+
+  // @param filename  name of the file relative to the shard directory, as
+  //                  given by ShardedRocksDBLocalLogStore::parseFilePath()
+  static IOTraceFile parse(folly::StringPiece filename);
+};
+
+// Parameters of a traced operation, see IOTracing::OpTimer.
+struct IOTraceOpInfo {
+  IOTraceOp op = IOTraceOp::OTHER;
+  IOTraceFile file;
+  uint64_t offset = 0;
+  uint64_t size = 0;
+};
+
+struct IOTraceEvent {
+  // cf_id of operations not done for a particular column family.
+  static constexpr uint32_t CF_UNKNOWN = std::numeric_limits<uint32_t>::max();
+
+  // When the operation started, in microseconds since epoch.
+  int64_t start_time_us;
+  // How long the operation took, in microseconds.
+  uint32_t latency_us;
+  // rocksdb column family ID for flushes and compactions, CF_UNKNOWN
+  // otherwise.
+  uint32_t cf_id;
+  uint64_t file_number;
+  uint64_t offset;
+  uint64_t size;
+  uint16_t shard;
+  IOTraceOp op;
+  IOTraceContext context;
+  IOTraceFileType file_type;
+  uint8_t reserved[3];
+};
+
+static_assert(sizeof(IOTraceEvent) == 48,
+              "IOTraceEvent is stored in dump files, don't change its size");
+static_assert(std::is_trivially_copyable<IOTraceEvent>::value,
+              "IOTraceEvent must be trivially copyable");
+
+/**
+ * A ring buffer of the last events recorded by a thread. Lock-free: it has a
+ * single writer, the thread, and any number of readers taking snapshots.
+ * Each slot is a seqlock, readers skip the slots that get overwritten while
+ * they read them.
+ */
+class IOTraceRing : boost::noncopyable {
+ public:
+  // @param capacity  number of events to keep, rounded up to a power of two
+  explicit IOTraceRing(size_t capacity);
+
+  size_t capacity() const {
+    return mask_ + 1;
+  }
+
+  // Total number of events pushed since the ring was created.
+  uint64_t numPushed() const {
+    return head_.load(std::memory_order_acquire);
+  }
+
+  // Only called by the thread owning the ring.
+  void push(const IOTraceEvent& event);
+
+  // Can be called from any thread. Appends the events currently in the ring
+  // to `out`, oldest first.
+  void snapshot(std::vector<IOTraceEvent>* out) const;
+
+ private:
+  static constexpr size_t WORDS = sizeof(IOTraceEvent) / sizeof(uint64_t);
+
+  struct Slot {
+    // 2 * i + 2 when the slot contains event number i, odd while an event is
+    // being written to it, 0 if it was never written.
+    std::atomic<uint64_t> seq{0};
+    std::atomic<uint64_t> words[WORDS];
+  };
+
+  const uint64_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+  std::atomic<uint64_t> head_{0};
+};
+
+/**
+ * Writes events to a dump file at `path`, replacing it. The file is a
+ * header followed by the raw events in host byte order.
+ *
+ * @return  0 on success, -1 on failure with err set to E::FAILED.
+ */
+int writeIOTraceFile(const std::string& path,
+                     const std::vector<IOTraceEvent>& events);
+
+/**
+ * Reads the events of a file written by writeIOTraceFile().
+ *
+ * @return  0 on success, -1 on failure with err set to:
+ *            NOTFOUND  the file does not exist
+ *            BADMSG    the file is not an IO trace dump of this version
+ *            FAILED    the file could not be read
+ */
+int readIOTraceFile(const std::string& path, std::vector<IOTraceEvent>* out);
+
+}} // namespace facebook::logdevice
@@ -7,13 +7,22 @@
  */
 #include "logdevice/server/locallogstore/IOTracing.h"
 
+#include <algorithm>
+#include <limits>
+
 #include "logdevice/common/chrono_util.h"
 #include "logdevice/common/debug.h"
+#include "logdevice/common/stats/PerShardHistograms.h"
 
 namespace facebook { namespace logdevice {
 
-IOTracing::IOTracing(shard_index_t shard_idx, StatsHolder* stats)
-    : shardIdx_(shard_idx), stats_(stats) {}
+IOTracing::IOTracing(shard_index_t shard_idx,
+                     StatsHolder* stats,
+                     size_t trace_ring_size)
+    : shardIdx_(shard_idx),
+      stats_(stats),
+      traceRingSize_(trace_ring_size),
+      threadTraces_([this] { return new ThreadTrace(traceRingSize_); }) {}
 
 IOTracing::~IOTracing() {
   if (stallDetectionThread_.enabled) {
@@ -39,6 +48,47 @@ void IOTracing::reportCompletedOp(std::chrono::steady_clock::duration duration,
   }
 }
 
+void IOTracing::recordCompletedOp(
+    const IOTraceOpInfo& info,
+    std::chrono::steady_clock::duration duration) {
+  ThreadTrace& trace = *threadTraces_;
+  const int64_t latency_us = std::max(to_usec(duration).count(), int64_t(0));
+
+  IOTraceEvent event{};
+  event.start_time_us =
+      to_usec(std::chrono::system_clock::now().time_since_epoch()).count() -
+      latency_us;
+  event.latency_us = static_cast<uint32_t>(std::min<int64_t>(
+      latency_us, std::numeric_limits<uint32_t>::max()));
+  event.cf_id = trace.cfId;
+  event.file_number = info.file.number;
+  event.offset = info.offset;
+  event.size = info.size;
+  event.shard = static_cast<uint16_t>(shardIdx_);
+  event.op = info.op;
+  event.context = trace.context;
+  event.file_type = info.file.type;
+  trace.ring.push(event);
+
+  PER_SHARD_HISTOGRAM_ADD(stats_,
+                          io_latency[static_cast<int>(trace.context)],
+                          shardIdx_,
+                          latency_us);
+}
+
+std::vector<IOTraceEvent> IOTracing::getRecentEvents() {
+  std::vector<IOTraceEvent> events;
+  for (const ThreadTrace& trace : threadTraces_.accessAllThreads()) {
+    trace.ring.snapshot(&events);
+  }
+  std::stable_sort(events.begin(),
+                   events.end(),
+                   [](const IOTraceEvent& a, const IOTraceEvent& b) {
+                     return a.start_time_us < b.start_time_us;
+                   });
+  return events;
+}
+
 void IOTracing::updateOptions(bool tracing_enabled,
                               std::chrono::milliseconds threshold,
                               std::chrono::milliseconds stall_threshold) {
@@ -15,11 +15,13 @@
 #include <folly/Utility.h>
 #include <folly/lang/Aligned.h>
 
+#include "logdevice/common/IOTraceContext.h"
 #include "logdevice/common/ThreadID.h"
 #include "logdevice/common/checks.h"
 #include "logdevice/common/stats/Stats.h"
 #include "logdevice/common/toString.h"
 #include "logdevice/common/types_internal.h"
+#include "logdevice/server/locallogstore/IOTraceBuffer.h"
 
 /**
  * @file
@@ -49,18 +51,29 @@
  * To time and report an IO operation, use macro SCOPED_IO_TRACED_OP();
  * this is done in RocksDBEnv.cpp - very close to the actual syscalls for IO.
  *
- * The thread-local context is currently just a free-form std::string to which
- * everyone appends. It could instead be more structured, e.g. describe the
- * reason for iops with an enum (e.g. write path, read path, rebuilding etc)
- * and aggregate some stats per enum value. We don't do it for now, to keep
- * adding context easy, but it may make sense in future, when we have a better
- * idea of what sort of aggregated stats would be useful to expose.
+ * The thread-local context is just a free-form std::string to which
+ * everyone appends.
  *
  * Performance-wise, appending to thread-local std::string should be pretty
  * cheap because it doesn't do memory allocations, apart from the initial
  * growth that happens O(1) times per thread's lifetime; and because
  * folly::format() appends directly to the string, without allocating temporary
  * buffers.
+ *
+ * Binary tracing
+ * --------------
+ * Independently of the text traces above, and meant to be always on
+ * (rocksdb-io-trace-ring-size > 0), every traced operation is recorded as a
+ * fixed-size IOTraceEvent (op, file, offset, size, latency, column family,
+ * IOTraceContext) into a lock-free ring buffer of the thread, see
+ * IOTraceBuffer.h. Its latency is also added to the per-shard io_latency
+ * histogram of its IOTraceContext, which says what the IO was done for:
+ * flush, compaction, read stream, findTime, rebuilding etc. The context is
+ * set with SCOPED_IO_TRACING_CONTEXT_TYPE() by storage threads for the task
+ * they run, and by RocksDBListener for flushes and compactions.
+ *
+ * The rings are read by the "info io_traces" admin command and dumped to a
+ * file by "dump_io_traces", for offline analysis.
  */
 
 namespace facebook { namespace logdevice {
@@ -84,6 +97,18 @@ class IOTracing {
       folly::Synchronized<ThreadState, folly::SpinLock>;
   using LockedThreadState = ThreadStateWithMutex::LockedPtr;
 
+  // Thread-local state of binary tracing. Only accessed by the owning thread,
+  // except for `ring`, which is lock-free and read by other threads.
+  struct ThreadTrace {
+    explicit ThreadTrace(size_t ring_size) : ring(ring_size) {}
+
+    // What the thread's IO is currently done for.
+    IOTraceContext context = IOTraceContext::OTHER;
+    uint32_t cfId = IOTraceEvent::CF_UNKNOWN;
+
+    IOTraceRing ring;
+  };
+
  public:
   // Appends the given string, formatted with folly::format(), to IOTracing's
   // thread-local context string.
@@ -172,35 +197,108 @@ class IOTracing {
     size_t addedSize_ = 0;
   };
 
+  // Sets the IOTraceContext that binary tracing attributes this thread's IO
+  // operations to, optionally along with a column family.
+  // Destructor restores the previous context.
+  // Usually used through SCOPED_IO_TRACING_CONTEXT_TYPE() rather than
+  // directly. Need to be destroyed in LIFO order.
+  class SetContextType {
+   public:
+    // Doesn't set anything. Used when binary tracing is disabled.
+    SetContextType() = default;
+
+    // Note that it doesn't check if isBinaryTracingEnabled(); it needs to be
+    // checked outside, before calling this.
+    SetContextType(IOTracing* tracing,
+                   IOTraceContext context,
+                   uint32_t cf_id = IOTraceEvent::CF_UNKNOWN) {
+      assign(tracing, context, cf_id);
+    }
+
+    SetContextType(SetContextType&& rhs) noexcept
+        : threadTrace_(rhs.threadTrace_),
+          prevContext_(rhs.prevContext_),
+          prevCfId_(rhs.prevCfId_) {
+      rhs.threadTrace_ = nullptr;
+    }
+
+    // Not supported for the same reason as AddContext's.
+    SetContextType& operator=(SetContextType&& rhs) = delete;
+
+    ~SetContextType() {
+      clear();
+    }
+
+    void assign(IOTracing* tracing,
+                IOTraceContext context,
+                uint32_t cf_id = IOTraceEvent::CF_UNKNOWN) {
+      clear();
+      threadTrace_ = tracing->threadTraces_.get();
+      prevContext_ = threadTrace_->context;
+      prevCfId_ = threadTrace_->cfId;
+      threadTrace_->context = context;
+      threadTrace_->cfId = cf_id;
+    }
+
+    void clear() {
+      if (threadTrace_ == nullptr) {
+        return;
+      }
+      threadTrace_->context = prevContext_;
+      threadTrace_->cfId = prevCfId_;
+      threadTrace_ = nullptr;
+    }
+
+   private:
+    ThreadTrace* threadTrace_ = nullptr;
+    IOTraceContext prevContext_ = IOTraceContext::OTHER;
+    uint32_t prevCfId_ = IOTraceEvent::CF_UNKNOWN;
+  };
+
   // Times and reports an IO operation. Also contains an AddContext for
   // convenience, since virtually all traced IO operations want to add some
   // context (namely, operation type and parameters) right next to operation.
   // Constructor grabs current time and appends to context, destructor does
-  // the actual reporting.
+  // the actual reporting: logs the operation if it's slow and text tracing
+  // isEnabled(), and records it as an IOTraceEvent if binary tracing is
+  // enabled.
   // Usually used through SCOPED_IO_TRACED_OP() rather than directly.
   class OpTimer {
    public:
     // Doesn't time or report anything. Used when tracing is disabled.
     OpTimer() = default;
 
-    // Appends to context and starts the timer. Note that it doesn't check if
-    // tracing isEnabled(); it needs to be checked outside, before calling this.
+    // Appends to context if text tracing isEnabled(), and starts the timer.
+    // Note that it doesn't check if any tracing isOpTracingEnabled(); it
+    // needs to be checked outside, before calling this.
+    // Format arguments are only formatted if text tracing is enabled.
     template <class... Args>
-    OpTimer(IOTracing* tracing, folly::StringPiece format, Args&&... args)
-        : tracing_(tracing),
-          addContext_(tracing, format, std::forward<Args>(args)...),
-          startTime_(std::chrono::steady_clock::now()) {
-      auto locked_state = tracing_->threadStates_->lock();
-      ld_check(locked_state->currentOpStartTime ==
-               std::chrono::steady_clock::time_point::max());
-      locked_state->currentOpStartTime = startTime_;
+    OpTimer(IOTracing* tracing,
+            const IOTraceOpInfo& info,
+            folly::StringPiece format,
+            Args&&... args)
+        : tracing_(tracing), info_(info) {
+      textTraced_ = tracing_->isEnabled();
+      if (textTraced_) {
+        addContext_.assign(tracing_, format, std::forward<Args>(args)...);
+      }
+      startTime_ = std::chrono::steady_clock::now();
+      if (textTraced_) {
+        auto locked_state = tracing_->threadStates_->lock();
+        ld_check(locked_state->currentOpStartTime ==
+                 std::chrono::steady_clock::time_point::max());
+        locked_state->currentOpStartTime = startTime_;
+      }
     }
 
     OpTimer(OpTimer&& rhs) noexcept
         : tracing_(rhs.tracing_),
+          info_(rhs.info_),
+          textTraced_(rhs.textTraced_),
           addContext_(std::move(rhs.addContext_)),
           startTime_(rhs.startTime_) {
       rhs.tracing_ = nullptr;
+      rhs.textTraced_ = false;
       rhs.startTime_ = std::chrono::steady_clock::time_point::min();
     }
 
@@ -212,6 +310,13 @@ class IOTracing {
       }
       auto duration = std::chrono::steady_clock::now() - startTime_;
 
+      if (tracing_->isBinaryTracingEnabled()) {
+        tracing_->recordCompletedOp(info_, duration);
+      }
+
+      if (!textTraced_) {
+        return;
+      }
       auto locked_state = tracing_->threadStates_->lock();
       ld_check_eq(locked_state->currentOpStartTime.time_since_epoch().count(),
                   startTime_.time_since_epoch().count());
@@ -223,18 +328,43 @@ class IOTracing {
 
    private:
     IOTracing* tracing_ = nullptr;
+    IOTraceOpInfo info_;
+    // Whether text tracing was enabled when the operation started.
+    bool textTraced_ = false;
     AddContext addContext_;
     std::chrono::steady_clock::time_point startTime_ =
         std::chrono::steady_clock::time_point::min();
   };
 
-  explicit IOTracing(shard_index_t shard_idx, StatsHolder* stats);
+  // @param trace_ring_size  number of binary trace events to keep for each
+  //                         thread, 0 to disable binary tracing
+  IOTracing(shard_index_t shard_idx,
+            StatsHolder* stats,
+            size_t trace_ring_size = 0);
   ~IOTracing();
 
+  // Whether text tracing is enabled, see rocksdb-io-tracing-shards.
   bool isEnabled() const {
     return options_->enabled.load(std::memory_order_relaxed);
   }
 
+  bool isBinaryTracingEnabled() const {
+    return traceRingSize_ > 0;
+  }
+
+  // Whether any kind of tracing wants IO operations to be timed.
+  bool isOpTracingEnabled() const {
+    return isBinaryTracingEnabled() || isEnabled();
+  }
+
+  shard_index_t getShardIdx() const {
+    return shardIdx_;
+  }
+
+  // Returns the binary trace events currently in the rings of all threads,
+  // ordered by start time.
+  std::vector<IOTraceEvent> getRecentEvents();
+
   // Not thread safe.
   void updateOptions(bool tracing_enabled,
                      std::chrono::milliseconds threshold,
@@ -251,6 +381,7 @@ class IOTracing {
 
   shard_index_t shardIdx_;
   StatsHolder* stats_;
+  const size_t traceRingSize_;
   folly::cacheline_aligned<Options> options_;
 
   // Information about all threads that touched this IOTracing.
@@ -261,6 +392,10 @@ class IOTracing {
   folly::ThreadLocal<folly::Synchronized<ThreadState, folly::SpinLock>, Tag>
       threadStates_;
 
+  // Binary tracing state of all threads that touched this IOTracing.
+  struct TraceTag {};
+  folly::ThreadLocal<ThreadTrace, TraceTag> threadTraces_;
+
   struct {
     std::mutex mutex;           // protects `cv`
     std::condition_variable cv; // notified to wake up the thread
@@ -276,6 +411,12 @@ class IOTracing {
   // Usually used through OpTimer/SCOPED_IO_TRACED_OP() rather than directly.
   void reportCompletedOp(std::chrono::steady_clock::duration duration,
                          LockedThreadState& locked_state);
+
+  // Appends an event to this thread's ring and adds the latency to the
+  // histogram of the thread's current IOTraceContext.
+  // Does _not_ check isBinaryTracingEnabled().
+  void recordCompletedOp(const IOTraceOpInfo& info,
+                         std::chrono::steady_clock::duration duration);
 };
 
 // Declares a local variable of type AddContext, passing it the given arguments.
@@ -289,11 +430,21 @@ class IOTracing {
       ? IOTracing::AddContext((tracing), (format), ##args)  \
       : IOTracing::AddContext()
 
+// Declares a local variable of type SetContextType. If binary tracing is
+// disabled, it's a no-op.
+#define SCOPED_IO_TRACING_CONTEXT_TYPE(tracing, context) \
+  auto FB_ANONYMOUS_VARIABLE(io_tracing_ctx_type) =      \
+      ((tracing) && (tracing)->isBinaryTracingEnabled()) \
+      ? IOTracing::SetContextType((tracing), (context))  \
+      : IOTracing::SetContextType()
+
 // Declares a local variable of type OpTimer, passing it the given arguments.
 // This macro intentionally doesn't nest, you can have at most one per scope;
 // that's because IO tracing is intended for low-level indivisible operations,
 // like file reads/writes.
 // If tracing is disabled, arguments are not evaluated, and OpTimer is no-op.
+// If only binary tracing is enabled, arguments are evaluated but not
+// formatted.
 // Note that if you add context after this macro but before the OpTimer goes
 // out of scope, this context _will_ show up in the trace for this operation;
 // this is useful e.g. for reporting the result of the operation:
@@ -303,9 +454,14 @@ class IOTracing {
 //   int rv = foo_op(fd, offset, size);
 //   SCOPED_IO_TRACING_CONTEXT(tracing, "rv:{}", rv);
 // }
-#define SCOPED_IO_TRACED_OP(tracing, format, args...)         \
-  auto _io_tracing_op = ((tracing) && (tracing)->isEnabled()) \
-      ? IOTracing::OpTimer((tracing), (format), ##args)       \
+#define SCOPED_IO_TRACED_OP(tracing, format, args...) \
+  SCOPED_IO_TRACED_OP_WITH_INFO(tracing, IOTraceOpInfo(), format, ##args)
+
+// Same as SCOPED_IO_TRACED_OP(), but also tells binary tracing what the
+// operation is, as an IOTraceOpInfo.
+#define SCOPED_IO_TRACED_OP_WITH_INFO(tracing, info, format, args...)  \
+  auto _io_tracing_op = ((tracing) && (tracing)->isOpTracingEnabled()) \
+      ? IOTracing::OpTimer((tracing), (info), (format), ##args)        \
       : IOTracing::OpTimer()
 
 }} // namespace facebook::logdevice
@@ -50,6 +50,18 @@ int LocalLogStore::findKey(logid_t /*log_id*/,
 
 void LocalLogStore::normalizeTimeRanges(RecordTimeIntervals&) const {}
 
+void LocalLogStore::updateLogMetadataBatch(
+    const std::vector<std::pair<logid_t, ComparableLogMetadata*>>& metadata,
+    std::vector<Status>& statuses_out,
+    const WriteOptions& opts) {
+  statuses_out.resize(metadata.size());
+  for (size_t i = 0; i < metadata.size(); ++i) {
+    ld_check(metadata[i].second != nullptr);
+    int rv = updateLogMetadata(metadata[i].first, *metadata[i].second, opts);
+    statuses_out[i] = rv == 0 ? E::OK : err;
+  }
+}
+
 int LocalLogStore::registerOnFlushCallback(FlushCallback& cb) {
   std::unique_lock<std::mutex> lock(flushing_mtx_);
   ld_check(!cb.links.is_linked());
@@ -249,6 +261,13 @@ bool LocalLogStoreReadFilter::operator()(logid_t,
   return true;
 }
 
+bool LocalLogStoreReadFilter::shouldProcessFilterableKey(
+    logid_t,
+    lsn_t,
+    folly::StringPiece key) {
+  return key_filter_ == nullptr || (*key_filter_)(key);
+}
+
 void LocalLogStoreReadFilter::applyCopysetReordering(
     ShardID* copyset,
     copyset_size_t copyset_size) const {
@@ -21,6 +21,7 @@
 #include "logdevice/common/LocalLogStoreRecordFormat.h"
 #include "logdevice/common/Metadata.h"
 #include "logdevice/common/SCDCopysetReordering.h"
+#include "logdevice/common/ServerRecordFilter.h"
 #include "logdevice/common/Timestamp.h"
 #include "logdevice/common/configuration/NodeLocation.h"
 #include "logdevice/common/configuration/ServerConfig.h"
@@ -372,6 +373,19 @@ class LocalLogStore : boost::noncopyable {
     // This counter is bumped each time we seek to a new partition in LogsDB.
     size_t seen_logsdb_partitions{0};
 
+    // Records rejected by ReadFilter::shouldProcessFilterableKey() based on
+    // the key in their copyset index entry, without reading the record.
+    // Unlike records rejected by ReadFilter::operator(), the reader needs to
+    // report these to the client, so their LSNs are appended to
+    // key_filtered_lsns in iteration order. The reader is expected to
+    // consume and clear the vector after each seek() or next().
+    size_t key_filtered_records{0};
+    std::vector<lsn_t> key_filtered_lsns;
+    // Soft limit on key_filtered_records. Bounds the size of
+    // key_filtered_lsns when long runs of records are skipped, and the
+    // amount of work done for a read that ships nothing.
+    size_t max_key_filtered_records{10000};
+
     size_t max_bytes_to_read{std::numeric_limits<size_t>::max()};
 
     std::chrono::time_point<std::chrono::steady_clock> read_start_time;
@@ -410,6 +424,7 @@ class LocalLogStore : boost::noncopyable {
     // readily available in memory, we should deliver it.
     bool softLimitReached() {
       return read_record_bytes + read_csi_bytes >= max_bytes_to_read ||
+          key_filtered_records >= max_key_filtered_records ||
           (max_execution_time != std::chrono::milliseconds::max() &&
            msec_since(read_start_time) >= max_execution_time.count());
     }
@@ -460,6 +475,11 @@ class LocalLogStore : boost::noncopyable {
         ++filtered_csi_entries;
       }
     }
+
+    void countKeyFilteredRecord(lsn_t lsn) {
+      ++key_filtered_records;
+      key_filtered_lsns.push_back(lsn);
+    }
   };
 
   /**
@@ -503,6 +523,18 @@ class LocalLogStore : boost::noncopyable {
                                           RecordTimestamp /* max_ts */) {
       return true;
     }
+
+    // Called for records that passed operator() and whose copyset index
+    // entry carries the record's KeyType::FILTERABLE key (see
+    // CSI_FLAG_FILTERABLE_KEY), before reading the record. If it returns
+    // false, the iterator skips the record and reports it in
+    // ReadStats::key_filtered_lsns. Only called if the iterator was given
+    // a ReadStats.
+    virtual bool shouldProcessFilterableKey(logid_t,
+                                            lsn_t,
+                                            folly::StringPiece /* key */) {
+      return true;
+    }
   };
 
   struct WriteOptions {
@@ -624,6 +656,29 @@ class LocalLogStore : boost::noncopyable {
    */
   virtual FlushToken walSyncedUpThrough() const = 0;
 
+  /**
+   * Ingests, as SST files, the writes that the store buffered for ingestion
+   * instead of writing them through the memtable (see
+   * WriteOp::ingestToken()) and that are due: buffers that are full or have
+   * been waiting for long enough, or all of them if `all` is true. Does
+   * blocking IO; called from a dedicated storage thread.
+   *
+   * @return On success, returns 0.  On failure, returns -1 and sets err to
+   *         LOCAL_LOG_STORE_WRITE; the writes stay buffered.
+   */
+  virtual int ingestBufferedWrites(bool /* all */) {
+    return 0;
+  }
+
+  /**
+   * @return the largest token, issued by WriteOp::ingestToken(), such that
+   *         all writes with this token or below have been ingested.
+   *         FlushToken_MAX if nothing is waiting to be ingested.
+   */
+  virtual FlushToken ingestedUpThrough() const {
+    return FlushToken_MAX;
+  }
+
   /**
    * The steady clock time at which the oldest uncommitted write was
    * received by the system.
@@ -843,6 +898,22 @@ class LocalLogStore : boost::noncopyable {
                                 ComparableLogMetadata& metadata,
                                 const WriteOptions& opts = WriteOptions()) = 0;
 
+  /**
+   * Same as calling updateLogMetadata() for each entry of `metadata` in
+   * order, but implementations may write all the entries at once. Used for
+   * sealing many logs with one write, see SealStorageTask::executeBatch().
+   *
+   * @param statuses_out  Set to one status per entry of `metadata`: OK,
+   *                      or the err updateLogMetadata() would have set
+   *                      (UPTODATE updates the entry like it does there).
+   *
+   * The default implementation calls updateLogMetadata() in a loop.
+   */
+  virtual void updateLogMetadataBatch(
+      const std::vector<std::pair<logid_t, ComparableLogMetadata*>>& metadata,
+      std::vector<Status>& statuses_out,
+      const WriteOptions& opts = WriteOptions());
+
   /**
    * Option that decides whether to check seal metadata preemption for
    * PerEpochLogMetadata.
@@ -1092,6 +1163,10 @@ class LocalLogStoreReadFilter : public LocalLogStore::ReadFilter {
                   RecordTimestamp min_ts,
                   RecordTimestamp max_ts) override;
 
+  bool shouldProcessFilterableKey(logid_t,
+                                  lsn_t,
+                                  folly::StringPiece key) override;
+
   // If valid(), this is the id of this storage shard and scd filtering should
   // be used.
   // @see doc/single-copy-delivery.md for more information about scd.
@@ -1120,6 +1195,9 @@ class LocalLogStoreReadFilter : public LocalLogStore::ReadFilter {
   // If not null, this is the location of the client and local scd should be
   // used.
   std::unique_ptr<NodeLocation> client_location_;
+  // Server-side filter of the read stream, if any. Records whose copyset
+  // index entry has a filterable key that doesn't pass it are skipped.
+  std::shared_ptr<ServerRecordFilter> key_filter_;
 
   // When `scd_copyset_reordering_' != NONE, reorder the copyset using the
   // chosen algorithm.  Public for testing.
@@ -1159,6 +1237,13 @@ class ShardedLocalLogStore {
    */
   virtual void setSequencerInitiatedSpaceBasedRetention(int /* shard_idx */) {}
 
+  /**
+   * Groups of shards that live on the same storage device. Empty if unknown.
+   */
+  virtual std::vector<std::vector<int>> getShardsGroupedByDevice() {
+    return {};
+  }
+
   virtual ~ShardedLocalLogStore() {}
 };
 
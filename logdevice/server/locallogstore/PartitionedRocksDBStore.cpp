@@ -12,6 +12,7 @@
 #include <cstdlib>
 #include <iterator>
 #include <list>
+#include <tuple>
 
 #include <folly/Conv.h>
 #include <folly/Likely.h>
@@ -22,6 +23,7 @@
 #include <rocksdb/convenience.h>
 #include <rocksdb/merge_operator.h>
 #include <rocksdb/sst_file_manager.h>
+#include <rocksdb/sst_file_writer.h>
 
 #include "logdevice/common/ConstructorFailed.h"
 #include "logdevice/common/LocalLogStoreRecordFormat.h"
@@ -2887,6 +2889,17 @@ int PartitionedRocksDBStore::writeMultiImpl(
 
   const bool skip_rebuilding = getRebuildingSettings()->read_only ==
       RebuildingReadOnlyOption::ON_RECIPIENT;
+  // With --rebuilding-ingest-sst, rebuilding writes are added to the ingest
+  // buffers of their partitions instead of being written through the
+  // memtable. If track_ingest is true, ingest_flags[i] says whether writes[i]
+  // may be buffered, and write_partitions[i] is the partition of writes[i],
+  // if any. Tracking is also needed if buffers were filled before the setting
+  // was turned off, so that writes aren't reordered with buffered ones.
+  const bool ingest_rebuilding = getRebuildingSettings()->ingest_sst;
+  const bool track_ingest =
+      ingest_rebuilding || ingest_buffered_bytes_.load() > 0;
+  std::vector<bool> ingest_flags;
+  std::vector<PartitionPtr> write_partitions;
 
   // Writes and clears rocksdb_batch. Used for flushing directory updates
   // between calls to getWritePartition() for the same log.
@@ -2925,7 +2938,9 @@ int PartitionedRocksDBStore::writeMultiImpl(
     }
 
     RocksDBCFPtr cf_ptr;
+    PartitionPtr op_partition;
     bool skip_op = false;
+    bool ingest_op = false;
 
     switch (write->getType()) {
       case WriteType::PUT:
@@ -3108,6 +3123,11 @@ int PartitionedRocksDBStore::writeMultiImpl(
                                    put_op->coordinator.value(),
                                    put_op->isRebuilding() ? DataClass::REBUILD
                                                           : DataClass::APPEND);
+            // Buffered records are acknowledged once they're ingested. Their
+            // directory entries are still in the metadata memtable then, so
+            // the partition stays dirty like for a memtable write.
+            ingest_op = ingest_rebuilding && put_op->isRebuilding() &&
+                put_op->durability() <= Durability::MEMORY;
           }
         }
 
@@ -3116,6 +3136,7 @@ int PartitionedRocksDBStore::writeMultiImpl(
         dir_updates_pending[op->log_id] = dir_updates_flushed + 1;
 
         cf_ptr = partition->cf_;
+        op_partition = partition;
 
         // Complain about suspicious writes.
         if (write->getType() != WriteType::PUT ||
@@ -3206,6 +3227,10 @@ int PartitionedRocksDBStore::writeMultiImpl(
     if (!skip_op) {
       writes.push_back(write);
       cf_ptrs.push_back(cf_ptr);
+      if (track_ingest) {
+        ingest_flags.push_back(ingest_op);
+        write_partitions.push_back(std::move(op_partition));
+      }
     }
   }
 
@@ -3213,6 +3238,14 @@ int PartitionedRocksDBStore::writeMultiImpl(
   ld_check_eq(*min_target_partition_est, min_target_partition->id_);
   ld_check(!min_target_partition->is_dropped);
 
+  // Rebuilding writes to add to ingest buffers, by partition.
+  std::vector<std::pair<PartitionPtr, std::vector<const WriteOp*>>>
+      ingest_groups;
+  if (track_ingest) {
+    splitIngestWrites(
+        writes, cf_ptrs, ingest_flags, write_partitions, ingest_groups);
+  }
+
   // Go over all holders and mark beginning of write on the partition.
   std::vector<rocksdb::ColumnFamilyHandle*> cf_handles;
   cf_handles.reserve(cf_ptrs.size());
@@ -3224,7 +3257,6 @@ int PartitionedRocksDBStore::writeMultiImpl(
       cf_handles.push_back(nullptr);
     }
   }
-
   // Actually write the records to rocksdb.
   int rv = writer_->writeMulti(writes,
                                options,
@@ -3251,6 +3283,34 @@ int PartitionedRocksDBStore::writeMultiImpl(
     cf_ptr->endWrite(metadata_cf_flush_token);
   }
 
+  // Buffer the rebuilding writes to ingest. This is done with the log locks
+  // held, so that the next writes of these logs see them in the buffers.
+  // This only copies the writes; they are ingested by ingestBufferedWrites()
+  // on a storage thread, which also holds back their acknowledgements.
+  for (auto& group : ingest_groups) {
+    Partition& partition = *group.first;
+    std::vector<rocksdb::ColumnFamilyHandle*> handles(
+        group.second.size(), partition.cf_->get());
+    rocksdb::WriteBatch batch;
+    RocksDBWriter::BatchStats batch_stats;
+    rv = writer_->addToBatches(group.second,
+                               metadata_cf_->get(),
+                               &handles,
+                               batch,
+                               batch,
+                               &batch_stats,
+                               /*skip_checksum_verification=*/true);
+    if (rv != 0) {
+      ld_check_in(err, ({E::INTERNAL, E::LOCAL_LOG_STORE_WRITE}));
+      return -1;
+    }
+    rv = addToIngestBuffer(partition, batch, group.second);
+    if (rv != 0) {
+      return -1;
+    }
+    writer_->noteBatchesWritten(batch_stats);
+  }
+
   // The rest of this method updates dirty state.
 
   // Unlock LogState::mutex'es, we don't need them anymore.
@@ -3287,6 +3347,11 @@ int PartitionedRocksDBStore::writeMultiImpl(
       }
 
       auto flush_token = cur_partition->cf_->getMostRecentMemtableFlushToken();
+      if (op->write_op->ingestToken() != FlushToken_INVALID) {
+        // The record is durable once ingested, but its directory entry is
+        // in the metadata memtable, which no data memtable depends on.
+        flush_token = std::max(flush_token, metadata_cf_flush_token);
+      }
 
       // Mark the flush token on which the writers should depend to check
       // whether data is retired.
@@ -3495,6 +3560,358 @@ int PartitionedRocksDBStore::writeMultiImpl(
   return 0;
 }
 
+void PartitionedRocksDBStore::splitIngestWrites(
+    std::vector<const WriteOp*>& writes,
+    std::vector<RocksDBCFPtr>& cf_ptrs,
+    const std::vector<bool>& ingest_flags,
+    const std::vector<PartitionPtr>& write_partitions,
+    std::vector<std::pair<PartitionPtr, std::vector<const WriteOp*>>>&
+        ingest_groups) {
+  ld_check_eq(ingest_flags.size(), writes.size());
+  ld_check_eq(write_partitions.size(), writes.size());
+
+  // Partition, log and index of the writes that have a partition, sorted so
+  // that the writes of a log to a partition are adjacent.
+  std::vector<std::tuple<Partition*, logid_t, size_t>> partition_logs;
+  for (size_t i = 0; i < writes.size(); ++i) {
+    if (write_partitions[i] != nullptr) {
+      partition_logs.emplace_back(
+          write_partitions[i].get(),
+          static_cast<const RecordWriteOp*>(writes[i])->log_id,
+          i);
+    }
+  }
+  std::sort(partition_logs.begin(), partition_logs.end());
+
+  std::vector<bool> buffer_write(writes.size(), false);
+  for (auto it = partition_logs.begin(); it != partition_logs.end();) {
+    Partition& partition = *std::get<0>(*it);
+    logid_t log = std::get<1>(*it);
+    auto end = std::find_if(it, partition_logs.end(), [&](const auto& t) {
+      return std::get<0>(t) != &partition || std::get<1>(t) != log;
+    });
+    bool buffer = std::all_of(
+        it, end, [&](const auto& t) { return ingest_flags[std::get<2>(t)]; });
+    if (!buffer) {
+      std::lock_guard<std::mutex> lock(partition.ingest_mutex_);
+      for (const auto& ingest_buffer : partition.ingest_buffers_) {
+        if (ingest_buffer.logs.count(log)) {
+          buffer = true;
+          break;
+        }
+      }
+    }
+    for (; it != end; ++it) {
+      buffer_write[std::get<2>(*it)] = buffer;
+    }
+  }
+
+  size_t num_memtable_writes = 0;
+  for (size_t i = 0; i < writes.size(); ++i) {
+    if (!buffer_write[i]) {
+      if (num_memtable_writes != i) {
+        writes[num_memtable_writes] = writes[i];
+        cf_ptrs[num_memtable_writes] = std::move(cf_ptrs[i]);
+      }
+      ++num_memtable_writes;
+      continue;
+    }
+    const PartitionPtr& partition = write_partitions[i];
+    auto group = std::find_if(
+        ingest_groups.begin(), ingest_groups.end(), [&](const auto& g) {
+          return g.first == partition;
+        });
+    if (group == ingest_groups.end()) {
+      ingest_groups.emplace_back(partition, std::vector<const WriteOp*>());
+      group = std::prev(ingest_groups.end());
+    }
+    group->second.push_back(writes[i]);
+  }
+  writes.resize(num_memtable_writes);
+  cf_ptrs.resize(num_memtable_writes);
+}
+
+int PartitionedRocksDBStore::addToIngestBuffer(
+    Partition& partition,
+    const rocksdb::WriteBatch& batch,
+    const std::vector<const WriteOp*>& writes) {
+  using Op = Partition::IngestBuffer::Op;
+
+  // Collects the entries of a batch. RocksDBWriter writes records and their
+  // index entries as puts and merges, and deletes records with deletes.
+  class EntryCollector : public rocksdb::WriteBatch::Handler {
+   public:
+    struct Entry {
+      // Point into the batch.
+      rocksdb::Slice key;
+      rocksdb::Slice value;
+      Op op;
+    };
+
+    rocksdb::Status PutCF(uint32_t /* cf_id */,
+                          const rocksdb::Slice& key,
+                          const rocksdb::Slice& value) override {
+      entries.push_back({key, value, Op::PUT});
+      return rocksdb::Status::OK();
+    }
+    rocksdb::Status MergeCF(uint32_t /* cf_id */,
+                            const rocksdb::Slice& key,
+                            const rocksdb::Slice& value) override {
+      entries.push_back({key, value, Op::MERGE});
+      return rocksdb::Status::OK();
+    }
+    rocksdb::Status DeleteCF(uint32_t /* cf_id */,
+                             const rocksdb::Slice& key) override {
+      entries.push_back({key, rocksdb::Slice(), Op::DELETE});
+      return rocksdb::Status::OK();
+    }
+
+    std::vector<Entry> entries;
+  };
+
+  EntryCollector collector;
+  rocksdb::Status status = batch.Iterate(&collector);
+  if (!status.ok()) {
+    ld_check(false);
+    err = E::INTERNAL;
+    return -1;
+  }
+
+  const size_t max_bytes = getRebuildingSettings()->ingest_sst_buffer_size;
+  std::lock_guard<std::mutex> lock(partition.ingest_mutex_);
+  auto& buffers = partition.ingest_buffers_;
+  // The last buffer that the logs of `writes` were added to.
+  const Partition::IngestBuffer* buffer_with_logs = nullptr;
+  for (const auto& entry : collector.entries) {
+    std::string key = entry.key.ToString();
+    if (!buffers.empty() && !buffers.back().sealed &&
+        entry.op == Op::MERGE && buffers.back().entries.count(key)) {
+      // Merging into a buffered value would need the merge operator. Let
+      // the merge be applied on top of the ingested file instead.
+      buffers.back().sealed = true;
+    }
+    if (buffers.empty() || buffers.back().sealed) {
+      buffers.emplace_back();
+      buffers.back().token = allocateIngestToken();
+      buffers.back().first_write_time = currentSteadyTime();
+    }
+    auto& buffer = buffers.back();
+    size_t bytes = key.size() + entry.value.size();
+    auto it = buffer.entries.find(key);
+    if (it != buffer.entries.end()) {
+      // A put or delete of a buffered key. Only the last write counts.
+      ld_check(entry.op != Op::MERGE);
+      size_t old_bytes = it->first.size() + it->second.value.size();
+      buffer.bytes -= old_bytes;
+      ingest_buffered_bytes_.fetch_sub(old_bytes);
+      it->second = Partition::IngestBuffer::Value{
+          entry.value.ToString(), entry.op};
+    } else {
+      buffer.entries.emplace(
+          std::move(key),
+          Partition::IngestBuffer::Value{entry.value.ToString(), entry.op});
+    }
+    buffer.bytes += bytes;
+    ingest_buffered_bytes_.fetch_add(bytes);
+    if (&buffer != buffer_with_logs) {
+      for (const WriteOp* write : writes) {
+        buffer.logs.insert(static_cast<const RecordWriteOp*>(write)->log_id);
+      }
+      buffer_with_logs = &buffer;
+    }
+    if (buffer.bytes >= max_bytes) {
+      buffer.sealed = true;
+    }
+  }
+
+  if (buffer_with_logs != nullptr) {
+    // Buffers are ingested in order, so the writes are ingested once the
+    // last buffer they went to is.
+    for (const WriteOp* write : writes) {
+      write->setIngestToken(buffer_with_logs->token);
+    }
+  }
+  return 0;
+}
+
+int PartitionedRocksDBStore::ingestBufferedWrites(bool all) {
+  std::lock_guard<std::mutex> run_lock(ingest_run_mutex_);
+  if (ingest_buffered_bytes_.load() == 0) {
+    return 0;
+  }
+  const auto max_delay = getRebuildingSettings()->ingest_sst_max_delay;
+
+  auto partitions = getPartitionList();
+  for (PartitionPtr partition : *partitions) {
+    // Keeps the partition from being dropped while its buffer is ingested.
+    folly::SharedMutex::ReadHolder partition_lock(partition->mutex_);
+    if (partition->is_dropped) {
+      continue;
+    }
+    while (true) {
+      const Partition::IngestBuffer* buffer;
+      {
+        std::lock_guard<std::mutex> lock(partition->ingest_mutex_);
+        if (partition->ingest_buffers_.empty()) {
+          break;
+        }
+        auto& front = partition->ingest_buffers_.front();
+        if (!all && !front.sealed &&
+            currentSteadyTime() - front.first_write_time < max_delay) {
+          break;
+        }
+        front.sealed = true;
+        buffer = &front;
+      }
+
+      if (!ingestBuffer(*partition, *buffer)) {
+        err = E::LOCAL_LOG_STORE_WRITE;
+        return -1;
+      }
+
+      FlushToken token = buffer->token;
+      ingest_buffered_bytes_.fetch_sub(buffer->bytes);
+      {
+        std::lock_guard<std::mutex> lock(partition->ingest_mutex_);
+        ld_check(&partition->ingest_buffers_.front() == buffer);
+        partition->ingest_buffers_.pop_front();
+      }
+      releaseIngestToken(token);
+    }
+  }
+  return 0;
+}
+
+FlushToken PartitionedRocksDBStore::ingestedUpThrough() const {
+  std::lock_guard<std::mutex> lock(ingest_tokens_mutex_);
+  if (pending_ingest_tokens_.empty()) {
+    return FlushToken_MAX;
+  }
+  return *pending_ingest_tokens_.begin() - 1;
+}
+
+bool PartitionedRocksDBStore::ingestBuffer(
+    Partition& partition,
+    const Partition::IngestBuffer& buffer) {
+  using Op = Partition::IngestBuffer::Op;
+  ld_check(buffer.sealed);
+  ld_check(!buffer.entries.empty());
+  rocksdb::ColumnFamilyHandle* cf = partition.cf_->get();
+  SCOPED_IO_TRACING_CONTEXT(
+      getIOTracing(), "ingest-rebuilding:{}", partition.id_);
+
+  bool ingested = false;
+  folly::Optional<std::string> db_path = getLocalDBPath();
+  if (db_path.hasValue()) {
+    rocksdb::Env* env = getDB().GetEnv();
+    const std::string dir = db_path.value() + "/rebuilding_ingest";
+    const std::string path =
+        folly::sformat("{}/{}.sst", dir, next_ingest_file_id_++);
+    rocksdb::Status status = env->CreateDirIfMissing(dir);
+    if (status.ok()) {
+      rocksdb::SstFileWriter writer(
+          rocksdb::EnvOptions(), getDB().GetOptions(cf), cf);
+      status = writer.Open(path);
+      for (auto it = buffer.entries.begin();
+           status.ok() && it != buffer.entries.end();
+           ++it) {
+        switch (it->second.op) {
+          case Op::PUT:
+            status = writer.Put(it->first, it->second.value);
+            break;
+          case Op::MERGE:
+            status = writer.Merge(it->first, it->second.value);
+            break;
+          case Op::DELETE:
+            status = writer.Delete(it->first);
+            break;
+        }
+      }
+      if (status.ok()) {
+        status = writer.Finish();
+      }
+    }
+    if (status.ok()) {
+      rocksdb::IngestExternalFileOptions options;
+      options.move_files = true;
+      // The partition's memtable may have keys in the range of the file,
+      // e.g. if the partition also gets appends. Flush it in that case.
+      // This only stalls the ingesting thread.
+      options.allow_blocking_flush = true;
+      status = getDB().IngestExternalFile(cf, {path}, options);
+    }
+    if (status.ok()) {
+      ingested = true;
+    } else {
+      RATELIMIT_INFO(std::chrono::seconds(10),
+                     2,
+                     "Failed to ingest rebuilt records of partition s%u:%lu, "
+                     "will write them through the memtable: %s",
+                     getShardIdx(),
+                     partition.id_,
+                     status.ToString().c_str());
+      env->DeleteFile(path);
+    }
+  }
+
+  if (!ingested) {
+    STAT_INCR(stats_, logsdb_rebuilding_ingest_fallbacks);
+    rocksdb::WriteBatch batch;
+    for (const auto& kv : buffer.entries) {
+      switch (kv.second.op) {
+        case Op::PUT:
+          batch.Put(cf, kv.first, kv.second.value);
+          break;
+        case Op::MERGE:
+          batch.Merge(cf, kv.first, kv.second.value);
+          break;
+        case Op::DELETE:
+          batch.Delete(cf, kv.first);
+          break;
+      }
+    }
+    rocksdb::WriteOptions options;
+    options.disableWAL = true;
+    if (!writeBatch(options, &batch).ok() ||
+        !flushMemtable(partition.cf_, /* wait */ true)) {
+      RATELIMIT_ERROR(std::chrono::seconds(10),
+                      2,
+                      "Failed to write buffered rebuilt records of partition "
+                      "s%u:%lu",
+                      getShardIdx(),
+                      partition.id_);
+      return false;
+    }
+  } else {
+    STAT_INCR(stats_, logsdb_rebuilding_ingested_files);
+    STAT_ADD(stats_, logsdb_rebuilding_ingested_keys, buffer.entries.size());
+    STAT_ADD(stats_, logsdb_rebuilding_ingested_bytes, buffer.bytes);
+  }
+  return true;
+}
+
+FlushToken PartitionedRocksDBStore::allocateIngestToken() {
+  std::lock_guard<std::mutex> lock(ingest_tokens_mutex_);
+  FlushToken token = next_ingest_token_++;
+  pending_ingest_tokens_.insert(token);
+  return token;
+}
+
+void PartitionedRocksDBStore::releaseIngestToken(FlushToken token) {
+  std::lock_guard<std::mutex> lock(ingest_tokens_mutex_);
+  size_t erased = pending_ingest_tokens_.erase(token);
+  ld_check_eq(erased, 1);
+}
+
+void PartitionedRocksDBStore::discardIngestBuffers(Partition& partition) {
+  std::lock_guard<std::mutex> lock(partition.ingest_mutex_);
+  for (const auto& buffer : partition.ingest_buffers_) {
+    ingest_buffered_bytes_.fetch_sub(buffer.bytes);
+    releaseIngestToken(buffer.token);
+  }
+  partition.ingest_buffers_.clear();
+}
+
 int PartitionedRocksDBStore::writeStoreMetadata(
     const StoreMetadata& metadata,
     const WriteOptions& write_options) {
@@ -3664,6 +4081,8 @@ int PartitionedRocksDBStore::dropPartitions(
 
   for (auto partition : partitions) {
     partition->is_dropped = true;
+    // Buffered rebuilt records would be dropped with the partition anyway.
+    discardIngestBuffers(*partition);
   }
 
   // 4a) Remove obsolete metadata. It's slightly better to do this before
@@ -5989,6 +6408,9 @@ int PartitionedRocksDBStore::flushUnpartitionedMemtables(bool wait) {
 }
 
 int PartitionedRocksDBStore::flushAllMemtables(bool wait) {
+  if (ingestBufferedWrites(/* all */ true) != 0) {
+    return -1;
+  }
   if (latest_.get()) {
     auto partitions = getPartitionList();
     for (PartitionPtr partition : *partitions) {
@@ -12,8 +12,12 @@
 #include <chrono>
 #include <deque>
 #include <limits>
+#include <map>
 #include <mutex>
+#include <set>
+#include <string>
 #include <thread>
+#include <unordered_set>
 #include <vector>
 
 #include <folly/IntrusiveList.h>
@@ -292,6 +296,36 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
     // write-copyset-index setting.
     bool is_csi_enabled_{false};
 
+    // Writes waiting to be ingested into cf_ as an SST file, if
+    // --rebuilding-ingest-sst is set. See addToIngestBuffer().
+    struct IngestBuffer {
+      enum class Op { PUT, MERGE, DELETE };
+      struct Value {
+        std::string value;
+        Op op;
+      };
+      // Sorted by key, like the SST file. An SST file can't have the same
+      // key twice: a put or delete replaces the buffered value, and a merge
+      // goes to a new buffer.
+      std::map<std::string, Value> entries;
+      // Logs that have writes in `entries`.
+      std::unordered_set<logid_t> logs;
+      size_t bytes = 0;
+      // Writes added to the buffer report it as their ingest token.
+      FlushToken token = FlushToken_INVALID;
+      SteadyTimestamp first_write_time{SteadyTimestamp::max()};
+      // No writes are added to a sealed buffer. A buffer is sealed when it's
+      // full or ingestBufferedWrites() starts ingesting it.
+      bool sealed = false;
+    };
+    // Protects ingest_buffers_. Locked after mutex_ if both are locked.
+    std::mutex ingest_mutex_;
+    // Oldest first; only the last buffer may be unsealed. Buffers are
+    // removed only by ingestBufferedWrites() and when the partition is
+    // dropped, which hold mutex_ shared and exclusively, respectively, so a
+    // sealed buffer can be read without ingest_mutex_ while holding mutex_.
+    std::deque<IngestBuffer> ingest_buffers_;
+
     Partition(partition_id_t id,
               RocksDBCFPtr cf,
               RecordTimestamp starting_timestamp,
@@ -440,6 +474,12 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
   int writeMulti(const std::vector<const WriteOp*>& writes,
                  const WriteOptions& write_options) override;
 
+  // Ingests the ingest buffers of rebuilt records (--rebuilding-ingest-sst)
+  // that are sealed or older than --rebuilding-ingest-sst-max-delay.
+  int ingestBufferedWrites(bool all) override;
+
+  FlushToken ingestedUpThrough() const override;
+
   int writeStoreMetadata(const StoreMetadata& metadata,
                          const WriteOptions& write_options) override;
 
@@ -1447,6 +1487,45 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
                      partition_id_t* min_target_partition    // in and out
   );
 
+  // Part of writeMultiImpl() with --rebuilding-ingest-sst. Moves the writes
+  // to buffer for ingestion from `writes` and `cf_ptrs` to `ingest_groups`,
+  // grouped by partition. Writes of a log to a partition must not be
+  // reordered, so they are either all buffered or all written through the
+  // memtable: they are buffered if the partition's ingest buffers already
+  // have writes of the log, or else if all of them are flagged in
+  // `ingest_flags`.
+  void splitIngestWrites(
+      std::vector<const WriteOp*>& writes,
+      std::vector<RocksDBCFPtr>& cf_ptrs,
+      const std::vector<bool>& ingest_flags,
+      const std::vector<PartitionPtr>& write_partitions,
+      std::vector<std::pair<PartitionPtr, std::vector<const WriteOp*>>>&
+          ingest_groups);
+
+  // Adds `batch`, the serialized writes `writes` to `partition`, to the
+  // partition's ingest buffers (--rebuilding-ingest-sst) and sets the ingest
+  // tokens of the writes. Never blocks on IO: the buffers are ingested by
+  // ingestBufferedWrites(). Returns 0, or -1 with err set if `batch` is
+  // malformed.
+  int addToIngestBuffer(Partition& partition,
+                        const rocksdb::WriteBatch& batch,
+                        const std::vector<const WriteOp*>& writes);
+
+  // Ingests a sealed ingest buffer of `partition` as an SST file or, if
+  // that fails, writes it through the memtable and flushes the memtable.
+  // Called with partition.mutex_ locked shared. Returns false if the
+  // writes couldn't be written; they stay in the buffer in that case.
+  bool ingestBuffer(Partition& partition,
+                    const Partition::IngestBuffer& buffer);
+
+  // Allocates the token of a new ingest buffer and marks it as pending until
+  // releaseIngestToken() is called with it.
+  FlushToken allocateIngestToken();
+  void releaseIngestToken(FlushToken token);
+
+  // Throws away the ingest buffers of a partition that is being dropped.
+  void discardIngestBuffers(Partition& partition);
+
   // Returns an iterator over the metadata column family.
   RocksDBIterator createMetadataIterator(bool allow_blocking_io = true) const;
 
@@ -1765,6 +1844,21 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
   // bytes written since last flush evaluation
   std::atomic<uint64_t> bytes_written_since_flush_eval_{0};
 
+  // Used for naming the SST files built by ingestBuffer().
+  std::atomic<uint64_t> next_ingest_file_id_{0};
+
+  // Total size of the partitions' ingest buffers.
+  std::atomic<size_t> ingest_buffered_bytes_{0};
+
+  // Serializes ingestBufferedWrites() calls.
+  std::mutex ingest_run_mutex_;
+
+  // Protects next_ingest_token_ and pending_ingest_tokens_.
+  mutable std::mutex ingest_tokens_mutex_;
+  FlushToken next_ingest_token_{FlushToken_MIN};
+  // Tokens of the ingest buffers that are neither ingested nor discarded.
+  std::set<FlushToken> pending_ingest_tokens_;
+
   // Protects last_flush_eval_stats_ and calls to throttleIOIfNeeded().
   // Can be locked on write path, so don't do anything slow while holding it.
   std::mutex throttle_eval_mutex_;
@@ -74,7 +74,8 @@ void RocksDBEnv::bgJobRun(void* arg) {
   thread_state.running_a_job = false;
 
   // Clean up after RocksDBListener.
-  thread_state.io_tracing_context.clear();
+  thread_state.io_tracing_context.text.clear();
+  thread_state.io_tracing_context.type.clear();
 }
 
 void RocksDBEnv::bgJobUnschedule(void* arg) {
@@ -82,7 +83,8 @@ void RocksDBEnv::bgJobUnschedule(void* arg) {
   (*job->unschedFunction)(job->arg);
 }
 
-IOTracing::AddContext* RocksDBEnv::backgroundJobContextOfThisThread() {
+RocksDBEnv::BackgroundJobContext*
+RocksDBEnv::backgroundJobContextOfThisThread() {
   // There are two cases to distinguish: we're called from rocksdb bg thread
   // inside a job, or we're called from logdevice thread.
 
@@ -125,12 +127,13 @@ RocksDBEnv::WritableFileOpImpl(WritableFileOp op,
   auto tracing = tracingInfoForPath(f);
   std::unique_ptr<rocksdb::WritableFile> file;
   {
-    SCOPED_IO_TRACED_OP(tracing.io_tracing,
-                        "wf:{}{}{}|{}",
-                        old_fname,
-                        old_fname.empty() ? "" : "->",
-                        tracing.filename,
-                        op_name);
+    SCOPED_IO_TRACED_OP_WITH_INFO(tracing.io_tracing,
+                                  tracing.opInfo(IOTraceOp::OPEN),
+                                  "wf:{}{}{}|{}",
+                                  old_fname,
+                                  old_fname.empty() ? "" : "->",
+                                  tracing.filename,
+                                  op_name);
     rocksdb::Status status;
     switch (op) {
       case WritableFileOp::NEW:
@@ -248,8 +251,10 @@ RocksDBEnv::NewSequentialFile(const std::string& f,
   auto tracing = tracingInfoForPath(f);
   std::unique_ptr<rocksdb::SequentialFile> file;
   {
-    SCOPED_IO_TRACED_OP(
-        tracing.io_tracing, "sf:{}|NewSequentialFile", tracing.filename);
+    SCOPED_IO_TRACED_OP_WITH_INFO(tracing.io_tracing,
+                                  tracing.opInfo(IOTraceOp::OPEN),
+                                  "sf:{}|NewSequentialFile",
+                                  tracing.filename);
     auto status = rocksdb::EnvWrapper::NewSequentialFile(f, &file, options);
     if (!status.ok()) {
       SCOPED_IO_TRACING_CONTEXT(tracing.io_tracing, "failed");
@@ -266,8 +271,10 @@ RocksDBEnv::NewRandomAccessFile(const std::string& f,
   auto tracing = tracingInfoForPath(f);
   std::unique_ptr<rocksdb::RandomAccessFile> file;
   {
-    SCOPED_IO_TRACED_OP(
-        tracing.io_tracing, "rf:{}|NewRandomAccessFile", tracing.filename);
+    SCOPED_IO_TRACED_OP_WITH_INFO(tracing.io_tracing,
+                                  tracing.opInfo(IOTraceOp::OPEN),
+                                  "rf:{}|NewRandomAccessFile",
+                                  tracing.filename);
     auto status = rocksdb::EnvWrapper::NewRandomAccessFile(f, &file, options);
     if (!status.ok()) {
       SCOPED_IO_TRACING_CONTEXT(tracing.io_tracing, "failed");
@@ -282,10 +289,13 @@ rocksdb::Status
 RocksDBEnv::NewDirectory(const std::string& f,
                          std::unique_ptr<rocksdb::Directory>* r) {
   auto tracing = tracingInfoForPath(f);
+  tracing.file.type = IOTraceFileType::DIRECTORY;
   std::unique_ptr<rocksdb::Directory> dir;
   {
-    SCOPED_IO_TRACED_OP(
-        tracing.io_tracing, "d:{}|NewDirectory", tracing.filename);
+    SCOPED_IO_TRACED_OP_WITH_INFO(tracing.io_tracing,
+                                  tracing.opInfo(IOTraceOp::OPEN),
+                                  "d:{}|NewDirectory",
+                                  tracing.filename);
     auto status = rocksdb::EnvWrapper::NewDirectory(f, &dir);
     if (!status.ok()) {
       SCOPED_IO_TRACING_CONTEXT(tracing.io_tracing, "failed");
@@ -338,8 +348,10 @@ rocksdb::Status RocksDBEnv::DeleteFile(const std::string& f) {
 
   {
     auto tracing = tracingInfoForPath(f);
-    SCOPED_IO_TRACED_OP(
-        tracing.io_tracing, "f:{}|DeleteFile", tracing.filename);
+    SCOPED_IO_TRACED_OP_WITH_INFO(tracing.io_tracing,
+                                  tracing.opInfo(IOTraceOp::DELETE),
+                                  "f:{}|DeleteFile",
+                                  tracing.filename);
     status = rocksdb::EnvWrapper::DeleteFile(f);
   }
 
@@ -365,8 +377,11 @@ rocksdb::Status RocksDBEnv::DeleteFile(const std::string& f) {
 }
 rocksdb::Status RocksDBEnv::Truncate(const std::string& f, size_t size) {
   auto tracing = tracingInfoForPath(f);
-  SCOPED_IO_TRACED_OP(
-      tracing.io_tracing, "f:{}|Truncate|sz:{}", tracing.filename, size);
+  SCOPED_IO_TRACED_OP_WITH_INFO(tracing.io_tracing,
+                                tracing.opInfo(IOTraceOp::TRUNCATE, 0, size),
+                                "f:{}|Truncate|sz:{}",
+                                tracing.filename,
+                                size);
   return rocksdb::EnvWrapper::Truncate(f, size);
 }
 rocksdb::Status RocksDBEnv::GetFileSize(const std::string& f,
@@ -386,10 +401,11 @@ rocksdb::Status RocksDBEnv::RenameFile(const std::string& src,
                                        const std::string& target) {
   auto tracing_src = tracingInfoForPath(src);
   auto tracing = tracingInfoForPath(target);
-  SCOPED_IO_TRACED_OP(tracing.io_tracing,
-                      "f:{}->{}|RenameFile",
-                      tracing_src.filename,
-                      tracing.filename);
+  SCOPED_IO_TRACED_OP_WITH_INFO(tracing.io_tracing,
+                                tracing.opInfo(IOTraceOp::RENAME),
+                                "f:{}->{}|RenameFile",
+                                tracing_src.filename,
+                                tracing.filename);
   return rocksdb::EnvWrapper::RenameFile(src, target);
 }
 
@@ -400,14 +416,20 @@ RocksDBSequentialFile::RocksDBSequentialFile(
       file_(std::move(file)),
       tracing_(tracing) {}
 RocksDBSequentialFile::~RocksDBSequentialFile() {
-  SCOPED_IO_TRACED_OP(tracing_.io_tracing, "sf:{}|close", tracing_.filename);
+  SCOPED_IO_TRACED_OP_WITH_INFO(tracing_.io_tracing,
+                                tracing_.opInfo(IOTraceOp::CLOSE),
+                                "sf:{}|close",
+                                tracing_.filename);
   file_.reset();
 }
 rocksdb::Status RocksDBSequentialFile::Read(size_t n,
                                             rocksdb::Slice* result,
                                             char* scratch) {
-  SCOPED_IO_TRACED_OP(
-      tracing_.io_tracing, "sf:{}|Read|sz:{}", tracing_.filename, n);
+  SCOPED_IO_TRACED_OP_WITH_INFO(tracing_.io_tracing,
+                                tracing_.opInfo(IOTraceOp::READ, 0, n),
+                                "sf:{}|Read|sz:{}",
+                                tracing_.filename,
+                                n);
   return rocksdb::SequentialFileWrapper::Read(n, result, scratch);
 }
 rocksdb::Status RocksDBSequentialFile::Skip(uint64_t n) {
@@ -419,11 +441,12 @@ rocksdb::Status RocksDBSequentialFile::PositionedRead(uint64_t offset,
                                                       size_t n,
                                                       rocksdb::Slice* result,
                                                       char* scratch) {
-  SCOPED_IO_TRACED_OP(tracing_.io_tracing,
-                      "sf:{}|PositionedRead|off:{}|sz:{}",
-                      tracing_.filename,
-                      offset,
-                      n);
+  SCOPED_IO_TRACED_OP_WITH_INFO(tracing_.io_tracing,
+                                tracing_.opInfo(IOTraceOp::READ, offset, n),
+                                "sf:{}|PositionedRead|off:{}|sz:{}",
+                                tracing_.filename,
+                                offset,
+                                n);
   return rocksdb::SequentialFileWrapper::PositionedRead(
       offset, n, result, scratch);
 }
@@ -437,18 +460,22 @@ RocksDBRandomAccessFile::RocksDBRandomAccessFile(
       tracing_(tracing),
       settings_(settings) {}
 RocksDBRandomAccessFile::~RocksDBRandomAccessFile() {
-  SCOPED_IO_TRACED_OP(tracing_.io_tracing, "rf:{}|close", tracing_.filename);
+  SCOPED_IO_TRACED_OP_WITH_INFO(tracing_.io_tracing,
+                                tracing_.opInfo(IOTraceOp::CLOSE),
+                                "rf:{}|close",
+                                tracing_.filename);
   file_.reset();
 }
 rocksdb::Status RocksDBRandomAccessFile::Read(uint64_t offset,
                                               size_t n,
                                               rocksdb::Slice* result,
                                               char* scratch) const {
-  SCOPED_IO_TRACED_OP(tracing_.io_tracing,
-                      "rf:{}|Read|off:{}|sz:{}",
-                      tracing_.filename,
-                      offset,
-                      n);
+  SCOPED_IO_TRACED_OP_WITH_INFO(tracing_.io_tracing,
+                                tracing_.opInfo(IOTraceOp::READ, offset, n),
+                                "rf:{}|Read|off:{}|sz:{}",
+                                tracing_.filename,
+                                offset,
+                                n);
   while (UNLIKELY(settings_->test_stall_sst_reads) &&
          boost::ends_with(tracing_.filename, ".sst")) {
     // Re-check the setting every 100ms.
@@ -457,11 +484,13 @@ rocksdb::Status RocksDBRandomAccessFile::Read(uint64_t offset,
   return rocksdb::RandomAccessFileWrapper::Read(offset, n, result, scratch);
 }
 rocksdb::Status RocksDBRandomAccessFile::Prefetch(uint64_t offset, size_t n) {
-  SCOPED_IO_TRACED_OP(tracing_.io_tracing,
-                      "rf:{}|Prefetch|off:{}|sz:{}",
-                      tracing_.filename,
-                      offset,
-                      n);
+  SCOPED_IO_TRACED_OP_WITH_INFO(
+      tracing_.io_tracing,
+      tracing_.opInfo(IOTraceOp::PREFETCH, offset, n),
+      "rf:{}|Prefetch|off:{}|sz:{}",
+      tracing_.filename,
+      offset,
+      n);
   return rocksdb::RandomAccessFileWrapper::Prefetch(offset, n);
 }
 size_t RocksDBRandomAccessFile::GetUniqueId(char* id, size_t max_size) const {
@@ -478,11 +507,13 @@ void RocksDBRandomAccessFile::Hint(AccessPattern pattern) {
 }
 rocksdb::Status RocksDBRandomAccessFile::InvalidateCache(size_t offset,
                                                          size_t length) {
-  SCOPED_IO_TRACED_OP(tracing_.io_tracing,
-                      "rf:{}|InvalidateCache|off:{}|sz:{}",
-                      tracing_.filename,
-                      offset,
-                      length);
+  SCOPED_IO_TRACED_OP_WITH_INFO(
+      tracing_.io_tracing,
+      tracing_.opInfo(IOTraceOp::INVALIDATE_CACHE, offset, length),
+      "rf:{}|InvalidateCache|off:{}|sz:{}",
+      tracing_.filename,
+      offset,
+      length);
   return rocksdb::RandomAccessFileWrapper::InvalidateCache(offset, length);
 }
 
@@ -492,11 +523,17 @@ RocksDBDirectory::RocksDBDirectory(std::unique_ptr<rocksdb::Directory> dir,
       dir_(std::move(dir)),
       tracing_(tracing) {}
 RocksDBDirectory::~RocksDBDirectory() {
-  SCOPED_IO_TRACED_OP(tracing_.io_tracing, "d:{}|close", tracing_.filename);
+  SCOPED_IO_TRACED_OP_WITH_INFO(tracing_.io_tracing,
+                                tracing_.opInfo(IOTraceOp::CLOSE),
+                                "d:{}|close",
+                                tracing_.filename);
   dir_.reset();
 }
 rocksdb::Status RocksDBDirectory::Fsync() {
-  SCOPED_IO_TRACED_OP(tracing_.io_tracing, "d:{}|Fsync", tracing_.filename);
+  SCOPED_IO_TRACED_OP_WITH_INFO(tracing_.io_tracing,
+                                tracing_.opInfo(IOTraceOp::SYNC),
+                                "d:{}|Fsync",
+                                tracing_.filename);
   return rocksdb::DirectoryWrapper::Fsync();
 }
 size_t RocksDBDirectory::GetUniqueId(char* id, size_t max_size) const {
@@ -514,6 +551,7 @@ FileTracingInfo RocksDBEnv::tracingInfoForPath(const std::string& path) {
           path, &shard_idx, &info.filename) &&
       shard_idx < io_tracing_by_shard_.size()) {
     info.io_tracing = io_tracing_by_shard_[shard_idx];
+    info.file = IOTraceFile::parse(info.filename);
   } else {
     // If path is in unexpected format, leave io_tracing null.
     info.filename = path;
@@ -535,25 +573,33 @@ RocksDBWritableFile::~RocksDBWritableFile() {
 }
 
 rocksdb::Status RocksDBWritableFile::Append(const rocksdb::Slice& data) {
-  SCOPED_IO_TRACED_OP(tracing_.io_tracing,
-                      "wf:{}|Append|sz:{}",
-                      tracing_.filename,
-                      data.size());
+  SCOPED_IO_TRACED_OP_WITH_INFO(
+      tracing_.io_tracing,
+      tracing_.opInfo(IOTraceOp::WRITE, 0, data.size()),
+      "wf:{}|Append|sz:{}",
+      tracing_.filename,
+      data.size());
   return rocksdb::WritableFileWrapper::Append(data);
 }
 rocksdb::Status
 RocksDBWritableFile::PositionedAppend(const rocksdb::Slice& data,
                                       uint64_t offset) {
-  SCOPED_IO_TRACED_OP(tracing_.io_tracing,
-                      "wf:{}|PositionedAppend|off:{}|sz:{}",
-                      tracing_.filename,
-                      offset,
-                      data.size());
+  SCOPED_IO_TRACED_OP_WITH_INFO(
+      tracing_.io_tracing,
+      tracing_.opInfo(IOTraceOp::WRITE, offset, data.size()),
+      "wf:{}|PositionedAppend|off:{}|sz:{}",
+      tracing_.filename,
+      offset,
+      data.size());
   return rocksdb::WritableFileWrapper::PositionedAppend(data, offset);
 }
 rocksdb::Status RocksDBWritableFile::Truncate(uint64_t size) {
-  SCOPED_IO_TRACED_OP(
-      tracing_.io_tracing, "wf:{}|Truncate|sz:{}", tracing_.filename, size);
+  SCOPED_IO_TRACED_OP_WITH_INFO(
+      tracing_.io_tracing,
+      tracing_.opInfo(IOTraceOp::TRUNCATE, 0, size),
+      "wf:{}|Truncate|sz:{}",
+      tracing_.filename,
+      size);
   return rocksdb::WritableFileWrapper::Truncate(size);
 }
 rocksdb::Status RocksDBWritableFile::Close() {
@@ -561,7 +607,10 @@ rocksdb::Status RocksDBWritableFile::Close() {
     return rocksdb::Status::OK();
   }
   closed_ = true;
-  SCOPED_IO_TRACED_OP(tracing_.io_tracing, "wf:{}|Close", tracing_.filename);
+  SCOPED_IO_TRACED_OP_WITH_INFO(tracing_.io_tracing,
+                                tracing_.opInfo(IOTraceOp::CLOSE),
+                                "wf:{}|Close",
+                                tracing_.filename);
   return rocksdb::WritableFileWrapper::Close();
 }
 rocksdb::Status RocksDBWritableFile::Flush() {
@@ -573,7 +622,10 @@ rocksdb::Status RocksDBWritableFile::Flush() {
 }
 rocksdb::Status RocksDBWritableFile::Sync() {
   auto time_start = std::chrono::steady_clock::now();
-  SCOPED_IO_TRACED_OP(tracing_.io_tracing, "wf:{}|Sync", tracing_.filename);
+  SCOPED_IO_TRACED_OP_WITH_INFO(tracing_.io_tracing,
+                                tracing_.opInfo(IOTraceOp::SYNC),
+                                "wf:{}|Sync",
+                                tracing_.filename);
   auto s = rocksdb::WritableFileWrapper::Sync();
   auto time_end = std::chrono::steady_clock::now();
   STAT_INCR(stats_, fdatasyncs);
@@ -582,7 +634,10 @@ rocksdb::Status RocksDBWritableFile::Sync() {
 }
 rocksdb::Status RocksDBWritableFile::Fsync() {
   auto time_start = std::chrono::steady_clock::now();
-  SCOPED_IO_TRACED_OP(tracing_.io_tracing, "wf:{}|Fsync", tracing_.filename);
+  SCOPED_IO_TRACED_OP_WITH_INFO(tracing_.io_tracing,
+                                tracing_.opInfo(IOTraceOp::SYNC),
+                                "wf:{}|Fsync",
+                                tracing_.filename);
   auto s = rocksdb::WritableFileWrapper::Fsync();
   auto time_end = std::chrono::steady_clock::now();
   STAT_INCR(stats_, fsyncs);
@@ -596,28 +651,34 @@ size_t RocksDBWritableFile::GetUniqueId(char* id, size_t max_size) const {
 }
 rocksdb::Status RocksDBWritableFile::InvalidateCache(size_t offset,
                                                      size_t length) {
-  SCOPED_IO_TRACED_OP(tracing_.io_tracing,
-                      "wf:{}|InvalidateCache|off:{}|sz:{}",
-                      tracing_.filename,
-                      offset,
-                      length);
+  SCOPED_IO_TRACED_OP_WITH_INFO(
+      tracing_.io_tracing,
+      tracing_.opInfo(IOTraceOp::INVALIDATE_CACHE, offset, length),
+      "wf:{}|InvalidateCache|off:{}|sz:{}",
+      tracing_.filename,
+      offset,
+      length);
   return rocksdb::WritableFileWrapper::InvalidateCache(offset, length);
 }
 rocksdb::Status RocksDBWritableFile::RangeSync(uint64_t offset,
                                                uint64_t nbytes) {
-  SCOPED_IO_TRACED_OP(tracing_.io_tracing,
-                      "wf:{}|RangeSync|off:{}|sz:{}",
-                      tracing_.filename,
-                      offset,
-                      nbytes);
+  SCOPED_IO_TRACED_OP_WITH_INFO(
+      tracing_.io_tracing,
+      tracing_.opInfo(IOTraceOp::RANGE_SYNC, offset, nbytes),
+      "wf:{}|RangeSync|off:{}|sz:{}",
+      tracing_.filename,
+      offset,
+      nbytes);
   return rocksdb::WritableFileWrapper::RangeSync(offset, nbytes);
 }
 rocksdb::Status RocksDBWritableFile::Allocate(uint64_t offset, uint64_t len) {
-  SCOPED_IO_TRACED_OP(tracing_.io_tracing,
-                      "wf:{}|Allocate|off:{}|sz:{}",
-                      tracing_.filename,
-                      offset,
-                      len);
+  SCOPED_IO_TRACED_OP_WITH_INFO(
+      tracing_.io_tracing,
+      tracing_.opInfo(IOTraceOp::ALLOCATE, offset, len),
+      "wf:{}|Allocate|off:{}|sz:{}",
+      tracing_.filename,
+      offset,
+      len);
   return rocksdb::WritableFileWrapper::Allocate(offset, len);
 }
 
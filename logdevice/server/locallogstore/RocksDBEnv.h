@@ -32,6 +32,13 @@ class StatsHolder;
 struct FileTracingInfo {
   IOTracing* io_tracing = nullptr;
   std::string filename;
+  // `filename` parsed for binary tracing.
+  IOTraceFile file;
+
+  IOTraceOpInfo
+  opInfo(IOTraceOp op, uint64_t offset = 0, uint64_t size = 0) const {
+    return IOTraceOpInfo{op, file, offset, size};
+  }
 };
 
 /**
@@ -55,8 +62,16 @@ class RocksDBEnv : public rocksdb::EnvWrapper {
         stats_(stats),
         io_tracing_by_shard_(io_tracing_by_shard) {}
 
-  // Returns pointer to a thread-local AddContext if we're inside a job running
-  // on rocksdb background thread, nullptr otherwise.
+  // IO tracing context of a background job, see
+  // backgroundJobContextOfThisThread().
+  struct BackgroundJobContext {
+    IOTracing::AddContext text;
+    // For binary tracing.
+    IOTracing::SetContextType type;
+  };
+
+  // Returns pointer to a thread-local BackgroundJobContext if we're inside a
+  // job running on rocksdb background thread, nullptr otherwise.
   //
   // This is part of a somewhat arcane mechanism for propagating information
   // about a running flush/compaction job to the IO operations done by that job.
@@ -76,8 +91,8 @@ class RocksDBEnv : public rocksdb::EnvWrapper {
   //      anything about the job itself, it only has a function pointer.
   // So we combine the two approaches: RocksDBListener's
   // OnFlushBegin()/OnCompactionBegin() assigns a thread-local AddContext,
-  // then RocksDBEnv's job wrapper clears it.
-  IOTracing::AddContext* backgroundJobContextOfThisThread();
+  // then RocksDBEnv's job wrapper clears it. Same for SetContextType.
+  BackgroundJobContext* backgroundJobContextOfThisThread();
 
   // We wrap all background jobs to:
   //  (a) set information in ThreadID needed to identify rocksdb bg threads,
@@ -168,7 +183,7 @@ class RocksDBEnv : public rocksdb::EnvWrapper {
   struct BGThreadState {
     bool initialized = false;
     bool running_a_job = false;
-    IOTracing::AddContext io_tracing_context;
+    BackgroundJobContext io_tracing_context;
   };
 
   UpdateableSettings<RocksDBSettings> settings_;
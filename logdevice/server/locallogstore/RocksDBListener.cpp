@@ -93,19 +93,30 @@ void RocksDBListener::OnTableFileCreated(
 
 void RocksDBListener::OnFlushBegin(rocksdb::DB*,
                                    const rocksdb::FlushJobInfo& info) {
-  IOTracing::AddContext* io_tracing_context =
+  RocksDBEnv::BackgroundJobContext* io_tracing_context =
       env_->backgroundJobContextOfThisThread();
   if (io_tracing_context && io_tracing_ && io_tracing_->isEnabled()) {
-    io_tracing_context->assign(io_tracing_, "flush|cf:{}", info.cf_name);
+    io_tracing_context->text.assign(io_tracing_, "flush|cf:{}", info.cf_name);
+  }
+  if (io_tracing_context && io_tracing_ &&
+      io_tracing_->isBinaryTracingEnabled()) {
+    io_tracing_context->type.assign(
+        io_tracing_, IOTraceContext::FLUSH, info.cf_id);
   }
 }
 void RocksDBListener::OnCompactionBegin(
     rocksdb::DB*,
     const rocksdb::CompactionJobInfo& info) {
-  IOTracing::AddContext* io_tracing_context =
+  RocksDBEnv::BackgroundJobContext* io_tracing_context =
       env_->backgroundJobContextOfThisThread();
   if (io_tracing_context && io_tracing_ && io_tracing_->isEnabled()) {
-    io_tracing_context->assign(io_tracing_, "compact|cf:{}", info.cf_name);
+    io_tracing_context->text.assign(
+        io_tracing_, "compact|cf:{}", info.cf_name);
+  }
+  if (io_tracing_context && io_tracing_ &&
+      io_tracing_->isBinaryTracingEnabled()) {
+    io_tracing_context->type.assign(
+        io_tracing_, IOTraceContext::COMPACTION, info.cf_id);
   }
 }
 
@@ -334,6 +334,9 @@ class RocksDBLocalLogStore::CSIWrapper::CopySetIndexIterator
   uint32_t getCurrentWave() const;
   const std::vector<ShardID>& getCurrentCopySet() const;
   LocalLogStoreRecordFormat::csi_flags_t getCurrentFlags() const;
+  // Empty unless the entry has CSI_FLAG_FILTERABLE_KEY. Points into the
+  // rocksdb iterator, only valid until the next seek or step.
+  folly::StringPiece getCurrentFilterableKey() const;
 
   // returns the size of the copyset index entry in bytes
   size_t getCurrentEntrySize();
@@ -371,6 +374,7 @@ class RocksDBLocalLogStore::CSIWrapper::CopySetIndexIterator
   uint32_t current_single_wave_{0};
   std::vector<ShardID> current_single_copyset_;
   LocalLogStoreRecordFormat::csi_flags_t current_single_flags_{0};
+  folly::StringPiece current_single_filterable_key_;
 
   // Size of the copyset index entry (NB: not the record it represents) in
   // bytes. Used to apply disk i/o limits when reading.
@@ -697,8 +701,12 @@ bool RocksDBLocalLogStore::CSIWrapper::applyFilterToDataRecord(
 
   if (csi_it != nullptr) {
     // Check that information in CSI entry matches information in data record.
+    // The filterable key has no counterpart in record flags.
     const auto& csi_cs = csi_it->getCurrentCopySet();
-    if (converted_flags != csi_it->getCurrentFlags() ||
+    const LocalLogStoreRecordFormat::csi_flags_t csi_flags =
+        csi_it->getCurrentFlags() &
+        ~LocalLogStoreRecordFormat::CSI_FLAG_FILTERABLE_KEY;
+    if (converted_flags != csi_flags ||
         copyset_size != csi_cs.size() ||
         memcmp(csi_cs.data(), &copyset[0], copyset_size * sizeof(copyset[0])) ||
         wave != csi_it->getCurrentWave()) {
@@ -917,6 +925,18 @@ void RocksDBLocalLogStore::CSIWrapper::moveTo(const Location& target,
         stats->countFilteredCSIEntry(!current_is_filtered_out);
       }
 
+      // If the entry carries the record's filterable key, the read stream's
+      // filter may be able to reject the record without reading it.
+      if (filter && stats && !current_is_filtered_out &&
+          (flags & LocalLogStoreRecordFormat::CSI_FLAG_FILTERABLE_KEY) &&
+          !filter->shouldProcessFilterableKey(
+              current.log_id,
+              current.lsn,
+              csi_iterator_->getCurrentFilterableKey())) {
+        current_is_filtered_out = true;
+        stats->countKeyFilteredRecord(current.lsn);
+      }
+
       if (current_is_filtered_out) {
         // If a CSI entry wass filtered out, chances are that many in a row
         // will be filtered out too (usually a sticky copyset block).
@@ -1156,7 +1176,8 @@ void RocksDBLocalLogStore::CSIWrapper::CopySetIndexIterator::
           &current_single_copyset_,
           &current_single_wave_,
           &current_single_flags_,
-          parent_->store_->getShardIdx())) {
+          parent_->store_->getShardIdx(),
+          &current_single_filterable_key_)) {
     RATELIMIT_ERROR(
         std::chrono::seconds(10),
         2,
@@ -1204,6 +1225,12 @@ RocksDBLocalLogStore::CSIWrapper::CopySetIndexIterator::getCurrentFlags()
   return current_single_flags_;
 }
 
+folly::StringPiece RocksDBLocalLogStore::CSIWrapper::CopySetIndexIterator::
+    getCurrentFilterableKey() const {
+  ld_check(state() == IteratorState::AT_RECORD);
+  return current_single_filterable_key_;
+}
+
 uint32_t
 RocksDBLocalLogStore::CSIWrapper::CopySetIndexIterator::getCurrentWave() const {
   return current_single_wave_;
@@ -426,6 +426,15 @@ int RocksDBLogStoreBase::updateLogMetadata(logid_t log_id,
   return writer_->updateLogMetadata(
       log_id, metadata, write_options, getMetadataCFHandle());
 }
+
+void RocksDBLogStoreBase::updateLogMetadataBatch(
+    const std::vector<std::pair<logid_t, ComparableLogMetadata*>>& metadata,
+    std::vector<Status>& statuses_out,
+    const WriteOptions& write_options) {
+  writer_->updateLogMetadataBatch(
+      metadata, statuses_out, write_options, getMetadataCFHandle());
+}
+
 int RocksDBLogStoreBase::updatePerEpochLogMetadata(
     logid_t log_id,
     epoch_t epoch,
@@ -371,6 +371,10 @@ class RocksDBLogStoreBase : public LocalLogStore {
       logid_t log_id,
       ComparableLogMetadata& metadata,
       const WriteOptions& write_options = WriteOptions()) override;
+  void updateLogMetadataBatch(
+      const std::vector<std::pair<logid_t, ComparableLogMetadata*>>& metadata,
+      std::vector<Status>& statuses_out,
+      const WriteOptions& write_options = WriteOptions()) override;
   int updatePerEpochLogMetadata(
       logid_t log_id,
       epoch_t epoch,
@@ -1649,6 +1649,22 @@ void RocksDBSettings::defineSettings(SettingEasyInit& init) {
        SERVER,
        SettingsCategory::LogsDB);
 
+  init("rocksdb-io-trace-ring-size",
+       &io_trace_ring_size,
+       "1024",
+       nullptr,
+       "Number of binary IO trace events to keep for each thread doing IO on "
+       "a shard. Unlike the text IO tracing (see rocksdb-io-tracing-shards), "
+       "binary tracing records every IO operation of the local log store as a "
+       "small fixed-size event, and aggregates latencies into per-shard "
+       "io_latency.<context> histograms by what the IO was done for (flush, "
+       "compaction, read_stream, findtime, rebuilding etc). The events are "
+       "shown by the 'info io_traces' admin command and can be dumped to a "
+       "file with 'dump_io_traces'. Rounded up to a power of two. 0 disables "
+       "binary IO tracing.",
+       SERVER | REQUIRES_RESTART,
+       SettingsCategory::LogsDB);
+
   init("rocksdb-paranoid-checks",
        &paranoid_checks,
        "true",
@@ -386,6 +386,10 @@ class RocksDBSettings : public SettingsBundle {
 
   std::chrono::milliseconds io_tracing_stall_threshold;
 
+  // Number of binary IO trace events to keep per thread and shard, 0 to
+  // disable binary IO tracing. See IOTracing.h.
+  size_t io_trace_ring_size;
+
   // When ld manages flushes, memory limit for the node and memtable
   // within rocksdb set to a very high value. rocksdb should never be
   // able to reach those limits and initiate a flush. This limit is a
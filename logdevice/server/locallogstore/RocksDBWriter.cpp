@@ -8,6 +8,7 @@
 #include "logdevice/server/locallogstore/RocksDBWriter.h"
 
 #include <algorithm>
+#include <map>
 
 #include <folly/small_vector.h>
 #include <rocksdb/env.h>
@@ -40,6 +41,51 @@ int RocksDBWriter::writeMulti(
     rocksdb::WriteBatch& wal_batch,
     rocksdb::WriteBatch& mem_batch,
     bool skip_checksum_verification) {
+  BatchStats batch_stats;
+  int rv = addToBatches(writes,
+                        metadata_cf,
+                        data_cf_handles,
+                        wal_batch,
+                        mem_batch,
+                        &batch_stats,
+                        skip_checksum_verification);
+  if (rv != 0) {
+    return -1;
+  }
+
+  rocksdb::WriteOptions options;
+  for (auto rocksdb_batch : {&wal_batch, &mem_batch}) {
+    if (rocksdb_batch->Count() > 0) {
+      rocksdb::Status status = store_->writeBatch(options, rocksdb_batch);
+      if (!status.ok()) {
+        err = E::LOCAL_LOG_STORE_WRITE;
+        return -1;
+      }
+    }
+    options.disableWAL = true;
+  }
+  noteBatchesWritten(batch_stats);
+  return 0;
+}
+
+void RocksDBWriter::noteBatchesWritten(const BatchStats& batch_stats) {
+  StatsHolder* stats = store_->getStatsHolder();
+  STAT_ADD(stats, record_bytes_written, batch_stats.record_bytes);
+  STAT_ADD(stats, csi_bytes_written, batch_stats.csi_bytes);
+  STAT_ADD(stats, index_bytes_written, batch_stats.index_bytes);
+  STAT_ADD(stats, csi_entry_writes, batch_stats.csi_entry_writes);
+  STAT_ADD(stats, index_entry_writes, batch_stats.index_entry_writes);
+}
+
+int RocksDBWriter::addToBatches(
+    const std::vector<const WriteOp*>& writes,
+    rocksdb::ColumnFamilyHandle* metadata_cf,
+    std::vector<rocksdb::ColumnFamilyHandle*>* data_cf_handles,
+    rocksdb::WriteBatch& wal_batch,
+    rocksdb::WriteBatch& mem_batch,
+    BatchStats* batch_stats,
+    bool skip_checksum_verification) {
+  ld_check(batch_stats != nullptr);
   if (read_only_) {
     ld_check(false);
     err = E::LOCAL_LOG_STORE_WRITE;
@@ -50,16 +96,11 @@ int RocksDBWriter::writeMulti(
     return -1;
   }
 
-  size_t csi_entry_writes = 0;
-  size_t index_entry_writes = 0;
-  SCOPE_EXIT {
-    STAT_ADD(store_->getStatsHolder(), csi_entry_writes, csi_entry_writes);
-    STAT_ADD(store_->getStatsHolder(), index_entry_writes, index_entry_writes);
-  };
-
-  size_t record_bytes = 0;
-  size_t csi_bytes = 0;
-  size_t index_bytes = 0;
+  size_t& record_bytes = batch_stats->record_bytes;
+  size_t& csi_bytes = batch_stats->csi_bytes;
+  size_t& index_bytes = batch_stats->index_bytes;
+  size_t& csi_entry_writes = batch_stats->csi_entry_writes;
+  size_t& index_entry_writes = batch_stats->index_entry_writes;
 
   for (size_t i = 0; i < writes.size(); ++i) {
     const WriteOp* write = writes[i];
@@ -385,21 +426,6 @@ int RocksDBWriter::writeMulti(
     }
   }
 
-  rocksdb::WriteOptions options;
-  for (auto rocksdb_batch : {&wal_batch, &mem_batch}) {
-    if (rocksdb_batch->Count() > 0) {
-      rocksdb::Status status = store_->writeBatch(options, rocksdb_batch);
-      if (!status.ok()) {
-        err = E::LOCAL_LOG_STORE_WRITE;
-        return -1;
-      }
-    }
-    options.disableWAL = true;
-  }
-
-  STAT_ADD(store_->getStatsHolder(), record_bytes_written, record_bytes);
-  STAT_ADD(store_->getStatsHolder(), csi_bytes_written, csi_bytes);
-  STAT_ADD(store_->getStatsHolder(), index_bytes_written, index_bytes);
   return 0;
 }
 
@@ -543,6 +569,108 @@ int RocksDBWriter::updateLogMetadata(
   return 0;
 }
 
+void RocksDBWriter::updateLogMetadataBatch(
+    const std::vector<std::pair<logid_t, ComparableLogMetadata*>>& metadata,
+    std::vector<Status>& statuses_out,
+    const LocalLogStore::WriteOptions& /*write_options*/,
+    rocksdb::ColumnFamilyHandle* cf) {
+  statuses_out.assign(metadata.size(), E::LOCAL_LOG_STORE_WRITE);
+  if (read_only_) {
+    ld_check(false);
+    return;
+  }
+  if (store_->acceptingWrites() == E::DISABLED) {
+    return;
+  }
+
+  // Take the locks of all the logs, in increasing order to avoid deadlocks
+  // with other batches.
+  std::vector<size_t> stripes;
+  stripes.reserve(metadata.size());
+  for (const auto& entry : metadata) {
+    stripes.push_back(entry.first.val_ % locks_.size());
+  }
+  std::sort(stripes.begin(), stripes.end());
+  stripes.erase(std::unique(stripes.begin(), stripes.end()), stripes.end());
+  std::vector<std::unique_lock<std::mutex>> lock_guards;
+  lock_guards.reserve(stripes.size());
+  for (size_t stripe : stripes) {
+    lock_guards.emplace_back(locks_[stripe]);
+  }
+
+  rocksdb::WriteBatch batch;
+  // Entries added to the batch, by log id and type. A log may appear more
+  // than once; later entries are compared with the earlier ones, as if they
+  // were written one by one.
+  std::map<std::pair<logid_t, LogMetadataType>, size_t> pending;
+  std::vector<size_t> written;
+
+  for (size_t i = 0; i < metadata.size(); ++i) {
+    const logid_t log_id = metadata[i].first;
+    ComparableLogMetadata& meta = *metadata[i].second;
+    if (!meta.valid()) {
+      RATELIMIT_CRITICAL(std::chrono::seconds(10),
+                         10,
+                         "INTERNAL ERROR: Not writing invalid metadata %s to "
+                         "persistent log store!",
+                         meta.toString().c_str());
+      dd_assert(false, "invalid metadata");
+      continue;
+    }
+
+    auto it = pending.find(std::make_pair(log_id, meta.getType()));
+    if (it != pending.end()) {
+      ComparableLogMetadata& prev = *metadata[it->second].second;
+      if (!(prev < meta)) {
+        meta.deserialize(prev.serialize());
+        statuses_out[i] = E::UPTODATE;
+        continue;
+      }
+    } else {
+      auto p = LogMetadataFactory::create(meta.getType());
+      ld_assert(dynamic_cast<ComparableLogMetadata*>(p.get()) != nullptr);
+      ComparableLogMetadata* prev =
+          static_cast<ComparableLogMetadata*>(p.get());
+      int rv = readLogMetadata(log_id, prev, cf);
+      if (rv == 0 && !(*prev < meta)) {
+        meta.deserialize(prev->serialize());
+        statuses_out[i] = E::UPTODATE;
+        continue;
+      } else if (rv != 0 && err != E::NOTFOUND) {
+        RATELIMIT_ERROR(std::chrono::seconds(1),
+                        10,
+                        "Reading existing metadata type %d for log %lu "
+                        "failed: %s",
+                        static_cast<int>(meta.getType()),
+                        log_id.val_,
+                        error_description(err));
+        statuses_out[i] = err;
+        continue;
+      }
+    }
+
+    LogMetaKey key(meta.getType(), log_id);
+    Slice value(meta.serialize());
+    // If the log is already in the batch, this Put overrides the earlier one.
+    batch.Put(
+        cf,
+        rocksdb::Slice(reinterpret_cast<const char*>(&key), sizeof key),
+        rocksdb::Slice(reinterpret_cast<const char*>(value.data), value.size));
+    pending[std::make_pair(log_id, meta.getType())] = i;
+    written.push_back(i);
+  }
+
+  if (written.empty()) {
+    return;
+  }
+  rocksdb::Status status = store_->writeBatch(rocksdb::WriteOptions(), &batch);
+  if (status.ok()) {
+    for (size_t i : written) {
+      statuses_out[i] = E::OK;
+    }
+  }
+}
+
 int RocksDBWriter::readPreviousPerEpochLogMetadata(
     logid_t log_id,
     epoch_t epoch,
@@ -90,6 +90,30 @@ class RocksDBWriter {
                  rocksdb::WriteBatch& mem_batch,
                  bool skip_checksum_verification = false);
 
+  // Sizes of what addToBatches() added to the batches.
+  struct BatchStats {
+    size_t record_bytes = 0;
+    size_t csi_bytes = 0;
+    size_t index_bytes = 0;
+    size_t csi_entry_writes = 0;
+    size_t index_entry_writes = 0;
+  };
+
+  // Same as writeMulti() but only adds the operations to `wal_batch` and
+  // `mem_batch` without writing them to DB. The caller is responsible for
+  // writing the batches, or e.g. ingesting them as SST files, and for calling
+  // noteBatchesWritten() with `*batch_stats` once that succeeds.
+  int addToBatches(const std::vector<const WriteOp*>& writes,
+                   rocksdb::ColumnFamilyHandle* metadata_cf,
+                   std::vector<rocksdb::ColumnFamilyHandle*>* data_cf_handles,
+                   rocksdb::WriteBatch& wal_batch,
+                   rocksdb::WriteBatch& mem_batch,
+                   BatchStats* batch_stats,
+                   bool skip_checksum_verification = false);
+
+  // Bumps the stats of written bytes and index entries.
+  void noteBatchesWritten(const BatchStats& batch_stats);
+
   int readLogMetadata(logid_t log_id,
                       LogMetadata* metadata,
                       rocksdb::ColumnFamilyHandle* cf);
@@ -101,6 +125,11 @@ class RocksDBWriter {
                         ComparableLogMetadata& metadata,
                         const LocalLogStore::WriteOptions& options,
                         rocksdb::ColumnFamilyHandle* cf);
+  void updateLogMetadataBatch(
+      const std::vector<std::pair<logid_t, ComparableLogMetadata*>>& metadata,
+      std::vector<Status>& statuses_out,
+      const LocalLogStore::WriteOptions& options,
+      rocksdb::ColumnFamilyHandle* cf);
   int deleteStoreMetadata(const StoreMetadataType& type,
                           const LocalLogStore::WriteOptions& options,
                           rocksdb::ColumnFamilyHandle* cf);
@@ -478,8 +478,9 @@ bool handleCopySetIndexEntry(const rocksdb::Slice& key,
   std::vector<ShardID> copyset;
   uint32_t wave;
   LocalLogStoreRecordFormat::csi_flags_t csi_flags = 0;
+  folly::StringPiece filterable_key;
   bool rv = LocalLogStoreRecordFormat::parseCopySetIndexSingleEntry(
-      result_value, &copyset, &wave, &csi_flags, this_shard);
+      result_value, &copyset, &wave, &csi_flags, this_shard, &filterable_key);
   ld_check(rv); // parsing succeeded before
   ld_check(!copyset.empty());
   // Assume that cumulative record flags 1:1 correspond to CSI flags.
@@ -490,7 +491,8 @@ bool handleCopySetIndexEntry(const rocksdb::Slice& key,
                                                    copyset.size(),
                                                    LSN_INVALID,
                                                    csi_flags,
-                                                   &out.new_value);
+                                                   &out.new_value,
+                                                   filterable_key);
   ld_check(!out.new_value.empty());
   return true;
 }
@@ -116,7 +116,8 @@ void ShardedRocksDBLocalLogStore::init(
 
   std::vector<IOTracing*> tracing_ptrs;
   for (shard_index_t i = 0; i < nshards_; ++i) {
-    io_tracing_by_shard_.push_back(std::make_unique<IOTracing>(i, stats_));
+    io_tracing_by_shard_.push_back(std::make_unique<IOTracing>(
+        i, stats_, db_settings_->io_trace_ring_size));
     tracing_ptrs.push_back(io_tracing_by_shard_[i].get());
   }
   // If tracing is enabled in settings, enable it before opening the DBs.
@@ -610,6 +611,15 @@ ShardedRocksDBLocalLogStore::getShardToDiskMapping() {
   return fspath_to_dsme_;
 }
 
+std::vector<std::vector<int>>
+ShardedRocksDBLocalLogStore::getShardsGroupedByDevice() {
+  std::vector<std::vector<int>> res;
+  for (const auto& kv : fspath_to_dsme_) {
+    res.push_back(kv.second.shards);
+  }
+  return res;
+}
+
 size_t ShardedRocksDBLocalLogStore::createDiskShardMapping() {
   ld_check(!shard_paths_.empty());
 
@@ -154,6 +154,8 @@ class ShardedRocksDBLocalLogStore : public ShardedLocalLogStore {
   const std::unordered_map<dev_t, DiskShardMappingEntry>&
   getShardToDiskMapping();
 
+  std::vector<std::vector<int>> getShardsGroupedByDevice() override;
+
   /**
    * If the shards use LogsDB, per-disk space-based trimming is enabled, and
    * space usage has reached that limit, trim logs on the given disk until that
@@ -83,6 +83,18 @@ class WriteOp {
     return FlushToken_INVALID;
   }
 
+  /**
+   * If the store buffered this write for ingestion as part of an SST file
+   * instead of writing it through the memtable, the write is neither
+   * readable nor durable until LocalLogStore::ingestedUpThrough() reaches
+   * the token. FlushToken_INVALID if the write wasn't buffered.
+   */
+  virtual void setIngestToken(FlushToken /* unused */) const {}
+
+  virtual FlushToken ingestToken() const {
+    return FlushToken_INVALID;
+  }
+
   virtual std::string toString() const = 0;
 
   /**
@@ -105,8 +117,19 @@ struct RecordWriteOp : public WriteOp {
 
   RecordWriteOp(logid_t log_id, lsn_t lsn) : log_id(log_id), lsn(lsn) {}
 
+  void setIngestToken(FlushToken ingest_token) const override {
+    ingest_token_ = ingest_token;
+  }
+
+  FlushToken ingestToken() const override {
+    return ingest_token_;
+  }
+
   logid_t log_id;
   lsn_t lsn;
+
+ private:
+  mutable FlushToken ingest_token_{FlushToken_INVALID};
 };
 
 /**
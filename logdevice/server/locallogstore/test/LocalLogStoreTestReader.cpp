@@ -33,6 +33,16 @@ class TestCallback : public LocalLogStoreReader::Callback {
 
     return 0;
   }
+  // Records skipped based on their filterable key are returned as empty
+  // records with filtered_out set.
+  int processFilteredOut(lsn_t lsn) override {
+    records_.emplace_back(lsn,
+                          Slice(),
+                          /*owned*/ false,
+                          /*from_under_replicated_region*/ false,
+                          /*filtered_out*/ true);
+    return 0;
+  }
   std::vector<RawRecord>& getRecords() {
     return records_;
   };
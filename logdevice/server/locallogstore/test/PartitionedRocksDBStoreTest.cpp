@@ -25,6 +25,7 @@
 #include "logdevice/common/configuration/InternalLogs.h"
 #include "logdevice/common/configuration/LocalLogsConfig.h"
 #include "logdevice/common/debug.h"
+#include "logdevice/common/settings/RebuildingSettings.h"
 #include "logdevice/common/settings/Settings.h"
 #include "logdevice/common/settings/SettingsUpdater.h"
 #include "logdevice/common/test/TestUtil.h"
@@ -625,6 +626,7 @@ class PartitionedRocksDBStoreTest : public ::testing::Test {
   PartitionedRocksDBStoreTest()
       : settings_(create_default_settings<Settings>()),
         server_settings_(create_default_settings<ServerSettings>()),
+        rebuilding_settings_(create_default_settings<RebuildingSettings>()),
         stats_(StatsParams().setIsServer(true)) {}
   ~PartitionedRocksDBStoreTest() override {}
 
@@ -880,7 +882,8 @@ class PartitionedRocksDBStoreTest : public ::testing::Test {
     }
     auto log_store_config =
         RocksDBLogStoreConfig(rocksdb_settings_,
-                              UpdateableSettings<RebuildingSettings>(),
+                              UpdateableSettings<RebuildingSettings>(
+                                  rebuilding_settings_),
                               env_.get(),
                               nullptr,
                               &stats_);
@@ -1602,6 +1605,8 @@ class PartitionedRocksDBStoreTest : public ::testing::Test {
   std::unique_ptr<SettingsUpdater> settings_updater_;
   ServerConfig::SettingsConfig settings_overrides_;
   UpdateableSettings<RocksDBSettings> rocksdb_settings_;
+  // Used when the store is (re)opened.
+  RebuildingSettings rebuilding_settings_;
 
  private:
   // Timer to kill the test if it takes too long
@@ -10772,3 +10777,113 @@ TEST_F(PartitionedRocksDBStoreTest, BatchWithDelete) {
     EXPECT_EQ(1, nread);
   }
 }
+
+// With --rebuilding-ingest-sst, rebuilt records are only buffered on the write
+// path. They become readable when a storage thread ingests them, which is
+// also when they are acknowledged.
+TEST_F(PartitionedRocksDBStoreTest, IngestRebuildingWrites) {
+  closeStore();
+  rebuilding_settings_.ingest_sst = true;
+  rebuilding_settings_.ingest_sst_max_delay = std::chrono::seconds(1);
+  openStore();
+  const logid_t logid(1);
+
+  EXPECT_EQ(FlushToken_MAX, store_->ingestedUpThrough());
+  put({TestRecord(
+           logid, 10, Durability::MEMORY, TestRecord::StoreType::REBUILD),
+       TestRecord(
+           logid, 20, Durability::MEMORY, TestRecord::StoreType::REBUILD)});
+  // Buffered, so not acknowledgeable yet, and not readable.
+  EXPECT_EQ(FlushToken_INVALID, store_->ingestedUpThrough());
+  auto count_records = [&] {
+    auto it = store_->read(
+        logid, LocalLogStore::ReadOptions("IngestRebuildingWrites"));
+    size_t n = 0;
+    for (it->seek(0); it->state() == IteratorState::AT_RECORD; it->next()) {
+      ++n;
+    }
+    return n;
+  };
+  EXPECT_EQ(0, count_records());
+
+  // Not due yet.
+  ASSERT_EQ(0, store_->ingestBufferedWrites(/* all */ false));
+  EXPECT_EQ(FlushToken_INVALID, store_->ingestedUpThrough());
+
+  // An append to the same log goes to the buffer too, so that it isn't
+  // reordered with the buffered records.
+  put({TestRecord(logid, 30)});
+  EXPECT_EQ(0, count_records());
+
+  setTime(time_.toMilliseconds().count() + 2000);
+  ASSERT_EQ(0, store_->ingestBufferedWrites(/* all */ false));
+  EXPECT_EQ(FlushToken_MAX, store_->ingestedUpThrough());
+  EXPECT_EQ(3, count_records());
+  Stats stats = stats_.aggregate();
+  EXPECT_EQ(
+      1,
+      stats.logsdb_rebuilding_ingested_files +
+          stats.logsdb_rebuilding_ingest_fallbacks);
+
+  // Nothing is buffered for the log anymore, so appends go to the memtable.
+  put({TestRecord(logid, 40)});
+  EXPECT_EQ(FlushToken_MAX, store_->ingestedUpThrough());
+  EXPECT_EQ(4, count_records());
+
+  auto data = readAndCheck();
+  ASSERT_EQ(1, data.size());
+  EXPECT_EQ(std::vector<lsn_t>({10, 20, 30, 40}), data[0][logid].records);
+}
+
+// Buffering and ingesting rebuilt records leaves the same data as writing them
+// through the memtable.
+TEST_F(PartitionedRocksDBStoreTest, IngestRebuildingWritesSameAsMemtable) {
+  no_deletes_ = false;
+  auto write = [&](logid_t logid) {
+    put({TestRecord(
+             logid, 10, Durability::MEMORY, TestRecord::StoreType::REBUILD),
+         TestRecord(
+             logid, 20, Durability::MEMORY, TestRecord::StoreType::REBUILD),
+         TestRecord(logid_t(logid.val_ + 1),
+                    10,
+                    Durability::SYNC_WRITE,
+                    TestRecord::StoreType::REBUILD)});
+    put({TestRecord(
+             logid, 30, Durability::MEMORY, TestRecord::StoreType::REBUILD),
+         TestRecord(logid, 20, TestRecord::Type::DELETE),
+         TestRecord(logid_t(logid.val_ + 1), 20)});
+    // Same key as a buffered record.
+    put({TestRecord(
+        logid, 30, Durability::MEMORY, TestRecord::StoreType::REBUILD)});
+    store_->createPartition();
+    put({TestRecord(
+        logid, 40, Durability::MEMORY, TestRecord::StoreType::REBUILD)});
+  };
+
+  write(logid_t(1));
+
+  closeStore();
+  rebuilding_settings_.ingest_sst = true;
+  openStore();
+  write(logid_t(3));
+  EXPECT_LT(store_->ingestedUpThrough(), FlushToken_MAX);
+
+  // Closing the store ingests the buffers.
+  auto data = readAndCheck();
+  std::map<logid_t, std::vector<lsn_t>> records;
+  for (auto& partition : data) {
+    for (auto& log : partition) {
+      auto& log_records = records[log.first];
+      log_records.insert(log_records.end(),
+                         log.second.records.begin(),
+                         log.second.records.end());
+    }
+  }
+  EXPECT_EQ(std::vector<lsn_t>({10, 30, 40}), records[logid_t(1)]);
+  EXPECT_EQ(records[logid_t(1)], records[logid_t(3)]);
+  EXPECT_EQ(records[logid_t(2)], records[logid_t(4)]);
+  Stats stats = stats_.aggregate();
+  EXPECT_GT(stats.logsdb_rebuilding_ingested_files +
+                stats.logsdb_rebuilding_ingest_fallbacks,
+            0);
+}
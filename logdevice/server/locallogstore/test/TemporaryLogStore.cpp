@@ -77,6 +77,14 @@ FlushToken TemporaryLogStore::walSyncedUpThrough() const {
   return db_->walSyncedUpThrough();
 }
 
+int TemporaryLogStore::ingestBufferedWrites(bool all) {
+  return db_->ingestBufferedWrites(all);
+}
+
+FlushToken TemporaryLogStore::ingestedUpThrough() const {
+  return db_->ingestedUpThrough();
+}
+
 std::unique_ptr<LocalLogStore::ReadIterator>
 TemporaryLogStore::read(logid_t log_id,
                         const LocalLogStore::ReadOptions& options) const {
@@ -124,6 +132,13 @@ int TemporaryLogStore::updateLogMetadata(logid_t log_id,
   return db_->updateLogMetadata(log_id, metadata, options);
 }
 
+void TemporaryLogStore::updateLogMetadataBatch(
+    const std::vector<std::pair<logid_t, ComparableLogMetadata*>>& metadata,
+    std::vector<Status>& statuses_out,
+    const WriteOptions& options) {
+  db_->updateLogMetadataBatch(metadata, statuses_out, options);
+}
+
 int TemporaryLogStore::readStoreMetadata(StoreMetadata* metadata) {
   return db_->readStoreMetadata(metadata);
 }
@@ -64,6 +64,8 @@ class TemporaryLogStore : public LocalLogStore {
   FlushToken flushedUpThrough() const override;
   FlushToken maxWALSyncToken() const override;
   FlushToken walSyncedUpThrough() const override;
+  int ingestBufferedWrites(bool all) override;
+  FlushToken ingestedUpThrough() const override;
 
   std::unique_ptr<ReadIterator>
   read(logid_t log_id, const LocalLogStore::ReadOptions&) const override;
@@ -91,6 +93,10 @@ class TemporaryLogStore : public LocalLogStore {
   int updateLogMetadata(logid_t log_id,
                         ComparableLogMetadata& metadata,
                         const WriteOptions& options) override;
+  void updateLogMetadataBatch(
+      const std::vector<std::pair<logid_t, ComparableLogMetadata*>>& metadata,
+      std::vector<Status>& statuses_out,
+      const WriteOptions& options) override;
   int readStoreMetadata(StoreMetadata* metadata) override;
   int writeStoreMetadata(const StoreMetadata& metadata,
                          const WriteOptions& options) override;
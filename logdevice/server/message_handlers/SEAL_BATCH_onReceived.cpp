@@ -0,0 +1,59 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/message_handlers/SEAL_BATCH_onReceived.h"
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "logdevice/server/ServerWorker.h"
+#include "logdevice/server/message_handlers/SEAL_onReceived.h"
+#include "logdevice/server/storage/SealBatchStorageTask.h"
+#include "logdevice/server/storage/SealStorageTask.h"
+#include "logdevice/server/storage_tasks/PerWorkerStorageTaskQueue.h"
+
+namespace facebook { namespace logdevice {
+
+Message::Disposition SEAL_BATCH_onReceived(SEAL_BATCH_Message* msg,
+                                           const Address& from) {
+  // A malformed SEAL rejects the whole message. Check them all before
+  // replying to any or preparing their tasks.
+  for (const SEAL_Header& header : msg->getHeaders()) {
+    Message::Disposition disposition = SEAL_checkHeader(header, from);
+    if (disposition != Message::Disposition::NORMAL) {
+      return disposition;
+    }
+  }
+
+  // Each SEAL is then handled as if it came on its own. The ones that need a
+  // storage task are grouped by shard, so that each shard seals its logs in
+  // one SealBatchStorageTask.
+  std::map<shard_index_t, std::vector<std::unique_ptr<SealStorageTask>>>
+      tasks;
+  for (const SEAL_Header& header : msg->getHeaders()) {
+    std::unique_ptr<SealStorageTask> task;
+    SEAL_prepareTask(header, from, &task);
+    if (task) {
+      tasks[header.shard].push_back(std::move(task));
+    }
+  }
+
+  ServerWorker* worker = ServerWorker::onThisThread();
+  for (auto& kv : tasks) {
+    auto* queue = worker->getStorageTaskQueueForShard(kv.first);
+    if (kv.second.size() == 1) {
+      queue->putTask(std::move(kv.second[0]));
+    } else {
+      queue->putTask(
+          std::make_unique<SealBatchStorageTask>(std::move(kv.second)));
+    }
+  }
+
+  return Message::Disposition::NORMAL;
+}
+}} // namespace facebook::logdevice
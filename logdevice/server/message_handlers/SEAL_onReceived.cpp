@@ -20,10 +20,8 @@
 
 namespace facebook { namespace logdevice {
 
-Message::Disposition SEAL_onReceived(SEAL_Message* msg, const Address& from) {
-  const SEAL_Header& header = msg->getHeader();
-  ServerWorker* worker = ServerWorker::onThisThread();
-
+Message::Disposition SEAL_checkHeader(const SEAL_Header& header,
+                                      const Address& from) {
   if (header.log_id == LOGID_INVALID || !epoch_valid(header.seal_epoch)) {
     RATELIMIT_CRITICAL(std::chrono::seconds(10),
                        10,
@@ -48,11 +46,20 @@ Message::Disposition SEAL_onReceived(SEAL_Message* msg, const Address& from) {
     return Message::Disposition::ERROR;
   }
 
+  return Message::Disposition::NORMAL;
+}
+
+void SEAL_prepareTask(const SEAL_Header& header,
+                      const Address& from,
+                      std::unique_ptr<SealStorageTask>* task_out) {
+  ld_check(task_out != nullptr);
+  ServerWorker* worker = ServerWorker::onThisThread();
+
   if (!worker->isAcceptingWork()) {
     ld_debug("Ignoring SEAL message: not accepting more work");
     SEALED_Message::createAndSend(
         from, header.log_id, header.shard, header.seal_epoch, E::SHUTDOWN);
-    return Message::Disposition::NORMAL;
+    return;
   }
 
   ServerProcessor* processor = worker->processor_;
@@ -62,7 +69,7 @@ Message::Disposition SEAL_onReceived(SEAL_Message* msg, const Address& from) {
 
     SEALED_Message::createAndSend(
         from, header.log_id, header.shard, header.seal_epoch, E::NOTSTORAGE);
-    return Message::Disposition::NORMAL;
+    return;
   }
 
   const shard_size_t n_shards = worker->getNodesConfiguration()->getNumShards(
@@ -78,7 +85,7 @@ Message::Disposition SEAL_onReceived(SEAL_Message* msg, const Address& from) {
                     Sender::describeConnection(from).c_str(),
                     shard_idx,
                     n_shards);
-    return Message::Disposition::NORMAL;
+    return;
   }
 
   if (processor->isDataMissingFromShard(shard_idx)) {
@@ -87,7 +94,7 @@ Message::Disposition SEAL_onReceived(SEAL_Message* msg, const Address& from) {
 
     SEALED_Message::createAndSend(
         from, header.log_id, header.shard, header.seal_epoch, E::REBUILDING);
-    return Message::Disposition::NORMAL;
+    return;
   }
 
   Seal seal;
@@ -100,7 +107,7 @@ Message::Disposition SEAL_onReceived(SEAL_Message* msg, const Address& from) {
     // LogStorageStateMap is at capacity
     SEALED_Message::createAndSend(
         from, header.log_id, header.shard, header.seal_epoch, E::FAILED);
-    return Message::Disposition::NORMAL;
+    return;
   }
 
   folly::Optional<Seal> current_seal =
@@ -118,7 +125,7 @@ Message::Disposition SEAL_onReceived(SEAL_Message* msg, const Address& from) {
                                   LSN_INVALID,
                                   /*lng_list*/ std::vector<lsn_t>(),
                                   current_seal.value());
-    return Message::Disposition::NORMAL;
+    return;
   }
 
   bool tail_optimized = false;
@@ -133,10 +140,24 @@ Message::Disposition SEAL_onReceived(SEAL_Message* msg, const Address& from) {
     tail_optimized = log->attrs().tailOptimized().value();
   }
 
-  auto task = std::make_unique<SealStorageTask>(
+  *task_out = std::make_unique<SealStorageTask>(
       header.log_id, header.last_clean_epoch, seal, from, tail_optimized);
-  worker->getStorageTaskQueueForShard(shard_idx)->putTask(std::move(task));
+}
 
+Message::Disposition SEAL_onReceived(SEAL_Message* msg, const Address& from) {
+  const SEAL_Header& header = msg->getHeader();
+  Message::Disposition disposition = SEAL_checkHeader(header, from);
+  if (disposition != Message::Disposition::NORMAL) {
+    return disposition;
+  }
+
+  std::unique_ptr<SealStorageTask> task;
+  SEAL_prepareTask(header, from, &task);
+  if (task) {
+    ServerWorker::onThisThread()
+        ->getStorageTaskQueueForShard(header.shard)
+        ->putTask(std::move(task));
+  }
   return Message::Disposition::NORMAL;
 }
 }} // namespace facebook::logdevice
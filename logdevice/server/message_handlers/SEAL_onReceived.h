@@ -7,12 +7,34 @@
  */
 #pragma once
 
+#include <memory>
+
 #include "logdevice/common/protocol/Message.h"
 #include "logdevice/common/protocol/SEAL_Message.h"
 
 namespace facebook { namespace logdevice {
 
 struct Address;
+class SealStorageTask;
 
 Message::Disposition SEAL_onReceived(SEAL_Message* msg, const Address& from);
+
+/**
+ * Checks that a SEAL request, received in a SEAL or SEAL_BATCH message, is
+ * well-formed.
+ *
+ * @return  ERROR with err set if the request is malformed, NORMAL otherwise.
+ */
+Message::Disposition SEAL_checkHeader(const SEAL_Header& header,
+                                      const Address& from);
+
+/**
+ * Handles a SEAL request that passed SEAL_checkHeader(). Replies with SEALED
+ * right away if the log can't or needn't be sealed on this node, otherwise
+ * sets *task_out to the task sealing it, to be put on the queue of shard
+ * header.shard.
+ */
+void SEAL_prepareTask(const SEAL_Header& header,
+                      const Address& from,
+                      std::unique_ptr<SealStorageTask>* task_out);
 }} // namespace facebook::logdevice
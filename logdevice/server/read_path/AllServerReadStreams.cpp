@@ -361,7 +361,7 @@ void AllServerReadStreams::onReadTaskDropped(ReadStorageTask& task) {
   // We're on worker thread.
   CatchupQueue* q = task.catchup_queue_.get().get();
   if (q) {
-    q->onStorageTaskDropped(task.stream_.get().get());
+    q->onReadTaskDropped(task);
   } else {
     // Client disconnected.
   }
@@ -651,6 +651,7 @@ bool AllServerReadStreams::tryAcquireMemoryForTask(
   if (!token.valid()) {
     return false;
   }
+  // Reads batched with the task share its byte limit, and this token.
   task->setMemoryToken(std::move(token));
   return true;
 }
@@ -181,6 +181,7 @@ class ReadingCallback : public LocalLogStoreReader::Callback {
         catchup_reason_(reason) {}
 
   int processRecord(const RawRecord& record) override;
+  int processFilteredOut(lsn_t lsn) override;
 
   int nrecords_ = 0;
 
@@ -196,6 +197,14 @@ class ReadingCallback : public LocalLogStoreReader::Callback {
                     const OffsetMap& offsets_within_epoch);
 
  private:
+  // Sends a TRIM gap for records before `lsn` that were trimmed since the
+  // read was scheduled. See processRecord().
+  int sendTrimGapIfNeeded(lsn_t lsn, lsn_t trim_point);
+
+  // Extends the pending FILTERED_OUT gap to `lsn`, first sending the pending
+  // one if it doesn't end right before `lsn`.
+  int addToFilteredOutGap(lsn_t lsn, lsn_t trim_point);
+
   // Sends a RECORD_Message for the given record over the wire
   int shipRecord(lsn_t lsn,
                  std::chrono::milliseconds timestamp,
@@ -226,6 +235,11 @@ class ReadingCallback : public LocalLogStoreReader::Callback {
 int ReadingCallback::processRecord(const RawRecord& record) {
   const lsn_t lsn = record.lsn;
 
+  if (record.filtered_out) {
+    // Record buffered by StorageThreadCallback::processFilteredOut().
+    return processFilteredOut(lsn);
+  }
+
   // Parse the local log store blob
   std::chrono::milliseconds timestamp;
   Payload payload;
@@ -340,20 +354,8 @@ int ReadingCallback::processRecord(
   LogStorageState& log_state = catchup_->deps_.getLogStorageStateMap().get(
       stream_->log_id_, stream_->shard_);
   lsn_t trim_point = log_state.getTrimPoint();
-  if (stream_->last_delivered_lsn_ < trim_point &&
-      lsn > stream_->last_delivered_lsn_ + 1) {
-    int rv = catchup_->sendGAP(std::min(trim_point, lsn - 1), GapReason::TRIM);
-
-    if (rv != 0) {
-      if (err == E::NOBUFS || err == E::SHUTDOWN) {
-        return -1;
-      }
-      // see below
-      ld_error("Got unexpected error from Sender::sendMessage(): %s",
-               error_description(err));
-      ld_check(false);
-      return -1;
-    }
+  if (sendTrimGapIfNeeded(lsn, trim_point) != 0) {
+    return -1;
   }
 
   // Iterators are expected to skip amends that don't correspond to any record.
@@ -387,24 +389,9 @@ int ReadingCallback::processRecord(
   }
 
   if (filtered_out) {
-    // If filtered_out_end_lsn_ is not lsn - 1, FILTERED_OUT gap is not
-    // continuous between filtered_out_end_lsn_ and lsn. We deliver last
-    // FILTERED_OUT gap and set filtered_out_end_lsn_ to current lsn.
-    if (stream_->filtered_out_end_lsn_ != lsn - 1 &&
-        (catchup_->sendGapFilteredOutIfNeeded(trim_point) != 0 ||
-         (lsn - 1 > stream_->last_delivered_lsn_ &&
-          catchup_->sendGAP(lsn - 1, GapReason::NO_RECORDS) != 0))) {
+    if (addToFilteredOutGap(lsn, trim_point) != 0) {
       return -1;
     }
-
-    stream_->filtered_out_end_lsn_ = lsn;
-    if (stream_->filtered_out_end_lsn_ >= stream_->getWindowHigh()) {
-      if (catchup_->sendGapFilteredOutIfNeeded(trim_point) != 0) {
-        return -1;
-      }
-      stream_->filtered_out_end_lsn_ = LSN_INVALID;
-    }
-
   } else {
     if (catchup_->sendGapFilteredOutIfNeeded(trim_point) != 0) {
       // There is a filtered out gap that has not been shipped.
@@ -448,6 +435,64 @@ int ReadingCallback::processRecord(
   return 0;
 }
 
+int ReadingCallback::processFilteredOut(lsn_t lsn) {
+  ld_check(lsn > stream_->last_delivered_lsn_);
+
+  LogStorageState& log_state = catchup_->deps_.getLogStorageStateMap().get(
+      stream_->log_id_, stream_->shard_);
+  lsn_t trim_point = log_state.getTrimPoint();
+  if (sendTrimGapIfNeeded(lsn, trim_point) != 0 ||
+      addToFilteredOutGap(lsn, trim_point) != 0) {
+    return -1;
+  }
+
+  // See processRecord().
+  if (lsn >= stream_->getReadPtr().lsn) {
+    stream_->setReadPtr(lsn + 1);
+  }
+  return 0;
+}
+
+int ReadingCallback::sendTrimGapIfNeeded(lsn_t lsn, lsn_t trim_point) {
+  if (stream_->last_delivered_lsn_ < trim_point &&
+      lsn > stream_->last_delivered_lsn_ + 1) {
+    int rv = catchup_->sendGAP(std::min(trim_point, lsn - 1), GapReason::TRIM);
+
+    if (rv != 0) {
+      if (err == E::NOBUFS || err == E::SHUTDOWN) {
+        return -1;
+      }
+      // see shipRecord()
+      ld_error("Got unexpected error from Sender::sendMessage(): %s",
+               error_description(err));
+      ld_check(false);
+      return -1;
+    }
+  }
+  return 0;
+}
+
+int ReadingCallback::addToFilteredOutGap(lsn_t lsn, lsn_t trim_point) {
+  // If filtered_out_end_lsn_ is not lsn - 1, FILTERED_OUT gap is not
+  // continuous between filtered_out_end_lsn_ and lsn. We deliver last
+  // FILTERED_OUT gap and set filtered_out_end_lsn_ to current lsn.
+  if (stream_->filtered_out_end_lsn_ != lsn - 1 &&
+      (catchup_->sendGapFilteredOutIfNeeded(trim_point) != 0 ||
+       (lsn - 1 > stream_->last_delivered_lsn_ &&
+        catchup_->sendGAP(lsn - 1, GapReason::NO_RECORDS) != 0))) {
+    return -1;
+  }
+
+  stream_->filtered_out_end_lsn_ = lsn;
+  if (stream_->filtered_out_end_lsn_ >= stream_->getWindowHigh()) {
+    if (catchup_->sendGapFilteredOutIfNeeded(trim_point) != 0) {
+      return -1;
+    }
+    stream_->filtered_out_end_lsn_ = LSN_INVALID;
+  }
+  return 0;
+}
+
 OffsetMap ReadingCallback::getEpochOffsets(epoch_t record_epoch,
                                            LogStorageState& log_state) {
   if (store_ == nullptr) {
@@ -758,7 +803,7 @@ CatchupOneStream::startRead(WeakRef<CatchupQueue> catchup_queue,
                             bool try_non_blocking_read,
                             size_t max_record_bytes_queued,
                             bool first_record_any_size,
-                            bool allow_storage_task,
+                            StorageTaskAllowed allow_storage_task,
                             CatchupEventTrigger catchup_reason,
                             ReadIoShapingCallback& read_shaping_cb) {
   ServerWorker* w = ServerWorker::onThisThread(false);
@@ -877,10 +922,12 @@ CatchupOneStream::startRead(WeakRef<CatchupQueue> catchup_queue,
                  stream_->last_known_good_ <= stream_->last_delivered_lsn_) {
         // No cached lng or cached lng too low to make progress. Try to read
         // from record cache or store.
-        if (readLastKnownGood(catchup_queue, allow_storage_task) != 0) {
-          // A storage task is needed and, if allow_storage_task is true, was
+        const bool allow_lng_task =
+            allow_storage_task == StorageTaskAllowed::ANY;
+        if (readLastKnownGood(catchup_queue, allow_lng_task) != 0) {
+          // A storage task is needed and, if allow_lng_task is true, was
           // created.
-          if (allow_storage_task) {
+          if (allow_lng_task) {
             stream_->last_batch_status_ = "sent LNG storage task";
             return Action::WAIT_FOR_LNG;
           } else {
@@ -1039,7 +1086,7 @@ CatchupOneStream::startRead(WeakRef<CatchupQueue> catchup_queue,
     }
   }
 
-  if (!allow_storage_task) {
+  if (allow_storage_task == StorageTaskAllowed::NONE) {
     stream_->last_batch_status_ = "WOULDBLOCK";
     return Action::WOULDBLOCK;
   }
@@ -1391,6 +1438,8 @@ void CatchupOneStream::readOnStorageThread(
     client_address = w->sender().getSockaddr(Address(stream_->client_id_));
   }
   auto prio = getPriorityForStorageTasks();
+  // May be null in tests.
+  CatchupQueue* queue = catchup_queue.get();
   auto task_uniq = std::make_unique<ReadStorageTask>(stream_->createRef(),
                                                      std::move(catchup_queue),
                                                      stream_->version_,
@@ -1405,7 +1454,12 @@ void CatchupOneStream::readOnStorageThread(
                                                      std::get<2>(prio),
                                                      std::get<3>(prio),
                                                      client_address);
-  deps_.putStorageTask(std::move(task_uniq), stream_->shard_);
+  if (queue) {
+    // CatchupQueue may batch the task with other reads.
+    queue->putStorageTask(std::move(task_uniq), stream_->shard_);
+  } else {
+    deps_.putStorageTask(std::move(task_uniq), stream_->shard_);
+  }
   STAT_INCR(deps_.getStatsHolder(), read_requests_to_storage);
 
   ld_check_gt(read_ctx.read_ptr_.lsn, stream_->last_delivered_lsn_);
@@ -1420,7 +1474,7 @@ CatchupOneStream::read(CatchupQueueDependencies& deps,
                        bool try_non_blocking_read,
                        size_t max_record_bytes_queued,
                        bool first_record_any_size,
-                       bool allow_storage_task,
+                       StorageTaskAllowed allow_storage_task,
                        CatchupEventTrigger catchup_reason) {
   CatchupOneStream catchup(deps, stream, catchup_queue->resumeCallback());
   Action action = catchup.startRead(std::move(catchup_queue),
@@ -1456,7 +1510,7 @@ CatchupOneStream::processTask(const ReadStorageTask& task) {
       task.owned_iterator_ && // May be null in tests.
       task.owned_iterator_->accessedUnderReplicatedRegion();
 
-  if (stream_->iterator_cache_ &&
+  if (stream_->iterator_cache_ && !task.shared_iterator_ &&
       !stream_->iterator_cache_->valid(task.options_)) {
     // We don't have an iterator in cache, either because it was the first
     // batch, or because we invalidated the iterator while the storage task was
@@ -1878,6 +1932,7 @@ CatchupOneStream::createReadContext(lsn_t last_released_lsn,
       }
     }
   }
+  filter->key_filter_ = stream_->filter_pred_;
 
   LocalLogStoreReader::ReadContext read_ctx(stream_->log_id_,
                                             stream_->getReadPtr(),
@@ -116,6 +116,18 @@ class CatchupOneStream {
 
   static EnumMap<Action, std::string> action_names;
 
+  // Which storage tasks read() may create when records can't be read without
+  // blocking.
+  enum class StorageTaskAllowed {
+    // None, read() returns WOULDBLOCK instead.
+    NONE,
+    // Only a ReadStorageTask, which CatchupQueue batches with the one it
+    // already has in flight. See --max-read-streams-per-storage-task.
+    BATCHED_READ,
+    // Any storage task.
+    ANY
+  };
+
   /**
    * Read a batch of records.
    *
@@ -135,7 +147,7 @@ class CatchupOneStream {
    *                                try_non_blocking_read is false, this
    *                                controls whether we issue a StorageTask to
    *                                perform blocking I/O, or just return
-   *                                WOULDBLOCK.
+   *                                WOULDBLOCK. See StorageTaskAllowed.
    *
    * @return std::pair of Action, and number of RECORD bytes queued, the number
    *                                of bytes that were immediatly enqueued in
@@ -147,7 +159,7 @@ class CatchupOneStream {
                                         bool try_non_blocking_read,
                                         size_t max_record_bytes_queued,
                                         bool first_record_any_size,
-                                        bool allow_storage_task,
+                                        StorageTaskAllowed allow_storage_task,
                                         CatchupEventTrigger reason);
 
   /**
@@ -175,7 +187,7 @@ class CatchupOneStream {
                    bool try_non_blocking_read,
                    size_t max_record_bytes_queued,
                    bool first_record_any_size,
-                   bool allow_storage_task,
+                   StorageTaskAllowed allow_storage_task,
                    CatchupEventTrigger reason,
                    ReadIoShapingCallback& read_shaping_cb);
 
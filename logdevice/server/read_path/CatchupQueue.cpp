@@ -186,6 +186,16 @@ void CatchupQueue::pushRecords(CatchupEventTrigger catchup_reason) {
 
   size_t max_record_bytes_queued = deps_->getMaxRecordBytesQueued(client_id_);
 
+  // Reads of several streams on the same shard may be batched into the one
+  // storage task this call issues, but never added to a task already in
+  // flight. This only saves storage thread round trips: each read still
+  // seeks, and only reads of the same log may share an iterator. All reads
+  // of the batch may use the rest of the byte limit; ReadStorageTask makes
+  // sure the batch as a whole stays within it.
+  const size_t max_streams_per_task =
+      deps_->getSettings().max_read_streams_per_storage_task;
+  batching_reads_ = max_streams_per_task > 1 && !storage_task_in_flight_;
+
   // We limit the number of iterations in that loop in order to yield in the
   // extremely unlikely case where all batches we read keep returning zero or a
   // very small amount of records because most records are filtered. We don't
@@ -251,6 +261,14 @@ void CatchupQueue::pushRecords(CatchupEventTrigger catchup_reason) {
     size_t n_bytes_queued;
     bool try_non_blocking_read =
         try_non_blocking_read_ && deps_->getSettings().allow_reads_on_workers;
+    using StorageTaskAllowed = CatchupOneStream::StorageTaskAllowed;
+    StorageTaskAllowed allow_storage_task = StorageTaskAllowed::NONE;
+    if (!storage_task_in_flight_) {
+      allow_storage_task = StorageTaskAllowed::ANY;
+    } else if (read_batch_ && read_batch_shard_ == stream->shard_ &&
+               read_batch_->batched_tasks_.size() + 1 < max_streams_per_task) {
+      allow_storage_task = StorageTaskAllowed::BATCHED_READ;
+    }
     std::tie(act, n_bytes_queued) =
         CatchupOneStream::read(*deps_,
                                &*stream,
@@ -258,7 +276,7 @@ void CatchupQueue::pushRecords(CatchupEventTrigger catchup_reason) {
                                try_non_blocking_read,
                                max_record_bytes_queued - record_bytes_queued_,
                                record_bytes_queued_ == 0,
-                               !storage_task_in_flight_,
+                               allow_storage_task,
                                catchup_reason);
     record_bytes_queued_ += n_bytes_queued;
 
@@ -279,8 +297,14 @@ void CatchupQueue::pushRecords(CatchupEventTrigger catchup_reason) {
     if (act == CatchupOneStream::Action::WAIT_FOR_STORAGE_TASK ||
         act == CatchupOneStream::Action::WAIT_FOR_LNG) {
       ld_check(stream->storage_task_in_flight_);
-      ld_check(!storage_task_in_flight_);
-      storage_task_in_flight_ = true;
+      if (allow_storage_task == StorageTaskAllowed::BATCHED_READ) {
+        // The read was added to read_batch_.
+        ld_check(act == CatchupOneStream::Action::WAIT_FOR_STORAGE_TASK);
+        ld_check(storage_task_in_flight_);
+      } else {
+        ld_check(!storage_task_in_flight_);
+        storage_task_in_flight_ = true;
+      }
       storage_task_count++;
     } else {
       ld_check(!stream->storage_task_in_flight_);
@@ -353,11 +377,15 @@ void CatchupQueue::pushRecords(CatchupEventTrigger catchup_reason) {
     }
   }
 
-  if (storage_task_count > 1) {
+  flushReadBatch();
+  batching_reads_ = false;
+
+  // Streams whose reads are batched each count as one.
+  if (storage_task_count > max_streams_per_task) {
     ld_critical("The catchup queue of client %s started more than one storage "
                 "task.",
                 Sender::describeConnection(client_id_).c_str());
-    ld_check_le(storage_task_count, 1);
+    ld_check_le(storage_task_count, max_streams_per_task);
   }
 
   // Depending on the outcome of the above loop, under certain error
@@ -838,10 +866,37 @@ void CatchupQueue::readThrottlingOnReadTaskDone(const ReadStorageTask& task) {
   }
 }
 
+void CatchupQueue::putStorageTask(std::unique_ptr<ReadStorageTask>&& task,
+                                  shard_index_t shard) {
+  ld_check(task);
+  if (!batching_reads_) {
+    deps_->putStorageTask(std::move(task), shard);
+    return;
+  }
+
+  if (!read_batch_) {
+    read_batch_ = std::move(task);
+    read_batch_shard_ = shard;
+    return;
+  }
+  ld_check_eq(read_batch_shard_, shard);
+  read_batch_->batched_tasks_.push_back(std::move(task));
+  STAT_INCR(deps_->getStatsHolder(), read_requests_to_storage_batched);
+}
+
+void CatchupQueue::flushReadBatch() {
+  if (read_batch_) {
+    deps_->putStorageTask(std::move(read_batch_), read_batch_shard_);
+    read_batch_shard_ = -1;
+  }
+}
+
 void CatchupQueue::onReadTaskDone(const ReadStorageTask& task) {
-  ld_spew("Got %zu records, status=%s",
+  ld_spew("Got %zu records, status=%s, %zu batched reads",
           task.records_.size(),
-          error_description(task.status_));
+          error_description(task.status_),
+          task.batched_tasks_.size());
+
   STAT_ADD(
       deps_->getStatsHolder(), num_bytes_read_via_read_task, task.total_bytes_);
 
@@ -850,6 +905,12 @@ void CatchupQueue::onReadTaskDone(const ReadStorageTask& task) {
   // Until onStorageTaskStopped() is called, no more read storage tasks can
   // be issued because storage_task_in_flight_ will remain true.
   readThrottlingOnReadTaskDone(task);
+  for (const auto& batched : task.batched_tasks_) {
+    STAT_ADD(deps_->getStatsHolder(),
+             num_bytes_read_via_read_task,
+             batched->total_bytes_);
+    readThrottlingOnReadTaskDone(*batched);
+  }
 
   // We may be waiting for bandwidth due to attempts to process another
   // stream. Cancel the resume callback so that any records/gaps generated
@@ -866,14 +927,48 @@ void CatchupQueue::onReadTaskDone(const ReadStorageTask& task) {
 
   ServerReadStream* stream = task.stream_.get().get();
   onStorageTaskStopped(stream);
-  if (!stream) {
-    // The ServerReadStreams was erased while the storage task was in flight.
-    pushRecords();
-    return;
+  onBatchedReadsStopped(task);
+
+  bool drain = false;
+  for (size_t i = 0; i <= task.batched_tasks_.size(); ++i) {
+    const ReadStorageTask& stream_task =
+        i == 0 ? task : *task.batched_tasks_[i - 1];
+    stream = stream_task.stream_.get().get();
+    if (!stream) {
+      // The ServerReadStreams was erased while the storage task was in flight.
+      continue;
+    }
+    ld_check(i > 0 || stream == &queue_.front());
+
+    auto act = processReadTaskResult(stream, stream_task);
+    if (act == CatchupOneStream::Action::TRANSIENT_ERROR) {
+      // We hit an error trying to send out a record to the client. Streams
+      // whose results were not processed yet will read them again.
+      adjustPingTimer();
+      return;
+    }
+
+    if (act == CatchupOneStream::Action::WAIT_FOR_BANDWIDTH) {
+      // We ran out of bandwidth trying to send out a record to the client.
+      // Wait for our callback to fire.
+      //
+      // NOTE: We use Sender's deferred message queuing feature when processing
+      //       records from tasks, this status should never be returned.
+      ld_check(false);
+      return;
+    }
+
+    drain |= act == CatchupOneStream::Action::REQUEUE_AND_DRAIN;
   }
 
-  ld_check(stream == &queue_.front());
+  if (!drain || record_bytes_queued_ == 0) {
+    pushRecords();
+  }
+}
 
+CatchupOneStream::Action
+CatchupQueue::processReadTaskResult(ServerReadStream* stream,
+                                    const ReadStorageTask& task) {
   size_t n_bytes_queued;
   CatchupOneStream::Action act;
   std::tie(act, n_bytes_queued) =
@@ -886,24 +981,11 @@ void CatchupQueue::onReadTaskDone(const ReadStorageTask& task) {
                   "Read on storage thread completes with %s",
                   CatchupOneStream::action_names[act].c_str());
 
-  if (act == CatchupOneStream::Action::TRANSIENT_ERROR) {
-    // We hit an error trying to send out a record to the client.
-    adjustPingTimer();
-    return;
-  }
-
-  if (act == CatchupOneStream::Action::WAIT_FOR_BANDWIDTH) {
-    // We ran out of bandwidth trying to send out a record to the client.
-    // Wait for our callback to fire.
-    //
-    // NOTE: We use Sender's deferred message queuing feature when processing
-    //       records from tasks, this status should never be returned.
-    ld_check(false);
-    return;
-  }
-
-  if (act == CatchupOneStream::Action::DEQUEUE_AND_CONTINUE) {
-    queue_.pop_front();
+  if (act == CatchupOneStream::Action::TRANSIENT_ERROR ||
+      act == CatchupOneStream::Action::WAIT_FOR_BANDWIDTH) {
+    // Handled by the caller.
+  } else if (act == CatchupOneStream::Action::DEQUEUE_AND_CONTINUE) {
+    queue_.erase(queue_.iterator_to(*stream));
     ld_check(!stream->isCatchingUp());
     stream->adjustStatWhenCatchingUpChanged();
   } else if (act == CatchupOneStream::Action::ERASE_AND_CONTINUE) {
@@ -912,26 +994,20 @@ void CatchupQueue::onReadTaskDone(const ReadStorageTask& task) {
     // folly::IntrusiveList.
     deps_->eraseStream(
         client_id_, stream->log_id_, stream->id_, stream->shard_);
-    stream = nullptr;
   } else if (act == CatchupOneStream::Action::PERMANENT_ERROR) {
     if (notifyShardError(stream) == 0) {
       deps_->eraseStream(
           client_id_, stream->log_id_, stream->id_, stream->shard_);
-      stream = nullptr;
     }
   } else {
     ld_check(act == CatchupOneStream::Action::REQUEUE_AND_DRAIN ||
              act == CatchupOneStream::Action::REQUEUE_AND_CONTINUE);
     // Move to the end of the queue.
-    queue_.pop_front();
+    queue_.erase(queue_.iterator_to(*stream));
     queue_.push_back(*stream);
     ld_check(stream->isCatchingUp());
   }
-
-  if (act != CatchupOneStream::Action::REQUEUE_AND_DRAIN ||
-      record_bytes_queued_ == 0) {
-    pushRecords();
-  }
+  return act;
 }
 
 void CatchupQueue::onStorageTaskStopped(const ServerReadStream* stream) {
@@ -978,6 +1054,21 @@ void CatchupQueue::onReadLngTaskDone(ServerReadStream* stream) {
   pushRecords();
 }
 
+void CatchupQueue::onBatchedReadsStopped(const ReadStorageTask& task) {
+  for (const auto& batched : task.batched_tasks_) {
+    ServerReadStream* stream = batched->stream_.get().get();
+    if (stream != nullptr) {
+      ld_check(stream->storage_task_in_flight_);
+      stream->storage_task_in_flight_ = false;
+    }
+  }
+}
+
+void CatchupQueue::onReadTaskDropped(const ReadStorageTask& task) {
+  onBatchedReadsStopped(task);
+  onStorageTaskDropped(task.stream_.get().get());
+}
+
 void CatchupQueue::onStorageTaskDropped(ServerReadStream* stream) {
   catchup_queue_ld_debug("Storage task dropped");
   onStorageTaskStopped(stream);
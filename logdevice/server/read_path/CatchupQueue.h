@@ -27,6 +27,7 @@
 #include "logdevice/common/protocol/STARTED_Message.h"
 #include "logdevice/common/types_internal.h"
 #include "logdevice/include/types.h"
+#include "logdevice/server/read_path/CatchupOneStream.h"
 #include "logdevice/server/read_path/ReadIoShapingCallback.h"
 #include "logdevice/server/read_path/ServerReadStream.h"
 
@@ -256,6 +257,14 @@ class CatchupQueue {
    */
   void onReadTaskDone(const ReadStorageTask& task);
 
+  /**
+   * Called by CatchupOneStream to issue a ReadStorageTask. While pushRecords()
+   * is batching reads, the task is held and sent along with the reads of
+   * other streams once pushRecords() is done. Otherwise it is sent right away.
+   */
+  void putStorageTask(std::unique_ptr<ReadStorageTask>&& task,
+                      shard_index_t shard);
+
   /**
    * Called after a ReadLngTask completes on a storage thread.
    */
@@ -266,6 +275,12 @@ class CatchupQueue {
    */
   void onStorageTaskDropped(ServerReadStream* stream);
 
+  /**
+   * Called after a ReadStorageTask is dropped. Also clears the state of the
+   * streams whose reads were batched with it.
+   */
+  void onReadTaskDropped(const ReadStorageTask& task);
+
   /**
    * Adds a read stream to the queue. Depending on the mode argument, the
    * stream will be processed either next time pushRecords() runs, or only
@@ -322,9 +337,20 @@ class CatchupQueue {
   size_t record_bytes_queued_ = 0;
 
   // Is there a storage task in flight for this catchup queue?  We only allow
-  // one at a time.
+  // one at a time. It may carry the reads of several streams, see
+  // --max-read-streams-per-storage-task.
   bool storage_task_in_flight_ = false;
 
+  // True while pushRecords() collects the ReadStorageTasks of several streams
+  // into read_batch_.
+  bool batching_reads_ = false;
+
+  // ReadStorageTask created during the current pushRecords() call. Reads of
+  // other streams on the same shard are added to its batched_tasks_. Sent
+  // at the end of pushRecords().
+  std::unique_ptr<ReadStorageTask> read_batch_;
+  shard_index_t read_batch_shard_ = -1;
+
   // If true, try a non-blocking read on the worker thread before involving a
   // storage thread.  This is only disabled in tests.
   bool try_non_blocking_read_ = true;
@@ -352,6 +378,23 @@ class CatchupQueue {
 
   void onStorageTaskStopped(const ServerReadStream* stream);
 
+  /**
+   * Processes the result of a read on behalf of @param stream, which was
+   * either the head of a ReadStorageTask or batched with it.
+   *
+   * @return the action CatchupOneStream returned for the stream. Except for
+   *         TRANSIENT_ERROR and WAIT_FOR_BANDWIDTH, it has been handled.
+   */
+  CatchupOneStream::Action processReadTaskResult(ServerReadStream* stream,
+                                                 const ReadStorageTask& task);
+
+  // Sends read_batch_, if any.
+  void flushReadBatch();
+
+  // Clears storage_task_in_flight_ of the streams whose reads were batched
+  // with @param task.
+  void onBatchedReadsStopped(const ReadStorageTask& task);
+
   /**
    * Handle Read Throttling related credits and stats,
    * should be called upon read storage task completion.
@@ -55,6 +55,29 @@ static Status maybeSendRecord(LocalLogStore::ReadIterator& read_iterator,
   return E::OK;
 }
 
+// Passes the records that the last seek() or next() skipped based on their
+// filterable key to the callback, and moves the read pointer past them.
+static Status processKeyFilteredRecords(Callback& callback,
+                                        ReadContext* read_ctx) {
+  auto& lsns = read_ctx->it_stats_.key_filtered_lsns;
+  SCOPE_EXIT {
+    lsns.clear();
+  };
+  for (lsn_t lsn : lsns) {
+    if (lsn < read_ctx->read_ptr_.lsn) {
+      continue;
+    }
+    if (callback.processFilteredOut(lsn) != 0) {
+      if (err != E::CBREGISTERED) {
+        err = E::ABORTED;
+      }
+      return err;
+    }
+    read_ctx->read_ptr_ = {std::min(lsn, LSN_MAX - 1) + 1};
+  }
+  return E::OK;
+}
+
 Status readImpl(LocalLogStore::ReadIterator& read_iterator,
                 Callback& callback,
                 ReadContext* read_ctx,
@@ -114,6 +137,9 @@ Status readImpl(LocalLogStore::ReadIterator& read_iterator,
     STAT_ADD(stats,
              read_streams_num_csi_entries_sent,
              read_ctx->it_stats_.sent_csi_entries);
+    STAT_ADD(stats,
+             read_streams_num_records_key_filtered,
+             read_ctx->it_stats_.key_filtered_records);
     STAT_ADD(stats, read_streams_block_bytes_read, block_bytes_read);
   };
 
@@ -131,6 +157,15 @@ Status readImpl(LocalLogStore::ReadIterator& read_iterator,
        read_iterator.next(&*read_ctx->lls_filter_, &read_ctx->it_stats_)) {
     IteratorState state = read_iterator.state();
 
+    // Records skipped by the iterator based on their filterable key still
+    // need to be reported to the client.
+    if (!read_ctx->it_stats_.key_filtered_lsns.empty()) {
+      Status st = processKeyFilteredRecords(callback, read_ctx);
+      if (st != E::OK) {
+        return st;
+      }
+    }
+
     // Advance read pointer.
     if (state == IteratorState::AT_RECORD ||
         state == IteratorState::LIMIT_REACHED) {
@@ -49,11 +49,13 @@ class RawRecord : boost::noncopyable {
   RawRecord(lsn_t lsn,
             Slice blob,
             bool owned,
-            bool from_under_replicated_region = false)
+            bool from_under_replicated_region = false,
+            bool filtered_out = false)
       : lsn(lsn),
         blob(blob),
         owned(owned),
-        from_under_replicated_region(from_under_replicated_region) {}
+        from_under_replicated_region(from_under_replicated_region),
+        filtered_out(filtered_out) {}
 
   ~RawRecord() {
     if (owned) {
@@ -65,17 +67,22 @@ class RawRecord : boost::noncopyable {
       : lsn(other.lsn),
         blob(other.blob),
         owned(other.owned),
-        from_under_replicated_region(other.from_under_replicated_region) {
+        from_under_replicated_region(other.from_under_replicated_region),
+        filtered_out(other.filtered_out) {
     other.lsn = LSN_INVALID;
     other.blob = Slice();
     other.owned = false;
     other.from_under_replicated_region = false;
+    other.filtered_out = false;
   }
 
   lsn_t lsn;
   Slice blob;
   bool owned;
   bool from_under_replicated_region;
+  // The record didn't pass server-side filtering and was skipped without
+  // being read, see Callback::processFilteredOut(). blob is empty.
+  bool filtered_out;
 };
 
 namespace LocalLogStoreReader {
@@ -210,6 +217,17 @@ class Callback {
    */
   virtual int processRecord(const RawRecord& record) = 0;
 
+  /**
+   * Called for a record that the iterator skipped without reading it because
+   * the key in its copyset index entry didn't pass the server-side filter
+   * (see LocalLogStore::ReadFilter::shouldProcessFilterableKey()). Calls are
+   * interleaved with processRecord() in LSN order. Same return value as
+   * processRecord().
+   */
+  virtual int processFilteredOut(lsn_t /* lsn */) {
+    return 0;
+  }
+
   virtual ~Callback() {}
 };
 
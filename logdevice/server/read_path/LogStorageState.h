@@ -324,12 +324,19 @@ class LogStorageState {
   const shard_index_t shard_;
   LogStorageStateMap* const owner_;
 
+  // The fields below, up to last_clean_epoch_, are read on every STORE,
+  // RELEASE and read. They are kept together so that they span as few cache
+  // lines as possible.
+
   // The last released LSN for the log. Updated when a global RELEASE message
   // is received from the log's sequencer. Read by CatchupQueue when reading
   // from the local log store. Anything up to the last released LSN can be
   // safely read.
   LastReleasedLSN last_released_lsn_{};
 
+  // Lock to protect `last_released_lsn_`
+  mutable folly::SharedMutex lsn_mutex_;
+
   // Set to true if a permanent error was encountered and this LogStorageState
   // likely will never be fully up-to-date. If true, we should avoid creating
   // ServerReadStreams for this log because they are likely to get stuck waiting
@@ -354,10 +361,6 @@ class LogStorageState {
   // (LNG) of its epoch.
   std::atomic<lsn_t> last_per_epoch_released_lsn_{LSN_INVALID};
 
-  // Is there a GetSeqStateRequest inflight for this log?  If so, we avoid
-  // creating new ones until it comes back.
-  std::atomic<bool> get_seq_state_inflight_{false};
-
   // Trim point of log.  Allows the local log store to delete trimmed
   // records and read paths to recognize that records are missing
   // because of trimming. All records up to (and including) this LSN
@@ -388,6 +391,10 @@ class LogStorageState {
   // Initialized by reading the value from the local log store.
   std::atomic<epoch_t::raw_type> last_clean_epoch_{EPOCH_INVALID.val_};
 
+  // Is there a GetSeqStateRequest inflight for this log?  If so, we avoid
+  // creating new ones until it comes back.
+  std::atomic<bool> get_seq_state_inflight_{false};
+
   // subscribed to broadcasts of RELEASE messages.  These workers are
   // notified, for example, when a new record is released for delivery.
   folly::ConcurrentBitSet<MAX_WORKERS> subscribed_workers_;
@@ -426,8 +433,6 @@ class LogStorageState {
     std::bitset<MAX_WORKERS> failed_workers_;
   } retry_release_;
 
-  // Lock to protect `last_released_lsn_`
-  mutable folly::SharedMutex lsn_mutex_;
   /**
    * Callback for timer to retry sending a ReleaseRequest to workers that we
    * failed to post to because their Request pipes were full.
@@ -0,0 +1,143 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/read_path/LogStorageStateIndex.h"
+
+namespace facebook { namespace logdevice {
+
+constexpr logid_t::raw_type LogStorageStateIndex::EMPTY_KEY;
+constexpr size_t LogStorageStateIndex::NUM_STRIPES_BITS;
+constexpr size_t LogStorageStateIndex::NUM_STRIPES;
+constexpr size_t LogStorageStateIndex::MIN_TABLE_SIZE;
+
+LogStorageStateIndex::LogStorageStateIndex() {
+  for (Stripe& stripe : stripes_) {
+    resetStripe(stripe);
+  }
+}
+
+LogStorageStateIndex::~LogStorageStateIndex() {
+  clear();
+}
+
+LogStorageState* LogStorageStateIndex::find(logid_t log_id) const {
+  const uint64_t h = hash(log_id.val_);
+  const Stripe& stripe = stripeFor(h);
+  const Table* table = stripe.table.load(std::memory_order_acquire);
+  while (true) {
+    LogStorageState* state = findInTable(*table, log_id.val_, h);
+    if (state != nullptr) {
+      return state;
+    }
+    // The log may have been inserted into a larger table that replaced the
+    // one we looked at.
+    const Table* current = stripe.table.load(std::memory_order_acquire);
+    if (current == table) {
+      return nullptr;
+    }
+    table = current;
+  }
+}
+
+LogStorageState*
+LogStorageStateIndex::insert(logid_t log_id,
+                             std::unique_ptr<LogStorageState> state) {
+  ld_check(log_id.val_ != EMPTY_KEY);
+  ld_check(state != nullptr);
+  const uint64_t h = hash(log_id.val_);
+  Stripe& stripe = stripeFor(h);
+
+  std::lock_guard<std::mutex> lock(stripe.mutex);
+  Table* table = stripe.table.load(std::memory_order_relaxed);
+  LogStorageState* existing = findInTable(*table, log_id.val_, h);
+  if (existing != nullptr) {
+    return existing;
+  }
+
+  // Keep the load factor at most 1/2 so that probe sequences stay short and
+  // there is always an empty slot to stop lookups of missing logs.
+  if ((stripe.size + 1) * 2 > table->size()) {
+    table = grow(stripe);
+  }
+  LogStorageState* inserted = state.release();
+  placeInTable(*table, log_id.val_, h, inserted);
+  ++stripe.size;
+  return inserted;
+}
+
+void LogStorageStateIndex::clear() {
+  for (Stripe& stripe : stripes_) {
+    Table* table = stripe.table.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < table->size(); ++i) {
+      delete table->slots[i].state.load(std::memory_order_relaxed);
+    }
+    resetStripe(stripe);
+  }
+}
+
+LogStorageState* LogStorageStateIndex::findInTable(const Table& table,
+                                                   logid_t::raw_type key,
+                                                   uint64_t h) {
+  // The low bits of the hash select the stripe, use the others for the slot.
+  for (size_t i = (h >> NUM_STRIPES_BITS) & table.mask;;
+       i = (i + 1) & table.mask) {
+    const Slot& slot = table.slots[i];
+    const logid_t::raw_type slot_key = slot.key.load(std::memory_order_acquire);
+    if (slot_key == key) {
+      return slot.state.load(std::memory_order_relaxed);
+    }
+    if (slot_key == EMPTY_KEY) {
+      return nullptr;
+    }
+  }
+}
+
+void LogStorageStateIndex::placeInTable(Table& table,
+                                        logid_t::raw_type key,
+                                        uint64_t h,
+                                        LogStorageState* state) {
+  for (size_t i = (h >> NUM_STRIPES_BITS) & table.mask;;
+       i = (i + 1) & table.mask) {
+    Slot& slot = table.slots[i];
+    if (slot.key.load(std::memory_order_relaxed) == EMPTY_KEY) {
+      slot.state.store(state, std::memory_order_relaxed);
+      slot.key.store(key, std::memory_order_release);
+      return;
+    }
+    ld_check(slot.key.load(std::memory_order_relaxed) != key);
+  }
+}
+
+LogStorageStateIndex::Table* LogStorageStateIndex::grow(Stripe& stripe) {
+  const Table& old_table = *stripe.tables.back();
+  auto new_table = std::make_unique<Table>(old_table.size() * 2);
+  for (size_t i = 0; i < old_table.size(); ++i) {
+    const Slot& slot = old_table.slots[i];
+    const logid_t::raw_type key = slot.key.load(std::memory_order_relaxed);
+    if (key != EMPTY_KEY) {
+      placeInTable(*new_table,
+                   key,
+                   hash(key),
+                   slot.state.load(std::memory_order_relaxed));
+    }
+  }
+  Table* table = new_table.get();
+  // Lookups still probing the old table retry on the new one if they don't
+  // find their log, see find(). The old table is freed with the index.
+  stripe.tables.push_back(std::move(new_table));
+  stripe.table.store(table, std::memory_order_release);
+  return table;
+}
+
+void LogStorageStateIndex::resetStripe(Stripe& stripe) {
+  stripe.tables.clear();
+  stripe.tables.push_back(std::make_unique<Table>(MIN_TABLE_SIZE));
+  stripe.table.store(stripe.tables.back().get(), std::memory_order_release);
+  stripe.size = 0;
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,173 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "logdevice/common/checks.h"
+#include "logdevice/common/types_internal.h"
+#include "logdevice/include/types.h"
+#include "logdevice/server/read_path/LogStorageState.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file
+ * Index of the LogStorageState instances of one shard, used by
+ * LogStorageStateMap. It is consulted on every STORE, RELEASE, read stream
+ * start and purge, so lookups need to be cheap even with millions of logs.
+ *
+ * The index is split into stripes by hash of the log id. Each stripe is an
+ * open-addressing table with linear probing whose slots hold the log id and a
+ * pointer to the LogStorageState, so a lookup touches one or two cache lines
+ * of the table before reaching the state itself.
+ *
+ * Lookups are lock-free. Insertions lock the stripe. When a stripe's table
+ * gets half full it is copied into a table twice as large; the old table is
+ * kept until the index is destroyed since lookups may still be probing it.
+ * That at most doubles the memory used by the tables.
+ *
+ * LogStorageState instances are owned by the index and never move or get
+ * freed before clear() or destruction, so pointers to them remain valid.
+ */
+
+class LogStorageStateIndex {
+ public:
+  LogStorageStateIndex();
+  ~LogStorageStateIndex();
+
+  LogStorageStateIndex(const LogStorageStateIndex&) = delete;
+  LogStorageStateIndex& operator=(const LogStorageStateIndex&) = delete;
+
+  /**
+   * Finds the state object for the given log. Returns nullptr if it does not
+   * exist. Lock-free.
+   */
+  LogStorageState* find(logid_t log_id) const;
+
+  /**
+   * Inserts @param state for the given log unless the log already has one,
+   * in which case @param state is destroyed.
+   *
+   * @return the state object that ended up in the index.
+   */
+  LogStorageState* insert(logid_t log_id,
+                          std::unique_ptr<LogStorageState> state);
+
+  /**
+   * Calls @param func for each state in the index, in no particular order.
+   * States inserted concurrently may or may not be visited. Stops and returns
+   * -1 as soon as func returns non-zero, otherwise returns 0.
+   *
+   * @param func A callable with signature int(logid_t, LogStorageState&).
+   */
+  template <typename Func>
+  int forEach(const Func& func) const;
+
+  /**
+   * Destroys all states. Not thread-safe, used in tests.
+   */
+  void clear();
+
+ private:
+  // Log id stored in empty slots. Not a valid log id.
+  static constexpr logid_t::raw_type EMPTY_KEY =
+      std::numeric_limits<logid_t::raw_type>::max();
+
+  static constexpr size_t NUM_STRIPES_BITS = 6;
+  static constexpr size_t NUM_STRIPES = 1ul << NUM_STRIPES_BITS;
+  static constexpr size_t MIN_TABLE_SIZE = 16;
+
+  struct Slot {
+    // Written after `state`, with release semantics, so that a lookup that
+    // finds the key also sees the state.
+    std::atomic<logid_t::raw_type> key{EMPTY_KEY};
+    std::atomic<LogStorageState*> state{nullptr};
+  };
+
+  struct Table {
+    explicit Table(size_t size) : mask(size - 1), slots(new Slot[size]) {
+      ld_check((size & mask) == 0);
+    }
+
+    size_t size() const {
+      return mask + 1;
+    }
+
+    const size_t mask;
+    std::unique_ptr<Slot[]> slots;
+  };
+
+  struct alignas(64) Stripe {
+    // Table used by lookups and insertions.
+    std::atomic<Table*> table{nullptr};
+    // Protects everything below and insertions into `table`.
+    std::mutex mutex;
+    // Number of states in `table`.
+    size_t size{0};
+    // All tables this stripe ever had, the current one last.
+    std::vector<std::unique_ptr<Table>> tables;
+  };
+
+  static uint64_t hash(logid_t::raw_type key) {
+    return Hash64<logid_t::raw_type>()(key);
+  }
+
+  const Stripe& stripeFor(uint64_t h) const {
+    return stripes_[h & (NUM_STRIPES - 1)];
+  }
+
+  Stripe& stripeFor(uint64_t h) {
+    return stripes_[h & (NUM_STRIPES - 1)];
+  }
+
+  static LogStorageState*
+  findInTable(const Table& table, logid_t::raw_type key, uint64_t h);
+
+  // Puts the key in the first empty slot of its probe sequence. The key must
+  // not be in the table already and the table must have an empty slot.
+  static void placeInTable(Table& table,
+                           logid_t::raw_type key,
+                           uint64_t h,
+                           LogStorageState* state);
+
+  // Replaces the stripe's table with one twice as large. Must be called with
+  // the stripe locked.
+  static Table* grow(Stripe& stripe);
+
+  static void resetStripe(Stripe& stripe);
+
+  std::array<Stripe, NUM_STRIPES> stripes_;
+};
+
+template <typename Func>
+int LogStorageStateIndex::forEach(const Func& func) const {
+  for (const Stripe& stripe : stripes_) {
+    const Table* table = stripe.table.load(std::memory_order_acquire);
+    for (size_t i = 0; i < table->size(); ++i) {
+      const Slot& slot = table->slots[i];
+      const logid_t::raw_type key = slot.key.load(std::memory_order_acquire);
+      if (key == EMPTY_KEY) {
+        continue;
+      }
+      LogStorageState* state = slot.state.load(std::memory_order_relaxed);
+      ld_check(state != nullptr);
+      if (func(logid_t(key), *state) != 0) {
+        return -1;
+      }
+    }
+  }
+  return 0;
+}
+
+}} // namespace facebook::logdevice
@@ -14,6 +14,7 @@
 #include "logdevice/common/debug.h"
 #include "logdevice/common/util.h"
 #include "logdevice/include/Err.h"
+#include "logdevice/server/RecordCache.h"
 #include "logdevice/server/RecordCacheDisposal.h"
 #include "logdevice/server/ServerProcessor.h"
 
@@ -21,46 +22,51 @@ namespace facebook { namespace logdevice {
 
 LogStorageState* LogStorageStateMap::insertOrGet(logid_t log_id,
                                                  shard_index_t shard_idx) {
-  Map& map = *shard_map_[shard_idx];
+  ld_check(shard_idx < shard_map_.size());
+  LogStorageStateIndex& index = *shard_map_[shard_idx];
 
   // First try a lookup to avoid memory allocation in the common case
-  auto it = map.find(log_id.val_);
-  if (it != map.cend()) {
-    return it->second.get();
+  LogStorageState* existing = index.find(log_id);
+  if (existing != nullptr) {
+    return existing;
   }
 
   // No state for this log yet.
-  auto insert_result =
-      map.emplace(log_id.val(),
-                  std::make_unique<LogStorageState>(
-                      log_id, shard_idx, this, cache_disposal_.get()));
-
+  auto state = std::make_unique<LogStorageState>(
+      log_id, shard_idx, this, cache_disposal_.get());
+  if (record_cache_files_ != nullptr) {
+    // Nothing can have touched the log on this shard without creating its
+    // LogStorageState first, so the cache persisted by the previous instance
+    // is still up to date. If another thread inserts a state first, the
+    // restored cache is dropped, which is fine: it's only an optimization.
+    std::unique_ptr<RecordCache> restored =
+        record_cache_files_->restore(log_id, shard_idx, cache_disposal_.get());
+    if (restored != nullptr) {
+      state->record_cache_ = std::move(restored);
+    }
+  }
   // Whether or not we were the ones to insert or some other thread beat us
   // to it, return a pointer to whatever ended up in the map.
-  return insert_result.first->second.get();
+  return index.insert(log_id, std::move(state));
 }
 
 LogStorageState* LogStorageStateMap::find(logid_t log_id,
                                           shard_index_t shard_idx) {
   ld_check(shard_idx < shard_map_.size());
-  Map& map = *shard_map_[shard_idx];
-  auto it = map.find(log_id.val_);
-  return it != map.cend() ? it->second.get() : nullptr;
+  return shard_map_[shard_idx]->find(log_id);
 }
 
 LogStorageState& LogStorageStateMap::get(logid_t log_id,
                                          shard_index_t shard_idx) {
   ld_check(shard_idx < shard_map_.size());
-  Map& map = *shard_map_[shard_idx];
-  auto it = map.find(log_id.val_);
-  ld_check(it != map.cend());
-  return *(it->second);
+  LogStorageState* state = shard_map_[shard_idx]->find(log_id);
+  ld_check(state != nullptr);
+  return *state;
 }
 
 void LogStorageStateMap::clear() {
   for (shard_index_t s = 0; s < num_shards_; ++s) {
-    Map& map = *shard_map_[s];
-    map.clear();
+    shard_map_[s]->clear();
   }
 }
 
@@ -91,13 +97,10 @@ LogStorageStateMap::ReleaseStates
 LogStorageStateMap::getAllLastReleasedLSNs(shard_index_t shard) const {
   ReleaseStates states;
 
-  for (auto entry = shard_map_[shard]->cbegin();
-       entry != shard_map_[shard]->cend();
-       ++entry) {
-    LogStorageState::LastReleasedLSN last_released =
-        entry->second->getLastReleasedLSN();
-    states.emplace_back(logid_t(entry->first), last_released.value());
-  }
+  shard_map_[shard]->forEach([&](logid_t log_id, LogStorageState& state) {
+    states.emplace_back(log_id, state.getLastReleasedLSN().value());
+    return 0;
+  });
 
   return states;
 }
@@ -120,12 +123,12 @@ void LogStorageStateMap::shutdownRecordCaches() {
     return;
   }
   for (shard_index_t i = 0; i < num_shards_; ++i) {
-    for (auto entry = shard_map_[i]->cbegin(); entry != shard_map_[i]->cend();
-         ++entry) {
-      if (entry->second->record_cache_ != nullptr) {
-        entry->second->record_cache_->shutdown();
+    shard_map_[i]->forEach([](logid_t, LogStorageState& state) {
+      if (state.record_cache_ != nullptr) {
+        state.record_cache_->shutdown();
       }
-    }
+      return 0;
+    });
   }
 }
 
@@ -147,6 +150,10 @@ void LogStorageStateMap::setProcessor(ServerProcessor* processor) {
     if (processor->runningOnStorageNode()) {
       // only starts the record cache monitor thread if record cache
       // is enabled
+      if (processor->settings()->persist_record_caches_to_file) {
+        record_cache_files_ =
+            std::make_unique<RecordCacheFileStore>(num_shards_, stats_);
+      }
       record_cache_monitor_ =
           std::make_unique<RecordCacheMonitorThread>(processor);
     }
@@ -157,12 +164,12 @@ StatsHolder* LogStorageStateMap::getStats() {
   return stats_;
 }
 
-std::vector<std::unique_ptr<LogStorageStateMap::Map>>
+std::vector<std::unique_ptr<LogStorageStateIndex>>
 LogStorageStateMap::makeMap(shard_size_t num_shards) {
-  std::vector<std::unique_ptr<Map>> ret;
+  std::vector<std::unique_ptr<LogStorageStateIndex>> ret;
 
   for (shard_index_t s = 0; s < num_shards; ++s) {
-    ret.push_back(std::make_unique<Map>());
+    ret.push_back(std::make_unique<LogStorageStateIndex>());
   }
 
   return ret;
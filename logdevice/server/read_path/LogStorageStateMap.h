@@ -12,15 +12,15 @@
 #include <memory>
 #include <vector>
 
-#include <folly/concurrency/ConcurrentHashMap.h>
-
 #include "logdevice/common/types_internal.h"
 #include "logdevice/common/util.h"
 #include "logdevice/include/Err.h"
 #include "logdevice/include/types.h"
 #include "logdevice/server/RecordCacheDisposal.h"
+#include "logdevice/server/RecordCacheFileStore.h"
 #include "logdevice/server/RecordCacheMonitorThread.h"
 #include "logdevice/server/read_path/LogStorageState.h"
+#include "logdevice/server/read_path/LogStorageStateIndex.h"
 
 namespace facebook { namespace logdevice {
 
@@ -34,7 +34,6 @@ class LogStorageStateMap {
  public:
   /**
    * @param num_shards         Number of shards on this node
-   *                           map, required by AtomicHashMap
    * @param recovery_interval  interval between consecutive attempts to recover
    *                           log state
    */
@@ -158,6 +157,14 @@ class LogStorageStateMap {
   template <typename Func>
   int forEachLogOnShard(shard_index_t shard, const Func& func) const;
 
+  /**
+   * Record cache files of all shards, nullptr unless record caches are
+   * persisted to files (see RecordCacheFileStore.h).
+   */
+  RecordCacheFileStore* getRecordCacheFileStore() {
+    return record_cache_files_.get();
+  }
+
   // May be nullptr in tests.
   ServerProcessor* getProcessor();
   void setProcessor(ServerProcessor*);
@@ -176,18 +183,20 @@ class LogStorageStateMap {
   // initialization.
   ServerProcessor* processor_;
 
-  // use Hash64 to mitigate the effect of logid (data and metadata) collision
-  using Map = folly::ConcurrentHashMap<logid_t::raw_type,
-                                       std::unique_ptr<LogStorageState>,
-                                       Hash64<logid_t::raw_type>>;
+  // One index per shard, see LogStorageStateIndex.h.
+  const std::vector<std::unique_ptr<LogStorageStateIndex>> shard_map_;
 
-  const std::vector<std::unique_ptr<Map>> shard_map_;
-
-  static std::vector<std::unique_ptr<Map>> makeMap(shard_size_t num_shards);
+  static std::vector<std::unique_ptr<LogStorageStateIndex>>
+  makeMap(shard_size_t num_shards);
 
   // Attempt to recover log state only once this many usecs.
   std::chrono::microseconds state_recovery_interval_;
 
+  // Restores record caches persisted by the previous instance when a
+  // LogStorageState is created, see getRecordCacheFileStore(). Used by
+  // record_cache_monitor_, hence declared before it.
+  std::unique_ptr<RecordCacheFileStore> record_cache_files_;
+
   /**
    * A background thread for monitoring record cache size and perform eviction
    * if needed.
@@ -200,15 +209,10 @@ template <typename Func>
 int LogStorageStateMap::forEachLogOnShard(shard_index_t shard,
                                           const Func& func) const {
   ld_check(shard < shard_map_.size());
-  for (auto kv = shard_map_[shard]->cbegin(); kv != shard_map_[shard]->cend();
-       ++kv) {
-    if (kv->second != nullptr) {
-      if (func(logid_t(kv->first), *kv->second) != 0) {
-        return -1;
-      }
-    }
-  }
-  return 0;
+  return shard_map_[shard]->forEach(
+      [&](logid_t log_id, const LogStorageState& state) {
+        return func(log_id, state);
+      });
 }
 
 template <typename Func>
@@ -522,8 +522,9 @@ class ServerReadStream : boost::noncopyable {
   folly::Optional<std::pair<epoch_t, OffsetMap>> epoch_offsets_ = folly::none;
 
   // ServerRecordFilter used to filter out record. It will be constructed
-  // by ServerRecordFilterFactory.
-  std::unique_ptr<ServerRecordFilter> filter_pred_;
+  // by ServerRecordFilterFactory. Shared with the LocalLogStoreReadFilter of
+  // reads so that records can be filtered based on the copyset index.
+  std::shared_ptr<ServerRecordFilter> filter_pred_;
 
   // The location of the client reader.
   // Only used if local_scd_enabled_ is set to true.
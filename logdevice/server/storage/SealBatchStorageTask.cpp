@@ -0,0 +1,68 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/storage/SealBatchStorageTask.h"
+
+#include "logdevice/server/ServerProcessor.h"
+#include "logdevice/server/read_path/LogStorageStateMap.h"
+#include "logdevice/server/storage_tasks/StorageThreadPool.h"
+
+namespace facebook { namespace logdevice {
+
+SealBatchStorageTask::SealBatchStorageTask(
+    std::vector<std::unique_ptr<SealStorageTask>> tasks)
+    : StorageTask(StorageTask::Type::SEAL_BATCH), tasks_(std::move(tasks)) {
+  ld_check(!tasks_.empty());
+}
+
+void SealBatchStorageTask::setTasksStorageThreadPool() {
+  ld_check(storageThreadPool_);
+  for (auto& task : tasks_) {
+    task->setStorageThreadPool(storageThreadPool_);
+  }
+}
+
+void SealBatchStorageTask::execute() {
+  setTasksStorageThreadPool();
+  std::vector<SealStorageTask*> tasks;
+  tasks.reserve(tasks_.size());
+  for (auto& task : tasks_) {
+    tasks.push_back(task.get());
+  }
+  SealStorageTask::executeBatch(
+      tasks,
+      storageThreadPool_->getLocalLogStore(),
+      storageThreadPool_->getProcessor().getLogStorageStateMap(),
+      storageThreadPool_->stats());
+}
+
+Durability SealBatchStorageTask::durability() const {
+  Durability max_durability = Durability::INVALID;
+  for (const auto& task : tasks_) {
+    Durability d = task->durability();
+    if (d != Durability::INVALID &&
+        (max_durability == Durability::INVALID || d > max_durability)) {
+      max_durability = d;
+    }
+  }
+  return max_durability;
+}
+
+void SealBatchStorageTask::onDone() {
+  for (auto& task : tasks_) {
+    task->onDone();
+  }
+}
+
+void SealBatchStorageTask::onDropped() {
+  setTasksStorageThreadPool();
+  for (auto& task : tasks_) {
+    task->onDropped();
+  }
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,51 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "logdevice/server/storage/SealStorageTask.h"
+#include "logdevice/server/storage_tasks/StorageTask.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file  Seals many logs of the same shard at once, on behalf of a SEAL_BATCH
+ *        message. Runs the SealStorageTasks of all the logs with
+ *        SealStorageTask::executeBatch(), so that the seals are written to
+ *        the local log store (and synced) once for the whole batch. Each log
+ *        still gets its own SEALED reply.
+ */
+
+class SealBatchStorageTask : public StorageTask {
+ public:
+  explicit SealBatchStorageTask(
+      std::vector<std::unique_ptr<SealStorageTask>> tasks);
+
+  void execute() override;
+
+  // The strongest durability of the tasks.
+  Durability durability() const override;
+
+  void onDone() override;
+  void onDropped() override;
+
+  StorageTaskPriority getPriority() const override {
+    return StorageTaskPriority::HIGH;
+  }
+
+ private:
+  // Gives the tasks access to the local log store, like StorageThreadPool
+  // does for tasks it's given directly.
+  void setTasksStorageThreadPool();
+
+  std::vector<std::unique_ptr<SealStorageTask>> tasks_;
+};
+
+}} // namespace facebook::logdevice
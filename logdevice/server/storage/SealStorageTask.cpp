@@ -71,6 +71,57 @@ shard_index_t SealStorageTask::getShardIdx() const {
 Status SealStorageTask::executeImpl(LocalLogStore& store,
                                     LogStorageStateMap& state_map,
                                     StatsHolder* stats) {
+  Status status;
+  if (!prepareSeal(store, state_map, stats, &status)) {
+    return status;
+  }
+
+  SealMetadata seal_metadata{seal_};
+  LocalLogStore::WriteOptions write_options;
+  int rv = store.updateLogMetadata(log_id_, seal_metadata, write_options);
+  return finishSeal(store, seal_metadata, rv == 0 ? E::OK : err, stats);
+}
+
+void SealStorageTask::executeBatch(const std::vector<SealStorageTask*>& tasks,
+                                   LocalLogStore& store,
+                                   LogStorageStateMap& state_map,
+                                   StatsHolder* stats) {
+  std::vector<SealStorageTask*> to_write;
+  std::vector<SealMetadata> seal_metadata;
+  to_write.reserve(tasks.size());
+  seal_metadata.reserve(tasks.size());
+  for (SealStorageTask* task : tasks) {
+    ld_check(task != nullptr);
+    if (task->prepareSeal(store, state_map, stats, &task->status_)) {
+      to_write.push_back(task);
+      seal_metadata.emplace_back(task->seal_);
+    }
+  }
+  if (to_write.empty()) {
+    return;
+  }
+
+  std::vector<std::pair<logid_t, ComparableLogMetadata*>> entries;
+  entries.reserve(to_write.size());
+  for (size_t i = 0; i < to_write.size(); ++i) {
+    entries.emplace_back(to_write[i]->log_id_, &seal_metadata[i]);
+  }
+  std::vector<Status> statuses;
+  LocalLogStore::WriteOptions write_options;
+  store.updateLogMetadataBatch(entries, statuses, write_options);
+  ld_check(statuses.size() == to_write.size());
+
+  for (size_t i = 0; i < to_write.size(); ++i) {
+    to_write[i]->status_ = to_write[i]->finishSeal(
+        store, seal_metadata[i], statuses[i], stats);
+  }
+}
+
+bool SealStorageTask::prepareSeal(LocalLogStore& store,
+                                  LogStorageStateMap& state_map,
+                                  StatsHolder* stats,
+                                  Status* status_out) {
+  ld_check(status_out != nullptr);
   // quickly check the current value of the seal to avoid reading LNGs if
   // E::PREEMPTED would be returned
 
@@ -81,12 +132,14 @@ Status SealStorageTask::executeImpl(LocalLogStore& store,
                     "Unable to update seal for log %lu: %s",
                     log_id_.val_,
                     error_description(err));
-    return E::FAILED;
+    *status_out = E::FAILED;
+    return false;
   }
 
   if (context_ == Context::PURGING) {
     // take a shortcut if we are in the purging context
-    return sealForPurging(store, log_state, stats);
+    *status_out = sealForPurging(store, log_state, stats);
+    return false;
   }
 
   folly::Optional<Seal> current_seal =
@@ -95,23 +148,30 @@ Status SealStorageTask::executeImpl(LocalLogStore& store,
   if (current_seal.has_value() && current_seal.value() > seal_) {
     // return the current value to the sequencer
     seal_ = current_seal.value();
-    return E::PREEMPTED;
+    *status_out = E::PREEMPTED;
+    return false;
   }
 
   // recover soft seal metadata before accessing the record cache, this could
   // increase the cache hit rate since the cache may have its last
   // nonauthoritative epoch initialized.
   recoverSoftSeals(store, log_state);
+  log_state_ = log_state;
+  return true;
+}
 
-  Status status = E::OK;
-  SealMetadata seal_metadata{seal_};
+Status SealStorageTask::finishSeal(LocalLogStore& store,
+                                   SealMetadata& seal_metadata,
+                                   Status update_status,
+                                   StatsHolder* stats) {
+  LogStorageState* log_state = log_state_;
+  ld_check(log_state != nullptr);
 
-  LocalLogStore::WriteOptions write_options;
-  int rv = store.updateLogMetadata(log_id_, seal_metadata, write_options);
-  if (rv != 0) {
+  Status status = E::OK;
+  if (update_status != E::OK) {
     ld_check(durability_ == Durability::INVALID);
 
-    if (err != E::UPTODATE) {
+    if (update_status != E::UPTODATE) {
       return E::FAILED;
     }
 
@@ -143,11 +203,12 @@ Status SealStorageTask::executeImpl(LocalLogStore& store,
   // stored in the local log store.
   seal_ = seal_metadata.seal_;
 
-  rv = log_state->updateSeal(
+  int rv = log_state->updateSeal(
       seal_metadata.seal_, LogStorageState::SealType::NORMAL);
   if (rv != 0) {
     // update seal_ to the updated value
-    current_seal = log_state->getSeal(LogStorageState::SealType::NORMAL);
+    folly::Optional<Seal> current_seal =
+        log_state->getSeal(LogStorageState::SealType::NORMAL);
     ld_check(current_seal.has_value());
     seal_ = current_seal.value();
     status = E::PREEMPTED;
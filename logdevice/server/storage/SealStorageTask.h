@@ -13,6 +13,7 @@
 #include <folly/Conv.h>
 
 #include "logdevice/common/Address.h"
+#include "logdevice/common/Metadata.h"
 #include "logdevice/common/OffsetMap.h"
 #include "logdevice/common/Seal.h"
 #include "logdevice/common/TailRecord.h"
@@ -103,11 +104,31 @@ class SealStorageTask : public StorageTask {
                      LogStorageStateMap& state_map,
                      StatsHolder* stats = nullptr);
 
+  /**
+   * Same as calling executeImpl() for each of the tasks, and setting their
+   * status, but writes the seals of all the logs to the local log store with
+   * one updateLogMetadataBatch() call. All tasks must be for the same shard.
+   * Used by SealBatchStorageTask.
+   */
+  static void executeBatch(const std::vector<SealStorageTask*>& tasks,
+                           LocalLogStore& store,
+                           LogStorageStateMap& state_map,
+                           StatsHolder* stats = nullptr);
+
   // expose seal_. used for testing
   Seal getSeal() const {
     return seal_;
   }
 
+  // expose status_. used for testing
+  Status getStatus() const {
+    return status_;
+  }
+
+  logid_t getLogID() const {
+    return log_id_;
+  }
+
   // get LNG values for all epochs in [last_clean_ + 1, seal_epoch_],
   // used to reply the SEAL message
   void getAllEpochInfo(std::vector<lsn_t>& epoch_lng,
@@ -145,6 +166,23 @@ class SealStorageTask : public StorageTask {
 
   EpochInfoSource epoch_info_source_{EpochInfoSource::INVALID};
 
+  // set by prepareSeal()
+  LogStorageState* log_state_{nullptr};
+
+  // executeImpl() is split in two around the write of the seal metadata, so
+  // that executeBatch() can write the seals of many logs at once.
+  // prepareSeal() returns false and sets *status_out if the task is done
+  // without writing the seal (e.g. it's preempted); otherwise the seal_ needs
+  // to be written, and finishSeal() called with the result of the write.
+  bool prepareSeal(LocalLogStore& store,
+                   LogStorageStateMap& state_map,
+                   StatsHolder* stats,
+                   Status* status_out);
+  Status finishSeal(LocalLogStore& store,
+                    SealMetadata& seal_metadata,
+                    Status update_status,
+                    StatsHolder* stats);
+
   // helper method that checks soft seals for preemption, may read metadata
   // from local logstore. updates seal_ if soft seal has a higher Seal record
   // for preemption
@@ -15,6 +15,7 @@
 #include "logdevice/common/stats/PerShardHistograms.h"
 #include "logdevice/common/stats/Stats.h"
 #include "logdevice/server/ServerProcessor.h"
+#include "logdevice/server/locallogstore/IOTracing.h"
 #include "logdevice/server/locallogstore/LocalLogStore.h"
 #include "logdevice/server/storage_tasks/StorageTask.h"
 #include "logdevice/server/storage_tasks/StorageTaskResponse.h"
@@ -22,6 +23,39 @@
 
 namespace facebook { namespace logdevice {
 
+namespace {
+
+// What the IO done by a storage task is attributed to by IO tracing.
+IOTraceContext ioTraceContextOf(StorageTaskType type) {
+  switch (type) {
+    case StorageTaskType::READ_METADATA_NORMAL:
+    case StorageTaskType::READ_METADATA_INTERNAL:
+    case StorageTaskType::READ_BACKLOG:
+    case StorageTaskType::READ_TAIL:
+    case StorageTaskType::READ_INTERNAL:
+      return IOTraceContext::READ_STREAM;
+    case StorageTaskType::FINDKEY:
+      return IOTraceContext::FINDTIME;
+    case StorageTaskType::REBUILDING_AMEND_SELF:
+    case StorageTaskType::REBUILDING_ENUMERATE_LOGS:
+    case StorageTaskType::REBUILDING_READ:
+    case StorageTaskType::REBUILDING_WRITE_COMPLETE_METADATA:
+    case StorageTaskType::REBUILDING_NOTE_RANGES_PUBLISHED:
+      return IOTraceContext::REBUILDING;
+    case StorageTaskType::STORE:
+    case StorageTaskType::WRITE_BATCH:
+      return IOTraceContext::WRITE;
+    case StorageTaskType::COMPACT_PARTITION:
+    case StorageTaskType::COMPACTION_THROTTLE_RETENTION:
+    case StorageTaskType::COMPACTION_THROTTLE_PARTIAL:
+      return IOTraceContext::COMPACTION;
+    default:
+      return IOTraceContext::OTHER;
+  }
+}
+
+} // namespace
+
 void ExecStorageThread::run() {
   pool_->getLocalLogStore().onStorageThreadStarted();
 
@@ -36,26 +70,39 @@ void ExecStorageThread::run() {
   SlowStorageTasksTracer slow_task_tracer{pool_->getTraceLogger()};
 
   while (shouldProcessTasks_) {
-    std::unique_ptr<StorageTask> task = pool_->blockingGetTask(thread_type_);
+    std::unique_ptr<StorageTask> task =
+        pool_->blockingGetTask(thread_type_, idx_);
     task->setStorageThread(this);
 
+    // Tasks stolen from another shard's pool are accounted to their own
+    // shard, not to the shard of this thread.
+    StorageThreadPool* task_pool =
+        task->getStorageThreadPool() ? task->getStorageThreadPool() : pool_;
+
     // Maintain stats for queueing latency.
     auto queueing_usec = usec_since(task->enqueue_time_);
     if (task->reply_shard_idx_ != -1) {
       PER_SHARD_HISTOGRAM_ADD(
-          pool_->stats(),
+          task_pool->stats(),
           storage_threads_queue_time[static_cast<int>(thread_type_)],
           task->reply_shard_idx_,
           queueing_usec);
       PER_SHARD_HISTOGRAM_ADD(
-          pool_->stats(),
+          task_pool->stats(),
           storage_task_queue_time[static_cast<int>(task->getType())],
           task->reply_shard_idx_,
           queueing_usec);
     }
 
     auto execution_start_time = std::chrono::steady_clock::now();
-    task->execute();
+    {
+      // A stolen task does IO on its own shard's store, so that's the
+      // IOTracing that needs to know what the IO is for.
+      SCOPED_IO_TRACING_CONTEXT_TYPE(
+          task_pool->getLocalLogStore().getIOTracing(),
+          ioTraceContextOf(task->getType()));
+      task->execute();
+    }
     auto execution_end_time = std::chrono::steady_clock::now();
     auto usec = SystemTimestamp(execution_end_time - execution_start_time)
                     .toMicroseconds()
@@ -63,17 +110,17 @@ void ExecStorageThread::run() {
 
     // Node avg. stats.
     STORAGE_TASK_TYPE_STAT_INCR(
-        pool_->stats(), task->getType(), storage_tasks_executed);
+        task_pool->stats(), task->getType(), storage_tasks_executed);
     STORAGE_TASK_TYPE_STAT_ADD(
-        pool_->stats(), task->getType(), storage_thread_usec, usec);
+        task_pool->stats(), task->getType(), storage_thread_usec, usec);
     STORAGE_TASK_TYPE_STAT_ADD(
-        pool_->stats(), task->getType(), storage_q_usec, queueing_usec);
+        task_pool->stats(), task->getType(), storage_q_usec, queueing_usec);
 
     // Maintaining stats for execution latency.
     if (task->reply_shard_idx_ != -1) {
       if (task->getType() != StorageTask::Type::UNKNOWN) {
         PER_SHARD_HISTOGRAM_ADD(
-            pool_->stats(),
+            task_pool->stats(),
             storage_tasks[static_cast<int>(task->getType())],
             task->reply_shard_idx_,
             usec);
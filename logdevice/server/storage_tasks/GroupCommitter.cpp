@@ -0,0 +1,172 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/storage_tasks/GroupCommitter.h"
+
+#include <algorithm>
+
+#include "logdevice/common/debug.h"
+#include "logdevice/common/stats/Stats.h"
+#include "logdevice/server/locallogstore/LocalLogStore.h"
+
+namespace facebook { namespace logdevice {
+
+using namespace std::chrono;
+
+GroupCommitter::GroupCommitter(LocalLogStore* store,
+                               UpdateableSettings<Settings> settings,
+                               StatsHolder* stats)
+    : store_(store), settings_(std::move(settings)), stats_(stats) {
+  ld_check(store_ != nullptr);
+}
+
+void GroupCommitter::closeOpenGroup() {
+  ld_check(open_group_);
+  open_group_->closed = true;
+  open_group_.reset();
+  group_closed_cv_.notify_all();
+}
+
+int GroupCommitter::commit(const std::vector<const WriteOp*>& write_ops,
+                           bool sync,
+                           bool* synced) {
+  ld_check(synced != nullptr);
+  const size_t max_ops = settings_->write_group_commit_max_ops;
+
+  Member me;
+  me.write_ops = &write_ops;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (open_group_ && open_group_->nops + write_ops.size() <= max_ops) {
+    // Join the open group and wait for its leader to write it.
+    open_group_->members.push_back(&me);
+    open_group_->nops += write_ops.size();
+    open_group_->sync |= sync;
+    if (open_group_->nops >= max_ops) {
+      closeOpenGroup();
+    }
+    lock.unlock();
+
+    me.done.wait();
+    *synced = me.synced;
+    if (me.rv != 0) {
+      err = me.status;
+    }
+    return me.rv;
+  }
+
+  // Become the leader of a new group. If there's an open group that we don't
+  // fit in, it's as full as it's going to get.
+  if (open_group_) {
+    closeOpenGroup();
+  }
+  auto group = std::make_shared<Group>();
+  group->members.push_back(&me);
+  group->nops = write_ops.size();
+  group->sync = sync;
+  if (group->nops < max_ops) {
+    open_group_ = group;
+  } else {
+    group->closed = true;
+  }
+  lock.unlock();
+
+  const auto wait_start = steady_clock::now();
+  // Other writers keep joining while the previous group is being written.
+  std::unique_lock<std::mutex> commit_lock(commit_mutex_);
+
+  lock.lock();
+  if (!group->closed && window_.count() > 0) {
+    group_closed_cv_.wait_for(lock, window_, [&] { return group->closed; });
+  }
+  if (!group->closed) {
+    ld_check(open_group_ == group);
+    closeOpenGroup();
+  }
+  lock.unlock();
+
+  const auto write_start = steady_clock::now();
+
+  std::vector<const WriteOp*> all_ops;
+  all_ops.reserve(group->nops);
+  for (const Member* member : group->members) {
+    all_ops.insert(
+        all_ops.end(), member->write_ops->begin(), member->write_ops->end());
+  }
+
+  int rv = store_->writeMulti(all_ops);
+  const Status status = rv == 0 ? E::OK : err;
+  bool group_synced = false;
+  if (rv == 0 && group->sync) {
+    if (store_->sync(Durability::ASYNC_WRITE) == 0) {
+      group_synced = true;
+    } else {
+      // Members will fall back to the syncing thread.
+      RATELIMIT_ERROR(seconds(10),
+                      1,
+                      "Shard %d: WAL sync of commit group failed: %s",
+                      store_->getShardIdx(),
+                      error_name(err));
+    }
+  }
+
+  const auto write_end = steady_clock::now();
+  const size_t group_size = group->members.size();
+  updateWindow(group_size,
+               duration_cast<microseconds>(write_end - write_start));
+  commit_lock.unlock();
+
+  STAT_INCR(stats_, write_group_commit_groups);
+  STAT_ADD(stats_, write_group_commit_members, group_size);
+  STAT_ADD(stats_,
+           write_group_commit_wait_usec,
+           duration_cast<microseconds>(write_start - wait_start).count());
+  if (group_synced) {
+    STAT_INCR(stats_, write_group_commit_syncs);
+    STAT_ADD(stats_, write_group_commit_synced_members, group_size);
+  }
+
+  for (Member* member : group->members) {
+    member->rv = rv;
+    member->status = status;
+    member->synced = group_synced;
+    if (member != &me) {
+      // `member` may be destroyed as soon as this returns.
+      member->done.post();
+    }
+  }
+
+  *synced = group_synced;
+  if (rv != 0) {
+    err = status;
+  }
+  return rv;
+}
+
+void GroupCommitter::updateWindow(size_t group_size, microseconds commit_time) {
+  recent_commit_times_[next_commit_time_++ % recent_commit_times_.size()] =
+      commit_time;
+  const microseconds p99 = *std::max_element(
+      recent_commit_times_.begin(), recent_commit_times_.end());
+  const microseconds allowed = std::max(
+      microseconds(0), settings_->write_group_commit_latency_budget - p99);
+
+  if (group_size > 1) {
+    // Waiting paid off. Grow the window by 1/8 of what the budget allows.
+    window_ += std::max(microseconds(1), allowed / 8);
+  } else {
+    window_ /= 2;
+  }
+  window_ = std::min(window_, allowed);
+}
+
+microseconds GroupCommitter::getWindow() {
+  std::lock_guard<std::mutex> lock(commit_mutex_);
+  return window_;
+}
+
+}} // namespace facebook::logdevice
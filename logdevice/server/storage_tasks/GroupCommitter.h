@@ -0,0 +1,122 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <folly/synchronization/Baton.h>
+
+#include "logdevice/common/settings/Settings.h"
+#include "logdevice/common/settings/UpdateableSettings.h"
+#include "logdevice/include/Err.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file  Leader-based group commit for writes of storage threads of one shard
+ *        (--write-group-commit).
+ *
+ *        Every storage thread that has a batch of write ops calls commit().
+ *        The first thread to arrive becomes the leader of a new commit group;
+ *        threads that arrive while the group is open join it and block. The
+ *        leader first waits for the previous group of this shard to finish
+ *        writing (writers that arrive meanwhile join the group), then for an
+ *        adaptive window, then writes the ops of all members with a single
+ *        LocalLogStore::writeMulti() and, if any member asked for it, syncs
+ *        the WAL once. Then it wakes up all members with the result.
+ *
+ *        The window is chosen so that the p99 of group wait plus group
+ *        write/sync time stays within --write-group-commit-latency-budget:
+ *        it's capped by the budget minus the recently observed write/sync
+ *        latency, grows while groups actually get followers and halves when
+ *        a leader ends up writing alone.
+ */
+
+class LocalLogStore;
+class StatsHolder;
+class WriteOp;
+
+class GroupCommitter {
+ public:
+  GroupCommitter(LocalLogStore* store,
+                 UpdateableSettings<Settings> settings,
+                 StatsHolder* stats);
+
+  /**
+   * Writes @param write_ops to the local log store as part of a commit group.
+   * Blocks until the group is written (and synced if requested).
+   *
+   * @param sync    if true, the WAL will be synced after the group's write
+   * @param synced  set to true if the WAL was synced after the write, which
+   *                may happen even if `sync` is false
+   * @return  same as LocalLogStore::writeMulti() for the whole group: 0 on
+   *          success, -1 with err set on failure
+   */
+  int commit(const std::vector<const WriteOp*>& write_ops,
+             bool sync,
+             bool* synced);
+
+  /**
+   * Current group wait window. Exposed for tests.
+   */
+  std::chrono::microseconds getWindow();
+
+ private:
+  struct Member {
+    const std::vector<const WriteOp*>* write_ops;
+    // Filled in by the leader before posting `done`.
+    int rv = 0;
+    Status status = E::OK;
+    bool synced = false;
+    folly::Baton<> done;
+  };
+
+  struct Group {
+    std::vector<Member*> members;
+    size_t nops = 0;
+    bool sync = false;
+    // Set when the group stops accepting members. Protected by mutex_.
+    bool closed = false;
+  };
+
+  // Closes the currently open group. Called with mutex_ locked.
+  void closeOpenGroup();
+
+  // Updates window_ after a group of @param group_size members was written
+  // in @param commit_time. Called with commit_mutex_ locked.
+  void updateWindow(size_t group_size, std::chrono::microseconds commit_time);
+
+  LocalLogStore* store_;
+  UpdateableSettings<Settings> settings_;
+  StatsHolder* stats_;
+
+  // Protects open_group_ and Group::closed.
+  std::mutex mutex_;
+  // Notified when the open group gets closed because it's full.
+  std::condition_variable group_closed_cv_;
+  // Group that new writers join, if any.
+  std::shared_ptr<Group> open_group_;
+
+  // Held by the leader of the group being written, so that groups are
+  // written one at a time and the next group fills up in the meantime.
+  std::mutex commit_mutex_;
+
+  // The rest is protected by commit_mutex_.
+  std::chrono::microseconds window_{0};
+  // Write+sync times of the most recent groups. The p99 latency is estimated
+  // as their maximum.
+  std::array<std::chrono::microseconds, 64> recent_commit_times_{};
+  size_t next_commit_time_ = 0;
+};
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,117 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/storage_tasks/IngestingStorageThread.h"
+
+#include <chrono>
+#include <vector>
+
+#include "logdevice/common/debug.h"
+#include "logdevice/server/locallogstore/LocalLogStore.h"
+#include "logdevice/server/storage_tasks/StorageTaskResponse.h"
+#include "logdevice/server/storage_tasks/StorageThreadPool.h"
+#include "logdevice/server/storage_tasks/WriteStorageTask.h"
+
+namespace facebook { namespace logdevice {
+
+namespace {
+// How often buffers are checked for being due while writes are waiting for
+// ingestion. Buffers that filled up wait for at most this long.
+constexpr std::chrono::milliseconds kIngestCheckPeriod{100};
+} // namespace
+
+IngestingStorageThread::IngestingStorageThread(StorageThreadPool* pool,
+                                               size_t queue_size)
+    : StorageThread(pool), queue_(queue_size) {}
+
+IngestingStorageThread::~IngestingStorageThread() {}
+
+void IngestingStorageThread::enqueueForIngestion(
+    std::unique_ptr<WriteStorageTask> task) {
+  // Tasks should be non-null so we can abuse null in stopProcessingTasks()
+  ld_check(task);
+  ld_check(task->ingestToken() != FlushToken_INVALID);
+
+  if (!queue_.writeIfNotFull(std::move(task))) {
+    ld_catch(false,
+             "Failed to enqueue.  This should never happen if the queue is "
+             "properly sized.  Reverting to blockingWrite().");
+    queue_.blockingWrite(std::move(task));
+  }
+}
+
+void IngestingStorageThread::stopProcessingTasks() {
+  queue_.write(std::unique_ptr<WriteStorageTask>());
+}
+
+void IngestingStorageThread::run() {
+  LocalLogStore& store = pool_->getLocalLogStore();
+  store.onStorageThreadStarted();
+
+  std::vector<std::unique_ptr<WriteStorageTask>> waiting;
+  bool stop = false;
+  while (!stop) {
+    std::unique_ptr<WriteStorageTask> task;
+    bool got_task = true;
+    if (waiting.empty()) {
+      // No writes are waiting for ingestion.
+      queue_.blockingRead(task);
+    } else {
+      got_task = queue_.tryReadUntil(
+          std::chrono::steady_clock::now() + kIngestCheckPeriod, task);
+    }
+    while (got_task) {
+      if (!task) {
+        // Null indicates need to stop
+        stop = true;
+        break;
+      }
+      waiting.push_back(std::move(task));
+      got_task = queue_.read(task);
+    }
+
+    int rv = store.ingestBufferedWrites(/* all */ stop);
+    if (rv != 0) {
+      RATELIMIT_ERROR(std::chrono::seconds(10),
+                      2,
+                      "Failed to ingest buffered writes of shard %d: %s. %s",
+                      pool_->getShardIdx(),
+                      error_description(err),
+                      stop ? "Failing them." : "Will retry.");
+    }
+    releaseTasks(waiting, /* fail */ stop);
+  }
+  ld_check(waiting.empty());
+}
+
+void IngestingStorageThread::releaseTasks(
+    std::vector<std::unique_ptr<WriteStorageTask>>& tasks,
+    bool fail) {
+  FlushToken ingested_up_through =
+      pool_->getLocalLogStore().ingestedUpThrough();
+  size_t num_waiting = 0;
+  for (auto& task : tasks) {
+    if (task->ingestToken() > ingested_up_through) {
+      if (!fail) {
+        tasks[num_waiting++] = std::move(task);
+        continue;
+      }
+      task->status_ = E::LOCAL_LOG_STORE_WRITE;
+    }
+    if (task->status_ == E::OK &&
+        task->durability() == Durability::SYNC_WRITE) {
+      // The write batch left the sync of this task to us, so that it
+      // happens after the ingestion.
+      task->synced_ = true;
+      pool_->enqueueForSync(std::move(task));
+    } else {
+      StorageTaskResponse::sendBackToWorker(std::move(task));
+    }
+  }
+  tasks.resize(num_waiting);
+}
+}} // namespace facebook::logdevice
@@ -0,0 +1,64 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <folly/MPMCQueue.h>
+
+#include "logdevice/server/storage_tasks/StorageThread.h"
+#include "logdevice/server/storage_tasks/StorageThreadPool.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Storage thread that ingests the writes that the local log store
+ * buffered for ingestion as SST files (see WriteOp::ingestToken()), and holds
+ * back the acknowledgement of such writes until they're ingested. Makes
+ * periodic calls to LocalLogStore::ingestBufferedWrites() while there are
+ * writes waiting, so that the write path never blocks on building or
+ * ingesting SST files.
+ */
+
+class WriteStorageTask;
+
+class IngestingStorageThread : public StorageThread {
+ public:
+  IngestingStorageThread(StorageThreadPool* parent, size_t queue_size);
+  ~IngestingStorageThread() override;
+
+  /**
+   * Hold the task until LocalLogStore::ingestedUpThrough() reaches its
+   * ingest token, then pass it back to the Worker, or to the syncing thread
+   * if it's a synchronous write.
+   */
+  void enqueueForIngestion(std::unique_ptr<WriteStorageTask> task);
+
+  /**
+   * Instructs the thread to ingest everything that is buffered, release the
+   * tasks and break the run() loop.  Can be called on any thread.
+   */
+  void stopProcessingTasks();
+
+ protected:
+  void run() override;
+
+  std::string threadName() override {
+    char buf[16];
+    snprintf(buf, sizeof buf, "ld:s%d:ingest", pool_->getShardIdx());
+    return buf;
+  }
+
+ private:
+  // Passes the tasks in `tasks` whose writes have been ingested on to the
+  // worker or the syncing thread. With `fail`, also the ones that haven't,
+  // with status LOCAL_LOG_STORE_WRITE.
+  void releaseTasks(std::vector<std::unique_ptr<WriteStorageTask>>& tasks,
+                    bool fail);
+
+  folly::MPMCQueue<std::unique_ptr<WriteStorageTask>> queue_;
+};
+}} // namespace facebook::logdevice
@@ -113,6 +113,7 @@ void PerWorkerStorageTaskQueue::putTask(std::unique_ptr<StorageTask>&& task) {
   if (task->isWriteTask()) {
     ld_assert(task->isDroppable());
     WriteStorageTask* write = static_cast<WriteStorageTask*>(task.get());
+    write->startAppendStageTimer();
 
     Status accepting = acceptingWrites();
     if (accepting != E::OK && accepting != E::LOW_ON_SPC) {
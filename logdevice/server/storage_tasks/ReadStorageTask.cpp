@@ -8,6 +8,7 @@
 #define __STDC_FORMAT_MACROS // pull in PRId64 etc
 #include "logdevice/server/storage_tasks/ReadStorageTask.h"
 
+#include <algorithm>
 #include <chrono>
 #include <memory>
 
@@ -35,6 +36,7 @@ namespace facebook { namespace logdevice {
 class StorageThreadCallback : public LocalLogStoreReader::Callback {
  public:
   int processRecord(const RawRecord& raw_record) override;
+  int processFilteredOut(lsn_t lsn) override;
   ReadStorageTask::RecordContainer&& releaseRecords() {
     return std::move(records_);
   }
@@ -114,11 +116,65 @@ void ReadStorageTask::setMemoryToken(ResourceBudget::Token memory_token) {
 }
 
 void ReadStorageTask::execute() {
+  STAT_INCR(storageThreadPool_->stats(), num_in_flight_read_storage_tasks);
+
+  // The reads batched with this one share its byte limit, which is at least
+  // as large as theirs, and the memory budgeted for it. Each read gets what
+  // the reads before it left over, so a stream with little to read doesn't
+  // hold back the others.
+  const size_t batch_max_bytes = read_ctx_.max_bytes_to_deliver_;
+  executeRead();
+  size_t batch_bytes = total_bytes_;
+  for (size_t i = 0; i < batched_tasks_.size(); ++i) {
+    ReadStorageTask& task = *batched_tasks_[i];
+    task.setStorageThreadPool(storageThreadPool_);
+    if (batch_bytes >= batch_max_bytes) {
+      // Nothing left for this read. The stream will be requeued.
+      task.status_ = E::BYTE_LIMIT_REACHED;
+      continue;
+    }
+    task.read_ctx_.max_bytes_to_deliver_ = std::min(
+        task.read_ctx_.max_bytes_to_deliver_, batch_max_bytes - batch_bytes);
+    task.read_ctx_.first_record_any_size_ &= batch_bytes == 0;
+    // Reads seek the iterator anyway, so streams of the same log can use the
+    // iterator created for another one instead of creating their own.
+    std::shared_ptr<LocalLogStore::ReadIterator> shared_iterator;
+    for (size_t j = 0; j <= i && !shared_iterator; ++j) {
+      const ReadStorageTask& other = j == 0 ? *this : *batched_tasks_[j - 1];
+      if (task.canShareIterator(other)) {
+        shared_iterator = other.owned_iterator_;
+      }
+    }
+    task.executeRead(std::move(shared_iterator));
+    batch_bytes += task.total_bytes_;
+  }
+
+  // Release memory for what we did not read.
+  // It's actually possible to have read more than max_bytes_to_deliver_ if
+  // first_record_any_size was true. However, AllServerReadStreams only budgeted
+  // for max_bytes_to_deliver_ so we don't release anything in that case.
+  if (batch_bytes < batch_max_bytes) {
+    ld_check(memory_token_.valid());
+    memory_token_.release(batch_max_bytes - batch_bytes);
+  }
+}
+
+bool ReadStorageTask::canShareIterator(const ReadStorageTask& other) const {
+  return other.owned_iterator_ != nullptr &&
+      other.read_ctx_.logid_ == read_ctx_.logid_ &&
+      other.options_.allow_blocking_io == options_.allow_blocking_io &&
+      other.options_.tailing == options_.tailing &&
+      other.options_.fill_cache == options_.fill_cache &&
+      other.options_.allow_copyset_index == options_.allow_copyset_index &&
+      other.options_.csi_data_only == options_.csi_data_only &&
+      other.options_.new_to_old == options_.new_to_old;
+}
+
+void ReadStorageTask::executeRead(
+    std::shared_ptr<LocalLogStore::ReadIterator> shared_iterator) {
   ld_check(options_.allow_blocking_io);
   ld_check(total_bytes_ == 0);
 
-  STAT_INCR(storageThreadPool_->stats(), num_in_flight_read_storage_tasks);
-
   // Only read if the ServerReadStream still exists.
   // We're not on a worker thread, but WeakRef's operator bool() is thread safe.
   if (stream_.getFromAnyThread()) {
@@ -128,6 +184,12 @@ void ReadStorageTask::execute() {
       baton.try_wait_for(io_fault_injection.getLatencyToInject(stream_shard_));
     }
     owned_iterator_ = iterator_from_cache_.lock();
+    if (!owned_iterator_ && shared_iterator) {
+      owned_iterator_ = std::move(shared_iterator);
+      shared_iterator_ = true;
+      STAT_INCR(storageThreadPool_->stats(),
+                read_requests_to_storage_shared_iterator);
+    }
     if (!owned_iterator_) {
       // Either the iterator wasn't passed in by CatchupOneStream because it
       // wasn't found in the cache, or the iterator has since then been
@@ -167,15 +229,6 @@ void ReadStorageTask::execute() {
      */
   }
 
-  // Release memory for what we did not read.
-  // It's actually possible to have read more than max_bytes_to_deliver_ if
-  // first_record_any_size was true. However, AllServerReadStreams only budgeted
-  // for max_bytes_to_deliver_ so we don't release anything in that case.
-  if (total_bytes_ < read_ctx_.max_bytes_to_deliver_) {
-    ld_check(memory_token_.valid());
-    memory_token_.release(read_ctx_.max_bytes_to_deliver_ - total_bytes_);
-  }
-
   STAT_ADD(storageThreadPool_->stats(),
            read_storage_tasks_allocated_records_bytes,
            total_bytes_);
@@ -193,12 +246,17 @@ void ReadStorageTask::onDropped() {
 
 void ReadStorageTask::releaseRecords() {
   records_.clear();
+  size_t bytes = total_bytes_;
+  // Batched reads are covered by this task's memory token.
+  for (auto& task : batched_tasks_) {
+    task->records_.clear();
+    bytes += task->total_bytes_;
+  }
 
   Worker* w = Worker::onThisThread(false);
   if (w) {
     // w may be nullptr in tests.
-    STAT_SUB(
-        w->stats(), read_storage_tasks_allocated_records_bytes, total_bytes_);
+    STAT_SUB(w->stats(), read_storage_tasks_allocated_records_bytes, bytes);
   }
 
   ld_check(memory_token_.valid());
@@ -222,6 +280,11 @@ void ReadStorageTask::getDebugInfoDetailed(StorageTaskDebugInfo& info) const {
                      toString(stream_creation_time_),
                      stream_scd_enabled_,
                      toString(stream_known_down_));
+  if (!batched_tasks_.empty()) {
+    info.extra_info +=
+        folly::sformat(", batched with reads of {} other streams",
+                       batched_tasks_.size());
+  }
 }
 
 int StorageThreadCallback::processRecord(const RawRecord& record) {
@@ -243,4 +306,15 @@ int StorageThreadCallback::processRecord(const RawRecord& record) {
       record.from_under_replicated_region);
   return 0;
 }
+
+int StorageThreadCallback::processFilteredOut(lsn_t lsn) {
+  // Passed to the worker as an empty record so that it can send the
+  // FILTERED_OUT gap in order with the other records.
+  records_.emplace_back(lsn,
+                        Slice(),
+                        /*owned*/ false,
+                        /*from_under_replicated_region*/ false,
+                        /*filtered_out*/ true);
+  return 0;
+}
 }} // namespace facebook::logdevice
@@ -76,7 +76,7 @@ class ReadStorageTask : public StorageTask {
   /**
    * Executes the storage task on a storage thread.  Wrapper around
    * LocalLogStoreReader::read() that puts the result into status_ and
-   * records_.
+   * records_, then does the same for batched_tasks_.
    */
   void execute() override;
 
@@ -100,9 +100,20 @@ class ReadStorageTask : public StorageTask {
     return principal_;
   }
 
+  bool canExecuteOnOtherShard() const override {
+    return true;
+  }
+
   RequireWorkerThread<WeakRef<ServerReadStream>> stream_;
   RequireWorkerThread<WeakRef<CatchupQueue>> catchup_queue_;
 
+  // Reads for other streams of the same CatchupQueue on the same shard,
+  // executed on the storage thread right after this one and handed back to
+  // the CatchupQueue along with it. They are never sent on their own, and
+  // share this task's byte limit and memory token. See
+  // --max-read-streams-per-storage-task.
+  std::vector<std::unique_ptr<ReadStorageTask>> batched_tasks_;
+
   const server_read_stream_version_t server_read_stream_version_;
   const filter_version_t filter_version_;
   LocalLogStoreReader::ReadContext read_ctx_;
@@ -116,6 +127,11 @@ class ReadStorageTask : public StorageTask {
   // failed, new iterator that will later be handed over to CatchupOneStream.
   std::shared_ptr<LocalLogStore::ReadIterator> owned_iterator_;
 
+  // True if owned_iterator_ was created for another task of the batch. Such
+  // an iterator is not handed over to CatchupOneStream, since it would then
+  // be cached by two streams.
+  bool shared_iterator_{false};
+
   //
   // These will hold the result after execute()
   //
@@ -141,6 +157,15 @@ class ReadStorageTask : public StorageTask {
  private:
   void getDebugInfoDetailed(StorageTaskDebugInfo&) const override;
 
+  // Reads the records of this task's stream. If @param shared_iterator is
+  // given, it is used instead of creating a new iterator when the iterator
+  // from the stream's cache is gone.
+  void executeRead(
+      std::shared_ptr<LocalLogStore::ReadIterator> shared_iterator = nullptr);
+
+  // If an iterator created for @param other can be used to read for this task.
+  bool canShareIterator(const ReadStorageTask& other) const;
+
   // The following fields store some information about the read stream for debug
   // output
   read_stream_id_t stream_id_;
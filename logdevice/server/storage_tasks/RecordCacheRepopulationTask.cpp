@@ -7,14 +7,20 @@
  */
 #include "logdevice/server/storage_tasks/RecordCacheRepopulationTask.h"
 
+#include <string>
+
+#include <folly/Optional.h>
+
 #include "logdevice/common/Processor.h"
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/debug.h"
 #include "logdevice/common/stats/Stats.h"
 #include "logdevice/common/types_internal.h"
 #include "logdevice/server/RecordCache.h"
+#include "logdevice/server/RecordCacheFileStore.h"
 #include "logdevice/server/ServerProcessor.h"
 #include "logdevice/server/locallogstore/LocalLogStore.h"
+#include "logdevice/server/locallogstore/RocksDBLogStoreBase.h"
 #include "logdevice/server/read_path/LogStorageStateMap.h"
 #include "logdevice/server/storage_tasks/ShardedStorageThreadPool.h"
 #include "logdevice/server/storage_tasks/StorageThreadPool.h"
@@ -43,18 +49,47 @@ void RecordCacheRepopulationTask::execute() {
     }
   };
 
+  ld_check(sharded_store->numShards() > 0);
+  const size_t bytes_limit_per_shard =
+      storageThreadPool_->getProcessor().settings()->record_cache_max_size /
+      sharded_store->numShards();
+
+  // Like the snapshot blobs, a record cache file must not outlive this
+  // instance unless it gets replaced with a new one.
+  RecordCacheFileStore* files = log_storage_state_map.getRecordCacheFileStore();
+  auto rocks_store = dynamic_cast<RocksDBLogStoreBase*>(&shard);
+  folly::Optional<std::string> shard_path;
+  if (rocks_store != nullptr) {
+    shard_path = rocks_store->getLocalDBPath();
+  }
+  if (shard_path.hasValue()) {
+    const std::string path =
+        shard_path.value() + "/" + RecordCacheFile::FILE_NAME;
+    if (repopulate_record_caches_ && files != nullptr) {
+      if (files->openShard(shard_idx_, path, bytes_limit_per_shard) != 0) {
+        ld_critical("Failed to open record cache file %s of shard %d: the "
+                    "file left by the previous instance could not be "
+                    "removed, so it may restore stale caches after the next "
+                    "restart",
+                    path.c_str(),
+                    shard_idx_);
+        status_ = E::FAILED;
+        return;
+      }
+    } else if (RecordCacheFileStore::removeFile(path) != 0) {
+      ld_critical("Failed to remove record cache file %s", path.c_str());
+      status_ = E::FAILED;
+      return;
+    }
+  }
+
   if (!repopulate_record_caches_) {
     status_ = E::OK;
     return;
   }
 
-  ld_check(sharded_store->numShards() > 0);
-
   size_t repopulated_caches = 0;
   size_t repopulated_bytes = 0;
-  const size_t bytes_limit_per_shard =
-      storageThreadPool_->getProcessor().settings()->record_cache_max_size /
-      sharded_store->numShards();
 
   LocalLogStore::LogSnapshotBlobCallback repopulate = [&](logid_t log_id,
                                                           Slice data) {
@@ -35,5 +35,24 @@ ShardedStorageThreadPool::ShardedStorageThreadPool(
                                             stats,
                                             trace_logger));
   }
+
+  if (settings->storage_tasks_work_stealing &&
+      settings->storage_tasks_steal_across_shards) {
+    for (const std::vector<int>& shards : store->getShardsGroupedByDevice()) {
+      for (int shard_idx : shards) {
+        std::vector<StorageThreadPool*> peers;
+        for (int peer_idx : shards) {
+          if (peer_idx != shard_idx) {
+            peers.push_back(pools_[peer_idx].get());
+          }
+        }
+        pools_[shard_idx]->setStealPeers(std::move(peers));
+      }
+    }
+  }
+}
+
+ShardedStorageThreadPool::~ShardedStorageThreadPool() {
+  shutdown();
 }
 }} // namespace facebook::logdevice
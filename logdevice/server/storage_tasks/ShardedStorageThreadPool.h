@@ -44,6 +44,13 @@ class ShardedStorageThreadPool {
       StatsHolder* stats,
       const std::shared_ptr<TraceLogger> trace_logger = nullptr);
 
+  /**
+   * Shuts down all pools before destroying any of them, since with
+   * --storage-tasks-steal-across-shards threads of one pool may access
+   * another.
+   */
+  ~ShardedStorageThreadPool();
+
   void setProcessor(ServerProcessor* processor) {
     for (auto& pool : pools_) {
       pool->setProcessor(processor);
@@ -173,6 +173,17 @@ class StorageTask {
     return true;
   }
 
+  /**
+   * Whether the task may be executed by a storage thread of another shard's
+   * StorageThreadPool (see --storage-tasks-steal-across-shards). Such tasks
+   * must only access the local log store, settings and stats through
+   * storageThreadPool_, which always points to the pool of the task's own
+   * shard, and must not need syncing after execution.
+   */
+  virtual bool canExecuteOnOtherShard() const {
+    return false;
+  }
+
   /**
    * Hook called on a storage thread when the task is dropped during a queue
    * drop.  Subclasses can override to perform extra processing.
@@ -188,6 +199,14 @@ class StorageTask {
     storageThreadPool_ = ptr;
   }
 
+  /**
+   * Pool of the task's own shard. May differ from the pool of the thread
+   * executing the task, see canExecuteOnOtherShard().
+   */
+  StorageThreadPool* getStorageThreadPool() const {
+    return storageThreadPool_;
+  }
+
   /**
    * Called by StorageThread before execute() to provide tasks access to the
    * StorageThread instance processing the task.
@@ -17,6 +17,7 @@
 #include "logdevice/server/RecordCachePersistence.h"
 #include "logdevice/server/locallogstore/LocalLogStore.h"
 #include "logdevice/server/storage_tasks/ExecStorageThread.h"
+#include "logdevice/server/storage_tasks/IngestingStorageThread.h"
 #include "logdevice/server/storage_tasks/StorageTask.h"
 #include "logdevice/server/storage_tasks/StorageTaskResponse.h"
 #include "logdevice/server/storage_tasks/SyncingStorageThread.h"
@@ -82,6 +83,9 @@ StorageThreadPool::StorageThreadPool(
           params[(size_t)ThreadType::FAST_TIME_SENSITIVE].nthreads),
       nthreads_default_(params[(size_t)ThreadType::DEFAULT].nthreads),
       useDRR_(settings->storage_tasks_use_drr),
+      useWorkStealing_(settings->storage_tasks_work_stealing),
+      stealAcrossShards_(useWorkStealing(ThreadType::SLOW) &&
+                         settings->storage_tasks_steal_across_shards),
       local_log_store_(local_log_store),
       processor_(nullptr),
       trace_logger_(trace_logger),
@@ -105,11 +109,22 @@ StorageThreadPool::StorageThreadPool(
               storageTaskThreadTypeName(eType),
               settings_->storage_tasks_drr_quanta,
               principals);
+          if (useWorkStealing(eType)) {
+            // Same total capacity as the PrioritizedQueue, which has `size`
+            // slots per priority. One lane per thread.
+            taskQueues_[eType].stealing_queue =
+                std::make_unique<StealingTaskQueue>(
+                    size * (size_t)StorageTaskPriority::NUM_PRIORITIES,
+                    std::max(1, params[type].nthreads));
+          }
         }
       }) {
   ld_check(local_log_store != nullptr);
   ld_check(nthreads_slow_ > 0);
 
+  group_committer_ =
+      std::make_unique<GroupCommitter>(local_log_store_, settings_, stats_);
+
   // If you're adding a new ThreadType, please search this file for 'nthreads'
   // to find what need updating here.
   static_assert((int)ThreadType::SLOW == 0 &&
@@ -133,7 +148,7 @@ StorageThreadPool::StorageThreadPool(
   });
 
   // Find an upper limit on the number of tasks in flight for this thread
-  // pool, to size the syncing thread's queue
+  // pool, to size the syncing and ingesting threads' queues
   size_t max_tasks_in_flight = 0;
 
   for (int type = 0; type < (int)ThreadType::MAX; ++type) {
@@ -167,6 +182,18 @@ StorageThreadPool::StorageThreadPool(
     }
     syncing_thread_ = std::move(thread);
   }
+
+  // Start ingesting thread
+  {
+    auto thread =
+        std::make_unique<IngestingStorageThread>(this, max_tasks_in_flight);
+    if (thread->start() != 0) {
+      this->shutDown(); // shut down any already started threads
+      this->join();
+      throw ConstructorFailed();
+    }
+    ingesting_thread_ = std::move(thread);
+  }
 }
 
 std::array<size_t, (size_t)ThreadType::MAX>
@@ -227,8 +254,10 @@ void StorageThreadPool::shutDown(bool persist_record_caches) {
   auto do_stop = [&](PerTypeTaskQueue& task_queue, size_t nthreads, bool drr) {
     // Ask storage threads to drop as many tasks as possible in case the queue
     // is backed up
-    const size_t ndrop =
-        std::max(task_queue.drrQueue.size(), task_queue.queue.max_capacity());
+    const ssize_t capacity = task_queue.stealing_queue
+        ? task_queue.stealing_queue->max_capacity()
+        : task_queue.queue.max_capacity();
+    const size_t ndrop = std::max(task_queue.drrQueue.size(), capacity);
     task_queue.tasks_to_drop.store(ndrop);
 
     for (size_t i = 0; i < nthreads; ++i) {
@@ -238,6 +267,8 @@ void StorageThreadPool::shutDown(bool persist_record_caches) {
       if (drr) {
         uint64_t principal = static_cast<uint64_t>(task->getPrincipal());
         task_queue.drrQueue.enqueue(task.release(), principal);
+      } else if (task_queue.stealing_queue) {
+        task_queue.stealing_queue->blockingWrite(task.release());
       } else {
         task_queue.queue.blockingWrite(task.release());
       }
@@ -280,9 +311,17 @@ void StorageThreadPool::join() {
   }
   exec_threads_.clear();
 
-  // Now that all exec threads are done, also stop the syncing thread.  We do
-  // it here not in shutDown() because exec threads shutting down may have
-  // generated work for the syncing thread; if not, it will shut down quickly.
+  // Now that all exec threads are done, also stop the ingesting and syncing
+  // threads.  We do it here not in shutDown() because exec threads shutting
+  // down may have generated work for them; if not, they will shut down
+  // quickly.  The ingesting thread goes first since it may hand tasks to the
+  // syncing thread.
+  if (ingesting_thread_) {
+    ingesting_thread_->stopProcessingTasks();
+    int rv = pthread_join(ingesting_thread_->getThreadHandle(), nullptr);
+    ld_check(rv == 0);
+    ingesting_thread_.reset();
+  }
   if (syncing_thread_) {
     syncing_thread_->stopProcessingTasks();
     int rv = pthread_join(syncing_thread_->getThreadHandle(), nullptr);
@@ -304,11 +343,14 @@ int StorageThreadPool::tryPutTask(std::unique_ptr<StorageTask>&& task) {
   task->setStorageThreadPool(this);
 
   bool ret = true;
+  auto& task_queue = taskQueues_[thread_type];
   if (useDRR_ && (thread_type == StorageTask::ThreadType::SLOW)) {
     uint64_t principal = static_cast<uint64_t>(task->getPrincipal());
-    taskQueues_[thread_type].drrQueue.enqueue(task.get(), principal);
+    task_queue.drrQueue.enqueue(task.get(), principal);
+  } else if (task_queue.stealing_queue) {
+    ret = task_queue.stealing_queue->writeIfNotFull(task.get());
   } else {
-    ret = taskQueues_[thread_type].queue.writeIfNotFull(task.get());
+    ret = task_queue.queue.writeIfNotFull(task.get());
   }
 
   if (!ret) {
@@ -351,11 +393,14 @@ bool StorageThreadPool::blockingPutTask(std::unique_ptr<StorageTask>&& task) {
   auto thread_type = getThreadType(*task);
 
   task->setStorageThreadPool(this);
+  auto& task_queue = taskQueues_[thread_type];
   if (useDRR_ && (thread_type == StorageTask::ThreadType::SLOW)) {
     uint64_t principal = static_cast<uint64_t>(task->getPrincipal());
-    taskQueues_[thread_type].drrQueue.enqueue(task.release(), principal);
+    task_queue.drrQueue.enqueue(task.release(), principal);
+  } else if (task_queue.stealing_queue) {
+    task_queue.stealing_queue->blockingWrite(task.release());
   } else {
-    taskQueues_[thread_type].queue.blockingWrite(task.release());
+    task_queue.queue.blockingWrite(task.release());
   }
   STORAGE_TASK_STAT_INCR(stats_, thread_type, num_storage_tasks);
   STORAGE_TASK_TYPE_STAT_INCR(stats_, task_type, storage_tasks_posted);
@@ -363,14 +408,21 @@ bool StorageThreadPool::blockingPutTask(std::unique_ptr<StorageTask>&& task) {
 }
 
 std::unique_ptr<StorageTask>
-StorageThreadPool::blockingGetTask(StorageTask::ThreadType type) {
+StorageThreadPool::blockingGetTask(StorageTask::ThreadType type,
+                                   size_t thread_idx) {
   auto& task_queue = taskQueues_[getThreadType(type)];
   std::map<StorageTaskType, int> dropped_by_type;
 
   while (true) {
     StorageTask* rawptr;
+    bool stolen = false;
+    bool from_peer = false;
     if (useDRR_ && (type == StorageTask::ThreadType::SLOW)) {
       rawptr = task_queue.drrQueue.blockingDequeue();
+    } else if (stealAcrossShards_ && type == StorageTask::ThreadType::SLOW) {
+      rawptr = getTaskOrStealFromPeers(thread_idx, &stolen, &from_peer);
+    } else if (task_queue.stealing_queue) {
+      task_queue.stealing_queue->blockingRead(rawptr, thread_idx, &stolen);
     } else {
       task_queue.queue.blockingRead(rawptr);
     }
@@ -378,6 +430,16 @@ StorageThreadPool::blockingGetTask(StorageTask::ThreadType type) {
     std::unique_ptr<StorageTask> task(rawptr);
 
     STORAGE_TASK_STAT_DECR(stats_, type, num_storage_tasks);
+    if (stolen) {
+      STORAGE_TASK_STAT_INCR(stats_, type, storage_tasks_stolen);
+    }
+    if (from_peer) {
+      // The task belongs to another shard's pool. Its drop tickets are that
+      // pool's business, so just execute it.
+      STAT_INCR(stats_, storage_tasks_stolen_from_other_shard);
+      STORAGE_TASK_STAT_INCR(stats_, type, storage_tasks_dequeued);
+      return task;
+    }
 
     // Check if we should drop the task.  Doing a load first to avoid an
     // std::atomic write in the common case when there is nothing to drop.
@@ -399,6 +461,62 @@ StorageThreadPool::blockingGetTask(StorageTask::ThreadType type) {
   }
 }
 
+StorageTask*
+StorageThreadPool::getTaskOrStealFromPeers(size_t thread_idx,
+                                           bool* stolen,
+                                           bool* from_peer) {
+  // How long an idle thread waits on its own queue before looking at the
+  // peers' queues again. Peers don't wake us up when they get tasks, so this
+  // bounds how long a peer's task can wait for an idle thread of ours.
+  const std::chrono::milliseconds poll_interval{5};
+
+  auto& queue = *taskQueues_[ThreadType::SLOW].stealing_queue;
+  StorageTask* task;
+  while (true) {
+    if (queue.read(task, thread_idx, stolen)) {
+      return task;
+    }
+    auto peers = steal_peers_.get();
+    if (peers) {
+      for (StorageThreadPool* peer : *peers) {
+        if (peer->isShuttingDown()) {
+          continue;
+        }
+        task = peer->tryStealForOtherShard();
+        if (task) {
+          *from_peer = true;
+          return task;
+        }
+      }
+    }
+    if (queue.timedRead(task,
+                        thread_idx,
+                        std::chrono::system_clock::now() + poll_interval,
+                        stolen)) {
+      return task;
+    }
+  }
+}
+
+StorageTask* StorageThreadPool::tryStealForOtherShard() {
+  auto& task_queue = taskQueues_[ThreadType::SLOW];
+  if (!task_queue.stealing_queue) {
+    return nullptr;
+  }
+  StorageTask* task;
+  if (!task_queue.stealing_queue->tryStealIf(task, [](StorageTask* t) {
+        return t->canExecuteOnOtherShard();
+      })) {
+    return nullptr;
+  }
+  return task;
+}
+
+void StorageThreadPool::setStealPeers(std::vector<StorageThreadPool*> peers) {
+  steal_peers_.update(std::make_shared<const std::vector<StorageThreadPool*>>(
+      std::move(peers)));
+}
+
 folly::small_vector<std::unique_ptr<WriteStorageTask>, 4>
 StorageThreadPool::tryGetWriteBatch(StorageTask::ThreadType thread_type,
                                     size_t max_count,
@@ -420,11 +538,18 @@ void StorageThreadPool::enqueueForSync(std::unique_ptr<StorageTask> task) {
   syncing_thread_->enqueueForSync(std::move(task));
 }
 
+void StorageThreadPool::enqueueForIngestion(
+    std::unique_ptr<WriteStorageTask> task) {
+  ingesting_thread_->enqueueForIngestion(std::move(task));
+}
+
 void StorageThreadPool::dropTaskQueue(StorageTask::ThreadType type) {
   auto& task_queue = taskQueues_[getThreadType(type)];
   ssize_t ntasks;
   if (useDRR_ && (type == StorageTask::ThreadType::SLOW)) {
     ntasks = task_queue.drrQueue.size();
+  } else if (task_queue.stealing_queue) {
+    ntasks = task_queue.stealing_queue->size();
   } else {
     ntasks = task_queue.queue.size();
   }
@@ -523,6 +648,9 @@ void StorageThreadPool::getStorageTaskDebugInfo(InfoStorageTasksTable& table) {
     if (useDRR_ && (eType == StorageTask::ThreadType::SLOW)) {
       taskQueues_[eType].drrQueue.introspect_contents(
           std::bind(cb, std::placeholders::_1, eType, false));
+    } else if (taskQueues_[eType].stealing_queue) {
+      taskQueues_[eType].stealing_queue->introspect_contents(
+          std::bind(cb, std::placeholders::_1, eType, false));
     } else {
       taskQueues_[eType].queue.introspect_contents(
           std::bind(cb, std::placeholders::_1, eType, false));
@@ -16,10 +16,13 @@
 #include "logdevice/common/ResourceBudget.h"
 #include "logdevice/common/Semaphore.h"
 #include "logdevice/common/SimpleEnumMap.h"
+#include "logdevice/common/UpdateableSharedPtr.h"
 #include "logdevice/common/settings/Settings.h"
 #include "logdevice/server/ServerSettings.h"
+#include "logdevice/server/storage_tasks/GroupCommitter.h"
 #include "logdevice/server/storage_tasks/PrioritizedQueue.h"
 #include "logdevice/server/storage_tasks/StorageTask.h"
+#include "logdevice/server/storage_tasks/WorkStealingQueue.h"
 
 namespace facebook { namespace logdevice {
 
@@ -33,6 +36,7 @@ class LocalLogStore;
 class ServerProcessor;
 class StatsHolder;
 class ExecStorageThread;
+class IngestingStorageThread;
 class SyncingStorageThread;
 class TraceLogger;
 class WriteStorageTask;
@@ -46,6 +50,10 @@ class StorageThreadPool {
       PrioritizedQueue<StorageTask*,
                        (size_t)StorageTaskPriority::NUM_PRIORITIES>;
 
+  using StealingTaskQueue =
+      WorkStealingQueue<StorageTask*,
+                        (size_t)StorageTaskPriority::NUM_PRIORITIES>;
+
   using DRRTaskQueue = DRRScheduler<StorageTask, &StorageTask::schedulerQHook_>;
 
   /**
@@ -117,6 +125,13 @@ class StorageThreadPool {
     return useDRR_;
   }
 
+  // If true, threads of this type have their own lanes in a
+  // WorkStealingQueue instead of sharing a PrioritizedQueue.
+  bool useWorkStealing(StorageTask::ThreadType type) const {
+    return useWorkStealing_ &&
+        !(useDRR_ && type == StorageTask::ThreadType::SLOW);
+  }
+
   void buildSchedulerPrincipals(std::vector<DRRPrincipal>& principals) {
     principals.clear();
     uint64_t numPrincipals = (uint64_t)StorageTask::Principal::NUM_PRINCIPALS;
@@ -171,8 +186,19 @@ class StorageThreadPool {
   /**
    * Gets a task from the queue, blocking if there are none.  Used by storage
    * threads to get work to do.
+   *
+   * @param thread_idx  index of the calling thread among threads of its type;
+   *                    selects the thread's own lane if work stealing is on
+   */
+  std::unique_ptr<StorageTask> blockingGetTask(StorageTask::ThreadType type,
+                                               size_t thread_idx = 0);
+
+  /**
+   * Sets the pools of other shards on the same disk, whose read tasks our
+   * idle SLOW threads may execute if --storage-tasks-steal-across-shards is
+   * set. The pools must stay alive until this pool is shut down and joined.
    */
-  std::unique_ptr<StorageTask> blockingGetTask(StorageTask::ThreadType type);
+  void setStealPeers(std::vector<StorageThreadPool*> peers);
 
   /**
    * Tries to get a batch of WriteStorageTasks from the write queue.
@@ -191,6 +217,13 @@ class StorageThreadPool {
    */
   void enqueueForSync(std::unique_ptr<StorageTask> task);
 
+  /**
+   * Enqueue a write that the local log store buffered for ingestion as an
+   * SST file (see WriteOp::ingestToken()). Once the write is ingested, the
+   * task will be passed back to the worker, or on to the syncing thread.
+   */
+  void enqueueForIngestion(std::unique_ptr<WriteStorageTask> task);
+
   /**
    * Called by a worker thread to suggest that all tasks currently in the
    * shared queue be dropped because the system is overloaded.
@@ -212,6 +245,14 @@ class StorageThreadPool {
 
   ResourceBudget& getMemoryBudget(StorageTask::ThreadType thread_type);
 
+  /**
+   * @return committer that write batches should go through, or nullptr if
+   *         --write-group-commit is off.
+   */
+  GroupCommitter* getGroupCommitter() {
+    return settings_->write_group_commit ? group_committer_.get() : nullptr;
+  }
+
   /**
    * Fetches debug info on all pending storage tasks into the table provided
    */
@@ -226,11 +267,20 @@ class StorageThreadPool {
   const int nthreads_fast_time_sensitive_;
   const int nthreads_default_;
   const bool useDRR_;
+  const bool useWorkStealing_;
+  // If true, idle SLOW threads execute read tasks of peer pools.
+  const bool stealAcrossShards_;
 
   std::vector<std::unique_ptr<ExecStorageThread>> exec_threads_;
 
   std::unique_ptr<SyncingStorageThread> syncing_thread_;
 
+  std::unique_ptr<IngestingStorageThread> ingesting_thread_;
+
+  // Combines write batches of our threads into commit groups. Always created
+  // since --write-group-commit can be toggled at runtime.
+  std::unique_ptr<GroupCommitter> group_committer_;
+
   // Pointer to local log store.  Not owned by this.
   LocalLogStore* local_log_store_;
 
@@ -250,6 +300,9 @@ class StorageThreadPool {
     // Task queue. Other threads write into it and our threads read from it.
     TaskQueue queue;
 
+    // Used instead of `queue` if useWorkStealing() is true for this type.
+    std::unique_ptr<StealingTaskQueue> stealing_queue;
+
     // For reads only
     DRRTaskQueue drrQueue;
     // Separate queue for write batching
@@ -275,6 +328,9 @@ class StorageThreadPool {
   // Separate queue for each type of storage thread.
   SimpleEnumMap<StorageTask::ThreadType, PerTypeTaskQueue> taskQueues_;
 
+  // Pools of other shards on the same disk. See setStealPeers().
+  FastUpdateableSharedPtr<const std::vector<StorageThreadPool*>> steal_peers_;
+
   // This updates memory budgets whenever they change in settings.
   UpdateableSettings<Settings>::SubscriptionHandle settings_subscription_;
 
@@ -288,6 +344,20 @@ class StorageThreadPool {
   bool tryDropOneTask(std::unique_ptr<StorageTask>& task,
                       std::map<StorageTaskType, int>& dropped_by_type);
 
+  /**
+   * Used by idle SLOW threads of peer pools: takes a task that can execute on
+   * another shard from our SLOW queue, if there's one.
+   */
+  StorageTask* tryStealForOtherShard();
+
+  /**
+   * Called by SLOW threads when cross-shard stealing is enabled instead of
+   * blocking on their queue indefinitely. Waits for a task in our own queue
+   * for a short while, then looks for work in the peers' queues.
+   */
+  StorageTask*
+  getTaskOrStealFromPeers(size_t thread_idx, bool* stolen, bool* from_peer);
+
   /**
    * Called only by the constructor.
    */
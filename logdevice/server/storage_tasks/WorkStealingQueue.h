@@ -0,0 +1,274 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include <folly/Random.h>
+#include <folly/lang/Align.h>
+
+#include "logdevice/common/Semaphore.h"
+#include "logdevice/common/checks.h"
+
+/**
+ * @file  Alternative to PrioritizedQueue used by StorageThreadPool when
+ *        --storage-tasks-work-stealing is enabled.
+ *
+ *        PrioritizedQueue is a single MPMC queue per priority shared by all
+ *        threads of a type, so every producer and every consumer contends on
+ *        the same few cache lines. Here every consumer thread has its own
+ *        lane with a FIFO per priority. Producers spread items over the lanes
+ *        (picking the shorter of two adjacent lanes), consumers take items
+ *        from their own lane and steal from other lanes when their own lane
+ *        has nothing at the highest non-empty priority, so priorities are
+ *        still honored across the whole queue.
+ *
+ *        A single semaphore counts items in all lanes, like in
+ *        PrioritizedQueue; a consumer that decremented it is guaranteed to
+ *        find an item in some lane.
+ */
+namespace facebook { namespace logdevice {
+
+template <class T, size_t NumPriorities>
+class WorkStealingQueue {
+ public:
+  /**
+   * @param capacity  maximum number of items in all lanes together
+   * @param nlanes    number of lanes; consumer i passes i as `lane` to the
+   *                  read methods
+   */
+  WorkStealingQueue(size_t capacity, size_t nlanes)
+      : capacity_(capacity),
+        free_slots_(capacity),
+        lanes_(std::max<size_t>(nlanes, 1)) {}
+
+  size_t getPriority(const T& item) const {
+    ld_check(item);
+    size_t rv = static_cast<size_t>(item->getPriority());
+    ld_check(rv < NumPriorities);
+    return rv;
+  }
+
+  bool writeIfNotFull(T item) {
+    if (!free_slots_.try_wait()) {
+      return false;
+    }
+    push(std::move(item));
+    return true;
+  }
+
+  void blockingWrite(T item) {
+    free_slots_.wait();
+    push(std::move(item));
+  }
+
+  /**
+   * Takes the highest priority item, preferring lane @param lane within a
+   * priority. Blocks if the queue is empty. If @param stolen is not null,
+   * sets it to whether the item came from another lane.
+   */
+  void blockingRead(T& out, size_t lane, bool* stolen = nullptr) {
+    items_.wait();
+    popGuaranteedNonEmpty(out, lane, stolen);
+  }
+
+  /**
+   * Same as blockingRead() but returns false instead of blocking.
+   */
+  bool read(T& out, size_t lane, bool* stolen = nullptr) {
+    if (!items_.try_wait()) {
+      return false;
+    }
+    popGuaranteedNonEmpty(out, lane, stolen);
+    return true;
+  }
+
+  /**
+   * Same as blockingRead() but gives up and returns false at @param deadline.
+   */
+  bool timedRead(T& out,
+                 size_t lane,
+                 std::chrono::system_clock::time_point deadline,
+                 bool* stolen = nullptr) {
+    if (items_.timedwait(deadline) != 0) {
+      return false;
+    }
+    popGuaranteedNonEmpty(out, lane, stolen);
+    return true;
+  }
+
+  /**
+   * Takes the highest priority item for which @param pred returns true, if
+   * there's one among the first @param max_scan items of each priority of
+   * each lane. Used by consumers of other queues to take work off this one.
+   */
+  bool tryStealIf(T& out,
+                  const std::function<bool(const T&)>& pred,
+                  size_t max_scan = 16) {
+    if (!items_.try_wait()) {
+      return false;
+    }
+    for (int pri = NumPriorities - 1; pri >= 0; --pri) {
+      for (Lane& lane : lanes_) {
+        if (lane.tryPopIf(pri, out, pred, max_scan)) {
+          free_slots_.post();
+          return true;
+        }
+      }
+    }
+    // Nothing matched. Give the ticket back to consumers of this queue.
+    items_.post();
+    return false;
+  }
+
+  ssize_t size() const {
+    ssize_t res = 0;
+    for (const Lane& lane : lanes_) {
+      res += lane.total.load(std::memory_order_relaxed);
+    }
+    return res;
+  }
+
+  ssize_t max_capacity() const {
+    return capacity_;
+  }
+
+  size_t numLanes() const {
+    return lanes_.size();
+  }
+
+  // Calls cb() on every item, from the highest priority to the lowest. Locks
+  // all lanes for the duration of the call, so the contents don't change
+  // while we look at them.
+  void introspect_contents(std::function<void(T&)> cb) {
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(lanes_.size());
+    // Always lock in lane order. Other methods lock at most one lane at a
+    // time, so this can't deadlock.
+    for (Lane& lane : lanes_) {
+      locks.emplace_back(lane.mutex);
+    }
+    for (int pri = NumPriorities - 1; pri >= 0; --pri) {
+      for (Lane& lane : lanes_) {
+        for (T& item : lane.fifos[pri]) {
+          cb(item);
+        }
+      }
+    }
+  }
+
+ private:
+  struct alignas(folly::hardware_destructive_interference_size) Lane {
+    std::mutex mutex;
+    std::array<std::deque<T>, NumPriorities> fifos;
+    // Number of items in each FIFO. Updated under the mutex but read without
+    // it, to skip empty FIFOs without locking.
+    std::array<std::atomic<size_t>, NumPriorities> sizes{};
+    std::atomic<size_t> total{0};
+
+    void push(size_t pri, T item) {
+      std::lock_guard<std::mutex> lock(mutex);
+      fifos[pri].push_back(std::move(item));
+      sizes[pri].fetch_add(1, std::memory_order_relaxed);
+      total.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool tryPop(size_t pri, T& out) {
+      if (sizes[pri].load(std::memory_order_relaxed) == 0) {
+        return false;
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      if (fifos[pri].empty()) {
+        return false;
+      }
+      out = std::move(fifos[pri].front());
+      fifos[pri].pop_front();
+      sizes[pri].fetch_sub(1, std::memory_order_relaxed);
+      total.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+
+    bool tryPopIf(size_t pri,
+                  T& out,
+                  const std::function<bool(const T&)>& pred,
+                  size_t max_scan) {
+      if (sizes[pri].load(std::memory_order_relaxed) == 0) {
+        return false;
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      auto& fifo = fifos[pri];
+      const size_t nscan = std::min(max_scan, fifo.size());
+      for (size_t i = 0; i < nscan; ++i) {
+        if (pred(fifo[i])) {
+          out = std::move(fifo[i]);
+          fifo.erase(fifo.begin() + i);
+          sizes[pri].fetch_sub(1, std::memory_order_relaxed);
+          total.fetch_sub(1, std::memory_order_relaxed);
+          return true;
+        }
+      }
+      return false;
+    }
+  };
+
+  void push(T item) {
+    const size_t pri = getPriority(item);
+    // Round-robin over lanes per producer thread, and pick the shorter of
+    // two adjacent lanes to even out the load.
+    static thread_local size_t next = folly::Random::rand32();
+    const size_t a = next++ % lanes_.size();
+    const size_t b = (a + 1) % lanes_.size();
+    Lane& lane = lanes_[b].total.load(std::memory_order_relaxed) <
+            lanes_[a].total.load(std::memory_order_relaxed)
+        ? lanes_[b]
+        : lanes_[a];
+    lane.push(pri, std::move(item));
+    items_.post();
+  }
+
+  void popGuaranteedNonEmpty(T& out, size_t lane, bool* stolen) {
+    ld_check(lane < lanes_.size());
+    lane %= lanes_.size();
+    // We hold a ticket from items_, so there's an item for us somewhere, but
+    // it may move to another lane's position in our scan order while we're
+    // scanning (another consumer may take the one we were about to find and
+    // a producer may add one to a lane we already looked at). Keep scanning.
+    while (true) {
+      for (int pri = NumPriorities - 1; pri >= 0; --pri) {
+        for (size_t i = 0; i < lanes_.size(); ++i) {
+          const size_t victim = (lane + i) % lanes_.size();
+          if (lanes_[victim].tryPop(pri, out)) {
+            if (stolen) {
+              *stolen = i != 0;
+            }
+            free_slots_.post();
+            return;
+          }
+        }
+      }
+    }
+  }
+
+  const size_t capacity_;
+
+  // Number of items in all lanes.
+  Semaphore items_;
+  // Number of items that can be added before the queue is full.
+  Semaphore free_slots_;
+
+  std::vector<Lane> lanes_;
+};
+
+}} // namespace facebook::logdevice
@@ -111,6 +111,7 @@ void WriteBatchStorageTask::execute() {
     std::copy(task_write_ops.begin(),
               task_write_ops.end(),
               std::back_inserter(write_ops));
+    sync_requested_ |= write->durability() == Durability::SYNC_WRITE;
 
     if (reply_shard_idx_ >= 0) {
       // Update the histogram of queueing latency for that individual
@@ -121,6 +122,7 @@ void WriteBatchStorageTask::execute() {
           reply_shard_idx_,
           usec_since(write->enqueue_time_));
     }
+    write->stage_timer_.end(AppendStage::STORAGE_QUEUE, stats());
   }
 
   if (thread_type_ == StorageTask::ThreadType::FAST_STALLABLE) {
@@ -141,6 +143,7 @@ void WriteBatchStorageTask::execute() {
     }
     write->status_ = status;
     if (status == E::OK) {
+      write->stage_timer_.end(AppendStage::LOCAL_WRITE, stats());
       // store success, try to insert the stored record into the record
       // cache. Perform insertion on the storage thread rather than the
       // worker thread to minimize lock contention.
@@ -160,10 +163,23 @@ void WriteBatchStorageTask::execute() {
 
     write_ops_iter += write->getNumWriteOps();
 
+    if (status == E::OK && write->ingestToken() != FlushToken_INVALID) {
+      // The store buffered the write for ingestion. It can't be
+      // acknowledged, or synced, before it is ingested.
+      storageThreadPool_->enqueueForIngestion(std::move(write));
+      continue;
+    }
+
     if (write->durability() == Durability::SYNC_WRITE) {
-      // Delay sending back to worker until the write is synced
       write->synced_ = true;
-      storageThreadPool_->enqueueForSync(std::move(write));
+      if (status == E::OK && synced_by_group_) {
+        // The commit group already synced the WAL.
+        write->onSynced();
+        sendBackToWorker(std::move(write));
+      } else {
+        // Delay sending back to worker until the write is synced
+        storageThreadPool_->enqueueForSync(std::move(write));
+      }
     } else {
       sendBackToWorker(std::move(write));
     }
@@ -242,6 +258,10 @@ void WriteBatchStorageTask::sendDroppedToWorker(
 
 int WriteBatchStorageTask::writeMulti(
     const std::vector<const WriteOp*>& write_ops) {
+  GroupCommitter* committer = storageThreadPool_->getGroupCommitter();
+  if (committer) {
+    return committer->commit(write_ops, sync_requested_, &synced_by_group_);
+  }
   auto& store = storageThreadPool_->getLocalLogStore();
   return store.writeMulti(write_ops);
 }
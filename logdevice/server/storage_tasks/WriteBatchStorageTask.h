@@ -85,8 +85,16 @@ class WriteBatchStorageTask : public StorageTask {
   virtual folly::small_vector<std::unique_ptr<WriteStorageTask>, 4>
   tryGetWriteBatch(size_t max_count, size_t max_bytes);
   virtual std::unique_ptr<WriteStorageTask> tryGetWrite();
+  // Goes through the pool's GroupCommitter if --write-group-commit is set.
   virtual int writeMulti(const std::vector<const WriteOp*>& write_ops);
   // Returns true if entire tasks will be rejected.
   virtual bool throttleIfNeeded();
+
+  // Set by execute() before calling writeMulti(): whether the batch contains
+  // SYNC_WRITE writes.
+  bool sync_requested_{false};
+  // Set by writeMulti() if the WAL was synced after the write as part of a
+  // commit group, so SYNC_WRITE writes don't need the syncing thread.
+  bool synced_by_group_{false};
 };
 }} // namespace facebook::logdevice
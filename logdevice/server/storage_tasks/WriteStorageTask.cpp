@@ -61,4 +61,23 @@ FlushToken WriteStorageTask::syncToken() const {
                             }))
       ->syncToken();
 }
+
+FlushToken WriteStorageTask::ingestToken() const {
+  size_t num_write_ops = getNumWriteOps();
+
+  if (status_ != E::OK || num_write_ops == 0) {
+    return FlushToken_INVALID;
+  }
+
+  folly::small_vector<const WriteOp*, 16> write_ops(num_write_ops);
+  size_t write_ops_written = getWriteOps(write_ops.data(), write_ops.size());
+  ld_check(num_write_ops == write_ops_written);
+  (void)write_ops_written;
+
+  FlushToken ingest_token = FlushToken_INVALID;
+  for (auto& op : write_ops) {
+    ingest_token = std::max(ingest_token, op->ingestToken());
+  }
+  return ingest_token;
+}
 }} // namespace facebook::logdevice
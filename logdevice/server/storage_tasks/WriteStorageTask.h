@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include "logdevice/common/AppendStageTimer.h"
 #include "logdevice/common/ResourceBudget.h"
 #include "logdevice/include/Err.h"
 #include "logdevice/server/locallogstore/WriteOps.h"
@@ -71,6 +72,22 @@ class WriteStorageTask : public StorageTask {
   Durability durability() const override;
   FlushToken syncToken() const override;
 
+  /**
+   * The largest WriteOp::ingestToken() of the write ops, FlushToken_INVALID
+   * if the store didn't buffer any of them for ingestion.
+   */
+  FlushToken ingestToken() const;
+
+  void onSynced() override {
+    stage_timer_.end(AppendStage::SYNC, stats_);
+  }
+
+  /**
+   * Called by PerWorkerStorageTaskQueue when the task is handed to it. Writes
+   * on behalf of appends may start stage_timer_ here.
+   */
+  virtual void startAppendStageTimer() {}
+
   /**
    * Assign memtable id that this write is associated with. The write will be
    * persisted once all memtable with ids less than equal to this will be
@@ -156,5 +173,9 @@ class WriteStorageTask : public StorageTask {
   // Used for tracking total memory usage by in-flight storage tasks of certain
   // types.
   ResourceBudget::Token memToken_;
+
+  // Latency breakdown of the append this write is for, if sampled. See
+  // AppendStageTimer.
+  AppendStageTimer stage_timer_;
 };
 }} // namespace facebook::logdevice
@@ -24,6 +24,7 @@
 #include "logdevice/common/protocol/STARTED_Message.h"
 #include "logdevice/common/protocol/STORE_Message.h"
 #include "logdevice/common/protocol/WINDOW_Message.h"
+#include "logdevice/common/settings/util.h"
 #include "logdevice/common/stats/Stats.h"
 #include "logdevice/common/test/MockBackoffTimer.h"
 #include "logdevice/common/test/MockTimer.h"
@@ -298,6 +299,8 @@ class CatchupQueueTest : public ::testing::Test {
   LogStorageStateMap log_storage_state_map_;
   InterceptedTasks tasks_;
   TestAllServerReadStreams streams_;
+  // Returned by MockCatchupQueueDependencies::getSettings().
+  Settings settings_{create_default_settings<Settings>()};
   const ClientID client_id_{9999};
   const std::string csid_{""};
   const logid_t log_id_{1};
@@ -451,7 +454,7 @@ class MockCatchupQueueDependencies : public CatchupQueueDependencies {
   }
 
   const Settings& getSettings() const override {
-    return *settings_.get();
+    return test_.settings_;
   }
 
  private:
@@ -461,7 +464,6 @@ class MockCatchupQueueDependencies : public CatchupQueueDependencies {
     test_.flow_group_->push(callback, priority);
   }
 
-  UpdateableSettings<Settings> settings_; // never updated
   CatchupQueueTest& test_;
   StatsHolder server_stats_;
 };
@@ -1083,6 +1085,58 @@ TEST_F(CatchupQueueTest, ReadStreamDeletedWhileStorageTaskInFlight) {
   ASSERT_EQ(1, tasks_.size());
 }
 
+// Reads of several streams issued by the same pushRecords() call are batched
+// into a single storage task when --max-read-streams-per-storage-task > 1.
+TEST_F(CatchupQueueTest, ReadsOfSeveralStreamsBatched) {
+  settings_.max_read_streams_per_storage_task = 4;
+
+  read_stream_id_t rs1(1), rs2(2), rs3(3);
+  ServerReadStream& s1 = createStream(rs1);
+  notifyNeedsCatchup(s1, rs1);
+  ASSERT_EQ(1, tasks_.size());
+  std::unique_ptr<ReadStorageTask> task = std::move(tasks_.front());
+  tasks_.clear();
+  ASSERT_TRUE(task->batched_tasks_.empty());
+
+  // The other streams wait for the task in flight.
+  ServerReadStream& s2 = createStream(rs2);
+  notifyNeedsCatchup(s2, rs2);
+  ServerReadStream& s3 = createStream(rs3);
+  notifyNeedsCatchup(s3, rs3);
+  ASSERT_EQ(0, tasks_.size());
+
+  task->status_ = E::CAUGHT_UP;
+  task->records_ = ReadStorageTask::RecordContainer();
+  streams_.onReadTaskDone(*task);
+
+  // Reads of s2 and s3 are issued as one storage task. Both may use the whole
+  // byte limit; the storage thread gives the second read what the first one
+  // left over.
+  ASSERT_EQ(1, tasks_.size());
+  task = std::move(tasks_.front());
+  tasks_.clear();
+  ASSERT_EQ(1, task->batched_tasks_.size());
+  ReadStorageTask& batched = *task->batched_tasks_[0];
+  EXPECT_EQ(&s2, task->stream_.get().get());
+  EXPECT_EQ(&s3, batched.stream_.get().get());
+  EXPECT_EQ(128 * 1024, task->read_ctx_.max_bytes_to_deliver_);
+  EXPECT_EQ(128 * 1024, batched.read_ctx_.max_bytes_to_deliver_);
+  EXPECT_TRUE(s2.storage_task_in_flight_);
+  EXPECT_TRUE(s3.storage_task_in_flight_);
+  EXPECT_EQ(1, getStats(client_id_).read_requests_to_storage_batched);
+
+  task->status_ = E::CAUGHT_UP;
+  task->records_ = ReadStorageTask::RecordContainer();
+  batched.status_ = E::CAUGHT_UP;
+  batched.records_ = ReadStorageTask::RecordContainer();
+  streams_.onReadTaskDone(*task);
+
+  // Both streams are caught up.
+  EXPECT_FALSE(s2.storage_task_in_flight_);
+  EXPECT_FALSE(s3.storage_task_in_flight_);
+  ASSERT_EQ(0, tasks_.size());
+}
+
 // Tests that no read tasks are issued if the log is fully trimmed
 TEST_F(CatchupQueueTest, TrimPointLsnMax) {
   setTrimPoint(LSN_MAX);
@@ -1419,6 +1473,68 @@ TEST_F(CatchupQueueTest, LastRecordsInBatchFiltered) {
   tasks_.clear();
 }
 
+// Records skipped by the storage thread based on the filterable key in their
+// copyset index entry come back as empty records marked filtered_out.
+// CatchupOneStream should merge consecutive ones into FILTERED_OUT gaps sent
+// in order with the other records.
+TEST_F(CatchupQueueTest, KeyFilteredRecordsSentAsGaps) {
+  read_stream_id_t read_stream_id(123123);
+  ServerReadStream& stream = createStream(read_stream_id);
+  stream.setWindowHigh(100);
+  stream.filter_pred_ = ServerRecordFilterFactory::create(
+      ServerRecordFilterType::EQUALITY, "pass", "");
+
+  notifyNeedsCatchup(stream, read_stream_id);
+  ASSERT_EQ(1, tasks_.size());
+  std::unique_ptr<ReadStorageTask> task = std::move(tasks_.front());
+  ASSERT_EQ(1, task->read_ctx_.read_ptr_.lsn);
+  tasks_.clear();
+  messages_.clear();
+
+  auto filtered_out = [](lsn_t lsn) {
+    return RawRecord(lsn,
+                     Slice(),
+                     /*owned*/ false,
+                     /*from_under_replicated_region*/ false,
+                     /*filtered_out*/ true);
+  };
+  ReadStorageTask::RecordContainer records;
+  records.push_back(createFakeRecord(1, 50, {N1}, 1, 0, "pass", true));
+  records.push_back(filtered_out(2));
+  records.push_back(filtered_out(3));
+  records.push_back(createFakeRecord(4, 50, {N1}, 1, 0, "pass", true));
+  records.push_back(filtered_out(5));
+  task->status_ = E::CAUGHT_UP;
+  task->records_ = std::move(records);
+  task->read_ctx_.read_ptr_ = {lsn_t{6}};
+  streams_.onReadTaskDone(*task);
+
+  // RECORD 1, GAP [2, 3], RECORD 4, GAP [5, 5].
+  ASSERT_EQ(4, messages_.size());
+  for (int i : {0, 2}) {
+    RECORD_Message* msg =
+        dynamic_cast<RECORD_Message*>(messages_[i].first.get());
+    ASSERT_NE(nullptr, msg);
+    EXPECT_EQ(i == 0 ? 1 : 4, getHeader(*msg).lsn);
+  }
+  std::vector<std::pair<lsn_t, lsn_t>> expected_gaps{{2, 3}, {5, 5}};
+  for (int i : {1, 3}) {
+    GAP_Message* msg = dynamic_cast<GAP_Message*>(messages_[i].first.get());
+    ASSERT_NE(nullptr, msg);
+    EXPECT_EQ(GapReason::FILTERED_OUT, msg->getHeader().reason);
+    EXPECT_EQ(expected_gaps[i / 2],
+              std::make_pair(msg->getHeader().start_lsn,
+                             msg->getHeader().end_lsn));
+  }
+  ASSERT_EQ(0, tasks_.size());
+
+  // The next batch starts after the last filtered out record.
+  notifyNeedsCatchup(stream, read_stream_id);
+  ASSERT_EQ(1, tasks_.size());
+  EXPECT_EQ(6, tasks_.front()->read_ctx_.read_ptr_.lsn);
+  tasks_.clear();
+}
+
 // Many records are filtered by a first batch until we eventually reach the
 // limit on the number of bytes that can be read per batch. LocalLogStoreReader
 // completes the batch with E::PARTIAL, so CatchupOneStream should issue a gap
@@ -7,8 +7,11 @@
  */
 #include "logdevice/server/epoch_store/FileEpochStore.h"
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -45,11 +48,7 @@ class FileEpochStoreTest : public ::testing::Test {
     auto config = cluster_config_->get();
 
     poster_ = std::make_unique<InlineRequestPoster>();
-    store_ = std::make_unique<FileEpochStore>(
-        temp_dir_->path().string(),
-        RequestExecutor(poster_.get()),
-        folly::none,
-        cluster_config_->updateableNodesConfiguration());
+    store_ = makeStore(0);
 
     int rv = store_->provisionMetaDataLogs(
         std::make_shared<CustomEpochMetaDataUpdater>(
@@ -63,6 +62,16 @@ class FileEpochStoreTest : public ::testing::Test {
     ASSERT_EQ(0, rv);
   }
 
+  // Another store over the same directory.
+  std::unique_ptr<FileEpochStore> makeStore(size_t max_batch_logs) {
+    return std::make_unique<FileEpochStore>(
+        temp_dir_->path().string(),
+        RequestExecutor(poster_.get()),
+        folly::none,
+        cluster_config_->updateableNodesConfiguration(),
+        max_batch_logs);
+  }
+
  private:
   std::unique_ptr<TemporaryDirectory> temp_dir_;
 
@@ -242,3 +251,74 @@ TEST_F(FileEpochStoreTest, LastCleanEpoch) {
         });
   }
 }
+
+// Concurrent epoch bumps and LCE updates through a batching store are all
+// applied, including several requests for the same log in one batch.
+TEST_F(FileEpochStoreTest, BatchedUpdates) {
+  auto store = makeStore(8);
+  const int kThreads = 4;
+  const int kBumpsPerThread = 25;
+  std::atomic<int> ok{0};
+  std::atomic<int> lce_ok{0};
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < kBumpsPerThread; ++i) {
+        const logid_t logid((t + i) % 2 + 1);
+        store->createOrUpdateMetaData(
+            logid,
+            std::make_shared<EpochMetaDataUpdateToNextEpoch>(
+                EpochMetaData::Updater::Options().setProvisionIfEmpty()),
+            [&ok](Status status,
+                  logid_t,
+                  std::unique_ptr<EpochMetaData> info,
+                  std::unique_ptr<EpochStoreMetaProperties>) {
+              EXPECT_EQ(E::OK, status);
+              EXPECT_NE(nullptr, info);
+              ++ok;
+            },
+            MetaDataTracer());
+        store->setLastCleanEpoch(
+            logid,
+            epoch_t(i + 1),
+            TailRecord({logid, LSN_INVALID, 0, {BYTE_OFFSET_INVALID}, 0, {}},
+                       OffsetMap(),
+                       PayloadHolder()),
+            [&lce_ok](Status status, logid_t, epoch_t, TailRecord) {
+              // Another thread may have stored a higher LCE already.
+              EXPECT_TRUE(status == E::OK || status == E::STALE);
+              ++lce_ok;
+            });
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // Every request has completed by the time the last caller returns.
+  EXPECT_EQ(kThreads * kBumpsPerThread, ok.load());
+  EXPECT_EQ(kThreads * kBumpsPerThread, lce_ok.load());
+
+  // Each log started at epoch 1 and got half of the bumps.
+  for (logid_t logid : {logid_t(1), logid_t(2)}) {
+    store_->createOrUpdateMetaData(
+        logid,
+        std::make_shared<EpochMetaDataUpdateToNextEpoch>(
+            EpochMetaData::Updater::Options().setProvisionIfEmpty()),
+        [&](Status status,
+            logid_t,
+            std::unique_ptr<EpochMetaData> info,
+            std::unique_ptr<EpochStoreMetaProperties>) {
+          ASSERT_EQ(E::OK, status);
+          ASSERT_NE(nullptr, info);
+          EXPECT_EQ(kThreads * kBumpsPerThread / 2 + 2, info->h.epoch.val());
+        },
+        MetaDataTracer());
+    store_->getLastCleanEpoch(
+        logid, [&](Status status, logid_t, epoch_t epoch, TailRecord) {
+          ASSERT_EQ(E::OK, status);
+          EXPECT_EQ(epoch_t(kBumpsPerThread), epoch);
+        });
+  }
+}
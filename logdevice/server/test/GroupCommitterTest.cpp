@@ -0,0 +1,120 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/storage_tasks/GroupCommitter.h"
+
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "logdevice/common/debug.h"
+#include "logdevice/common/settings/util.h"
+#include "logdevice/common/stats/Stats.h"
+#include "logdevice/server/locallogstore/WriteOps.h"
+#include "logdevice/server/locallogstore/test/TemporaryLogStore.h"
+
+using namespace facebook::logdevice;
+
+namespace {
+
+std::string makeHeader() {
+  std::string header;
+  std::array<ShardID, 2> cs = {ShardID(41, 0), ShardID(42, 0)};
+  LocalLogStoreRecordFormat::formRecordHeader(
+      0,
+      esn_t(0),
+      LocalLogStoreRecordFormat::FLAG_CHECKSUM_PARITY,
+      0,
+      folly::Range<const ShardID*>(cs.begin(), cs.end()),
+      OffsetMap(),
+      std::map<KeyType, std::string>(),
+      &header);
+  return header;
+}
+
+UpdateableSettings<Settings> makeSettings(std::chrono::microseconds budget) {
+  Settings settings = create_default_settings<Settings>();
+  settings.write_group_commit = true;
+  settings.write_group_commit_latency_budget = budget;
+  settings.write_group_commit_max_ops = 16;
+  return UpdateableSettings<Settings>(settings);
+}
+
+} // namespace
+
+// Many threads commit small batches concurrently. All writes must land, every
+// writer that asked for a sync must see one, and groups must have formed.
+TEST(GroupCommitterTest, ConcurrentWriters) {
+  const int nthreads = 8;
+  const int nwrites = 100;
+
+  TemporaryRocksDBStore store;
+  StatsHolder stats(StatsParams().setIsServer(true));
+  GroupCommitter committer(
+      &store, makeSettings(std::chrono::milliseconds(2)), &stats);
+  const std::string header = makeHeader();
+
+  std::atomic<int> failures{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < nthreads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < nwrites; ++i) {
+        PutWriteOp op{logid_t(1),
+                      lsn_t(t * nwrites + i + 1),
+                      Slice(header.data(), header.size())};
+        const bool sync = i % 2 == 0;
+        bool synced = false;
+        if (committer.commit({&op}, sync, &synced) != 0 ||
+            (sync && !synced)) {
+          ++failures;
+        }
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(0, failures.load());
+
+  auto it = store.read(logid_t(1), LocalLogStore::ReadOptions("Test"));
+  it->seek(0);
+  int nread = 0;
+  for (; it->state() == IteratorState::AT_RECORD; it->next()) {
+    ++nread;
+  }
+  EXPECT_EQ(nthreads * nwrites, nread);
+
+  Stats s = stats.aggregate();
+  EXPECT_EQ(nthreads * nwrites, s.write_group_commit_members);
+  EXPECT_GT(s.write_group_commit_groups, 0);
+  EXPECT_LE(s.write_group_commit_groups, s.write_group_commit_members);
+  EXPECT_GT(s.write_group_commit_syncs, 0);
+  ld_info("%ld writers in %ld groups, %ld syncs",
+          s.write_group_commit_members.load(),
+          s.write_group_commit_groups.load(),
+          s.write_group_commit_syncs.load());
+}
+
+// A lone writer never gets followers, so it shouldn't wait for them.
+TEST(GroupCommitterTest, NoWindowForSingleWriter) {
+  TemporaryRocksDBStore store;
+  GroupCommitter committer(
+      &store, makeSettings(std::chrono::milliseconds(2)), nullptr);
+  const std::string header = makeHeader();
+
+  for (int i = 0; i < 20; ++i) {
+    PutWriteOp op{
+        logid_t(1), lsn_t(i + 1), Slice(header.data(), header.size())};
+    bool synced = false;
+    ASSERT_EQ(0, committer.commit({&op}, false, &synced));
+    EXPECT_FALSE(synced);
+  }
+  EXPECT_EQ(std::chrono::microseconds(0), committer.getWindow());
+}
@@ -0,0 +1,266 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/locallogstore/IOTracing.h"
+
+#include <atomic>
+#include <future>
+#include <map>
+#include <thread>
+#include <vector>
+
+#include <folly/FileUtil.h>
+#include <gtest/gtest.h>
+
+#include "logdevice/common/stats/PerShardHistograms.h"
+#include "logdevice/common/stats/Stats.h"
+#include "logdevice/common/test/TestUtil.h"
+#include "logdevice/server/locallogstore/IOTraceBuffer.h"
+
+using namespace facebook::logdevice;
+
+namespace {
+
+IOTraceEvent makeEvent(uint64_t i) {
+  IOTraceEvent e{};
+  e.start_time_us = i;
+  e.latency_us = i % 1000;
+  e.cf_id = IOTraceEvent::CF_UNKNOWN;
+  e.file_number = i;
+  e.offset = i * 4096;
+  e.size = 4096;
+  e.shard = 1;
+  e.op = IOTraceOp::READ;
+  e.context = IOTraceContext::READ_STREAM;
+  e.file_type = IOTraceFileType::SST;
+  return e;
+}
+
+} // namespace
+
+TEST(IOTracingTest, ParseFile) {
+  IOTraceFile f = IOTraceFile::parse("367120.sst");
+  EXPECT_EQ(IOTraceFileType::SST, f.type);
+  EXPECT_EQ(367120, f.number);
+
+  f = IOTraceFile::parse("/data/shard0/000042.log");
+  EXPECT_EQ(IOTraceFileType::WAL, f.type);
+  EXPECT_EQ(42, f.number);
+
+  f = IOTraceFile::parse("MANIFEST-000007");
+  EXPECT_EQ(IOTraceFileType::MANIFEST, f.type);
+  EXPECT_EQ(7, f.number);
+
+  f = IOTraceFile::parse("CURRENT");
+  EXPECT_EQ(IOTraceFileType::OTHER, f.type);
+  EXPECT_EQ(0, f.number);
+
+  f = IOTraceFile::parse("foo.sst");
+  EXPECT_EQ(IOTraceFileType::SST, f.type);
+  EXPECT_EQ(0, f.number);
+}
+
+TEST(IOTracingTest, RingWraparound) {
+  IOTraceRing ring(5);
+  EXPECT_EQ(8, ring.capacity());
+
+  std::vector<IOTraceEvent> events;
+  ring.snapshot(&events);
+  EXPECT_TRUE(events.empty());
+
+  for (uint64_t i = 0; i < 3; ++i) {
+    ring.push(makeEvent(i));
+  }
+  ring.snapshot(&events);
+  ASSERT_EQ(3, events.size());
+  for (uint64_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(i, events[i].file_number);
+  }
+
+  for (uint64_t i = 3; i < 20; ++i) {
+    ring.push(makeEvent(i));
+  }
+  EXPECT_EQ(20, ring.numPushed());
+  events.clear();
+  ring.snapshot(&events);
+  // Only the last 8, oldest first.
+  ASSERT_EQ(8, events.size());
+  for (uint64_t i = 0; i < 8; ++i) {
+    EXPECT_EQ(12 + i, events[i].file_number);
+    EXPECT_EQ((12 + i) * 4096, events[i].offset);
+    EXPECT_EQ(IOTraceContext::READ_STREAM, events[i].context);
+  }
+}
+
+// Readers must never see a torn event.
+TEST(IOTracingTest, RingConcurrentSnapshot) {
+  IOTraceRing ring(64);
+  std::atomic<bool> done{false};
+
+  std::thread writer([&] {
+    for (uint64_t i = 0; i < 200000; ++i) {
+      ring.push(makeEvent(i));
+    }
+    done.store(true);
+  });
+
+  std::vector<IOTraceEvent> events;
+  while (!done.load()) {
+    events.clear();
+    ring.snapshot(&events);
+    EXPECT_LE(events.size(), 64);
+    for (size_t j = 0; j < events.size(); ++j) {
+      const IOTraceEvent& e = events[j];
+      ASSERT_EQ(e.start_time_us, e.file_number);
+      ASSERT_EQ(e.file_number * 4096, e.offset);
+      ASSERT_EQ(e.file_number % 1000, e.latency_us);
+      if (j > 0) {
+        EXPECT_LT(events[j - 1].file_number, e.file_number);
+      }
+    }
+  }
+  writer.join();
+}
+
+TEST(IOTracingTest, File) {
+  TemporaryDirectory dir("IOTracingTest");
+  const std::string path = (dir.path() / "trace").string();
+
+  std::vector<IOTraceEvent> events;
+  for (uint64_t i = 0; i < 10; ++i) {
+    events.push_back(makeEvent(i));
+  }
+  ASSERT_EQ(0, writeIOTraceFile(path, events));
+
+  std::vector<IOTraceEvent> read;
+  ASSERT_EQ(0, readIOTraceFile(path, &read));
+  ASSERT_EQ(events.size(), read.size());
+  for (size_t i = 0; i < events.size(); ++i) {
+    EXPECT_EQ(0, memcmp(&events[i], &read[i], sizeof(IOTraceEvent)));
+  }
+
+  ASSERT_EQ(0, writeIOTraceFile(path, {}));
+  ASSERT_EQ(0, readIOTraceFile(path, &read));
+  EXPECT_TRUE(read.empty());
+
+  EXPECT_EQ(-1, readIOTraceFile((dir.path() / "nope").string(), &read));
+  EXPECT_EQ(E::NOTFOUND, err);
+
+  const std::string bad_path = (dir.path() / "bad").string();
+  ASSERT_TRUE(
+      folly::writeFile(std::string("not an IO trace"), bad_path.c_str()));
+  EXPECT_EQ(-1, readIOTraceFile(bad_path, &read));
+  EXPECT_EQ(E::BADMSG, err);
+}
+
+TEST(IOTracingTest, BinaryTracing) {
+  IOTracing disabled(0, nullptr);
+  EXPECT_FALSE(disabled.isBinaryTracingEnabled());
+  EXPECT_FALSE(disabled.isOpTracingEnabled());
+
+  IOTracing tracing(3, nullptr, 16);
+  ASSERT_TRUE(tracing.isBinaryTracingEnabled());
+  EXPECT_FALSE(tracing.isEnabled());
+
+  IOTraceOpInfo info;
+  info.op = IOTraceOp::WRITE;
+  info.file = IOTraceFile::parse("000012.sst");
+  info.offset = 100;
+  info.size = 200;
+  {
+    SCOPED_IO_TRACED_OP_WITH_INFO(&tracing, info, "write");
+  }
+  {
+    SCOPED_IO_TRACING_CONTEXT_TYPE(&tracing, IOTraceContext::FLUSH);
+    {
+      IOTracing::SetContextType cf(&tracing, IOTraceContext::COMPACTION, 5);
+      SCOPED_IO_TRACED_OP_WITH_INFO(&tracing, info, "write");
+    }
+    SCOPED_IO_TRACED_OP(&tracing, "stat");
+  }
+
+  // Events recorded by another thread are visible too, as long as the thread
+  // is alive.
+  std::promise<void> recorded;
+  std::promise<void> snapshotted;
+  std::thread thread([&] {
+    {
+      SCOPED_IO_TRACING_CONTEXT_TYPE(&tracing, IOTraceContext::REBUILDING);
+      SCOPED_IO_TRACED_OP_WITH_INFO(&tracing, info, "write");
+    }
+    recorded.set_value();
+    snapshotted.get_future().wait();
+  });
+  recorded.get_future().wait();
+  std::vector<IOTraceEvent> events = tracing.getRecentEvents();
+  snapshotted.set_value();
+  thread.join();
+
+  ASSERT_EQ(4, events.size());
+  // The operations above take less than a microsecond, so start times may not
+  // tell their order; look them up by context instead.
+  std::map<IOTraceContext, IOTraceEvent> by_context;
+  for (size_t i = 0; i < events.size(); ++i) {
+    if (i > 0) {
+      EXPECT_LE(events[i - 1].start_time_us, events[i].start_time_us);
+    }
+    by_context[events[i].context] = events[i];
+  }
+  ASSERT_EQ(4, by_context.size());
+
+  const IOTraceEvent& e = by_context[IOTraceContext::OTHER];
+  EXPECT_EQ(IOTraceEvent::CF_UNKNOWN, e.cf_id);
+  EXPECT_EQ(3, e.shard);
+  EXPECT_EQ(IOTraceOp::WRITE, e.op);
+  EXPECT_EQ(IOTraceFileType::SST, e.file_type);
+  EXPECT_EQ(12, e.file_number);
+  EXPECT_EQ(100, e.offset);
+  EXPECT_EQ(200, e.size);
+
+  EXPECT_EQ(5, by_context[IOTraceContext::COMPACTION].cf_id);
+
+  // The previous context is restored.
+  EXPECT_EQ(IOTraceEvent::CF_UNKNOWN, by_context[IOTraceContext::FLUSH].cf_id);
+  EXPECT_EQ(IOTraceOp::OTHER, by_context[IOTraceContext::FLUSH].op);
+
+  EXPECT_EQ(IOTraceOp::WRITE, by_context[IOTraceContext::REBUILDING].op);
+}
+
+// Latencies of traced operations go to the io_latency histogram of the
+// context they were done in, for the shard of the IOTracing.
+TEST(IOTracingTest, LatencyHistograms) {
+  StatsHolder stats(StatsParams().setIsServer(true));
+  IOTracing tracing(2, &stats, 16);
+  ASSERT_TRUE(tracing.isBinaryTracingEnabled());
+
+  IOTraceOpInfo info;
+  info.op = IOTraceOp::READ;
+  info.file = IOTraceFile::parse("000012.sst");
+  {
+    SCOPED_IO_TRACING_CONTEXT_TYPE(&tracing, IOTraceContext::READ_STREAM);
+    for (int i = 0; i < 2; ++i) {
+      SCOPED_IO_TRACED_OP_WITH_INFO(&tracing, info, "read");
+    }
+  }
+  {
+    SCOPED_IO_TRACED_OP_WITH_INFO(&tracing, info, "read");
+  }
+
+  Stats aggregated = stats.aggregate();
+  ASSERT_NE(nullptr, aggregated.per_shard_histograms);
+  auto count = [&](IOTraceContext context, shard_index_t shard) {
+    return aggregated.per_shard_histograms
+        ->io_latency[static_cast<int>(context)]
+        .get(shard)
+        ->getCountAndSum()
+        .first;
+  };
+  EXPECT_EQ(2, count(IOTraceContext::READ_STREAM, 2));
+  EXPECT_EQ(1, count(IOTraceContext::OTHER, 2));
+  EXPECT_EQ(0, count(IOTraceContext::COMPACTION, 2));
+  EXPECT_EQ(0, count(IOTraceContext::READ_STREAM, 0));
+}
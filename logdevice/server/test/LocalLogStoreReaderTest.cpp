@@ -19,6 +19,7 @@
 #include "logdevice/common/test/NodeSetTestUtil.h"
 #include "logdevice/common/test/TestUtil.h"
 #include "logdevice/common/util.h"
+#include "logdevice/server/ServerRecordFilterFactory.h"
 #include "logdevice/server/locallogstore/LocalLogStore.h"
 #include "logdevice/server/locallogstore/WriteOps.h"
 #include "logdevice/server/locallogstore/test/LocalLogStoreTestReader.h"
@@ -62,6 +63,9 @@ struct RecordDescriptor {
   STORE_flags_t flags = 0;
   size_t extra_payload_size = 0;
   DataKeyFormat key_format = DataKeyFormat::DEFAULT;
+  // If not empty, the record's KeyType::FILTERABLE key, also written to its
+  // copyset index entry.
+  std::string filterable_key;
 };
 
 } // namespace
@@ -119,12 +123,12 @@ class LocalLogStoreReaderTest : public ::testing::TestWithParam<Options> {
     for (ShardID shard : rec.copyset) {
       chain.push_back(StoreChainLink{shard, ClientID::INVALID});
     }
+    std::map<KeyType, std::string> optional_keys;
+    if (!rec.filterable_key.empty()) {
+      optional_keys[KeyType::FILTERABLE] = rec.filterable_key;
+    }
     return LocalLogStoreRecordFormat::formRecordHeader(
-        hdr,
-        chain.data(),
-        buf,
-        shardIDInCopyset(),
-        std::map<KeyType, std::string>());
+        hdr, chain.data(), buf, shardIDInCopyset(), optional_keys);
   }
 
   Slice formCopySetIndexEntry(const RecordDescriptor& rec, std::string* buf) {
@@ -137,7 +141,8 @@ class LocalLogStoreReaderTest : public ::testing::TestWithParam<Options> {
                                                             rec.copyset.size(),
                                                             LSN_INVALID,
                                                             flags,
-                                                            buf);
+                                                            buf,
+                                                            rec.filterable_key);
   }
 
   // Create a temporary store with initial data on it for one log.
@@ -1247,6 +1252,42 @@ TEST_P(LocalLogStoreReaderTest, ReadPtrContinuityPartial) {
   ASSERT_SHIPPED(records, 2);
 }
 
+// Records whose copyset index entry has a filterable key that doesn't pass the
+// server-side filter are passed to Callback::processFilteredOut() in LSN order,
+// without being read. Without the copyset index, all records are read and
+// shipped, and filtering is left to the caller.
+TEST_P(LocalLogStoreReaderTest, KeyFilteredRecords) {
+  const std::vector<std::string> keys{"a", "b", "b", "a", "b"};
+  std::vector<RecordDescriptor> data;
+  for (lsn_t lsn = 1; lsn <= keys.size(); ++lsn) {
+    RecordDescriptor rec{lsn, 1, {N1, N2, N3}};
+    rec.filterable_key = keys[lsn - 1];
+    data.push_back(rec);
+  }
+  auto store = createStore(data);
+
+  auto filter = std::make_shared<LLSFilter>();
+  filter->key_filter_ = ServerRecordFilterFactory::create(
+      ServerRecordFilterType::EQUALITY, "a", "");
+  std::vector<RawRecord> records;
+  ReadPointer read_ptr;
+  const Status st = ReadOperation()
+                        .use_csi(useCSI())
+                        .window_high(10)
+                        .last_released(5)
+                        .filter(filter)
+                        .process(store.get(), records, &read_ptr);
+
+  ASSERT_EQ(E::CAUGHT_UP, st);
+  ASSERT_SHIPPED(records, 1, 2, 3, 4, 5);
+  for (const RawRecord& record : records) {
+    const bool filtered_out = useCSI() && keys[record.lsn - 1] != "a";
+    EXPECT_EQ(filtered_out, record.filtered_out) << record.lsn;
+    EXPECT_EQ(filtered_out, record.blob.size == 0) << record.lsn;
+  }
+  ASSERT_EQ(6, read_ptr.lsn);
+}
+
 INSTANTIATE_TEST_CASE_P(LocalLogStoreReaderTest,
                         LocalLogStoreReaderTest,
                         ::testing::Values(WAVE_IN_VALUE,
@@ -7,6 +7,7 @@
  */
 #include "logdevice/server/read_path/LogStorageStateMap.h"
 
+#include <algorithm>
 #include <deque>
 #include <thread>
 #include <vector>
@@ -146,3 +147,58 @@ TEST(LogStorageStateMapTest, LastReleasedLSNSource) {
   EXPECT_EQ(
       LogStorageState::LastReleasedSource::RELEASE, released_state.source());
 }
+
+/**
+ * Inserts enough logs to make the index grow many times, with threads
+ * concurrently looking up and inserting the same logs. Every thread must see
+ * the same LogStorageState for a log, and addresses must stay stable.
+ */
+TEST(LogStorageStateMapTest, ConcurrentInsertAndGrow) {
+  const int num_logs = 100000;
+  const int num_threads = 8;
+  LogStorageStateMap map(1, /*stats*/ nullptr, /*record cache*/ false);
+
+  std::vector<std::vector<LogStorageState*>> seen(num_threads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&map, &seen, t] {
+      seen[t].resize(num_logs + 1);
+      // Half the threads go in the opposite order to race on insertions.
+      for (int i = 1; i <= num_logs; ++i) {
+        const int log_id = t % 2 ? i : num_logs + 1 - i;
+        LogStorageState* state = map.insertOrGet(logid_t(log_id), THIS_SHARD);
+        ASSERT_NE(nullptr, state);
+        ASSERT_EQ(state, map.find(logid_t(log_id), THIS_SHARD));
+        seen[t][log_id] = state;
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 1; i <= num_logs; ++i) {
+    LogStorageState* state = map.find(logid_t(i), THIS_SHARD);
+    ASSERT_NE(nullptr, state);
+    for (int t = 0; t < num_threads; ++t) {
+      ASSERT_EQ(state, seen[t][i]);
+    }
+  }
+  EXPECT_EQ(nullptr, map.find(logid_t(num_logs + 1), THIS_SHARD));
+
+  std::vector<logid_t::raw_type> visited;
+  int rv = map.forEachLogOnShard(
+      THIS_SHARD, [&](logid_t log_id, const LogStorageState&) {
+        visited.push_back(log_id.val_);
+        return 0;
+      });
+  ASSERT_EQ(0, rv);
+  ASSERT_EQ(num_logs, visited.size());
+  std::sort(visited.begin(), visited.end());
+  for (int i = 1; i <= num_logs; ++i) {
+    ASSERT_EQ(i, visited[i - 1]);
+  }
+
+  map.clear();
+  EXPECT_EQ(nullptr, map.find(logid_t(1), THIS_SHARD));
+}
@@ -10,8 +10,10 @@
 #include <algorithm>
 #include <chrono>
 #include <cstdlib>
+#include <cstring>
 #include <thread>
 
+#include <folly/FileUtil.h>
 #include <folly/Memory.h>
 #include <folly/Random.h>
 #include <gtest/gtest.h>
@@ -22,10 +24,13 @@
 #include "logdevice/common/SlidingWindow.h"
 #include "logdevice/common/debug.h"
 #include "logdevice/common/protocol/STORE_Message.h"
+#include "logdevice/common/test/TestUtil.h"
 #include "logdevice/common/util.h"
 #include "logdevice/server/EpochRecordCache.h"
 #include "logdevice/server/EpochRecordCacheEntry.h"
+#include "logdevice/server/EpochRecordCacheEntryArena.h"
 #include "logdevice/server/RecordCacheDependencies.h"
+#include "logdevice/server/RecordCacheFile.h"
 
 using namespace facebook::logdevice;
 using StoredBefore = EpochRecordCache::StoredBefore;
@@ -1442,6 +1447,109 @@ TEST_F(EpochRecordCacheTest, Keys) {
       1,
       copyset_t({N2, N3, N4}));
 }
+
+// Entries created by the cache live in the arena of the epoch. Slots of
+// disposed entries are reused, slabs only grow while entries are referenced
+// outside the cache, and are given back as soon as all their entries are
+// disposed of.
+TEST_F(EpochRecordCacheTest, EntryArena) {
+  capacity_ = 16;
+  stored_before_ = StoredBefore::NEVER;
+  create();
+
+  auto put_round = [&](esn_t::raw_type round) {
+    const esn_t::raw_type base = round * 8;
+    for (esn_t::raw_type i = 1; i <= 8; ++i) {
+      ASSERT_EQ(0, putRecord(cache_.get(), lsn(EPOCH, base + i), base));
+    }
+    cache_->advanceLNG(esn_t(base + 8));
+  };
+
+  put_round(0);
+  ASSERT_EQ(8, dropped_.size());
+  EpochRecordCacheEntryArena* arena = dropped_.front()->getArena();
+  ASSERT_NE(nullptr, arena);
+  for (const auto& entry : dropped_) {
+    ASSERT_EQ(arena, entry->getArena());
+  }
+  dropped_.clear();
+  const size_t initial_bytes = arena->bytesAllocated();
+  ASSERT_GT(initial_bytes, 0);
+
+  // entries are disposed of after each round, their slots get reused
+  for (esn_t::raw_type round = 1; round < 10; ++round) {
+    put_round(round);
+    dropped_.clear();
+    ASSERT_EQ(initial_bytes, arena->bytesAllocated());
+  }
+
+  // keep entries alive past their eviction, the arena has to grow
+  for (esn_t::raw_type round = 10; round < 14; ++round) {
+    put_round(round);
+  }
+  ASSERT_EQ(32, dropped_.size());
+  ASSERT_GT(arena->bytesAllocated(), initial_bytes);
+
+  // dispose of half of the entries: the slabs that held them are freed
+  const size_t grown_bytes = arena->bytesAllocated();
+  dropped_.erase(dropped_.begin(), dropped_.begin() + 16);
+  ASSERT_LT(arena->bytesAllocated(), grown_bytes);
+  ASSERT_GT(arena->bytesAllocated(), initial_bytes);
+
+  // all entries gone, only the first slab of each size is kept
+  dropped_.clear();
+  ASSERT_EQ(initial_bytes, arena->bytesAllocated());
+
+  // entries outlive the cache, and so does the arena
+  ASSERT_EQ(0, putRecord(cache_.get(), lsn(EPOCH, 121), 120));
+  cache_.reset();
+  ASSERT_EQ(1, dropped_.size());
+  verifyEntry(*dropped_.back(), lsn(EPOCH, 121));
+  ASSERT_EQ(arena, dropped_.back()->getArena());
+  ASSERT_EQ(initial_bytes, arena->bytesAllocated());
+  dropped_.clear();
+}
+
+// The first slabs are small, later ones bigger, and slots of all slabs are
+// distinct and usable.
+TEST(EpochRecordCacheEntryArenaTest, SlabGrowth) {
+  auto arena = new EpochRecordCacheEntryArena(
+      EpochRecordCacheEntryArena::kMaxSlabEntries, nullptr);
+  const size_t entry_size = EpochRecordCacheEntry::kAllocationHeaderSize +
+      sizeof(EpochRecordCacheEntry);
+
+  std::vector<void*> slots;
+  slots.push_back(arena->allocate(entry_size));
+  const size_t first_slab_bytes = arena->bytesAllocated();
+  ASSERT_GT(first_slab_bytes, 0);
+  // Room for a few entries, not for kMaxSlabEntries.
+  ASSERT_LT(first_slab_bytes, 16 * entry_size);
+
+  for (size_t i = 1; i < EpochRecordCacheEntryArena::kMaxSlabEntries; ++i) {
+    slots.push_back(arena->allocate(entry_size));
+  }
+  for (size_t i = 0; i < slots.size(); ++i) {
+    memset(slots[i], static_cast<int>(i), entry_size);
+  }
+  for (size_t i = 0; i < slots.size(); ++i) {
+    const char* p = static_cast<const char*>(slots[i]);
+    ASSERT_EQ(entry_size,
+              static_cast<size_t>(
+                  std::count(p, p + entry_size, static_cast<char>(i))));
+  }
+  // Slabs are filled, so the arena is not much bigger than its slots.
+  ASSERT_LT(arena->bytesAllocated(),
+            slots.size() * entry_size +
+                2 * EpochRecordCacheEntryArena::kMaxSlabBytes);
+
+  // Freeing everything gives back all slabs but the first one.
+  for (void* slot : slots) {
+    arena->deallocate(slot, entry_size);
+  }
+  ASSERT_EQ(first_slab_bytes, arena->bytesAllocated());
+  arena->release();
+}
+
 // TODO:add tests for ESN_MAX corner cases
 
 ///////////////////// RecordCache Tests /////////////////////////
@@ -2189,3 +2297,98 @@ TEST_F(RecordCacheTest, SequencingSizeCalculation) {
   ASSERT_NE(linear_size, -1);
   ASSERT_EQ(calculated_size, linear_size);
 }
+
+TEST_F(RecordCacheTest, PersistToFile) {
+  epoch_cache_capacity_ = 10;
+  create();
+  TemporaryDirectory dir("RecordCacheTest");
+  const std::string path = (dir.path() / RecordCacheFile::FILE_NAME).string();
+
+  auto serialize = [&] {
+    std::string buf(cache_->sizeInLinearBuffer(), '\0');
+    EXPECT_EQ(ssize_t(buf.size()), cache_->toLinearBuffer(&buf[0], buf.size()));
+    return buf;
+  };
+
+  const uint64_t version = cache_->getVersion();
+  ASSERT_EQ(0, putRecord(cache_.get(), lsn(epoch_t(5), 7), 2));
+  ASSERT_GT(cache_->getVersion(), version);
+  const std::string first = serialize();
+  ASSERT_EQ(0, putRecord(cache_.get(), lsn(epoch_t(8), 5), 2));
+  const std::string second = serialize();
+
+  auto writer = RecordCacheFileWriter::create(path);
+  ASSERT_NE(nullptr, writer);
+  ASSERT_EQ(0, writer->append(LOG_ID, Slice(first.data(), first.size())));
+  ASSERT_EQ(0, writer->append(logid_t(8), Slice(first.data(), first.size())));
+  // the latest copy of a log replaces the previous one
+  ASSERT_EQ(0, writer->append(LOG_ID, Slice(second.data(), second.size())));
+  writer->remove(logid_t(8));
+  ASSERT_EQ(1, writer->numLogs());
+  ASSERT_EQ(second.size(), writer->liveBytes());
+  ASSERT_EQ(0, writer->seal());
+  writer.reset();
+
+  auto reader = RecordCacheFileReader::open(path);
+  ASSERT_NE(nullptr, reader);
+  ASSERT_EQ(std::vector<logid_t>{LOG_ID}, reader->logs());
+  Slice blob;
+  ASSERT_EQ(-1, reader->find(logid_t(8), &blob));
+  ASSERT_EQ(E::NOTFOUND, err);
+  ASSERT_EQ(0, reader->find(LOG_ID, &blob));
+  ASSERT_EQ(second,
+            std::string(static_cast<const char*>(blob.data), blob.size));
+
+  auto restored = RecordCache::fromLinearBuffer(
+      static_cast<const char*>(blob.data), blob.size, deps_.get(), SHARD);
+  ASSERT_NE(nullptr, restored);
+  ASSERT_TRUE(testRecordCachesIdentical(*cache_, *restored));
+}
+
+TEST_F(RecordCacheTest, UnsealedOrCorruptedFile) {
+  epoch_cache_capacity_ = 10;
+  create();
+  TemporaryDirectory dir("RecordCacheTest");
+  const std::string path = (dir.path() / RecordCacheFile::FILE_NAME).string();
+
+  ASSERT_EQ(nullptr, RecordCacheFileReader::open(path));
+  ASSERT_EQ(E::NOTFOUND, err);
+
+  ASSERT_EQ(0, putRecord(cache_.get(), lsn(epoch_t(5), 7), 2));
+  std::string buf(cache_->sizeInLinearBuffer(), '\0');
+  ASSERT_EQ(ssize_t(buf.size()), cache_->toLinearBuffer(&buf[0], buf.size()));
+
+  // a file that was never sealed, e.g. after a crash, must not be used
+  auto writer = RecordCacheFileWriter::create(path);
+  ASSERT_NE(nullptr, writer);
+  ASSERT_EQ(0, writer->append(LOG_ID, Slice(buf.data(), buf.size())));
+  writer.reset();
+  ASSERT_EQ(nullptr, RecordCacheFileReader::open(path));
+  ASSERT_EQ(E::BADMSG, err);
+
+  writer = RecordCacheFileWriter::create(path);
+  ASSERT_NE(nullptr, writer);
+  ASSERT_EQ(0, writer->append(LOG_ID, Slice(buf.data(), buf.size())));
+  ASSERT_EQ(0, writer->seal());
+  writer.reset();
+
+  // flip a byte of the serialized cache, right after the file and entry
+  // headers; the index is intact but the entry fails its checksum
+  std::string contents;
+  ASSERT_TRUE(folly::readFile(path.c_str(), contents));
+  contents[sizeof(RecordCacheFile::FileHeader) +
+           sizeof(RecordCacheFile::EntryHeader)] ^= 1;
+  ASSERT_TRUE(folly::writeFile(contents, path.c_str()));
+
+  auto reader = RecordCacheFileReader::open(path);
+  ASSERT_NE(nullptr, reader);
+  Slice blob;
+  ASSERT_EQ(-1, reader->find(LOG_ID, &blob));
+  ASSERT_EQ(E::BADMSG, err);
+
+  // a truncated file has no trailer
+  contents.resize(contents.size() - 1);
+  ASSERT_TRUE(folly::writeFile(contents, path.c_str()));
+  ASSERT_EQ(nullptr, RecordCacheFileReader::open(path));
+  ASSERT_EQ(E::BADMSG, err);
+}
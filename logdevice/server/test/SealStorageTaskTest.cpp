@@ -99,6 +99,68 @@ TEST(SealStorageTaskTest, UpdateSealSmaller) {
   EXPECT_EQ(epoch_t(2), seal.value().epoch);
 }
 
+// Seal several logs with one write, as for a SEAL_BATCH message. The result
+// for each log must be the same as if it had been sealed on its own.
+TEST(SealStorageTaskTest, ExecuteBatch) {
+  TemporaryRocksDBStore store;
+  LogStorageStateMap map(1, /*stats*/ nullptr, /*record_cache*/ false);
+
+  // log 2 is already sealed up to epoch 5 in the local log store
+  store.writeLogMetadata(logid_t(2),
+                         SealMetadata(Seal(epoch_t(5), NodeID(0, 1))),
+                         LocalLogStore::WriteOptions());
+  // log 3 is already sealed up to epoch 2, this is a retry
+  {
+    TestSealStorageTask task = create_task(logid_t(3), epoch_t(2), EPOCH_MIN);
+    ASSERT_EQ(E::OK, task.executeImpl(store, map));
+  }
+
+  std::vector<std::unique_ptr<TestSealStorageTask>> tasks;
+  auto add = [&](logid_t log, epoch_t seal_epoch) {
+    tasks.push_back(std::make_unique<TestSealStorageTask>(
+        create_task(log, seal_epoch, EPOCH_MIN)));
+  };
+  add(logid_t(1), epoch_t(3));
+  add(logid_t(2), epoch_t(3));
+  add(logid_t(3), epoch_t(2));
+  // log 4 twice in the same batch, the second seal is preempted by the first
+  add(logid_t(4), epoch_t(3));
+  add(logid_t(4), epoch_t(2));
+
+  std::vector<SealStorageTask*> ptrs;
+  for (auto& task : tasks) {
+    ptrs.push_back(task.get());
+  }
+  SealStorageTask::executeBatch(ptrs, store, map);
+
+  EXPECT_EQ(E::OK, tasks[0]->getStatus());
+  EXPECT_EQ(Durability::SYNC_WRITE, tasks[0]->durability());
+  EXPECT_EQ(E::PREEMPTED, tasks[1]->getStatus());
+  EXPECT_EQ(epoch_t(5), tasks[1]->getSeal().epoch);
+  EXPECT_EQ(E::OK, tasks[2]->getStatus());
+  EXPECT_EQ(Durability::INVALID, tasks[2]->durability());
+  EXPECT_EQ(E::OK, tasks[3]->getStatus());
+  EXPECT_EQ(E::PREEMPTED, tasks[4]->getStatus());
+  EXPECT_EQ(epoch_t(3), tasks[4]->getSeal().epoch);
+
+  // seals are in the state map and the local log store
+  const std::vector<std::pair<logid_t, epoch_t>> expected = {
+      {logid_t(1), epoch_t(3)},
+      {logid_t(2), epoch_t(5)},
+      {logid_t(3), epoch_t(2)},
+      {logid_t(4), epoch_t(3)}};
+  for (const auto& e : expected) {
+    folly::Optional<Seal> seal =
+        map.get(e.first, SHARD_IDX).getSeal(LogStorageState::SealType::NORMAL);
+    ASSERT_TRUE(seal.has_value());
+    EXPECT_EQ(e.second, seal.value().epoch);
+
+    SealMetadata meta;
+    ASSERT_EQ(0, store.readLogMetadata(e.first, &meta));
+    EXPECT_EQ(e.second, meta.seal_.epoch);
+  }
+}
+
 TEST(SealStorageTaskTest, LastKnownGood) {
   TemporaryRocksDBStore store;
   LogStorageStateMap map(1, /*stats*/ nullptr, /*record_cache*/ false);
@@ -98,15 +98,18 @@ class MockWriteStorageTask : public WriteStorageTask {
 /**
  * Spins up storage thread pool, has it do some trivial tasks, verifies that
  * the pool can cleanly shut down. The seconds iteration drives the DRR
- * scheduler code path.
+ * scheduler code path, the third one the work stealing queue.
  */
 TEST(StorageThreadPoolTest, Basic) {
-  for (int testIter = 0; testIter < 2; testIter++) {
+  for (int testIter = 0; testIter < 3; testIter++) {
     ld_info("starting test iter %d", testIter);
     Settings init_settings = create_default_settings<Settings>();
     if (testIter == 1) {
       init_settings.storage_tasks_use_drr = true;
     }
+    if (testIter == 2) {
+      init_settings.storage_tasks_work_stealing = true;
+    }
     UpdateableSettings<Settings> settings(init_settings);
     ServerSettings init_server_settings =
         create_default_settings<ServerSettings>();
@@ -218,12 +221,15 @@ TEST(StorageThreadPoolTest, DifferentPriorities) {
   Semaphore sem1;
   TemporaryRocksDBStore store;
 
-  for (int testIter = 0; testIter < 2; testIter++) {
+  for (int testIter = 0; testIter < 3; testIter++) {
     ld_info("starting test iter %d", testIter);
     Settings init_settings = create_default_settings<Settings>();
     if (testIter == 1) {
       init_settings.storage_tasks_use_drr = true;
     }
+    if (testIter == 2) {
+      init_settings.storage_tasks_work_stealing = true;
+    }
     UpdateableSettings<Settings> settings(init_settings);
     ServerSettings init_server_settings =
         create_default_settings<ServerSettings>();
@@ -259,6 +265,59 @@ TEST(StorageThreadPoolTest, DifferentPriorities) {
   }
 }
 
+// With --storage-tasks-steal-across-shards, an idle slow thread of one pool
+// executes a task stuck behind a busy thread of a peer pool.
+TEST(StorageThreadPoolTest, StealAcrossShards) {
+  struct StealableTask : public TestTask {
+    using TestTask::TestTask;
+    bool canExecuteOnOtherShard() const override {
+      return true;
+    }
+  };
+
+  Alarm alarm(std::chrono::seconds(60));
+  Settings init_settings = create_default_settings<Settings>();
+  init_settings.storage_tasks_work_stealing = true;
+  init_settings.storage_tasks_steal_across_shards = true;
+  UpdateableSettings<Settings> settings(init_settings);
+  UpdateableSettings<ServerSettings> server_settings(
+      create_default_settings<ServerSettings>());
+
+  Params params;
+  params[(size_t)StorageTaskThreadType::SLOW].nthreads = 1;
+  TemporaryRocksDBStore store0;
+  TemporaryRocksDBStore store1;
+  StorageThreadPool pool0(
+      0, 2, params, server_settings, settings, &store0, 16);
+  StorageThreadPool pool1(
+      1, 2, params, server_settings, settings, &store1, 16);
+  pool1.setStealPeers({&pool0});
+
+  // Occupy pool0's only thread.
+  Semaphore blocked;
+  Semaphore unblock;
+  ASSERT_EQ(0,
+            pool0.tryPutTask(std::make_unique<TestTask>(
+                StorageTask::ThreadType::SLOW, [&] {
+                  blocked.post();
+                  unblock.wait();
+                })));
+  blocked.wait();
+
+  // pool1's thread should pick this one up.
+  Semaphore done;
+  ASSERT_EQ(0,
+            pool0.tryPutTask(std::make_unique<StealableTask>(
+                StorageTask::ThreadType::SLOW, [&] { done.post(); })));
+  done.wait();
+
+  unblock.post();
+  pool1.shutDown();
+  pool0.shutDown();
+  pool1.join();
+  pool0.join();
+}
+
 TEST(StorageThreadPoolTest, IOPrio) {
   Settings init_settings = create_default_settings<Settings>();
   init_settings.slow_ioprio = std::make_pair(2, 2);
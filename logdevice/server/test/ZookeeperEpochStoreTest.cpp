@@ -7,10 +7,16 @@
  */
 #include "logdevice/server/epoch_store/ZookeeperEpochStore.h"
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <vector>
 
+#include <folly/Function.h>
+
 #include <gtest/gtest.h>
 
 #include "logdevice/common/EpochMetaData.h"
@@ -1246,3 +1252,227 @@ TEST_F(ZookeeperEpochStoreMigrationTest, testMigration) {
       });
   sem.wait();
 }
+
+/**
+ * Emulates the latency of a real ensemble: writes (setData and multi-ops) are
+ * committed one at a time by a single thread, each taking `commit_latency`,
+ * the way the leader serializes transactions. Reads keep the delay of
+ * ZookeeperClientInMemory.
+ */
+class SlowCommitZookeeperClient : public ZookeeperClientInMemory {
+ public:
+  SlowCommitZookeeperClient(std::string quorum,
+                            state_map_t map,
+                            std::chrono::microseconds commit_latency)
+      : ZookeeperClientInMemory(std::move(quorum), std::move(map)),
+        commit_latency_(commit_latency),
+        committer_([this] { run(); }) {}
+
+  ~SlowCommitZookeeperClient() override {
+    {
+      std::lock_guard<std::mutex> lock(txn_mutex_);
+      stop_ = true;
+    }
+    txn_cv_.notify_one();
+    committer_.join();
+  }
+
+  void setData(std::string path,
+               std::string data,
+               stat_callback_t cb,
+               zk::version_t base_version = -1) override {
+    commit([this,
+            path = std::move(path),
+            data = std::move(data),
+            cb = std::move(cb),
+            base_version]() mutable {
+      ZookeeperClientInMemory::setData(
+          std::move(path), std::move(data), std::move(cb), base_version);
+    });
+  }
+
+  void multiOp(std::vector<zk::Op> ops, multi_op_callback_t cb) override {
+    commit([this, ops = std::move(ops), cb = std::move(cb)]() mutable {
+      ZookeeperClientInMemory::multiOp(std::move(ops), std::move(cb));
+    });
+  }
+
+ private:
+  void commit(folly::Function<void()> txn) {
+    {
+      std::lock_guard<std::mutex> lock(txn_mutex_);
+      txns_.push_back(std::move(txn));
+    }
+    txn_cv_.notify_one();
+  }
+
+  void run() {
+    for (;;) {
+      folly::Function<void()> txn;
+      {
+        std::unique_lock<std::mutex> lock(txn_mutex_);
+        txn_cv_.wait(lock, [this] { return stop_ || !txns_.empty(); });
+        if (stop_) {
+          return;
+        }
+        txn = std::move(txns_.front());
+        txns_.pop_front();
+      }
+      /* sleep override */
+      std::this_thread::sleep_for(commit_latency_);
+      txn();
+    }
+  }
+
+  const std::chrono::microseconds commit_latency_;
+  std::mutex txn_mutex_;
+  std::condition_variable txn_cv_;
+  std::deque<folly::Function<void()>> txns_;
+  bool stop_{false};
+  std::thread committer_;
+};
+
+class ZookeeperEpochStoreMultiOpTest : public ZookeeperEpochStoreTestBase {
+ public:
+  ZookeeperClientInMemory::state_map_t getPrefillZnodes() override {
+    return {};
+  }
+
+  // Adds logs [first, first + count) to the config and switches the epoch
+  // store to a client with the given commit latency.
+  void init(logid_t::raw_type first,
+            size_t count,
+            std::chrono::microseconds commit_latency) {
+    auto logs_cfg = config->getLocalLogsConfig()->copyLocal();
+    logs_cfg->insert(
+        boost::icl::right_open_interval<logid_t::raw_type>(first,
+                                                           first + count),
+        "multi_op_logs",
+        logsconfig::LogAttributes().with_replicateAcross(
+            {{NodeLocationScope::NODE, 1}}));
+    config->updateableLogsConfig()->update(std::move(logs_cfg));
+
+    epochstore.reset();
+    zkclient = std::make_shared<SlowCommitZookeeperClient>(
+        config->getZookeeperConfig()->getQuorumString(),
+        getPrefillZnodes(),
+        commit_latency);
+    epochstore = std::make_unique<ZookeeperEpochStore>(
+        TEST_CLUSTER,
+        processor->getRequestExecutor(),
+        zkclient,
+        config->updateableNodesConfiguration(),
+        processor->updateableSettings(),
+        processor->getOptionalMyNodeID(),
+        processor->stats_);
+  }
+
+  void setSetting(const std::string& name, const std::string& value) {
+    auto settings = processor->updateableSettings();
+    SettingsUpdater updater{};
+    updater.registerSettings(settings);
+    updater.setFromAdminCmd(name, value);
+  }
+
+  // Bumps the epoch of every entry of `logs` concurrently (a log may appear
+  // more than once) and returns the status and epoch of each bump.
+  std::vector<std::pair<Status, epoch_t>>
+  bumpEpochs(const std::vector<logid_t>& logs) {
+    std::vector<std::pair<Status, epoch_t>> results(logs.size());
+    Semaphore sem;
+    for (size_t i = 0; i < logs.size(); ++i) {
+      int rv = epochstore->createOrUpdateMetaData(
+          logs[i],
+          std::make_shared<EpochMetaDataUpdateToNextEpoch>(
+              EpochMetaData::Updater::Options().setProvisionIfEmpty(),
+              config->get(),
+              config->get()->getNodesConfiguration()),
+          [&results, &sem, i](
+              Status st,
+              logid_t,
+              std::unique_ptr<EpochMetaData> info,
+              std::unique_ptr<EpochStoreMetaProperties> /*meta_props*/) {
+            results[i] =
+                std::make_pair(st, info ? info->h.epoch : EPOCH_INVALID);
+            sem.post();
+          },
+          MetaDataTracer());
+      EXPECT_EQ(0, rv);
+    }
+    for (size_t i = 0; i < logs.size(); ++i) {
+      sem.wait();
+    }
+    return results;
+  }
+};
+
+// Two concurrent bumps of each log are batched into the same multi-ops. The
+// conflicting one gets E::AGAIN and the others go through.
+TEST_F(ZookeeperEpochStoreMultiOpTest, Conflicts) {
+  const logid_t::raw_type first = 100;
+  const size_t num_logs = 16;
+  init(first, num_logs, std::chrono::milliseconds(20));
+  setSetting("epoch-store-multi-op-max-logs", "8");
+
+  std::vector<logid_t> logs;
+  for (size_t i = 0; i < num_logs; ++i) {
+    logs.push_back(logid_t(first + i));
+  }
+  // Provisioning is not batched.
+  auto provisioned = bumpEpochs(logs);
+  for (const auto& res : provisioned) {
+    ASSERT_EQ(E::OK, res.first);
+  }
+
+  std::vector<logid_t> twice(logs);
+  twice.insert(twice.end(), logs.begin(), logs.end());
+  auto results = bumpEpochs(twice);
+  std::vector<int> num_ok(num_logs, 0);
+  for (size_t i = 0; i < twice.size(); ++i) {
+    EXPECT_TRUE(results[i].first == E::OK || results[i].first == E::AGAIN)
+        << error_name(results[i].first);
+    if (results[i].first == E::OK) {
+      ++num_ok[i % num_logs];
+    }
+  }
+
+  // Every log ends up bumped exactly once per successful update.
+  auto last = bumpEpochs(logs);
+  for (size_t i = 0; i < num_logs; ++i) {
+    EXPECT_GE(num_ok[i], 1);
+    ASSERT_EQ(E::OK, last[i].first);
+    EXPECT_EQ(provisioned[i].second.val() + num_ok[i] + 1,
+              last[i].second.val());
+  }
+}
+
+// Throughput of bulk epoch bumps with a 2ms commit latency, without batching
+// and with multi-ops of increasing size.
+TEST_F(ZookeeperEpochStoreMultiOpTest, DISABLED_BulkActivationBenchmark) {
+  const logid_t::raw_type first = 100;
+  const size_t num_logs = 500;
+  init(first, num_logs, std::chrono::milliseconds(2));
+
+  std::vector<logid_t> logs;
+  for (size_t i = 0; i < num_logs; ++i) {
+    logs.push_back(logid_t(first + i));
+  }
+  bumpEpochs(logs);
+
+  for (const char* max_logs : {"0", "16", "64", "256"}) {
+    setSetting("epoch-store-multi-op-max-logs", max_logs);
+    auto start = std::chrono::steady_clock::now();
+    auto results = bumpEpochs(logs);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+    for (const auto& res : results) {
+      EXPECT_EQ(E::OK, res.first);
+    }
+    ld_info("epoch-store-multi-op-max-logs=%s: %lu epoch bumps in %ldms "
+            "(%.0f/s)",
+            max_logs,
+            num_logs,
+            elapsed.count(),
+            num_logs * 1000.0 / std::max<int64_t>(1, elapsed.count()));
+  }
+}
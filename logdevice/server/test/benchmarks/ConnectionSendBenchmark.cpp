@@ -0,0 +1,207 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <folly/Benchmark.h>
+#include <folly/Singleton.h>
+#include <folly/io/IOBuf.h>
+#include <gflags/gflags.h>
+
+#include "logdevice/common/PayloadHolder.h"
+#include "logdevice/common/Semaphore.h"
+#include "logdevice/common/Sender.h"
+#include "logdevice/common/Worker.h"
+#include "logdevice/common/protocol/Message.h"
+#include "logdevice/common/protocol/ProtocolWriter.h"
+#include "logdevice/common/protocol/TEST_Message.h"
+#include "logdevice/common/request_util.h"
+#include "logdevice/common/stats/Stats.h"
+#include "logdevice/common/test/TestUtil.h"
+#include "logdevice/lib/ClientImpl.h"
+#include "logdevice/test/utils/IntegrationTestUtils.h"
+
+/**
+ * @file: Cost of sending messages from a client to a node through Sender and
+ *        Connection, over a single TCP connection. The iters/s column is
+ *        messages handed to the socket per second.
+ *
+ *        The small message case sends TEST messages, which Connection
+ *        coalesces into the buffers of the batch. The payload cases send
+ *        messages with a payload that is serialized with writeWithoutCopy(),
+ *        like the payloads of RECORD and STORE messages, with
+ *        --socket-zero-copy-threshold off and on.
+ *
+ *        Counters, from the client's stats: bytes copied and bytes
+ *        referenced when serializing, per message, messages coalesced into
+ *        the previous buffer of a batch, and writes made with MSG_ZEROCOPY.
+ *        Note that the kernel copies MSG_ZEROCOPY data sent over loopback
+ *        anyway, so here the zero-copy cases only show the overhead of
+ *        tracking completions.
+ */
+
+DEFINE_int32(sends_per_loop_iteration,
+             1000,
+             "Number of messages to send in a single event loop iteration.");
+
+namespace facebook { namespace logdevice {
+
+namespace {
+
+// Pretends to be a TEST_Message, which the recipient accepts with any trailing
+// bytes and drops.
+class PayloadMessage : public Message {
+ public:
+  explicit PayloadMessage(PayloadHolder payload)
+      : Message(MessageType::TEST, TrafficClass::REBUILD),
+        payload_(std::move(payload)) {}
+
+  void serialize(ProtocolWriter& writer) const override {
+    payload_.serialize(writer);
+  }
+
+  Disposition onReceived(const Address&) override {
+    // Received as a TEST_Message.
+    ld_check(false);
+    return Disposition::ERROR;
+  }
+
+ private:
+  PayloadHolder payload_;
+};
+
+IntegrationTestUtils::Cluster& getCluster() {
+  static std::unique_ptr<IntegrationTestUtils::Cluster> cluster =
+      IntegrationTestUtils::ClusterFactory().useTcp().create(1);
+  return *cluster;
+}
+
+int64_t messagesReceived(IntegrationTestUtils::Cluster& cluster) {
+  return cluster.getNode(0).stats()["message_received.TEST"];
+}
+
+void sendMessages(folly::UserCounters& counters,
+                  size_t n,
+                  size_t payload_size,
+                  size_t zero_copy_threshold) {
+  IntegrationTestUtils::Cluster* cluster;
+  std::shared_ptr<Client> client;
+  Processor* processor;
+  folly::IOBuf payload;
+  int64_t received_before;
+  BENCHMARK_SUSPEND {
+    cluster = &getCluster();
+    std::unique_ptr<ClientSettings> settings(ClientSettings::create());
+    int rv = settings->set("num-workers", 1);
+    ld_check(rv == 0);
+    rv = settings->set("execute-requests", "1");
+    ld_check(rv == 0);
+    rv = settings->set("client-test-force-stats", "true");
+    ld_check(rv == 0);
+    rv = settings->set(
+        "socket-zero-copy-threshold", std::to_string(zero_copy_threshold));
+    ld_check(rv == 0);
+    client =
+        cluster->createClient(getDefaultTestTimeout(), std::move(settings));
+    processor = &checked_downcast<ClientImpl*>(client.get())->getProcessor();
+    if (payload_size > 0) {
+      payload = folly::IOBuf(folly::IOBuf::CREATE, payload_size);
+      payload.append(payload_size);
+    }
+    received_before = messagesReceived(*cluster);
+  }
+
+  // Sends from the only worker of the client, yielding to the event loop
+  // from time to time so that the connection flushes its batches.
+  Semaphore sem;
+  size_t to_send = n;
+  std::function<int()> send_fn;
+  send_fn = [&]() {
+    Worker* w = Worker::onThisThread();
+    int sent_in_this_iteration = 0;
+    while (to_send > 0) {
+      std::unique_ptr<Message> msg;
+      if (payload_size > 0) {
+        msg = std::make_unique<PayloadMessage>(
+            PayloadHolder(payload.cloneAsValue()));
+      } else {
+        msg = std::make_unique<TEST_Message>();
+      }
+      int rv = w->sender().sendMessage(std::move(msg), Address(NodeID(0)));
+      if (rv == 0) {
+        --to_send;
+        ++sent_in_this_iteration;
+      }
+      if (rv != 0 || sent_in_this_iteration >= FLAGS_sends_per_loop_iteration) {
+        auto fn = send_fn;
+        run_on_worker_nonblocking(processor,
+                                  w->idx_,
+                                  w->worker_type_,
+                                  RequestType::ADMIN_CMD_UTIL_INTERNAL,
+                                  std::move(fn),
+                                  true);
+        return 0;
+      }
+    }
+    sem.post();
+    return 0;
+  };
+  run_on_worker(processor, 0, send_fn);
+  sem.wait();
+
+  BENCHMARK_SUSPEND {
+    wait_until("all messages received", [&]() {
+      return messagesReceived(*cluster) - received_before >= int64_t(n);
+    });
+    StatsHolder* stats = checked_downcast<ClientImpl*>(client.get())->stats();
+    ld_check(stats);
+    Stats s = stats->aggregate();
+    const size_t messages = std::max(n, size_t(1));
+    counters["copied_bytes_per_msg"] =
+        s.sock_bytes_serialized_copied.load() / messages;
+    counters["zero_copy_bytes_per_msg"] =
+        s.sock_bytes_serialized_zero_copy.load() / messages;
+    counters["coalesced"] = s.sock_messages_coalesced.load();
+    counters["zero_copy_writes"] = s.sock_zero_copy_writes.load();
+    client.reset();
+  }
+}
+
+} // namespace
+
+#define PAYLOAD_BENCHMARKS(name, payload_size)                          \
+  BENCHMARK_COUNTERS(name##_copy, counters, n) {                        \
+    sendMessages(counters, n, payload_size, 0);                         \
+  }                                                                     \
+  BENCHMARK_COUNTERS_RELATIVE(name##_zero_copy, counters, n) {          \
+    sendMessages(counters, n, payload_size, 1);                         \
+  }                                                                     \
+  BENCHMARK_DRAW_LINE();
+
+BENCHMARK_COUNTERS(SmallMessages, counters, n) {
+  sendMessages(counters, n, 0, 0);
+}
+
+BENCHMARK_DRAW_LINE();
+
+PAYLOAD_BENCHMARKS(Payload4K, 4096)
+PAYLOAD_BENCHMARKS(Payload64K, 65536)
+PAYLOAD_BENCHMARKS(Payload1M, 1 << 20)
+
+}} // namespace facebook::logdevice
+
+#ifndef BENCHMARK_BUNDLE
+int main(int argc, char** argv) {
+  folly::SingletonVault::singleton()->registrationComplete();
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
+#endif
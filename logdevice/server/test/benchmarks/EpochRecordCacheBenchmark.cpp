@@ -0,0 +1,190 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <gflags/gflags.h>
+
+#include "logdevice/common/PayloadHolder.h"
+#include "logdevice/common/RecordID.h"
+#include "logdevice/server/EpochRecordCache.h"
+#include "logdevice/server/EpochRecordCacheEntry.h"
+#include "logdevice/server/EpochRecordCacheEntryArena.h"
+#include "logdevice/server/RecordCacheDependencies.h"
+
+using namespace facebook::logdevice;
+
+/**
+ * @file: Cost of creating and disposing of EpochRecordCache entries the way
+ *        the cache used to (entry and shared_ptr control block on the heap)
+ *        and with the per-epoch arena, plus the whole EpochRecordCache write
+ *        path with the arena. Counts heap allocations made by each and prints
+ *        them per entry after each run. Entries are kept alive for
+ *        --window_size more entries, like records waiting in the cache for
+ *        LNG to move past them.
+ */
+
+DEFINE_int32(window_size, 256, "Number of entries alive at any time.");
+
+namespace {
+
+std::atomic<size_t> heap_allocations{0};
+
+class Dependencies : public EpochRecordCacheDependencies {
+ public:
+  void disposeOfCacheEntry(std::unique_ptr<EpochRecordCacheEntry>) override {}
+  void onRecordsReleased(const EpochRecordCache&,
+                         lsn_t /* begin */,
+                         lsn_t /* end */,
+                         const ReleasedVector& /* entries */) override {}
+};
+
+std::shared_ptr<EpochRecordCacheEntry>
+createEntry(EpochRecordCacheEntryArena* arena,
+            EpochRecordCacheDependencies* deps,
+            lsn_t lsn) {
+  const copyset_t copyset{ShardID(1, 0), ShardID(2, 0), ShardID(3, 0)};
+  if (arena == nullptr) {
+    return std::shared_ptr<EpochRecordCacheEntry>(
+        new EpochRecordCacheEntry(lsn,
+                                  0,
+                                  lsn,
+                                  ESN_INVALID,
+                                  1,
+                                  copyset,
+                                  OffsetMap(),
+                                  std::map<KeyType, std::string>(),
+                                  PayloadHolder()),
+        EpochRecordCacheEntry::Disposer(deps));
+  }
+  return std::shared_ptr<EpochRecordCacheEntry>(
+      new (arena) EpochRecordCacheEntry(lsn,
+                                        0,
+                                        lsn,
+                                        ESN_INVALID,
+                                        1,
+                                        copyset,
+                                        OffsetMap(),
+                                        std::map<KeyType, std::string>(),
+                                        PayloadHolder()),
+      EpochRecordCacheEntry::Disposer(deps),
+      EpochRecordCacheEntryArena::Allocator<EpochRecordCacheEntry>(arena));
+}
+
+void printAllocations(const char* name, size_t allocations, size_t n) {
+  printf("%s: %zu heap allocations for %zu entries (%.3f per entry)\n",
+         name,
+         allocations,
+         n,
+         n > 0 ? double(allocations) / n : 0.);
+}
+
+void createEntries(bool use_arena, size_t n) {
+  Dependencies deps;
+  EpochRecordCacheEntryArena* arena = nullptr;
+  std::vector<std::shared_ptr<EpochRecordCacheEntry>> window;
+  BENCHMARK_SUSPEND {
+    if (use_arena) {
+      arena = new EpochRecordCacheEntryArena(FLAGS_window_size, nullptr);
+    }
+    window.resize(FLAGS_window_size);
+  }
+
+  const size_t allocations_before = heap_allocations.load();
+  for (size_t i = 0; i < n; ++i) {
+    // replaces, and disposes of, the entry created window_size entries ago
+    window[i % window.size()] = createEntry(arena, &deps, lsn_t(i + 1));
+  }
+  const size_t allocations = heap_allocations.load() - allocations_before;
+
+  BENCHMARK_SUSPEND {
+    printAllocations(use_arena ? "arena" : "heap", allocations, n);
+    window.clear();
+    if (arena != nullptr) {
+      arena->release();
+    }
+  }
+}
+
+} // namespace
+
+void* operator new(size_t size) {
+  ++heap_allocations;
+  void* p = std::malloc(size == 0 ? 1 : size);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  std::free(p);
+}
+
+BENCHMARK(HeapEntries, n) {
+  createEntries(false, n);
+}
+
+BENCHMARK_RELATIVE(ArenaEntries, n) {
+  createEntries(true, n);
+}
+
+BENCHMARK(PutRecord, n) {
+  Dependencies deps;
+  std::unique_ptr<EpochRecordCache> cache;
+  BENCHMARK_SUSPEND {
+    cache = std::make_unique<EpochRecordCache>(
+        logid_t(1),
+        shard_index_t(0),
+        epoch_t(1),
+        &deps,
+        FLAGS_window_size,
+        EpochRecordCache::TailOptimized::NO,
+        EpochRecordCache::StoredBefore::NEVER);
+  }
+
+  const copyset_t copyset{ShardID(1, 0), ShardID(2, 0), ShardID(3, 0)};
+  const PayloadHolder payload;
+  const size_t window = FLAGS_window_size;
+  const size_t allocations_before = heap_allocations.load();
+  for (size_t i = 0; i < n; ++i) {
+    // LNG trails the record being stored by window_size - 1 records
+    const esn_t esn(i + 1);
+    const esn_t lng(i + 1 >= window ? i + 2 - window : 0);
+    cache->putRecord(RecordID(compose_lsn(epoch_t(1), esn), logid_t(1)),
+                     i + 1,
+                     lng,
+                     1,
+                     copyset,
+                     0,
+                     std::map<KeyType, std::string>(),
+                     payload);
+  }
+  const size_t allocations = heap_allocations.load() - allocations_before;
+
+  BENCHMARK_SUSPEND {
+    printAllocations("putRecord", allocations, n);
+    cache.reset();
+  }
+}
+
+BENCHMARK_DRAW_LINE();
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
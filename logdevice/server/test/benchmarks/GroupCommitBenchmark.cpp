@@ -0,0 +1,138 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <gflags/gflags.h>
+
+#include "logdevice/common/settings/util.h"
+#include "logdevice/common/stats/Stats.h"
+#include "logdevice/server/locallogstore/WriteOps.h"
+#include "logdevice/server/locallogstore/test/TemporaryLogStore.h"
+#include "logdevice/server/storage_tasks/GroupCommitter.h"
+
+using namespace facebook::logdevice;
+
+/**
+ * @file: N threads doing small durable writes to one PartitionedRocksDBStore,
+ *        either each calling writeMulti() and sync() on its own (what storage
+ *        threads do with --write-group-commit off, modulo the syncing
+ *        thread's batching) or through a GroupCommitter. Prints the average
+ *        group size and the number of writes per WAL sync after each run.
+ */
+
+DEFINE_int32(num_threads, 8, "Number of writer threads.");
+DEFINE_int32(ops_per_write, 2, "Number of records per writeMulti() call.");
+DEFINE_int32(latency_budget_us, 2000, "--write-group-commit-latency-budget");
+
+namespace {
+
+std::string makeHeader() {
+  std::string header;
+  std::array<ShardID, 3> cs = {ShardID(1, 0), ShardID(2, 0), ShardID(3, 0)};
+  LocalLogStoreRecordFormat::formRecordHeader(
+      0,
+      esn_t(0),
+      LocalLogStoreRecordFormat::FLAG_CHECKSUM_PARITY,
+      0,
+      folly::Range<const ShardID*>(cs.begin(), cs.end()),
+      OffsetMap(),
+      std::map<KeyType, std::string>(),
+      &header);
+  return header;
+}
+
+void runWriters(bool group_commit, size_t n) {
+  std::unique_ptr<TemporaryPartitionedStore> store;
+  std::unique_ptr<StatsHolder> stats;
+  std::unique_ptr<GroupCommitter> committer;
+  std::string header;
+  std::atomic<lsn_t> next_lsn{1};
+  std::atomic<size_t> syncs{0};
+
+  BENCHMARK_SUSPEND {
+    store = std::make_unique<TemporaryPartitionedStore>();
+    stats = std::make_unique<StatsHolder>(StatsParams().setIsServer(true));
+    Settings settings = create_default_settings<Settings>();
+    settings.write_group_commit = true;
+    settings.write_group_commit_latency_budget =
+        std::chrono::microseconds(FLAGS_latency_budget_us);
+    committer = std::make_unique<GroupCommitter>(
+        store.get(), UpdateableSettings<Settings>(settings), stats.get());
+    header = makeHeader();
+  }
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < FLAGS_num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      std::vector<PutWriteOp> ops;
+      std::vector<const WriteOp*> op_ptrs;
+      for (size_t i = t; i < n; i += FLAGS_num_threads) {
+        ops.clear();
+        op_ptrs.clear();
+        for (int j = 0; j < FLAGS_ops_per_write; ++j) {
+          ops.push_back(PutWriteOp{logid_t(1 + t),
+                                   next_lsn++,
+                                   Slice(header.data(), header.size())});
+        }
+        for (auto& op : ops) {
+          op_ptrs.push_back(&op);
+        }
+        if (group_commit) {
+          bool synced;
+          committer->commit(op_ptrs, true, &synced);
+        } else {
+          store->writeMulti(op_ptrs);
+          store->sync(Durability::ASYNC_WRITE);
+          ++syncs;
+        }
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  BENCHMARK_SUSPEND {
+    Stats s = stats->aggregate();
+    if (group_commit) {
+      printf("group commit: %ld writes in %ld groups, %ld syncs\n",
+             s.write_group_commit_members.load(),
+             s.write_group_commit_groups.load(),
+             s.write_group_commit_syncs.load());
+    } else {
+      printf("no group commit: %zu writes, %zu syncs\n", n, syncs.load());
+    }
+    committer.reset();
+    store.reset();
+  }
+}
+
+} // namespace
+
+BENCHMARK(WriteMultiAndSyncPerThread, n) {
+  runWriters(false, n);
+}
+
+BENCHMARK_RELATIVE(GroupCommit, n) {
+  runWriters(true, n);
+}
+
+BENCHMARK_DRAW_LINE();
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  gflags::SetCommandLineOptionWithMode(
+      "bm_min_iters", "10000", gflags::SET_FLAG_IF_DEFAULT);
+  folly::runBenchmarks();
+  return 0;
+}
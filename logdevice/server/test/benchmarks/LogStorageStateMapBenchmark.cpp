@@ -19,43 +19,69 @@
 
 using namespace facebook::logdevice;
 
-const size_t N_LOGS = 200000; // logid starts from 1
-
 const shard_index_t SHARD_IDX = 0;
 
+DEFINE_int32(num_threads, 32, "Number of threads for benchmarks.");
+DEFINE_uint64(num_logs,
+              10000000,
+              "Number of logs in the map. Logids start from 1.");
+
 /**
  * @file: a benchmark for testing time spent on accessing LogStorageStateMap
  *        populated with different logids. The performance is directly related
- *        to the internal AtomicHashMap, and specifically, its hash function.
+ *        to the internal LogStorageStateIndex, and specifically, its hash
+ *        function and memory layout.
+ *
+ *        The map is populated once and shared by all benchmarks of the same
+ *        kind, since populating it with millions of logs takes a while.
  */
 
-// range 1..100000
+// range 1..num_logs/2, plus either metadata logs of the same logs or data logs
+// num_logs/2+1..num_logs
 static inline void populateLogs(LogStorageStateMap* map, bool metadata_log) {
   ld_check(map);
-  for (size_t i = 0; i < N_LOGS / 2; ++i) {
+  for (size_t i = 0; i < FLAGS_num_logs / 2; ++i) {
     const logid_t logid(1 + i);
     map->insertOrGet(logid, SHARD_IDX);
     if (metadata_log) {
       map->insertOrGet(MetaDataLog::metaDataLogID(logid), SHARD_IDX);
     } else {
-      map->insertOrGet(logid_t(N_LOGS / 2 + i + 1), SHARD_IDX);
+      map->insertOrGet(logid_t(FLAGS_num_logs / 2 + i + 1), SHARD_IDX);
     }
   }
 }
 
+static LogStorageStateMap* getMap(bool metadata_log) {
+  static std::unique_ptr<LogStorageStateMap> maps[2];
+  auto& map = maps[metadata_log];
+  if (!map) {
+    map.reset(
+        new LogStorageStateMap(1, /*stats*/ nullptr, /*record_cache*/ false));
+    populateLogs(map.get(), metadata_log);
+  }
+  return map.get();
+}
+
+// Each thread performs n_iters lookups of random logs, with insertOrGet() if
+// `insert` is true and with find() otherwise.
 static inline void accessMap(LogStorageStateMap* map,
                              int n_threads,
-                             size_t n_iters) {
+                             size_t n_iters,
+                             bool insert) {
   ld_check(map);
-  static std::mt19937_64 rnd{std::random_device()()};
-  std::uniform_int_distribution<logid_t::raw_type> dis(1, N_LOGS / 2);
-
   std::vector<std::thread> threads;
   for (int i = 0; i < n_threads; ++i) {
-    threads.emplace_back([map, &dis, n_iters]() {
+    threads.emplace_back([map, n_iters, insert]() {
+      std::mt19937_64 rnd{std::random_device()()};
+      std::uniform_int_distribution<logid_t::raw_type> dis(
+          1, FLAGS_num_logs / 2);
       for (size_t j = 0; j < n_iters; ++j) {
-        folly::doNotOptimizeAway(
-            map->insertOrGet(logid_t(dis(rnd)), SHARD_IDX));
+        const logid_t logid(dis(rnd));
+        if (insert) {
+          folly::doNotOptimizeAway(map->insertOrGet(logid, SHARD_IDX));
+        } else {
+          folly::doNotOptimizeAway(map->find(logid, SHARD_IDX));
+        }
       }
     });
   }
@@ -65,32 +91,38 @@ static inline void accessMap(LogStorageStateMap* map,
   }
 }
 
-DEFINE_int32(num_threads, 32, "Number of threads for benchmarks.");
-
 BENCHMARK(LogStorageStateMapWithDataLogs, iters) {
-  std::unique_ptr<LogStorageStateMap> map = nullptr;
-
+  LogStorageStateMap* map;
   BENCHMARK_SUSPEND {
-    map.reset(
-        new LogStorageStateMap(1, /*stats*/ nullptr, /*record_cache*/ false));
-    populateLogs(map.get(), false);
+    map = getMap(false);
   }
-
-  accessMap(map.get(), FLAGS_num_threads, iters / FLAGS_num_threads);
+  accessMap(map, FLAGS_num_threads, iters / FLAGS_num_threads, true);
 }
 
 BENCHMARK(LogStorageStateMapWithMetaDataLogs, iters) {
-  std::unique_ptr<LogStorageStateMap> map = nullptr;
-
+  LogStorageStateMap* map;
   BENCHMARK_SUSPEND {
-    map.reset(
-        new LogStorageStateMap(1, /*stats*/ nullptr, /*record_cache*/ false));
-    populateLogs(map.get(), true);
+    map = getMap(true);
   }
+  accessMap(map, FLAGS_num_threads, iters / FLAGS_num_threads, true);
+}
+
+BENCHMARK_DRAW_LINE();
 
-  accessMap(map.get(), FLAGS_num_threads, iters / FLAGS_num_threads);
+// Lookups only, with a varying number of reader threads.
+static void findWithReaders(unsigned iters, int n_threads) {
+  LogStorageStateMap* map;
+  BENCHMARK_SUSPEND {
+    map = getMap(false);
+  }
+  accessMap(map, n_threads, iters / n_threads, false);
 }
 
+BENCHMARK_PARAM(findWithReaders, 1);
+BENCHMARK_PARAM(findWithReaders, 4);
+BENCHMARK_PARAM(findWithReaders, 16);
+BENCHMARK_PARAM(findWithReaders, 64);
+
 BENCHMARK_DRAW_LINE();
 
 int main(int argc, char* argv[]) {
@@ -0,0 +1,515 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/Singleton.h>
+#include <gflags/gflags.h>
+
+#include "logdevice/common/debug.h"
+#include "logdevice/common/protocol/Compatibility.h"
+#include "logdevice/common/protocol/GAP_Message.h"
+#include "logdevice/common/protocol/RECORD_Message.h"
+#include "logdevice/common/protocol/STARTED_Message.h"
+#include "logdevice/common/settings/Settings.h"
+#include "logdevice/common/settings/UpdateableSettings.h"
+#include "logdevice/common/settings/util.h"
+#include "logdevice/common/stats/Stats.h"
+#include "logdevice/common/test/MockBackoffTimer.h"
+#include "logdevice/common/test/MockTimer.h"
+#include "logdevice/common/test/SenderTestProxy.h"
+#include "logdevice/server/ServerSettings.h"
+#include "logdevice/server/locallogstore/test/StoreUtil.h"
+#include "logdevice/server/locallogstore/test/TemporaryLogStore.h"
+#include "logdevice/server/read_path/AllServerReadStreams.h"
+#include "logdevice/server/read_path/CatchupQueue.h"
+#include "logdevice/server/read_path/IteratorCache.h"
+#include "logdevice/server/read_path/LogStorageStateMap.h"
+#include "logdevice/server/storage_tasks/ReadStorageTask.h"
+#include "logdevice/server/storage_tasks/StorageThreadPool.h"
+
+using namespace facebook::logdevice;
+
+/**
+ * @file: what batching the reads of several streams of a client into one
+ *        ReadStorageTask (--max-read-streams-per-storage-task) does to the
+ *        storage thread's work when many tailing streams wake up on a
+ *        release.
+ *
+ *        One client has --streams_per_log read streams on each of --num_logs
+ *        logs of a TemporaryRocksDBStore. The streams are served by a real
+ *        CatchupQueue in an AllServerReadStreams, with reads on workers
+ *        disabled so that every read goes through a ReadStorageTask. Each
+ *        round, every log gets --records_per_round new records and a release,
+ *        every stream is notified, and the storage tasks the CatchupQueue
+ *        issues are executed on the benchmark thread and handed back to it,
+ *        until all streams are caught up. Messages to the client are drained
+ *        as soon as they're sent.
+ *
+ *        The reads are compared without and with batching, with the streams'
+ *        iterators cached from round to round, and without iterator caches,
+ *        as when the cached iterators expire between releases
+ *        (--iterator-cache-ttl).
+ *
+ *        Counters, per 1000 delivered records: storage tasks, reads issued to
+ *        storage threads, iterators created and seeks, counted by an iterator
+ *        wrapped around the store's.
+ */
+
+DEFINE_int32(num_logs, 100, "Number of logs.");
+DEFINE_int32(streams_per_log, 10, "Number of tailing read streams per log.");
+DEFINE_int32(records_per_round, 5, "Records appended to every log per round.");
+DEFINE_int32(batch_size,
+             16,
+             "--max-read-streams-per-storage-task of the batched runs.");
+
+namespace {
+
+const shard_index_t kShard = 0;
+const ClientID kClient(9999);
+
+struct IteratorCounters {
+  size_t iterators = 0;
+  size_t seeks = 0;
+};
+
+// Forwards to an iterator of the wrapped store, counting seeks.
+class SeekCountingIterator : public LocalLogStore::ReadIterator {
+ public:
+  SeekCountingIterator(const LocalLogStore* store,
+                       std::unique_ptr<LocalLogStore::ReadIterator> iterator,
+                       IteratorCounters* counters)
+      : LocalLogStore::ReadIterator(store),
+        iterator_(std::move(iterator)),
+        counters_(counters) {}
+
+  IteratorState state() const override {
+    return iterator_->state();
+  }
+  bool accessedUnderReplicatedRegion() const override {
+    return iterator_->accessedUnderReplicatedRegion();
+  }
+  lsn_t getLSN() const override {
+    return iterator_->getLSN();
+  }
+  Slice getRecord() const override {
+    return iterator_->getRecord();
+  }
+  void seek(lsn_t lsn,
+            LocalLogStore::ReadFilter* filter,
+            LocalLogStore::ReadStats* stats) override {
+    ++counters_->seeks;
+    iterator_->seek(lsn, filter, stats);
+  }
+  void seekForPrev(lsn_t lsn) override {
+    ++counters_->seeks;
+    iterator_->seekForPrev(lsn);
+  }
+  void next(LocalLogStore::ReadFilter* filter,
+            LocalLogStore::ReadStats* stats) override {
+    iterator_->next(filter, stats);
+  }
+  void prev() override {
+    iterator_->prev();
+  }
+  void setContextString(const char* str) override {
+    iterator_->setContextString(str);
+  }
+  size_t getIOBytesUnnormalized() const override {
+    return iterator_->getIOBytesUnnormalized();
+  }
+
+ private:
+  std::unique_ptr<LocalLogStore::ReadIterator> iterator_;
+  IteratorCounters* counters_;
+};
+
+class SeekCountingStore : public TemporaryRocksDBStore {
+ public:
+  std::unique_ptr<ReadIterator>
+  read(logid_t log_id,
+       const LocalLogStore::ReadOptions& options) const override {
+    ++counters_.iterators;
+    return std::make_unique<SeekCountingIterator>(
+        this, TemporaryRocksDBStore::read(log_id, options), &counters_);
+  }
+
+  const IteratorCounters& counters() const {
+    return counters_;
+  }
+
+ private:
+  // Storage tasks are executed on the benchmark thread.
+  mutable IteratorCounters counters_;
+};
+
+using Messages = std::vector<std::unique_ptr<Message>>;
+
+/**
+ * The rest of the server, as seen by the CatchupQueue of the client: the
+ * connection to the client, which accepts all messages, and the settings.
+ */
+class BenchmarkCatchupQueueDependencies : public CatchupQueueDependencies {
+  using BenchmarkSender = SenderTestProxy<BenchmarkCatchupQueueDependencies>;
+
+ public:
+  BenchmarkCatchupQueueDependencies(AllServerReadStreams* streams,
+                                    StatsHolder* stats,
+                                    const Settings* settings,
+                                    LogStorageStateMap* log_storage_state_map,
+                                    Messages* messages)
+      : CatchupQueueDependencies(streams, stats),
+        settings_(settings),
+        log_storage_state_map_(log_storage_state_map),
+        messages_(messages) {
+    sender_ = std::make_unique<BenchmarkSender>(this);
+  }
+
+  std::unique_ptr<BackoffTimer>
+  createPingTimer(std::function<void()> callback) override {
+    auto timer = std::make_unique<MockBackoffTimer>();
+    timer->setCallback(callback);
+    return std::move(timer);
+  }
+
+  // Never fires, so cached iterators live as long as their streams.
+  std::unique_ptr<Timer>
+  createIteratorTimer(std::function<void()> callback) override {
+    auto timer = std::make_unique<MockTimer>();
+    timer->setCallback(callback);
+    return std::move(timer);
+  }
+
+  std::chrono::milliseconds iteratorTimerTTL() const override {
+    return std::chrono::milliseconds::zero();
+  }
+
+  folly::Optional<std::chrono::milliseconds>
+  getDeliveryLatency(logid_t /*log_id*/) override {
+    return folly::none;
+  }
+
+  bool canSendToImpl(const Address&, TrafficClass, BWAvailableCallback&) {
+    return true;
+  }
+
+  int sendMessageImpl(std::unique_ptr<Message>&& msg,
+                      const Address& addr,
+                      BWAvailableCallback*,
+                      SocketCallback*) {
+    ld_check(addr.isClientAddress());
+    messages_->push_back(std::move(msg));
+    return 0;
+  }
+
+  LogStorageStateMap& getLogStorageStateMap() override {
+    return *log_storage_state_map_;
+  }
+
+  int recoverLogState(logid_t /*log_id*/,
+                      shard_index_t /*shard*/,
+                      bool /*force_ask_sequencer*/ = false) override {
+    return 0;
+  }
+
+  NodeID getMyNodeID() const override {
+    return NodeID(0, 1);
+  }
+
+  size_t getMaxRecordBytesQueued(ClientID) override {
+    return 1024 * 1024;
+  }
+
+  const Settings& getSettings() const override {
+    return *settings_;
+  }
+
+ private:
+  const Settings* settings_;
+  LogStorageStateMap* log_storage_state_map_;
+  Messages* messages_;
+};
+
+// Keeps the storage tasks to be executed by the benchmark.
+class BenchmarkReadStreams : public AllServerReadStreams {
+ public:
+  BenchmarkReadStreams(UpdateableSettings<Settings> settings,
+                       LogStorageStateMap* log_storage_state_map)
+      : AllServerReadStreams(settings,
+                             1ul << 30,
+                             worker_id_t(0),
+                             log_storage_state_map,
+                             nullptr,
+                             nullptr,
+                             false) {}
+
+  // Injects the CatchupQueue of the client, which AllServerReadStreams would
+  // otherwise create with dependencies that need a Worker.
+  void addClient(ClientID client_id,
+                 std::unique_ptr<CatchupQueueDependencies> deps) {
+    auto insert_result =
+        client_states_.emplace(std::piecewise_construct,
+                               std::forward_as_tuple(client_id),
+                               std::forward_as_tuple());
+    ld_check(insert_result.second);
+    insert_result.first->second.catchup_queue.reset(
+        new CatchupQueue(std::move(deps), client_id));
+  }
+
+  void sendStorageTask(std::unique_ptr<ReadStorageTask>&& task,
+                       shard_index_t shard) override {
+    ld_check_eq(kShard, shard);
+    tasks_.push_back(std::move(task));
+  }
+
+  void scheduleSendDelayedStorageTasks() override {
+    send_delayed_storage_tasks_pending_ = true;
+  }
+
+  // Returns the next storage task, or nullptr if the CatchupQueue has none in
+  // flight.
+  std::unique_ptr<ReadStorageTask> nextTask() {
+    if (tasks_.empty() && send_delayed_storage_tasks_pending_) {
+      send_delayed_storage_tasks_pending_ = false;
+      sendDelayedReadStorageTasks();
+    }
+    if (tasks_.empty()) {
+      return nullptr;
+    }
+    auto task = std::move(tasks_.front());
+    tasks_.pop_front();
+    return task;
+  }
+
+ private:
+  std::deque<std::unique_ptr<ReadStorageTask>> tasks_;
+  bool send_delayed_storage_tasks_pending_ = false;
+};
+
+class Simulation {
+ public:
+  Simulation(size_t max_streams_per_task, bool cache_iterators)
+      : settings_(makeSettings(max_streams_per_task)),
+        updateable_settings_(settings_),
+        log_storage_state_map_(1, /*stats*/ nullptr, /*record_cache*/ false),
+        stats_(StatsParams().setIsServer(true)) {
+    // Tasks are executed on the benchmark thread, the pool's thread stays
+    // idle.
+    ServerSettings::StoragePoolParams params;
+    params[(size_t)StorageTaskThreadType::SLOW].nthreads = 1;
+    pool_ = std::make_unique<StorageThreadPool>(
+        kShard,
+        1,
+        params,
+        UpdateableSettings<ServerSettings>(
+            create_default_settings<ServerSettings>()),
+        updateable_settings_,
+        &store_,
+        4096,
+        &stats_);
+    streams_ = std::make_unique<BenchmarkReadStreams>(
+        updateable_settings_, &log_storage_state_map_);
+    streams_->addClient(
+        kClient,
+        std::make_unique<BenchmarkCatchupQueueDependencies>(
+            streams_.get(),
+            &stats_,
+            &settings_,
+            &log_storage_state_map_,
+            &messages_));
+
+    const lsn_t start_lsn = compose_lsn(EPOCH_MIN, ESN_MIN);
+    uint64_t next_id = 1;
+    for (int log = 1; log <= FLAGS_num_logs; ++log) {
+      const logid_t log_id(log);
+      LogStorageState* log_state =
+          log_storage_state_map_.insertOrGet(log_id, kShard);
+      log_state->updateLastReleasedLSN(
+          start_lsn - 1, LogStorageState::LastReleasedSource::RELEASE);
+      log_state->updateTrimPoint(LSN_INVALID);
+
+      // Streams of the same log are next to each other in the CatchupQueue,
+      // as are their reads in a batch.
+      for (int i = 0; i < FLAGS_streams_per_log; ++i) {
+        auto insert_result = streams_->insertOrGet(
+            kClient, log_id, kShard, "", read_stream_id_t(next_id++));
+        ld_check(insert_result.second);
+        ServerReadStream* stream = insert_result.first;
+        stream->setTrafficClass(TrafficClass::READ_TAIL);
+        stream->setReadPtr(start_lsn);
+        stream->last_delivered_record_ = start_lsn - 1;
+        stream->last_delivered_lsn_ = start_lsn - 1;
+        stream->until_lsn_ = LSN_MAX;
+        stream->setWindowHigh(LSN_MAX);
+        stream->proto_ = Compatibility::MAX_PROTOCOL_SUPPORTED;
+        stream->needs_started_message_ = false;
+        if (cache_iterators) {
+          stream->iterator_cache_ =
+              std::make_shared<IteratorCache>(&store_, log_id, false);
+        }
+        read_streams_.push_back(stream);
+      }
+    }
+  }
+
+  ~Simulation() {
+    pool_->shutDown();
+    pool_->join();
+    read_streams_.clear();
+    streams_->clear();
+  }
+
+  void runRound() {
+    BENCHMARK_SUSPEND {
+      std::vector<TestRecord> data;
+      for (int log = 1; log <= FLAGS_num_logs; ++log) {
+        for (int i = 1; i <= FLAGS_records_per_round; ++i) {
+          data.emplace_back(
+              logid_t(log),
+              compose_lsn(EPOCH_MIN, esn_t(last_esn_ + i)),
+              std::chrono::milliseconds(0),
+              1);
+        }
+      }
+      store_fill(store_, data);
+      last_esn_ += FLAGS_records_per_round;
+      for (int log = 1; log <= FLAGS_num_logs; ++log) {
+        log_storage_state_map_.get(logid_t(log), kShard)
+            .updateLastReleasedLSN(
+                compose_lsn(EPOCH_MIN, esn_t(last_esn_)),
+                LogStorageState::LastReleasedSource::RELEASE);
+      }
+    }
+
+    for (ServerReadStream* stream : read_streams_) {
+      streams_->notifyNeedsCatchup(*stream, /* allow_delay */ false);
+    }
+    drainMessages();
+    while (auto task = streams_->nextTask()) {
+      ++storage_tasks_;
+      task->setStorageThreadPool(pool_.get());
+      task->execute();
+      streams_->onReadTaskDone(*task);
+      task.reset();
+      drainMessages();
+    }
+  }
+
+  void report(folly::UserCounters& counters, size_t rounds) const {
+    Stats stats = stats_.aggregate();
+    const size_t records = std::max(records_delivered_, size_t(1));
+    auto per_1k_records = [&](size_t count) { return count * 1000 / records; };
+    counters["records_per_round"] =
+        records_delivered_ / std::max(rounds, size_t(1));
+    counters["storage_tasks_per_1k_records"] = per_1k_records(storage_tasks_);
+    counters["reads_per_1k_records"] =
+        per_1k_records(stats.read_requests_to_storage.load());
+    counters["iterators_per_1k_records"] =
+        per_1k_records(store_.counters().iterators);
+    counters["seeks_per_1k_records"] = per_1k_records(store_.counters().seeks);
+  }
+
+ private:
+  static Settings makeSettings(size_t max_streams_per_task) {
+    Settings settings = create_default_settings<Settings>();
+    settings.allow_reads_on_workers = false;
+    settings.max_read_streams_per_storage_task = max_streams_per_task;
+    return settings;
+  }
+
+  // Tells the CatchupQueue that the messages it sent were written to the
+  // client's socket, which lets it read more.
+  void drainMessages() {
+    while (!messages_.empty()) {
+      Messages messages;
+      messages.swap(messages_);
+      const SteadyTimestamp now = SteadyTimestamp::now();
+      for (const auto& msg : messages) {
+        switch (msg->type_) {
+          case MessageType::RECORD:
+            ++records_delivered_;
+            streams_->onRecordSent(
+                kClient, static_cast<const RECORD_Message&>(*msg), now);
+            break;
+          case MessageType::GAP:
+            streams_->onGapSent(
+                kClient, static_cast<const GAP_Message&>(*msg), now);
+            break;
+          case MessageType::STARTED:
+            streams_->onStartedSent(
+                kClient, static_cast<const STARTED_Message&>(*msg), now);
+            break;
+          default:
+            break;
+        }
+      }
+    }
+  }
+
+  Settings settings_;
+  UpdateableSettings<Settings> updateable_settings_;
+  SeekCountingStore store_;
+  LogStorageStateMap log_storage_state_map_;
+  StatsHolder stats_;
+  std::unique_ptr<StorageThreadPool> pool_;
+  std::unique_ptr<BenchmarkReadStreams> streams_;
+  std::vector<ServerReadStream*> read_streams_;
+  Messages messages_;
+  esn_t::raw_type last_esn_{0};
+  size_t storage_tasks_{0};
+  size_t records_delivered_{0};
+};
+
+void runRounds(folly::UserCounters& counters,
+               size_t rounds,
+               size_t max_streams_per_task,
+               bool cache_iterators) {
+  std::unique_ptr<Simulation> sim;
+  BENCHMARK_SUSPEND {
+    dbg::currentLevel = dbg::Level::ERROR;
+    sim = std::make_unique<Simulation>(max_streams_per_task, cache_iterators);
+  }
+
+  for (size_t i = 0; i < rounds; ++i) {
+    sim->runRound();
+  }
+
+  BENCHMARK_SUSPEND {
+    sim->report(counters, rounds);
+    sim.reset();
+  }
+}
+
+} // namespace
+
+#define BATCHING_BENCHMARKS(name, cache_iterators)             \
+  BENCHMARK_COUNTERS(name##_unbatched, counters, n) {          \
+    runRounds(counters, n, 1, cache_iterators);                \
+  }                                                            \
+  BENCHMARK_COUNTERS_RELATIVE(name##_batched, counters, n) {   \
+    runRounds(counters, n, FLAGS_batch_size, cache_iterators); \
+  }                                                            \
+  BENCHMARK_DRAW_LINE();
+
+BATCHING_BENCHMARKS(CachedIterators, true)
+BATCHING_BENCHMARKS(NoIteratorCache, false)
+
+#ifndef BENCHMARK_BUNDLE
+int main(int argc, char* argv[]) {
+  folly::SingletonVault::singleton()->registrationComplete();
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  gflags::SetCommandLineOptionWithMode(
+      "bm_min_iters", "10", gflags::SET_FLAG_IF_DEFAULT);
+  folly::runBenchmarks();
+  return 0;
+}
+#endif
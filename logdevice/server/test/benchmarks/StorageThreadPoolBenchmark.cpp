@@ -0,0 +1,197 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/Random.h>
+#include <gflags/gflags.h>
+
+#include "logdevice/common/Semaphore.h"
+#include "logdevice/common/settings/util.h"
+#include "logdevice/server/locallogstore/test/TemporaryLogStore.h"
+#include "logdevice/server/storage_tasks/StorageTask.h"
+#include "logdevice/server/storage_tasks/StorageThreadPool.h"
+
+using namespace facebook::logdevice;
+
+/**
+ * @file: compares queueing latency of storage tasks (time from tryPutTask()
+ *        to the task being handed out by blockingGetTask()) with the shared
+ *        PrioritizedQueue, the per-thread WorkStealingQueue, and the
+ *        WorkStealingQueue with cross-shard stealing, when most of the load
+ *        goes to one shard. Percentiles are printed after each run.
+ */
+
+DEFINE_int32(num_shards, 4, "Number of shards (all on the same \"disk\").");
+DEFINE_int32(slow_threads, 2, "Number of SLOW storage threads per shard.");
+DEFINE_int32(producers, 4, "Number of threads putting tasks.");
+DEFINE_int32(hot_shard_pct, 80, "Percentage of tasks sent to shard 0.");
+DEFINE_int32(task_usec, 20, "How long each task spins, in microseconds.");
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchTask : public StorageTask {
+  BenchTask(std::atomic<int64_t>* latency_out, Semaphore* done)
+      : StorageTask(StorageTask::Type::READ_BACKLOG),
+        put_time_(Clock::now()),
+        latency_out_(latency_out),
+        done_(done) {}
+
+  void execute() override {
+    latency_out_->store(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                             put_time_)
+            .count(),
+        std::memory_order_relaxed);
+    auto until = Clock::now() + std::chrono::microseconds(FLAGS_task_usec);
+    while (Clock::now() < until) {
+    }
+    done_->post();
+  }
+  bool canExecuteOnOtherShard() const override {
+    return true;
+  }
+  void onDone() override {}
+  void onDropped() override {}
+
+  Clock::time_point put_time_;
+  std::atomic<int64_t>* latency_out_;
+  Semaphore* done_;
+};
+
+enum class Mode { SHARED_QUEUE, WORK_STEALING, STEAL_ACROSS_SHARDS };
+
+void printPercentiles(const char* name, std::vector<int64_t> latencies) {
+  if (latencies.empty()) {
+    return;
+  }
+  std::sort(latencies.begin(), latencies.end());
+  auto pct = [&](double p) {
+    size_t i = std::min(latencies.size() - 1,
+                        static_cast<size_t>(p / 100 * latencies.size()));
+    return latencies[i] / 1000.0;
+  };
+  printf("%s: n=%zu p50=%.1fus p99=%.1fus p99.9=%.1fus max=%.1fus\n",
+         name,
+         latencies.size(),
+         pct(50),
+         pct(99),
+         pct(99.9),
+         latencies.back() / 1000.0);
+}
+
+void runSkewedLoad(Mode mode, const char* name, size_t ntasks) {
+  std::vector<std::unique_ptr<TemporaryRocksDBStore>> stores;
+  std::vector<std::unique_ptr<StorageThreadPool>> pools;
+  std::vector<std::atomic<int64_t>> latencies(ntasks);
+  Semaphore done;
+
+  BENCHMARK_SUSPEND {
+    Settings init_settings = create_default_settings<Settings>();
+    init_settings.storage_tasks_work_stealing = mode != Mode::SHARED_QUEUE;
+    init_settings.storage_tasks_steal_across_shards =
+        mode == Mode::STEAL_ACROSS_SHARDS;
+    UpdateableSettings<Settings> settings(init_settings);
+    UpdateableSettings<ServerSettings> server_settings(
+        create_default_settings<ServerSettings>());
+
+    ServerSettings::StoragePoolParams params;
+    params[(size_t)StorageTaskThreadType::SLOW].nthreads = FLAGS_slow_threads;
+    for (int i = 0; i < FLAGS_num_shards; ++i) {
+      stores.push_back(std::make_unique<TemporaryRocksDBStore>());
+      pools.push_back(std::make_unique<StorageThreadPool>(i,
+                                                          FLAGS_num_shards,
+                                                          params,
+                                                          server_settings,
+                                                          settings,
+                                                          stores.back().get(),
+                                                          4096));
+    }
+    for (int i = 0; i < FLAGS_num_shards; ++i) {
+      std::vector<StorageThreadPool*> peers;
+      for (int j = 0; j < FLAGS_num_shards; ++j) {
+        if (j != i) {
+          peers.push_back(pools[j].get());
+        }
+      }
+      pools[i]->setStealPeers(std::move(peers));
+    }
+  }
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < FLAGS_producers; ++p) {
+    producers.emplace_back([&, p] {
+      for (size_t i = p; i < ntasks; i += FLAGS_producers) {
+        size_t shard = 0;
+        if (folly::Random::rand32(100) >= FLAGS_hot_shard_pct) {
+          shard = 1 + folly::Random::rand32(FLAGS_num_shards - 1);
+        }
+        auto task = std::make_unique<BenchTask>(&latencies[i], &done);
+        // tryPutTask() only takes ownership on success. Retrying keeps the
+        // original put time, so time spent waiting for queue space counts.
+        while (pools[shard]->tryPutTask(std::move(task)) != 0) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto& t : producers) {
+    t.join();
+  }
+  for (size_t i = 0; i < ntasks; ++i) {
+    done.wait();
+  }
+
+  BENCHMARK_SUSPEND {
+    for (auto& pool : pools) {
+      pool->shutDown();
+    }
+    for (auto& pool : pools) {
+      pool->join();
+    }
+    std::vector<int64_t> values;
+    values.reserve(ntasks);
+    for (auto& l : latencies) {
+      values.push_back(l.load());
+    }
+    printPercentiles(name, std::move(values));
+    pools.clear();
+    stores.clear();
+  }
+}
+
+} // namespace
+
+BENCHMARK(SharedPrioritizedQueue, n) {
+  runSkewedLoad(Mode::SHARED_QUEUE, "SharedPrioritizedQueue", n);
+}
+
+BENCHMARK_RELATIVE(WorkStealingQueue, n) {
+  runSkewedLoad(Mode::WORK_STEALING, "WorkStealingQueue", n);
+}
+
+BENCHMARK_RELATIVE(WorkStealingAcrossShards, n) {
+  runSkewedLoad(Mode::STEAL_ACROSS_SHARDS, "WorkStealingAcrossShards", n);
+}
+
+BENCHMARK_DRAW_LINE();
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  gflags::SetCommandLineOptionWithMode(
+      "bm_min_iters", "100000", gflags::SET_FLAG_IF_DEFAULT);
+  folly::runBenchmarks();
+  return 0;
+}
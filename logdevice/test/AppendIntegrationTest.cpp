@@ -6,11 +6,14 @@
  * LICENSE file in the root directory of this source tree.
  */
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <memory>
 #include <mutex>
 #include <pthread.h>
+#include <string>
 #include <thread>
+#include <vector>
 
 #include <folly/json.h>
 #include <gtest/gtest.h>
@@ -1198,3 +1201,70 @@ TEST_F(AppendIntegrationTest, AppendPayloadGroup) {
   lsn = client->appendSync(logid, folly::copy(payload_group));
   EXPECT_EQ(LSN_INVALID, lsn);
 }
+
+// Appends many small records at once with --store-batch-max-bytes. Their
+// STOREs and STOREDs should go out in batches, and all of them should be
+// readable.
+TEST_F(AppendIntegrationTest, StoreBatching) {
+  const logid_t logid{1};
+  const int NUM_RECORDS = 1000;
+
+  auto cluster = IntegrationTestUtils::ClusterFactory()
+                     .setParam("--store-batch-max-bytes", "65536")
+                     .create(4);
+  cluster->waitForMetaDataLogWrites();
+  std::shared_ptr<Client> client = cluster->createClient();
+
+  Semaphore sem;
+  std::atomic<int> failed{0};
+  lsn_t min_lsn = LSN_MAX;
+  lsn_t max_lsn = LSN_INVALID;
+  std::mutex mutex;
+  for (int i = 0; i < NUM_RECORDS; ++i) {
+    int rv = client->append(
+        logid,
+        "record" + std::to_string(i),
+        [&](Status st, const DataRecord& r) {
+          if (st != E::OK) {
+            ++failed;
+          } else {
+            std::lock_guard<std::mutex> lock(mutex);
+            min_lsn = std::min(min_lsn, r.attrs.lsn);
+            max_lsn = std::max(max_lsn, r.attrs.lsn);
+          }
+          sem.post();
+        });
+    ASSERT_EQ(0, rv);
+  }
+  for (int i = 0; i < NUM_RECORDS; ++i) {
+    sem.wait();
+  }
+  ASSERT_EQ(0, failed.load());
+
+  int64_t store_batches = 0;
+  int64_t stored_batches = 0;
+  for (auto& it : cluster->getNodes()) {
+    auto stats = it.second->stats();
+    store_batches += stats["store_batches_sent"];
+    stored_batches += stats["stored_batches_sent"];
+  }
+  EXPECT_GT(store_batches, 0);
+  EXPECT_GT(stored_batches, 0);
+
+  auto reader = client->createReader(1);
+  ASSERT_EQ(0, reader->startReading(logid, min_lsn, max_lsn));
+  std::vector<std::unique_ptr<DataRecord>> records;
+  GapRecord gap;
+  int nread = 0;
+  while (nread < NUM_RECORDS) {
+    ssize_t n = reader->read(NUM_RECORDS - nread, &records, &gap);
+    if (n < 0) {
+      // All records are in one epoch, unless the sequencer was reactivated.
+      ASSERT_EQ(E::GAP, err);
+      ASSERT_EQ(GapType::BRIDGE, gap.type);
+      continue;
+    }
+    nread += n;
+  }
+  EXPECT_EQ(NUM_RECORDS, records.size());
+}
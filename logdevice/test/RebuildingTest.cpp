@@ -38,7 +38,11 @@ namespace fs = boost::filesystem;
 
 namespace {
 
-struct TestMode {};
+struct TestMode {
+  // Recipients ingest rebuilt records as SST files instead of writing them
+  // through the memtable.
+  bool ingest_sst;
+};
 
 const int NUM_DB_SHARDS = 2;
 // More logs than shards, so that at least one shard gets multiple logs.
@@ -286,6 +290,8 @@ class RebuildingTest : public IntegrationTestBase,
           .setParam("--rocksdb-min-manual-flush-interval", "200ms")
           .setParam("--rocksdb-partition-hi-pri-check-period", "50ms")
           .setParam("--rebuilding-store-timeout", "6s..10s")
+          .setParam("--rebuilding-ingest-sst",
+                    test_param.ingest_sst ? "true" : "false")
           // When rebuilding Without WAL, destruction of memtable is used as
           // proxy for memtable being flushed to stable storage. Iterators can
           // pin a memtable preventing its destruction. Low ttl in tests ensures
@@ -1781,6 +1787,16 @@ TEST_P(RebuildingTest, RebuildingWithDifferentDurabilities) {
   // Verify that everything is correctly replicated.
   ld_info("Running checker");
   ASSERT_EQ(0, cluster->checkConsistency(check_args));
+
+  if (GetParam().ingest_sst) {
+    // Records rebuilt by N2 and N3 with memory durability were buffered and
+    // ingested by the recipients.
+    int64_t ingested_files = 0;
+    for (const auto& it : cluster->getNodes()) {
+      ingested_files += it.second->stats()["logsdb_rebuilding_ingested_files"];
+    }
+    EXPECT_GT(ingested_files, 0);
+  }
 }
 
 // Delete some logs, then replace each storage node one by one, re-add them and
@@ -3043,7 +3059,8 @@ TEST_P(RebuildingTest, UndrainDeadNode) {
   }
 }
 
-std::vector<TestMode> test_params{{}};
+std::vector<TestMode> test_params{{/*ingest_sst=*/false},
+                                  {/*ingest_sst=*/true}};
 INSTANTIATE_TEST_CASE_P(RebuildingTest,
                         RebuildingTest,
                         ::testing::ValuesIn(test_params));
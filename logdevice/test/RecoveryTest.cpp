@@ -231,6 +231,9 @@ class RecoveryTest : public ::testing::TestWithParam<PopulateRecordCache> {
   // sequencer reactivation limit setting string. optional
   folly::Optional<std::string> seq_reactivation_limit_;
 
+  // --seal-batch-max-logs, optional
+  folly::Optional<size_t> seal_batch_max_logs_;
+
   TailRecord tail_record;
   OffsetMap epoch_size_map;
   OffsetMap epoch_end_offsets;
@@ -391,6 +394,11 @@ void RecoveryTest::init(bool can_tail_optimize) {
     factory.setParam("--reactivation-limit", seq_reactivation_limit_.value());
   }
 
+  if (seal_batch_max_logs_.has_value()) {
+    factory.setParam("--seal-batch-max-logs",
+                     toString(seal_batch_max_logs_.value()));
+  }
+
   if (recovery_timeout_.has_value()) {
     factory.setParam("--recovery-timeout",
                      toString(recovery_timeout_.value().count()) + "ms");
@@ -4347,3 +4355,81 @@ TEST_P(RecoveryTest, LogRemovedBeforePurging) {
     return cluster->getNode(1).sendJsonCommand("info purges --json").empty();
   });
 }
+
+// Restarting the sequencer node of many logs makes their recoveries seal them
+// concurrently. With --seal-batch-max-logs, the SEALs go out in SEAL_BATCH
+// messages even though the restarted node has no connections yet when the
+// first SEALs are queued, and all logs still recover.
+TEST_P(RecoveryTest, SealBatching) {
+  const size_t num_logs = 100;
+  nodes_ = 4;
+  num_logs_ = num_logs;
+  seal_batch_max_logs_ = 16;
+  init();
+
+  ASSERT_EQ(0, cluster_->start());
+  ASSERT_EQ(0, cluster_->waitUntilAllSequencersQuiescent());
+
+  ld_info("Restarting sequencer node N0");
+  cluster_->getNode(0).restart(
+      /*graceful=*/false, /*wait_until_available=*/false);
+  wait_until("all logs recovered on N0", [&] {
+    return cluster_->getNode(0).stats()["recovery_success"] >=
+        static_cast<int64_t>(num_logs);
+  });
+
+  auto stats = cluster_->getNode(0).stats();
+  EXPECT_GT(stats["seal_batches_sent"], 0);
+  EXPECT_GT(stats["seal_batch_seals"], stats["seal_batches_sent"]);
+  EXPECT_EQ(0, cluster_->waitUntilAllSequencersQuiescent());
+
+  auto client = cluster_->createClient();
+  for (logid_t::raw_type log = 1; log <= num_logs; ++log) {
+    EXPECT_NE(LSN_INVALID, client->appendSync(logid_t(log), "payload"));
+  }
+}
+
+// Benchmark for mass failover: the sequencer node of many logs restarts and
+// reactivates all of their sequencers at once, which then seal and recover
+// their logs concurrently. Reports the time until all logs are recovered,
+// i.e. fully available again. Disabled since it's slow; run with
+// --gtest_also_run_disabled_tests, and LOGDEVICE_RECOVERY_BENCH_SEAL_BATCH=0
+// to compare with SEAL batching off.
+TEST_P(RecoveryTest, DISABLED_MassFailoverBenchmark) {
+  const size_t num_logs = 10000;
+  nodes_ = 4;
+  num_logs_ = num_logs;
+  const char* batch_env = getenv("LOGDEVICE_RECOVERY_BENCH_SEAL_BATCH");
+  seal_batch_max_logs_ =
+      batch_env ? folly::to<size_t>(batch_env) : size_t(1000);
+  init();
+
+  ASSERT_EQ(0, cluster_->start());
+  ASSERT_EQ(0, cluster_->waitUntilAllSequencersQuiescent());
+
+  auto recovered = [&] {
+    return cluster_->getNode(0).stats()["recovery_success"] >=
+        static_cast<int64_t>(num_logs);
+  };
+
+  ld_info("Restarting sequencer node N0");
+  auto start_time = std::chrono::steady_clock::now();
+  cluster_->getNode(0).restart(
+      /*graceful=*/false, /*wait_until_available=*/false);
+  wait_until("all logs recovered on N0", recovered);
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start_time);
+
+  auto stats = cluster_->getNode(0).stats();
+  ld_info("Recovered %lu logs in %ldms with --seal-batch-max-logs=%lu: "
+          "%ld SEAL_BATCH messages carrying %ld SEALs",
+          num_logs,
+          elapsed.count(),
+          seal_batch_max_logs_.value(),
+          stats["seal_batches_sent"],
+          stats["seal_batch_seals"]);
+  if (seal_batch_max_logs_.value() > 1) {
+    EXPECT_GT(stats["seal_batches_sent"], 0);
+  }
+  EXPECT_EQ(0, cluster_->waitUntilAllSequencersQuiescent());
+}
@@ -49,6 +49,8 @@ class FindTimeWorker : public MetaRequestWorker {
                     ms_ago,
                     RecordTimestamp(timestamp).toString().c_str());
 
+    traceEvent(TraceEventType::FIND_TIME, log_id, 0, ms_ago);
+
     return client_->findTime(
         state->log_id, timestamp, [this](Status st, lsn_t /*result*/) mutable {
           if (isStopped()) {
@@ -78,6 +80,7 @@ void registerFindTimeWorker() {
                              "log-requests-per-sec-distribution",
                              "findtime-avg-time-ago",
                              "findtime-timestamp-distribution",
+                             "record-trace",
                          },
                          {PartitioningMode::LOG, PartitioningMode::RECORD},
                          OptionsRestrictions::AllowBufferedWriterOptions::NO));
@@ -659,6 +659,28 @@ void Options::get_named_options(options_description& named) {
       "If enabled, writers will put some information into payloads "
       "(e.g. client-assigned timestamp), and readers will use this information "
       "to update stats.");
+  named.add_options()(
+      "record-trace",
+      value<std::string>(&record_trace)->default_value(""),
+      "If not empty, record the appends, reader starts and stops and "
+      "findTime calls that the worker does into this trace file, so that the "
+      "workload can be replayed with the \"replay\" bench.");
+  named.add_options()(
+      "trace-file",
+      value<std::string>(&trace_file)->default_value(""),
+      "Trace to replay, as recorded with --record-trace. Logs of the trace "
+      "that are not in the config are mapped to the logs that are.");
+  named.add_options()(
+      "replay-speed",
+      value<double>(&replay_speed)
+          ->default_value(1.0)
+          ->notifier([](double val) {
+            if (!(val > 0)) {
+              throw boost::program_options::error(
+                  "--replay-speed must be positive");
+            }
+          }),
+      "How many times faster than recorded to replay the trace.");
 
   // Default buffered writer options, taken from scribe config as of the time of
   // writing.
@@ -96,6 +96,9 @@ struct Options {
   double write_rate;
   bool pretend;
   bool record_writer_info;
+  // If not empty, the worker records the operations it does to this trace
+  // file, for the "replay" bench.
+  std::string record_trace;
   // If you're adding an option, don't forget to add it to a REGISTER_WORKER().
 
   // Options of "read" bench.
@@ -133,6 +136,10 @@ struct Options {
   std::chrono::milliseconds findtime_avg_time_ago = std::chrono::minutes(30);
   Log2Histogram findtime_timestamp_distribution;
 
+  // Options of "replay" bench.
+  std::string trace_file;
+  double replay_speed;
+
   // Populates the given options description with the options pointing to fields
   // of this Options instance.
   void get_named_options(boost::program_options::options_description&);
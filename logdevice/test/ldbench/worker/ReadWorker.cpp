@@ -122,6 +122,9 @@ class ReadWorker final : public Worker {
 
   void stopTailer(LogTailerState* tailer);
 
+  // Records the start of a tailer to the --record-trace file, if any.
+  void traceStart(LogTailerState* tailer);
+
   void printProgress(double seconds_since_start,
                      double seconds_since_last_call) override;
   void dumpDebugInfo() override;
@@ -263,6 +266,9 @@ void ReadWorker::tryStartTailer(LogTailerState* tailer) {
 }
 
 void ReadWorker::stopTailer(LogTailerState* tailer) {
+  traceEvent(
+      TraceEventType::STOP_READING, tailer->log_id, tailer->tailer_idx);
+
   if (tailer->reader_idx == -1) {
     tailer->retry_timer.reset();
   } else {
@@ -310,9 +316,25 @@ void ReadWorker::maybeRestartTailer(LogTailerState* tailer) {
   ++nrestarts_;
   stopTailer(tailer);
   maybeSetBacklogDepth(tailer);
+  traceStart(tailer);
   tailer->retry_timer.fire();
 }
 
+void ReadWorker::traceStart(LogTailerState* tailer) {
+  uint64_t depth_ms = 0;
+  if (options.read_all) {
+    // As far back as a timestamp goes, i.e. from the oldest record.
+    depth_ms = RecordTimestamp::now().toMilliseconds().count();
+  } else if (tailer->backlog_depth.has_value()) {
+    // 0 would mean the tail.
+    depth_ms = std::max<int64_t>(1, tailer->backlog_depth->count());
+  }
+  traceEvent(TraceEventType::START_READING,
+             tailer->log_id,
+             tailer->tailer_idx,
+             depth_ms);
+}
+
 int ReadWorker::run() {
   // Get the log set from config.
   std::vector<logid_t> logs;
@@ -633,6 +655,7 @@ int ReadWorker::run() {
           if (!no_restarts) {
             activateRestartTimer(tailer.get());
           }
+          traceStart(tailer.get());
           tailer->retry_timer.fire();
         }
       }
@@ -859,6 +882,7 @@ void registerReadWorker() {
               "pct-readers-consider-backlog-on-start",
               "record-writer-info",
               "start-time",
+              "record-trace",
           },
           {PartitioningMode::LOG, PartitioningMode::LOG_AND_IDX}));
 }
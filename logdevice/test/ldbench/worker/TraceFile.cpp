@@ -0,0 +1,258 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "logdevice/test/ldbench/worker/TraceFile.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include <folly/Varint.h>
+
+#include "logdevice/common/checks.h"
+#include "logdevice/common/debug.h"
+
+namespace facebook { namespace logdevice { namespace ldbench {
+
+namespace {
+
+constexpr char kMagic[8] = {'L', 'D', 'B', 'T', 'R', 'A', 'C', 'E'};
+constexpr uint32_t kVersion = 1;
+
+// Flush the buffer once it grows past this size.
+constexpr size_t kFlushThreshold = 64 * 1024;
+
+bool hasStream(TraceEventType type) {
+  return type == TraceEventType::START_READING ||
+      type == TraceEventType::STOP_READING;
+}
+
+bool hasValue(TraceEventType type) {
+  return type == TraceEventType::APPEND ||
+      type == TraceEventType::START_READING ||
+      type == TraceEventType::FIND_TIME;
+}
+
+} // namespace
+
+const char* traceEventTypeName(TraceEventType type) {
+  switch (type) {
+    case TraceEventType::APPEND:
+      return "APPEND";
+    case TraceEventType::START_READING:
+      return "START_READING";
+    case TraceEventType::STOP_READING:
+      return "STOP_READING";
+    case TraceEventType::FIND_TIME:
+      return "FIND_TIME";
+    case TraceEventType::GET_TAIL:
+      return "GET_TAIL";
+    case TraceEventType::MAX:
+      break;
+  }
+  return "UNKNOWN";
+}
+
+TraceWriter::TraceWriter(const std::string& path)
+    : start_time_(std::chrono::steady_clock::now()) {
+  file_ = std::fopen(path.c_str(), "wb");
+  if (file_ == nullptr) {
+    ld_error("Failed to open trace file %s for writing: %s",
+             path.c_str(),
+             strerror(errno));
+    return;
+  }
+  const uint8_t version[4] = {static_cast<uint8_t>(kVersion),
+                              static_cast<uint8_t>(kVersion >> 8),
+                              static_cast<uint8_t>(kVersion >> 16),
+                              static_cast<uint8_t>(kVersion >> 24)};
+  buf_.insert(buf_.end(), kMagic, kMagic + sizeof(kMagic));
+  buf_.insert(buf_.end(), version, version + sizeof(version));
+}
+
+TraceWriter::~TraceWriter() {
+  if (file_ != nullptr) {
+    flush();
+    std::fclose(file_);
+  }
+}
+
+void TraceWriter::record(TraceEventType type,
+                         uint64_t log_id,
+                         uint64_t stream,
+                         uint64_t value) {
+  TraceEvent event;
+  event.type = type;
+  event.log_id = log_id;
+  event.stream = stream;
+  event.value = value;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Take the time under the lock so that times don't go backwards.
+  event.time = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start_time_);
+  writeLocked(event);
+}
+
+bool TraceWriter::write(const TraceEvent& event) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return writeLocked(event);
+}
+
+bool TraceWriter::flush() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return flushLocked();
+}
+
+bool TraceWriter::writeLocked(const TraceEvent& event) {
+  if (file_ == nullptr) {
+    return true;
+  }
+  if (event.type >= TraceEventType::MAX) {
+    RATELIMIT_ERROR(std::chrono::seconds(10),
+                    2,
+                    "Not writing trace event of invalid type %d",
+                    static_cast<int>(event.type));
+    return true;
+  }
+  if (event.time < last_time_) {
+    RATELIMIT_ERROR(std::chrono::seconds(10),
+                    2,
+                    "Not writing %s trace event out of order: time %ldus is "
+                    "before the previous event's %ldus",
+                    traceEventTypeName(event.type),
+                    event.time.count(),
+                    last_time_.count());
+    return true;
+  }
+
+  uint8_t tmp[folly::kMaxVarintLength64];
+  auto put = [&](uint64_t v) {
+    size_t len = folly::encodeVarint(v, tmp);
+    buf_.insert(buf_.end(), tmp, tmp + len);
+  };
+  put((event.time - last_time_).count());
+  buf_.push_back(static_cast<uint8_t>(event.type));
+  put(event.log_id);
+  if (hasStream(event.type)) {
+    put(event.stream);
+  }
+  if (hasValue(event.type)) {
+    put(event.value);
+  }
+  last_time_ = event.time;
+
+  return buf_.size() >= kFlushThreshold ? flushLocked() : false;
+}
+
+bool TraceWriter::flushLocked() {
+  if (file_ == nullptr) {
+    return true;
+  }
+  if (!buf_.empty() &&
+      std::fwrite(buf_.data(), 1, buf_.size(), file_) != buf_.size()) {
+    RATELIMIT_ERROR(std::chrono::seconds(10),
+                    2,
+                    "Failed to write trace: %s",
+                    strerror(errno));
+    return true;
+  }
+  buf_.clear();
+  if (std::fflush(file_) != 0) {
+    ld_error("Failed to flush trace: %s", strerror(errno));
+    return true;
+  }
+  return false;
+}
+
+TraceReader::TraceReader(const std::string& path) {
+  file_ = std::fopen(path.c_str(), "rb");
+  if (file_ == nullptr) {
+    ld_error("Failed to open trace file %s: %s", path.c_str(), strerror(errno));
+    return;
+  }
+  char magic[sizeof(kMagic)];
+  uint8_t version[4];
+  if (std::fread(magic, 1, sizeof(magic), file_) != sizeof(magic) ||
+      std::fread(version, 1, sizeof(version), file_) != sizeof(version) ||
+      std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+    ld_error("%s is not a trace file", path.c_str());
+    std::fclose(file_);
+    file_ = nullptr;
+    return;
+  }
+  uint32_t v = version[0] | (version[1] << 8) | (version[2] << 16) |
+      (uint32_t(version[3]) << 24);
+  if (v != kVersion) {
+    ld_error("Trace file %s has unsupported version %u, expected %u",
+             path.c_str(),
+             v,
+             kVersion);
+    std::fclose(file_);
+    file_ = nullptr;
+  }
+}
+
+TraceReader::~TraceReader() {
+  if (file_ != nullptr) {
+    std::fclose(file_);
+  }
+}
+
+bool TraceReader::readVarint(uint64_t* out) {
+  uint64_t v = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    int c = std::getc(file_);
+    if (c == EOF) {
+      return false;
+    }
+    v |= uint64_t(c & 0x7f) << shift;
+    if (!(c & 0x80)) {
+      *out = v;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool TraceReader::next(TraceEvent* event_out) {
+  ld_check(event_out != nullptr);
+  if (file_ == nullptr) {
+    return false;
+  }
+
+  uint64_t delta;
+  if (!readVarint(&delta)) {
+    if (!std::feof(file_)) {
+      ld_error("Trace is corrupt: bad event time");
+    }
+    // Otherwise it's the end of the trace.
+    return false;
+  }
+
+  TraceEvent event;
+  int type = std::getc(file_);
+  if (type == EOF || type >= static_cast<int>(TraceEventType::MAX)) {
+    ld_error("Trace is corrupt or truncated: bad event type %d", type);
+    return false;
+  }
+  event.type = static_cast<TraceEventType>(type);
+  event.time = last_time_ + std::chrono::microseconds(delta);
+  if (!readVarint(&event.log_id) ||
+      (hasStream(event.type) && !readVarint(&event.stream)) ||
+      (hasValue(event.type) && !readVarint(&event.value))) {
+    ld_error("Trace is corrupt or truncated: incomplete %s event",
+             traceEventTypeName(event.type));
+    return false;
+  }
+
+  last_time_ = event.time;
+  *event_out = event;
+  return true;
+}
+
+}}} // namespace facebook::logdevice::ldbench
@@ -0,0 +1,164 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+namespace facebook { namespace logdevice { namespace ldbench {
+
+/**
+ * @file Compact binary traces of client workloads, recorded by ldbench
+ *       workers with --record-trace and replayed by the "replay" worker.
+ *
+ *       A trace file is a header followed by a sequence of events:
+ *
+ *         header: "LDBTRACE" magic, then a uint32 version, little-endian
+ *         event:  varint microseconds since the previous event
+ *                 uint8  TraceEventType
+ *                 varint log id
+ *                 varint stream (START/STOP_READING only)
+ *                 varint value (APPEND, START_READING and FIND_TIME only)
+ *
+ *       so a typical event takes 5-10 bytes. Payloads are not recorded,
+ *       only their sizes.
+ */
+
+enum class TraceEventType : uint8_t {
+  // Append of `value` bytes.
+  APPEND = 0,
+  // Start reading the log, `value` milliseconds behind the current time,
+  // or from the tail if `value` is 0. `stream` tells apart readers of the
+  // same log, it is reused once the reader is stopped.
+  START_READING = 1,
+  // Stop the reader started with the same log and stream.
+  STOP_READING = 2,
+  // findTime for the timestamp `value` milliseconds ago.
+  FIND_TIME = 3,
+  // getTailLSN.
+  GET_TAIL = 4,
+
+  MAX
+};
+
+const char* traceEventTypeName(TraceEventType type);
+
+struct TraceEvent {
+  // Time since the beginning of the trace.
+  std::chrono::microseconds time{0};
+  TraceEventType type{TraceEventType::APPEND};
+  uint64_t log_id{0};
+  uint64_t stream{0};
+  uint64_t value{0};
+
+  bool operator==(const TraceEvent& rhs) const {
+    return time == rhs.time && type == rhs.type && log_id == rhs.log_id &&
+        stream == rhs.stream && value == rhs.value;
+  }
+};
+
+/**
+ * Writes events to a trace file. Thread safe: events may be added from any
+ * thread, they are timed when added.
+ */
+class TraceWriter : private boost::noncopyable {
+ public:
+  /**
+   * Opens (and truncates) the file. Check ok() for success.
+   */
+  explicit TraceWriter(const std::string& path);
+
+  /**
+   * Flushes and closes the file.
+   */
+  ~TraceWriter();
+
+  bool ok() const {
+    return file_ != nullptr;
+  }
+
+  /**
+   * Adds an event that happens now. Event times are relative to the creation
+   * of the TraceWriter. Errors are logged and otherwise ignored; the trace
+   * is best effort.
+   */
+  void record(TraceEventType type,
+              uint64_t log_id,
+              uint64_t stream = 0,
+              uint64_t value = 0);
+
+  /**
+   * Adds an event with an explicit time. Times must not decrease.
+   * Mostly useful for converting traces from other sources, and for tests.
+   *
+   * @return
+   *  false on success, true on failure (I/O error, invalid event type, or
+   *  event out of order). An event that failed validation isn't written and
+   *  the trace can still be added to.
+   */
+  bool write(const TraceEvent& event);
+
+  /**
+   * Writes out buffered events.
+   *
+   * @return
+   *  false on success, true on I/O error.
+   */
+  bool flush();
+
+ private:
+  bool writeLocked(const TraceEvent& event);
+  bool flushLocked();
+
+  std::mutex mutex_;
+  FILE* file_{nullptr};
+  std::chrono::steady_clock::time_point start_time_;
+  std::chrono::microseconds last_time_{0};
+  std::vector<uint8_t> buf_;
+};
+
+/**
+ * Reads a trace file sequentially.
+ */
+class TraceReader : private boost::noncopyable {
+ public:
+  /**
+   * Opens the file and checks its header. Check ok() for success.
+   */
+  explicit TraceReader(const std::string& path);
+
+  ~TraceReader();
+
+  bool ok() const {
+    return file_ != nullptr;
+  }
+
+  /**
+   * Reads the next event.
+   *
+   * @return
+   *  true if an event was read, false at the end of the trace or if the trace
+   *  is corrupt (in which case an error is logged).
+   */
+  bool next(TraceEvent* event_out);
+
+ private:
+  bool readVarint(uint64_t* out);
+
+  FILE* file_{nullptr};
+  std::chrono::microseconds last_time_{0};
+};
+
+}}} // namespace facebook::logdevice::ldbench
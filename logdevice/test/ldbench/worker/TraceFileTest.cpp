@@ -0,0 +1,158 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "logdevice/test/ldbench/worker/TraceFile.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace facebook { namespace logdevice { namespace ldbench {
+
+class TraceFileTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    tmp_file_name = std::tmpnam(nullptr);
+  }
+  void TearDown() override {
+    std::remove(tmp_file_name.c_str());
+  }
+
+  std::vector<TraceEvent> readAll() {
+    TraceReader reader(tmp_file_name);
+    EXPECT_TRUE(reader.ok());
+    std::vector<TraceEvent> events;
+    TraceEvent event;
+    while (reader.next(&event)) {
+      events.push_back(event);
+    }
+    return events;
+  }
+
+  std::string tmp_file_name;
+};
+
+TEST_F(TraceFileTest, RoundTrip) {
+  std::vector<TraceEvent> events;
+  auto add = [&](int64_t us,
+                 TraceEventType type,
+                 uint64_t log,
+                 uint64_t stream,
+                 uint64_t value) {
+    TraceEvent e;
+    e.time = std::chrono::microseconds(us);
+    e.type = type;
+    e.log_id = log;
+    e.stream = stream;
+    e.value = value;
+    events.push_back(e);
+  };
+  add(0, TraceEventType::APPEND, 1, 0, 100);
+  add(0, TraceEventType::APPEND, 1, 0, 1ul << 40);
+  add(5, TraceEventType::START_READING, 2, 3, 0);
+  add(1000000, TraceEventType::FIND_TIME, 4611686018427387904ul, 0, 60000);
+  add(1000001, TraceEventType::GET_TAIL, 3, 0, 0);
+  add(3600000000l, TraceEventType::STOP_READING, 2, 3, 0);
+
+  {
+    TraceWriter writer(tmp_file_name);
+    ASSERT_TRUE(writer.ok());
+    for (const auto& e : events) {
+      EXPECT_FALSE(writer.write(e));
+    }
+  }
+  EXPECT_EQ(events, readAll());
+}
+
+// Invalid events are rejected with an error and leave the trace usable.
+TEST_F(TraceFileTest, InvalidEvents) {
+  TraceEvent first;
+  first.time = std::chrono::microseconds(10);
+  first.type = TraceEventType::GET_TAIL;
+  first.log_id = 1;
+  TraceEvent last = first;
+  last.time = std::chrono::microseconds(20);
+  {
+    TraceWriter writer(tmp_file_name);
+    ASSERT_TRUE(writer.ok());
+    EXPECT_FALSE(writer.write(first));
+    TraceEvent bad = first;
+    bad.time = std::chrono::microseconds(5);
+    EXPECT_TRUE(writer.write(bad));
+    bad = first;
+    bad.type = TraceEventType::MAX;
+    EXPECT_TRUE(writer.write(bad));
+    EXPECT_FALSE(writer.write(last));
+  }
+  EXPECT_EQ(std::vector<TraceEvent>({first, last}), readAll());
+}
+
+TEST_F(TraceFileTest, Record) {
+  {
+    TraceWriter writer(tmp_file_name);
+    ASSERT_TRUE(writer.ok());
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+      threads.emplace_back([&writer, i] {
+        for (int j = 0; j < 1000; ++j) {
+          writer.record(TraceEventType::APPEND, i + 1, 0, j);
+        }
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+  }
+
+  auto events = readAll();
+  ASSERT_EQ(4000, events.size());
+  std::vector<uint64_t> next_value(5, 0);
+  for (size_t i = 0; i < events.size(); ++i) {
+    if (i > 0) {
+      EXPECT_GE(events[i].time, events[i - 1].time);
+    }
+    EXPECT_EQ(TraceEventType::APPEND, events[i].type);
+    // Events of each thread are in order.
+    EXPECT_EQ(next_value.at(events[i].log_id)++, events[i].value);
+  }
+}
+
+TEST_F(TraceFileTest, Truncated) {
+  {
+    TraceWriter writer(tmp_file_name);
+    writer.record(TraceEventType::APPEND, 1, 0, 100);
+    writer.record(TraceEventType::FIND_TIME, 1, 0, 1ul << 50);
+  }
+  // Cut the last event in the middle of its value.
+  std::ifstream in(tmp_file_name, std::ios::binary);
+  std::string data((std::istreambuf_iterator<char>(in)),
+                   std::istreambuf_iterator<char>());
+  in.close();
+  std::ofstream out(tmp_file_name, std::ios::binary | std::ios::trunc);
+  out.write(data.data(), data.size() - 2);
+  out.close();
+
+  auto events = readAll();
+  ASSERT_EQ(1, events.size());
+  EXPECT_EQ(100, events[0].value);
+}
+
+TEST_F(TraceFileTest, NotATrace) {
+  {
+    std::ofstream out(tmp_file_name);
+    out << "this is not a trace";
+  }
+  TraceReader reader(tmp_file_name);
+  EXPECT_FALSE(reader.ok());
+}
+
+}}} // namespace facebook::logdevice::ldbench
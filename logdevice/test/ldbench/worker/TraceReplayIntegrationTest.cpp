@@ -0,0 +1,135 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <folly/dynamic.h>
+#include <folly/json.h>
+#include <gtest/gtest.h>
+
+#include "logdevice/common/test/TestUtil.h"
+#include "logdevice/test/ldbench/worker/Options.h"
+#include "logdevice/test/ldbench/worker/TraceFile.h"
+#include "logdevice/test/ldbench/worker/Worker.h"
+#include "logdevice/test/ldbench/worker/WorkerRegistry.h"
+#include "logdevice/test/utils/IntegrationTestUtils.h"
+
+namespace facebook { namespace logdevice { namespace ldbench {
+
+class TraceReplayIntegrationTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    cluster_ = IntegrationTestUtils::ClusterFactory().setNumLogs(4).create(3);
+    temp_dir_ = std::make_unique<TemporaryDirectory>("traceReplayTest");
+    trace_file_ = temp_dir_->path().generic_string() + "/trace";
+    options.bench_name = "replay";
+    options.sys_name = "logdevice";
+    options.config_path = cluster_->getConfigPath();
+    options.log_range_names.clear();
+    options.log_hash_range = std::make_pair(0.0, 1.0);
+    options.partition_by = PartitioningMode::LOG;
+    options.worker_id_index = 0;
+    options.worker_id_count = 1;
+    options.duration = -1;
+    options.max_appends_in_flight = 1000;
+    options.record_writer_info = false;
+    options.trace_file = trace_file_;
+    options.publish_dir = temp_dir_->path().generic_string();
+    options.stats_interval = 1;
+    options.event_ratio = 0;
+    stats_file_name_ = folly::to<std::string>(options.publish_dir,
+                                              "/stats_",
+                                              options.bench_name,
+                                              options.worker_id_index,
+                                              "_.csv");
+  }
+
+  void writeEvent(std::chrono::milliseconds time,
+                  TraceEventType type,
+                  uint64_t log,
+                  uint64_t stream,
+                  uint64_t value) {
+    TraceEvent event;
+    event.time = time;
+    event.type = type;
+    event.log_id = log;
+    event.stream = stream;
+    event.value = value;
+    ASSERT_FALSE(writer_->write(event));
+  }
+
+  // Last stats line the worker published.
+  folly::dynamic lastStats() {
+    std::ifstream in(stats_file_name_);
+    EXPECT_TRUE(in);
+    std::string line;
+    std::string last;
+    while (in >> line) {
+      last = line;
+    }
+    return last.empty() ? folly::dynamic::object() : folly::parseJson(last);
+  }
+
+  std::unique_ptr<IntegrationTestUtils::Cluster> cluster_;
+  std::unique_ptr<TemporaryDirectory> temp_dir_;
+  std::unique_ptr<TraceWriter> writer_;
+  std::string trace_file_;
+  std::string stats_file_name_;
+};
+
+// Appends to some logs, then reads one of them from the backlog. Replayed
+// at 2x, so the trace takes ~2s.
+TEST_F(TraceReplayIntegrationTest, Replay) {
+  using std::chrono::milliseconds;
+  const int appends_per_log = 20;
+  const uint64_t payload_size = 100;
+  writer_ = std::make_unique<TraceWriter>(trace_file_);
+  ASSERT_TRUE(writer_->ok());
+  for (int i = 0; i < appends_per_log; ++i) {
+    writeEvent(
+        milliseconds(10 * i), TraceEventType::APPEND, 1, 0, payload_size);
+    // Not in the config, mapped to one of the 4 logs.
+    writeEvent(
+        milliseconds(10 * i), TraceEventType::APPEND, 1000, 0, payload_size);
+  }
+  writeEvent(milliseconds(1000), TraceEventType::GET_TAIL, 1, 0, 0);
+  writeEvent(milliseconds(1000), TraceEventType::FIND_TIME, 2, 0, 1000);
+  // Read log 1 from an hour ago, i.e. all of it.
+  writeEvent(milliseconds(2000), TraceEventType::START_READING, 1, 0, 3600000);
+  writeEvent(milliseconds(4000), TraceEventType::STOP_READING, 1, 0, 0);
+  writer_.reset();
+
+  options.replay_speed = 2.0;
+  auto worker = getWorkerFactoryMap().at("replay").factory();
+  auto start = std::chrono::steady_clock::now();
+  ASSERT_EQ(0, worker->run());
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  worker.reset();
+  EXPECT_GE(elapsed, std::chrono::milliseconds(2000));
+
+  // All appends succeeded, and log 1 was read back. If log 1000 got mapped to
+  // log 1, its records were read too.
+  folly::dynamic stats = lastStats();
+  ASSERT_TRUE(stats.count("success"));
+  int64_t records = stats["success"].asInt() - 2 * appends_per_log;
+  EXPECT_TRUE(records == appends_per_log || records == 2 * appends_per_log)
+      << records;
+  EXPECT_EQ(0, stats["fail"].asInt());
+  EXPECT_EQ((2 * appends_per_log + records) * payload_size,
+            stats["success_byte"].asInt());
+}
+
+TEST_F(TraceReplayIntegrationTest, MissingTrace) {
+  options.replay_speed = 1.0;
+  auto worker = getWorkerFactoryMap().at("replay").factory();
+  EXPECT_NE(0, worker->run());
+}
+
+}}} // namespace facebook::logdevice::ldbench
@@ -0,0 +1,489 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <folly/Hash.h>
+
+#include "logdevice/common/Timestamp.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/common/util.h"
+#include "logdevice/include/types.h"
+#include "logdevice/test/ldbench/worker/BenchStats.h"
+#include "logdevice/test/ldbench/worker/LogStoreClientHolder.h"
+#include "logdevice/test/ldbench/worker/LogStoreReader.h"
+#include "logdevice/test/ldbench/worker/Options.h"
+#include "logdevice/test/ldbench/worker/TraceFile.h"
+#include "logdevice/test/ldbench/worker/Worker.h"
+#include "logdevice/test/ldbench/worker/WorkerRegistry.h"
+
+namespace facebook { namespace logdevice { namespace ldbench {
+namespace {
+
+static constexpr const char* BENCH_NAME = "replay";
+
+// Readers of the same log in a trace are told apart by a small stream index.
+// Larger ones are assumed to come from a broken trace.
+static constexpr uint64_t MAX_STREAMS = 1024;
+
+/**
+ * Trace replay benchmark worker.
+ *
+ * Replays the appends, reader starts and stops, findTime and getTailLSN calls
+ * of a trace recorded with --record-trace (see TraceFile.h), at the recorded
+ * times divided by --replay-speed. Appends and reads are reported to
+ * BenchStats, like for the "write" and "read" benches.
+ *
+ * Logs of the trace that are not in the config are mapped to the logs that
+ * are, so a trace can be replayed against a different cluster (e.g. a local
+ * test cluster) than the one it was recorded on. Events for logs of other
+ * workers (see --partition-by) are skipped.
+ *
+ * The replay stops at the end of the trace or after --duration, whichever
+ * comes first.
+ */
+class TraceReplayWorker final : public Worker {
+ public:
+  using Worker::Worker;
+  int run() override;
+
+  void onAppendDone(LogIDType log_id,
+                    bool successful,
+                    bool buffered,
+                    uint64_t num_records,
+                    uint64_t payload_bytes) override;
+
+ private:
+  struct StreamState {
+    // Bumped on every start and stop, so that a findTime() or getTailLSN()
+    // completing after the stream was stopped or restarted is ignored.
+    uint64_t generation = 0;
+    bool reading = false;
+  };
+
+  // Returns the log of this cluster on which to replay events of the trace's
+  // `trace_log`, or LOGID_INVALID if that log belongs to another worker.
+  logid_t mapLog(uint64_t trace_log);
+
+  // These run on ev_.
+  void replay(const TraceEvent& event, logid_t log);
+  void append(logid_t log, uint64_t size);
+  void startReading(logid_t log, uint64_t stream, uint64_t depth_ms);
+  void onStartLSN(logid_t log,
+                  uint64_t stream,
+                  uint64_t generation,
+                  bool backlog,
+                  bool successful,
+                  lsn_t lsn);
+  void stopReading(logid_t log, uint64_t stream);
+  LogStoreReader* getReader(uint64_t stream);
+
+  void printProgress(double seconds_since_start,
+                     double seconds_since_last_call) override;
+
+  // Logs in the config, and the ones assigned to this worker.
+  std::vector<logid_t> all_logs_;
+  std::unordered_set<logid_t, logid_t::Hash> my_logs_;
+  std::unordered_map<uint64_t, logid_t> log_map_;
+
+  // readers_[i] reads the logs for which stream i is active.
+  std::vector<std::unique_ptr<LogStoreReader>> readers_;
+  std::map<std::pair<logid_t, uint64_t>, StreamState> streams_;
+
+  std::atomic<uint64_t> nevents_{0};
+  std::atomic<uint64_t> nappends_{0};
+  std::atomic<uint64_t> nappends_failed_{0};
+  std::atomic<uint64_t> nappends_skipped_{0};
+  std::atomic<uint64_t> appends_in_flight_{0};
+  std::atomic<uint64_t> nreads_started_{0};
+  std::atomic<uint64_t> nreads_failed_{0};
+  std::atomic<uint64_t> nrecords_{0};
+  std::atomic<uint64_t> nbytes_read_{0};
+  std::atomic<uint64_t> nfindtimes_{0};
+  std::atomic<uint64_t> ngettails_{0};
+  std::atomic<uint64_t> nmeta_failed_{0};
+
+  // How far behind the trace the replay got, at most.
+  std::chrono::microseconds max_lag_{0};
+  uint64_t prev_nevents_ = 0;
+};
+
+logid_t TraceReplayWorker::mapLog(uint64_t trace_log) {
+  auto it = log_map_.find(trace_log);
+  if (it != log_map_.end()) {
+    return it->second;
+  }
+
+  ld_check(!all_logs_.empty());
+  logid_t log(trace_log);
+  if (!std::binary_search(all_logs_.begin(), all_logs_.end(), log)) {
+    log = all_logs_[folly::hash::hash_128_to_64(trace_log, 534773) %
+                    all_logs_.size()];
+  }
+  if (!my_logs_.count(log)) {
+    log = LOGID_INVALID;
+  }
+  log_map_.emplace(trace_log, log);
+  return log;
+}
+
+void TraceReplayWorker::replay(const TraceEvent& event, logid_t log) {
+  switch (event.type) {
+    case TraceEventType::APPEND:
+      append(log, event.value);
+      break;
+    case TraceEventType::START_READING:
+      startReading(log, event.stream, event.value);
+      break;
+    case TraceEventType::STOP_READING:
+      stopReading(log, event.stream);
+      break;
+    case TraceEventType::FIND_TIME: {
+      ++nfindtimes_;
+      auto ts = RecordTimestamp::now().toMilliseconds() -
+          std::chrono::milliseconds(event.value);
+      auto cb = [this](bool successful, uint64_t) {
+        if (!successful) {
+          ++nmeta_failed_;
+        }
+      };
+      if (!options.pretend && !findTime(log, ts, std::move(cb))) {
+        ++nmeta_failed_;
+      }
+      break;
+    }
+    case TraceEventType::GET_TAIL: {
+      ++ngettails_;
+      auto cb = [this](bool successful, uint64_t) {
+        if (!successful) {
+          ++nmeta_failed_;
+        }
+      };
+      if (!options.pretend && !getTailLSN(log, std::move(cb))) {
+        ++nmeta_failed_;
+      }
+      break;
+    }
+    case TraceEventType::MAX:
+      ld_check(false);
+      break;
+  }
+}
+
+void TraceReplayWorker::append(logid_t log, uint64_t size) {
+  if (appends_in_flight_.load() >= options.max_appends_in_flight) {
+    ++nappends_skipped_;
+    if (!options.pretend) {
+      client_holder_->getBenchStatsHolder()->getOrCreateTLStats()->incStat(
+          StatsType::SKIPPED, 1);
+    }
+    return;
+  }
+
+  ++nappends_;
+  ++appends_in_flight_;
+  if (options.pretend) {
+    ev_->add(
+        [this, log, size] { onAppendDone(log.val_, true, false, 1, size); });
+    return;
+  }
+  if (!client_holder_->append(
+          log.val(), generatePayload(size), reinterpret_cast<void*>(size))) {
+    --appends_in_flight_;
+    ++nappends_failed_;
+  }
+}
+
+void TraceReplayWorker::onAppendDone(LogIDType /* log_id */,
+                                     bool successful,
+                                     bool /* buffered */,
+                                     uint64_t /* num_records */,
+                                     uint64_t /* payload_bytes */) {
+  ld_check(appends_in_flight_.load() > 0);
+  --appends_in_flight_;
+  if (!successful) {
+    ++nappends_failed_;
+  }
+}
+
+LogStoreReader* TraceReplayWorker::getReader(uint64_t stream) {
+  ld_check(stream < MAX_STREAMS);
+  if (stream >= readers_.size()) {
+    readers_.resize(stream + 1);
+  }
+  auto& reader = readers_[stream];
+  if (!reader) {
+    reader = client_holder_->createReader();
+    reader->setWorkerRecordCallback(
+        [this](LogIDType,
+               LogPositionType,
+               std::chrono::milliseconds,
+               std::string payload) {
+          ++nrecords_;
+          nbytes_read_ += payload.size();
+          return true;
+        });
+    reader->setWorkerGapCallback(
+        [](LogStoreGapType, LogIDType, LogPositionType, LogPositionType) {
+          return true;
+        });
+  }
+  return reader.get();
+}
+
+void TraceReplayWorker::startReading(logid_t log,
+                                     uint64_t stream,
+                                     uint64_t depth_ms) {
+  if (stream >= MAX_STREAMS) {
+    RATELIMIT_WARNING(std::chrono::seconds(10),
+                      2,
+                      "Skipping reader %lu of log %lu: too many readers",
+                      stream,
+                      log.val_);
+    return;
+  }
+  if (streams_[std::make_pair(log, stream)].reading) {
+    // Not stopped in the trace, e.g. if it was cut short. Restart.
+    stopReading(log, stream);
+  }
+  auto& state = streams_[std::make_pair(log, stream)];
+  uint64_t generation = ++state.generation;
+  ++nreads_started_;
+  if (options.pretend) {
+    return;
+  }
+
+  // Like the "read" bench, find where to start with findTime() if reading
+  // from the backlog, or with getTailLSN() if tailing.
+  bool backlog = depth_ms > 0;
+  auto cb = [this, log, stream, generation, backlog](bool successful,
+                                                     uint64_t lsn) {
+    onStartLSN(log, stream, generation, backlog, successful, lsn);
+  };
+  int rv;
+  if (backlog) {
+    auto ts = RecordTimestamp::now().toMilliseconds() -
+        std::chrono::milliseconds(depth_ms);
+    rv = findTime(log, ts, std::move(cb));
+  } else {
+    rv = getTailLSN(log, std::move(cb));
+  }
+  if (!rv) {
+    ++nreads_failed_;
+  }
+}
+
+void TraceReplayWorker::onStartLSN(logid_t log,
+                                   uint64_t stream,
+                                   uint64_t generation,
+                                   bool backlog,
+                                   bool successful,
+                                   lsn_t lsn) {
+  auto it = streams_.find(std::make_pair(log, stream));
+  ld_check(it != streams_.end());
+  StreamState& state = it->second;
+  if (state.generation != generation) {
+    // Stopped or restarted in the meantime.
+    return;
+  }
+  if (!successful || lsn == LSN_INVALID) {
+    ++nreads_failed_;
+    return;
+  }
+  // Start after the tail. See ReadWorker::tryStartTailer() for why not
+  // just lsn + 1.
+  lsn = lsn + !backlog > lsn ? lsn + !backlog : lsn;
+  if (!getReader(stream)->startReading(log.val(), lsn, LSN_MAX)) {
+    RATELIMIT_INFO(std::chrono::seconds(10),
+                   2,
+                   "Failed to start reading log %lu: %s",
+                   log.val_,
+                   error_name(err));
+    ++nreads_failed_;
+    return;
+  }
+  state.reading = true;
+}
+
+void TraceReplayWorker::stopReading(logid_t log, uint64_t stream) {
+  auto it = streams_.find(std::make_pair(log, stream));
+  if (it == streams_.end()) {
+    return;
+  }
+  StreamState& state = it->second;
+  ++state.generation;
+  if (state.reading) {
+    ld_check(stream < readers_.size() && readers_[stream]);
+    readers_[stream]->stopReading(log.val());
+    state.reading = false;
+  }
+}
+
+int TraceReplayWorker::run() {
+  TraceReader trace(options.trace_file);
+  if (!trace.ok()) {
+    return 1;
+  }
+
+  if (getLogs(all_logs_)) {
+    return 1;
+  }
+  if (all_logs_.empty()) {
+    ld_error("No logs to replay the trace on");
+    return 1;
+  }
+  std::sort(all_logs_.begin(), all_logs_.end());
+  for (logid_t log : getLogsPartition(all_logs_)) {
+    my_logs_.insert(log);
+  }
+
+  waitUntilStartTime();
+
+  using Clock = std::chrono::steady_clock;
+  const auto start_time = Clock::now();
+  auto end_time = Clock::time_point::max();
+  if (options.duration > 0) {
+    end_time = start_time + std::chrono::seconds(options.duration);
+  }
+  const auto print_progress_every = std::chrono::seconds(1);
+  auto last_progress_time = start_time;
+
+  TraceEvent event;
+  while (!isStopped() && trace.next(&event)) {
+    auto due = start_time +
+        std::chrono::duration_cast<Clock::duration>(
+                   std::chrono::duration<double, std::micro>(
+                       event.time.count() / options.replay_speed));
+    if (due > end_time) {
+      break;
+    }
+
+    // Sleep in small steps to notice stop() in time.
+    auto now = Clock::now();
+    while (now < due && !isStopped()) {
+      /* sleep override */
+      std::this_thread::sleep_for(
+          std::min<Clock::duration>(due - now, std::chrono::milliseconds(100)));
+      now = Clock::now();
+    }
+    if (isStopped()) {
+      break;
+    }
+    max_lag_ = std::max(
+        max_lag_,
+        std::chrono::duration_cast<std::chrono::microseconds>(now - due));
+
+    if (now - last_progress_time >= print_progress_every) {
+      printProgress(
+          std::chrono::duration<double>(now - start_time).count(),
+          std::chrono::duration<double>(now - last_progress_time).count());
+      last_progress_time = now;
+    }
+
+    logid_t log = mapLog(event.log_id);
+    if (log == LOGID_INVALID) {
+      continue;
+    }
+    ++nevents_;
+    ev_->add([this, event, log] {
+      if (!isStopped()) {
+        replay(event, log);
+      }
+    });
+  }
+
+  // Let the last appends complete so that they're accounted for.
+  const auto drain_deadline = Clock::now() + options.client_timeout;
+  while (!isStopped() && appends_in_flight_.load() > 0 &&
+         Clock::now() < drain_deadline) {
+    /* sleep override */
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  stop();
+  auto actual_duration_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() -
+                                                            start_time);
+
+  if (!options.pretend) {
+    ld_info("Stopping reads");
+    executeOnEventLoopSync([&] {
+      for (auto& kv : streams_) {
+        stopReading(kv.first.first, kv.first.second);
+      }
+    });
+  }
+
+  ld_info("Destroying readers");
+  for (auto& r : readers_) {
+    r.reset();
+  }
+
+  // Make sure no callbacks will be called after the worker is destroyed.
+  destroyClient();
+
+  ld_info("All done. Replay lagged behind the trace by up to %.3fs",
+          max_lag_.count() / 1e6);
+
+  std::cout << actual_duration_ms.count() << ' ' << nevents_ << ' '
+            << nappends_ << ' ' << nappends_failed_ << ' ' << nappends_skipped_
+            << ' ' << nreads_started_ << ' ' << nreads_failed_ << ' '
+            << nrecords_ << ' ' << nbytes_read_ << ' ' << nfindtimes_ << ' '
+            << ngettails_ << ' ' << nmeta_failed_ << '\n';
+
+  return 0;
+}
+
+void TraceReplayWorker::printProgress(double seconds_since_start,
+                                      double seconds_since_last_call) {
+  uint64_t nevents = nevents_.load();
+  double events_per_sec = (nevents - prev_nevents_) / seconds_since_last_call;
+  prev_nevents_ = nevents;
+
+  std::array<std::array<char, 32>, 4> bufs; // for commaprint_r()
+  ld_info("ran for: %.3fs, events: %s, appends: %s, appends in flight: %lu, "
+          "readers started: %lu, records read: %s, events/s: %s, "
+          "max lag: %.3fs",
+          seconds_since_start,
+          commaprint_r(nevents, &bufs[0][0], 32),
+          commaprint_r(nappends_.load(), &bufs[1][0], 32),
+          appends_in_flight_.load(),
+          nreads_started_.load(),
+          commaprint_r(nrecords_.load(), &bufs[2][0], 32),
+          commaprint_r((uint64_t)events_per_sec, &bufs[3][0], 32),
+          max_lag_.count() / 1e6);
+}
+
+} // namespace
+
+void registerTraceReplayWorker() {
+  registerWorkerImpl(BENCH_NAME,
+                     []() -> std::unique_ptr<Worker> {
+                       return std::make_unique<TraceReplayWorker>();
+                     },
+                     OptionsRestrictions(
+                         {
+                             "pretend",
+                             "duration",
+                             "trace-file",
+                             "replay-speed",
+                             "max-appends-in-flight",
+                             "start-time",
+                         },
+                         {PartitioningMode::LOG}));
+}
+
+}}} // namespace facebook::logdevice::ldbench
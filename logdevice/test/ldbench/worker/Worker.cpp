@@ -20,6 +20,7 @@
 #include <folly/Range.h>
 #include <folly/synchronization/Baton.h>
 
+#include "logdevice/common/ConstructorFailed.h"
 #include "logdevice/common/ReadStreamAttributes.h"
 #include "logdevice/common/debug.h"
 #include "logdevice/include/AsyncReader.h"
@@ -33,6 +34,13 @@
 namespace facebook { namespace logdevice { namespace ldbench {
 
 Worker::Worker() : ev_(new EventLoop("ldbench:ev")) {
+  if (!options.record_trace.empty()) {
+    trace_writer_ = std::make_unique<TraceWriter>(options.record_trace);
+    if (!trace_writer_->ok()) {
+      throw ConstructorFailed();
+    }
+  }
+
   if (options.pretend) {
     return;
   }
@@ -162,6 +170,10 @@ bool Worker::getTailLSNs(LogToLsnMap& tail_lsns,
   // Clear output map.
   tail_lsns.clear();
 
+  for (logid_t log : logs) {
+    traceEvent(TraceEventType::GET_TAIL, log);
+  }
+
   if (options.pretend) {
     // Pretend only. Just use LSN_INVALID.
     for (logid_t log : logs) {
@@ -32,6 +32,7 @@
 #include "logdevice/include/types.h"
 #include "logdevice/test/ldbench/worker/LogStoreTypes.h"
 #include "logdevice/test/ldbench/worker/Options.h"
+#include "logdevice/test/ldbench/worker/TraceFile.h"
 
 namespace facebook { namespace logdevice {
 
@@ -258,6 +259,17 @@ class Worker : private boost::noncopyable {
   // Convenience function for synchronous execution on EventLoop
   void executeOnEventLoopSync(folly::Func f);
 
+  // Records an operation to the --record-trace file, if any. See TraceEvent
+  // for the meaning of stream and value.
+  void traceEvent(TraceEventType type,
+                  logid_t log,
+                  uint64_t stream = 0,
+                  uint64_t value = 0) const {
+    if (trace_writer_) {
+      trace_writer_->record(type, log.val(), stream, value);
+    }
+  }
+
   // Custom stats for ldbench. Above client_ as to be destroyed after it.
   std::unique_ptr<StatsHolder> stats_;
 
@@ -278,6 +290,9 @@ class Worker : private boost::noncopyable {
 
   std::vector<uint32_t> payload_buf_;
 
+  // Set if --record-trace was given.
+  std::unique_ptr<TraceWriter> trace_writer_;
+
  private:
   template <typename T>
   friend class std::default_delete;
@@ -26,6 +26,7 @@ const WorkerFactoryMap& getWorkerFactoryMap() {
   registerWriteSaturationWorker();
   registerIsLogEmptyWorker();
   registerFindTimeWorker();
+  registerTraceReplayWorker();
 
   return getWorkerFactoryMapImpl();
 }
@@ -67,6 +67,7 @@ void registerReadYourWriteLatencyWorker();
 void registerWriteSaturationWorker();
 void registerIsLogEmptyWorker();
 void registerFindTimeWorker();
+void registerTraceReplayWorker();
 
 } // namespace ldbench
 }} // namespace facebook::logdevice
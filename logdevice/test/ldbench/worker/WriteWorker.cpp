@@ -306,6 +306,8 @@ void WriteWorker::maybeAppend(LogState* state) {
     }
   }
 
+  traceEvent(TraceEventType::APPEND, state->log_id, 0, payload_size);
+
   bool failed = false;
   if (options.pretend) {
     // pretend
@@ -581,6 +583,7 @@ void registerWriteWorker() {
                              "payload-entropy-sequencer",
                              "start-time",
                              "record-writer-info",
+                             "record-trace",
                          },
                          {PartitioningMode::LOG, PartitioningMode::RECORD},
                          OptionsRestrictions::AllowBufferedWriterOptions::YES));